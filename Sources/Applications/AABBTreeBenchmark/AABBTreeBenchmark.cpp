@@ -0,0 +1,206 @@
+/*=============================================================================
+AABBTreeBenchmark.cpp
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+#include <Core/Core.h>
+
+using namespace SonataEngine;
+
+/*
+	Benchmark of the frustum culling with the AABBTree.
+
+	AABBTreeBenchmark [maxCount] [frameCount]
+
+	For 10K objects up to maxCount objects (1M by default), random boxes are
+	scattered in a 2000x200x2000 world around the camera, which has a 90
+	degrees frustum with its far plane at 600. For each frame (20 by
+	default), 10% of the objects move, then the objects are culled by a
+	linear test of each box and by a query of the tree. The times are in
+	milliseconds per frame.
+
+	The tree returns the objects whose enlarged box intersects the frustum,
+	so its results must contain the results of the linear test.
+*/
+
+/// Size of the world along the horizontal axes, the vertical size is a tenth of it.
+static const real WorldSize = 2000.0f;
+
+/// Ratio of the objects moving at each frame.
+static const int32 MovingStride = 10;
+
+struct BenchmarkResult
+{
+	real64 _Build;
+	real64 _Update;
+	real64 _Linear;
+	real64 _Query;
+	int32 _Visible;
+	int32 _Candidates;
+	int32 _Height;
+};
+
+/// Culls the boxes one by one, like the linear path of the scene manager.
+static void CullLinear(const BaseArray<AABB>& boxes, const Frustum& frustum, BaseArray<void*>& result)
+{
+	int32 count = boxes.Count();
+	const AABB* data = boxes.Data();
+	for (int32 i = 0; i < count; i++)
+	{
+		uint32 planeMask = FrustumPlaneMask_All;
+		if (frustum.Intersects(data[i], planeMask) != ContainmentType_Disjoint)
+		{
+			result.Add((void*)(size_t)(i + 1));
+		}
+	}
+}
+
+/// Checks that each object found by the linear test is found by the tree.
+static bool CheckResults(const BaseArray<void*>& linear, const BaseArray<void*>& query, BaseArray<int32>& marks, int32 frame)
+{
+	int32 i;
+	for (i = 0; i < query.Count(); i++)
+	{
+		marks[(int32)(size_t)query[i] - 1] = frame;
+	}
+	for (i = 0; i < linear.Count(); i++)
+	{
+		if (marks[(int32)(size_t)linear[i] - 1] != frame)
+			return false;
+	}
+	return true;
+}
+
+static bool Benchmark(int32 count, int32 frameCount, BenchmarkResult& result)
+{
+	RandomLCG random(1);
+	BaseArray<AABB> boxes;
+	BaseArray<Vector3> velocities;
+	BaseArray<int32> proxies;
+	BaseArray<int32> marks;
+	boxes.Resize(count);
+	velocities.Resize(count);
+	proxies.Resize(count);
+	marks.Resize(count);
+
+	AABBTree tree;
+	Timer timer;
+	int32 i;
+
+	timer.Start();
+	for (i = 0; i < count; i++)
+	{
+		Vector3 center(
+			random.RandomReal(-WorldSize * 0.5f, WorldSize * 0.5f),
+			random.RandomReal(-WorldSize * 0.05f, WorldSize * 0.05f),
+			random.RandomReal(-WorldSize * 0.5f, WorldSize * 0.5f));
+		real size = random.RandomReal(0.5f, 2.5f);
+		boxes[i] = AABB(center - Vector3(size, size, size), center + Vector3(size, size, size));
+		velocities[i] = Vector3(random.RandomReal(-0.5f, 0.5f), 0.0f, random.RandomReal(-0.5f, 0.5f));
+		proxies[i] = tree.CreateProxy(boxes[i], (void*)(size_t)(i + 1));
+		marks[i] = -1;
+	}
+	timer.Stop();
+	result._Build = timer.Elapsed();
+
+	// The camera is at the origin and looks along -Z
+	const Frustum frustum(Matrix4::CreatePerspective(Math::PiByTwo, 1.0f, 1.0f, 600.0f));
+	BaseArray<void*> linear;
+	BaseArray<void*> query;
+	linear.SetCapacity(count);
+	query.SetCapacity(count);
+
+	bool isValid = true;
+	result._Update = 0.0;
+	result._Linear = 0.0;
+	result._Query = 0.0;
+	for (int32 frame = 0; frame < frameCount; frame++)
+	{
+		timer.Start();
+		for (i = 0; i < count; i += MovingStride)
+		{
+			boxes[i].Min += velocities[i];
+			boxes[i].Max += velocities[i];
+			tree.MoveProxy(proxies[i], boxes[i]);
+		}
+		timer.Stop();
+		result._Update += timer.Elapsed();
+
+		linear.Clear();
+		timer.Start();
+		CullLinear(boxes, frustum, linear);
+		timer.Stop();
+		result._Linear += timer.Elapsed();
+
+		query.Clear();
+		timer.Start();
+		tree.Query(frustum, query);
+		timer.Stop();
+		result._Query += timer.Elapsed();
+
+		isValid &= CheckResults(linear, query, marks, frame);
+	}
+
+	result._Visible = linear.Count();
+	result._Candidates = query.Count();
+	result._Height = tree.GetHeight();
+
+	for (i = 0; i < count; i++)
+	{
+		tree.DestroyProxy(proxies[i]);
+	}
+	isValid &= (tree.Count() == 0);
+
+	result._Build *= 1000.0;
+	result._Update *= 1000.0 / frameCount;
+	result._Linear *= 1000.0 / frameCount;
+	result._Query *= 1000.0 / frameCount;
+	return isValid;
+}
+
+int main(int argc, char** argv)
+{
+	int32 maxCount = 1000000;
+	int32 frameCount = 20;
+
+	Console::WriteLine(_T("AABBTreeBenchmark"));
+	Console::WriteLine(_T("================="));
+
+	if (argc > 3)
+	{
+		Console::WriteLine(_T("AABBTreeBenchmark [maxCount] [frameCount]"));
+		return -1;
+	}
+	if (argc > 1)
+	{
+		maxCount = Math::Max(String(argv[1]).ToInt32(), 10000);
+	}
+	if (argc > 2)
+	{
+		frameCount = Math::Max(String(argv[2]).ToInt32(), 1);
+	}
+
+	bool result = true;
+	for (int32 count = 10000; count <= maxCount; count *= 10)
+	{
+		BenchmarkResult benchmark;
+		bool isValid = Benchmark(count, frameCount, benchmark);
+
+		Console::WriteLine(String::ToString(count) + _T(" objects, build ") + String::ToString(benchmark._Build) +
+			_T(" ms, height ") + String::ToString(benchmark._Height));
+		Console::WriteLine(_T("  Linear test: ") + String::ToString(benchmark._Linear) + _T(" ms, ") +
+			String::ToString(benchmark._Visible) + _T(" visible"));
+		Console::WriteLine(_T("  Tree query:  ") + String::ToString(benchmark._Query) + _T(" ms, ") +
+			String::ToString(benchmark._Candidates) + _T(" candidates"));
+		Console::WriteLine(_T("  Tree update: ") + String::ToString(benchmark._Update) + _T(" ms"));
+		if (!isValid)
+		{
+			Console::WriteLine(_T("  FAILED: the tree missed visible objects"));
+			result = false;
+		}
+	}
+
+	Console::WriteLine(result ? _T("All tests passed.") : _T("Some tests failed."));
+	return (result ? 0 : 1);
+}
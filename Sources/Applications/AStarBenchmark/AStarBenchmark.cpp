@@ -0,0 +1,414 @@
+/*=============================================================================
+AStarBenchmark.cpp
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+#include <Core/Core.h>
+#include <AI/AI.h>
+
+using namespace SonataEngine;
+using namespace SonataEngine::AI;
+
+/*
+	Tests and benchmark of the storages of the A* pathfinder.
+
+	AStarBenchmark [maxSize]
+
+	The grids have 4 neighbours per cell, 20% of walls and costs of 1 or 2,
+	and the heuristic is the Chebyshev distance. The tests compare the path
+	costs of the pooled indexed storage with a Dijkstra reference on 200
+	small random grids, searching twice with the same storage.
+
+	The benchmark searches from a corner to the other on 512x512 and
+	2048x2048 grids, up to maxSize (2048 by default). The indexed storage
+	runs full searches, and both storages run the first 5K and 20K
+	expansions. The list storage is the one of the samples before the
+	indexed storage, its cost is quadratic. The rates are in millions of
+	expanded nodes per second.
+*/
+
+/// Number of random grids of the tests.
+static const int32 TestCount = 200;
+
+/// Percentages of walls and of cells of cost 2.
+static const int32 WallRatio = 20;
+static const int32 SlowRatio = 15;
+
+struct GridNode : public AStarPathfinderNode
+{
+	BaseArray<PathfinderNodeID> _Neighbours;
+};
+
+/// Grid of cell costs, 0 for the walls.
+struct Grid
+{
+	int32 _Width;
+	int32 _Height;
+	BaseArray<SEbyte> _Costs;
+
+	void Create(int32 width, int32 height, int32 seed)
+	{
+		RandomLCG random(seed);
+		_Width = width;
+		_Height = height;
+		_Costs.Resize(width * height);
+		for (int32 i = 0; i < _Costs.Count(); i++)
+		{
+			real value = random.RandomReal(0.0f, 100.0f);
+			_Costs[i] = (value < WallRatio ? 0 : (value < WallRatio + SlowRatio ? 2 : 1));
+		}
+	}
+
+	int32 GetNeighbours(PathfinderNodeID node, PathfinderNodeID* neighbours) const
+	{
+		int32 x = node % _Width;
+		int32 y = node / _Width;
+		int32 count = 0;
+		if (x > 0)
+			neighbours[count++] = node - 1;
+		if (x < _Width - 1)
+			neighbours[count++] = node + 1;
+		if (y > 0)
+			neighbours[count++] = node - _Width;
+		if (y < _Height - 1)
+			neighbours[count++] = node + _Width;
+		return count;
+	}
+};
+
+class GridMap : public AStarPathfinderMap
+{
+public:
+	GridMap(const Grid* grid) : _Grid(grid) {}
+
+	virtual int GetNeighbourCount(PathfinderNode* node) { return ((GridNode*)node)->_Neighbours.Count(); }
+	virtual PathfinderNodeID GetNeighbour(PathfinderNode* node, int index) { return ((GridNode*)node)->_Neighbours[index]; }
+
+	virtual void InitializeNeighbour(AStarPathfinderNode* parent, AStarPathfinderNode* child)
+	{
+		PathfinderNodeID neighbours[4];
+		int32 count = _Grid->GetNeighbours(child->_NodeID, neighbours);
+
+		GridNode* node = (GridNode*)child;
+		node->_Neighbours.Clear();
+		for (int32 i = 0; i < count; i++)
+			node->_Neighbours.Add(neighbours[i]);
+	}
+
+protected:
+	const Grid* _Grid;
+};
+
+/// Goal with the Chebyshev distance, the search can be stopped after a number of expansions.
+class GridGoal : public AStarPathfinderGoal
+{
+public:
+	GridGoal(const Grid* grid, int32 maxExpandedCount) :
+		_Grid(grid),
+		_DestinationNode(PathfinderNodeID_Invalid),
+		_ExpandedCount(0),
+		_MaxExpandedCount(maxExpandedCount)
+	{
+	}
+
+	int32 GetExpandedCount() const { return _ExpandedCount; }
+
+	virtual void SetDestinationNode(PathfinderNodeID node) { _DestinationNode = node; }
+	virtual bool IsNodeValid(PathfinderNodeID node) { return (_Grid->_Costs[node] != 0); }
+
+	virtual real32 GetHeuristic(AStarPathfinderNode* node)
+	{
+		int32 dx = Math::Abs(node->_NodeID % _Grid->_Width - _DestinationNode % _Grid->_Width);
+		int32 dy = Math::Abs(node->_NodeID / _Grid->_Width - _DestinationNode / _Grid->_Width);
+		return (real32)Math::Max(dx, dy);
+	}
+
+	virtual real32 GetCost(AStarPathfinderNode* nodeA, AStarPathfinderNode* nodeB)
+	{
+		return (real32)_Grid->_Costs[nodeB->_NodeID];
+	}
+
+	virtual bool IsSearchFinished(AStarPathfinderNode* node)
+	{
+		_ExpandedCount++;
+		return (node->_NodeID == _DestinationNode || (_MaxExpandedCount > 0 && _ExpandedCount >= _MaxExpandedCount));
+	}
+
+protected:
+	const Grid* _Grid;
+	PathfinderNodeID _DestinationNode;
+	int32 _ExpandedCount;
+	int32 _MaxExpandedCount;
+};
+
+/**
+	Storage of the samples before the indexed storage: the Open list is
+	sorted by insertion and the lists are searched linearly. Unlike the
+	samples, the nodes are deleted by Reset.
+*/
+class ListStorage : public AStarPathfinderStorage
+{
+public:
+	virtual ~ListStorage()
+	{
+		Reset();
+	}
+
+	virtual AStarPathfinderNode* CreateNode(PathfinderNodeID node)
+	{
+		GridNode* result = new GridNode();
+		result->_NodeID = node;
+		_Nodes.Add(result);
+		return result;
+	}
+
+	virtual void DestroyNode(AStarPathfinderNode* node)
+	{
+	}
+
+	virtual void Reset()
+	{
+		for (int32 i = 0; i < _Nodes.Count(); i++)
+			delete _Nodes[i];
+		_Nodes.Clear();
+		_OpenList.Clear();
+		_ClosedList.Clear();
+	}
+
+	virtual void AddToOpenList(AStarPathfinderNode* node, AStarPathfinderMap* map)
+	{
+		int32 index = 0;
+		while (index < _OpenList.Count() && node->CompareTo(*_OpenList[index]) >= 0)
+			index++;
+		_OpenList.Insert(index, node);
+	}
+
+	virtual void AddToClosedList(AStarPathfinderNode* node, AStarPathfinderMap* map)
+	{
+		_ClosedList.Add(node);
+	}
+
+	virtual void RemoveFromOpenList(AStarPathfinderNode* node)
+	{
+		if (!_OpenList.IsEmpty() && _OpenList[0] == node)
+			_OpenList.RemoveAt(0);
+	}
+
+	virtual void RemoveFromClosedList(AStarPathfinderNode* node)
+	{
+		for (int32 i = 0; i < _ClosedList.Count(); i++)
+		{
+			if (_ClosedList[i] == node)
+			{
+				_ClosedList.RemoveAt(i);
+				return;
+			}
+		}
+	}
+
+	virtual AStarPathfinderNode* FindInOpenList(PathfinderNodeID node)
+	{
+		for (int32 i = 0; i < _OpenList.Count(); i++)
+		{
+			if (_OpenList[i]->_NodeID == node)
+				return _OpenList[i];
+		}
+		return NULL;
+	}
+
+	virtual AStarPathfinderNode* FindInClosedList(PathfinderNodeID node)
+	{
+		for (int32 i = 0; i < _ClosedList.Count(); i++)
+		{
+			if (_ClosedList[i]->_NodeID == node)
+				return _ClosedList[i];
+		}
+		return NULL;
+	}
+
+	virtual AStarPathfinderNode* RemoveBestOpenNode()
+	{
+		if (_OpenList.IsEmpty())
+			return NULL;
+
+		AStarPathfinderNode* node = _OpenList[0];
+		_OpenList.RemoveAt(0);
+		return node;
+	}
+
+protected:
+	BaseArray<AStarPathfinderNode*> _Nodes;
+	BaseArray<AStarPathfinderNode*> _OpenList;
+	BaseArray<AStarPathfinderNode*> _ClosedList;
+};
+
+struct SearchResult
+{
+	int32 _ExpandedCount;
+	real64 _Time;
+	real32 _Cost;
+};
+
+/// Gets the cost of the shortest path with the Dijkstra algorithm, the costs are small integers so the queue has a bucket per cost.
+static int32 GetDijkstraCost(const Grid& grid, PathfinderNodeID source, PathfinderNodeID destination)
+{
+	const int32 Infinite = 0x7fffffff;
+	BaseArray<int32> costs;
+	costs.Resize(grid._Costs.Count());
+	for (int32 i = 0; i < costs.Count(); i++)
+		costs[i] = Infinite;
+
+	BaseArray< BaseArray<PathfinderNodeID> > buckets;
+	buckets.Resize(2 * grid._Costs.Count() + 1);
+	costs[source] = 0;
+	buckets[0].Add(source);
+
+	for (int32 cost = 0; cost < buckets.Count(); cost++)
+	{
+		for (int32 i = 0; i < buckets[cost].Count(); i++)
+		{
+			PathfinderNodeID node = buckets[cost][i];
+			if (costs[node] != cost)
+				continue;
+			if (node == destination)
+				return cost;
+
+			PathfinderNodeID neighbours[4];
+			int32 count = grid.GetNeighbours(node, neighbours);
+			for (int32 j = 0; j < count; j++)
+			{
+				PathfinderNodeID neighbour = neighbours[j];
+				int32 neighbourCost = cost + grid._Costs[neighbour];
+				if (grid._Costs[neighbour] != 0 && neighbourCost < costs[neighbour])
+				{
+					costs[neighbour] = neighbourCost;
+					buckets[neighbourCost].Add(neighbour);
+				}
+			}
+		}
+	}
+	return -1;
+}
+
+static SearchResult Search(const Grid& grid, AStarPathfinderStorage* storage, PathfinderNodeID source,
+	PathfinderNodeID destination, int32 maxExpandedCount)
+{
+	GridMap map(&grid);
+	GridGoal goal(&grid, maxExpandedCount);
+	AStarPathfinder pathfinder;
+	pathfinder.Initialize(storage, &goal, &map);
+
+	Timer timer;
+	timer.Start();
+	pathfinder.SetSourceNode(source);
+	pathfinder.SetDestinationNode(destination);
+	pathfinder.Run();
+	timer.Stop();
+
+	SearchResult result;
+	result._ExpandedCount = goal.GetExpandedCount();
+	result._Time = timer.Elapsed();
+
+	AStarPathfinderNode* node = (AStarPathfinderNode*)pathfinder.GetCurrentNode();
+	result._Cost = (node != NULL && node->_NodeID == destination ? node->_Goal : -1.0f);
+	return result;
+}
+
+static bool TestCosts()
+{
+	RandomLCG random(5);
+	int32 failedCount = 0;
+	for (int32 i = 0; i < TestCount; i++)
+	{
+		Grid grid;
+		grid.Create(32 + i % 17, 24 + i % 13, i + 1);
+
+		// The source and the destination are walkable
+		int32 cellCount = grid._Costs.Count();
+		PathfinderNodeID source = Math::Min((int32)random.RandomReal(0.0f, (real)cellCount), cellCount - 1);
+		PathfinderNodeID destination = Math::Min((int32)random.RandomReal(0.0f, (real)cellCount), cellCount - 1);
+		grid._Costs[source] = Math::Max(grid._Costs[source], (SEbyte)1);
+		grid._Costs[destination] = Math::Max(grid._Costs[destination], (SEbyte)1);
+
+		PooledAStarPathfinderStorage<GridNode> pooled(64);
+		pooled.SetNodeCount(cellCount);
+		ListStorage list;
+
+		bool isValid = true;
+		isValid &= (Search(grid, &pooled, source, destination, 0)._Cost == GetDijkstraCost(grid, source, destination));
+		isValid &= (Search(grid, &list, source, destination, 0)._Cost == GetDijkstraCost(grid, source, destination));
+		isValid &= (Search(grid, &pooled, destination, source, 0)._Cost == GetDijkstraCost(grid, destination, source));
+		if (!isValid)
+			failedCount++;
+	}
+
+	if (failedCount != 0)
+	{
+		Console::WriteLine(_T("  FAILED: ") + String::ToString(failedCount) + _T(" path costs differ from Dijkstra"));
+	}
+	return (failedCount == 0);
+}
+
+static String GetRate(const SearchResult& result)
+{
+	return String::ToString(result._ExpandedCount / result._Time * 1.0e-6) + _T("M/s");
+}
+
+int main(int argc, char** argv)
+{
+	const int32 Sizes[] = { 512, 2048 };
+	const int32 SizeCount = sizeof(Sizes) / sizeof(Sizes[0]);
+	const int32 Budgets[] = { 5000, 20000 };
+	const int32 BudgetCount = sizeof(Budgets) / sizeof(Budgets[0]);
+	int32 maxSize = 2048;
+
+	Console::WriteLine(_T("AStarBenchmark"));
+	Console::WriteLine(_T("=============="));
+
+	if (argc == 2)
+	{
+		maxSize = Math::Max(String(argv[1]).ToInt32(), Sizes[0]);
+	}
+	else if (argc != 1)
+	{
+		Console::WriteLine(_T("AStarBenchmark [maxSize]"));
+		return -1;
+	}
+
+	bool result = TestCosts();
+
+	for (int32 s = 0; s < SizeCount && Sizes[s] <= maxSize; s++)
+	{
+		int32 size = Sizes[s];
+		Grid grid;
+		grid.Create(size, size, 1234 + size);
+
+		int32 margin = size / 16;
+		PathfinderNodeID source = margin * size + margin;
+		PathfinderNodeID destination = (size - margin) * size + (size - margin);
+		grid._Costs[source] = Math::Max(grid._Costs[source], (SEbyte)1);
+		grid._Costs[destination] = Math::Max(grid._Costs[destination], (SEbyte)1);
+
+		// The first search fills the pool
+		PooledAStarPathfinderStorage<GridNode> pooled;
+		pooled.SetNodeCount(size * size);
+		Search(grid, &pooled, source, destination, 0);
+
+		SearchResult full = Search(grid, &pooled, source, destination, 0);
+		Console::WriteLine(String::ToString(size) + _T("x") + String::ToString(size) + _T(", full search: ") +
+			String::ToString(full._ExpandedCount) + _T(" nodes, ") + GetRate(full) + _T(", cost ") + String::ToString(full._Cost));
+
+		for (int32 b = 0; b < BudgetCount; b++)
+		{
+			ListStorage list;
+			SearchResult listResult = Search(grid, &list, source, destination, Budgets[b]);
+			SearchResult pooledResult = Search(grid, &pooled, source, destination, Budgets[b]);
+			Console::WriteLine(_T("  First ") + String::ToString(Budgets[b]) + _T(" expansions: list ") +
+				GetRate(listResult) + _T(", indexed ") + GetRate(pooledResult));
+		}
+	}
+
+	Console::WriteLine(result ? _T("All tests passed.") : _T("Some tests failed."));
+	return (result ? 0 : 1);
+}
@@ -0,0 +1,347 @@
+/*=============================================================================
+AnimationBenchmark.cpp
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+#include <Core/Core.h>
+#include <Graphics/Graphics.h>
+
+using namespace SonataEngine;
+
+/*
+	Tests and benchmark of the transform animation tracks.
+
+	AnimationBenchmark [characterCount]
+
+	The tests edit the key frames of a bone track: the key frames are added
+	out of order, moved and removed, and the track must keep them sorted and
+	interpolate between the right keys. The rotations must take the shortest
+	arc with the spherical and linear interpolations.
+
+	The benchmark animates characters (500 by default) of 60 bones, with 61
+	keys of translation and rotation per bone, during 600 frames at 60 Hz.
+	Each character has its own tracks, updated by BoneAnimationTrack::Update
+	during the playback and at random times. The tracks of the first
+	character are then shared by all the characters, each one sampling them
+	with its own cursors, with the spherical and the linear interpolation of
+	the rotations. The times are in milliseconds per frame. The sampled
+	transforms must match the interpolation of the keys.
+*/
+
+static const int32 BoneCount = 60;
+static const int32 KeyCount = 61;
+static const int32 FrameCount = 600;
+static const real64 KeyRate = 30.0;
+static const real64 FrameRate = 60.0;
+static const real64 Length = (KeyCount - 1) / KeyRate;
+
+/// Number of times at which the interpolation is checked.
+static const int32 SampleCount = 600;
+
+static const real MaxError = 1.0e-3f;
+
+static bool Check(bool value, const String& message)
+{
+	if (!value)
+		Console::WriteLine(_T("  FAILED: ") + message);
+	return value;
+}
+
+static TransformKeyFrame* AddKeyFrame(BoneAnimationTrack* track, real64 time, TransformKeyFrameType type)
+{
+	TransformKeyFrame* keyFrame = (TransformKeyFrame*)track->AddKeyFrame(TimeValue(time));
+	keyFrame->SetTransformType(type);
+	return keyFrame;
+}
+
+static bool TestKeyFrames()
+{
+	bool result = true;
+	Bone bone(NULL, 0);
+	BoneAnimationTrack track;
+	track.SetBone(&bone);
+
+	TransformKeyFrame* keyFrame2 = AddKeyFrame(&track, 2.0, TransformKeyFrameType_Translation);
+	TransformKeyFrame* keyFrame0 = AddKeyFrame(&track, 0.0, TransformKeyFrameType_Translation);
+	TransformKeyFrame* keyFrame1 = AddKeyFrame(&track, 1.0, TransformKeyFrameType_Translation);
+	result &= Check(track.AddKeyFrame(TimeValue(1.0)) == keyFrame1, _T("a key frame is added twice at the same time"));
+	result &= Check(track.GetKeyFrameCount() == 3 && track.GetKeyFrameByIndex(0) == keyFrame0 &&
+		track.GetKeyFrameByIndex(2) == keyFrame2 && track.GetKeyFrameByIndex(3) == NULL, _T("the key frames are not sorted"));
+	result &= Check(track.GetKeyFrameIndex(keyFrame1) == 1, _T("wrong key frame index"));
+	result &= Check(track.GetKeyFrameAtTime(TimeValue(2.0)) == keyFrame2 && track.GetKeyFrameAtTime(TimeValue(1.5)) == NULL,
+		_T("wrong key frame at a time"));
+
+	KeyFrame* keyFrameA;
+	KeyFrame* keyFrameB;
+	track.GetKeyFramesAtTime(TimeValue(1.5), &keyFrameA, &keyFrameB);
+	bool isFound = (keyFrameA == keyFrame1 && keyFrameB == keyFrame2);
+	track.GetKeyFramesAtTime(TimeValue(-1.0), &keyFrameA, &keyFrameB);
+	isFound &= (keyFrameA == keyFrame0 && keyFrameB == keyFrame0);
+	track.GetKeyFramesAtTime(TimeValue(3.0), &keyFrameA, &keyFrameB);
+	isFound &= (keyFrameA == keyFrame2 && keyFrameB == keyFrame2);
+	result &= Check(isFound, _T("wrong key frames around a time"));
+
+	keyFrame0->SetTranslation(Vector3(0.0f, 0.0f, 0.0f));
+	keyFrame1->SetTranslation(Vector3(10.0f, 0.0f, 0.0f));
+	keyFrame2->SetTranslation(Vector3(20.0f, 0.0f, 0.0f));
+	keyFrame2->SetTransformType((TransformKeyFrameType)(TransformKeyFrameType_Translation | TransformKeyFrameType_Rotation));
+	keyFrame2->SetRotation(Quaternion::Identity);
+
+	track.Update(TimeValue(0.25));
+	result &= Check(bone.GetLocalPosition().X == 2.5f && bone.GetLocalOrientation().W == 1.0f, _T("wrong interpolation"));
+	track.Update(TimeValue(1.5));
+	result &= Check(bone.GetLocalPosition().X == 15.0f, _T("wrong interpolation"));
+	track.Update(TimeValue(5.0));
+	result &= Check(bone.GetLocalPosition().X == 20.0f, _T("wrong value after the last key"));
+	track.Update(TimeValue(-5.0));
+	result &= Check(bone.GetLocalPosition().X == 0.0f, _T("wrong value before the first key"));
+
+	// The middle key moves after the last one, the keys are sorted again
+	keyFrame1->SetTime(TimeValue(4.0));
+	result &= Check(track.GetKeyFrameIndex(keyFrame1) == 2 && track.GetKeyFrameByIndex(1) == keyFrame2, _T("a moved key frame is not sorted"));
+	track.Update(TimeValue(3.0));
+	result &= Check(bone.GetLocalPosition().X == 15.0f, _T("wrong interpolation after a move"));
+	keyFrame2->SetTime(TimeValue(4.0));
+	result &= Check(keyFrame2->GetTime() == TimeValue(2.0), _T("a key frame is moved on another one"));
+	track.RemoveKeyFrame(keyFrame2);
+	result &= Check(track.GetKeyFrameCount() == 2 && track.GetKeyFrameIndex(keyFrame2) == -1, _T("a key frame is not removed"));
+	track.Update(TimeValue(2.0));
+	result &= Check(bone.GetLocalPosition().X == 5.0f, _T("wrong interpolation after a removal"));
+
+	// The rotations take the shortest arc
+	BoneAnimationTrack rotationTrack;
+	rotationTrack.SetBone(&bone);
+	AddKeyFrame(&rotationTrack, 0.0, TransformKeyFrameType_Rotation)->SetRotation(Quaternion::Identity);
+	AddKeyFrame(&rotationTrack, 1.0, TransformKeyFrameType_Rotation)->SetRotation(Quaternion(0.0f, 0.0f, -0.7071068f, -0.7071068f));
+	rotationTrack.Update(TimeValue(0.5));
+	const Quaternion& rotation = bone.GetLocalOrientation();
+	result &= Check(rotation.W > 0.9f && rotation.Z > 0.38f && rotation.Z < 0.39f, _T("the slerp doesn't take the shortest arc"));
+	rotationTrack.SetRotationInterpolation(RotationInterpolationMode_Linear);
+	rotationTrack.Update(TimeValue(0.5));
+	result &= Check(rotation.W > 0.9f && rotation.Z > 0.38f && rotation.Z < 0.39f, _T("the nlerp doesn't take the shortest arc"));
+	rotationTrack.SetRotationInterpolation(RotationInterpolationMode_Constant);
+	rotationTrack.Update(TimeValue(0.5));
+	result &= Check(rotation.W == 1.0f, _T("wrong constant interpolation"));
+
+	return result;
+}
+
+static Quaternion GetKeyRotation(int32 bone, int32 key)
+{
+	real angle = (real)(0.05 * key + 0.1 * bone);
+	real sin = Math::Sin(angle);
+	return Quaternion(sin * 0.6f, sin * 0.8f, 0.0f, Math::Cos(angle));
+}
+
+static Vector3 GetKeyTranslation(int32 bone, int32 key)
+{
+	return Vector3((real)key, (real)bone, (real)(key * bone % 7));
+}
+
+static void AddKeyFrames(BoneAnimationTrack* track, int32 bone)
+{
+	for (int32 i = 0; i < KeyCount; i++)
+	{
+		TransformKeyFrame* keyFrame = AddKeyFrame(track, i / KeyRate,
+			(TransformKeyFrameType)(TransformKeyFrameType_Translation | TransformKeyFrameType_Rotation));
+		keyFrame->SetTranslation(GetKeyTranslation(bone, i));
+		keyFrame->SetRotation(GetKeyRotation(bone, i));
+	}
+}
+
+static real GetError(const Quaternion& value, const Quaternion& expected)
+{
+	return Math::Abs(value.X - expected.X) + Math::Abs(value.Y - expected.Y) +
+		Math::Abs(value.Z - expected.Z) + Math::Abs(value.W - expected.W);
+}
+
+/// Gets the time of a sample checked, and the key before it with the interpolation amount.
+static real64 GetSampleTime(int32 sample, int32& key, real& amount)
+{
+	real64 time = sample * Length * 0.999 / SampleCount;
+	key = (int32)(time * KeyRate);
+	amount = (real)((time - key / KeyRate) * KeyRate);
+	return time;
+}
+
+/// Gets the largest difference between a bone of a track and the interpolation of its keys.
+static real GetUpdateError(BoneAnimationTrack* track, int32 bone)
+{
+	real maxError = 0.0f;
+	for (int32 i = 0; i < SampleCount; i++)
+	{
+		int32 key;
+		real amount;
+		real64 time = GetSampleTime(i, key, amount);
+		track->Update(TimeValue(time));
+
+		Vector3 translation = track->GetBone()->GetLocalPosition() -
+			Vector3::Lerp(GetKeyTranslation(bone, key), GetKeyTranslation(bone, key + 1), amount);
+		real error = Math::Abs(translation.X) + Math::Abs(translation.Y) + Math::Abs(translation.Z);
+		error += GetError(track->GetBone()->GetLocalOrientation(),
+			Quaternion::Slerp(GetKeyRotation(bone, key), GetKeyRotation(bone, key + 1), amount));
+		maxError = Math::Max(maxError, error);
+	}
+	return maxError;
+}
+
+/// Gets the largest difference between the sampled rotations and the slerp of the keys.
+static real GetSampleError(BoneAnimationTrack* track, int32 bone)
+{
+	real maxError = 0.0f;
+	for (int32 i = 0; i < SampleCount; i++)
+	{
+		int32 key;
+		real amount;
+		real64 time = GetSampleTime(i, key, amount);
+
+		TransformKeyCursor cursor;
+		Vector3 translation;
+		Quaternion rotation;
+		Vector3 scale;
+		track->Sample(time, cursor, translation, rotation, scale);
+		maxError = Math::Max(maxError, GetError(rotation,
+			Quaternion::Slerp(GetKeyRotation(bone, key), GetKeyRotation(bone, key + 1), amount)));
+	}
+	return maxError;
+}
+
+static real64 GetPlaybackTime(real64 phase, int32 frame)
+{
+	real64 time = phase + frame / FrameRate;
+	return time - Length * (int32)(time / Length);
+}
+
+/// Samples the tracks of the first character for every character.
+static real64 SampleSharedTracks(const BaseArray<BoneAnimationTrack*>& tracks,
+	const BaseArray<real64>& phases, BaseArray<TransformKeyCursor>& cursors, real& checksum)
+{
+	int32 characterCount = phases.Count();
+	Vector3 translation;
+	Quaternion rotation;
+	Vector3 scale;
+	Timer timer;
+	timer.Start();
+	for (int32 frame = 0; frame < FrameCount; frame++)
+	{
+		for (int32 c = 0; c < characterCount; c++)
+		{
+			real64 time = GetPlaybackTime(phases[c], frame);
+			for (int32 b = 0; b < BoneCount; b++)
+			{
+				tracks[b]->Sample(time, cursors[c * BoneCount + b], translation, rotation, scale);
+				checksum += rotation.W;
+			}
+		}
+	}
+	timer.Stop();
+	return timer.Elapsed() * 1000.0 / FrameCount;
+}
+
+static bool Benchmark(int32 characterCount)
+{
+	int32 trackCount = characterCount * BoneCount;
+	BaseArray<Bone*> bones;
+	BaseArray<BoneAnimationTrack*> tracks;
+	BaseArray<real64> phases;
+	RandomLCG random(5);
+	int32 i, c, b, frame;
+	for (i = 0; i < trackCount; i++)
+	{
+		Bone* bone = new Bone(NULL, (uint16)(i % BoneCount));
+		BoneAnimationTrack* track = new BoneAnimationTrack();
+		track->SetBone(bone);
+		AddKeyFrames(track, i % BoneCount);
+		bones.Add(bone);
+		tracks.Add(track);
+	}
+	for (c = 0; c < characterCount; c++)
+		phases.Add(random.RandomReal(0.0f, (real)Length));
+
+	Console::WriteLine(String::ToString(characterCount) + _T(" characters, ") + String::ToString(BoneCount) + _T(" bones, ") +
+		String::ToString(KeyCount) + _T(" keys per bone"));
+
+	// Playback, each character with its own tracks
+	Timer timer;
+	timer.Start();
+	for (frame = 0; frame < FrameCount; frame++)
+	{
+		for (c = 0; c < characterCount; c++)
+		{
+			TimeValue time(GetPlaybackTime(phases[c], frame));
+			for (b = 0; b < BoneCount; b++)
+				tracks[c * BoneCount + b]->Update(time);
+		}
+	}
+	timer.Stop();
+	Console::WriteLine(_T("  Update, playback        : ") + String::ToString(timer.Elapsed() * 1000.0 / FrameCount) + _T(" ms/frame"));
+
+	timer.Start();
+	for (frame = 0; frame < FrameCount; frame++)
+	{
+		for (c = 0; c < characterCount; c++)
+		{
+			TimeValue time(random.RandomReal(0.0f, (real)Length));
+			for (b = 0; b < BoneCount; b++)
+				tracks[c * BoneCount + b]->Update(time);
+		}
+	}
+	timer.Stop();
+	Console::WriteLine(_T("  Update, random times    : ") + String::ToString(timer.Elapsed() * 1000.0 / FrameCount) + _T(" ms/frame"));
+
+	real updateError = GetUpdateError(tracks[3], 3);
+	Console::WriteLine(_T("  Update error            : ") + String::ToString(updateError));
+
+	// One clip shared by the characters, with a cursor per character
+	BaseArray<TransformKeyCursor> cursors;
+	cursors.Resize(trackCount);
+	for (b = 0; b < BoneCount; b++)
+		tracks[b]->UpdateKeys();
+
+	real checksum = 0.0f;
+	real64 slerpTime = SampleSharedTracks(tracks, phases, cursors, checksum);
+	Console::WriteLine(_T("  Shared Sample, slerp    : ") + String::ToString(slerpTime) + _T(" ms/frame"));
+
+	for (b = 0; b < BoneCount; b++)
+		tracks[b]->SetRotationInterpolation(RotationInterpolationMode_Linear);
+	real64 nlerpTime = SampleSharedTracks(tracks, phases, cursors, checksum);
+	real nlerpError = GetSampleError(tracks[3], 3);
+	Console::WriteLine(_T("  Shared Sample, nlerp    : ") + String::ToString(nlerpTime) + _T(" ms/frame, error against slerp ") +
+		String::ToString(nlerpError) + _T(" (") + String::ToString(checksum) + _T(")"));
+
+	for (i = 0; i < trackCount; i++)
+	{
+		delete tracks[i];
+		delete bones[i];
+	}
+
+	bool result = Check(updateError < MaxError, _T("the updated bones differ from the keys"));
+	result &= Check(nlerpError < 0.01f, _T("the nlerp differs from the slerp"));
+	return result;
+}
+
+int main(int argc, char** argv)
+{
+	int32 characterCount = 500;
+
+	Console::WriteLine(_T("AnimationBenchmark"));
+	Console::WriteLine(_T("=================="));
+
+	if (argc == 2)
+	{
+		characterCount = Math::Max(String(argv[1]).ToInt32(), 1);
+	}
+	else if (argc != 1)
+	{
+		Console::WriteLine(_T("AnimationBenchmark [characterCount]"));
+		return -1;
+	}
+
+	Console::WriteLine(_T("Key frames"));
+	bool result = TestKeyFrames();
+	result &= Benchmark(characterCount);
+
+	Console::WriteLine(result ? _T("All tests passed.") : _T("Some tests failed."));
+	return (result ? 0 : 1);
+}
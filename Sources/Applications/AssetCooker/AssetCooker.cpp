@@ -0,0 +1,204 @@
+/*=============================================================================
+AssetCooker.cpp
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+#include <Core/Core.h>
+#include <Core/Engine.h>
+#include <Graphics/Graphics.h>
+#include <Plugins.h>
+
+using namespace SonataEngine;
+
+/*
+	Cooks the models and the images loaded by the data plugins, and the raw
+	height fields, into a cooked asset container.
+
+	AssetCooker output.seck [-raw width height int8|int16|int32|real] input...
+
+	The option -raw applies to the next input, which is a raw height field.
+	The models are loaded in the hardware buffers of a render system, which
+	are read back to be cooked.
+*/
+
+static ManagerPlugin* FindRenderSystemPlugin()
+{
+	ManagerPlugin* renderPlugin;
+
+	renderPlugin = (ManagerPlugin*)PluginManager::Instance()->GetPluginByID(SE_ID_RENDERSYSTEM_D3D9);
+	if (renderPlugin != NULL)
+		return renderPlugin;
+
+	renderPlugin = (ManagerPlugin*)PluginManager::Instance()->GetPluginByID(SE_ID_RENDERSYSTEM_D3D8);
+	if (renderPlugin != NULL)
+		return renderPlugin;
+
+	renderPlugin = (ManagerPlugin*)PluginManager::Instance()->GetPluginByID(SE_ID_RENDERSYSTEM_GL);
+	if (renderPlugin != NULL)
+		return renderPlugin;
+
+	return NULL;
+}
+
+static bool CreateRenderSystem(Window* window)
+{
+	ManagerPlugin* renderPlugin = FindRenderSystemPlugin();
+	if (renderPlugin == NULL)
+	{
+		Console::Error()->WriteLine(_T("Failed to get the render system plugin."));
+		return false;
+	}
+
+	RenderSystem* renderSystem = (RenderSystem*)renderPlugin->CreateManager();
+	if (renderSystem == NULL)
+	{
+		Console::Error()->WriteLine(_T("Failed to create the render system."));
+		return false;
+	}
+
+	renderSystem->Create();
+	RenderSystem::SetCurrent(renderSystem);
+
+	// The hardware buffers need a render context
+	window->Create(_T("AssetCooker"), 0, 0, 64, 64);
+	RenderContextDescription desc;
+	desc.Mode.SetWidth(window->GetClientWidth());
+	desc.Mode.SetHeight(window->GetClientHeight());
+
+	return renderSystem->CreateRenderContext(window, desc);
+}
+
+static bool ParseHeightFieldFormat(const String& value, HeightFieldFormat& format)
+{
+	if (value.CompareTo(_T("int8"), true) == 0)
+		format = HeightFieldFormat_Int8;
+	else if (value.CompareTo(_T("int16"), true) == 0)
+		format = HeightFieldFormat_Int16;
+	else if (value.CompareTo(_T("int32"), true) == 0)
+		format = HeightFieldFormat_Int32;
+	else if (value.CompareTo(_T("real"), true) == 0)
+		format = HeightFieldFormat_Real;
+	else
+		return false;
+
+	return true;
+}
+
+static bool CookHeightField(CookedAssetWriter& writer, const String& fileName, int32 width, int32 height, HeightFieldFormat format)
+{
+	File file(fileName);
+	FileStreamPtr stream = file.Open(FileMode_Open, FileAccess_Read, FileShare_Read);
+	if (stream == NULL)
+		return false;
+
+	HeightFieldPtr heightField = new HeightField();
+	if (!heightField->LoadFromRAW(*stream, width, height, format))
+		return false;
+
+	return writer.AddHeightField(heightField);
+}
+
+static bool CookResource(CookedAssetWriter& writer, const String& fileName)
+{
+	Resource* resource = ResourceHelper::LoadFromFile(fileName, SE_ID_DATA_MODEL);
+	if (resource != NULL)
+	{
+		Model* model = (Model*)resource->GetData();
+		if (model->GetName().IsEmpty())
+			model->SetName(Path::GetFileNameWithoutExtension(fileName));
+		return writer.AddModel(model);
+	}
+
+	resource = ResourceHelper::LoadFromFile(fileName, SE_ID_DATA_IMAGE);
+	if (resource != NULL)
+	{
+		return writer.AddImage((Image*)resource->GetData());
+	}
+
+	return false;
+}
+
+int main(int argc, char** argv)
+{
+	Engine::Instance();
+
+	Console::WriteLine(_T("AssetCooker"));
+	Console::WriteLine(_T("==========="));
+
+	if (argc < 3)
+	{
+		Console::WriteLine(_T("AssetCooker output.seck [-raw width height int8|int16|int32|real] input..."));
+		return -1;
+	}
+
+	TextStreamLogHandler* consoleHandler = new TextStreamLogHandler(ConsoleStream::StandardOutput);
+	((DefaultLogFormatter*)consoleHandler->GetFormatter())->SetOptions(
+		(LogOptions)(LogOptions_None));
+
+	Logger* logger = new Logger();
+	logger->GetHandlers().Add(consoleHandler);
+	Logger::SetCurrent(logger);
+
+#ifndef SE_STATIC
+	PluginManager::Instance()->ParsePlugins(Environment::GetCurrentDirectory());
+#endif
+	PluginManager::Instance()->CreateAllPlugins();
+
+	Window window;
+	if (!CreateRenderSystem(&window))
+	{
+		Console::Error()->WriteLine(_T("Failed to create the render context."));
+		return -1;
+	}
+
+	CookedAssetWriter writer;
+	int result = 0;
+	for (int i = 2; i < argc; i++)
+	{
+		String arg = argv[i];
+		if (arg.CompareTo(_T("-raw"), true) == 0)
+		{
+			HeightFieldFormat format;
+			if (i + 4 >= argc || !ParseHeightFieldFormat(argv[i + 3], format))
+			{
+				Console::Error()->WriteLine(_T("Invalid height field options."));
+				result = -1;
+				break;
+			}
+
+			String fileName = argv[i + 4];
+			if (!CookHeightField(writer, fileName, String(argv[i + 1]).ToInt32(), String(argv[i + 2]).ToInt32(), format))
+			{
+				Console::Error()->WriteLine(_T("Failed to cook ") + fileName);
+				result = -1;
+			}
+			i += 4;
+		}
+		else if (!CookResource(writer, arg))
+		{
+			Console::Error()->WriteLine(_T("Failed to cook ") + arg);
+			result = -1;
+		}
+	}
+
+	if (result == 0)
+	{
+		File file(argv[1]);
+		FileStreamPtr stream = file.Open(FileMode_Create, FileAccess_Write, FileShare_None);
+		if (stream == NULL || !writer.Save(*stream))
+		{
+			Console::Error()->WriteLine(_T("Failed to write the cooked assets."));
+			result = -1;
+		}
+		else
+		{
+			Console::WriteLine(String::ToString(writer.GetAssetCount()) + _T(" assets cooked."));
+		}
+	}
+
+	RenderSystem::Current()->Destroy();
+	Engine::DestroyInstance();
+
+	return result;
+}
@@ -0,0 +1,334 @@
+/*=============================================================================
+BinaryStreamBenchmark.cpp
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+#include <Core/Core.h>
+
+using namespace SonataEngine;
+
+/*
+	Tests and benchmark of the buffered binary streams.
+
+	BinaryStreamBenchmark [objectCount]
+
+	The tests write and read records with buffers of 1, 3, 7 and 64K bytes
+	on a big endian file stream, check the bytes of the file, the zero
+	filled reads past the end, the position given back to the file stream
+	by a partial buffered read, the reads in place of a memory stream, and
+	the rejection of the corrupt string lengths.
+
+	The benchmark writes objects (1M by default) as BinarySerializer does:
+	a type name, a reference, 10 real32, a few integers, a real64 and two
+	strings. The objects are written to a file and read back with an
+	unbuffered and a buffered stream, then read from the memory with an
+	unbuffered stream and in place with a buffered stream. The read values
+	must be the same in each case. The times are in milliseconds.
+*/
+
+static const String FileName = _T("BinaryStreamBenchmark.bin");
+
+/// Number of records written by the tests.
+static const int32 RecordCount = 1000;
+
+/// Size of a record: an int32, a string of 10 characters, a real64, 20 bytes and a byte.
+static const int32 RecordSize = 4 + 4 + 10 + 8 + 20 + 1;
+
+static const SEchar* TypeNames[] = { _T("SceneNode"), _T("MeshEntity"), _T("LightEntity"), _T("CameraEntity") };
+static const SEchar* EnumNames[] = { _T("Visibility_Visible"), _T("Visibility_Hidden"), _T("Visibility_Inherited") };
+
+static bool Check(bool value, const String& message)
+{
+	if (!value)
+		Console::WriteLine(_T("  FAILED: ") + message);
+	return value;
+}
+
+/// Creates an unbuffered binary stream when bufferSize is 0.
+static BinaryStream* CreateBinaryStream(Stream* stream, int32 bufferSize)
+{
+	if (bufferSize > 0)
+		return new BinaryStream(stream, bufferSize);
+	else
+		return new BinaryStream(stream);
+}
+
+static FileStreamPtr OpenFile(bool isWriting)
+{
+	File file(FileName);
+	if (isWriting)
+		return file.Open(FileMode_Create, FileAccess_Write, FileShare_None);
+	else
+		return file.Open(FileMode_Open, FileAccess_Read, FileShare_Read);
+}
+
+static void WriteRecords(BinaryStream& writer)
+{
+	SEbyte bytes[20];
+	for (int32 k = 0; k < 20; k++)
+		bytes[k] = (SEbyte)k;
+
+	for (int32 i = 0; i < RecordCount; i++)
+	{
+		writer.WriteInt32(i);
+		writer.WriteString(_T("abcdefghij"));
+		writer.WriteReal64(i * 0.5);
+		writer.Write(bytes, 20);
+		writer.Write((SEbyte)7);
+	}
+}
+
+static bool ReadRecords(BinaryStream& reader)
+{
+	bool isValid = true;
+	for (int32 i = 0; i < RecordCount && isValid; i++)
+	{
+		isValid &= (reader.ReadInt32() == i);
+		isValid &= (reader.ReadString() == _T("abcdefghij"));
+		isValid &= (reader.ReadReal64() == i * 0.5);
+		SEbyte bytes[20];
+		isValid &= (reader.Read(bytes, 20) == 20);
+		for (int32 k = 0; k < 20; k++)
+			isValid &= (bytes[k] == k);
+		isValid &= (reader.Peek() == 7);
+		isValid &= (reader.Read() == 7);
+	}
+	return isValid;
+}
+
+static bool TestBufferSize(int32 bufferSize)
+{
+	bool result = true;
+	String name = _T("buffer of ") + String::ToString(bufferSize) + _T(" bytes: ");
+
+	{
+		FileStreamPtr stream = OpenFile(true);
+		stream->SetByteOrder(ByteOrder_BigEndian);
+		BinaryStream writer(stream, bufferSize);
+		WriteRecords(writer);
+	}
+
+	{
+		FileStreamPtr stream = OpenFile(false);
+		stream->SetByteOrder(ByteOrder_BigEndian);
+		BinaryStream reader(stream, bufferSize);
+		result &= Check(ReadRecords(reader), name + _T("the records differ"));
+		result &= Check(reader.ReadInt32() == 0, name + _T("the values past the end are not zero"));
+	}
+
+	{
+		// The second record starts with 1 in big endian
+		FileStreamPtr stream = OpenFile(false);
+		SEbyte bytes[4];
+		stream->Seek(RecordSize, SeekOrigin_Begin);
+		result &= Check(stream->Read(bytes, 4) == 4 && bytes[0] == 0 && bytes[3] == 1, name + _T("the file is not big endian"));
+	}
+
+	{
+		// A partial read gives the position back to the file stream
+		FileStreamPtr stream = OpenFile(false);
+		stream->SetByteOrder(ByteOrder_BigEndian);
+		{
+			BinaryStream reader(stream, bufferSize);
+			reader.ReadInt32();
+			reader.ReadString();
+		}
+		result &= Check(stream->GetPosition() == 4 + 4 + 10, name + _T("the position is not given back to the stream"));
+		BinaryStream reader(stream);
+		result &= Check(reader.ReadReal64() == 0.0, name + _T("wrong value after a partial read"));
+	}
+
+	return result;
+}
+
+static bool ReadCorruptString(Stream* stream, int32 bufferSize)
+{
+	bool isThrown = false;
+	BinaryStream* reader = CreateBinaryStream(stream, bufferSize);
+	try
+	{
+		reader->ReadString();
+	}
+	catch (const IOException&)
+	{
+		isThrown = true;
+	}
+	delete reader;
+	return isThrown;
+}
+
+static bool TestStreams()
+{
+	bool result = true;
+	int32 bufferSizes[] = { 1, 3, 7, BinaryStream::DefaultBufferSize };
+	for (int32 i = 0; i < 4; i++)
+		result &= TestBufferSize(bufferSizes[i]);
+
+	{
+		// The reads of a memory stream are done in place, the stream can be used again after Flush
+		MemoryStream memory(64);
+		for (int32 i = 0; i < 64; i++)
+			memory.WriteByte((SEbyte)i);
+		memory.SetPosition(0);
+
+		BinaryStream reader(&memory, 16);
+		result &= Check(reader.ReadUInt8() == 0 && reader.ReadUInt16() == (2 << 8 | 1), _T("memory: wrong values"));
+		reader.Flush();
+		result &= Check(memory.GetPosition() == 3 && memory.ReadByte() == 3, _T("memory: the position is not given back to the stream"));
+		result &= Check(reader.ReadUInt8() == 4, _T("memory: wrong value after Flush"));
+		SEbyte bytes[100];
+		result &= Check(reader.Read(bytes, 100) == 59 && bytes[0] == 5 && bytes[58] == 63 && bytes[59] == 0,
+			_T("memory: the short read is not zero filled"));
+	}
+
+	{
+		// A string longer than the rest of the stream is rejected before allocating it
+		{
+			FileStreamPtr stream = OpenFile(true);
+			BinaryStream writer(stream);
+			writer.WriteUInt32(0xFFFFFFFF);
+			writer.WriteInt32(1);
+			writer.WriteUInt32(5);
+		}
+		FileStreamPtr stream = OpenFile(false);
+		result &= Check(ReadCorruptString(stream, 0), _T("unbuffered: a corrupt string length is accepted"));
+		stream->SetPosition(0);
+		result &= Check(ReadCorruptString(stream, 16), _T("buffered: a corrupt string length is accepted"));
+
+		MemoryStream memory(8);
+		SEbyte bytes[8] = { 9, 0, 0, 0, 'a', 'b', 'c', 'd' };
+		memory.Write(bytes, 8);
+		memory.SetPosition(0);
+		result &= Check(ReadCorruptString(&memory, 16), _T("memory: a corrupt string length is accepted"));
+	}
+
+	File::Delete(FileName);
+	return result;
+}
+
+static void WriteObject(BinaryStream& writer, int32 index)
+{
+	writer.WriteString(TypeNames[index & 3]);
+	writer.WriteInt8(1);
+	for (int32 k = 0; k < 10; k++)
+		writer.WriteReal32(index * 0.5f + k);
+	writer.WriteInt32(index);
+	writer.WriteUInt8((uint8)(index & 1));
+	writer.WriteInt16((int16)index);
+	writer.WriteReal64(index * 0.25);
+	writer.WriteString(_T("node_") + String::ToString(index));
+	writer.WriteString(EnumNames[index % 3]);
+}
+
+/// Reads an object, returns the sum of its values.
+static real64 ReadObject(BinaryStream& reader)
+{
+	real64 sum = reader.ReadString().Length();
+	sum += reader.ReadInt8();
+	for (int32 k = 0; k < 10; k++)
+		sum += reader.ReadReal32();
+	sum += reader.ReadInt32();
+	sum += reader.ReadUInt8();
+	sum += reader.ReadInt16();
+	sum += reader.ReadReal64();
+	sum += reader.ReadString().Length();
+	sum += reader.ReadString().Length();
+	return sum;
+}
+
+static real64 WriteFile(int32 objectCount, int32 bufferSize)
+{
+	Timer timer;
+	timer.Start();
+	{
+		FileStreamPtr stream = OpenFile(true);
+		BinaryStream* writer = CreateBinaryStream(stream, bufferSize);
+		for (int32 i = 0; i < objectCount; i++)
+			WriteObject(*writer, i);
+		delete writer;
+	}
+	timer.Stop();
+	return timer.Elapsed() * 1000.0;
+}
+
+static real64 Read(Stream* stream, int32 objectCount, int32 bufferSize, real64& sum)
+{
+	Timer timer;
+	timer.Start();
+	BinaryStream* reader = CreateBinaryStream(stream, bufferSize);
+	sum = 0.0;
+	for (int32 i = 0; i < objectCount; i++)
+		sum += ReadObject(*reader);
+	delete reader;
+	timer.Stop();
+	return timer.Elapsed() * 1000.0;
+}
+
+static real64 ReadFile(int32 objectCount, int32 bufferSize, real64& sum)
+{
+	FileStreamPtr stream = OpenFile(false);
+	return Read(stream, objectCount, bufferSize, sum);
+}
+
+int main(int argc, char** argv)
+{
+	int32 objectCount = 1000000;
+
+	Console::WriteLine(_T("BinaryStreamBenchmark"));
+	Console::WriteLine(_T("====================="));
+
+	if (argc == 2)
+	{
+		objectCount = Math::Max(String(argv[1]).ToInt32(), 1);
+	}
+	else if (argc != 1)
+	{
+		Console::WriteLine(_T("BinaryStreamBenchmark [objectCount]"));
+		return -1;
+	}
+
+	bool result = true;
+	Console::WriteLine(_T("Tests"));
+	result &= TestStreams();
+
+	real64 writeTime = WriteFile(objectCount, 0);
+	real64 bufferedWriteTime = WriteFile(objectCount, BinaryStream::DefaultBufferSize);
+
+	real64 sum;
+	real64 bufferedSum;
+	real64 readTime = ReadFile(objectCount, 0, sum);
+	real64 bufferedReadTime = ReadFile(objectCount, BinaryStream::DefaultBufferSize, bufferedSum);
+	result &= Check(sum == bufferedSum, _T("the buffered file reads differ"));
+
+	// The same bytes, in a memory stream wrapping them and in a memory stream exposing its buffer
+	int32 length;
+	BaseArray<SEbyte> data;
+	{
+		FileStreamPtr stream = OpenFile(false);
+		length = (int32)stream->GetLength();
+		data.Resize(length);
+		stream->Read(data.Data(), length);
+	}
+	MemoryStream memory(data.Data(), length, false);
+	MemoryStream exposedMemory(length);
+	exposedMemory.Write(data.Data(), length);
+	exposedMemory.SetPosition(0);
+
+	real64 memorySum;
+	real64 spanSum;
+	real64 memoryReadTime = Read(&memory, objectCount, 0, memorySum);
+	real64 spanReadTime = Read(&exposedMemory, objectCount, BinaryStream::DefaultBufferSize, spanSum);
+	result &= Check(sum == memorySum && sum == spanSum, _T("the memory reads differ"));
+	result &= Check(exposedMemory.GetPosition() == length, _T("the memory stream is not at the end"));
+
+	File::Delete(FileName);
+
+	Console::WriteLine(String::ToString(objectCount) + _T(" objects, ") + String::ToString(length / 1048576.0) + _T(" MB"));
+	Console::WriteLine(_T("  file write : unbuffered ") + String::ToString(writeTime) + _T(" ms, buffered ") + String::ToString(bufferedWriteTime) + _T(" ms"));
+	Console::WriteLine(_T("  file read  : unbuffered ") + String::ToString(readTime) + _T(" ms, buffered ") + String::ToString(bufferedReadTime) + _T(" ms"));
+	Console::WriteLine(_T("  memory read: unbuffered ") + String::ToString(memoryReadTime) + _T(" ms, in place ") + String::ToString(spanReadTime) + _T(" ms"));
+
+	Console::WriteLine(result ? _T("All tests passed.") : _T("Some tests failed."));
+	return (result ? 0 : 1);
+}
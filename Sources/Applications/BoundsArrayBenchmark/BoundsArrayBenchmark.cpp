@@ -0,0 +1,252 @@
+/*=============================================================================
+BoundsArrayBenchmark.cpp
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+#include <Core/Core.h>
+
+using namespace SonataEngine;
+
+/*
+	Benchmark of the batch frustum culling of the BoundsArray.
+
+	BoundsArrayBenchmark [maxCount]
+
+	For 10K objects up to maxCount objects (1M by default), random boxes and
+	their bounding spheres are scattered in a 2000x200x2000 world around the
+	camera, which has a 90 degrees frustum with its far plane at 600. 1% of
+	the bounds are then removed. The boxes and the spheres are culled one by
+	one with Frustum::Intersects, and in batch with CullBoxes and CullSpheres.
+	The rates are in objects per nanosecond.
+
+	The batch culling uses SSE when SE_USE_SIMD is enabled, build with
+	SE_USE_SIMD set to 0 to measure the scalar path.
+*/
+
+/// Size of the world along the horizontal axes, the vertical size is a tenth of it.
+static const real WorldSize = 2000.0f;
+
+/// Number of objects culled by each measure, the culling is repeated to reach it.
+static const int32 CulledObjectCount = 20000000;
+
+/**
+	Distance below which a volume is considered on a plane of the frustum.
+	The batch and the per-object tests may round these volumes differently.
+*/
+static const real PlaneTolerance = 0.001f;
+
+struct BenchmarkResult
+{
+	real64 _Boxes;
+	real64 _BatchBoxes;
+	real64 _Spheres;
+	real64 _BatchSpheres;
+	int32 _VisibleBoxes;
+	int32 _VisibleSpheres;
+};
+
+static bool IsVisible(const uint32* visibility, int32 index)
+{
+	return ((visibility[index / 32] >> (index & 31)) & 1) != 0;
+}
+
+/// Gets the smallest distance of a box to the outside of the frustum, negative if the box is outside.
+static real GetBoxDistance(const Frustum& frustum, const BoundingBox& box)
+{
+	Vector3 center = (box.Min + box.Max) * 0.5f;
+	Vector3 extents = (box.Max - box.Min) * 0.5f;
+	real result = WorldSize;
+	for (int i = 0; i < NumFrustumPlanes; i++)
+	{
+		Plane plane = frustum.GetFrustumPlane((FrustumPlane)i);
+		real radius =
+			extents.X * Math::Abs(plane.Normal.X) +
+			extents.Y * Math::Abs(plane.Normal.Y) +
+			extents.Z * Math::Abs(plane.Normal.Z);
+		result = Math::Min(result, plane.GetDistance(center) + radius);
+	}
+	return result;
+}
+
+static real GetSphereDistance(const Frustum& frustum, const BoundingSphere& sphere)
+{
+	real result = WorldSize;
+	for (int i = 0; i < NumFrustumPlanes; i++)
+	{
+		Plane plane = frustum.GetFrustumPlane((FrustumPlane)i);
+		result = Math::Min(result, plane.GetDistance(sphere.Center) + sphere.Radius);
+	}
+	return result;
+}
+
+static bool Benchmark(int32 count, BenchmarkResult& result)
+{
+	RandomLCG random(1);
+	BoundsArray bounds;
+	BaseArray<BoundingBox> boxes;
+	BaseArray<BoundingSphere> spheres;
+	int32 i;
+
+	for (i = 0; i < count; i++)
+	{
+		Vector3 center(
+			random.RandomReal(-WorldSize * 0.5f, WorldSize * 0.5f),
+			random.RandomReal(-WorldSize * 0.05f, WorldSize * 0.05f),
+			random.RandomReal(-WorldSize * 0.5f, WorldSize * 0.5f));
+		real size = random.RandomReal(0.5f, 2.5f);
+		BoundingBox box(center - Vector3(size, size, size), center + Vector3(size, size, size));
+		BoundingSphere sphere(center, size * Math::Sqrt(3.0f));
+		boxes.Add(box);
+		spheres.Add(sphere);
+		bounds.Add(sphere, box);
+	}
+
+	// The last bounds are moved to the removed ones, as in the scene
+	for (i = 0; i < count / 100; i++)
+	{
+		int32 index = i * 50;
+		bounds.RemoveAt(index);
+		boxes[index] = boxes[boxes.Count() - 1];
+		spheres[index] = spheres[spheres.Count() - 1];
+		boxes.RemoveAt(boxes.Count() - 1);
+		spheres.RemoveAt(spheres.Count() - 1);
+	}
+	count = bounds.Count();
+
+	// The camera is at the origin and looks along -Z
+	const Frustum frustum(Matrix4::CreatePerspective(Math::PiByTwo, 1.0f, 1.0f, 600.0f));
+	int32 repeatCount = Math::Max(CulledObjectCount / count, 20);
+
+	// One more word checks that the culling doesn't write past the mask
+	const uint32 Guard = 0xDEADBEEF;
+	int32 maskSize = BoundsArray::GetMaskSize(count);
+	BaseArray<uint32> boxMask;
+	BaseArray<uint32> sphereMask;
+	boxMask.Resize(maskSize + 1);
+	sphereMask.Resize(maskSize + 1);
+	boxMask[maskSize] = Guard;
+	sphereMask[maskSize] = Guard;
+
+	// The results of the per-object tests, BaseArray<bool> would be a bit vector
+	BaseArray<SEbyte> boxVisible;
+	BaseArray<SEbyte> sphereVisible;
+	boxVisible.Resize(count);
+	sphereVisible.Resize(count);
+
+	const BoundingBox* boxData = boxes.Data();
+	const BoundingSphere* sphereData = spheres.Data();
+	Timer timer;
+	int32 repeat;
+
+	timer.Start();
+	for (repeat = 0; repeat < repeatCount; repeat++)
+	{
+		for (i = 0; i < count; i++)
+		{
+			uint32 planeMask = FrustumPlaneMask_All;
+			boxVisible[i] = (frustum.Intersects(boxData[i], planeMask) != ContainmentType_Disjoint ? 1 : 0);
+		}
+	}
+	timer.Stop();
+	result._Boxes = timer.Elapsed();
+
+	timer.Start();
+	for (repeat = 0; repeat < repeatCount; repeat++)
+	{
+		bounds.CullBoxes(frustum, boxMask.Data());
+	}
+	timer.Stop();
+	result._BatchBoxes = timer.Elapsed();
+
+	timer.Start();
+	for (repeat = 0; repeat < repeatCount; repeat++)
+	{
+		for (i = 0; i < count; i++)
+		{
+			sphereVisible[i] = (frustum.Intersects(sphereData[i]) != 0 ? 1 : 0);
+		}
+	}
+	timer.Stop();
+	result._Spheres = timer.Elapsed();
+
+	timer.Start();
+	for (repeat = 0; repeat < repeatCount; repeat++)
+	{
+		bounds.CullSpheres(frustum, sphereMask.Data());
+	}
+	timer.Stop();
+	result._BatchSpheres = timer.Elapsed();
+
+	// The masks must match the per-object tests, and the unused bits must be cleared
+	bool isValid = (boxMask[maskSize] == Guard && sphereMask[maskSize] == Guard);
+	result._VisibleBoxes = 0;
+	result._VisibleSpheres = 0;
+	for (i = 0; i < count; i++)
+	{
+		bool isBoxVisible = IsVisible(boxMask.Data(), i);
+		bool isSphereVisible = IsVisible(sphereMask.Data(), i);
+		if (isBoxVisible != (boxVisible[i] != 0) && Math::Abs(GetBoxDistance(frustum, boxData[i])) > PlaneTolerance)
+			isValid = false;
+		if (isSphereVisible != (sphereVisible[i] != 0) && Math::Abs(GetSphereDistance(frustum, sphereData[i])) > PlaneTolerance)
+			isValid = false;
+
+		result._VisibleBoxes += (isBoxVisible ? 1 : 0);
+		result._VisibleSpheres += (isSphereVisible ? 1 : 0);
+	}
+	if ((count & 31) != 0)
+	{
+		isValid &= ((boxMask[count / 32] >> (count & 31)) == 0);
+		isValid &= ((sphereMask[count / 32] >> (count & 31)) == 0);
+	}
+
+	real64 objectCount = (real64)count * repeatCount * 1.0e-9;
+	result._Boxes = objectCount / result._Boxes;
+	result._BatchBoxes = objectCount / result._BatchBoxes;
+	result._Spheres = objectCount / result._Spheres;
+	result._BatchSpheres = objectCount / result._BatchSpheres;
+	return isValid;
+}
+
+int main(int argc, char** argv)
+{
+	int32 maxCount = 1000000;
+
+	Console::WriteLine(_T("BoundsArrayBenchmark"));
+	Console::WriteLine(_T("===================="));
+
+	if (argc == 2)
+	{
+		maxCount = Math::Max(String(argv[1]).ToInt32(), 10000);
+	}
+	else if (argc != 1)
+	{
+		Console::WriteLine(_T("BoundsArrayBenchmark [maxCount]"));
+		return -1;
+	}
+
+	Console::WriteLine(String(_T("SIMD: ")) + (SE_USE_SIMD ? _T("enabled") : _T("disabled")));
+
+	bool result = true;
+	for (int32 count = 10000; count <= maxCount; count *= 10)
+	{
+		BenchmarkResult benchmark;
+		bool isValid = Benchmark(count, benchmark);
+
+		Console::WriteLine(String::ToString(count - count / 100) + _T(" objects, ") +
+			String::ToString(benchmark._VisibleBoxes) + _T(" visible boxes, ") +
+			String::ToString(benchmark._VisibleSpheres) + _T(" visible spheres"));
+		Console::WriteLine(_T("  Frustum::Intersects boxes:   ") + String::ToString(benchmark._Boxes) + _T(" objects/ns"));
+		Console::WriteLine(_T("  CullBoxes:                   ") + String::ToString(benchmark._BatchBoxes) + _T(" objects/ns"));
+		Console::WriteLine(_T("  Frustum::Intersects spheres: ") + String::ToString(benchmark._Spheres) + _T(" objects/ns"));
+		Console::WriteLine(_T("  CullSpheres:                 ") + String::ToString(benchmark._BatchSpheres) + _T(" objects/ns"));
+		if (!isValid)
+		{
+			Console::WriteLine(_T("  FAILED: the visibility masks differ from the per-object tests"));
+			result = false;
+		}
+	}
+
+	Console::WriteLine(result ? _T("All tests passed.") : _T("Some tests failed."));
+	return (result ? 0 : 1);
+}
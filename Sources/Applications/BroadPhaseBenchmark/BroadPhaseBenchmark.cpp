@@ -0,0 +1,260 @@
+/*=============================================================================
+BroadPhaseBenchmark.cpp
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+#include <Core/Core.h>
+#include <PhysicsSystem_Software/SoftwarePhysicsSystem.h>
+#include <PhysicsSystem_Software/BroadPhase.h>
+
+using namespace SonataEngine;
+using namespace SE_Software;
+
+/*
+	Benchmark of the broad phases of the software physics system.
+
+	BroadPhaseBenchmark [maxCount]
+
+	For 1K, 10K and 50K bodies, up to maxCount bodies (50K by default), unit
+	boxes fall on a ground plane covering 30% of it, during 120 steps. The
+	AABBTree and the sweep and prune broad phases are updated at each step.
+	The test of every pair of bodies done before the broad phases is
+	measured on the final step, and its overlapping pairs must all be found
+	by the broad phases. The times are in milliseconds per step.
+*/
+
+/// Number of steps of the simulation.
+static const int32 StepCount = 120;
+
+static const real TimeStep = 1.0f / 60.0f;
+
+/// Ratio of the ground covered by the bodies.
+static const real Coverage = 0.3f;
+
+struct Body
+{
+	Vector3 _Position;
+	real _Velocity;
+};
+
+struct BenchmarkResult
+{
+	real64 _Create;
+	real64 _Step;
+	real64 _WorstStep;
+	int32 _PairCount;
+	int32 _MissingCount;
+};
+
+static AABB GetBox(const Body& body)
+{
+	const Vector3 HalfSize(0.5f, 0.5f, 0.5f);
+	return AABB(body._Position - HalfSize, body._Position + HalfSize);
+}
+
+/// Creates the bodies above the ground, the same ones for each broad phase.
+static void CreateBodies(int32 count, BaseArray<Body>& bodies)
+{
+	RandomLCG random(7);
+	real size = Math::Sqrt(count / Coverage);
+	bodies.Resize(count);
+	for (int32 i = 0; i < count; i++)
+	{
+		bodies[i]._Position = Vector3(random.RandomReal(0.0f, size), random.RandomReal(1.0f, 41.0f), random.RandomReal(0.0f, size));
+		bodies[i]._Velocity = 0.0f;
+	}
+}
+
+/// Moves the bodies until they rest on the ground.
+static void MoveBodies(BaseArray<Body>& bodies)
+{
+	for (int32 i = 0; i < bodies.Count(); i++)
+	{
+		Body& body = bodies[i];
+		if (body._Position.Y > 0.5f)
+		{
+			body._Velocity -= 9.81f * TimeStep;
+			body._Position.Y += body._Velocity * TimeStep;
+			if (body._Position.Y < 0.5f)
+			{
+				body._Position.Y = 0.5f;
+				body._Velocity = 0.0f;
+			}
+		}
+	}
+}
+
+static uint64 GetPairKey(int32 indexA, int32 indexB)
+{
+	if (indexA > indexB)
+		SE_Swap(indexA, indexB);
+	return ((uint64)indexA << 32) | (uint32)indexB;
+}
+
+static bool CompareKeys(const uint64& left, const uint64& right)
+{
+	return (left < right);
+}
+
+/// Finds the overlapping pairs by testing every pair of bodies.
+static void FindPairs(const BaseArray<Body>& bodies, BaseArray<uint64>& pairs)
+{
+	int32 count = bodies.Count();
+	BaseArray<AABB> boxes;
+	boxes.Resize(count);
+	for (int32 i = 0; i < count; i++)
+	{
+		boxes[i] = GetBox(bodies[i]);
+	}
+
+	for (int32 i = 0; i < count; i++)
+	{
+		for (int32 j = 0; j < i; j++)
+		{
+			if (boxes[i].Intersects(boxes[j]))
+			{
+				pairs.Add(GetPairKey(i, j));
+			}
+		}
+	}
+}
+
+/// Counts the expected pairs missing from the pairs of the broad phase, the pairs of the ground are ignored.
+static int32 CountMissingPairs(const BroadPhase* broadPhase, const BaseArray<uint64>& expected)
+{
+	const BaseArray<BroadPhasePair>& pairs = broadPhase->GetPairs();
+	BaseArray<uint64> found;
+	int32 i;
+	for (i = 0; i < pairs.Count(); i++)
+	{
+		// The bodies are stored from 1, the ground is 0
+		int32 indexA = (int32)(size_t)broadPhase->GetUserData(pairs[i]._ProxyA) - 1;
+		int32 indexB = (int32)(size_t)broadPhase->GetUserData(pairs[i]._ProxyB) - 1;
+		if (indexA >= 0 && indexB >= 0)
+		{
+			found.Add(GetPairKey(indexA, indexB));
+		}
+	}
+	found.Sort(CompareKeys);
+
+	int32 missingCount = 0;
+	int32 j = 0;
+	for (i = 0; i < expected.Count(); i++)
+	{
+		while (j < found.Count() && found[j] < expected[i])
+			j++;
+		if (j == found.Count() || found[j] != expected[i])
+			missingCount++;
+	}
+	return missingCount;
+}
+
+static void Benchmark(int32 count, BroadPhaseType type, BenchmarkResult& result, BaseArray<Body>& bodies)
+{
+	CreateBodies(count, bodies);
+
+	BroadPhase* broadPhase = BroadPhase::Create(type);
+	BaseArray<int32> proxies;
+	proxies.Resize(count);
+	Timer timer;
+	int32 i;
+
+	// The ground plane has no box
+	broadPhase->CreateProxy(AABB(Vector3::Zero, Vector3::Zero), NULL, true);
+
+	timer.Start();
+	for (i = 0; i < count; i++)
+	{
+		proxies[i] = broadPhase->CreateProxy(GetBox(bodies[i]), (void*)(size_t)(i + 1), false);
+	}
+	broadPhase->UpdatePairs();
+	timer.Stop();
+	result._Create = timer.Elapsed() * 1000.0;
+
+	result._Step = 0.0;
+	result._WorstStep = 0.0;
+	for (int32 step = 0; step < StepCount; step++)
+	{
+		MoveBodies(bodies);
+
+		timer.Start();
+		for (i = 0; i < count; i++)
+		{
+			broadPhase->MoveProxy(proxies[i], GetBox(bodies[i]));
+		}
+		broadPhase->UpdatePairs();
+		timer.Stop();
+
+		real64 time = timer.Elapsed() * 1000.0;
+		result._Step += time;
+		result._WorstStep = Math::Max(result._WorstStep, time);
+	}
+	result._Step /= StepCount;
+	result._PairCount = broadPhase->GetPairs().Count();
+
+	BaseArray<uint64> expected;
+	FindPairs(bodies, expected);
+	expected.Sort(CompareKeys);
+	result._MissingCount = CountMissingPairs(broadPhase, expected);
+
+	delete broadPhase;
+}
+
+int main(int argc, char** argv)
+{
+	const int32 Counts[] = { 1000, 10000, 50000 };
+	const int32 CountCount = sizeof(Counts) / sizeof(Counts[0]);
+	const BroadPhaseType Types[] = { BroadPhaseType_AABBTree, BroadPhaseType_SweepAndPrune };
+	const String TypeNames[] = { _T("AABBTree     "), _T("SweepAndPrune") };
+	int32 maxCount = 50000;
+
+	Console::WriteLine(_T("BroadPhaseBenchmark"));
+	Console::WriteLine(_T("==================="));
+
+	if (argc == 2)
+	{
+		maxCount = Math::Max(String(argv[1]).ToInt32(), Counts[0]);
+	}
+	else if (argc != 1)
+	{
+		Console::WriteLine(_T("BroadPhaseBenchmark [maxCount]"));
+		return -1;
+	}
+
+	bool result = true;
+	for (int32 c = 0; c < CountCount && Counts[c] <= maxCount; c++)
+	{
+		int32 count = Counts[c];
+		BaseArray<Body> bodies;
+		Console::WriteLine(String::ToString(count) + _T(" bodies"));
+
+		for (int32 t = 0; t < 2; t++)
+		{
+			BenchmarkResult benchmark;
+			Benchmark(count, Types[t], benchmark, bodies);
+
+			Console::WriteLine(_T("  ") + TypeNames[t] + _T(": step ") + String::ToString(benchmark._Step) +
+				_T(" ms, worst step ") + String::ToString(benchmark._WorstStep) +
+				_T(" ms, creation ") + String::ToString(benchmark._Create) +
+				_T(" ms, ") + String::ToString(benchmark._PairCount) + _T(" pairs"));
+			if (benchmark._MissingCount != 0)
+			{
+				Console::WriteLine(_T("  FAILED: ") + String::ToString(benchmark._MissingCount) + _T(" overlapping pairs are missing"));
+				result = false;
+			}
+		}
+
+		// The bodies are at their final positions
+		BaseArray<uint64> pairs;
+		Timer timer;
+		timer.Start();
+		FindPairs(bodies, pairs);
+		timer.Stop();
+		Console::WriteLine(_T("  Every pair   : step ") + String::ToString(timer.Elapsed() * 1000.0) + _T(" ms, ") +
+			String::ToString(pairs.Count()) + _T(" overlapping pairs"));
+	}
+
+	Console::WriteLine(result ? _T("All tests passed.") : _T("Some tests failed."));
+	return (result ? 0 : 1);
+}
@@ -0,0 +1,269 @@
+/*=============================================================================
+ContactSolverTest.cpp
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+#include <Core/Core.h>
+#include <PhysicsSystem_Software/ContactSolver.h>
+
+using namespace SonataEngine;
+using namespace SE_Software;
+
+/*
+	Tests of the contact solver of the software physics system.
+
+	ContactSolverTest [columns height steps]
+
+	Stacks of spheres fall on a static ground and are solved with 1, 4 and 16
+	iterations. The states of the bodies after the last step must be
+	identical, bit for bit, whatever the number of threads of the job
+	scheduler. The warm starting of a contact of which a body was destroyed
+	must not use the impulses of the previous body.
+*/
+
+static const real Radius = 0.5f;
+static const real TimeStep = 1.0f / 60.0f;
+
+struct Ball
+{
+	Vector3 _Position;
+	Vector3 _LinearVelocity;
+	Vector3 _AngularVelocity;
+};
+
+static SolverBody CreateStaticBody(const Vector3& position)
+{
+	SolverBody body;
+	body._Position = position;
+	body._LinearVelocity = Vector3::Zero;
+	body._AngularVelocity = Vector3::Zero;
+	body._InverseMass = 0.0f;
+	body._InverseInertiaTensor = Matrix3::Zero;
+	body._IsDynamic = false;
+	body._IsAwake = false;
+	body._SleepTime = 0.0f;
+	return body;
+}
+
+static SolverBody CreateBall(const Ball& ball)
+{
+	Matrix3 inverseInertia = Matrix3::Zero;
+	inverseInertia.M[0][0] = inverseInertia.M[1][1] = inverseInertia.M[2][2] = 1.0f / (0.4f * Radius * Radius);
+
+	SolverBody body;
+	body._Position = ball._Position;
+	body._LinearVelocity = ball._LinearVelocity + Vector3(0.0f, -9.81f * TimeStep, 0.0f);
+	body._AngularVelocity = ball._AngularVelocity;
+	body._InverseMass = 1.0f;
+	body._InverseInertiaTensor = inverseInertia;
+	body._IsDynamic = true;
+	body._IsAwake = true;
+	body._SleepTime = 0.0f;
+	return body;
+}
+
+static SolverContact CreateContact(uint64 pairKey, int32 bodyA, int32 bodyB,
+	const Vector3& position, const Vector3& normal, real depth)
+{
+	SolverContact contact;
+	contact._PairKey = pairKey;
+	contact._BodyA = bodyA;
+	contact._BodyB = bodyB;
+	contact._Position = position;
+	contact._Normal = normal;
+	contact._Depth = depth;
+	contact._Restitution = 0.2f;
+	contact._Friction = 0.5f;
+	return contact;
+}
+
+static void CreateStacks(BaseArray<Ball>& balls, int32 columns, int32 height)
+{
+	balls.Clear();
+	for (int32 c = 0; c < columns; c++)
+	{
+		for (int32 h = 0; h < height; h++)
+		{
+			// The spheres start slightly overlapping, with different speeds
+			Ball ball;
+			ball._Position = Vector3((c % 100) * 3.0f, Radius + h * 2.0f * Radius - 0.02f, (c / 100) * 3.0f);
+			ball._LinearVelocity = Vector3(0.0f, -0.1f * (c % 7), 0.0f);
+			ball._AngularVelocity = Vector3::Zero;
+			balls.Add(ball);
+		}
+	}
+}
+
+static void Simulate(BaseArray<Ball>& balls, int32 columns, int32 height, int32 steps, int32 iterations)
+{
+	ContactSolver solver;
+	for (int32 step = 0; step < steps; step++)
+	{
+		solver.Clear();
+		int32 ground = solver.AddBody(CreateStaticBody(Vector3::Zero));
+		int32 i;
+		for (i = 0; i < balls.Count(); i++)
+		{
+			solver.AddBody(CreateBall(balls[i]));
+		}
+
+		// The keys of the bodies are their index plus one, the ground is 0
+		for (int32 c = 0; c < columns; c++)
+		{
+			for (int32 h = 0; h < height; h++)
+			{
+				i = c * height + h;
+				const Vector3& position = balls[i]._Position;
+				if (position.Y < Radius)
+				{
+					solver.AddContact(CreateContact((uint64)(i + 1) << 32, i + 1, ground,
+						Vector3(position.X, 0.0f, position.Z), Vector3::UnitY, Radius - position.Y));
+				}
+
+				if (h + 1 < height)
+				{
+					Vector3 delta = balls[i + 1]._Position - position;
+					real distance = delta.Length();
+					if (distance < 2.0f * Radius)
+					{
+						solver.AddContact(CreateContact(((uint64)(i + 2) << 32) | (uint64)(i + 1), i + 2, i + 1,
+							position + delta * 0.5f, delta / distance, 2.0f * Radius - distance));
+					}
+				}
+			}
+		}
+
+		solver.Solve(TimeStep, iterations);
+
+		for (i = 0; i < balls.Count(); i++)
+		{
+			const SolverBody& body = solver.GetBody(i + 1);
+			balls[i]._LinearVelocity = body._LinearVelocity;
+			balls[i]._AngularVelocity = body._AngularVelocity;
+			balls[i]._Position += balls[i]._LinearVelocity * TimeStep;
+		}
+	}
+}
+
+static bool IsSameState(const BaseArray<Ball>& balls, const BaseArray<Ball>& reference)
+{
+	if (balls.Count() != reference.Count())
+		return false;
+
+	return (Memory::Compare((void*)balls.Data(), (void*)reference.Data(), balls.Count() * sizeof(Ball)) == 0);
+}
+
+static bool TestDeterminism(int32 columns, int32 height, int32 steps)
+{
+	static const int32 ThreadCounts[] = { 1, 2, 3, 4, 8 };
+	static const int32 IterationCounts[] = { 1, 4, 16 };
+	bool result = true;
+
+	for (int32 it = 0; it < 3; it++)
+	{
+		BaseArray<Ball> reference;
+		for (int32 t = 0; t < 5; t++)
+		{
+			// The calling thread is a worker of the scheduler
+			JobScheduler* scheduler = JobScheduler::Instance();
+			if (ThreadCounts[t] > 1)
+				scheduler->Create(ThreadCounts[t] - 1);
+
+			BaseArray<Ball> balls;
+			CreateStacks(balls, columns, height);
+
+			Timer timer;
+			timer.Start();
+			Simulate(balls, columns, height, steps, IterationCounts[it]);
+			timer.Stop();
+
+			if (ThreadCounts[t] > 1)
+				scheduler->Destroy();
+
+			bool isSame = true;
+			if (t == 0)
+				reference = balls;
+			else
+				isSame = IsSameState(balls, reference);
+
+			Console::WriteLine(String::ToString(IterationCounts[it]) + _T(" iterations, ") +
+				String::ToString(ThreadCounts[t]) + _T(" threads: ") +
+				String::ToString(timer.Elapsed() * 1000.0 / steps) + _T(" ms/step") +
+				(isSame ? _T("") : _T(" FAILED: the states differ from 1 thread")));
+			result &= isSame;
+		}
+	}
+
+	JobScheduler::DestroyInstance();
+	return result;
+}
+
+/// Solves one step of a body resting on the ground on two points, and returns its velocity.
+static Vector3 SolveRestingBody(ContactSolver& solver, uint64 pairKey, const Vector3& linearVelocity)
+{
+	Ball ball;
+	ball._Position = Vector3(0.0f, Radius - 0.01f, 0.0f);
+	ball._LinearVelocity = linearVelocity;
+	ball._AngularVelocity = Vector3::Zero;
+
+	solver.Clear();
+	int32 ground = solver.AddBody(CreateStaticBody(Vector3::Zero));
+	int32 body = solver.AddBody(CreateBall(ball));
+	solver.AddContact(CreateContact(pairKey, body, ground, Vector3(-0.4f, 0.0f, 0.0f), Vector3::UnitY, 0.01f));
+	solver.AddContact(CreateContact(pairKey, body, ground, Vector3(0.3f, 0.0f, 0.0f), Vector3::UnitY, 0.01f));
+	solver.Solve(TimeStep, 1);
+
+	return solver.GetBody(body)._LinearVelocity;
+}
+
+static bool TestRemoveImpulses()
+{
+	const uint32 bodyKey = 1;
+	const uint64 pairKey = (uint64)bodyKey << 32;
+	const Vector3 restingVelocity = Vector3::Zero;
+	const Vector3 fallingVelocity = Vector3(0.0f, -10.0f, 0.0f);
+
+	// Reference: the first step of a contact, without impulses to warm start
+	ContactSolver freshSolver;
+	Vector3 expected = SolveRestingBody(freshSolver, pairKey, restingVelocity);
+
+	// A falling body is destroyed and its key is reused by a resting body
+	ContactSolver solver;
+	SolveRestingBody(solver, pairKey, fallingVelocity);
+	solver.RemoveImpulses(bodyKey);
+	Vector3 velocity = SolveRestingBody(solver, pairKey, restingVelocity);
+
+	bool result = (velocity.X == expected.X && velocity.Y == expected.Y && velocity.Z == expected.Z);
+	Console::WriteLine(String(_T("Removed impulses: ")) +
+		(result ? _T("OK") : _T("FAILED: the new body was warm started")));
+	return result;
+}
+
+int main(int argc, char** argv)
+{
+	int32 columns = 200;
+	int32 height = 10;
+	int32 steps = 120;
+
+	Console::WriteLine(_T("ContactSolverTest"));
+	Console::WriteLine(_T("================="));
+
+	if (argc == 4)
+	{
+		columns = Math::Max(String(argv[1]).ToInt32(), 1);
+		height = Math::Max(String(argv[2]).ToInt32(), 1);
+		steps = Math::Max(String(argv[3]).ToInt32(), 1);
+	}
+	else if (argc != 1)
+	{
+		Console::WriteLine(_T("ContactSolverTest [columns height steps]"));
+		return -1;
+	}
+
+	bool result = TestDeterminism(columns, height, steps);
+	result &= TestRemoveImpulses();
+
+	Console::WriteLine(result ? _T("All tests passed.") : _T("Some tests failed."));
+	return (result ? 0 : 1);
+}
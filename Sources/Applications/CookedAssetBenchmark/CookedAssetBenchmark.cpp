@@ -0,0 +1,734 @@
+/*=============================================================================
+CookedAssetBenchmark.cpp
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+#include <Core/Core.h>
+#include <Core/Engine.h>
+#include <Graphics/Graphics.h>
+#include <Plugins.h>
+
+using namespace SonataEngine;
+
+/*
+	Tests and benchmark of the cooked asset containers.
+
+	CookedAssetBenchmark [gridSize repeatCount]
+
+	A model, an image and a height field are written as source files: an OBJ
+	of a grid of gridSize x gridSize quads (400 by default, 320000 triangles
+	and 32 MB), a 2048x2048 32 bpp TGA and a 1025x1025 int16 RAW. They are
+	loaded with the OBJ and image data plugins and HeightField::LoadFromRAW,
+	then cooked in a container.
+
+	The tests check the container read back from a stream and mapped from its
+	file, the copy-on-write of the mapped pixels and heights, the rejection of
+	a bad magic number and of the truncated containers, and load mutated
+	containers, creating the assets of those accepted.
+
+	The benchmark loads the three assets from the source files, from the
+	container read at once from a file stream, and from the container mapped
+	from its file. The times are the medians of the loads (5 by default) in
+	milliseconds, after a first load bringing the files in the system cache,
+	and each load is checked against the checksum of the source assets.
+	The memory used by each path is not measured, it needs the platform
+	process counters.
+*/
+
+static const String ModelFileName = _T("CookedAssetBenchmark.obj");
+static const String ImageFileName = _T("CookedAssetBenchmark.tga");
+static const String HeightFieldFileName = _T("CookedAssetBenchmark.raw");
+static const String CookedFileName = _T("CookedAssetBenchmark.seck");
+static const String SmallModelFileName = _T("CookedAssetBenchmarkSmall.obj");
+
+static const int32 ImageSize = 2048;
+static const int32 HeightFieldSize = 1025;
+
+/// Size of the assets of the container mutated by the tests.
+static const int32 SmallAssetSize = 8;
+
+/// Number of mutated containers loaded by the tests.
+static const int32 MutationCount = 300;
+
+enum LoadPath
+{
+	LoadPath_Source,
+	LoadPath_Stream,
+	LoadPath_Mapped,
+	LoadPath_Count
+};
+
+static const SEchar* LoadPathNames[] = { _T("source files    "), _T("cooked, stream  "), _T("cooked, mapped  ") };
+
+/// Assets loaded by a path of the benchmark.
+struct Assets
+{
+	Model* _Model;
+	Image* _Image;
+	HeightFieldPtr _HeightField;
+
+	Assets() :
+		_Model(NULL),
+		_Image(NULL)
+	{
+	}
+
+	~Assets()
+	{
+		SE_DELETE(_Model);
+		SE_DELETE(_Image);
+	}
+
+	bool IsValid() const
+	{
+		return (_Model != NULL && _Image != NULL && _HeightField != NULL);
+	}
+};
+
+static bool Check(bool value, const String& message)
+{
+	if (!value)
+		Console::WriteLine(_T("  FAILED: ") + message);
+	return value;
+}
+
+static bool CompareTimes(const real64& left, const real64& right)
+{
+	return (left < right);
+}
+
+static ManagerPlugin* FindRenderSystemPlugin()
+{
+	ManagerPlugin* renderPlugin;
+
+	renderPlugin = (ManagerPlugin*)PluginManager::Instance()->GetPluginByID(SE_ID_RENDERSYSTEM_D3D9);
+	if (renderPlugin != NULL)
+		return renderPlugin;
+
+	renderPlugin = (ManagerPlugin*)PluginManager::Instance()->GetPluginByID(SE_ID_RENDERSYSTEM_D3D8);
+	if (renderPlugin != NULL)
+		return renderPlugin;
+
+	renderPlugin = (ManagerPlugin*)PluginManager::Instance()->GetPluginByID(SE_ID_RENDERSYSTEM_GL);
+	if (renderPlugin != NULL)
+		return renderPlugin;
+
+	return NULL;
+}
+
+static bool CreateRenderSystem(Window* window)
+{
+	ManagerPlugin* renderPlugin = FindRenderSystemPlugin();
+	if (renderPlugin == NULL)
+	{
+		Console::Error()->WriteLine(_T("Failed to get the render system plugin."));
+		return false;
+	}
+
+	RenderSystem* renderSystem = (RenderSystem*)renderPlugin->CreateManager();
+	if (renderSystem == NULL)
+	{
+		Console::Error()->WriteLine(_T("Failed to create the render system."));
+		return false;
+	}
+
+	renderSystem->Create();
+	RenderSystem::SetCurrent(renderSystem);
+
+	// The hardware buffers need a render context
+	window->Create(_T("CookedAssetBenchmark"), 0, 0, 64, 64);
+	RenderContextDescription desc;
+	desc.Mode.SetWidth(window->GetClientWidth());
+	desc.Mode.SetHeight(window->GetClientHeight());
+
+	return renderSystem->CreateRenderContext(window, desc);
+}
+
+static FileStreamPtr OpenFile(const String& fileName, bool isWriting)
+{
+	File file(fileName);
+	if (isWriting)
+		return file.Open(FileMode_Create, FileAccess_Write, FileShare_None);
+	else
+		return file.Open(FileMode_Open, FileAccess_Read, FileShare_Read);
+}
+
+static void WriteLine(Stream* stream, const String& line)
+{
+	String value = line + _T("\n");
+	stream->Write((const SEbyte*)value.Data(), value.Length() * sizeof(SEchar));
+}
+
+/// Writes a grid of quads with positions, normals and texture coordinates.
+static void WriteModel(const String& fileName, int32 gridSize)
+{
+	FileStreamPtr stream = OpenFile(fileName, true);
+	int32 x, y;
+
+	for (y = 0; y <= gridSize; y++)
+	{
+		for (x = 0; x <= gridSize; x++)
+		{
+			real32 height = Math::Sin(x * 0.05f) * Math::Cos(y * 0.05f);
+			WriteLine(stream, _T("v ") + String::ToString(x * 0.1f) + _T(" ") + String::ToString(height) + _T(" ") + String::ToString(y * 0.1f));
+		}
+	}
+	for (y = 0; y <= gridSize; y++)
+		for (x = 0; x <= gridSize; x++)
+			WriteLine(stream, _T("vn 0.0 1.0 0.0"));
+	for (y = 0; y <= gridSize; y++)
+	{
+		for (x = 0; x <= gridSize; x++)
+		{
+			WriteLine(stream, _T("vt ") + String::ToString((real32)x / gridSize) + _T(" ") + String::ToString((real32)y / gridSize));
+		}
+	}
+
+	for (y = 0; y < gridSize; y++)
+	{
+		for (x = 0; x < gridSize; x++)
+		{
+			String a = String::ToString(y * (gridSize + 1) + x + 1);
+			String b = String::ToString(y * (gridSize + 1) + x + 2);
+			String c = String::ToString((y + 1) * (gridSize + 1) + x + 1);
+			String d = String::ToString((y + 1) * (gridSize + 1) + x + 2);
+			a = a + _T("/") + a + _T("/") + a;
+			b = b + _T("/") + b + _T("/") + b;
+			c = c + _T("/") + c + _T("/") + c;
+			d = d + _T("/") + d + _T("/") + d;
+			WriteLine(stream, _T("f ") + a + _T(" ") + b + _T(" ") + d);
+			WriteLine(stream, _T("f ") + a + _T(" ") + d + _T(" ") + c);
+		}
+	}
+}
+
+/// Writes an uncompressed 32 bpp TGA.
+static void WriteImage(const String& fileName, int32 size)
+{
+	FileStreamPtr stream = OpenFile(fileName, true);
+
+	SEbyte header[18];
+	Memory::Set(header, 0, sizeof(header));
+	header[2] = 2;
+	header[12] = (SEbyte)(size & 0xFF);
+	header[13] = (SEbyte)(size >> 8);
+	header[14] = (SEbyte)(size & 0xFF);
+	header[15] = (SEbyte)(size >> 8);
+	header[16] = 32;
+	stream->Write(header, sizeof(header));
+
+	BaseArray<SEbyte> row;
+	row.Resize(size * 4);
+	for (int32 y = 0; y < size; y++)
+	{
+		for (int32 i = 0; i < size * 4; i++)
+			row[i] = (SEbyte)((y * size * 4 + i) * 7);
+		stream->Write(row.Data(), size * 4);
+	}
+}
+
+static void WriteHeightField(const String& fileName, int32 size)
+{
+	FileStreamPtr stream = OpenFile(fileName, true);
+	BaseArray<int16> row;
+	row.Resize(size);
+	for (int32 y = 0; y < size; y++)
+	{
+		for (int32 x = 0; x < size; x++)
+			row[x] = (int16)((y * size + x) % 3000);
+		stream->Write((const SEbyte*)row.Data(), size * sizeof(int16));
+	}
+}
+
+static Model* LoadModel(const String& fileName)
+{
+	ModelDataPlugin* plugin = (ModelDataPlugin*)PluginManager::Instance()->GetPluginByID(SE_ID_DATAMODEL_OBJ);
+	if (plugin == NULL)
+		return NULL;
+
+	FileStreamPtr stream = OpenFile(fileName, false);
+	if (stream == NULL)
+		return NULL;
+
+	ModelReader* reader = plugin->CreateReader();
+	if (reader == NULL)
+		return NULL;
+
+	Model* model = reader->LoadModel(*stream);
+	plugin->DestroyReader(reader);
+	return model;
+}
+
+static Image* LoadImage(const String& fileName)
+{
+	ImageDataPlugin* plugin = (ImageDataPlugin*)PluginManager::Instance()->GetPluginByID(SE_ID_DATAIMAGE_DEVIL);
+	if (plugin == NULL)
+		return NULL;
+
+	FileStreamPtr stream = OpenFile(fileName, false);
+	if (stream == NULL)
+		return NULL;
+
+	ImageReader* reader = plugin->CreateReader();
+	if (reader == NULL)
+		return NULL;
+
+	Image* image = reader->LoadImage(*stream);
+	plugin->DestroyReader(reader);
+	return image;
+}
+
+static HeightField* LoadHeightField(const String& fileName, int32 size)
+{
+	FileStreamPtr stream = OpenFile(fileName, false);
+	if (stream == NULL)
+		return NULL;
+
+	HeightField* heightField = new HeightField();
+	if (!heightField->LoadFromRAW(*stream, size, size, HeightFieldFormat_Int16))
+	{
+		delete heightField;
+		return NULL;
+	}
+	return heightField;
+}
+
+static void CreateAssets(CookedAsset* asset, Assets& assets)
+{
+	assets._Model = asset->CreateModel(asset->FindAsset(CookedAssetType_Model));
+	assets._Image = asset->CreateImage(asset->FindAsset(CookedAssetType_Image));
+	assets._HeightField = asset->CreateHeightField(asset->FindAsset(CookedAssetType_HeightField));
+}
+
+static bool Load(LoadPath path, Assets& assets)
+{
+	if (path == LoadPath_Source)
+	{
+		assets._Model = LoadModel(ModelFileName);
+		assets._Image = LoadImage(ImageFileName);
+		assets._HeightField = LoadHeightField(HeightFieldFileName, HeightFieldSize);
+		return assets.IsValid();
+	}
+
+	// The image and the height field keep the container
+	CookedAssetPtr asset = new CookedAsset();
+	if (path == LoadPath_Stream)
+	{
+		FileStreamPtr stream = OpenFile(CookedFileName, false);
+		if (stream == NULL || !asset->Load(*stream))
+			return false;
+	}
+	else
+	{
+		if (!asset->Open(CookedFileName))
+			return false;
+	}
+
+	CreateAssets(asset, assets);
+	return assets.IsValid();
+}
+
+/// FNV-1a hash of a range of bytes.
+static uint64 HashBytes(uint64 hash, const void* data, uint32 size)
+{
+	const SEbyte* bytes = (const SEbyte*)data;
+	for (uint32 i = 0; i < size; i++)
+	{
+		hash ^= bytes[i];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+static uint64 HashValue(uint64 hash, uint32 value)
+{
+	return HashBytes(hash, &value, sizeof(value));
+}
+
+static uint64 HashBuffer(uint64 hash, HardwareBuffer* buffer)
+{
+	if (buffer == NULL)
+		return HashValue(hash, 0);
+
+	void* data;
+	if (!buffer->Map(HardwareBufferMode_ReadOnly, &data))
+		return HashValue(hash, 1);
+
+	hash = HashBytes(hash, data, buffer->GetSize());
+	buffer->Unmap();
+	return hash;
+}
+
+static uint64 HashVertexData(uint64 hash, VertexData* vertexData)
+{
+	if (vertexData == NULL)
+		return HashValue(hash, 0);
+
+	hash = HashValue(hash, vertexData->VertexCount);
+	hash = HashValue(hash, vertexData->VertexLayout->GetSize());
+	for (int32 i = 0; i < vertexData->VertexStreams.Count(); i++)
+	{
+		hash = HashValue(hash, vertexData->VertexStreams[i].Stride);
+		hash = HashBuffer(hash, vertexData->VertexStreams[i].VertexBuffer);
+	}
+	return hash;
+}
+
+static uint64 HashIndexData(uint64 hash, IndexData* indexData)
+{
+	if (indexData == NULL)
+		return HashValue(hash, 0);
+
+	hash = HashValue(hash, indexData->IndexCount);
+	return HashBuffer(hash, indexData->IndexBuffer);
+}
+
+/// Returns a checksum of the vertices, indices, pixels and heights of the assets.
+static uint64 Checksum(const Assets& assets)
+{
+	uint64 hash = 14695981039346656037ULL;
+
+	Model* model = assets._Model;
+	hash = HashValue(hash, model->GetMeshCount());
+	for (int32 i = 0; i < model->GetMeshCount(); i++)
+	{
+		Mesh* mesh = model->GetMeshByIndex(i);
+		hash = HashVertexData(hash, mesh->GetVertexData());
+		hash = HashIndexData(hash, mesh->GetIndexData());
+		for (int32 j = 0; j < mesh->GetMeshPartCount(); j++)
+		{
+			MeshPart* meshPart = mesh->GetMeshPart(j);
+			hash = HashValue(hash, meshPart->GetPrimitiveType());
+			hash = HashValue(hash, meshPart->GetPrimitiveCount());
+			hash = HashValue(hash, meshPart->GetStartVertex());
+			hash = HashValue(hash, meshPart->GetStartIndex());
+			hash = HashVertexData(hash, meshPart->GetVertexData());
+			hash = HashIndexData(hash, meshPart->GetIndexData());
+		}
+	}
+
+	Image* image = assets._Image;
+	hash = HashValue(hash, image->GetFormat());
+	hash = HashValue(hash, image->GetWidth());
+	hash = HashValue(hash, image->GetHeight());
+	hash = HashBytes(hash, image->GetData(), image->GetDataSize());
+
+	HeightField* heightField = assets._HeightField;
+	hash = HashValue(hash, heightField->GetWidth());
+	hash = HashValue(hash, heightField->GetHeight());
+	hash = HashBytes(hash, heightField->GetData(), heightField->GetWidth() * heightField->GetHeight() * sizeof(real32));
+
+	return hash;
+}
+
+static bool Cook(const String& fileName, Model* model, Image* image, HeightField* heightField)
+{
+	CookedAssetWriter writer;
+	if (!writer.AddModel(model) || !writer.AddImage(image) || !writer.AddHeightField(heightField))
+		return false;
+
+	FileStreamPtr stream = OpenFile(fileName, true);
+	return (stream != NULL && writer.Save(*stream));
+}
+
+/// Reads a file in a buffer allocated with new[].
+static SEbyte* ReadFile(const String& fileName, int32& length)
+{
+	FileStreamPtr stream = OpenFile(fileName, false);
+	length = (int32)stream->GetLength();
+	SEbyte* buffer = new SEbyte[length];
+	if (stream->Read(buffer, length) != length)
+	{
+		delete[] buffer;
+		return NULL;
+	}
+	return buffer;
+}
+
+/// Loads a copy of a container, returns the number of assets created or -1 if it is rejected.
+static int32 LoadCopy(const SEbyte* data, int32 length)
+{
+	SEbyte* buffer = new SEbyte[Math::Max(length, 1)];
+	Memory::Copy(buffer, (void*)data, length);
+
+	CookedAssetPtr asset = new CookedAsset();
+	if (!asset->Load(buffer, length))
+		return -1;
+
+	int32 count = 0;
+	for (int32 i = 0; i < asset->GetAssetCount(); i++)
+	{
+		switch (asset->GetAssetType(i))
+		{
+		case CookedAssetType_Model:
+			{
+				Model* model = asset->CreateModel(i);
+				count += (model != NULL ? 1 : 0);
+				SE_DELETE(model);
+			}
+			break;
+
+		case CookedAssetType_Image:
+			{
+				Image* image = asset->CreateImage(i);
+				count += (image != NULL ? 1 : 0);
+				SE_DELETE(image);
+			}
+			break;
+
+		case CookedAssetType_HeightField:
+			{
+				HeightFieldPtr heightField = asset->CreateHeightField(i);
+				count += (heightField != NULL ? 1 : 0);
+			}
+			break;
+		}
+	}
+	return count;
+}
+
+static bool TestContainer(uint64 expected)
+{
+	bool result = true;
+
+	{
+		FileStreamPtr stream = OpenFile(CookedFileName, false);
+		result &= Check(CookedAsset::CanRead(*stream) && stream->GetPosition() == 0, _T("the cooked file is not recognized"));
+		stream = OpenFile(ModelFileName, false);
+		result &= Check(!CookedAsset::CanRead(*stream), _T("a source file is recognized as cooked"));
+	}
+
+	{
+		CookedAssetPtr asset = new CookedAsset();
+		FileStreamPtr stream = OpenFile(CookedFileName, false);
+		result &= Check(asset->Load(*stream) && !asset->IsMapped(), _T("the cooked file is not read"));
+		result &= Check(asset->GetAssetCount() == 3 && asset->GetAssetType(0) == CookedAssetType_Model &&
+			asset->GetAssetType(1) == CookedAssetType_Image && asset->GetAssetType(2) == CookedAssetType_HeightField,
+			_T("wrong assets"));
+		result &= Check(asset->CreateModel(1) == NULL && asset->CreateImage(3) == NULL && asset->CreateHeightField(-1) == NULL,
+			_T("an asset created from a wrong index"));
+	}
+
+	// The pixels and the heights written in a mapped container are not written to the file
+	{
+		Assets assets;
+		result &= Check(Load(LoadPath_Mapped, assets), _T("the cooked file is not mapped"));
+		if (assets.IsValid())
+		{
+			result &= Check(Checksum(assets) == expected, _T("wrong checksum of the mapped assets"));
+			assets._Image->GetData()[0] ^= 0xFF;
+			assets._HeightField->GetData()[0] += 1.0f;
+			result &= Check(Checksum(assets) != expected, _T("the mapped assets are not modified"));
+		}
+
+		Assets reloaded;
+		result &= Check(Load(LoadPath_Stream, reloaded) && Checksum(reloaded) == expected, _T("the mapped assets are written to the file"));
+	}
+
+	int32 length;
+	SEbyte* data = ReadFile(CookedFileName, length);
+	result &= Check(data != NULL, _T("the cooked file is not read"));
+	if (data != NULL)
+	{
+		result &= Check(LoadCopy(data, length) == 3, _T("the cooked buffer is not loaded"));
+		result &= Check(LoadCopy(data, length / 2) < 0 && LoadCopy(data, 8) < 0 && LoadCopy(data, 0) < 0, _T("a truncated container is loaded"));
+
+		data[0] ^= 0xFF;
+		result &= Check(LoadCopy(data, length) < 0, _T("a container of a bad magic number is loaded"));
+		delete[] data;
+	}
+
+	return result;
+}
+
+/// Loads mutated copies of a small container, which must be rejected or give valid assets.
+static bool TestMutations()
+{
+	bool result = true;
+
+	WriteModel(SmallModelFileName, SmallAssetSize);
+	Model* model = LoadModel(SmallModelFileName);
+	Image* image = new Image();
+	image->Create(PixelFormat_R8G8B8A8, SmallAssetSize, SmallAssetSize);
+	Memory::Set(image->GetData(), 0x80, image->GetDataSize());
+	HeightFieldPtr heightField = new HeightField();
+	heightField->Create(SmallAssetSize + 1, SmallAssetSize + 1, HeightFieldFormat_Real);
+	Memory::Set(heightField->GetData(), 0, (SmallAssetSize + 1) * (SmallAssetSize + 1) * sizeof(real32));
+
+	String fileName = SmallModelFileName + _T(".seck");
+	result &= Check(model != NULL && Cook(fileName, model, image, heightField), _T("the small container is not cooked"));
+	SE_DELETE(model);
+	SE_DELETE(image);
+	heightField = NULL;
+
+	int32 length;
+	SEbyte* data = ReadFile(fileName, length);
+	File::Delete(fileName);
+	File::Delete(SmallModelFileName);
+	if (!result || data == NULL)
+	{
+		delete[] data;
+		return false;
+	}
+
+	result &= Check(LoadCopy(data, length) == 3, _T("the small container is not loaded"));
+
+	BaseArray<SEbyte> mutation;
+	mutation.Resize(length);
+	RandomLCG random(1);
+	int32 accepted = 0;
+	for (int32 i = 0; i < MutationCount; i++)
+	{
+		Memory::Copy(mutation.Data(), data, length);
+		int32 mutationLength = length;
+
+		switch (i % 3)
+		{
+		case 0:
+			// Random bytes
+			{
+				int32 count = random.RandomInt(1, 4);
+				for (int32 j = 0; j < count; j++)
+					mutation[random.RandomInt(0, length - 1)] = (SEbyte)random.RandomInt(0, 255);
+			}
+			break;
+
+		case 1:
+			// A random aligned word, where the offsets and the sizes are
+			{
+				int32 offset = random.RandomInt(0, length / 8 - 1) * 8;
+				int32 value = random.RandomInt();
+				Memory::Copy(mutation.Data() + offset, &value, sizeof(value));
+			}
+			break;
+
+		case 2:
+			// Truncated
+			mutationLength = random.RandomInt(0, length - 1);
+			break;
+		}
+
+		if (LoadCopy(mutation.Data(), mutationLength) >= 0)
+			accepted++;
+	}
+	delete[] data;
+
+	Console::WriteLine(_T("  ") + String::ToString(MutationCount) + _T(" mutated containers of ") + String::ToString(length) +
+		_T(" bytes, ") + String::ToString(accepted) + _T(" accepted"));
+	return result;
+}
+
+/// Returns the median time of the loads in milliseconds.
+static real64 Measure(LoadPath path, int32 repeatCount, uint64 expected, bool& isValid)
+{
+	BaseArray<real64> times;
+	Timer timer;
+	isValid = true;
+	for (int32 i = 0; i <= repeatCount; i++)
+	{
+		Assets assets;
+		timer.Start();
+		bool isLoaded = Load(path, assets);
+		timer.Stop();
+
+		isValid &= (isLoaded && Checksum(assets) == expected);
+
+		// The first load brings the files in the system cache
+		if (i > 0)
+			times.Add(timer.Elapsed() * 1000.0);
+	}
+	times.Sort(CompareTimes);
+	return times[repeatCount / 2];
+}
+
+int main(int argc, char** argv)
+{
+	int32 gridSize = 400;
+	int32 repeatCount = 5;
+
+	Engine::Instance();
+
+	Console::WriteLine(_T("CookedAssetBenchmark"));
+	Console::WriteLine(_T("===================="));
+
+	if (argc == 3)
+	{
+		gridSize = Math::Max(String(argv[1]).ToInt32(), 1);
+		repeatCount = Math::Max(String(argv[2]).ToInt32(), 1);
+	}
+	else if (argc != 1)
+	{
+		Console::WriteLine(_T("CookedAssetBenchmark [gridSize repeatCount]"));
+		return -1;
+	}
+
+	TextStreamLogHandler* consoleHandler = new TextStreamLogHandler(ConsoleStream::StandardOutput);
+	((DefaultLogFormatter*)consoleHandler->GetFormatter())->SetOptions(
+		(LogOptions)(LogOptions_None));
+
+	Logger* logger = new Logger();
+	logger->GetHandlers().Add(consoleHandler);
+	Logger::SetCurrent(logger);
+
+#ifndef SE_STATIC
+	PluginManager::Instance()->ParsePlugins(Environment::GetCurrentDirectory());
+#endif
+	PluginManager::Instance()->CreateAllPlugins();
+
+	Window window;
+	if (!CreateRenderSystem(&window))
+	{
+		Console::Error()->WriteLine(_T("Failed to create the render context."));
+		return -1;
+	}
+
+	WriteModel(ModelFileName, gridSize);
+	WriteImage(ImageFileName, ImageSize);
+	WriteHeightField(HeightFieldFileName, HeightFieldSize);
+
+	bool result = true;
+	uint64 expected = 0;
+	{
+		Assets assets;
+		result &= Check(Load(LoadPath_Source, assets), _T("the source files are not loaded"));
+		if (assets.IsValid())
+		{
+			expected = Checksum(assets);
+			result &= Check(Cook(CookedFileName, assets._Model, assets._Image, assets._HeightField), _T("the assets are not cooked"));
+		}
+	}
+
+	if (result)
+	{
+		Console::WriteLine(_T("Tests"));
+		result &= TestContainer(expected);
+		result &= TestMutations();
+
+		FileStreamPtr stream = OpenFile(CookedFileName, false);
+		Console::WriteLine(_T("OBJ of ") + String::ToString(gridSize * gridSize * 2) + _T(" triangles, ") +
+			String::ToString(ImageSize) + _T("x") + String::ToString(ImageSize) + _T(" TGA, ") +
+			String::ToString(HeightFieldSize) + _T("x") + String::ToString(HeightFieldSize) + _T(" RAW, cooked in ") +
+			String::ToString((real64)stream->GetLength() / (1024.0 * 1024.0)) + _T(" MB"));
+		stream = NULL;
+
+		for (int32 path = 0; path < LoadPath_Count; path++)
+		{
+			bool isValid;
+			real64 time = Measure((LoadPath)path, repeatCount, expected, isValid);
+			Console::WriteLine(_T("  ") + String(LoadPathNames[path]) + _T(": ") + String::ToString(time) + _T(" ms"));
+			result &= Check(isValid, String(LoadPathNames[path]) + _T(": wrong checksum of the assets"));
+		}
+	}
+
+	File::Delete(ModelFileName);
+	File::Delete(ImageFileName);
+	File::Delete(HeightFieldFileName);
+	File::Delete(CookedFileName);
+
+	RenderSystem::Current()->Destroy();
+	Engine::DestroyInstance();
+
+	Console::WriteLine(result ? _T("All tests passed.") : _T("Some tests failed."));
+	return (result ? 0 : 1);
+}
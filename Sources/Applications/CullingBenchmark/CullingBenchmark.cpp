@@ -0,0 +1,174 @@
+/*=============================================================================
+CullingBenchmark.cpp
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+#include <Core/Core.h>
+
+using namespace SonataEngine;
+
+/*
+	Benchmark of the visibility culling loop of the scene manager.
+
+	CullingBenchmark [objectCount] [frameCount]
+
+	The objects (100K by default) are scattered around the camera and culled
+	against its frustum for each frame (100 by default), like the loop of
+	SceneManager::BuildVisibilityList. The times are in nanoseconds per object.
+*/
+
+/// Object of the scene, with the members read by the culling loop.
+struct CullObject
+{
+	bool _Visible;
+	BoundingSphere _WorldBound;
+	Vector3 _WorldPosition;
+};
+
+struct CullResult
+{
+	CullObject* _Object;
+	real _DistanceFromCamera;
+};
+
+typedef BaseArray<CullObject*> CullObjectList;
+typedef BaseArray<CullResult> CullResultList;
+
+static real DistanceFromCamera(const Vector3& cameraPos, const CullObject* object)
+{
+	return (object->_WorldPosition - cameraPos).Length() - object->_WorldBound.Radius;
+}
+
+/**
+	Culls the objects through the IList interface, like the loop did before
+	the arrays were devirtualized: each Count and GetItem is a virtual call.
+*/
+static void CullList(const IList<CullObject*>& objects, const Frustum& frustum,
+	const Vector3& cameraPos, CullResultList& results)
+{
+	CullResult result;
+	for (int32 i = 0; i < objects.Count(); ++i)
+	{
+		CullObject* object = objects.GetItem(i);
+		if (!object->_Visible)
+			continue;
+
+		if (!frustum.Intersects(object->_WorldBound))
+			continue;
+
+		result._Object = object;
+		result._DistanceFromCamera = DistanceFromCamera(cameraPos, object);
+		results.Add(result);
+	}
+}
+
+/**
+	Culls the objects over the contiguous elements of the array, like the
+	current loop of the scene manager.
+*/
+static void CullArray(const CullObjectList& objects, const Frustum& frustum,
+	const Vector3& cameraPos, CullResultList& results)
+{
+	int32 count = objects.Count();
+	CullObject* const* data = objects.Data();
+
+	CullResult result;
+	for (int32 i = 0; i < count; ++i)
+	{
+		CullObject* object = data[i];
+		if (!object->_Visible)
+			continue;
+
+		if (!frustum.Intersects(object->_WorldBound))
+			continue;
+
+		result._Object = object;
+		result._DistanceFromCamera = DistanceFromCamera(cameraPos, object);
+		results.Add(result);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	int32 objectCount = 100000;
+	int32 frameCount = 100;
+	int32 i, frame;
+
+	Console::WriteLine(_T("CullingBenchmark"));
+	Console::WriteLine(_T("================"));
+
+	if (argc > 3)
+	{
+		Console::WriteLine(_T("CullingBenchmark [objectCount] [frameCount]"));
+		return -1;
+	}
+	if (argc > 1)
+	{
+		objectCount = Math::Max(String(argv[1]).ToInt32(), 1);
+	}
+	if (argc > 2)
+	{
+		frameCount = Math::Max(String(argv[2]).ToInt32(), 1);
+	}
+
+	// The objects are allocated separately, as the nodes of a scene
+	RandomLCG random(1);
+	CullObjectList objects;
+	objects.SetCapacity(objectCount);
+	for (i = 0; i < objectCount; i++)
+	{
+		CullObject* object = new CullObject();
+		object->_Visible = (i % 10 != 0);
+		object->_WorldPosition = Vector3(random.RandomReal(-500, 500),
+			random.RandomReal(-500, 500), random.RandomReal(-500, 500));
+		object->_WorldBound = BoundingSphere(object->_WorldPosition, random.RandomReal(1, 10));
+		objects.Add(object);
+	}
+
+	const Frustum frustum(Matrix4::CreatePerspective(Math::PiByFour, 4.0f / 3.0f, 1.0f, 1000.0f));
+	const Vector3 cameraPos = Vector3::Zero;
+	ListAdapter<CullObject*> list(&objects);
+
+	CullResultList results;
+	results.SetCapacity(objectCount);
+	int32 listVisible = 0;
+	int32 arrayVisible = 0;
+	Timer timer;
+
+	timer.Start();
+	for (frame = 0; frame < frameCount; frame++)
+	{
+		results.Clear();
+		CullList(list, frustum, cameraPos, results);
+		listVisible += results.Count();
+	}
+	timer.Stop();
+	real64 listTime = timer.Elapsed();
+
+	timer.Start();
+	for (frame = 0; frame < frameCount; frame++)
+	{
+		results.Clear();
+		CullArray(objects, frustum, cameraPos, results);
+		arrayVisible += results.Count();
+	}
+	timer.Stop();
+	real64 arrayTime = timer.Elapsed();
+
+	real64 scale = 1.0e9 / ((real64)objectCount * frameCount);
+	Console::WriteLine(String::ToString(objectCount) + _T(" objects, ") +
+		String::ToString(results.Count()) + _T(" visible"));
+	Console::WriteLine(_T("  IList (before): ") + String::ToString(listTime * scale) + _T(" ns"));
+	Console::WriteLine(_T("  Data (after)  : ") + String::ToString(arrayTime * scale) + _T(" ns"));
+
+	for (i = 0; i < objectCount; i++)
+	{
+		delete objects[i];
+	}
+
+	// Both loops must keep the same objects
+	bool result = (listVisible == arrayVisible);
+	Console::WriteLine(result ? _T("All tests passed.") : _T("Some tests failed."));
+	return (result ? 0 : 1);
+}
@@ -0,0 +1,279 @@
+/*=============================================================================
+FSMBenchmark.cpp
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+#include <Core/Core.h>
+#include <AI/AI.h>
+
+using namespace SonataEngine;
+using namespace SonataEngine::AI;
+
+/*
+	Benchmark of the compiled state machines.
+
+	FSMBenchmark [agentCount frameCount workerCount]
+
+	Each agent (10K by default) has a state machine with 4 states and 20
+	transitions per state, testing up to 2 of 64 sensor symbols, and enter
+	and exit actions setting the symbols. Half of the symbols are in the
+	symbol table, the others are only used by the conditions and the
+	actions. At each frame (100 by default), 2 random sensor symbols of each
+	agent change, then the agents are updated with FSM::Update, with
+	FSMAgentBatch::Update, and with FSMAgentBatch::ParallelUpdate on the
+	JobScheduler with 1 worker by default. The times are in milliseconds per
+	frame. The states and the symbols of both batches must match the state
+	machines of the agents at every frame.
+*/
+
+static const int32 StateCount = 4;
+static const int32 TransitionCount = 20;
+static const int32 SymbolCount = 64;
+
+/// Number of sensor symbols changing per agent and per frame.
+static const int32 ChangeCount = 2;
+
+static const int32 MachineSeed = 7;
+
+struct SymbolChange
+{
+	int32 _Symbol;
+	bool _Value;
+};
+
+static int32 GetRandomIndex(RandomLCG& random, int32 count)
+{
+	return Math::Min((int32)random.RandomReal(0.0f, (real)count), count - 1);
+}
+
+static SymbolAction* CreateAction(FSM* machine, const String& symbol, bool value)
+{
+	SymbolAction* action = new SymbolAction();
+	action->SetMachine(machine);
+	action->Symbol = symbol;
+	action->Value = value;
+	return action;
+}
+
+/// Creates a state machine, the same one for a given seed.
+static FSM* CreateMachine(const BaseArray<String>& symbols, int32 seed)
+{
+	RandomLCG random(seed);
+	FSM* machine = new FSM();
+
+	SymbolTable* table = new SymbolTable();
+	table->SetMachine(machine);
+	machine->SetSymbolTable(table);
+	int32 i, j, k;
+	for (i = 0; i < SymbolCount / 2; i++)
+	{
+		table->AddSymbol(Symbol(symbols[i], i % 3 == 0));
+	}
+
+	BaseArray<State*> states;
+	for (i = 0; i < StateCount; i++)
+	{
+		State* state = new State();
+		state->SetMachine(machine);
+		for (k = 0; k < 3; k++)
+			state->EnterActions.Add(CreateAction(machine, symbols[GetRandomIndex(random, SymbolCount)], false));
+		state->ExitActions.Add(CreateAction(machine, symbols[GetRandomIndex(random, SymbolCount)], random.RandomReal() < 0.5f));
+		machine->States.Add(state);
+		states.Add(state);
+	}
+	machine->SetStartState(states[0]);
+
+	for (i = 0; i < StateCount; i++)
+	{
+		for (j = 0; j < TransitionCount; j++)
+		{
+			// The transitions without condition never fire
+			Transition* transition = new Transition();
+			transition->SetMachine(machine);
+			transition->SetStates(states[i], states[GetRandomIndex(random, StateCount)]);
+			int32 conditionCount = GetRandomIndex(random, 3);
+			for (k = 0; k < conditionCount; k++)
+			{
+				SymbolCondition* condition = new SymbolCondition(symbols[GetRandomIndex(random, SymbolCount)], random.RandomReal() < 0.875f);
+				condition->SetMachine(machine);
+				transition->Conditions.Add(condition);
+			}
+			machine->Transitions.Add(transition);
+		}
+	}
+
+	// A transition of the start state declared after the others
+	Transition* transition = new Transition();
+	transition->SetMachine(machine);
+	transition->SetStates(states[0], states[1]);
+	SymbolCondition* condition = new SymbolCondition(symbols[SymbolCount - 1], true);
+	condition->SetMachine(machine);
+	transition->Conditions.Add(condition);
+	machine->Transitions.Add(transition);
+
+	machine->SetCurrentState(machine->GetStartState());
+	return machine;
+}
+
+/// Gets the compiled index of the current state of a machine built like the compiled one.
+static int32 GetStateIndex(const CompiledFSM* compiled, FSM* machine)
+{
+	for (int32 i = 0; i < machine->States.Count(); i++)
+	{
+		if (machine->States[i] == machine->GetCurrentState())
+			return compiled->GetStateIndex(compiled->GetMachine()->States[i]);
+	}
+	return CompiledFSM::NullState;
+}
+
+/// Counts the agents whose batch state or symbols differ from their state machine.
+static int32 CountMismatches(const BaseArray<FSMPtr>& machines, const CompiledFSM* compiled,
+	const FSMAgentBatch& batch, const BaseArray<String>& symbols)
+{
+	int32 mismatchCount = 0;
+	for (int32 i = 0; i < machines.Count(); i++)
+	{
+		FSM* machine = machines[i];
+		int32 state = GetStateIndex(compiled, machine);
+		bool isMatching = (state == batch.GetState(i));
+		for (int32 j = 0; j < SymbolCount && isMatching; j++)
+		{
+			int32 symbol = compiled->GetSymbolIndex(symbols[j]);
+			if (symbol >= 0)
+				isMatching = (machine->GetSymbolTable()->GetSymbol(symbols[j]) == batch.GetSymbol(i, symbol));
+		}
+		if (!isMatching)
+			mismatchCount++;
+	}
+	return mismatchCount;
+}
+
+int main(int argc, char** argv)
+{
+	int32 agentCount = 10000;
+	int32 frameCount = 100;
+	int32 workerCount = 1;
+
+	Console::WriteLine(_T("FSMBenchmark"));
+	Console::WriteLine(_T("============"));
+
+	if (argc == 4)
+	{
+		agentCount = Math::Max(String(argv[1]).ToInt32(), 1);
+		frameCount = Math::Max(String(argv[2]).ToInt32(), 1);
+		workerCount = Math::Max(String(argv[3]).ToInt32(), 0);
+	}
+	else if (argc != 1)
+	{
+		Console::WriteLine(_T("FSMBenchmark [agentCount frameCount workerCount]"));
+		return -1;
+	}
+
+	BaseArray<String> symbols;
+	int32 i, j;
+	for (i = 0; i < SymbolCount; i++)
+		symbols.Add(String(_T("Sensor.Symbol")) + String::ToString(i));
+
+	BaseArray<FSMPtr> machines;
+	for (i = 0; i < agentCount; i++)
+		machines.Add(CreateMachine(symbols, MachineSeed));
+
+	CompiledFSMPtr compiled = new CompiledFSM();
+	compiled->Compile(machines[0]);
+	FSMAgentBatch batch;
+	batch.Initialize(compiled, agentCount);
+	FSMAgentBatch parallelBatch;
+	parallelBatch.Initialize(compiled, agentCount);
+
+	JobScheduler* scheduler = JobScheduler::Instance();
+	scheduler->Create(workerCount);
+
+	Console::WriteLine(String::ToString(agentCount) + _T(" agents, ") + String::ToString(StateCount) + _T(" states, ") +
+		String::ToString(TransitionCount) + _T(" transitions per state, ") +
+		String::ToString(compiled->GetSymbolCount()) + _T(" symbols, ") +
+		String::ToString(scheduler->GetThreadCount()) + _T(" threads"));
+
+	bool result = true;
+	real64 machineTime = 0.0;
+	real64 batchTime = 0.0;
+	real64 parallelTime = 0.0;
+	int32 mismatchCount = 0;
+	BaseArray<SymbolChange> changes;
+	changes.Resize(agentCount * ChangeCount);
+	Timer timer;
+	for (int32 frame = 0; frame < frameCount; frame++)
+	{
+		// The sensors change a few symbols of each agent
+		RandomLCG random(1000 + frame);
+		for (i = 0; i < changes.Count(); i++)
+		{
+			changes[i]._Symbol = GetRandomIndex(random, SymbolCount);
+			changes[i]._Value = (random.RandomReal() < 0.0625f);
+		}
+		for (i = 0; i < agentCount; i++)
+		{
+			for (j = 0; j < ChangeCount; j++)
+			{
+				const SymbolChange& change = changes[i * ChangeCount + j];
+				machines[i]->GetSymbolTable()->SetSymbol(symbols[change._Symbol], change._Value);
+
+				int32 symbol = compiled->GetSymbolIndex(symbols[change._Symbol]);
+				if (symbol >= 0)
+				{
+					batch.SetSymbol(i, symbol, change._Value);
+					parallelBatch.SetSymbol(i, symbol, change._Value);
+				}
+			}
+		}
+
+		timer.Start();
+		for (i = 0; i < agentCount; i++)
+			machines[i]->Update();
+		timer.Stop();
+		machineTime += timer.Elapsed();
+
+		timer.Start();
+		batch.Update();
+		timer.Stop();
+		batchTime += timer.Elapsed();
+
+		timer.Start();
+		parallelBatch.ParallelUpdate();
+		timer.Stop();
+		parallelTime += timer.Elapsed();
+
+		mismatchCount += CountMismatches(machines, compiled, batch, symbols);
+		mismatchCount += CountMismatches(machines, compiled, parallelBatch, symbols);
+	}
+
+	int32 movedCount = 0;
+	for (i = 0; i < agentCount; i++)
+	{
+		if (batch.GetState(i) != compiled->GetStartState())
+			movedCount++;
+	}
+
+	scheduler->Destroy();
+
+	Console::WriteLine(_T("  FSM::Update                  : ") + String::ToString(machineTime * 1000.0 / frameCount) + _T(" ms/frame"));
+	Console::WriteLine(_T("  FSMAgentBatch::Update        : ") + String::ToString(batchTime * 1000.0 / frameCount) + _T(" ms/frame (x") +
+		String::ToString(machineTime / batchTime) + _T(")"));
+	Console::WriteLine(_T("  FSMAgentBatch::ParallelUpdate: ") + String::ToString(parallelTime * 1000.0 / frameCount) + _T(" ms/frame (x") +
+		String::ToString(machineTime / parallelTime) + _T(")"));
+	Console::WriteLine(_T("  ") + String::ToString(movedCount) + _T(" agents out of the start state"));
+
+	if (mismatchCount != 0)
+	{
+		Console::WriteLine(_T("  FAILED: ") + String::ToString(mismatchCount) + _T(" agents differ from their state machine"));
+		result = false;
+	}
+	if (movedCount == 0)
+	{
+		Console::WriteLine(_T("  FAILED: no transition fired"));
+		result = false;
+	}
+
+	Console::WriteLine(result ? _T("All tests passed.") : _T("Some tests failed."));
+	return (result ? 0 : 1);
+}
@@ -0,0 +1,510 @@
+/*=============================================================================
+GridPathfindingBenchmark.cpp
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+#include <Core/Core.h>
+#include <AI/AI.h>
+
+using namespace SonataEngine;
+using namespace SonataEngine::AI;
+
+/*
+	Tests and benchmark of the pathfinders of the grid maps.
+
+	GridPathfindingBenchmark [maxSize]
+
+	The tests search 10 random paths on each of 300 small random grids,
+	with and without diagonals, with random walls or with rooms. The JPS
+	path costs must match a Dijkstra reference, and the HPA* paths must be
+	valid. 20 random cells of each grid are then flipped, and the HPA*
+	graph repaired by InvalidateNode must have the same nodes, edges and
+	paths as a rebuilt graph.
+
+	The benchmark searches paths between random walkable cells of 512x512
+	and 2048x2048 grids with diagonals, up to maxSize (2048 by default),
+	with A*, JPS and HPA* with clusters of 16 and 32 cells. The grids have
+	20% of random walls, or rooms with walls every 64 cells, doors and
+	blocks of 4x4 cells. The times are the mean and the 99th percentile
+	in milliseconds, the repair time is for one cell change.
+*/
+
+/// Number of random grids of the tests, and number of paths searched on each grid.
+static const int32 TestCount = 300;
+static const int32 TestQueryCount = 10;
+
+/// Number of cells flipped on each grid to test the repair of the HPA* graph.
+static const int32 TestFlipCount = 20;
+
+/// Number of cell changes whose repair is measured.
+static const int32 RepairCount = 50;
+
+static const real64 CostTolerance = 1.0e-3;
+
+class TestMap : public GridPathfinderMap
+{
+public:
+	virtual bool IsWalkable(int32 x, int32 y) { return (_Walkable[y * _Width + x] != 0); }
+
+	/**
+		Creates the cells.
+		@param wallRatio The percentage of walls, or of cells covered by blocks with rooms.
+		@param roomSize The distance between the walls of the rooms, 0 for random walls.
+	*/
+	void Create(int32 width, int32 height, int32 wallRatio, int32 roomSize, int32 seed)
+	{
+		RandomLCG random(seed);
+		SetSize(width, height);
+		_Walkable.Resize(width * height);
+		int32 x, y;
+		for (y = 0; y < height; y++)
+		{
+			for (x = 0; x < width; x++)
+			{
+				bool isWall;
+				if (roomSize > 0)
+					isWall = ((x % roomSize == 0 || y % roomSize == 0) && random.RandomReal(0.0f, 100.0f) < 97.0f);
+				else
+					isWall = (random.RandomReal(0.0f, 100.0f) < wallRatio);
+				_Walkable[y * width + x] = (isWall ? 0 : 1);
+			}
+		}
+
+		if (roomSize > 0)
+		{
+			int32 blockCount = width * height * wallRatio / 1600;
+			for (int32 i = 0; i < blockCount; i++)
+			{
+				int32 blockX = GetRandomIndex(random, width);
+				int32 blockY = GetRandomIndex(random, height);
+				for (y = blockY; y < Math::Min(height, blockY + 4); y++)
+				{
+					for (x = blockX; x < Math::Min(width, blockX + 4); x++)
+						_Walkable[y * width + x] = 0;
+				}
+			}
+		}
+	}
+
+	void Flip(PathfinderNodeID node)
+	{
+		_Walkable[node] = (_Walkable[node] != 0 ? 0 : 1);
+	}
+
+	PathfinderNodeID GetRandomWalkableNode(RandomLCG& random)
+	{
+		while (true)
+		{
+			PathfinderNodeID node = GetRandomIndex(random, _Walkable.Count());
+			if (_Walkable[node] != 0)
+				return node;
+		}
+	}
+
+	static int32 GetRandomIndex(RandomLCG& random, int32 count)
+	{
+		return Math::Min((int32)random.RandomReal(0.0f, (real)count), count - 1);
+	}
+
+protected:
+	BaseArray<SEbyte> _Walkable;
+};
+
+/// Goal of the A* searches on the grid, with the distance without obstacles as heuristic.
+class TestGoal : public AStarPathfinderGoal
+{
+public:
+	TestGoal(TestMap* map) :
+		_Map(map),
+		_DestinationNode(PathfinderNodeID_Invalid)
+	{
+	}
+
+	virtual void SetDestinationNode(PathfinderNodeID node) { _DestinationNode = node; }
+
+	virtual real32 GetHeuristic(AStarPathfinderNode* node)
+	{
+		return GetDistance(node->_NodeID, _DestinationNode);
+	}
+
+	virtual real32 GetCost(AStarPathfinderNode* nodeA, AStarPathfinderNode* nodeB)
+	{
+		return GetDistance(nodeA->_NodeID, nodeB->_NodeID);
+	}
+
+	virtual bool IsSearchFinished(AStarPathfinderNode* node)
+	{
+		return (node->_NodeID == _DestinationNode);
+	}
+
+protected:
+	real32 GetDistance(PathfinderNodeID nodeA, PathfinderNodeID nodeB) const
+	{
+		return _Map->GetDistance(_Map->GetNodeX(nodeA), _Map->GetNodeY(nodeA), _Map->GetNodeX(nodeB), _Map->GetNodeY(nodeB));
+	}
+
+	TestMap* _Map;
+	PathfinderNodeID _DestinationNode;
+};
+
+struct QueueItem
+{
+	real64 _Cost;
+	PathfinderNodeID _Node;
+};
+
+/// Adds an item to a binary heap sorted by cost.
+static void PushItem(BaseArray<QueueItem>& heap, const QueueItem& item)
+{
+	heap.Add(item);
+	int32 index = heap.Count() - 1;
+	while (index > 0 && heap[(index - 1) / 2]._Cost > item._Cost)
+	{
+		heap[index] = heap[(index - 1) / 2];
+		index = (index - 1) / 2;
+	}
+	heap[index] = item;
+}
+
+static QueueItem PopItem(BaseArray<QueueItem>& heap)
+{
+	QueueItem result = heap[0];
+	QueueItem last = heap[heap.Count() - 1];
+	heap.RemoveAt(heap.Count() - 1);
+
+	int32 count = heap.Count();
+	int32 index = 0;
+	while (count > 0)
+	{
+		int32 child = 2 * index + 1;
+		if (child >= count)
+			break;
+		if (child + 1 < count && heap[child + 1]._Cost < heap[child]._Cost)
+			child++;
+		if (heap[child]._Cost >= last._Cost)
+			break;
+		heap[index] = heap[child];
+		index = child;
+	}
+	if (count > 0)
+		heap[index] = last;
+	return result;
+}
+
+/// Gets the cost of the shortest path with the Dijkstra algorithm, or -1.
+static real64 GetDijkstraCost(TestMap& map, PathfinderNodeID source, PathfinderNodeID destination)
+{
+	BaseArray<real64> costs;
+	costs.Resize(map.GetWidth() * map.GetHeight());
+	for (int32 i = 0; i < costs.Count(); i++)
+		costs[i] = -1.0;
+
+	BaseArray<QueueItem> heap;
+	QueueItem item;
+	item._Cost = 0.0;
+	item._Node = source;
+	costs[source] = 0.0;
+	PushItem(heap, item);
+
+	while (!heap.IsEmpty())
+	{
+		item = PopItem(heap);
+		if (item._Cost > costs[item._Node])
+			continue;
+		if (item._Node == destination)
+			return item._Cost;
+
+		int32 x = map.GetNodeX(item._Node);
+		int32 y = map.GetNodeY(item._Node);
+		for (int32 i = 0; i < map.GetDirectionCount(); i++)
+		{
+			int32 dx, dy;
+			GridPathfinderMap::GetDirection(i, dx, dy);
+			if (!map.CanMove(x, y, dx, dy))
+				continue;
+
+			QueueItem neighbour;
+			neighbour._Node = map.GetNodeID(x + dx, y + dy);
+			neighbour._Cost = item._Cost + map.GetDistance(x, y, x + dx, y + dy);
+			if (costs[neighbour._Node] < 0.0 || neighbour._Cost < costs[neighbour._Node])
+			{
+				costs[neighbour._Node] = neighbour._Cost;
+				PushItem(heap, neighbour);
+			}
+		}
+	}
+	return -1.0;
+}
+
+/// Checks that the cells of a path are walkable and consecutive, and returns its cost, or -1.
+static real64 GetPathCost(TestMap& map, const BaseArray<PathfinderNodeID>& path, PathfinderNodeID source, PathfinderNodeID destination)
+{
+	if (path.IsEmpty() || path[0] != source || path[path.Count() - 1] != destination)
+		return -1.0;
+
+	real64 cost = 0.0;
+	for (int32 i = 1; i < path.Count(); i++)
+	{
+		int32 x = map.GetNodeX(path[i - 1]);
+		int32 y = map.GetNodeY(path[i - 1]);
+		int32 dx = map.GetNodeX(path[i]) - x;
+		int32 dy = map.GetNodeY(path[i]) - y;
+		if (Math::Abs(dx) > 1 || Math::Abs(dy) > 1 || (dx == 0 && dy == 0) || !map.CanMove(x, y, dx, dy))
+			return -1.0;
+		cost += map.GetDistance(x, y, x + dx, y + dy);
+	}
+	return cost;
+}
+
+static real64 FindHierarchicalPath(HierarchicalPathfinder& pathfinder, TestMap& map, PathfinderNodeID source, PathfinderNodeID destination)
+{
+	BaseArray<PathfinderNodeID> path;
+	pathfinder.SetSourceNode(source);
+	pathfinder.SetDestinationNode(destination);
+	pathfinder.Run();
+	return (pathfinder.GetPath(path) ? GetPathCost(map, path, source, destination) : -1.0);
+}
+
+static bool TestPathfinders()
+{
+	RandomLCG random(9);
+	int32 jpsFailedCount = 0;
+	int32 hierarchicalFailedCount = 0;
+	int32 repairFailedCount = 0;
+	real64 costRatio = 0.0;
+	int32 pathCount = 0;
+
+	for (int32 i = 0; i < TestCount; i++)
+	{
+		TestMap map;
+		map.Create(40 + i % 37, 30 + i % 23, i % 35, (i % 3 == 0 ? 32 : 0), i + 1);
+		map.SetAllowDiagonals(i % 5 != 4);
+		TestGoal goal(&map);
+		int32 clusterSize = 8 + i % 9;
+
+		JPSPathfinder jps;
+		jps.Initialize(&goal, &map);
+		HierarchicalPathfinder hierarchical;
+		hierarchical.Initialize(&goal, &map, clusterSize);
+
+		int32 q;
+		for (q = 0; q < TestQueryCount; q++)
+		{
+			PathfinderNodeID source = map.GetRandomWalkableNode(random);
+			PathfinderNodeID destination = map.GetRandomWalkableNode(random);
+			real64 reference = GetDijkstraCost(map, source, destination);
+
+			// JPS needs the diagonals
+			if (map.GetAllowDiagonals())
+			{
+				BaseArray<PathfinderNodeID> path;
+				jps.SetSourceNode(source);
+				jps.SetDestinationNode(destination);
+				jps.Run();
+				real64 cost = (jps.GetPath(path) ? GetPathCost(map, path, source, destination) : -1.0);
+				if ((reference < 0.0) != (cost < 0.0) || Math::Abs(cost - reference) > CostTolerance)
+					jpsFailedCount++;
+			}
+
+			real64 cost = FindHierarchicalPath(hierarchical, map, source, destination);
+			if ((reference < 0.0) != (cost < 0.0) || cost < reference - CostTolerance)
+				hierarchicalFailedCount++;
+			if (reference > 0.0 && cost > 0.0)
+			{
+				costRatio += cost / reference;
+				pathCount++;
+			}
+		}
+
+		for (q = 0; q < TestFlipCount; q++)
+		{
+			PathfinderNodeID node = TestMap::GetRandomIndex(random, map.GetWidth() * map.GetHeight());
+			map.Flip(node);
+			hierarchical.InvalidateNode(node);
+		}
+		hierarchical.Update();
+
+		HierarchicalPathfinder rebuilt;
+		rebuilt.Initialize(&goal, &map, clusterSize);
+		bool isRepaired = (hierarchical.GetAbstractNodeCount() == rebuilt.GetAbstractNodeCount() &&
+			hierarchical.GetAbstractEdgeCount() == rebuilt.GetAbstractEdgeCount());
+
+		for (q = 0; q < TestQueryCount; q++)
+		{
+			PathfinderNodeID source = map.GetRandomWalkableNode(random);
+			PathfinderNodeID destination = map.GetRandomWalkableNode(random);
+			real64 repairedCost = FindHierarchicalPath(hierarchical, map, source, destination);
+			real64 rebuiltCost = FindHierarchicalPath(rebuilt, map, source, destination);
+			real64 reference = GetDijkstraCost(map, source, destination);
+			isRepaired &= (Math::Abs(repairedCost - rebuiltCost) <= CostTolerance && (reference < 0.0) == (repairedCost < 0.0));
+		}
+		if (!isRepaired)
+			repairFailedCount++;
+	}
+
+	Console::WriteLine(_T("HPA* paths are ") + String::ToString((costRatio / pathCount - 1.0) * 100.0) +
+		_T("% longer than the shortest paths"));
+
+	bool result = true;
+	if (jpsFailedCount != 0)
+	{
+		Console::WriteLine(_T("  FAILED: ") + String::ToString(jpsFailedCount) + _T(" JPS path costs differ from Dijkstra"));
+		result = false;
+	}
+	if (hierarchicalFailedCount != 0)
+	{
+		Console::WriteLine(_T("  FAILED: ") + String::ToString(hierarchicalFailedCount) + _T(" HPA* paths are invalid"));
+		result = false;
+	}
+	if (repairFailedCount != 0)
+	{
+		Console::WriteLine(_T("  FAILED: ") + String::ToString(repairFailedCount) + _T(" repaired HPA* graphs differ from the rebuilt ones"));
+		result = false;
+	}
+	return result;
+}
+
+static bool CompareTimes(const real64& left, const real64& right)
+{
+	return (left < right);
+}
+
+/// Sorts the times and writes their mean and their 99th percentile.
+static void WriteTimes(const String& name, BaseArray<real64>& times, const String& details)
+{
+	times.Sort(CompareTimes);
+	real64 sum = 0.0;
+	for (int32 i = 0; i < times.Count(); i++)
+		sum += times[i];
+
+	Console::WriteLine(_T("  ") + name + _T(": mean ") + String::ToString(sum / times.Count() * 1000.0) +
+		_T(" ms, p99 ") + String::ToString(times[times.Count() * 99 / 100] * 1000.0) + _T(" ms, ") + details);
+}
+
+static void Benchmark(int32 size, bool hasRooms, int32 queryCount)
+{
+	TestMap map;
+	map.Create(size, size, (hasRooms ? 8 : 20), (hasRooms ? 64 : 0), 77 + size);
+	TestGoal goal(&map);
+
+	RandomLCG random(5);
+	BaseArray<PathfinderNodeID> sources;
+	BaseArray<PathfinderNodeID> destinations;
+	int32 q;
+	for (q = 0; q < queryCount; q++)
+	{
+		sources.Add(map.GetRandomWalkableNode(random));
+		destinations.Add(map.GetRandomWalkableNode(random));
+	}
+
+	Console::WriteLine(String::ToString(size) + _T("x") + String::ToString(size) +
+		(hasRooms ? _T(", rooms, ") : _T(", random walls, ")) + String::ToString(queryCount) + _T(" queries"));
+
+	BaseArray<real64> times;
+	Timer timer;
+
+	PooledAStarPathfinderStorage<AStarPathfinderNode> storage;
+	storage.SetNodeCount(size * size);
+	AStarPathfinder astar;
+	astar.Initialize(&storage, &goal, &map);
+	int32 maxNodeCount = 0;
+	for (q = 0; q < queryCount; q++)
+	{
+		timer.Start();
+		astar.SetSourceNode(sources[q]);
+		astar.SetDestinationNode(destinations[q]);
+		astar.Run();
+		timer.Stop();
+		times.Add(timer.Elapsed());
+		maxNodeCount = Math::Max(maxNodeCount, storage.GetUsedCount());
+	}
+	WriteTimes(_T("A*     "), times, _T("at most ") + String::ToString(maxNodeCount) + _T(" nodes"));
+
+	JPSPathfinder jps;
+	jps.Initialize(&goal, &map);
+	times.Clear();
+	maxNodeCount = 0;
+	for (q = 0; q < queryCount; q++)
+	{
+		timer.Start();
+		jps.SetSourceNode(sources[q]);
+		jps.SetDestinationNode(destinations[q]);
+		jps.Run();
+		timer.Stop();
+		times.Add(timer.Elapsed());
+		maxNodeCount = Math::Max(maxNodeCount, jps.GetExpandedNodeCount());
+	}
+	WriteTimes(_T("JPS    "), times, _T("at most ") + String::ToString(maxNodeCount) + _T(" jump points"));
+
+	const int32 ClusterSizes[] = { 16, 32 };
+	for (int32 c = 0; c < 2; c++)
+	{
+		HierarchicalPathfinder hierarchical;
+		timer.Start();
+		hierarchical.Initialize(&goal, &map, ClusterSizes[c]);
+		timer.Stop();
+		real64 buildTime = timer.Elapsed();
+
+		times.Clear();
+		for (q = 0; q < queryCount; q++)
+		{
+			timer.Start();
+			hierarchical.SetSourceNode(sources[q]);
+			hierarchical.SetDestinationNode(destinations[q]);
+			hierarchical.Run();
+			timer.Stop();
+			times.Add(timer.Elapsed());
+		}
+
+		// A cell is blocked then opened again
+		timer.Start();
+		for (q = 0; q < RepairCount; q++)
+		{
+			PathfinderNodeID node = map.GetRandomWalkableNode(random);
+			map.Flip(node);
+			hierarchical.InvalidateNode(node);
+			hierarchical.Update();
+			map.Flip(node);
+			hierarchical.InvalidateNode(node);
+			hierarchical.Update();
+		}
+		timer.Stop();
+
+		WriteTimes(_T("HPA* ") + String::ToString(ClusterSizes[c]), times,
+			String::ToString(hierarchical.GetAbstractNodeCount()) + _T(" nodes, ") +
+			String::ToString(hierarchical.GetAbstractEdgeCount()) + _T(" edges, build ") +
+			String::ToString(buildTime * 1000.0) + _T(" ms, repair ") +
+			String::ToString(timer.Elapsed() * 1000.0 / (2 * RepairCount)) + _T(" ms"));
+	}
+}
+
+int main(int argc, char** argv)
+{
+	int32 maxSize = 2048;
+
+	Console::WriteLine(_T("GridPathfindingBenchmark"));
+	Console::WriteLine(_T("========================"));
+
+	if (argc == 2)
+	{
+		maxSize = Math::Max(String(argv[1]).ToInt32(), 512);
+	}
+	else if (argc != 1)
+	{
+		Console::WriteLine(_T("GridPathfindingBenchmark [maxSize]"));
+		return -1;
+	}
+
+	bool result = TestPathfinders();
+
+	for (int32 size = 512; size <= maxSize; size *= 4)
+	{
+		int32 queryCount = (size == 512 ? 200 : 40);
+		Benchmark(size, false, queryCount);
+		Benchmark(size, true, queryCount);
+	}
+
+	Console::WriteLine(result ? _T("All tests passed.") : _T("Some tests failed."));
+	return (result ? 0 : 1);
+}
@@ -0,0 +1,176 @@
+/*=============================================================================
+HashtableBenchmark.cpp
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+#include <Core/Core.h>
+
+using namespace SonataEngine;
+
+/*
+	Benchmark of the Hashtable against the Dictionary.
+
+	HashtableBenchmark [maxCount]
+
+	For 1K entries up to maxCount entries (1M by default), each container is
+	filled with the entries, looked up with each key and with as many missing
+	keys, then emptied. The integer and string keys are measured separately.
+	The times are in nanoseconds per operation.
+*/
+
+/// Creates the key of an entry, the indices are scattered so the keys are not sorted.
+static void CreateKey(int32 index, int32& key)
+{
+	key = (int32)((uint32)index * 2654435761U);
+}
+
+static void CreateKey(int32 index, String& key)
+{
+	key = _T("Key") + String::ToString((uint32)index * 2654435761U);
+}
+
+/// Gets the value of an existing key with a single lookup.
+template <class TKey>
+static int32 GetValue(Hashtable<TKey, int32>& table, const TKey& key)
+{
+	return *table.Find(key);
+}
+
+template <class TKey>
+static int32 GetValue(Dictionary<TKey, int32>& table, const TKey& key)
+{
+	return table.GetItem(key);
+}
+
+struct BenchmarkResult
+{
+	real64 _Insert;
+	real64 _Hit;
+	real64 _Miss;
+	real64 _Erase;
+};
+
+template <class TTable, class TKey>
+static BenchmarkResult Benchmark(const BaseArray<TKey>& keys, const BaseArray<TKey>& missingKeys, int32& checksum)
+{
+	// The keys are looked up and erased in another order than they were inserted
+	const int32 Stride = 7919;
+	int32 count = keys.Count();
+	BenchmarkResult result;
+	Timer timer;
+	int32 i;
+
+	TTable* table = new TTable();
+
+	timer.Start();
+	for (i = 0; i < count; i++)
+	{
+		table->Add(keys[i], i);
+	}
+	timer.Stop();
+	result._Insert = timer.Elapsed();
+
+	int32 sum = 0;
+	timer.Start();
+	for (i = 0; i < count; i++)
+	{
+		sum += GetValue(*table, keys[(int32)(((int64)i * Stride) % count)]);
+	}
+	timer.Stop();
+	result._Hit = timer.Elapsed();
+
+	int32 found = 0;
+	timer.Start();
+	for (i = 0; i < count; i++)
+	{
+		if (table->ContainsKey(missingKeys[i]))
+			found++;
+	}
+	timer.Stop();
+	result._Miss = timer.Elapsed();
+
+	timer.Start();
+	for (i = 0; i < count; i++)
+	{
+		table->Remove(keys[(int32)(((int64)i * Stride) % count)]);
+	}
+	timer.Stop();
+	result._Erase = timer.Elapsed();
+
+	// The sum of the values and the final state are checked so the loops are not optimized away
+	checksum += sum + found + table->Count();
+	delete table;
+
+	result._Insert *= 1.0e9 / count;
+	result._Hit *= 1.0e9 / count;
+	result._Miss *= 1.0e9 / count;
+	result._Erase *= 1.0e9 / count;
+	return result;
+}
+
+static void WriteResult(const String& name, const BenchmarkResult& result)
+{
+	Console::WriteLine(name + _T(": insert ") + String::ToString(result._Insert) +
+		_T(", hit ") + String::ToString(result._Hit) +
+		_T(", miss ") + String::ToString(result._Miss) +
+		_T(", erase ") + String::ToString(result._Erase) + _T(" ns"));
+}
+
+template <class TKey>
+static bool BenchmarkKeys(const String& keyName, int32 maxCount)
+{
+	bool result = true;
+	for (int32 count = 1000; count <= maxCount; count *= 10)
+	{
+		BaseArray<TKey> keys;
+		BaseArray<TKey> missingKeys;
+		keys.Resize(count);
+		missingKeys.Resize(count);
+		for (int32 i = 0; i < count; i++)
+		{
+			CreateKey(i, keys[i]);
+			CreateKey(count + i, missingKeys[i]);
+		}
+
+		// Both containers must find the same values and no missing key
+		int32 hashtableChecksum = 0;
+		int32 dictionaryChecksum = 0;
+		BenchmarkResult hashtable = Benchmark<Hashtable<TKey, int32> >(keys, missingKeys, hashtableChecksum);
+		BenchmarkResult dictionary = Benchmark<Dictionary<TKey, int32> >(keys, missingKeys, dictionaryChecksum);
+		int32 expected = (int32)((int64)count * (count - 1) / 2);
+
+		Console::WriteLine(keyName + _T(" keys, ") + String::ToString(count) + _T(" entries"));
+		WriteResult(_T("  Hashtable "), hashtable);
+		WriteResult(_T("  Dictionary"), dictionary);
+		if (hashtableChecksum != expected || dictionaryChecksum != expected)
+		{
+			Console::WriteLine(_T("  FAILED: the containers returned wrong values"));
+			result = false;
+		}
+	}
+	return result;
+}
+
+int main(int argc, char** argv)
+{
+	int32 maxCount = 1000000;
+
+	Console::WriteLine(_T("HashtableBenchmark"));
+	Console::WriteLine(_T("=================="));
+
+	if (argc == 2)
+	{
+		maxCount = Math::Max(String(argv[1]).ToInt32(), 1000);
+	}
+	else if (argc != 1)
+	{
+		Console::WriteLine(_T("HashtableBenchmark [maxCount]"));
+		return -1;
+	}
+
+	bool result = BenchmarkKeys<int32>(_T("Integer"), maxCount);
+	result &= BenchmarkKeys<String>(_T("String"), maxCount);
+
+	return (result ? 0 : 1);
+}
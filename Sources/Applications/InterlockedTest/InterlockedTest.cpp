@@ -0,0 +1,451 @@
+/*=============================================================================
+InterlockedTest.cpp
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+#include <Core/Core.h>
+
+using namespace SonataEngine;
+
+/*
+	Stress tests of the atomic operations.
+
+	InterlockedTest [threads iterations]
+
+	Each test runs the same loop of atomic operations from all the threads at
+	once. The operations are linearizable if the final state is the one of
+	some sequential order of all the operations: the counters hold the sum of
+	all the increments, each value returned by an increment is returned once,
+	the compare and exchange loops lose no update, the 64-bit values are never
+	torn, and the pointers exchanged between the threads are neither lost nor
+	duplicated.
+*/
+
+typedef void (*StressFunction)(int32 index);
+
+static int32 _ThreadCount = 8;
+static int32 _IterationCount = 200000;
+
+/// Number of threads waiting for the others before starting a test.
+static volatile int32 _ReadyCount;
+
+static volatile int32 _Counter32;
+static volatile int64 _Counter64;
+
+/// Number of times each value was returned by an increment.
+static volatile int32* _Returned;
+
+/// Shared object of the pointer exchanges, and last node of the stack.
+static void* volatile _Shared;
+
+/// Spin lock protecting a counter that is not atomic.
+static volatile int32 _Lock;
+static int32 _LockedCounter;
+
+/// Identifiers of the threads.
+static ThreadId* _ThreadIds;
+
+/// Node of a stack only pushed with compare and exchange.
+struct StackNode
+{
+	StackNode* _Next;
+	int32 _Thread;
+	int32 _Index;
+};
+
+static StackNode* _Nodes;
+
+/// Objects exchanged by the threads, one per thread and the initial shared object.
+static int32* _Tokens;
+static int32** _HeldTokens;
+
+class StressThread : public Thread
+{
+public:
+	StressThread(StressFunction function, int32 index) :
+		Thread(),
+		_function(function),
+		_index(index)
+	{
+	}
+
+	virtual void Run()
+	{
+		// All the threads start the test at the same time to maximize the contention
+		Interlocked::Increment(&_ReadyCount);
+		while (Interlocked::Load(&_ReadyCount) != _ThreadCount)
+		{
+		}
+
+		_function(_index);
+	}
+
+protected:
+	StressFunction _function;
+	int32 _index;
+};
+
+/// Runs a function from all the threads and returns the elapsed time in milliseconds.
+static real64 RunThreads(StressFunction function)
+{
+	_ReadyCount = 0;
+
+	StressThread** threads = new StressThread*[_ThreadCount];
+	int32 i;
+	for (i = 0; i < _ThreadCount; i++)
+	{
+		threads[i] = new StressThread(function, i);
+	}
+
+	Timer timer;
+	timer.Start();
+	for (i = 0; i < _ThreadCount; i++)
+	{
+		threads[i]->Start();
+	}
+	for (i = 0; i < _ThreadCount; i++)
+	{
+		threads[i]->Join(Thread::Infinite);
+	}
+	timer.Stop();
+
+	for (i = 0; i < _ThreadCount; i++)
+	{
+		delete threads[i];
+	}
+	delete[] threads;
+
+	return timer.Elapsed() * 1000.0;
+}
+
+static bool Report(const String& name, bool result, real64 time)
+{
+	Console::WriteLine(name + _T(": ") + (result ? String(_T("OK")) : String(_T("FAILED"))) +
+		_T(" (") + String::ToString(time) + _T(" ms)"));
+	return result;
+}
+
+static void IncrementDecrement(int32 index)
+{
+	// The increments and decrements are balanced except for the last increment of each iteration
+	for (int32 i = 0; i < _IterationCount; i++)
+	{
+		Interlocked::Increment(&_Counter32);
+		Interlocked::Decrement(&_Counter32, MemoryOrder_Relaxed);
+		Interlocked::Increment(&_Counter32, MemoryOrder_AcquireRelease);
+	}
+}
+
+static bool TestIncrementDecrement()
+{
+	_Counter32 = 0;
+	real64 time = RunThreads(IncrementDecrement);
+	return Report(_T("Increment/Decrement 32"), _Counter32 == _ThreadCount * _IterationCount, time);
+}
+
+static void UniqueIncrement(int32 index)
+{
+	for (int32 i = 0; i < _IterationCount; i++)
+	{
+		int32 value = Interlocked::Increment(&_Counter32);
+		Interlocked::Increment(&_Returned[value - 1], MemoryOrder_Relaxed);
+	}
+}
+
+static bool TestUniqueIncrement()
+{
+	// Each value from 1 to the number of increments is returned once
+	int32 count = _ThreadCount * _IterationCount;
+	_Counter32 = 0;
+	_Returned = new int32[count];
+	Memory::Zero((void*)_Returned, count * sizeof(int32));
+
+	real64 time = RunThreads(UniqueIncrement);
+
+	bool result = (_Counter32 == count);
+	for (int32 i = 0; i < count && result; i++)
+	{
+		result = (_Returned[i] == 1);
+	}
+	delete[] _Returned;
+	_Returned = NULL;
+
+	return Report(_T("Increment return values"), result, time);
+}
+
+static void Add64(int32 index)
+{
+	// The additions carry from the low to the high 32 bits
+	const int64 value = ((int64)1 << 32) - 1;
+	for (int32 i = 0; i < _IterationCount; i++)
+	{
+		Interlocked::Add(&_Counter64, value);
+		Interlocked::Increment(&_Counter64, MemoryOrder_Relaxed);
+		Interlocked::Decrement(&_Counter64);
+	}
+}
+
+static bool TestAdd64()
+{
+	_Counter64 = 0;
+	real64 time = RunThreads(Add64);
+	int64 expected = (int64)_ThreadCount * _IterationCount * (((int64)1 << 32) - 1);
+	return Report(_T("Add/Increment/Decrement 64"), Interlocked::Load(&_Counter64) == expected, time);
+}
+
+static void CompareExchange32(int32 index)
+{
+	for (int32 i = 0; i < _IterationCount; i++)
+	{
+		int32 value = Interlocked::Load(&_Counter32, MemoryOrder_Relaxed);
+		while (true)
+		{
+			int32 previous = Interlocked::CompareExchange(&_Counter32, value + 1, value);
+			if (previous == value)
+				break;
+			value = previous;
+		}
+	}
+}
+
+static bool TestCompareExchange32()
+{
+	_Counter32 = 0;
+	real64 time = RunThreads(CompareExchange32);
+	return Report(_T("CompareExchange 32"), _Counter32 == _ThreadCount * _IterationCount, time);
+}
+
+/// Number of 64-bit values read with different high and low 32 bits.
+static volatile int32 _TornCount;
+
+static void CompareExchange64(int32 index)
+{
+	// The high and low 32 bits of the value are always equal, a torn read or write breaks it
+	const int64 step = ((int64)1 << 32) + 1;
+	for (int32 i = 0; i < _IterationCount; i++)
+	{
+		int64 value = Interlocked::Load(&_Counter64, MemoryOrder_Acquire);
+		while (true)
+		{
+			if ((uint32)(value >> 32) != (uint32)value)
+				Interlocked::Increment(&_TornCount);
+
+			int64 previous = Interlocked::CompareExchange(&_Counter64, value + step, value, MemoryOrder_AcquireRelease);
+			if (previous == value)
+				break;
+			value = previous;
+		}
+	}
+}
+
+static bool TestCompareExchange64()
+{
+	_Counter64 = 0;
+	_TornCount = 0;
+	real64 time = RunThreads(CompareExchange64);
+	int64 expected = (int64)_ThreadCount * _IterationCount * (((int64)1 << 32) + 1);
+	return Report(_T("CompareExchange 64"), _TornCount == 0 && Interlocked::Load(&_Counter64) == expected, time);
+}
+
+static void PushNodes(int32 index)
+{
+	StackNode* nodes = _Nodes + index * _IterationCount;
+	for (int32 i = 0; i < _IterationCount; i++)
+	{
+		StackNode* node = &nodes[i];
+		node->_Thread = index;
+		node->_Index = i;
+
+		void* top = Interlocked::Load((volatile void**)&_Shared, MemoryOrder_Relaxed);
+		while (true)
+		{
+			node->_Next = (StackNode*)top;
+			void* previous = Interlocked::CompareExchange((volatile void**)&_Shared, node, top, MemoryOrder_Release);
+			if (previous == top)
+				break;
+			top = previous;
+		}
+	}
+}
+
+static bool TestCompareExchangePointer()
+{
+	// The nodes are pushed on a stack, each node must be found once and the nodes of a thread in the reverse order of their push
+	int32 count = _ThreadCount * _IterationCount;
+	_Nodes = new StackNode[count];
+	_Shared = NULL;
+
+	real64 time = RunThreads(PushNodes);
+
+	int32* nextIndices = new int32[_ThreadCount];
+	int32 i;
+	for (i = 0; i < _ThreadCount; i++)
+	{
+		nextIndices[i] = _IterationCount - 1;
+	}
+
+	bool result = true;
+	int32 nodeCount = 0;
+	StackNode* node = (StackNode*)Interlocked::Load((volatile void**)&_Shared, MemoryOrder_Acquire);
+	while (node != NULL && result)
+	{
+		result = (nodeCount < count && node->_Index == nextIndices[node->_Thread]);
+		nextIndices[node->_Thread]--;
+		nodeCount++;
+		node = node->_Next;
+	}
+	result &= (nodeCount == count);
+
+	delete[] nextIndices;
+	delete[] _Nodes;
+	_Nodes = NULL;
+
+	return Report(_T("CompareExchange pointer"), result, time);
+}
+
+static void ExchangeTokens(int32 index)
+{
+	int32* token = _HeldTokens[index];
+	for (int32 i = 0; i < _IterationCount; i++)
+	{
+		token = (int32*)Interlocked::Exchange((volatile void**)&_Shared, token, (i & 1) != 0 ? MemoryOrder_AcquireRelease : MemoryOrder_Sequential);
+
+		// The token is only owned by this thread until it is given back
+		(*token)++;
+	}
+	_HeldTokens[index] = token;
+}
+
+static bool TestExchangePointer()
+{
+	// The tokens held by the threads and the shared token are all different at the end
+	_Tokens = new int32[_ThreadCount + 1];
+	_HeldTokens = new int32*[_ThreadCount];
+	int32 i;
+	for (i = 0; i <= _ThreadCount; i++)
+	{
+		_Tokens[i] = 0;
+	}
+	for (i = 0; i < _ThreadCount; i++)
+	{
+		_HeldTokens[i] = &_Tokens[i];
+	}
+	_Shared = &_Tokens[_ThreadCount];
+
+	real64 time = RunThreads(ExchangeTokens);
+
+	bool* found = new bool[_ThreadCount + 1];
+	for (i = 0; i <= _ThreadCount; i++)
+	{
+		found[i] = false;
+	}
+
+	bool result = true;
+	int64 useCount = 0;
+	for (i = 0; i <= _ThreadCount; i++)
+	{
+		int32* token = (i < _ThreadCount ? _HeldTokens[i] : (int32*)_Shared);
+		int32 tokenIndex = (int32)(token - _Tokens);
+		if (tokenIndex < 0 || tokenIndex > _ThreadCount || found[tokenIndex])
+		{
+			result = false;
+			break;
+		}
+		found[tokenIndex] = true;
+		useCount += _Tokens[tokenIndex];
+	}
+	result &= (useCount == (int64)_ThreadCount * _IterationCount);
+
+	delete[] found;
+	delete[] _HeldTokens;
+	delete[] _Tokens;
+
+	return Report(_T("Exchange pointer"), result, time);
+}
+
+static void SpinLock(int32 index)
+{
+	// The lock orders the accesses to the counter with acquire and release operations only
+	for (int32 i = 0; i < _IterationCount; i++)
+	{
+		while (Interlocked::Exchange(&_Lock, 1, MemoryOrder_Acquire) != 0)
+		{
+			while (Interlocked::Load(&_Lock, MemoryOrder_Relaxed) != 0)
+			{
+			}
+		}
+
+		_LockedCounter++;
+
+		Interlocked::Store(&_Lock, 0, MemoryOrder_Release);
+	}
+}
+
+static bool TestSpinLock()
+{
+	_Lock = 0;
+	_LockedCounter = 0;
+	real64 time = RunThreads(SpinLock);
+	return Report(_T("Acquire/Release spin lock"), _LockedCounter == _ThreadCount * _IterationCount, time);
+}
+
+static void GetThreadIds(int32 index)
+{
+	_ThreadIds[index] = Thread::GetCurrentThreadId();
+}
+
+static bool TestThreadIds()
+{
+	// The identifiers of the running threads are all different
+	_ThreadIds = new ThreadId[_ThreadCount + 1];
+	_ThreadIds[_ThreadCount] = Thread::GetCurrentThreadId();
+
+	real64 time = RunThreads(GetThreadIds);
+
+	bool result = true;
+	for (int32 i = 0; i <= _ThreadCount && result; i++)
+	{
+		for (int32 j = i + 1; j <= _ThreadCount && result; j++)
+		{
+			result = (_ThreadIds[i] != _ThreadIds[j]);
+		}
+	}
+	delete[] _ThreadIds;
+	_ThreadIds = NULL;
+
+	return Report(_T("GetCurrentThreadId"), result, time);
+}
+
+int main(int argc, char** argv)
+{
+	Console::WriteLine(_T("InterlockedTest"));
+	Console::WriteLine(_T("==============="));
+
+	if (argc == 3)
+	{
+		_ThreadCount = Math::Max(String(argv[1]).ToInt32(), 2);
+		_IterationCount = Math::Max(String(argv[2]).ToInt32(), 1);
+	}
+	else if (argc != 1)
+	{
+		Console::WriteLine(_T("InterlockedTest [threads iterations]"));
+		return -1;
+	}
+
+	Console::WriteLine(String::ToString(_ThreadCount) + _T(" threads, ") +
+		String::ToString(_IterationCount) + _T(" iterations"));
+
+	bool result = TestIncrementDecrement();
+	result &= TestUniqueIncrement();
+	result &= TestAdd64();
+	result &= TestCompareExchange32();
+	result &= TestCompareExchange64();
+	result &= TestCompareExchangePointer();
+	result &= TestExchangePointer();
+	result &= TestSpinLock();
+	result &= TestThreadIds();
+
+	Console::WriteLine(result ? _T("All tests passed.") : _T("Some tests failed."));
+	return (result ? 0 : 1);
+}
@@ -0,0 +1,182 @@
+/*=============================================================================
+JobSchedulerBenchmark.cpp
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+#include <Core/Core.h>
+
+using namespace SonataEngine;
+
+/*
+	Benchmark of the scaling of the JobScheduler.
+
+	JobSchedulerBenchmark [maxThreadCount]
+
+	For 1 thread up to maxThreadCount threads (the number of processors by
+	default), two workloads are executed:
+	- Coarse: a parallel loop over 1M independent items of about 1 us each.
+	- Fine: 1000 parallel loops of 1024 jobs of about 100 ns each, the cost
+	  is dominated by the creation, the stealing and the completion of the jobs.
+	The speedup is relative to the scheduler with a single thread.
+*/
+
+/// Number of items of the coarse workload.
+static const int32 CoarseCount = 1000000;
+
+/// Number of steps of each item of the coarse workload.
+static const int32 CoarseSteps = 256;
+
+/// Number of loops of the fine workload.
+static const int32 FineLoopCount = 1000;
+
+/// Number of jobs of each loop of the fine workload, the maximum created by a loop.
+static const int32 FineCount = 1024;
+
+/// Number of steps of each job of the fine workload.
+static const int32 FineSteps = 32;
+
+struct WorkData
+{
+	uint32* _results;
+	int32 _steps;
+};
+
+/// Work of an item, a chain of dependent multiplications that can't be vectorized.
+static uint32 Work(int32 index, int32 steps)
+{
+	uint32 value = (uint32)index;
+	for (int32 i = 0; i < steps; i++)
+	{
+		value = value * 1664525U + 1013904223U;
+	}
+	return value;
+}
+
+static void WorkRange(int32 start, int32 end, void* data)
+{
+	WorkData* work = (WorkData*)data;
+	for (int32 i = start; i < end; i++)
+	{
+		work->_results[i] = Work(i, work->_steps);
+	}
+}
+
+static uint32 Checksum(const BaseArray<uint32>& results)
+{
+	uint32 sum = 0;
+	for (int32 i = 0; i < results.Count(); i++)
+	{
+		sum += results[i];
+	}
+	return sum;
+}
+
+/// Executes the coarse workload and returns its time.
+static real64 RunCoarse(JobScheduler* scheduler, uint32& checksum)
+{
+	BaseArray<uint32> results;
+	results.Resize(CoarseCount);
+
+	WorkData work;
+	work._results = results.Data();
+	work._steps = CoarseSteps;
+
+	Timer timer;
+	timer.Start();
+	scheduler->ParallelFor(CoarseCount, WorkRange, &work);
+	timer.Stop();
+
+	checksum = Checksum(results);
+	return timer.Elapsed();
+}
+
+/// Executes the fine workload and returns its time.
+static real64 RunFine(JobScheduler* scheduler, uint32& checksum)
+{
+	BaseArray<uint32> results;
+	results.Resize(FineCount);
+
+	WorkData work;
+	work._results = results.Data();
+	work._steps = FineSteps;
+
+	Timer timer;
+	timer.Start();
+	for (int32 i = 0; i < FineLoopCount; i++)
+	{
+		scheduler->ParallelFor(FineCount, WorkRange, &work, 1);
+	}
+	timer.Stop();
+
+	checksum = Checksum(results);
+	return timer.Elapsed();
+}
+
+static String FormatResult(const String& name, real64 time, real64 reference, real64 scale, const String& unit)
+{
+	return _T("  ") + name + _T(": ") + String::ToString(time * scale) + unit +
+		_T(", speedup ") + String::ToString(reference / time);
+}
+
+int main(int argc, char** argv)
+{
+	int32 maxThreadCount = Environment::ProcessorCount();
+
+	Console::WriteLine(_T("JobSchedulerBenchmark"));
+	Console::WriteLine(_T("====================="));
+
+	if (argc == 2)
+	{
+		maxThreadCount = Math::Max(String(argv[1]).ToInt32(), 1);
+	}
+	else if (argc != 1)
+	{
+		Console::WriteLine(_T("JobSchedulerBenchmark [maxThreadCount]"));
+		return -1;
+	}
+
+	JobScheduler* scheduler = JobScheduler::Instance();
+	real64 coarseReference = 0.0;
+	real64 fineReference = 0.0;
+	uint32 coarseExpected = 0;
+	uint32 fineExpected = 0;
+	bool result = true;
+
+	for (int32 threadCount = 1; threadCount <= maxThreadCount; threadCount++)
+	{
+		// The calling thread is a worker of the scheduler
+		scheduler->Create(threadCount - 1);
+
+		uint32 coarseChecksum;
+		uint32 fineChecksum;
+		real64 coarseTime = RunCoarse(scheduler, coarseChecksum);
+		real64 fineTime = RunFine(scheduler, fineChecksum);
+
+		scheduler->Destroy();
+
+		if (threadCount == 1)
+		{
+			coarseReference = coarseTime;
+			fineReference = fineTime;
+			coarseExpected = coarseChecksum;
+			fineExpected = fineChecksum;
+		}
+
+		Console::WriteLine(String::ToString(threadCount) + _T(" threads"));
+		Console::WriteLine(FormatResult(_T("Coarse"), coarseTime, coarseReference, 1000.0, _T(" ms")));
+		Console::WriteLine(FormatResult(_T("Fine  "), fineTime, fineReference,
+			1.0e9 / ((real64)FineLoopCount * FineCount), _T(" ns/job")));
+
+		if (coarseChecksum != coarseExpected || fineChecksum != fineExpected)
+		{
+			Console::WriteLine(_T("  FAILED: the results differ from 1 thread"));
+			result = false;
+		}
+	}
+
+	JobScheduler::DestroyInstance();
+
+	Console::WriteLine(result ? _T("All tests passed.") : _T("Some tests failed."));
+	return (result ? 0 : 1);
+}
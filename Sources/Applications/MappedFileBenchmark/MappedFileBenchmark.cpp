@@ -0,0 +1,324 @@
+/*=============================================================================
+MappedFileBenchmark.cpp
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+#include <Core/Core.h>
+#include <Graphics/Graphics.h>
+
+using namespace SonataEngine;
+
+/*
+	Tests and benchmark of the memory-mapped file streams.
+
+	MappedFileBenchmark [heightFieldSize repeatCount]
+
+	The tests check the spans of a mapped file, the reads in place of a
+	buffered binary stream and the position given back to the mapped file,
+	the private writes of a file mapped copy-on-write, and the height fields
+	loaded from a file stream and from a mapped file.
+
+	The benchmark loads a height field of 8193x8193 int16 by default
+	(128 MB) with HeightField::LoadFromRAW, then a Quake 3 BSP of 17 lumps
+	(100 MB) with a Seek and a Read per lump as BSPFile::ReadLump does. Each
+	file is loaded with a file stream and with a mapped file for each access
+	pattern. The times are the medians of the loads (7 by default) in
+	milliseconds, after a first load bringing the file in the system cache.
+	The cold loads need the system cache to be flushed between the runs,
+	which can't be done from the application.
+*/
+
+static const String FileName = _T("MappedFileBenchmark.bin");
+static const String HeightFieldFileName = _T("MappedFileBenchmark.raw");
+static const String BSPFileName = _T("MappedFileBenchmark.bsp");
+
+static const int32 LumpCount = 17;
+
+/// Sizes of the lumps, those of a large Quake 3 map scaled up.
+static const int32 LumpSizes[LumpCount] =
+{
+	64 << 10, 8 << 20, 2 << 20, 4 << 20, 4 << 20, 1 << 20, 2 << 20, 1 << 20, 512 << 10,
+	1 << 20, 24 << 20, 8 << 20, 16 << 10, 12 << 20, 24 << 20, 4 << 20, 4 << 20
+};
+
+/// Size of the header of a Quake 3 BSP: an identifier, a version and the lumps.
+static const int32 BSPHeaderSize = 4 + 4 + LumpCount * 8;
+
+static const SEchar* AccessNames[] = { _T("normal    "), _T("sequential"), _T("random    ") };
+
+static bool Check(bool value, const String& message)
+{
+	if (!value)
+		Console::WriteLine(_T("  FAILED: ") + message);
+	return value;
+}
+
+static bool CompareTimes(const real64& left, const real64& right)
+{
+	return (left < right);
+}
+
+static FileStreamPtr OpenFile(const String& fileName, bool isWriting)
+{
+	File file(fileName);
+	if (isWriting)
+		return file.Open(FileMode_Create, FileAccess_Write, FileShare_None);
+	else
+		return file.Open(FileMode_Open, FileAccess_Read, FileShare_Read);
+}
+
+static int16 GetRawHeight(int32 x, int32 y)
+{
+	return (int16)((x * 7 + y * 13) & 0x3FFF);
+}
+
+static void WriteHeightField(const String& fileName, int32 width, int32 height)
+{
+	FileStreamPtr stream = OpenFile(fileName, true);
+	BaseArray<int16> row;
+	row.Resize(width);
+	for (int32 y = 0; y < height; y++)
+	{
+		for (int32 x = 0; x < width; x++)
+			row[x] = GetRawHeight(x, y);
+		stream->Write((const SEbyte*)row.Data(), width * sizeof(int16));
+	}
+}
+
+static bool TestSpans()
+{
+	bool result = true;
+
+	{
+		FileStreamPtr stream = OpenFile(FileName, true);
+		BinaryStream writer(stream);
+		for (int32 i = 0; i < 100; i++)
+			writer.WriteInt32(i);
+	}
+
+	{
+		MappedFileStream stream(FileName);
+		result &= Check(stream.IsOpen() && stream.GetLength() == 400, _T("the file is not mapped"));
+		result &= Check(stream.GetSpan(0, 400) != NULL && stream.GetSpan(400, 0) != NULL, _T("no span of the file"));
+		result &= Check(stream.GetSpan(399, 2) == NULL && stream.GetSpan(-1, 1) == NULL, _T("a span out of the file"));
+		result &= Check(stream.GetWritableSpan(0, 4) == NULL, _T("a writable span of a read-only file"));
+
+		// The buffered reads are done in place and give the position back
+		{
+			BinaryStream reader(&stream, 16);
+			bool isValid = true;
+			for (int32 i = 0; i < 10; i++)
+				isValid &= (reader.ReadInt32() == i);
+			result &= Check(isValid, _T("wrong values read in place"));
+		}
+		result &= Check(stream.GetPosition() == 40, _T("the position is not given back to the mapped file"));
+
+		BinaryStream reader(&stream, 16);
+		result &= Check(reader.ReadInt32() == 10, _T("wrong value after a partial read"));
+		SEbyte bytes[400];
+		result &= Check(reader.Read(bytes, 400) == 356 && bytes[0] == 11, _T("wrong read to the end of the file"));
+	}
+
+	{
+		// The writes of a file mapped copy-on-write are private to the stream
+		MappedFileStream stream;
+		result &= Check(stream.Open(FileName, MappedFileAccess_Normal, true) && stream.IsCopyOnWrite(), _T("the file is not mapped copy-on-write"));
+		SEbyte* data = stream.GetWritableSpan(0, 4);
+		result &= Check(data != NULL, _T("no writable span of a file mapped copy-on-write"));
+		if (data != NULL)
+		{
+			data[0] = 0xFF;
+			MappedFileStream other(FileName);
+			result &= Check(stream.GetSpan(0, 1)[0] == 0xFF, _T("the write is not seen by the stream"));
+			result &= Check(other.GetSpan(0, 1)[0] == 0, _T("the write is seen by another mapping"));
+		}
+	}
+
+	{
+		FileStreamPtr stream = OpenFile(FileName, false);
+		result &= Check(stream->ReadByte() == 0, _T("the file mapped copy-on-write is changed"));
+	}
+
+	File::Delete(FileName);
+	return result;
+}
+
+static bool TestHeightFields()
+{
+	bool result = true;
+	const int32 width = 65;
+	const int32 height = 33;
+	WriteHeightField(FileName, width, height);
+
+	HeightFieldPtr expected = new HeightField();
+	{
+		FileStreamPtr stream = OpenFile(FileName, false);
+		result &= Check(expected->LoadFromRAW(*stream, width, height, HeightFieldFormat_Int16), _T("the height field is not loaded from the file stream"));
+	}
+
+	bool isValid = true;
+	for (int32 i = 0; i < width * height; i++)
+		isValid &= (expected->GetData()[i] == GetRawHeight(i % width, i / width));
+	result &= Check(isValid, _T("wrong heights loaded from the file stream"));
+
+	for (int32 access = MappedFileAccess_Normal; access <= MappedFileAccess_Random; access++)
+	{
+		String name = String(AccessNames[access]) + _T(": ");
+		MappedFileStream stream(FileName, (MappedFileAccess)access);
+		HeightFieldPtr field = new HeightField();
+		result &= Check(field->LoadFromRAW(stream, width, height, HeightFieldFormat_Int16), name + _T("the height field is not loaded from the mapped file"));
+		result &= Check(Memory::Compare(field->GetData(), expected->GetData(), width * height * sizeof(real32)) == 0, name + _T("the heights differ"));
+		result &= Check(stream.GetPosition() == width * height * sizeof(int16), name + _T("the mapped file is not at the end of the heights"));
+
+		stream.SetPosition(2);
+		result &= Check(!field->LoadFromRAW(stream, width, height, HeightFieldFormat_Int16), name + _T("a truncated height field is loaded"));
+	}
+
+	File::Delete(FileName);
+	return result;
+}
+
+static void WriteBSP()
+{
+	FileStreamPtr stream = OpenFile(BSPFileName, true);
+	BinaryStream writer(stream, BinaryStream::DefaultBufferSize);
+	writer.WriteInt32(0x50534249);
+	writer.WriteInt32(46);
+	int32 offset = BSPHeaderSize;
+	int32 l;
+	for (l = 0; l < LumpCount; l++)
+	{
+		writer.WriteInt32(offset);
+		writer.WriteInt32(LumpSizes[l]);
+		offset += LumpSizes[l];
+	}
+
+	BaseArray<SEbyte> bytes;
+	bytes.Resize(24 << 20);
+	for (int32 i = 0; i < bytes.Count(); i++)
+		bytes[i] = (SEbyte)(i * 31);
+	for (l = 0; l < LumpCount; l++)
+		writer.Write(bytes.Data(), LumpSizes[l]);
+}
+
+/// Loads the lumps as BSPFile::ReadLump does, returns a sum of a byte per page.
+static real64 LoadBSP(Stream* stream)
+{
+	int32 header[BSPHeaderSize / 4];
+	stream->Read((SEbyte*)header, BSPHeaderSize);
+
+	real64 sum = 0.0;
+	for (int32 l = 0; l < LumpCount; l++)
+	{
+		int32 offset = header[2 + l * 2];
+		int32 length = header[2 + l * 2 + 1];
+		SEbyte* lump = new SEbyte[length];
+		stream->Seek(offset, SeekOrigin_Begin);
+		stream->Read(lump, length);
+		for (int32 i = 1; i < length; i += 4096)
+			sum += lump[i];
+		delete[] lump;
+	}
+	return sum;
+}
+
+static real64 LoadHeightField(Stream* stream, int32 heightFieldSize)
+{
+	HeightFieldPtr field = new HeightField();
+	if (!field->LoadFromRAW(*stream, heightFieldSize, heightFieldSize, HeightFieldFormat_Int16))
+		return -1.0;
+	return field->GetData()[12345] + field->GetData()[heightFieldSize * heightFieldSize - 1];
+}
+
+/// Loads a file with a file stream when access is -1, returns a checksum.
+static real64 Load(const String& fileName, int32 access, int32 heightFieldSize)
+{
+	if (access < 0)
+	{
+		FileStreamPtr stream = OpenFile(fileName, false);
+		return (fileName == BSPFileName ? LoadBSP(stream) : LoadHeightField(stream, heightFieldSize));
+	}
+	else
+	{
+		MappedFileStreamPtr stream = new MappedFileStream(fileName, (MappedFileAccess)access);
+		return (fileName == BSPFileName ? LoadBSP(stream) : LoadHeightField(stream, heightFieldSize));
+	}
+}
+
+/// Returns the median time of the loads in milliseconds.
+static real64 Measure(const String& fileName, int32 access, int32 heightFieldSize, int32 repeatCount, real64& checksum)
+{
+	checksum = Load(fileName, access, heightFieldSize);
+
+	BaseArray<real64> times;
+	Timer timer;
+	for (int32 i = 0; i < repeatCount; i++)
+	{
+		timer.Start();
+		real64 value = Load(fileName, access, heightFieldSize);
+		timer.Stop();
+		times.Add(timer.Elapsed() * 1000.0);
+		if (value != checksum)
+			checksum = -1.0;
+	}
+	times.Sort(CompareTimes);
+	return times[repeatCount / 2];
+}
+
+static bool Benchmark(const String& fileName, const String& title, int32 heightFieldSize, int32 repeatCount)
+{
+	bool result = true;
+	real64 expected;
+	real64 time = Measure(fileName, -1, heightFieldSize, repeatCount, expected);
+	Console::WriteLine(title);
+	Console::WriteLine(_T("  file stream        : ") + String::ToString(time) + _T(" ms"));
+	result &= Check(expected >= 0.0, _T("the file stream loads differ"));
+
+	for (int32 access = MappedFileAccess_Normal; access <= MappedFileAccess_Random; access++)
+	{
+		real64 checksum;
+		time = Measure(fileName, access, heightFieldSize, repeatCount, checksum);
+		Console::WriteLine(_T("  mapped, ") + String(AccessNames[access]) + _T(" : ") + String::ToString(time) + _T(" ms"));
+		result &= Check(checksum == expected, String(AccessNames[access]) + _T(": the mapped file loads differ"));
+	}
+	return result;
+}
+
+int main(int argc, char** argv)
+{
+	int32 heightFieldSize = 8193;
+	int32 repeatCount = 7;
+
+	Console::WriteLine(_T("MappedFileBenchmark"));
+	Console::WriteLine(_T("==================="));
+
+	if (argc == 3)
+	{
+		heightFieldSize = Math::Max(String(argv[1]).ToInt32(), 128);
+		repeatCount = Math::Max(String(argv[2]).ToInt32(), 1);
+	}
+	else if (argc != 1)
+	{
+		Console::WriteLine(_T("MappedFileBenchmark [heightFieldSize repeatCount]"));
+		return -1;
+	}
+
+	bool result = true;
+	Console::WriteLine(_T("Tests"));
+	result &= TestSpans();
+	result &= TestHeightFields();
+
+	WriteHeightField(HeightFieldFileName, heightFieldSize, heightFieldSize);
+	WriteBSP();
+
+	result &= Benchmark(HeightFieldFileName, String::ToString(heightFieldSize) + _T("x") + String::ToString(heightFieldSize) +
+		_T(" int16 height field (") + String::ToString(heightFieldSize * heightFieldSize / 524288) + _T(" MB)"), heightFieldSize, repeatCount);
+	result &= Benchmark(BSPFileName, String(_T("Quake 3 BSP, ")) + String::ToString(LumpCount) + _T(" lumps, Seek and Read per lump"), heightFieldSize, repeatCount);
+
+	File::Delete(HeightFieldFileName);
+	File::Delete(BSPFileName);
+
+	Console::WriteLine(result ? _T("All tests passed.") : _T("Some tests failed."));
+	return (result ? 0 : 1);
+}
@@ -0,0 +1,226 @@
+/*=============================================================================
+MemoryTrackerBenchmark.cpp
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+#include <Core/Core.h>
+
+using namespace SonataEngine;
+
+/*
+	Tests and benchmark of the MemoryTracker.
+
+	MemoryTrackerBenchmark [pairCount]
+
+	The tests check the tag statistics, the call sites of a snapshot and the
+	reallocations of tracked blocks. The benchmark measures a mixed loop of
+	allocations and frees of 16 to 271 bytes, with the system allocator used
+	by the untracked Memory methods, and with the tracker used when
+	SE_USE_MEMORYINFO is enabled. The times are in nanoseconds per pair.
+*/
+
+/// Number of blocks alive during the benchmark.
+static const int32 SlotCount = 64;
+
+/// Number of blocks allocated by the tests.
+static const int32 BlockCount = 100;
+
+/// Call site of the blocks allocated by the snapshot test.
+static const char* SiteFile = "MemoryTrackerBenchmark";
+static const int32 SiteLine = 1;
+
+static bool Check(bool condition, const String& name)
+{
+	if (!condition)
+	{
+		Console::WriteLine(_T("  FAILED: ") + name);
+	}
+	return condition;
+}
+
+static bool TestTagStats()
+{
+	bool result = true;
+	MemoryTagStats before;
+	MemoryTagStats after;
+	MemoryTagStats freed;
+	void* blocks[BlockCount];
+	int64 size = 0;
+	MemoryTag scopeTag;
+	int32 i;
+
+	// Nothing else is allocated in the scope, so the statistics only count the blocks
+	MemoryTracker::GetTagStats(MemoryTag_User, before);
+	{
+		MemoryTagScope scope(MemoryTag_User);
+		scopeTag = MemoryTracker::GetCurrentTag();
+
+		for (i = 0; i < BlockCount; i++)
+		{
+			blocks[i] = MemoryTracker::Alloc(16 + i, __FILE__, __LINE__);
+			size += 16 + i;
+		}
+	}
+	result &= Check(scopeTag == MemoryTag_User, _T("tag of the scope"));
+	result &= Check(MemoryTracker::GetCurrentTag() == MemoryTag_Default, _T("tag restored after the scope"));
+
+	MemoryTracker::GetTagStats(MemoryTag_User, after);
+	result &= Check(after.LiveCount - before.LiveCount == BlockCount, _T("live count"));
+	result &= Check(after.LiveBytes - before.LiveBytes == size, _T("live bytes"));
+	result &= Check(after.TotalCount - before.TotalCount == BlockCount, _T("total count"));
+
+	for (i = 0; i < BlockCount; i++)
+	{
+		MemoryTracker::Free(blocks[i]);
+	}
+
+	MemoryTracker::GetTagStats(MemoryTag_User, freed);
+	result &= Check(freed.LiveCount == before.LiveCount && freed.LiveBytes == before.LiveBytes, _T("live stats after the frees"));
+	result &= Check(freed.TotalCount == after.TotalCount, _T("total count after the frees"));
+	return result;
+}
+
+static bool TestSnapshot()
+{
+	bool result = true;
+	void* blocks[BlockCount];
+	int32 i;
+
+	MemorySnapshot* from = new MemorySnapshot();
+	MemorySnapshot* to = new MemorySnapshot();
+	MemoryTracker::TakeSnapshot(*from);
+
+	MemoryTracker::SetCurrentTag(MemoryTag_AI);
+	for (i = 0; i < BlockCount; i++)
+	{
+		blocks[i] = MemoryTracker::Alloc(32, SiteFile, SiteLine);
+	}
+	MemoryTracker::SetCurrentTag(MemoryTag_Default);
+
+	MemoryTracker::TakeSnapshot(*to);
+	const MemorySiteStats* site = to->FindSite(SiteFile, SiteLine, MemoryTag_AI);
+	result &= Check(from->FindSite(SiteFile, SiteLine, MemoryTag_AI) == NULL, _T("site before the allocations"));
+	result &= Check(site != NULL && site->LiveCount == BlockCount && site->LiveBytes == 32 * BlockCount, _T("site of the allocations"));
+	result &= Check(to->GetTagStats(MemoryTag_AI).LiveCount - from->GetTagStats(MemoryTag_AI).LiveCount == BlockCount,
+		_T("tag stats of the snapshots"));
+
+	for (i = 0; i < BlockCount; i++)
+	{
+		MemoryTracker::Free(blocks[i]);
+	}
+
+	MemoryTracker::TakeSnapshot(*to);
+	result &= Check(to->FindSite(SiteFile, SiteLine, MemoryTag_AI) == NULL, _T("site after the frees"));
+
+	delete from;
+	delete to;
+	return result;
+}
+
+static bool TestReAlloc()
+{
+	bool result = true;
+	MemoryTagStats before;
+	MemoryTagStats after;
+
+	MemoryTracker::GetTagStats(MemoryTag_Default, before);
+	SEbyte* block = (SEbyte*)MemoryTracker::Alloc(100, __FILE__, __LINE__);
+	for (int32 i = 0; i < 100; i++)
+	{
+		block[i] = (SEbyte)i;
+	}
+
+	block = (SEbyte*)MemoryTracker::ReAlloc(block, 10000, __FILE__, __LINE__);
+	bool isKept = true;
+	for (int32 i = 0; i < 100; i++)
+	{
+		isKept &= (block[i] == (SEbyte)i);
+	}
+	result &= Check(isKept, _T("content kept by the reallocation"));
+
+	MemoryTracker::GetTagStats(MemoryTag_Default, after);
+	result &= Check(after.LiveCount - before.LiveCount == 1 && after.LiveBytes - before.LiveBytes == 10000,
+		_T("live stats after the reallocation"));
+
+	MemoryTracker::Free(block);
+	MemoryTracker::GetTagStats(MemoryTag_Default, after);
+	result &= Check(after.LiveCount == before.LiveCount && after.LiveBytes == before.LiveBytes, _T("live stats after the free"));
+	return result;
+}
+
+static void* SystemAlloc(size_t size)
+{
+	return Memory::SystemAlloc(size);
+}
+
+static void SystemFree(void* ptr)
+{
+	Memory::SystemFree(ptr);
+}
+
+static void* TrackedAlloc(size_t size)
+{
+	return MemoryTracker::Alloc(size, __FILE__, __LINE__);
+}
+
+static void TrackedFree(void* ptr)
+{
+	MemoryTracker::Free(ptr);
+}
+
+/// Allocates and frees blocks of 16 to 271 bytes, and returns the time per pair.
+static real64 Benchmark(int32 pairCount, void* (*allocFunction)(size_t), void (*freeFunction)(void*))
+{
+	void* blocks[SlotCount];
+	int32 i;
+
+	Timer timer;
+	timer.Start();
+	for (i = 0; i < pairCount; i++)
+	{
+		int32 slot = i & (SlotCount - 1);
+		if (i >= SlotCount)
+		{
+			freeFunction(blocks[slot]);
+		}
+		blocks[slot] = allocFunction(16 + (i & 255));
+	}
+	for (i = 0; i < Math::Min(pairCount, SlotCount); i++)
+	{
+		freeFunction(blocks[i]);
+	}
+	timer.Stop();
+
+	return timer.Elapsed() * 1.0e9 / pairCount;
+}
+
+int main(int argc, char** argv)
+{
+	int32 pairCount = 2000000;
+
+	Console::WriteLine(_T("MemoryTrackerBenchmark"));
+	Console::WriteLine(_T("======================"));
+
+	if (argc == 2)
+	{
+		pairCount = Math::Max(String(argv[1]).ToInt32(), SlotCount);
+	}
+	else if (argc != 1)
+	{
+		Console::WriteLine(_T("MemoryTrackerBenchmark [pairCount]"));
+		return -1;
+	}
+
+	bool result = true;
+	result &= TestTagStats();
+	result &= TestSnapshot();
+	result &= TestReAlloc();
+
+	Console::WriteLine(_T("Tracking in Memory: ") + String(MemoryTracker::IsEnabled() ? _T("enabled") : _T("disabled")));
+	Console::WriteLine(_T("Untracked alloc/free: ") + String::ToString(Benchmark(pairCount, SystemAlloc, SystemFree)) + _T(" ns"));
+	Console::WriteLine(_T("Tracked alloc/free:   ") + String::ToString(Benchmark(pairCount, TrackedAlloc, TrackedFree)) + _T(" ns"));
+
+	Console::WriteLine(result ? _T("All tests passed.") : _T("Some tests failed."));
+	return (result ? 0 : 1);
+}
@@ -0,0 +1,775 @@
+/*=============================================================================
+NarrowPhaseTest.cpp
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+#include <Core/Core.h>
+#include <PhysicsSystem_Software/SoftwarePhysicsSystem.h>
+#include <PhysicsSystem_Software/NarrowPhase.h>
+#include <PhysicsSystem_Software/PhysicsBody.h>
+
+using namespace SonataEngine;
+using namespace SonataEngine::Physics;
+using namespace SE_Software;
+
+/*
+	Tests and benchmark of the narrow phase of the software physics system.
+
+	NarrowPhaseTest [pairs]
+
+	The contacts of the pairs of shapes are checked against their analytic
+	values, the manifolds against their persistence and reduction rules, and
+	the box/box contacts against a separating axis test. The throughput of
+	each collision function is then measured, alone and with the update of
+	the manifolds, in millions of pairs per second.
+*/
+
+static SoftwarePhysicsSystem* _PhysicsSystem = NULL;
+static IScene* _Scene = NULL;
+static int32 _FailureCount = 0;
+
+/// Creates the scene of the bodies, they are created without updating the scene and all their pairs are given to the narrow phase.
+static void CreateScene()
+{
+	SceneDescription desc;
+	desc._BroadPhase = BroadPhaseType_None;
+	_Scene = _PhysicsSystem->CreateScene(desc);
+}
+
+static void DestroyScene()
+{
+	_PhysicsSystem->DestroyScene(_Scene);
+	_Scene = NULL;
+}
+
+static void Check(bool condition, const String& name)
+{
+	if (!condition)
+	{
+		Console::WriteLine(_T("FAILED: ") + name);
+		_FailureCount++;
+	}
+}
+
+static bool IsNear(real a, real b, real tolerance = 1e-4f)
+{
+	return (Math::Abs(a - b) <= tolerance);
+}
+
+static bool IsNear(const Vector3& a, const Vector3& b, real tolerance = 1e-4f)
+{
+	return IsNear(a.X, b.X, tolerance) && IsNear(a.Y, b.Y, tolerance) && IsNear(a.Z, b.Z, tolerance);
+}
+
+static Matrix3 CreateRotation(const Vector3& axis, real angle)
+{
+	return Matrix3::CreateFromAxisAngle(Vector3::Normalize(axis), angle);
+}
+
+/// Creates a static body, the shapes of the static bodies are moved with their body.
+static PhysicsBody* CreateBody(IShape* shape, const Vector3& position, const Matrix3& orientation)
+{
+	BodyDescription desc;
+	desc._BodyType = BodyType_Static;
+	desc._Shapes.Add(shape);
+
+	PhysicsBody* body = (PhysicsBody*)_Scene->CreateBody(desc);
+	body->SetOrientationMatrix(orientation);
+	body->SetPosition(position);
+	return body;
+}
+
+static PhysicsBody* CreateSphere(const Vector3& center, real radius)
+{
+	ISphereShape* shape = new ISphereShape();
+	shape->Data = BoundingSphere(center, radius);
+	return CreateBody(shape, center, Matrix3::Identity);
+}
+
+static PhysicsBody* CreateBox(const Vector3& center, const Vector3& extents, const Matrix3& rotation)
+{
+	IBoxShape* shape = new IBoxShape();
+	shape->Data = OBB(center, extents, rotation);
+	return CreateBody(shape, center, rotation);
+}
+
+static PhysicsBody* CreatePlane(const Vector3& normal, real d)
+{
+	IPlaneShape* shape = new IPlaneShape();
+	shape->Data.Normal = normal;
+	shape->Data.D = d;
+	return CreateBody(shape, Vector3::Zero, Matrix3::Identity);
+}
+
+static void MoveBody(PhysicsBody* body, const Vector3& position, const Matrix3& orientation)
+{
+	body->SetOrientationMatrix(orientation);
+	body->SetPosition(position);
+}
+
+static const OBB& GetBox(const PhysicsBody* body)
+{
+	return ((const IBoxShape*)body->Shapes()[0].Get())->Data;
+}
+
+/// Finds the contacts of a single pair, returns NULL if the bodies don't touch.
+static const ContactManifold* Collide(NarrowPhase& narrowPhase, PhysicsBody* bodyA, PhysicsBody* bodyB)
+{
+	narrowPhase.AddPair(bodyA, bodyB);
+	narrowPhase.Update();
+	if (narrowPhase.GetTouchingManifolds().IsEmpty())
+		return NULL;
+
+	return &narrowPhase.GetManifold(narrowPhase.GetTouchingManifolds()[0]);
+}
+
+/// Gets the normal of a manifold pointing to a body, whatever the order of the bodies in the manifold.
+static Vector3 GetNormal(const ContactManifold* manifold, const PhysicsBody* body)
+{
+	return (manifold->_BodyA == body ? manifold->_Normal : -manifold->_Normal);
+}
+
+static bool HasPoint(const ContactManifold* manifold, const Vector3& position, real depth)
+{
+	for (int32 i = 0; i < manifold->_PointCount; i++)
+	{
+		if (IsNear(manifold->_Points[i]._Position, position, 1e-3f) && IsNear(manifold->_Points[i]._Depth, depth, 1e-3f))
+			return true;
+	}
+	return false;
+}
+
+static void TestSpheres()
+{
+	{
+		NarrowPhase narrowPhase;
+		PhysicsBody* plane = CreatePlane(Vector3::UnitY, 0.0f);
+		PhysicsBody* sphere = CreateSphere(Vector3(0.0f, 0.9f, 0.0f), 1.0f);
+		const ContactManifold* manifold = Collide(narrowPhase, sphere, plane);
+		Check(manifold != NULL && manifold->_PointCount == 1, _T("sphere/plane"));
+		if (manifold != NULL)
+		{
+			Check(IsNear(GetNormal(manifold, sphere), Vector3::UnitY), _T("sphere/plane normal"));
+			Check(HasPoint(manifold, Vector3(0.0f, -0.05f, 0.0f), 0.1f), _T("sphere/plane point"));
+		}
+	}
+	{
+		NarrowPhase narrowPhase;
+		PhysicsBody* plane = CreatePlane(Vector3::UnitY, 0.0f);
+		PhysicsBody* sphere = CreateSphere(Vector3(0.0f, 1.1f, 0.0f), 1.0f);
+		Check(Collide(narrowPhase, sphere, plane) == NULL, _T("sphere/plane separated"));
+	}
+	{
+		NarrowPhase narrowPhase;
+		PhysicsBody* sphereB = CreateSphere(Vector3::Zero, 1.0f);
+		PhysicsBody* sphereA = CreateSphere(Vector3(1.5f, 0.0f, 0.0f), 1.0f);
+		const ContactManifold* manifold = Collide(narrowPhase, sphereA, sphereB);
+		Check(manifold != NULL && manifold->_PointCount == 1, _T("sphere/sphere"));
+		if (manifold != NULL)
+		{
+			Check(IsNear(GetNormal(manifold, sphereA), Vector3::UnitX), _T("sphere/sphere normal"));
+			Check(HasPoint(manifold, Vector3(0.75f, 0.0f, 0.0f), 0.5f), _T("sphere/sphere point"));
+			Check(manifold->_BodyA == sphereB, _T("sphere/sphere bodies sorted by proxy"));
+		}
+	}
+	{
+		// The normal of concentric spheres is arbitrary but valid
+		NarrowPhase narrowPhase;
+		PhysicsBody* sphereA = CreateSphere(Vector3::Zero, 1.0f);
+		PhysicsBody* sphereB = CreateSphere(Vector3::Zero, 0.5f);
+		const ContactManifold* manifold = Collide(narrowPhase, sphereA, sphereB);
+		Check(manifold != NULL && IsNear(manifold->_Points[0]._Depth, 1.5f) && IsNear(manifold->_Normal, Vector3::UnitY),
+			_T("sphere/sphere concentric"));
+	}
+}
+
+static void TestBoxPlane()
+{
+	{
+		NarrowPhase narrowPhase;
+		PhysicsBody* plane = CreatePlane(Vector3::UnitY, 0.0f);
+		PhysicsBody* box = CreateBox(Vector3(3.0f, 0.95f, 2.0f), Vector3(1.0f), Matrix3::Identity);
+		const ContactManifold* manifold = Collide(narrowPhase, box, plane);
+		Check(manifold != NULL && manifold->_PointCount == 4, _T("box/plane face"));
+		if (manifold != NULL)
+		{
+			Check(IsNear(GetNormal(manifold, box), Vector3::UnitY), _T("box/plane face normal"));
+			for (int32 x = -1; x <= 1; x += 2)
+			{
+				for (int32 z = -1; z <= 1; z += 2)
+				{
+					Check(HasPoint(manifold, Vector3(3.0f + x, -0.025f, 2.0f + z), 0.05f), _T("box/plane face corner"));
+				}
+			}
+		}
+	}
+	{
+		NarrowPhase narrowPhase;
+		PhysicsBody* plane = CreatePlane(Vector3::UnitY, 0.0f);
+		PhysicsBody* box = CreateBox(Vector3(0.0f, Math::Sqrt(2.0f) - 0.1f, 0.0f), Vector3(1.0f),
+			CreateRotation(Vector3::UnitZ, Math::PiByFour));
+		const ContactManifold* manifold = Collide(narrowPhase, plane, box);
+		Check(manifold != NULL && manifold->_PointCount == 2, _T("box/plane edge"));
+		if (manifold != NULL)
+		{
+			Check(HasPoint(manifold, Vector3(0.0f, -0.05f, 1.0f), 0.1f) && HasPoint(manifold, Vector3(0.0f, -0.05f, -1.0f), 0.1f),
+				_T("box/plane edge points"));
+		}
+	}
+}
+
+static void TestBoxBox()
+{
+	real sqrt2 = Math::Sqrt(2.0f);
+	{
+		NarrowPhase narrowPhase;
+		PhysicsBody* boxB = CreateBox(Vector3::Zero, Vector3(1.0f), Matrix3::Identity);
+		PhysicsBody* boxA = CreateBox(Vector3(0.0f, 1.9f, 0.0f), Vector3(1.0f), Matrix3::Identity);
+		const ContactManifold* manifold = Collide(narrowPhase, boxA, boxB);
+		Check(manifold != NULL && manifold->_PointCount == 4, _T("box/box face"));
+		if (manifold != NULL)
+		{
+			Check(IsNear(GetNormal(manifold, boxA), Vector3::UnitY), _T("box/box face normal"));
+			for (int32 x = -1; x <= 1; x += 2)
+			{
+				for (int32 z = -1; z <= 1; z += 2)
+				{
+					Check(HasPoint(manifold, Vector3((real)x, 0.95f, (real)z), 0.1f), _T("box/box face corner"));
+				}
+			}
+		}
+	}
+	{
+		NarrowPhase narrowPhase;
+		PhysicsBody* boxB = CreateBox(Vector3::Zero, Vector3(1.0f), Matrix3::Identity);
+		PhysicsBody* boxA = CreateBox(Vector3(0.5f, 1.9f, 0.5f), Vector3(1.0f), Matrix3::Identity);
+		const ContactManifold* manifold = Collide(narrowPhase, boxA, boxB);
+		Check(manifold != NULL && manifold->_PointCount == 4, _T("box/box offset"));
+		if (manifold != NULL)
+		{
+			const real coordinates[2] = { -0.5f, 1.0f };
+			for (int32 i = 0; i < 2; i++)
+			{
+				for (int32 j = 0; j < 2; j++)
+				{
+					Check(HasPoint(manifold, Vector3(coordinates[i], 0.95f, coordinates[j]), 0.1f), _T("box/box offset corner"));
+				}
+			}
+		}
+	}
+	{
+		// The clipped face is an octagon, reduced to the four points covering the largest area
+		NarrowPhase narrowPhase;
+		PhysicsBody* boxB = CreateBox(Vector3::Zero, Vector3(1.0f), Matrix3::Identity);
+		PhysicsBody* boxA = CreateBox(Vector3(0.0f, 1.85f, 0.0f), Vector3(1.0f), CreateRotation(Vector3::UnitY, Math::PiByFour));
+		const ContactManifold* manifold = Collide(narrowPhase, boxA, boxB);
+		Check(manifold != NULL && manifold->_PointCount == 4, _T("box/box octagon reduced"));
+		if (manifold != NULL)
+		{
+			Vector3 minimum = manifold->_Points[0]._Position;
+			Vector3 maximum = minimum;
+			for (int32 i = 0; i < manifold->_PointCount; i++)
+			{
+				const ManifoldPoint& point = manifold->_Points[i];
+				Check(IsNear(point._Depth, 0.15f, 1e-3f) && IsNear(point._Position.Y, 0.925f, 1e-3f), _T("box/box octagon depth"));
+				minimum = Vector3::Min(minimum, point._Position);
+				maximum = Vector3::Max(maximum, point._Position);
+			}
+			Check(maximum.X - minimum.X > 1.5f && maximum.Z - minimum.Z > 1.5f, _T("box/box octagon area"));
+		}
+	}
+	{
+		NarrowPhase narrowPhase;
+		PhysicsBody* boxB = CreateBox(Vector3::Zero, Vector3(1.0f), CreateRotation(Vector3::UnitZ, Math::PiByFour));
+		PhysicsBody* boxA = CreateBox(Vector3(0.0f, 2.0f * sqrt2 - 0.1f, 0.0f), Vector3(1.0f), CreateRotation(Vector3::UnitX, Math::PiByFour));
+		const ContactManifold* manifold = Collide(narrowPhase, boxA, boxB);
+		Check(manifold != NULL && manifold->_PointCount == 1, _T("box/box edge"));
+		if (manifold != NULL)
+		{
+			Check(IsNear(GetNormal(manifold, boxA), Vector3::UnitY, 1e-3f), _T("box/box edge normal"));
+			Check(HasPoint(manifold, Vector3(0.0f, sqrt2 - 0.05f, 0.0f), 0.1f), _T("box/box edge point"));
+		}
+
+		// The point of the edges is replaced when the bodies move
+		MoveBody(boxA, Vector3(0.0f, 2.0f * sqrt2 - 0.11f, 0.0f), CreateRotation(Vector3::UnitX, Math::PiByFour));
+		manifold = Collide(narrowPhase, boxA, boxB);
+		Check(manifold != NULL && manifold->_PointCount == 1 && IsNear(manifold->_Points[0]._Depth, 0.11f, 1e-3f), _T("box/box edge moved"));
+
+		MoveBody(boxA, Vector3(0.01f, 2.0f * sqrt2 + 0.5f, 0.0f), CreateRotation(Vector3::UnitX, Math::PiByFour));
+		Check(Collide(narrowPhase, boxA, boxB) == NULL, _T("box/box edge separated"));
+	}
+	{
+		NarrowPhase narrowPhase;
+		PhysicsBody* boxB = CreateBox(Vector3::Zero, Vector3(1.0f), Matrix3::Identity);
+		PhysicsBody* boxA = CreateBox(Vector3(2.5f, 0.0f, 0.0f), Vector3(1.0f), CreateRotation(Vector3(1.0f, 1.0f, 0.0f), 0.3f));
+		Check(Collide(narrowPhase, boxA, boxB) == NULL, _T("box/box separated"));
+	}
+}
+
+static void TestSphereBox()
+{
+	struct SphereBoxCase
+	{
+		/// Center of the sphere, normal and point in the space of the box.
+		Vector3 _Center;
+		real _Depth;
+		Vector3 _Normal;
+		Vector3 _Position;
+	};
+
+	// The sphere is outside a face, outside a corner, inside near a face, and inside near the bottom face
+	const SphereBoxCase cases[4] =
+	{
+		{ Vector3(1.3f, 0.0f, 0.0f), 0.2f, Vector3::UnitX, Vector3(0.9f, 0.0f, 0.0f) },
+		{ Vector3(1.2f, 1.2f, 1.2f), 0.5f - Math::Sqrt(0.12f), Vector3(1.0f), Vector3(1.0f) },
+		{ Vector3(0.8f, 0.1f, 0.0f), 0.7f, Vector3::UnitX, Vector3(0.65f, 0.1f, 0.0f) },
+		{ Vector3(0.0f, -0.9f, 0.2f), 0.6f, -Vector3::UnitY, Vector3(0.0f, -0.7f, 0.2f) }
+	};
+
+	Matrix3 rotation = CreateRotation(Vector3::UnitZ, 0.5f);
+	Vector3 center(1.0f, 2.0f, 3.0f);
+	PhysicsBody* box = CreateBox(center, Vector3(1.0f), rotation);
+
+	for (int32 i = 0; i < 4; i++)
+	{
+		const SphereBoxCase& sphereBox = cases[i];
+		String name = _T("sphere/box ") + String::ToString(i);
+
+		NarrowPhase narrowPhase;
+		Vector3 sphereCenter = center + rotation.Transform(sphereBox._Center);
+		PhysicsBody* sphere = CreateSphere(sphereCenter, 0.5f);
+		const ContactManifold* manifold = Collide(narrowPhase, sphere, box);
+		Check(manifold != NULL && manifold->_PointCount == 1, name);
+		if (manifold == NULL)
+			continue;
+
+		Vector3 normal = rotation.Transform(Vector3::Normalize(sphereBox._Normal));
+		Check(IsNear(GetNormal(manifold, sphere), normal), name + _T(" normal"));
+		Check(IsNear(manifold->_Points[0]._Depth, sphereBox._Depth), name + _T(" depth"));
+
+		// The point of the corner is between the surface of the sphere and the corner
+		Vector3 position = center + rotation.Transform(sphereBox._Position);
+		if (i == 1)
+			position = ((sphereCenter - normal * 0.5f) + position) * 0.5f;
+		Check(IsNear(manifold->_Points[0]._Position, position), name + _T(" point"));
+	}
+
+	NarrowPhase narrowPhase;
+	PhysicsBody* sphere = CreateSphere(center + rotation.Transform(Vector3(1.6f, 0.0f, 0.0f)), 0.5f);
+	Check(Collide(narrowPhase, sphere, box) == NULL, _T("sphere/box separated"));
+}
+
+static int32 _FakeCallCount = 0;
+
+/// Collision function returning a point around the origin that changes at each call.
+static void CollideRotatingPoint(const CollisionPair* pairs, int32 count, CollisionResult* results)
+{
+	for (int32 i = 0; i < count; i++)
+	{
+		real angle = _FakeCallCount * 1.3f;
+		results[i]._Normal = Vector3::UnitY;
+		results[i]._PointCount = 1;
+		results[i]._Positions[0] = Vector3(Math::Cos(angle) * 0.5f, 0.0f, Math::Sin(angle) * 0.5f);
+		results[i]._Depths[0] = 0.01f * (1 + _FakeCallCount % 3);
+	}
+	_FakeCallCount++;
+}
+
+static void TestManifolds()
+{
+	{
+		// The points accumulate while the bodies don't move, then the manifold keeps the deepest point
+		NarrowPhase narrowPhase;
+		narrowPhase.SetCollideFunction(ShapeType_Sphere, ShapeType_Sphere, CollideRotatingPoint);
+		PhysicsBody* sphereA = CreateSphere(Vector3::Zero, 1.0f);
+		PhysicsBody* sphereB = CreateSphere(Vector3::Zero, 1.0f);
+
+		const ContactManifold* manifold = NULL;
+		for (int32 i = 1; i <= 5; i++)
+		{
+			manifold = Collide(narrowPhase, sphereA, sphereB);
+			Check(manifold != NULL && manifold->_PointCount == Math::Min(i, ContactManifold::MaxPoints),
+				_T("persistent points ") + String::ToString(i));
+		}
+
+		if (manifold != NULL)
+		{
+			real maxDepth = 0.0f;
+			for (int32 i = 0; i < manifold->_PointCount; i++)
+			{
+				maxDepth = Math::Max(maxDepth, manifold->_Points[i]._Depth);
+			}
+			Check(IsNear(maxDepth, 0.03f), _T("reduction keeps the deepest point"));
+		}
+
+		MoveBody(sphereB, Vector3(0.1f, 0.0f, 0.0f), Matrix3::Identity);
+		manifold = Collide(narrowPhase, sphereA, sphereB);
+		Check(manifold != NULL && manifold->_PointCount == 1, _T("moved bodies drop the old points"));
+	}
+	{
+		// The capsules are tested with the bounding box of their body
+		NarrowPhase narrowPhase;
+		ICapsuleShape* shape = new ICapsuleShape();
+		shape->Data = Capsule(Vector3::Zero, Vector3::UnitY, 2.0f, 1.0f);
+		PhysicsBody* capsule = CreateBody(shape, Vector3(0.0f, 0.9f, 0.0f), Matrix3::Identity);
+		PhysicsBody* plane = CreatePlane(Vector3::UnitY, 0.0f);
+		const ContactManifold* manifold = Collide(narrowPhase, capsule, plane);
+		Check(manifold != NULL && manifold->_PointCount == 4 && IsNear(manifold->_Points[0]._Depth, 0.1f), _T("capsule bounds"));
+	}
+	{
+		NarrowPhase narrowPhase;
+		Collide(narrowPhase, CreatePlane(Vector3::UnitY, 0.0f), CreatePlane(Vector3::UnitX, 0.0f));
+		Check(narrowPhase.GetManifoldCount() == 0, _T("plane/plane has no function"));
+	}
+	{
+		NarrowPhase narrowPhase;
+		PhysicsBody* spheres[6];
+		int32 i;
+		for (i = 0; i < 6; i++)
+		{
+			spheres[i] = CreateSphere(Vector3(i * 1.5f, 0.0f, 0.0f), 1.0f);
+		}
+
+		for (i = 0; i < 5; i++)
+		{
+			narrowPhase.AddPair(spheres[i], spheres[i + 1]);
+		}
+		narrowPhase.Update();
+		Check(narrowPhase.GetTouchingManifolds().Count() == 5 && narrowPhase.GetManifoldCount() == 5, _T("manifolds created"));
+
+		narrowPhase.DestroyManifold(spheres[1]->GetBroadPhaseProxy(), spheres[0]->GetBroadPhaseProxy());
+		narrowPhase.DestroyManifold(spheres[3]->GetBroadPhaseProxy(), spheres[2]->GetBroadPhaseProxy());
+		Check(narrowPhase.GetManifoldCount() == 3, _T("manifolds destroyed"));
+
+		for (i = 0; i < 5; i++)
+		{
+			narrowPhase.AddPair(spheres[i + 1], spheres[i]);
+		}
+		narrowPhase.Update();
+		Check(narrowPhase.GetManifoldCount() == 5, _T("manifolds recreated"));
+
+		for (i = 0; i < narrowPhase.GetManifoldCount(); i++)
+		{
+			const ContactManifold& manifold = narrowPhase.GetManifold(i);
+			Check(manifold._PointCount == 1 &&
+				manifold._BodyA->GetBroadPhaseProxy() + 1 == manifold._BodyB->GetBroadPhaseProxy(), _T("manifold bodies"));
+		}
+	}
+}
+
+static Vector3 RandomVector(Random& random, real minValue, real maxValue)
+{
+	real x = random.RandomReal(minValue, maxValue);
+	real y = random.RandomReal(minValue, maxValue);
+	real z = random.RandomReal(minValue, maxValue);
+	return Vector3(x, y, z);
+}
+
+static Matrix3 RandomRotation(Random& random, real maxAngle)
+{
+	Vector3 axis = RandomVector(random, -0.5f, 0.5f);
+	return CreateRotation(axis, random.RandomReal(maxAngle));
+}
+
+static void TestBatch()
+{
+	// The pairs of each function are processed in one call, the results must be the same as one pair at a time
+	RandomLCG random(7);
+	Array<PhysicsBody*> bodiesA;
+	Array<PhysicsBody*> bodiesB;
+	int32 i;
+	for (i = 0; i < 403; i++)
+	{
+		int32 kind = i % 5;
+		Vector3 center = RandomVector(random, 0.0f, 2.0f);
+		if (kind <= 2)
+			bodiesA.Add(CreateSphere(center, random.RandomReal(0.5f, 1.5f)));
+		else
+			bodiesA.Add(CreateBox(center, RandomVector(random, 0.3f, 1.3f), RandomRotation(random, 3.0f)));
+
+		if (kind == 0)
+		{
+			bodiesB.Add(CreateSphere(Vector3(1.0f), 1.0f));
+		}
+		else if (kind == 1 || kind == 3)
+		{
+			Vector3 normal(random.RandomReal(-0.5f, 0.5f), 1.0f, random.RandomReal(-0.5f, 0.5f));
+			bodiesB.Add(CreatePlane(Vector3::Normalize(normal), -1.5f));
+		}
+		else
+		{
+			bodiesB.Add(CreateBox(Vector3(1.0f), Vector3(0.5f, 0.8f, 0.6f), CreateRotation(Vector3(1.0f, 2.0f, 3.0f), 0.7f)));
+		}
+	}
+
+	NarrowPhase batch;
+	for (i = 0; i < bodiesA.Count(); i++)
+	{
+		batch.AddPair(bodiesA[i], bodiesB[i]);
+	}
+	batch.Update();
+
+	int32 touchingCount = 0;
+	int32 mismatchCount = 0;
+	for (i = 0; i < bodiesA.Count(); i++)
+	{
+		NarrowPhase single;
+		const ContactManifold* expected = Collide(single, bodiesA[i], bodiesB[i]);
+		if (expected != NULL)
+			touchingCount++;
+
+		const ContactManifold* manifold = NULL;
+		for (int32 j = 0; j < batch.GetManifoldCount(); j++)
+		{
+			const ContactManifold& batchManifold = batch.GetManifold(j);
+			if ((batchManifold._BodyA == bodiesA[i] && batchManifold._BodyB == bodiesB[i]) ||
+				(batchManifold._BodyA == bodiesB[i] && batchManifold._BodyB == bodiesA[i]))
+			{
+				manifold = &batchManifold;
+			}
+		}
+
+		int32 pointCount = (manifold != NULL ? manifold->_PointCount : 0);
+		int32 expectedCount = (expected != NULL ? expected->_PointCount : 0);
+		if (pointCount != expectedCount)
+		{
+			mismatchCount++;
+			continue;
+		}
+
+		for (int32 p = 0; p < pointCount; p++)
+		{
+			if (!IsNear(manifold->_Points[p]._Position, expected->_Points[p]._Position) ||
+				!IsNear(manifold->_Points[p]._Depth, expected->_Points[p]._Depth, 1e-5f) ||
+				!IsNear(manifold->_Normal, expected->_Normal, 1e-5f))
+			{
+				mismatchCount++;
+			}
+		}
+	}
+
+	Check(mismatchCount == 0 && touchingCount == batch.GetTouchingManifolds().Count(), _T("batched pairs"));
+	Console::WriteLine(_T("Batched pairs touching: ") + String::ToString(touchingCount) + _T("/") + String::ToString(bodiesA.Count()));
+}
+
+/// Finds the smallest penetration of two boxes along the 15 axes of the separating axis test, negative if they are separated.
+static real GetBoxPenetration(const OBB& boxA, const OBB& boxB)
+{
+	Vector3 axes[15];
+	int32 axisCount = 0;
+	int32 i;
+	for (i = 0; i < 3; i++)
+	{
+		axes[axisCount++] = boxA.Rotation.GetColumn(i);
+		axes[axisCount++] = boxB.Rotation.GetColumn(i);
+	}
+	for (i = 0; i < 3; i++)
+	{
+		for (int32 j = 0; j < 3; j++)
+		{
+			Vector3 axis = Vector3::Cross(boxA.Rotation.GetColumn(i), boxB.Rotation.GetColumn(j));
+			if (axis.LengthSquared() > 1e-6f)
+				axes[axisCount++] = Vector3::Normalize(axis);
+		}
+	}
+
+	real penetration = 0.0f;
+	for (i = 0; i < axisCount; i++)
+	{
+		real radiusA = 0.0f;
+		real radiusB = 0.0f;
+		for (int32 j = 0; j < 3; j++)
+		{
+			radiusA += boxA.Extents[j] * Math::Abs(Vector3::Dot(boxA.Rotation.GetColumn(j), axes[i]));
+			radiusB += boxB.Extents[j] * Math::Abs(Vector3::Dot(boxB.Rotation.GetColumn(j), axes[i]));
+		}
+		real distance = Math::Abs(Vector3::Dot(boxA.Center - boxB.Center, axes[i]));
+		penetration = (i == 0 ? radiusA + radiusB - distance : Math::Min(penetration, radiusA + radiusB - distance));
+	}
+	return penetration;
+}
+
+static void TestRandomBoxes()
+{
+	RandomLCG random(11);
+	int32 overlapCount = 0;
+	int32 errorCount = 0;
+	for (int32 i = 0; i < 3000; i++)
+	{
+		NarrowPhase narrowPhase;
+		PhysicsBody* boxB = CreateBox(Vector3::Zero, RandomVector(random, 0.3f, 1.3f), RandomRotation(random, 6.0f));
+		PhysicsBody* boxA = CreateBox(RandomVector(random, -2.0f, 2.0f), RandomVector(random, 0.3f, 1.3f), RandomRotation(random, 6.0f));
+		const ContactManifold* manifold = Collide(narrowPhase, boxA, boxB);
+
+		real penetration = GetBoxPenetration(GetBox(boxA), GetBox(boxB));
+		if (penetration < 0.0f)
+		{
+			if (manifold != NULL)
+				errorCount++;
+		}
+		else if (manifold == NULL)
+		{
+			overlapCount++;
+			errorCount++;
+		}
+		else
+		{
+			overlapCount++;
+
+			// The normal separates the boxes and the points are not deeper than the penetration
+			if (Vector3::Dot(GetNormal(manifold, boxA), GetBox(boxA).Center - GetBox(boxB).Center) < -1e-4f)
+				errorCount++;
+
+			for (int32 p = 0; p < manifold->_PointCount; p++)
+			{
+				real depth = manifold->_Points[p]._Depth;
+				if (depth < -1e-4f || depth > penetration / 0.95f + 0.02f)
+				{
+					errorCount++;
+					break;
+				}
+			}
+		}
+
+		_Scene->DestroyBody(boxA);
+		_Scene->DestroyBody(boxB);
+	}
+
+	Check(errorCount == 0, _T("random box/box: ") + String::ToString(errorCount) + _T(" errors"));
+	Console::WriteLine(_T("Random box/box overlapping: ") + String::ToString(overlapCount) + _T("/3000"));
+}
+
+static void Benchmark(int32 pairCount)
+{
+	static const SEchar* names[5] = { _T("sphere/sphere"), _T("sphere/plane"), _T("sphere/box"), _T("box/plane"), _T("box/box") };
+	static const int32 RepeatCount = 20;
+
+	RandomLCG random(1);
+	for (int32 kind = 0; kind < 5; kind++)
+	{
+		// The pairs are spread so they touch but don't overlap each other
+		CreateScene();
+		Array<PhysicsBody*> bodiesA;
+		Array<PhysicsBody*> bodiesB;
+		PhysicsBody* ground = CreatePlane(Vector3::UnitY, 0.0f);
+		int32 i;
+		for (i = 0; i < pairCount; i++)
+		{
+			Vector3 center(i * 10.0f, 0.0f, 0.0f);
+			Matrix3 rotation = RandomRotation(random, 0.3f);
+			switch (kind)
+			{
+			case 0:
+				bodiesA.Add(CreateSphere(center + Vector3(0.0f, random.RandomReal(0.5f, 1.1f), 0.0f), 0.5f));
+				bodiesB.Add(CreateSphere(center, 0.5f));
+				break;
+			case 1:
+				bodiesA.Add(CreateSphere(center + Vector3(0.0f, random.RandomReal(0.4f, 0.6f), 0.0f), 0.5f));
+				bodiesB.Add(ground);
+				break;
+			case 2:
+				bodiesA.Add(CreateSphere(center + Vector3(random.RandomReal(-0.5f, 0.5f), random.RandomReal(1.0f, 1.3f), random.RandomReal(-0.5f, 0.5f)), 0.5f));
+				bodiesB.Add(CreateBox(center, Vector3(1.0f, 0.6f, 1.0f), rotation));
+				break;
+			case 3:
+				bodiesA.Add(CreateBox(center + Vector3(0.0f, random.RandomReal(0.45f, 0.55f), 0.0f), Vector3(0.5f), rotation));
+				bodiesB.Add(ground);
+				break;
+			default:
+				bodiesA.Add(CreateBox(center + Vector3(random.RandomReal(0.4f), random.RandomReal(0.95f, 1.05f), random.RandomReal(0.4f)), Vector3(0.5f), rotation));
+				bodiesB.Add(CreateBox(center, Vector3(0.5f), Matrix3::Identity));
+				break;
+			}
+		}
+
+		// The best time of the updates, including the manifolds
+		NarrowPhase narrowPhase;
+		Timer timer;
+		real64 updateTime = 0.0;
+		int32 touchingCount = 0;
+		int32 r;
+		for (r = 0; r < RepeatCount; r++)
+		{
+			timer.Start();
+			for (i = 0; i < pairCount; i++)
+			{
+				narrowPhase.AddPair(bodiesA[i], bodiesB[i]);
+			}
+			narrowPhase.Update();
+			timer.Stop();
+			updateTime = (r == 0 ? timer.Elapsed() : Math::Min(updateTime, timer.Elapsed()));
+			touchingCount = narrowPhase.GetTouchingManifolds().Count();
+		}
+
+		// The best time of the collision function alone
+		BaseArray<CollisionPair> pairs;
+		BaseArray<CollisionResult> results;
+		pairs.Resize(pairCount);
+		results.Resize(pairCount);
+		for (i = 0; i < pairCount; i++)
+		{
+			CollisionPair& pair = pairs[i];
+			pair._ShapeA = bodiesA[i]->Shapes()[0].Get();
+			pair._ShapeB = bodiesB[i]->Shapes()[0].Get();
+			pair._BodyA = bodiesA[i];
+			pair._BodyB = bodiesB[i];
+			pair._Manifold = 0;
+			pair._IsSwapped = false;
+		}
+
+		CollideFunction function = narrowPhase.GetCollideFunction(pairs[0]._ShapeA->GetShapeType(), pairs[0]._ShapeB->GetShapeType());
+		real64 functionTime = 0.0;
+		for (r = 0; r < RepeatCount; r++)
+		{
+			timer.Start();
+			function(pairs.Data(), pairCount, results.Data());
+			timer.Stop();
+			functionTime = (r == 0 ? timer.Elapsed() : Math::Min(functionTime, timer.Elapsed()));
+		}
+
+		Console::WriteLine(String(names[kind]) + _T(": update ") + String::ToString(pairCount / updateTime / 1.0e6) +
+			_T(" Mpairs/s, function ") + String::ToString(pairCount / functionTime / 1.0e6) + _T(" Mpairs/s, touching ") +
+			String::ToString(touchingCount) + _T("/") + String::ToString(pairCount));
+
+		DestroyScene();
+	}
+}
+
+int main(int argc, char** argv)
+{
+	int32 pairCount = 20000;
+
+	Console::WriteLine(_T("NarrowPhaseTest"));
+	Console::WriteLine(_T("==============="));
+
+	if (argc == 2)
+	{
+		pairCount = Math::Max(String(argv[1]).ToInt32(), 1);
+	}
+	else if (argc != 1)
+	{
+		Console::WriteLine(_T("NarrowPhaseTest [pairs]"));
+		return -1;
+	}
+
+	_PhysicsSystem = new SoftwarePhysicsSystem();
+	_PhysicsSystem->Create(PhysicsSystemDescription());
+	CreateScene();
+
+	TestSpheres();
+	TestBoxPlane();
+	TestBoxBox();
+	TestSphereBox();
+	TestManifolds();
+	TestBatch();
+	TestRandomBoxes();
+
+	DestroyScene();
+	Console::WriteLine(_FailureCount == 0 ? _T("All tests passed.") : _T("Some tests failed."));
+
+	Benchmark(pairCount);
+
+	delete _PhysicsSystem;
+	return (_FailureCount == 0 ? 0 : 1);
+}
@@ -0,0 +1,656 @@
+/*=============================================================================
+PathRequestQueueBenchmark.cpp
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+#include <Core/Core.h>
+#include <AI/AI.h>
+
+using namespace SonataEngine;
+using namespace SonataEngine::AI;
+
+/*
+	Tests and benchmark of the path request queue.
+
+	PathRequestQueueBenchmark [frameCount workerCount]
+
+	The tests run a scripted sequence of requests on a 10x10 grid in both
+	modes: the identical requests are coalesced and then found in the cache,
+	the cache evicts its oldest paths, a node changing on a path invalidates
+	the requests, a running search is cancelled when its request is
+	released, and the released handles are not valid anymore.
+
+	The benchmark runs 600 frames of 16.7 ms by default on a 256x256 grid
+	with rooms, with 3 JobScheduler workers by default. 1000 agents patrol
+	between 64 connected waypoints, starting over the first 120 frames and
+	walking one cell per frame. Every 10 frames a free cell is blocked and a
+	wall opens. The paths are searched by A* during the frame, or by the queue
+	time-sliced with budgets of 2 and 8 ms, or threaded with a budget of
+	4 ms. The rest of the frame is idle, when the JobScheduler workers run.
+	The times are in milliseconds. Every delivered path must start at the
+	agent, end at the destination and cross only adjacent walkable cells.
+*/
+
+static const int32 GridSize = 256;
+static const int32 RoomSize = 64;
+static const int32 AgentCount = 1000;
+static const int32 WaypointCount = 64;
+
+/// Number of frames over which the agents start.
+static const int32 StartFrameCount = 120;
+
+/// Number of frames between two cell changes.
+static const int32 ChangePeriod = 10;
+
+static const int32 CacheSize = 1024;
+static const real64 FrameLength = 1.0 / 60.0;
+
+class TestMap : public GridPathfinderMap
+{
+public:
+	virtual bool IsWalkable(int32 x, int32 y) { return (_Walkable[y * _Width + x] != 0); }
+
+	/** Creates the cells, all walkable or with rooms and blocks of 4x4 cells. */
+	void Create(int32 width, int32 height, bool hasRooms, int32 seed)
+	{
+		RandomLCG random(seed);
+		SetSize(width, height);
+		_Walkable.Resize(width * height);
+		int32 x, y;
+		for (y = 0; y < height; y++)
+		{
+			for (x = 0; x < width; x++)
+			{
+				bool isWall = (hasRooms && (x % RoomSize == 0 || y % RoomSize == 0) && random.RandomReal(0.0f, 100.0f) < 97.0f);
+				_Walkable[y * width + x] = (isWall ? 0 : 1);
+			}
+		}
+
+		if (hasRooms)
+		{
+			int32 blockCount = width * height / 200;
+			for (int32 i = 0; i < blockCount; i++)
+			{
+				int32 blockX = GetRandomIndex(random, width);
+				int32 blockY = GetRandomIndex(random, height);
+				for (y = blockY; y < Math::Min(height, blockY + 4); y++)
+				{
+					for (x = blockX; x < Math::Min(width, blockX + 4); x++)
+						_Walkable[y * width + x] = 0;
+				}
+			}
+		}
+	}
+
+	bool IsNodeWalkable(PathfinderNodeID node) const { return (_Walkable[node] != 0); }
+
+	void SetNodeWalkable(PathfinderNodeID node, bool value) { _Walkable[node] = (value ? 1 : 0); }
+
+	PathfinderNodeID GetRandomWalkableNode(RandomLCG& random)
+	{
+		while (true)
+		{
+			PathfinderNodeID node = GetRandomIndex(random, _Walkable.Count());
+			if (_Walkable[node] != 0)
+				return node;
+		}
+	}
+
+	/** Marks the cells that can be reached from a cell. */
+	void GetReachableNodes(PathfinderNodeID source, BaseArray<SEbyte>& reachable)
+	{
+		reachable.Resize(_Walkable.Count());
+		for (int32 i = 0; i < reachable.Count(); i++)
+			reachable[i] = 0;
+
+		BaseArray<PathfinderNodeID> stack;
+		stack.Add(source);
+		reachable[source] = 1;
+		while (!stack.IsEmpty())
+		{
+			PathfinderNodeID node = stack[stack.Count() - 1];
+			stack.RemoveAt(stack.Count() - 1);
+
+			int32 x = GetNodeX(node);
+			int32 y = GetNodeY(node);
+			for (int32 i = 0; i < GetDirectionCount(); i++)
+			{
+				int32 dx, dy;
+				GetDirection(i, dx, dy);
+				if (!CanMove(x, y, dx, dy))
+					continue;
+
+				PathfinderNodeID neighbour = GetNodeID(x + dx, y + dy);
+				if (reachable[neighbour] == 0)
+				{
+					reachable[neighbour] = 1;
+					stack.Add(neighbour);
+				}
+			}
+		}
+	}
+
+	static int32 GetRandomIndex(RandomLCG& random, int32 count)
+	{
+		return Math::Min((int32)random.RandomReal(0.0f, (real)count), count - 1);
+	}
+
+protected:
+	BaseArray<SEbyte> _Walkable;
+};
+
+/// Goal of the searches, the requests of type 1 can't enter the left column.
+class TestGoal : public AStarPathfinderGoal
+{
+public:
+	TestGoal(TestMap* map) :
+		_Map(map),
+		_DestinationNode(PathfinderNodeID_Invalid),
+		_Type(0)
+	{
+	}
+
+	void SetType(int32 value) { _Type = value; }
+
+	virtual void SetDestinationNode(PathfinderNodeID node) { _DestinationNode = node; }
+
+	virtual real32 GetHeuristic(AStarPathfinderNode* node)
+	{
+		return GetDistance(node->_NodeID, _DestinationNode);
+	}
+
+	virtual real32 GetCost(AStarPathfinderNode* nodeA, AStarPathfinderNode* nodeB)
+	{
+		return GetDistance(nodeA->_NodeID, nodeB->_NodeID);
+	}
+
+	virtual bool IsSearchFinished(AStarPathfinderNode* node)
+	{
+		return (node->_NodeID == _DestinationNode);
+	}
+
+	virtual bool IsNodeValid(PathfinderNodeID node)
+	{
+		return (_Type == 0 || _Map->GetNodeX(node) != 0);
+	}
+
+protected:
+	real32 GetDistance(PathfinderNodeID nodeA, PathfinderNodeID nodeB) const
+	{
+		return _Map->GetDistance(_Map->GetNodeX(nodeA), _Map->GetNodeY(nodeA), _Map->GetNodeX(nodeB), _Map->GetNodeY(nodeB));
+	}
+
+	TestMap* _Map;
+	PathfinderNodeID _DestinationNode;
+	int32 _Type;
+};
+
+class TestQueue : public PathRequestQueue
+{
+public:
+	TestQueue(TestMap* map) :
+		_TestMap(map)
+	{
+	}
+
+	virtual ~TestQueue()
+	{
+		Destroy();
+	}
+
+protected:
+	virtual AStarPathfinderStorage* CreateStorage()
+	{
+		PooledAStarPathfinderStorage<AStarPathfinderNode>* storage = new PooledAStarPathfinderStorage<AStarPathfinderNode>();
+		storage->SetNodeCount(_TestMap->GetWidth() * _TestMap->GetHeight());
+		return storage;
+	}
+
+	virtual AStarPathfinderGoal* CreateGoal()
+	{
+		return new TestGoal(_TestMap);
+	}
+
+	virtual void InitializeGoal(AStarPathfinderGoal* goal, int32 type)
+	{
+		((TestGoal*)goal)->SetType(type);
+	}
+
+	TestMap* _TestMap;
+};
+
+static bool Check(bool value, const String& message)
+{
+	if (!value)
+		Console::WriteLine(_T("  FAILED: ") + message);
+	return value;
+}
+
+/// Updates the queue until the searches started by the previous calls are collected.
+static void UpdateQueue(PathRequestQueue& queue)
+{
+	queue.Update();
+	if (queue.GetMode() == PathRequestQueue::Mode_Threaded)
+		queue.Update();
+}
+
+static bool TestRequests(PathRequestQueue::Mode mode)
+{
+	TestMap map;
+	map.Create(10, 10, false, 1);
+	TestQueue queue(&map);
+	queue.Initialize(&map, mode, 2);
+	queue.SetTimeBudget(100000);
+
+	bool result = true;
+	PathRequestHandle a = queue.Request(0, 99);
+	PathRequestHandle b = queue.Request(0, 99);
+	PathRequestHandle c = queue.Request(0, 90, 1);
+	PathRequestHandle d = queue.Request(5, 95);
+	result &= Check(queue.GetCoalescedCount() == 1, _T("the identical requests are not coalesced"));
+	result &= Check(queue.GetStatus(a) == PathRequestQueue::RequestStatus_Pending, _T("a request is finished before the update"));
+	queue.Release(d);
+	result &= Check(queue.GetStatus(d) == PathRequestQueue::RequestStatus_Invalid, _T("a released request is valid"));
+
+	UpdateQueue(queue);
+	result &= Check(queue.GetStatus(a) == PathRequestQueue::RequestStatus_Succeeded &&
+		queue.GetStatus(b) == PathRequestQueue::RequestStatus_Succeeded, _T("the coalesced requests failed"));
+	result &= Check(queue.GetStatus(c) == PathRequestQueue::RequestStatus_Failed, _T("the request type is ignored"));
+	result &= Check(queue.GetPendingCount() == 0, _T("searches are still pending"));
+
+	BaseArray<PathfinderNodeID> path;
+	result &= Check(queue.GetPath(a, path) && path.Count() == 10 && path[0] == 0 && path[9] == 99, _T("wrong path"));
+	result &= Check(queue.GetCachedPathCount() == 2, _T("the paths are not cached"));
+	PathRequestHandle e = queue.Request(0, 99);
+	result &= Check(queue.GetStatus(e) == PathRequestQueue::RequestStatus_Succeeded && queue.GetCacheHitCount() == 1,
+		_T("the cached path is not found"));
+
+	// A node of the path changes
+	PathfinderNodeID node = path[5];
+	queue.InvalidateNode(node);
+	map.SetNodeWalkable(node, false);
+	result &= Check(queue.GetStatus(a) == PathRequestQueue::RequestStatus_Invalidated &&
+		queue.GetStatus(c) == PathRequestQueue::RequestStatus_Invalidated, _T("the requests are not invalidated"));
+	result &= Check(queue.GetCachedPathCount() == 0, _T("the invalidated paths are still cached"));
+	queue.Release(a);
+	queue.Release(b);
+	queue.Release(c);
+	queue.Release(e);
+	result &= Check(queue.GetStatus(a) == PathRequestQueue::RequestStatus_Invalid, _T("a released request is valid"));
+
+	PathRequestHandle f = queue.Request(0, 99);
+	result &= Check(queue.GetCacheHitCount() == 1, _T("an invalidated path is found in the cache"));
+	UpdateQueue(queue);
+	bool isValid = (queue.GetPath(f, path) && path.Count() >= 11 && path[0] == 0 && path[path.Count() - 1] == 99);
+	for (int32 i = 0; i < path.Count(); i++)
+		isValid &= (path[i] != node);
+	result &= Check(isValid, _T("the new path crosses the changed node"));
+	queue.Release(f);
+
+	// Cache eviction
+	queue.SetCacheSize(3);
+	BaseArray<PathRequestHandle> handles;
+	int32 i;
+	for (i = 0; i < 8; i++)
+		handles.Add(queue.Request(i, 90 + i));
+	UpdateQueue(queue);
+	result &= Check(queue.GetCachedPathCount() == 3, _T("the cache is not limited"));
+	for (i = 0; i < handles.Count(); i++)
+	{
+		result &= Check(queue.GetStatus(handles[i]) == PathRequestQueue::RequestStatus_Succeeded, _T("an evicted request failed"));
+		queue.Release(handles[i]);
+	}
+
+	// Cancellation of a running search, without time to finish it
+	queue.SetTimeBudget(0);
+	PathRequestHandle g = queue.Request(3, 96);
+	queue.Update();
+	queue.Release(g);
+	for (i = 0; i < 5; i++)
+		queue.Update();
+	result &= Check(queue.GetPendingCount() == 0, _T("the cancelled search is still pending"));
+
+	// The handles are reused with a new generation
+	PathRequestHandle h = queue.Request(1, 2);
+	result &= Check(h != g && queue.GetStatus(g) == PathRequestQueue::RequestStatus_Invalid, _T("an old handle is valid"));
+	queue.Release(h);
+	for (i = 0; i < 50; i++)
+		queue.Update();
+	result &= Check(queue.GetPendingCount() == 0, _T("a released search is still pending"));
+
+	return result;
+}
+
+struct Agent
+{
+	PathfinderNodeID _Node;
+	PathfinderNodeID _Destination;
+	int32 _StartFrame;
+	PathRequestHandle _Handle;
+	real64 _RequestTime;
+	BaseArray<PathfinderNodeID> _Path;
+	int32 _Step;
+};
+
+struct BenchmarkResult
+{
+	BaseArray<real64> _FrameTimes;
+	BaseArray<real64> _Latencies;
+	int32 _PathCount;
+	int32 _FailedCount;
+	int32 _InvalidatedCount;
+	int32 _InvalidPathCount;
+	int32 _CacheHitCount;
+	int32 _CoalescedCount;
+};
+
+/// Determines whether a cell is a waypoint or holds an agent, such cells are never blocked.
+static bool IsNodeUsed(const BaseArray<Agent>& agents, const BaseArray<PathfinderNodeID>& waypoints, PathfinderNodeID node)
+{
+	int32 i;
+	for (i = 0; i < waypoints.Count(); i++)
+	{
+		if (waypoints[i] == node)
+			return true;
+	}
+	for (i = 0; i < agents.Count(); i++)
+	{
+		if (agents[i]._Node == node)
+			return true;
+	}
+	return false;
+}
+
+/**
+	Checks that a delivered path goes from the agent to its destination through
+	adjacent walkable cells. The corners cut by the diagonal moves are not
+	checked, since their changes don't invalidate the paths.
+*/
+static bool IsPathValid(TestMap& map, const Agent& agent)
+{
+	const BaseArray<PathfinderNodeID>& path = agent._Path;
+	if (path.IsEmpty() || path[0] != agent._Node || path[path.Count() - 1] != agent._Destination)
+		return false;
+
+	for (int32 i = 0; i < path.Count(); i++)
+	{
+		if (!map.IsNodeWalkable(path[i]))
+			return false;
+		if (i == 0)
+			continue;
+
+		int32 dx = map.GetNodeX(path[i]) - map.GetNodeX(path[i - 1]);
+		int32 dy = map.GetNodeY(path[i]) - map.GetNodeY(path[i - 1]);
+		if (Math::Abs(dx) > 1 || Math::Abs(dy) > 1 || (dx == 0 && dy == 0))
+			return false;
+	}
+	return true;
+}
+
+/**
+	Simulates the agents.
+	@param isQueued false to search the paths with A* during the frame.
+*/
+static void Benchmark(bool isQueued, PathRequestQueue::Mode mode, int32 budget, int32 frameCount, BenchmarkResult& result)
+{
+	TestMap map;
+	map.Create(GridSize, GridSize, true, 1234);
+
+	// The waypoints are connected, until the cells change
+	RandomLCG random(99);
+	BaseArray<PathfinderNodeID> waypoints;
+	waypoints.Add(map.GetRandomWalkableNode(random));
+	BaseArray<SEbyte> reachable;
+	map.GetReachableNodes(waypoints[0], reachable);
+	int32 i;
+	while (waypoints.Count() < WaypointCount)
+	{
+		PathfinderNodeID node = map.GetRandomWalkableNode(random);
+		if (reachable[node] != 0)
+			waypoints.Add(node);
+	}
+
+	BaseArray<Agent> agents;
+	agents.Resize(AgentCount);
+	for (i = 0; i < AgentCount; i++)
+	{
+		agents[i]._Node = waypoints[TestMap::GetRandomIndex(random, WaypointCount)];
+		agents[i]._Destination = PathfinderNodeID_Invalid;
+		agents[i]._StartFrame = TestMap::GetRandomIndex(random, StartFrameCount);
+		agents[i]._Handle = PathRequestHandle_Invalid;
+		agents[i]._Step = 0;
+	}
+
+	TestQueue queue(&map);
+	queue.Initialize(&map, mode);
+	queue.SetTimeBudget(budget);
+	queue.SetCacheSize(CacheSize);
+
+	PooledAStarPathfinderStorage<AStarPathfinderNode> storage;
+	storage.SetNodeCount(GridSize * GridSize);
+	TestGoal goal(&map);
+	AStarPathfinder pathfinder;
+	pathfinder.Initialize(&storage, &goal, &map);
+
+	result._FrameTimes.Clear();
+	result._Latencies.Clear();
+	result._PathCount = 0;
+	result._FailedCount = 0;
+	result._InvalidatedCount = 0;
+	result._InvalidPathCount = 0;
+
+	Timer clock;
+	clock.Start();
+	for (int32 frame = 0; frame < frameCount; frame++)
+	{
+		real64 frameStart = clock.Elapsed();
+
+		// A cell is blocked and a wall opens
+		if (frame % ChangePeriod == ChangePeriod / 2)
+		{
+			PathfinderNodeID node;
+			do
+			{
+				node = map.GetRandomWalkableNode(random);
+			}
+			while (IsNodeUsed(agents, waypoints, node));
+			if (isQueued)
+				queue.InvalidateNode(node);
+			map.SetNodeWalkable(node, false);
+
+			node = TestMap::GetRandomIndex(random, GridSize * GridSize);
+			if (!map.IsNodeWalkable(node))
+			{
+				if (isQueued)
+					queue.InvalidateNode(node);
+				map.SetNodeWalkable(node, true);
+			}
+		}
+
+		for (i = 0; i < AgentCount; i++)
+		{
+			Agent& agent = agents[i];
+			if (agent._Handle != PathRequestHandle_Invalid || !agent._Path.IsEmpty() || frame < agent._StartFrame)
+				continue;
+
+			agent._Destination = waypoints[TestMap::GetRandomIndex(random, WaypointCount)];
+			agent._RequestTime = clock.Elapsed();
+			agent._Step = 0;
+			if (isQueued)
+			{
+				agent._Handle = queue.Request(agent._Node, agent._Destination);
+				continue;
+			}
+
+			pathfinder.SetSourceNode(agent._Node);
+			pathfinder.SetDestinationNode(agent._Destination);
+			pathfinder.Run();
+			if (pathfinder.GetStatus() == Pathfinder::Status_Succeeded)
+			{
+				int32 count = 0;
+				PathfinderNode* node;
+				for (node = pathfinder.GetCurrentNode(); node != NULL; node = node->_Parent)
+					count++;
+				agent._Path.Resize(count);
+				for (node = pathfinder.GetCurrentNode(); node != NULL; node = node->_Parent)
+					agent._Path[--count] = node->_NodeID;
+				if (!IsPathValid(map, agent))
+					result._InvalidPathCount++;
+			}
+			else
+			{
+				result._FailedCount++;
+			}
+			result._PathCount++;
+			result._Latencies.Add(clock.Elapsed() - agent._RequestTime);
+		}
+
+		if (isQueued)
+		{
+			queue.Update();
+			for (i = 0; i < AgentCount; i++)
+			{
+				Agent& agent = agents[i];
+				if (agent._Handle == PathRequestHandle_Invalid)
+					continue;
+
+				PathRequestQueue::RequestStatus status = queue.GetStatus(agent._Handle);
+				if (status == PathRequestQueue::RequestStatus_Pending)
+					continue;
+
+				if (status == PathRequestQueue::RequestStatus_Invalidated)
+				{
+					result._InvalidatedCount++;
+				}
+				else
+				{
+					result._PathCount++;
+					result._Latencies.Add(clock.Elapsed() - agent._RequestTime);
+					if (queue.GetPath(agent._Handle, agent._Path))
+					{
+						if (!IsPathValid(map, agent))
+							result._InvalidPathCount++;
+					}
+					else
+					{
+						result._FailedCount++;
+					}
+				}
+				queue.Release(agent._Handle);
+				agent._Handle = PathRequestHandle_Invalid;
+			}
+		}
+
+		// The agents walk one cell along their path, and search a new path at the end
+		for (i = 0; i < AgentCount; i++)
+		{
+			Agent& agent = agents[i];
+			if (agent._Path.IsEmpty())
+				continue;
+
+			if (agent._Step + 1 < agent._Path.Count())
+			{
+				PathfinderNodeID next = agent._Path[agent._Step + 1];
+				if (!map.IsNodeWalkable(next))
+				{
+					agent._Path.Clear();
+					continue;
+				}
+				agent._Node = next;
+				agent._Step++;
+			}
+			if (agent._Step + 1 >= agent._Path.Count())
+			{
+				agent._Path.Clear();
+				agent._StartFrame = frame;
+			}
+		}
+
+		real64 frameTime = clock.Elapsed() - frameStart;
+		result._FrameTimes.Add(frameTime);
+
+		// The rest of the frame is idle
+		if (frameTime < FrameLength)
+			Thread::Sleep((int32)((FrameLength - frameTime) * 1000.0));
+	}
+
+	result._CacheHitCount = queue.GetCacheHitCount();
+	result._CoalescedCount = queue.GetCoalescedCount();
+}
+
+static bool CompareTimes(const real64& left, const real64& right)
+{
+	return (left < right);
+}
+
+static real64 GetPercentile(const BaseArray<real64>& times, int32 percentile)
+{
+	return (times.IsEmpty() ? 0.0 : times[times.Count() * percentile / 100] * 1000.0);
+}
+
+int main(int argc, char** argv)
+{
+	int32 frameCount = 600;
+	int32 workerCount = 3;
+
+	Console::WriteLine(_T("PathRequestQueueBenchmark"));
+	Console::WriteLine(_T("========================="));
+
+	if (argc == 3)
+	{
+		frameCount = Math::Max(String(argv[1]).ToInt32(), 1);
+		workerCount = Math::Max(String(argv[2]).ToInt32(), 0);
+	}
+	else if (argc != 1)
+	{
+		Console::WriteLine(_T("PathRequestQueueBenchmark [frameCount workerCount]"));
+		return -1;
+	}
+
+	JobScheduler* scheduler = JobScheduler::Instance();
+	scheduler->Create(workerCount);
+
+	bool result = true;
+	Console::WriteLine(_T("Time-sliced queue"));
+	result &= TestRequests(PathRequestQueue::Mode_TimeSliced);
+	Console::WriteLine(_T("Threaded queue"));
+	result &= TestRequests(PathRequestQueue::Mode_Threaded);
+
+	const bool IsQueued[] = { false, true, true, true };
+	const PathRequestQueue::Mode Modes[] = { PathRequestQueue::Mode_TimeSliced, PathRequestQueue::Mode_TimeSliced,
+		PathRequestQueue::Mode_TimeSliced, PathRequestQueue::Mode_Threaded };
+	const int32 Budgets[] = { 0, 2000, 8000, 4000 };
+	const String Names[] = { _T("synchronous A*"), _T("time-sliced 2 ms"), _T("time-sliced 8 ms"), _T("threaded 4 ms") };
+
+	for (int32 b = 0; b < 4; b++)
+	{
+		BenchmarkResult benchmark;
+		Benchmark(IsQueued[b], Modes[b], Budgets[b], frameCount, benchmark);
+
+		BaseArray<real64>& frameTimes = benchmark._FrameTimes;
+		real64 sum = 0.0;
+		for (int32 i = 0; i < frameTimes.Count(); i++)
+			sum += frameTimes[i];
+		frameTimes.Sort(CompareTimes);
+		benchmark._Latencies.Sort(CompareTimes);
+
+		Console::WriteLine(Names[b] + _T(": ") + String::ToString(benchmark._PathCount) + _T(" paths, ") +
+			String::ToString(benchmark._FailedCount) + _T(" failed, ") +
+			String::ToString(benchmark._InvalidatedCount) + _T(" invalidated, ") +
+			String::ToString(benchmark._CacheHitCount) + _T(" cache hits, ") +
+			String::ToString(benchmark._CoalescedCount) + _T(" coalesced"));
+		Console::WriteLine(_T("  Main thread: mean ") + String::ToString(sum / frameTimes.Count() * 1000.0) +
+			_T(" ms/frame, p99 ") + String::ToString(GetPercentile(frameTimes, 99)) +
+			_T(" ms, max ") + String::ToString(frameTimes[frameTimes.Count() - 1] * 1000.0) + _T(" ms"));
+		Console::WriteLine(_T("  Latency: p50 ") + String::ToString(GetPercentile(benchmark._Latencies, 50)) +
+			_T(" ms, p99 ") + String::ToString(GetPercentile(benchmark._Latencies, 99)) + _T(" ms"));
+		result &= Check(benchmark._PathCount > 0, _T("no path delivered"));
+		result &= Check(benchmark._InvalidPathCount == 0, String::ToString(benchmark._InvalidPathCount) + _T(" invalid paths"));
+	}
+
+	scheduler->Destroy();
+
+	Console::WriteLine(result ? _T("All tests passed.") : _T("Some tests failed."));
+	return (result ? 0 : 1);
+}
@@ -0,0 +1,537 @@
+/*=============================================================================
+ResourceManagerBenchmark.cpp
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+#include <Core/Core.h>
+
+using namespace SonataEngine;
+
+/*
+	Tests and benchmark of the asynchronous loads of the resource manager.
+
+	ResourceManagerBenchmark [modelCount]
+
+	The tests check the order of the requests by priority, the dependencies
+	and the rejection of the cycles, the cancelled and the failed requests,
+	the callbacks of the resources already loaded and the reloads. A stress
+	test then runs rounds of requests with random dependencies, cancels,
+	priority changes, unloads, reloads and thread restarts, and checks that
+	every LoadAsync gets exactly one callback.
+
+	The benchmark loads a level of 200 models by default, each depending on
+	3 textures. The textures are 0.25 to 2 MB and can be decoded on a
+	thread, the models are 64 to 512 KB and must be decoded on the main
+	thread. Decoding makes 3 passes over the data. The level is loaded:
+	- with Load, 8 models and their textures per frame,
+	- with LoadAsync and Update once per frame, without threads,
+	- with LoadAsync and 2 read and 2 decode threads.
+	The asynchronous loads request the models from the closest to the
+	farthest and cancel the farthest 10%. The frames last 16.7 ms, the main
+	thread sleeping after Update for the rest of the frame. The times of
+	the frames are in milliseconds.
+*/
+
+static const SE_ID TextureType = SE_ID(0x1a2b3c4d, 0x00000001);
+static const SE_ID ModelType = SE_ID(0x1a2b3c4d, 0x00000002);
+
+static const int32 TexturesPerModel = 3;
+static const int32 MinTextureSize = 256 << 10;
+static const int32 MaxTextureSize = 2 << 20;
+static const int32 MinModelSize = 64 << 10;
+static const int32 MaxModelSize = 512 << 10;
+
+/// Number of passes of the decoding over the data.
+static const int32 DecodePassCount = 3;
+
+/// The files starting with this byte fail to load.
+static const SEbyte FailByte = 7;
+
+/// Duration of a frame, in milliseconds.
+static const real64 FrameTime = 16.7;
+
+/// Number of models loaded per frame with Load.
+static const int32 SyncModelsPerFrame = 8;
+
+static const int32 StressRoundCount = 20;
+static const int32 StressFileCount = 300;
+
+/**
+	Loads the files of the tests and the benchmark, decoding them with
+	passes over their data. The textures can be decoded on the threads.
+*/
+class BenchmarkHandler : public ResourceHandler
+{
+public:
+	virtual bool CanHandle(const SE_ID& type)
+	{
+		return (type == TextureType || type == ModelType);
+	}
+
+	virtual bool CanLoadAsync(const SE_ID& type, Stream& stream)
+	{
+		return (type == TextureType);
+	}
+
+	virtual Resource* Load(const String& name, const SE_ID& type, const String& path, Stream& stream)
+	{
+		int32 size = (int32)stream.GetLength();
+		SEbyte* data = new SEbyte[Math::Max(size, 1)];
+		if (stream.Read(data, size) != size || size == 0 || data[0] == FailByte)
+		{
+			delete[] data;
+			return NULL;
+		}
+
+		uint32 hash = 2166136261U;
+		for (int32 pass = 0; pass < DecodePassCount; pass++)
+		{
+			for (int32 i = 0; i < size; i++)
+			{
+				hash = (hash ^ data[i]) * 16777619U;
+				data[i] = (SEbyte)hash;
+			}
+		}
+
+		Resource* resource = new Resource();
+		resource->SetResourceType(type);
+		resource->SetData(data);
+		resource->SetSize(size);
+		return resource;
+	}
+
+	virtual bool Save(Resource* resource, const String& path, Stream& stream)
+	{
+		return false;
+	}
+
+	virtual bool Unload(Resource* resource)
+	{
+		SEbyte* data = (SEbyte*)resource->GetData();
+		SE_DELETE_ARRAY(data);
+		resource->SetData(NULL);
+		return true;
+	}
+};
+
+/// Callbacks received by a LoadAsync.
+struct CallbackCounter
+{
+	int32 _Count;
+	ResourceState _State;
+	Resource* _Resource;
+};
+
+/// Handles of the finished requests, in the order of their callbacks.
+static BaseArray<ResourceHandle> FinishedHandles;
+
+static void OnFinished(ResourceHandle handle, ResourceState state, Resource* resource, void* userData)
+{
+	CallbackCounter* counter = (CallbackCounter*)userData;
+	counter->_Count++;
+	counter->_State = state;
+	counter->_Resource = resource;
+	FinishedHandles.Add(handle);
+}
+
+static bool Check(bool value, const String& message)
+{
+	if (!value)
+		Console::WriteLine(_T("  FAILED: ") + message);
+	return value;
+}
+
+static bool CompareTimes(const real64& left, const real64& right)
+{
+	return (left < right);
+}
+
+static String GetFileName(const String& kind, int32 index)
+{
+	return _T("ResourceManagerBenchmark") + kind + String::ToString(index) + _T(".bin");
+}
+
+static void WriteFile(const String& fileName, int32 size, SEbyte first)
+{
+	File file(fileName);
+	FileStreamPtr stream = file.Open(FileMode_Create, FileAccess_Write, FileShare_None);
+
+	BaseArray<SEbyte> data;
+	data.Resize(size);
+	for (int32 i = 0; i < size; i++)
+		data[i] = (SEbyte)(i * 31 + size);
+	data[0] = first;
+	stream->Write(data.Data(), size);
+}
+
+static Resource* LoadFile(const String& fileName, const SE_ID& type)
+{
+	File file(fileName);
+	FileStreamPtr stream = file.Open(FileMode_Open, FileAccess_Read, FileShare_Read);
+	if (stream == NULL)
+		return NULL;
+
+	return ResourceManager::Instance()->Load(fileName, type, fileName, *stream);
+}
+
+/// Calls Update until the callbacks of the finished requests are called.
+static void Flush()
+{
+	ResourceManager::Instance()->Update();
+	ResourceManager::Instance()->Update();
+}
+
+static bool TestRequests()
+{
+	ResourceManager* manager = ResourceManager::Instance();
+	bool result = true;
+
+	int32 i;
+	for (i = 0; i < 8; i++)
+		WriteFile(GetFileName(_T("Test"), i), 1024, (i == 7 ? FailByte : 0));
+
+	CallbackCounter counters[10];
+	Memory::Set(counters, 0, sizeof(counters));
+	ResourceHandle handles[10];
+
+	// The requests are loaded by priority
+	FinishedHandles.Clear();
+	handles[0] = manager->LoadAsync(GetFileName(_T("Test"), 0), TextureType, GetFileName(_T("Test"), 0), 1.0f, OnFinished, &counters[0]);
+	handles[1] = manager->LoadAsync(GetFileName(_T("Test"), 1), TextureType, GetFileName(_T("Test"), 1), 3.0f, OnFinished, &counters[1]);
+	handles[2] = manager->LoadAsync(GetFileName(_T("Test"), 2), TextureType, GetFileName(_T("Test"), 2), 2.0f, OnFinished, &counters[2]);
+	result &= Check(manager->GetState(handles[0]) == ResourceState_Queued, _T("the request is not queued"));
+	for (i = 0; i < 3; i++)
+		result &= Check(manager->Wait(handles[i]) == ResourceState_Loaded, _T("the resource is not loaded"));
+	Flush();
+	result &= Check(FinishedHandles.Count() == 3 && FinishedHandles[0] == handles[1] &&
+		FinishedHandles[1] == handles[2] && FinishedHandles[2] == handles[0], _T("the requests are not loaded by priority"));
+
+	// A model is decoded after its texture, which gets its priority
+	FinishedHandles.Clear();
+	handles[3] = manager->LoadAsync(GetFileName(_T("Test"), 3), ModelType, GetFileName(_T("Test"), 3), 10.0f, OnFinished, &counters[3]);
+	handles[4] = manager->LoadAsync(GetFileName(_T("Test"), 4), TextureType, GetFileName(_T("Test"), 4), 0.0f, OnFinished, &counters[4]);
+	result &= Check(manager->AddDependency(handles[3], handles[4]), _T("the dependency is not added"));
+	result &= Check(!manager->AddDependency(handles[4], handles[3]), _T("a cycle of dependencies is added"));
+	result &= Check(!manager->AddDependency(handles[3], handles[3]), _T("a resource depends on itself"));
+	result &= Check(manager->Wait(handles[3]) == ResourceState_Loaded, _T("the model is not loaded"));
+	Flush();
+	result &= Check(FinishedHandles.Count() == 2 && FinishedHandles[0] == handles[4] && FinishedHandles[1] == handles[3],
+		_T("the model is loaded before its texture"));
+
+	// Cancelled and failed requests
+	handles[5] = manager->LoadAsync(GetFileName(_T("Test"), 5), TextureType, GetFileName(_T("Test"), 5), 0.0f, OnFinished, &counters[5]);
+	result &= Check(manager->Cancel(handles[5]) && manager->Wait(handles[5]) == ResourceState_Cancelled, _T("the request is not cancelled"));
+	handles[6] = manager->LoadAsync(GetFileName(_T("Test"), 7), TextureType, GetFileName(_T("Test"), 7), 0.0f, OnFinished, &counters[6]);
+	result &= Check(manager->Wait(handles[6]) == ResourceState_Failed, _T("the load does not fail"));
+	handles[7] = manager->LoadAsync(_T("ResourceManagerBenchmarkMissing.bin"), TextureType, _T("ResourceManagerBenchmarkMissing.bin"), 0.0f, OnFinished, &counters[7]);
+	result &= Check(manager->Wait(handles[7]) == ResourceState_Failed, _T("the load of a missing file does not fail"));
+	Flush();
+	result &= Check(counters[5]._State == ResourceState_Cancelled && counters[6]._State == ResourceState_Failed &&
+		counters[6]._Resource == NULL && counters[7]._State == ResourceState_Failed, _T("wrong states of the callbacks"));
+	result &= Check(!manager->Cancel(handles[0]), _T("a loaded resource is cancelled"));
+
+	// A resource already loaded calls back at once
+	handles[8] = manager->LoadAsync(GetFileName(_T("Test"), 0), TextureType, GetFileName(_T("Test"), 0), 0.0f, OnFinished, &counters[8]);
+	result &= Check(handles[8] == handles[0] && counters[8]._Count == 1 && counters[8]._State == ResourceState_Loaded,
+		_T("no callback of a loaded resource"));
+	result &= Check(manager->LoadAsync(GetFileName(_T("Test"), 0), ModelType, GetFileName(_T("Test"), 0)) == ResourceHandleInvalid,
+		_T("a resource is requested with another type"));
+
+	// A resource loaded by Load while its request is pending gets its handle
+	handles[9] = manager->LoadAsync(GetFileName(_T("Test"), 6), TextureType, GetFileName(_T("Test"), 6), 0.0f, OnFinished, &counters[9]);
+	Resource* resource = LoadFile(GetFileName(_T("Test"), 6), TextureType);
+	result &= Check(resource != NULL && resource->GetHandle() == handles[9], _T("the loaded resource has another handle"));
+	manager->Wait(handles[9]);
+	Flush();
+
+	// The reloads keep the resource
+	resource = manager->Get(handles[0]);
+	result &= Check(manager->Reload(handles[0]) && manager->Get(handles[0]) == resource && resource->GetData() != NULL,
+		_T("the resource is not reloaded in place"));
+
+	bool isValid = true;
+	for (i = 0; i < 10; i++)
+		isValid &= (counters[i]._Count == 1);
+	result &= Check(isValid, _T("a request has no callback or several"));
+
+	manager->UnloadAll();
+	result &= Check(manager->Get(handles[0]) == NULL && resource->GetData() == NULL, _T("the resources are not unloaded"));
+
+	for (i = 0; i < 8; i++)
+		File::Delete(GetFileName(_T("Test"), i));
+	return result;
+}
+
+static bool TestStress()
+{
+	ResourceManager* manager = ResourceManager::Instance();
+	bool result = true;
+
+	int32 i;
+	for (i = 0; i < StressFileCount; i++)
+		WriteFile(GetFileName(_T("Stress"), i), 64 + i * 16, (i % 13 == 0 ? FailByte : 0));
+
+	BaseArray<CallbackCounter> counters;
+	counters.Resize(StressFileCount);
+	BaseArray<ResourceHandle> handles;
+	handles.Resize(StressFileCount);
+	RandomLCG random(1);
+	int32 loadCount = 0;
+	int32 callbackErrors = 0;
+
+	for (int32 round = 0; round < StressRoundCount; round++)
+	{
+		if (round % 3 != 2)
+			manager->CreateThreads(2, 2);
+
+		Memory::Set(counters.Data(), 0, StressFileCount * sizeof(CallbackCounter));
+		for (i = 0; i < StressFileCount; i++)
+		{
+			String fileName = GetFileName(_T("Stress"), i);
+			handles[i] = manager->LoadAsync(fileName, ((i % 4) != 0 ? TextureType : ModelType), fileName,
+				(real32)random.RandomInt(0, 99), OnFinished, &counters[i]);
+			loadCount++;
+
+			if (i > 3 && random.RandomInt(0, 1) == 0)
+				manager->AddDependency(handles[i], handles[random.RandomInt(0, i - 1)]);
+			if (random.RandomInt(0, 9) == 0)
+				manager->Cancel(handles[random.RandomInt(0, i)]);
+			if (random.RandomInt(0, 9) == 0)
+				manager->SetPriority(handles[random.RandomInt(0, i)], 1000.0f);
+			if (random.RandomInt(0, 19) == 0)
+				manager->Update();
+			if (random.RandomInt(0, 39) == 0)
+				manager->Unload(handles[random.RandomInt(0, i)]);
+		}
+
+		if (round % 5 == 1)
+			manager->DestroyThreads();
+
+		for (i = 0; i < StressFileCount; i++)
+		{
+			if (random.RandomInt(0, 14) == 0)
+				manager->Cancel(handles[i]);
+		}
+
+		bool isFinished = true;
+		for (i = 0; i < StressFileCount; i++)
+		{
+			ResourceState state = manager->Wait(handles[i]);
+			isFinished &= (state != ResourceState_Queued && state != ResourceState_Reading &&
+				state != ResourceState_Waiting && state != ResourceState_Decoding);
+		}
+		Flush();
+		result &= Check(isFinished, _T("a request is still pending after Wait"));
+
+		for (i = 0; i < StressFileCount; i++)
+		{
+			if (counters[i]._Count != 1)
+				callbackErrors++;
+		}
+
+		if (round % 4 == 3)
+			result &= Check(manager->Reload(GetFileName(_T("Stress"), 5)) || manager->Get(GetFileName(_T("Stress"), 5)) == NULL,
+				_T("a loaded resource is not reloaded"));
+		if (round % 2 != 0)
+			manager->UnloadAll();
+
+		manager->DestroyThreads();
+	}
+	manager->UnloadAll();
+
+	result &= Check(callbackErrors == 0, String::ToString(callbackErrors) + _T(" requests without exactly one callback"));
+	Console::WriteLine(_T("  ") + String::ToString(StressRoundCount) + _T(" rounds, ") + String::ToString(loadCount) + _T(" LoadAsync"));
+
+	for (i = 0; i < StressFileCount; i++)
+		File::Delete(GetFileName(_T("Stress"), i));
+	return result;
+}
+
+static void WriteLevel(int32 modelCount)
+{
+	RandomLCG random(1);
+	for (int32 i = 0; i < modelCount * TexturesPerModel; i++)
+		WriteFile(GetFileName(_T("Texture"), i), random.RandomInt(MinTextureSize, MaxTextureSize), 0);
+	for (int32 i = 0; i < modelCount; i++)
+		WriteFile(GetFileName(_T("Model"), i), random.RandomInt(MinModelSize, MaxModelSize), 0);
+}
+
+static void DeleteLevel(int32 modelCount)
+{
+	for (int32 i = 0; i < modelCount * TexturesPerModel; i++)
+		File::Delete(GetFileName(_T("Texture"), i));
+	for (int32 i = 0; i < modelCount; i++)
+		File::Delete(GetFileName(_T("Model"), i));
+}
+
+static void Report(const String& title, BaseArray<real64>& frames, real64 totalTime)
+{
+	frames.Sort(CompareTimes);
+
+	real64 sum = 0.0;
+	int32 overCount = 0;
+	for (int32 i = 0; i < frames.Count(); i++)
+	{
+		sum += frames[i];
+		if (frames[i] > FrameTime)
+			overCount++;
+	}
+
+	Console::WriteLine(title);
+	Console::WriteLine(_T("  frames: ") + String::ToString(frames.Count()) +
+		_T(", mean: ") + String::ToString(sum / frames.Count()) +
+		_T(" ms, p99: ") + String::ToString(frames[frames.Count() * 99 / 100]) +
+		_T(" ms, max: ") + String::ToString(frames[frames.Count() - 1]) +
+		_T(" ms, over ") + String::ToString(FrameTime) + _T(" ms: ") + String::ToString(overCount));
+	Console::WriteLine(_T("  total: ") + String::ToString(totalTime) + _T(" ms"));
+}
+
+static bool BenchmarkLoad(int32 modelCount)
+{
+	ResourceManager* manager = ResourceManager::Instance();
+	BaseArray<real64> frames;
+	Timer total;
+	Timer frame;
+	int32 loadCount = 0;
+
+	total.Start();
+	for (int32 i = 0; i < modelCount; )
+	{
+		frame.Start();
+		for (int32 j = 0; j < SyncModelsPerFrame && i < modelCount; j++, i++)
+		{
+			for (int32 k = 0; k < TexturesPerModel; k++)
+			{
+				if (LoadFile(GetFileName(_T("Texture"), i * TexturesPerModel + k), TextureType) != NULL)
+					loadCount++;
+			}
+			if (LoadFile(GetFileName(_T("Model"), i), ModelType) != NULL)
+				loadCount++;
+		}
+		frame.Stop();
+		frames.Add(frame.Elapsed() * 1000.0);
+	}
+	total.Stop();
+
+	Report(_T("Load, ") + String::ToString(SyncModelsPerFrame) + _T(" models per frame"), frames, total.Elapsed() * 1000.0);
+	manager->UnloadAll();
+	return Check(loadCount == modelCount * (TexturesPerModel + 1), _T("a resource is not loaded"));
+}
+
+static bool BenchmarkLoadAsync(int32 modelCount, int32 readThreadCount, int32 decodeThreadCount)
+{
+	ResourceManager* manager = ResourceManager::Instance();
+	int32 requestCount = modelCount * (TexturesPerModel + 1);
+	BaseArray<CallbackCounter> counters;
+	counters.Resize(requestCount);
+	Memory::Set(counters.Data(), 0, requestCount * sizeof(CallbackCounter));
+	FinishedHandles.Clear();
+
+	BaseArray<real64> frames;
+	Timer total;
+	Timer frame;
+
+	total.Start();
+	if (readThreadCount > 0)
+		manager->CreateThreads(readThreadCount, decodeThreadCount);
+
+	frame.Start();
+	for (int32 i = 0; i < modelCount; i++)
+	{
+		// The closest models first
+		real32 priority = -(real32)i;
+		ResourceHandle textures[TexturesPerModel];
+		for (int32 k = 0; k < TexturesPerModel; k++)
+		{
+			String fileName = GetFileName(_T("Texture"), i * TexturesPerModel + k);
+			textures[k] = manager->LoadAsync(fileName, TextureType, fileName, priority, OnFinished, &counters[modelCount + i * TexturesPerModel + k]);
+		}
+
+		String fileName = GetFileName(_T("Model"), i);
+		ResourceHandle model = manager->LoadAsync(fileName, ModelType, fileName, priority, OnFinished, &counters[i]);
+		for (int32 k = 0; k < TexturesPerModel; k++)
+			manager->AddDependency(model, textures[k]);
+
+		// The farthest models are cancelled
+		if (i >= modelCount - modelCount / 10)
+			manager->Cancel(model);
+	}
+	manager->Update();
+	frame.Stop();
+	frames.Add(frame.Elapsed() * 1000.0);
+
+	while (FinishedHandles.Count() < requestCount)
+	{
+		frame.Start();
+		manager->Update();
+		frame.Stop();
+
+		real64 time = frame.Elapsed() * 1000.0;
+		frames.Add(time);
+		if (time < FrameTime)
+			Thread::Sleep((int32)(FrameTime - time));
+	}
+	total.Stop();
+
+	bool result = true;
+	int32 loadCount = 0;
+	int32 cancelCount = 0;
+	for (int32 i = 0; i < requestCount; i++)
+	{
+		if (counters[i]._State == ResourceState_Loaded)
+			loadCount++;
+		else if (counters[i]._State == ResourceState_Cancelled)
+			cancelCount++;
+		result &= Check(counters[i]._Count == 1, _T("a request has no callback or several"));
+	}
+	result &= Check(cancelCount == modelCount / 10 && loadCount == requestCount - cancelCount, _T("wrong states of the requests"));
+
+	String title = _T("LoadAsync, ");
+	if (readThreadCount > 0)
+		title += String::ToString(readThreadCount) + _T(" read and ") + String::ToString(decodeThreadCount) + _T(" decode threads");
+	else
+		title += _T("no threads");
+	Report(title, frames, total.Elapsed() * 1000.0);
+
+	manager->DestroyThreads();
+	manager->UnloadAll();
+	return result;
+}
+
+int main(int argc, char** argv)
+{
+	int32 modelCount = 200;
+
+	Console::WriteLine(_T("ResourceManagerBenchmark"));
+	Console::WriteLine(_T("========================"));
+
+	if (argc == 2)
+	{
+		modelCount = Math::Max(String(argv[1]).ToInt32(), 10);
+	}
+	else if (argc != 1)
+	{
+		Console::WriteLine(_T("ResourceManagerBenchmark [modelCount]"));
+		return -1;
+	}
+
+	BenchmarkHandler handler;
+	ResourceManager::Instance()->RegisterHandler(&handler);
+
+	bool result = true;
+	Console::WriteLine(_T("Tests"));
+	result &= TestRequests();
+	result &= TestStress();
+
+	WriteLevel(modelCount);
+	result &= BenchmarkLoad(modelCount);
+	result &= BenchmarkLoadAsync(modelCount, 0, 0);
+	result &= BenchmarkLoadAsync(modelCount, 2, 2);
+	DeleteLevel(modelCount);
+
+	ResourceManager::Instance()->UnregisterHandler(&handler);
+
+	Console::WriteLine(result ? _T("All tests passed.") : _T("Some tests failed."));
+	return (result ? 0 : 1);
+}
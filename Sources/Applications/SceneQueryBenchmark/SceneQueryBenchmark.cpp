@@ -0,0 +1,365 @@
+/*=============================================================================
+SceneQueryBenchmark.cpp
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+#include <Core/Core.h>
+#include <PhysicsSystem_Software/SoftwarePhysicsSystem.h>
+#include <PhysicsSystem_Software/BroadPhase.h>
+#include <PhysicsSystem_Software/ShapeQuery.h>
+
+using namespace SonataEngine;
+using namespace SonataEngine::Physics;
+using namespace SE_Software;
+
+/*
+	Tests and benchmark of the ray casts of the software physics scene.
+
+	SceneQueryBenchmark [rayCount]
+
+	The tests cast random rays and sweep random spheres against rotated
+	boxes and spheres with ShapeQuery, and compare the hits with a
+	reference that samples the ray.
+
+	The benchmark casts rays (200K by default) for the closest hit in a
+	200x20x200 world of 1K and 10K boxes and spheres above a ground plane,
+	through the AABBTree broad phase, as PhysicsScene::Raycast does. Each
+	hit shortens the ray, so farther subtrees are skipped. The same rays
+	are cast by collecting all the candidates of the broad phase first,
+	and by testing every shape. The rates are in millions of rays per
+	second, and the hits of the broad phase must match the hits of every
+	shape.
+*/
+
+/// Size of the world along the horizontal axes.
+static const real WorldSize = 200.0f;
+
+/// Maximum distance of the rays.
+static const real RayDistance = 100.0f;
+
+/// Number of rays tested against every shape.
+static const int32 ReferenceRayCount = 2000;
+
+/// Number of random shapes of the tests.
+static const int32 TestCount = 1000;
+
+/// Step of the sampled references, and tolerance of the distances of the hits.
+static const real SampleStep = 0.001f;
+static const real DistanceTolerance = 0.01f;
+
+struct Object
+{
+	ShapePtr _Shape;
+	AABB _Bounds;
+};
+
+struct ClosestHit
+{
+	RaycastHit _Hit;
+	bool _IsHit;
+};
+
+struct BenchmarkResult
+{
+	real64 _Closest;
+	real64 _Candidates;
+	real64 _BruteForce;
+	int32 _HitCount;
+	int32 _MismatchCount;
+};
+
+static bool Check(bool condition, const String& name)
+{
+	if (!condition)
+	{
+		Console::WriteLine(_T("  FAILED: ") + name);
+	}
+	return condition;
+}
+
+static Vector3 RandomVector(RandomLCG& random, real size)
+{
+	return Vector3(random.RandomReal(-size, size), random.RandomReal(-size, size), random.RandomReal(-size, size));
+}
+
+static OBB RandomBox(RandomLCG& random)
+{
+	return OBB(RandomVector(random, 2.0f),
+		Vector3(random.RandomReal(0.2f, 1.2f), random.RandomReal(0.2f, 1.2f), random.RandomReal(0.2f, 1.2f)),
+		Matrix3::CreateFromYawPitchRoll(random.RandomReal(0.0f, Math::TwoPi),
+			random.RandomReal(0.0f, Math::TwoPi), random.RandomReal(0.0f, Math::TwoPi)));
+}
+
+/// Gets the distance of a point to a box, 0 if the point is inside.
+static real GetBoxDistance(const OBB& box, const Vector3& point)
+{
+	Vector3 delta = point - box.Center;
+	real result = 0.0f;
+	for (int32 i = 0; i < 3; i++)
+	{
+		real outside = Math::Abs(Vector3::Dot(box.Rotation.GetColumn(i), delta)) - box.Extents[i];
+		if (outside > 0.0f)
+			result += outside * outside;
+	}
+	return Math::Sqrt(result);
+}
+
+/**
+	Checks a hit against the distance of the first sample that hits, -1 if none.
+	A reference at the start of the ray may be missed by a query that grazes the shape.
+*/
+static bool CheckHit(bool isHit, const RaycastHit& hit, real reference, const Vector3& direction)
+{
+	if (isHit != (reference >= 0.0f))
+		return (reference >= 0.0f && reference < DistanceTolerance);
+	if (!isHit)
+		return true;
+	return (Math::Abs(hit._Distance - reference) < DistanceTolerance && Vector3::Dot(hit._Normal, direction) <= 1.0e-4f);
+}
+
+static bool TestPrimitives()
+{
+	RandomLCG random(3);
+	bool rayBox = true;
+	bool raySphere = true;
+	bool sweepBox = true;
+	const real MaxDistance = 12.0f;
+
+	for (int32 i = 0; i < TestCount; i++)
+	{
+		OBB box = RandomBox(random);
+		BoundingSphere sphere(box.Center, random.RandomReal(0.2f, 1.2f));
+		Vector3 origin = RandomVector(random, 6.0f);
+		Vector3 direction = Vector3::Normalize(box.Center + RandomVector(random, 1.5f) - origin);
+		Ray3 ray(origin, direction);
+		real radius = random.RandomReal(0.1f, 0.9f);
+		real boxReference = -1.0f;
+		real sphereReference = -1.0f;
+		real sweepReference = -1.0f;
+
+		for (real t = 0.0f; t < MaxDistance; t += SampleStep)
+		{
+			Vector3 point = origin + direction * t;
+			real distance = GetBoxDistance(box, point);
+			if (boxReference < 0.0f && distance == 0.0f)
+				boxReference = t;
+			if (sweepReference < 0.0f && distance <= radius)
+				sweepReference = t;
+			if (sphereReference < 0.0f && (point - sphere.Center).LengthSquared() <= sphere.Radius * sphere.Radius)
+				sphereReference = t;
+		}
+
+		RaycastHit hit;
+		bool isHit = ShapeQuery::RaycastBox(box, ray, MaxDistance, hit);
+		rayBox &= CheckHit(isHit, hit, boxReference, direction);
+
+		isHit = ShapeQuery::RaycastSphere(sphere, ray, MaxDistance, hit);
+		raySphere &= CheckHit(isHit, hit, sphereReference, direction);
+
+		isHit = ShapeQuery::SweepSphereBox(BoundingSphere(origin, radius), direction, MaxDistance, box, hit);
+		sweepBox &= CheckHit(isHit, hit, sweepReference, direction);
+	}
+
+	bool result = true;
+	result &= Check(rayBox, _T("ray against box"));
+	result &= Check(raySphere, _T("ray against sphere"));
+	result &= Check(sweepBox, _T("sphere sweep against box"));
+	return result;
+}
+
+/// Creates the ground plane, and boxes and spheres with unit sizes, the ground is the last object.
+static void CreateObjects(int32 count, BaseArray<Object>& objects)
+{
+	RandomLCG random(1);
+	objects.Resize(count + 1);
+	for (int32 i = 0; i < count; i++)
+	{
+		Vector3 center(random.RandomReal(0.0f, WorldSize), random.RandomReal(1.0f, 21.0f), random.RandomReal(0.0f, WorldSize));
+		if ((i & 1) != 0)
+		{
+			ISphereShape* shape = new ISphereShape();
+			shape->Data = BoundingSphere(center, random.RandomReal(0.5f, 1.5f));
+			Vector3 extents(shape->Data.Radius, shape->Data.Radius, shape->Data.Radius);
+			objects[i]._Shape = shape;
+			objects[i]._Bounds = AABB(center - extents, center + extents);
+		}
+		else
+		{
+			IBoxShape* shape = new IBoxShape();
+			shape->Data = OBB(center, Vector3(random.RandomReal(0.5f, 1.5f), random.RandomReal(0.5f, 1.5f),
+				random.RandomReal(0.5f, 1.5f)), Matrix3::Identity);
+			objects[i]._Shape = shape;
+			objects[i]._Bounds = AABB(center - shape->Data.Extents, center + shape->Data.Extents);
+		}
+	}
+
+	IPlaneShape* ground = new IPlaneShape();
+	ground->Data = Plane(Vector3::UnitY, 0.0f);
+	objects[count]._Shape = ground;
+	objects[count]._Bounds = AABB(Vector3::Zero, Vector3::Zero);
+}
+
+/// Tests a candidate and shortens the ray to its hit, like PhysicsScene::RaycastClosestBody.
+static real RaycastClosest(void* userData, const Ray3& ray, real maxDistance, void* context)
+{
+	const Object* object = (const Object*)userData;
+	RaycastHit hit;
+	if (!ShapeQuery::Raycast(object->_Shape.Get(), object->_Bounds, ray, maxDistance, hit))
+		return maxDistance;
+
+	ClosestHit* closest = (ClosestHit*)context;
+	closest->_Hit = hit;
+	closest->_IsHit = true;
+	return hit._Distance;
+}
+
+static real CollectCandidate(void* userData, const Ray3& ray, real maxDistance, void* context)
+{
+	((BaseArray<void*>*)context)->Add(userData);
+	return maxDistance;
+}
+
+static bool RaycastCandidates(const BroadPhase* broadPhase, const Ray3& ray, BaseArray<void*>& candidates, RaycastHit& hit)
+{
+	candidates.Clear();
+	broadPhase->Raycast(ray, RayDistance, CollectCandidate, &candidates);
+
+	bool isHit = false;
+	real maxDistance = RayDistance;
+	for (int32 i = 0; i < candidates.Count(); i++)
+	{
+		const Object* object = (const Object*)candidates[i];
+		if (ShapeQuery::Raycast(object->_Shape.Get(), object->_Bounds, ray, maxDistance, hit))
+		{
+			maxDistance = hit._Distance;
+			isHit = true;
+		}
+	}
+	return isHit;
+}
+
+static bool RaycastBruteForce(const BaseArray<Object>& objects, const Ray3& ray, RaycastHit& hit)
+{
+	bool isHit = false;
+	real maxDistance = RayDistance;
+	for (int32 i = 0; i < objects.Count(); i++)
+	{
+		if (ShapeQuery::Raycast(objects[i]._Shape.Get(), objects[i]._Bounds, ray, maxDistance, hit))
+		{
+			maxDistance = hit._Distance;
+			isHit = true;
+		}
+	}
+	return isHit;
+}
+
+static void Benchmark(int32 count, int32 rayCount, BenchmarkResult& result)
+{
+	BaseArray<Object> objects;
+	CreateObjects(count, objects);
+
+	BroadPhase* broadPhase = BroadPhase::Create(BroadPhaseType_AABBTree);
+	int32 i;
+	for (i = 0; i < objects.Count(); i++)
+	{
+		broadPhase->CreateProxy(objects[i]._Bounds, &objects[i], i == count);
+	}
+	broadPhase->UpdatePairs();
+
+	// The rays start above the ground and mostly look down
+	RandomLCG random(2);
+	BaseArray<Ray3> rays;
+	rays.Resize(rayCount);
+	for (i = 0; i < rayCount; i++)
+	{
+		Vector3 origin(random.RandomReal(0.0f, WorldSize), random.RandomReal(2.0f, 22.0f), random.RandomReal(0.0f, WorldSize));
+		Vector3 direction(random.RandomReal(-1.0f, 1.0f), random.RandomReal(-1.2f, 0.8f), random.RandomReal(-1.0f, 1.0f));
+		rays[i] = Ray3(origin, Vector3::Normalize(direction));
+	}
+
+	BaseArray<ClosestHit> hits;
+	hits.Resize(rayCount);
+	Timer timer;
+
+	timer.Start();
+	for (i = 0; i < rayCount; i++)
+	{
+		hits[i]._IsHit = false;
+		broadPhase->Raycast(rays[i], RayDistance, RaycastClosest, &hits[i]);
+	}
+	timer.Stop();
+	result._Closest = rayCount / timer.Elapsed() * 1.0e-6;
+
+	BaseArray<void*> candidates;
+	RaycastHit hit;
+	timer.Start();
+	for (i = 0; i < rayCount; i++)
+	{
+		RaycastCandidates(broadPhase, rays[i], candidates, hit);
+	}
+	timer.Stop();
+	result._Candidates = rayCount / timer.Elapsed() * 1.0e-6;
+
+	result._HitCount = 0;
+	for (i = 0; i < rayCount; i++)
+	{
+		result._HitCount += (hits[i]._IsHit ? 1 : 0);
+	}
+
+	int32 referenceCount = Math::Min(rayCount, ReferenceRayCount);
+	result._MismatchCount = 0;
+	timer.Start();
+	for (i = 0; i < referenceCount; i++)
+	{
+		bool isHit = RaycastBruteForce(objects, rays[i], hit);
+		if (isHit != hits[i]._IsHit || (isHit && Math::Abs(hit._Distance - hits[i]._Hit._Distance) > 1.0e-4f))
+			result._MismatchCount++;
+	}
+	timer.Stop();
+	result._BruteForce = referenceCount / timer.Elapsed() * 1.0e-6;
+
+	delete broadPhase;
+}
+
+int main(int argc, char** argv)
+{
+	const int32 Counts[] = { 1000, 10000 };
+	const int32 CountCount = sizeof(Counts) / sizeof(Counts[0]);
+	int32 rayCount = 200000;
+
+	Console::WriteLine(_T("SceneQueryBenchmark"));
+	Console::WriteLine(_T("==================="));
+
+	if (argc == 2)
+	{
+		rayCount = Math::Max(String(argv[1]).ToInt32(), 100);
+	}
+	else if (argc != 1)
+	{
+		Console::WriteLine(_T("SceneQueryBenchmark [rayCount]"));
+		return -1;
+	}
+
+	bool result = TestPrimitives();
+
+	for (int32 c = 0; c < CountCount; c++)
+	{
+		BenchmarkResult benchmark;
+		Benchmark(Counts[c], rayCount, benchmark);
+
+		Console::WriteLine(String::ToString(Counts[c]) + _T(" bodies, ") + String::ToString(rayCount) + _T(" rays, ") +
+			String::ToString(benchmark._HitCount) + _T(" hits"));
+		Console::WriteLine(_T("  Closest hit:    ") + String::ToString(benchmark._Closest) + _T(" Mrays/s"));
+		Console::WriteLine(_T("  All candidates: ") + String::ToString(benchmark._Candidates) + _T(" Mrays/s"));
+		Console::WriteLine(_T("  Every shape:    ") + String::ToString(benchmark._BruteForce) + _T(" Mrays/s"));
+		if (benchmark._MismatchCount != 0)
+		{
+			Console::WriteLine(_T("  FAILED: ") + String::ToString(benchmark._MismatchCount) + _T(" hits differ from every shape"));
+			result = false;
+		}
+	}
+
+	Console::WriteLine(result ? _T("All tests passed.") : _T("Some tests failed."));
+	return (result ? 0 : 1);
+}
@@ -0,0 +1,401 @@
+/*=============================================================================
+SerializerBenchmark.cpp
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+#include <Core/Core.h>
+
+using namespace SonataEngine;
+
+/*
+	Tests and benchmark of the binary serializer.
+
+	SerializerBenchmark [objectCount]
+
+	The tests write 1000 objects of a type and read them back with a type
+	of the same name whose fields changed: fields removed, a field changed
+	from int32 to real64 and a field added. They then read the objects of a
+	type that no longer exists as NULL, and reject a stream whose magic
+	number is wrong.
+
+	The benchmark writes a scene of reflected objects (1M by default) to a
+	memory stream and reads it back, in the byte order of the platform and
+	in the other byte order. Each object has a String, an int32, a real32,
+	two Vector3, an enumeration, a bool, an int64, an int16, a real64 and an
+	object field; every 16th object has a child object. The scene writes its
+	objects from OnSerialized. The objects read must be equal to the objects
+	written. The times are in milliseconds.
+*/
+
+enum Visibility
+{
+	Visibility_Visible,
+	Visibility_Hidden,
+	Visibility_Inherited
+};
+
+SE_BEGIN_ENUM(Visibility);
+	SE_Enum(Visible);
+	SE_Enum(Hidden);
+	SE_Enum(Inherited);
+SE_END_ENUM(Visibility);
+
+class Entity : public Object
+{
+	SE_DECLARE_CLASS(Entity, Object);
+
+	SE_BEGIN_REFLECTION(Entity);
+		SE_Field(name, String, Public);
+		SE_Field(health, int32, Public);
+		SE_Field(size, real32, Public);
+		SE_Field(position, Vector3, Public);
+		SE_Field(velocity, Vector3, Public);
+		SE_Field(visibility, Visibility, Public);
+		SE_Field(enabled, bool, Public);
+		SE_Field(id, int64, Public);
+		SE_Field(layer, int16, Public);
+		SE_Field(mass, real64, Public);
+		SE_Field(child, Entity, Public);
+	SE_END_REFLECTION(Entity);
+
+public:
+	Entity() : Object(), health(100), size(1.0f), position(Vector3::Zero), velocity(Vector3::Zero),
+		visibility(Visibility_Visible), enabled(true), id(0), layer(0), mass(0.0), child(NULL) {}
+	virtual ~Entity() { SE_DELETE(child); }
+
+public:
+	String name;
+	int32 health;
+	real32 size;
+	Vector3 position;
+	Vector3 velocity;
+	Visibility visibility;
+	bool enabled;
+	int64 id;
+	int16 layer;
+	real64 mass;
+	Entity* child;
+};
+
+SE_IMPLEMENT_CLASS(Entity);
+SE_IMPLEMENT_REFLECTION(Entity);
+
+/// The type written by the schema tests, renamed EntityV2 in the stream.
+class EntityV1 : public Object
+{
+	SE_DECLARE_CLASS(EntityV1, Object);
+
+	SE_BEGIN_REFLECTION(EntityV1);
+		SE_Field(name, String, Public);
+		SE_Field(health, int32, Public);
+		SE_Field(layer, int16, Public);
+		SE_Field(velocity, Vector3, Public);
+		SE_Field(mass, real64, Public);
+		SE_Field(child, EntityV1, Public);
+	SE_END_REFLECTION(EntityV1);
+
+public:
+	EntityV1() : Object(), health(0), layer(0), velocity(Vector3::Zero), mass(0.0), child(NULL) {}
+	virtual ~EntityV1() { SE_DELETE(child); }
+
+public:
+	String name;
+	int32 health;
+	int16 layer;
+	Vector3 velocity;
+	real64 mass;
+	EntityV1* child;
+};
+
+SE_IMPLEMENT_CLASS(EntityV1);
+SE_IMPLEMENT_REFLECTION(EntityV1);
+
+/// The type read by the schema tests: layer, velocity and mass removed, health changed to real64, extra added.
+class EntityV2 : public Object
+{
+	SE_DECLARE_CLASS(EntityV2, Object);
+
+	SE_BEGIN_REFLECTION(EntityV2);
+		SE_Field(extra, int32, Public);
+		SE_Field(name, String, Public);
+		SE_Field(health, real64, Public);
+		SE_Field(child, EntityV2, Public);
+	SE_END_REFLECTION(EntityV2);
+
+public:
+	EntityV2() : Object(), extra(42), health(0.0), child(NULL) {}
+	virtual ~EntityV2() { SE_DELETE(child); }
+
+public:
+	int32 extra;
+	String name;
+	real64 health;
+	EntityV2* child;
+};
+
+SE_IMPLEMENT_CLASS(EntityV2);
+SE_IMPLEMENT_REFLECTION(EntityV2);
+
+/// Root object writing its objects from OnSerialized.
+class Scene : public Object
+{
+	SE_DECLARE_CLASS(Scene, Object);
+
+public:
+	Scene() : Object() {}
+	virtual ~Scene()
+	{
+		for (int32 i = 0; i < objects.Count(); i++)
+			delete objects[i];
+	}
+
+	virtual void OnSerialized(BinarySerializer* context, BinaryStream& stream)
+	{
+		int32 count = objects.Count();
+		stream.WriteInt32(count);
+		for (int32 i = 0; i < count; i++)
+			context->Serialize(stream, objects[i], objects[i]->GetType());
+	}
+
+	virtual void OnDeserialized(BinarySerializer* context, BinaryStream& stream)
+	{
+		int32 count = stream.ReadInt32();
+		objects.SetCapacity(count);
+		for (int32 i = 0; i < count; i++)
+			objects.Add(context->Deserialize(stream));
+	}
+
+public:
+	BaseArray<Object*> objects;
+};
+
+SE_IMPLEMENT_CLASS(Scene);
+
+/// Number of objects of the schema tests.
+static const int32 SchemaObjectCount = 1000;
+
+static bool Check(bool value, const String& message)
+{
+	if (!value)
+		Console::WriteLine(_T("  FAILED: ") + message);
+	return value;
+}
+
+static String GetName(int32 index)
+{
+	return _T("entity_") + String::ToString(index);
+}
+
+static Scene* CreateScene(int32 objectCount)
+{
+	Scene* scene = new Scene();
+	scene->objects.SetCapacity(objectCount);
+	for (int32 i = 0; i < objectCount; i++)
+	{
+		Entity* entity = new Entity();
+		entity->name = GetName(i);
+		entity->health = i;
+		entity->size = i * 0.5f;
+		entity->position = Vector3((real32)i, i * 2.0f, -i * 1.0f);
+		entity->velocity = Vector3(1.0f, 2.0f, 3.0f);
+		entity->visibility = (Visibility)(i % 3);
+		entity->enabled = ((i & 1) != 0);
+		entity->id = (int64)i << 20;
+		entity->layer = (int16)(i & 31);
+		entity->mass = i * 0.125;
+		if ((i & 15) == 0)
+		{
+			entity->child = new Entity();
+			entity->child->name = _T("child");
+			entity->child->health = -i;
+		}
+		scene->objects.Add(entity);
+	}
+	return scene;
+}
+
+static bool IsEqual(const Entity* left, const Entity* right)
+{
+	if (left == NULL || right == NULL)
+		return (left == right);
+
+	return (left->name == right->name && left->health == right->health && left->size == right->size &&
+		left->position == right->position && left->velocity == right->velocity &&
+		left->visibility == right->visibility && left->enabled == right->enabled && left->id == right->id &&
+		left->layer == right->layer && left->mass == right->mass && IsEqual(left->child, right->child));
+}
+
+static bool IsEqual(const Scene* left, const Scene* right)
+{
+	if (right == NULL || left->objects.Count() != right->objects.Count())
+		return false;
+
+	for (int32 i = 0; i < left->objects.Count(); i++)
+	{
+		if (!IsEqual((const Entity*)left->objects[i], (const Entity*)right->objects[i]))
+			return false;
+	}
+	return true;
+}
+
+/// Renames a type in a stream, the names having the same length. Returns the number of names found.
+static int32 RenameType(MemoryStream& stream, const String& name, const String& newName)
+{
+	SEbyte* data = stream.GetBuffer();
+	int32 length = (int32)stream.GetLength();
+	int32 size = name.Length() * sizeof(SEchar);
+	int32 count = 0;
+	for (int32 i = 0; i + size <= length; i++)
+	{
+		if (Memory::Compare(data + i, (void*)name.Data(), size) == 0)
+		{
+			Memory::Copy(data + i, (void*)newName.Data(), size);
+			count++;
+		}
+	}
+	return count;
+}
+
+static bool TestSchemas()
+{
+	bool result = true;
+
+	Scene scene;
+	int32 i;
+	for (i = 0; i < SchemaObjectCount; i++)
+	{
+		EntityV1* entity = new EntityV1();
+		entity->name = GetName(i);
+		entity->health = i;
+		entity->layer = (int16)i;
+		entity->velocity = Vector3(1.0f, 2.0f, 3.0f);
+		entity->mass = i * 0.5;
+		if ((i & 15) == 0)
+		{
+			entity->child = new EntityV1();
+			entity->child->health = -i;
+		}
+		scene.objects.Add(entity);
+	}
+
+	MemoryStream stream;
+	BinarySerializer serializer;
+	serializer.Serialize(&stream, &scene);
+	result &= Check(RenameType(stream, _T("EntityV1"), _T("EntityV2")) == 1, _T("the type name is not written once"));
+
+	{
+		// The fields are matched by name
+		stream.SetPosition(0);
+		BinarySerializer reader;
+		Scene* other = (Scene*)reader.Deserialize(&stream);
+		result &= Check(other != NULL && other->objects.Count() == SchemaObjectCount, _T("the changed type is not read"));
+		if (other != NULL)
+		{
+			bool isValid = true;
+			for (i = 0; i < other->objects.Count() && isValid; i++)
+			{
+				const EntityV1* expected = (const EntityV1*)scene.objects[i];
+				const EntityV2* entity = (const EntityV2*)other->objects[i];
+				isValid &= (entity != NULL && entity->GetType() == EntityV2::GetTypeStatic());
+				isValid &= (isValid && entity->name == expected->name && entity->health == (real64)expected->health && entity->extra == 42);
+				isValid &= (isValid && (entity->child != NULL) == (expected->child != NULL));
+				if (isValid && entity->child != NULL)
+					isValid &= (entity->child->health == (real64)expected->child->health && entity->child->extra == 42);
+			}
+			result &= Check(isValid, _T("wrong values read with the changed type"));
+			delete other;
+		}
+	}
+
+	{
+		// The objects of an unknown type are skipped
+		RenameType(stream, _T("EntityV2"), _T("EntityV3"));
+		stream.SetPosition(0);
+		BinarySerializer reader;
+		Scene* other = (Scene*)reader.Deserialize(&stream);
+		result &= Check(other != NULL && other->objects.Count() == SchemaObjectCount, _T("the stream with an unknown type is not read"));
+		if (other != NULL)
+		{
+			int32 nullCount = 0;
+			for (i = 0; i < other->objects.Count(); i++)
+			{
+				if (other->objects[i] == NULL)
+					nullCount++;
+			}
+			result &= Check(nullCount == SchemaObjectCount, _T("the objects of an unknown type are not read as NULL"));
+			result &= Check(stream.GetPosition() == stream.GetLength(), _T("the objects of an unknown type are not skipped"));
+			delete other;
+		}
+	}
+
+	{
+		stream.GetBuffer()[0] ^= 0xFF;
+		stream.SetPosition(0);
+		BinarySerializer reader;
+		result &= Check(reader.Deserialize(&stream) == NULL, _T("a wrong magic number is accepted"));
+	}
+
+	return result;
+}
+
+static bool Benchmark(Scene* scene, ByteOrder byteOrder, const String& title)
+{
+	Timer timer;
+	MemoryStream stream;
+	stream.SetByteOrder(byteOrder);
+	BinarySerializer serializer;
+
+	timer.Start();
+	serializer.Serialize(&stream, scene);
+	timer.Stop();
+	real64 writeTime = timer.Elapsed() * 1000.0;
+
+	stream.SetPosition(0);
+	timer.Start();
+	Scene* other = (Scene*)serializer.Deserialize(&stream);
+	timer.Stop();
+	real64 readTime = timer.Elapsed() * 1000.0;
+
+	Console::WriteLine(title + _T(": write ") + String::ToString(writeTime) + _T(" ms, read ") + String::ToString(readTime) +
+		_T(" ms, ") + String::ToString(stream.GetLength() / 1048576.0) + _T(" MB"));
+
+	bool result = Check(IsEqual(scene, other), title + _T(": the objects read differ"));
+	delete other;
+	return result;
+}
+
+int main(int argc, char** argv)
+{
+	int32 objectCount = 1000000;
+
+	Console::WriteLine(_T("SerializerBenchmark"));
+	Console::WriteLine(_T("==================="));
+
+	if (argc == 2)
+	{
+		objectCount = Math::Max(String(argv[1]).ToInt32(), 1);
+	}
+	else if (argc != 1)
+	{
+		Console::WriteLine(_T("SerializerBenchmark [objectCount]"));
+		return -1;
+	}
+
+	// Registers the primitive types and the structures
+	Engine::Instance();
+
+	bool result = true;
+	Console::WriteLine(_T("Tests"));
+	result &= TestSchemas();
+
+	Scene* scene = CreateScene(objectCount);
+	Console::WriteLine(String::ToString(objectCount) + _T(" objects"));
+	ByteOrder swappedOrder = (SE_ENDIAN == ByteOrder_LittleEndian ? ByteOrder_BigEndian : ByteOrder_LittleEndian);
+	result &= Benchmark(scene, SE_ENDIAN, _T("  native "));
+	result &= Benchmark(scene, swappedOrder, _T("  swapped"));
+	delete scene;
+
+	Console::WriteLine(result ? _T("All tests passed.") : _T("Some tests failed."));
+	return (result ? 0 : 1);
+}
@@ -0,0 +1,433 @@
+/*=============================================================================
+SkinningBenchmark.cpp
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+#include <Core/Core.h>
+#include <Graphics/Graphics.h>
+
+using namespace SonataEngine;
+
+/*
+	Tests and benchmark of the software skinning.
+
+	SkinningBenchmark [workerCount]
+
+	The meshes have 56 bytes vertices with a position, a normal, 4 blend
+	weights and 4 blend indices, the other bytes must not be modified. The
+	skeletons have 64 bones with a random rotation, translation and scale.
+
+	The tests compare the skins to a reference skinning, the interleaved
+	kernel of the previous implementation: with the linear blending, on a
+	small mesh and on a large mesh deformed by the JobScheduler threads, and
+	with the dual quaternions, which must be exact with a single influence
+	per vertex, blend like the matrices when all the bones have the same
+	rotation, and ignore the scale of the bones.
+
+	The benchmark deforms meshes of 10K, 100K and 1M vertices, each vertex
+	having up to 4 influences, with the reference skinning and with the
+	linear and the dual quaternion blending of Skin, the skeleton palette
+	being computed at each frame. The JobScheduler is not created by
+	default, workerCount creates it with this number of workers. The
+	results are in vertices per millisecond.
+*/
+
+static const int32 BoneCount = 64;
+
+/// Vertex layout of the meshes.
+static const int32 VertexSize = 56;
+static const int32 PositionOffset = 0;
+static const int32 NormalOffset = 12;
+static const int32 TextureCoordinateOffset = 24;
+static const int32 BlendWeightsOffset = 32;
+static const int32 BlendIndicesOffset = 48;
+
+static const int32 TestVertexCount = 10003;
+
+/// Above Skin::ParallelVertexCount and not a multiple of the chunks.
+static const int32 ParallelTestVertexCount = 70001;
+static const int32 ParallelWorkerCount = 3;
+
+/// Number of vertices deformed for each mesh of the benchmark.
+static const int32 BenchmarkVertexCount = 20000000;
+
+static const real32 MaxError = 1.0e-4f;
+
+/** Vertex buffer in the system memory. */
+class MemoryBuffer : public HardwareBuffer
+{
+public:
+	MemoryBuffer(uint32 size) :
+		HardwareBuffer(size, HardwareBufferUsage_Dynamic),
+		_mapCount(0)
+	{
+		_data = new SEbyte[size];
+	}
+
+	virtual ~MemoryBuffer()
+	{
+		delete[] _data;
+	}
+
+	SEbyte* GetData() const { return _data; }
+
+	virtual bool IsMapped() { return (_mapCount > 0); }
+
+	virtual bool Map(HardwareBufferMode mode, void** data)
+	{
+		_mapCount++;
+		*data = _data;
+		return true;
+	}
+
+	virtual void Unmap()
+	{
+		_mapCount--;
+	}
+
+protected:
+	SEbyte* _data;
+	int32 _mapCount;
+};
+
+static bool Check(bool value, const String& message)
+{
+	if (!value)
+		Console::WriteLine(_T("  FAILED: ") + message);
+	return value;
+}
+
+static MemoryBuffer* GetBuffer(VertexData* vertexData)
+{
+	return (MemoryBuffer*)vertexData->VertexStreams[0].VertexBuffer.Get();
+}
+
+/// Creates a mesh whose vertices have from 1 to maxInfluences influences.
+static VertexData* CreateMesh(int32 seed, int32 vertexCount, int32 maxInfluences)
+{
+	RandomLCG random(seed);
+	VertexLayout* vertexLayout = new VertexLayout();
+	vertexLayout->AddElement(VertexElement(0, PositionOffset, VertexFormat_Float3, VertexSemantic_Position));
+	vertexLayout->AddElement(VertexElement(0, NormalOffset, VertexFormat_Float3, VertexSemantic_Normal));
+	vertexLayout->AddElement(VertexElement(0, TextureCoordinateOffset, VertexFormat_Float2, VertexSemantic_TextureCoordinate));
+	vertexLayout->AddElement(VertexElement(0, BlendWeightsOffset, VertexFormat_Float4, VertexSemantic_BlendWeight));
+	vertexLayout->AddElement(VertexElement(0, BlendIndicesOffset, VertexFormat_UByte4, VertexSemantic_BlendIndices));
+
+	MemoryBuffer* buffer = new MemoryBuffer(vertexCount * VertexSize);
+	VertexData* vertexData = new VertexData();
+	vertexData->VertexLayout = vertexLayout;
+	vertexData->VertexStreams.Add(VertexStream(buffer, VertexSize));
+	vertexData->VertexCount = vertexCount;
+
+	SEbyte* vertex = buffer->GetData();
+	for (int32 i = 0; i < vertexCount; i++, vertex += VertexSize)
+	{
+		Memory::Zero(vertex, VertexSize);
+		real32* position = (real32*)(vertex + PositionOffset);
+		position[0] = random.RandomReal(-1.0f, 1.0f);
+		position[1] = random.RandomReal(0.0f, 2.0f);
+		position[2] = random.RandomReal(-0.5f, 0.5f);
+		real32* normal = (real32*)(vertex + NormalOffset);
+		normal[0] = random.RandomReal(-0.5f, 0.5f);
+		normal[1] = random.RandomReal(-0.5f, 0.5f);
+		normal[2] = random.RandomReal(-0.5f, 0.5f);
+		real32* textureCoordinate = (real32*)(vertex + TextureCoordinateOffset);
+		textureCoordinate[0] = random.RandomReal();
+		textureCoordinate[1] = random.RandomReal();
+
+		real32* weights = (real32*)(vertex + BlendWeightsOffset);
+		uint8* indices = (uint8*)(vertex + BlendIndicesOffset);
+		int32 influenceCount = 1 + Math::Min((int32)random.RandomReal(0.0f, (real)maxInfluences), maxInfluences - 1);
+		real32 sum = 0.0f;
+		int32 j;
+		for (j = 0; j < influenceCount; j++)
+		{
+			weights[j] = random.RandomReal(0.1f, 1.1f);
+			indices[j] = (uint8)Math::Min((int32)random.RandomReal(0.0f, (real)BoneCount), BoneCount - 1);
+			sum += weights[j];
+		}
+		for (j = 0; j < influenceCount; j++)
+			weights[j] /= sum;
+
+		// The padding must not be modified either
+		*(uint32*)(vertex + 52) = 0xDEADBEEF;
+	}
+
+	return vertexData;
+}
+
+/// Creates the bones of a skeleton, the same ones for a given seed.
+static void CreateBones(Skeleton* skeleton, int32 seed, bool isScaled)
+{
+	RandomLCG random(seed);
+	for (int32 i = 0; i < BoneCount; i++)
+	{
+		Vector3 axis(random.RandomReal(-0.5f, 0.5f), random.RandomReal(-0.5f, 0.5f), random.RandomReal(-0.5f, 0.5f));
+		real angle = random.RandomReal(0.0f, 1.2f);
+		Vector3 position(random.RandomReal(), random.RandomReal(), random.RandomReal());
+		real scale = random.RandomReal(0.8f, 1.2f);
+
+		Bone* bone = skeleton->AddBone();
+		bone->SetLocalOrientation(Quaternion::CreateFromAxisAngle(Vector3::Normalize(axis), angle));
+		bone->SetLocalPosition(position);
+		if (isScaled)
+			bone->SetLocalScale(Vector3(scale, scale, scale));
+	}
+}
+
+static void GetPalette(Skeleton* skeleton, BaseArray<Matrix4>& palette)
+{
+	palette.Clear();
+	for (int32 i = 0; i < skeleton->GetBoneCount(); i++)
+		palette.Add(skeleton->GetBoneByIndex(i)->GetSkinTransform());
+}
+
+/// Creates a skin whose palette indices are the bone indices.
+static Skin* CreateSkin(VertexData* vertexData, SkinBlendMode blendMode)
+{
+	Skin* skin = new Skin();
+	for (int32 i = 0; i < BoneCount; i++)
+	{
+		SkinVertex skinVertex;
+		skinVertex.BoneIndex = (uint16)i;
+		skin->SkinVertices.Add(skinVertex);
+	}
+	skin->BlendMode = blendMode;
+	skin->Initialize(vertexData);
+	return skin;
+}
+
+/// Reference skinning: the interleaved kernel of the previous implementation, copying a matrix per influence.
+static void ReferenceSkin(const SEbyte* source, SEbyte* dest, int32 vertexCount, const BaseArray<Matrix4>& palette)
+{
+	for (int32 i = 0; i < vertexCount; i++, source += VertexSize, dest += VertexSize)
+	{
+		const real32* position = (const real32*)(source + PositionOffset);
+		const real32* normal = (const real32*)(source + NormalOffset);
+		const real32* weights = (const real32*)(source + BlendWeightsOffset);
+		const uint8* indices = (const uint8*)(source + BlendIndicesOffset);
+
+		real tp[3] = { 0.0f, 0.0f, 0.0f };
+		real tn[3] = { 0.0f, 0.0f, 0.0f };
+		for (int32 b = 0; b < 4; b++)
+		{
+			if (weights[b] > Math::Epsilon)
+			{
+				Matrix4 m = palette[indices[b]];
+				tp[0] += weights[b] * (m.M00 * position[0] + m.M01 * position[1] + m.M02 * position[2] + m.M03);
+				tp[1] += weights[b] * (m.M10 * position[0] + m.M11 * position[1] + m.M12 * position[2] + m.M13);
+				tp[2] += weights[b] * (m.M20 * position[0] + m.M21 * position[1] + m.M22 * position[2] + m.M23);
+				tn[0] += weights[b] * (m.M00 * normal[0] + m.M01 * normal[1] + m.M02 * normal[2]);
+				tn[1] += weights[b] * (m.M10 * normal[0] + m.M11 * normal[1] + m.M12 * normal[2]);
+				tn[2] += weights[b] * (m.M20 * normal[0] + m.M21 * normal[1] + m.M22 * normal[2]);
+			}
+		}
+
+		for (int32 c = 0; c < 3; c++)
+		{
+			((real32*)(dest + PositionOffset))[c] = (real32)tp[c];
+			((real32*)(dest + NormalOffset))[c] = (real32)tn[c];
+		}
+	}
+}
+
+/// Gets the largest difference of the positions and the normals, counts the vertices whose other bytes differ.
+static real32 Compare(SEbyte* left, SEbyte* right, int32 vertexCount, int32& changedCount)
+{
+	real32 error = 0.0f;
+	changedCount = 0;
+	for (int32 i = 0; i < vertexCount; i++, left += VertexSize, right += VertexSize)
+	{
+		for (int32 c = 0; c < 3; c++)
+		{
+			error = Math::Max(error, Math::Abs(((real32*)(left + PositionOffset))[c] - ((real32*)(right + PositionOffset))[c]));
+			error = Math::Max(error, Math::Abs(((real32*)(left + NormalOffset))[c] - ((real32*)(right + NormalOffset))[c]));
+		}
+		if (Memory::Compare(left + TextureCoordinateOffset, right + TextureCoordinateOffset, VertexSize - TextureCoordinateOffset) != 0)
+			changedCount++;
+	}
+	return error;
+}
+
+/**
+	Deforms a mesh with a skin of a skeleton, and compares the vertices to
+	the reference skinning with a palette.
+*/
+static bool TestSkin(const String& name, Skeleton* skeleton, const BaseArray<Matrix4>& palette,
+	int32 vertexCount, int32 maxInfluences, SkinBlendMode blendMode)
+{
+	VertexData* vertexData = CreateMesh(vertexCount, vertexCount, maxInfluences);
+	MemoryBuffer* buffer = GetBuffer(vertexData);
+	BaseArray<SEbyte> expected;
+	expected.Resize(vertexCount * VertexSize);
+	Memory::Copy(expected.Data(), buffer->GetData(), vertexCount * VertexSize);
+	ReferenceSkin(buffer->GetData(), expected.Data(), vertexCount, palette);
+
+	SmartPtr<Skin> skin = CreateSkin(vertexData, blendMode);
+	skeleton->InvalidateSkinPalette();
+	skin->Update(skeleton);
+	skin->Deform();
+
+	int32 changedCount;
+	real32 error = Compare(expected.Data(), buffer->GetData(), vertexCount, changedCount);
+	Console::WriteLine(_T("  ") + name + _T(": max error ") + String::ToString(error));
+
+	bool result = true;
+	result &= Check(error < MaxError, name + _T(": the vertices differ from the reference skinning"));
+	result &= Check(changedCount == 0, name + _T(": ") + String::ToString(changedCount) + _T(" vertices have other bytes modified"));
+	result &= Check(!buffer->IsMapped(), name + _T(": the vertex buffer is still mapped"));
+
+	skin = NULL;
+	delete vertexData;
+	return result;
+}
+
+static bool TestSkins()
+{
+	bool result = true;
+
+	Skeleton skeleton;
+	CreateBones(&skeleton, 1, true);
+	BaseArray<Matrix4> palette;
+	GetPalette(&skeleton, palette);
+	result &= TestSkin(_T("linear"), &skeleton, palette, TestVertexCount, 4, SkinBlendMode_Linear);
+
+	JobScheduler* scheduler = JobScheduler::Instance();
+	scheduler->Create(ParallelWorkerCount);
+	result &= TestSkin(_T("linear, parallel"), &skeleton, palette, ParallelTestVertexCount, 4, SkinBlendMode_Linear);
+	scheduler->Destroy();
+
+	// A single influence is exact with the rigid bones
+	Skeleton rigidSkeleton;
+	CreateBones(&rigidSkeleton, 2, false);
+	BaseArray<Matrix4> rigidPalette;
+	GetPalette(&rigidSkeleton, rigidPalette);
+	result &= TestSkin(_T("dual quaternion, single influence"), &rigidSkeleton, rigidPalette, TestVertexCount, 1, SkinBlendMode_DualQuaternion);
+
+	scheduler->Create(ParallelWorkerCount);
+	result &= TestSkin(_T("dual quaternion, parallel"), &rigidSkeleton, rigidPalette, ParallelTestVertexCount, 1, SkinBlendMode_DualQuaternion);
+	scheduler->Destroy();
+
+	// The dual quaternions blend like the matrices when only the translations differ
+	Skeleton translatedSkeleton;
+	RandomLCG random(3);
+	Quaternion orientation = Quaternion::CreateFromAxisAngle(Vector3::Normalize(Vector3(0.3f, 1.0f, 0.2f)), 0.7f);
+	for (int32 i = 0; i < BoneCount; i++)
+	{
+		Bone* bone = translatedSkeleton.AddBone();
+		bone->SetLocalOrientation(orientation);
+		bone->SetLocalPosition(Vector3(random.RandomReal(0.0f, 3.0f), random.RandomReal(), random.RandomReal()));
+	}
+	BaseArray<Matrix4> translatedPalette;
+	GetPalette(&translatedSkeleton, translatedPalette);
+	result &= TestSkin(_T("dual quaternion, same rotation"), &translatedSkeleton, translatedPalette, TestVertexCount, 4, SkinBlendMode_DualQuaternion);
+
+	// The dual quaternions ignore the scale
+	Skeleton scaledSkeleton;
+	CreateBones(&scaledSkeleton, 2, false);
+	for (int32 i = 0; i < BoneCount; i++)
+		scaledSkeleton.GetBoneByIndex(i)->SetLocalScale(Vector3(1.5f, 1.5f, 1.5f));
+	result &= TestSkin(_T("dual quaternion, scaled bones"), &scaledSkeleton, rigidPalette, TestVertexCount, 1, SkinBlendMode_DualQuaternion);
+
+	return result;
+}
+
+/// Deforms a mesh for a number of frames, the palette is computed again at each frame.
+static real64 Deform(Skin* skin, Skeleton* skeleton, int32 frameCount)
+{
+	Timer timer;
+	timer.Start();
+	for (int32 frame = 0; frame < frameCount; frame++)
+	{
+		skeleton->InvalidateSkinPalette();
+		skin->Update(skeleton);
+		skin->Deform();
+	}
+	timer.Stop();
+	return timer.Elapsed();
+}
+
+static bool Benchmark(int32 vertexCount)
+{
+	int32 frameCount = Math::Max(BenchmarkVertexCount / vertexCount, 1);
+	Skeleton skeleton;
+	CreateBones(&skeleton, 4, true);
+	BaseArray<Matrix4> palette;
+	GetPalette(&skeleton, palette);
+
+	VertexData* vertexData = CreateMesh(vertexCount, vertexCount, 4);
+	MemoryBuffer* buffer = GetBuffer(vertexData);
+	BaseArray<SEbyte> source;
+	source.Resize(vertexCount * VertexSize);
+	Memory::Copy(source.Data(), buffer->GetData(), vertexCount * VertexSize);
+	BaseArray<SEbyte> dest;
+	dest.Resize(vertexCount * VertexSize);
+	Memory::Copy(dest.Data(), source.Data(), vertexCount * VertexSize);
+
+	Timer timer;
+	timer.Start();
+	for (int32 frame = 0; frame < frameCount; frame++)
+		ReferenceSkin(source.Data(), dest.Data(), vertexCount, palette);
+	timer.Stop();
+	real64 referenceTime = timer.Elapsed();
+
+	SmartPtr<Skin> skin = CreateSkin(vertexData, SkinBlendMode_Linear);
+	real64 linearTime = Deform(skin, &skeleton, frameCount);
+
+	int32 changedCount;
+	real32 error = Compare(dest.Data(), buffer->GetData(), vertexCount, changedCount);
+
+	skin->BlendMode = SkinBlendMode_DualQuaternion;
+	real64 dualQuaternionTime = Deform(skin, &skeleton, frameCount);
+
+	real64 vertexTotal = (real64)vertexCount * frameCount;
+	Console::WriteLine(_T("  ") + String::ToString(vertexCount) + _T(" vertices: reference ") +
+		String::ToString((int32)(vertexTotal / (referenceTime * 1000.0))) + _T(", linear ") +
+		String::ToString((int32)(vertexTotal / (linearTime * 1000.0))) + _T(", dual quaternion ") +
+		String::ToString((int32)(vertexTotal / (dualQuaternionTime * 1000.0))) + _T(" vertices/ms"));
+
+	bool result = Check(error < MaxError && changedCount == 0, _T("the linear skinning differs from the reference skinning"));
+
+	skin = NULL;
+	delete vertexData;
+	return result;
+}
+
+int main(int argc, char** argv)
+{
+	int32 workerCount = 0;
+
+	Console::WriteLine(_T("SkinningBenchmark"));
+	Console::WriteLine(_T("================="));
+
+	if (argc == 2)
+	{
+		workerCount = Math::Max(String(argv[1]).ToInt32(), 0);
+	}
+	else if (argc != 1)
+	{
+		Console::WriteLine(_T("SkinningBenchmark [workerCount]"));
+		return -1;
+	}
+
+	bool result = true;
+	Console::WriteLine(_T("Tests"));
+	result &= TestSkins();
+
+	JobScheduler* scheduler = JobScheduler::Instance();
+	if (workerCount > 0)
+		scheduler->Create(workerCount);
+
+	Console::WriteLine(_T("Benchmark, ") + String::ToString(BoneCount) + _T(" bones, up to 4 influences, ") +
+		String::ToString(VertexSize) + _T(" bytes per vertex"));
+	result &= Benchmark(10000);
+	result &= Benchmark(100000);
+	result &= Benchmark(1000000);
+
+	if (workerCount > 0)
+		scheduler->Destroy();
+
+	Console::WriteLine(result ? _T("All tests passed.") : _T("Some tests failed."));
+	return (result ? 0 : 1);
+}
@@ -0,0 +1,310 @@
+/*=============================================================================
+SleepingBenchmark.cpp
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+#include <Core/Core.h>
+#include <PhysicsSystem_Software/ContactSolver.h>
+
+using namespace SonataEngine;
+using namespace SE_Software;
+
+/*
+	Benchmark of the sleeping islands of the software physics system.
+
+	SleepingBenchmark [columns height]
+
+	Stacks of spheres (2000 stacks of 10 by default) fall on a static ground
+	during 240 steps, solved with 8 iterations, once with the sleeping
+	disabled and once enabled. The steps mirror PhysicsScene::Update: the
+	gravity is integrated before the contacts are solved, the contacts
+	without awake body are skipped, and the sleeping bodies are neither
+	solved nor integrated. The times are in milliseconds per step.
+
+	With the sleeping enabled, the pile must be asleep before the step 180,
+	where the top sphere of one stack is knocked. Only the spheres of that
+	stack must then wake up, one layer below the knocked sphere per step.
+*/
+
+static const real Radius = 0.5f;
+static const real TimeStep = 1.0f / 60.0f;
+static const int32 Iterations = 8;
+
+/// Default values of SceneDescription.
+static const real SleepEnergy = 0.01f;
+static const real SleepTime = 0.5f;
+
+static const int32 StepCount = 240;
+static const int32 KnockStep = 180;
+static const int32 KnockedStack = 5;
+
+/// Number of steps of which the mean time is written.
+static const int32 ReportSteps = 20;
+
+struct Ball
+{
+	Vector3 _Position;
+	Vector3 _LinearVelocity;
+	Vector3 _AngularVelocity;
+	bool _IsAwake;
+	real _SleepTime;
+};
+
+static SolverContact CreateContact(uint64 pairKey, int32 bodyA, int32 bodyB,
+	const Vector3& position, const Vector3& normal, real depth)
+{
+	SolverContact contact;
+	contact._PairKey = pairKey;
+	contact._BodyA = bodyA;
+	contact._BodyB = bodyB;
+	contact._Position = position;
+	contact._Normal = normal;
+	contact._Depth = depth;
+	contact._Restitution = 0.2f;
+	contact._Friction = 0.5f;
+	return contact;
+}
+
+static void CreateStacks(BaseArray<Ball>& balls, int32 columns, int32 height)
+{
+	balls.Clear();
+	for (int32 c = 0; c < columns; c++)
+	{
+		for (int32 h = 0; h < height; h++)
+		{
+			// The spheres start slightly overlapping, with different speeds
+			Ball ball;
+			ball._Position = Vector3((c % 50) * 3.0f, Radius + h * 2.0f * Radius - 0.02f, (c / 50) * 3.0f);
+			ball._LinearVelocity = Vector3(0.0f, -0.1f * (c % 5), 0.0f);
+			ball._AngularVelocity = Vector3::Zero;
+			ball._IsAwake = true;
+			ball._SleepTime = 0.0f;
+			balls.Add(ball);
+		}
+	}
+}
+
+static void AddBodies(ContactSolver& solver, const BaseArray<Ball>& balls)
+{
+	SolverBody ground;
+	ground._Position = Vector3::Zero;
+	ground._LinearVelocity = Vector3::Zero;
+	ground._AngularVelocity = Vector3::Zero;
+	ground._InverseMass = 0.0f;
+	ground._InverseInertiaTensor = Matrix3::Zero;
+	ground._IsDynamic = false;
+	ground._IsAwake = true;
+	ground._SleepTime = 0.0f;
+	solver.AddBody(ground);
+
+	Matrix3 inverseInertia = Matrix3::Zero;
+	inverseInertia.M[0][0] = inverseInertia.M[1][1] = inverseInertia.M[2][2] = 1.0f / (0.4f * Radius * Radius);
+
+	// The index of a body in the solver is its index plus one, the ground is 0
+	for (int32 i = 0; i < balls.Count(); i++)
+	{
+		SolverBody body;
+		body._Position = balls[i]._Position;
+		body._LinearVelocity = balls[i]._LinearVelocity;
+		body._AngularVelocity = balls[i]._AngularVelocity;
+		body._InverseMass = 1.0f;
+		body._InverseInertiaTensor = inverseInertia;
+		body._IsDynamic = true;
+		body._IsAwake = balls[i]._IsAwake;
+		body._SleepTime = balls[i]._SleepTime;
+		solver.AddBody(body);
+	}
+}
+
+/// Adds the contacts of the pairs with an awake body, like the narrow phase of the scene.
+static void AddContacts(ContactSolver& solver, const BaseArray<Ball>& balls, int32 columns, int32 height)
+{
+	for (int32 c = 0; c < columns; c++)
+	{
+		for (int32 h = 0; h < height; h++)
+		{
+			int32 i = c * height + h;
+			const Ball& ball = balls[i];
+			if (ball._IsAwake && ball._Position.Y < Radius)
+			{
+				solver.AddContact(CreateContact((uint64)(i + 1) << 32, i + 1, 0,
+					Vector3(ball._Position.X, 0.0f, ball._Position.Z), Vector3::UnitY, Radius - ball._Position.Y));
+			}
+
+			if (h + 1 < height)
+			{
+				const Ball& above = balls[i + 1];
+				if (!ball._IsAwake && !above._IsAwake)
+					continue;
+
+				Vector3 delta = above._Position - ball._Position;
+				real distance = delta.Length();
+				if (distance < 2.0f * Radius)
+				{
+					solver.AddContact(CreateContact(((uint64)(i + 2) << 32) | (uint64)(i + 1), i + 2, i + 1,
+						ball._Position + delta * 0.5f, delta / distance, 2.0f * Radius - distance));
+				}
+			}
+		}
+	}
+}
+
+/// Executes a step and returns the number of awake bodies.
+static int32 Step(ContactSolver& solver, BaseArray<Ball>& balls, int32 columns, int32 height, bool isSleeping)
+{
+	int32 i;
+	for (i = 0; i < balls.Count(); i++)
+	{
+		if (balls[i]._IsAwake)
+			balls[i]._LinearVelocity.Y -= 9.81f * TimeStep;
+	}
+
+	solver.Clear();
+	AddBodies(solver, balls);
+	AddContacts(solver, balls, columns, height);
+	solver.Solve(TimeStep, Iterations);
+	if (isSleeping)
+		solver.UpdateSleepTimes(TimeStep, SleepEnergy);
+
+	int32 awakeCount = 0;
+	for (i = 0; i < balls.Count(); i++)
+	{
+		Ball& ball = balls[i];
+		const SolverBody& body = solver.GetBody(i + 1);
+		ball._SleepTime = body._SleepTime;
+
+		if (isSleeping && solver.GetIslandSleepTime(i + 1) >= SleepTime)
+		{
+			ball._IsAwake = false;
+			ball._SleepTime = 0.0f;
+			ball._LinearVelocity = Vector3::Zero;
+			ball._AngularVelocity = Vector3::Zero;
+			continue;
+		}
+
+		// A sleeping body in an island with a moving body is woken
+		if (!solver.IsBodySolved(i + 1))
+			continue;
+
+		if (!ball._IsAwake)
+		{
+			ball._IsAwake = true;
+			ball._SleepTime = 0.0f;
+		}
+		ball._LinearVelocity = body._LinearVelocity;
+		ball._AngularVelocity = body._AngularVelocity;
+	}
+
+	for (i = 0; i < balls.Count(); i++)
+	{
+		Ball& ball = balls[i];
+		if (ball._IsAwake)
+		{
+			ball._Position += ball._LinearVelocity * TimeStep;
+			awakeCount++;
+		}
+	}
+	return awakeCount;
+}
+
+/// Determines whether the awake bodies all belong to a stack.
+static bool IsStackAwake(const BaseArray<Ball>& balls, int32 height, int32 stack)
+{
+	for (int32 i = 0; i < balls.Count(); i++)
+	{
+		if (balls[i]._IsAwake && i / height != stack)
+			return false;
+	}
+	return true;
+}
+
+static bool Simulate(int32 columns, int32 height, bool isSleeping)
+{
+	ContactSolver solver;
+	BaseArray<Ball> balls;
+	CreateStacks(balls, columns, height);
+
+	Console::WriteLine(String(_T("Sleeping ")) + (isSleeping ? _T("enabled") : _T("disabled")));
+
+	bool result = true;
+	int32 asleepStep = -1;
+	int32 maxWokenCount = 0;
+	real64 time = 0.0;
+	Timer timer;
+	for (int32 step = 0; step < StepCount; step++)
+	{
+		if (step == KnockStep)
+		{
+			Ball& top = balls[KnockedStack * height + height - 1];
+			top._LinearVelocity = Vector3(0.5f, -3.0f, 0.0f);
+			top._IsAwake = true;
+			top._SleepTime = 0.0f;
+		}
+
+		timer.Start();
+		int32 awakeCount = Step(solver, balls, columns, height, isSleeping);
+		timer.Stop();
+		time += timer.Elapsed();
+
+		if (awakeCount == 0 && asleepStep < 0)
+			asleepStep = step;
+
+		if (isSleeping && step >= KnockStep)
+		{
+			maxWokenCount = Math::Max(maxWokenCount, awakeCount);
+			result &= IsStackAwake(balls, height, KnockedStack);
+			result &= (awakeCount <= step - KnockStep + 2);
+		}
+		else if (!isSleeping)
+		{
+			result &= (awakeCount == balls.Count());
+		}
+
+		if ((step + 1) % ReportSteps == 0)
+		{
+			Console::WriteLine(_T("  Steps ") + String::ToString(step + 1 - ReportSteps) + _T("-") + String::ToString(step) +
+				_T(": ") + String::ToString(time * 1000.0 / ReportSteps) + _T(" ms/step, ") +
+				String::ToString(awakeCount) + _T(" awake"));
+			time = 0.0;
+		}
+	}
+
+	if (isSleeping)
+	{
+		Console::WriteLine(_T("  Asleep at step ") + String::ToString(asleepStep) + _T(", ") +
+			String::ToString(maxWokenCount) + _T(" bodies woken by the knock"));
+		result &= (asleepStep >= 0 && asleepStep < KnockStep && maxWokenCount > 0);
+	}
+	if (!result)
+	{
+		Console::WriteLine(_T("  FAILED: wrong awake bodies"));
+	}
+	return result;
+}
+
+int main(int argc, char** argv)
+{
+	int32 columns = 2000;
+	int32 height = 10;
+
+	Console::WriteLine(_T("SleepingBenchmark"));
+	Console::WriteLine(_T("================="));
+
+	if (argc == 3)
+	{
+		columns = Math::Max(String(argv[1]).ToInt32(), KnockedStack + 1);
+		height = Math::Max(String(argv[2]).ToInt32(), 1);
+	}
+	else if (argc != 1)
+	{
+		Console::WriteLine(_T("SleepingBenchmark [columns height]"));
+		return -1;
+	}
+
+	bool result = Simulate(columns, height, false);
+	result &= Simulate(columns, height, true);
+
+	Console::WriteLine(result ? _T("All tests passed.") : _T("Some tests failed."));
+	return (result ? 0 : 1);
+}
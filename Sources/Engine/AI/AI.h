@@ -11,14 +11,21 @@ Author: Julien Delezenne
 
 // Pathfinding
 #include <AI/Pathfinding/AStarPathfinder.h>
+#include <AI/Pathfinding/GridPathfinderMap.h>
 #include <AI/Pathfinding/HeuristicCost.h>
+#include <AI/Pathfinding/HierarchicalPathfinder.h>
+#include <AI/Pathfinding/IndexedAStarPathfinderStorage.h>
+#include <AI/Pathfinding/JPSPathfinder.h>
 #include <AI/Pathfinding/Pathfinder.h>
+#include <AI/Pathfinding/PathRequestQueue.h>
 
 // State Machines
 #include <AI/StateMachines/Action.h>
 #include <AI/StateMachines/Agent.h>
+#include <AI/StateMachines/CompiledFSM.h>
 #include <AI/StateMachines/Condition.h>
 #include <AI/StateMachines/FSM.h>
+#include <AI/StateMachines/FSMAgentBatch.h>
 #include <AI/StateMachines/FSMObject.h>
 #include <AI/StateMachines/FunctionAction.h>
 #include <AI/StateMachines/FunctionCondition.h>
@@ -58,17 +58,23 @@ namespace SonataEngine
 
 		void AStarPathfinder::Run()
 		{
-			real32 g, h, f;
-			int neighbour;
-			PathfinderNodeID neighbourID;
-			AStarPathfinderNode* neighbourNode;
-			bool inClosed;
+			Start();
+
+			while (!Step(SE_MAX_I32))
+			{
+			}
+		}
+
+		void AStarPathfinder::Start()
+		{
+			real32 h;
 
 			// Initialize the source node
 			_currentNode = _Storage->CreateNode(_SourceNode);
 			if (_currentNode == NULL)
 			{
 				// Failed to create the source node
+				_Status = Status_Failed;
 				return;
 			}
 
@@ -83,8 +89,23 @@ namespace SonataEngine
 			// Add the source node to the Open list
 			_Storage->AddToOpenList(_currentNode, _Map);
 
-			// Infinite loop
-			while (true)
+			_Status = Status_Searching;
+		}
+
+		bool AStarPathfinder::Step(int32 iterationCount)
+		{
+			real32 g, h, f;
+			int neighbour;
+			PathfinderNodeID neighbourID;
+			AStarPathfinderNode* neighbourNode;
+			bool inClosed;
+
+			if (_Status != Status_Searching)
+			{
+				return true;
+			}
+
+			for (int32 iteration = 0; iteration < iterationCount; ++iteration)
 			{
 				// Remove the best node (lowest fitness) from the Open list
 				_currentNode = _Storage->RemoveBestOpenNode();
@@ -99,8 +120,8 @@ namespace SonataEngine
 				// The current node is the destination node or there are no more nodes to explore
 				if (_currentNode == NULL || _Goal->IsSearchFinished(_currentNode))
 				{
-					// Stop the loop
-					break;
+					_Status = (_currentNode != NULL ? Status_Succeeded : Status_Failed);
+					return true;
 				}
 
 				// Iterate over the neighbours of the current node
@@ -117,7 +138,6 @@ namespace SonataEngine
 						continue;
 					}
 
-					// TODO: use flags to prevent the searches
 					inClosed = false;
 
 					// Check if the node is in the Open list
@@ -128,6 +148,7 @@ namespace SonataEngine
 					{
 						// Check if the node is in the Closed list
 						neighbourNode = _Storage->FindInClosedList(neighbourID);
+						inClosed = (neighbourNode != NULL);
 					}
 
 					// The node is not in the Closed list
@@ -152,10 +173,6 @@ namespace SonataEngine
 							continue;
 						}
 					}
-					else
-					{
-						inClosed = true;
-					}
 
 					_Map->InitializeNeighbour(_currentNode, neighbourNode);
 
@@ -196,6 +213,8 @@ namespace SonataEngine
 					neighbourNode->_Parent = _currentNode;
 				}
 			}
+
+			return false;
 		}
 	}
 }
@@ -21,7 +21,7 @@ namespace SonataEngine
 		public:
 			AStarPathfinderNode();
 
-			virtual int CompareTo(const AStarPathfinderNode value) const
+			virtual int CompareTo(const AStarPathfinderNode& value) const
 			{
 				if (_Fitness < value._Fitness)
 					return -1;
@@ -50,20 +50,6 @@ namespace SonataEngine
 		class SE_AI_EXPORT AStarPathfinderMap : public PathfinderMap
 		{
 		public:
-			enum AStarPathfinderMapFlags
-			{
-				AStarPathfinderMapFlags_Unchecked = 0,
-				AStarPathfinderMapFlags_Open = (1<<0),
-				AStarPathfinderMapFlags_Closed = (1<<1),
-				AStarPathfinderMapFlags_OpenOrClosed =
-					AStarPathfinderMapFlags_Open | AStarPathfinderMapFlags_Closed,
-				AStarPathfinderMapFlags_NotPassable = (1<<2),
-			};
-
-		public:
-			virtual void SetAStarFlags(PathfinderNodeID node, uint32 flags) = 0;
-			virtual uint32 GetAStarFlags(PathfinderNodeID node) = 0;
-
 			virtual void InitializeNeighbour(AStarPathfinderNode* parent, AStarPathfinderNode* child) {}
 		};
 
@@ -75,9 +61,15 @@ namespace SonataEngine
 			virtual bool IsSearchFinished(AStarPathfinderNode* node) = 0;
 		};
 
+		/**
+			Storage of the nodes and of the Open and Closed lists.
+			@see IndexedAStarPathfinderStorage
+		*/
 		class SE_AI_EXPORT AStarPathfinderStorage
 		{
 		public:
+			virtual ~AStarPathfinderStorage() {}
+
 			virtual AStarPathfinderNode* CreateNode(PathfinderNodeID node) = 0;
 			virtual void DestroyNode(AStarPathfinderNode* node) = 0;
 
@@ -116,6 +108,19 @@ namespace SonataEngine
 
 			virtual void Run();
 
+			/**
+				Starts a search from the source node, the search is then advanced by Step.
+				Run is equivalent to Start followed by Step until the search is finished.
+			*/
+			void Start();
+
+			/**
+				Advances the search started by Start.
+				@param iterationCount The maximum number of nodes to expand.
+				@return true if the search is finished, the status tells whether a path was found.
+			*/
+			bool Step(int32 iterationCount);
+
 		protected:
 			AStarPathfinderStorage* _Storage;
 			AStarPathfinderGoal* _Goal;
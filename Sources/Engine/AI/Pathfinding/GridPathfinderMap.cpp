@@ -0,0 +1,94 @@
+/*=============================================================================
+GridPathfinderMap.cpp
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+#include "GridPathfinderMap.h"
+
+namespace SonataEngine
+{
+	namespace AI
+	{
+		static const int32 GridDirections[8][2] =
+		{
+			{ 1, 0 }, { 0, 1 }, { -1, 0 }, { 0, -1 },
+			{ 1, 1 }, { -1, 1 }, { -1, -1 }, { 1, -1 }
+		};
+
+		static const real32 GridDiagonalCost = 1.41421356f;
+
+		GridPathfinderMap::GridPathfinderMap() :
+			AStarPathfinderMap(),
+			_Width(0),
+			_Height(0),
+			_AllowDiagonals(true)
+		{
+		}
+
+		GridPathfinderMap::~GridPathfinderMap()
+		{
+		}
+
+		void GridPathfinderMap::SetSize(int32 width, int32 height)
+		{
+			_Width = width;
+			_Height = height;
+		}
+
+		bool GridPathfinderMap::CanMove(int32 x, int32 y, int32 dx, int32 dy)
+		{
+			if (!IsWalkableAt(x + dx, y + dy))
+				return false;
+
+			if (dx != 0 && dy != 0)
+			{
+				if (!_AllowDiagonals)
+					return false;
+
+				// Don't cut the corners
+				return (IsWalkable(x + dx, y) && IsWalkable(x, y + dy));
+			}
+
+			return true;
+		}
+
+		real32 GridPathfinderMap::GetDistance(int32 x0, int32 y0, int32 x1, int32 y1) const
+		{
+			int32 dx = Math::Abs(x1 - x0);
+			int32 dy = Math::Abs(y1 - y0);
+
+			if (!_AllowDiagonals)
+				return (real32)(dx + dy);
+
+			// Octile distance: diagonal moves along the shortest axis, then straight moves
+			int32 diagonal = Math::Min(dx, dy);
+			int32 straight = Math::Max(dx, dy) - diagonal;
+			return (real32)straight + (real32)diagonal * GridDiagonalCost;
+		}
+
+		void GridPathfinderMap::GetDirection(int32 index, int32& dx, int32& dy)
+		{
+			dx = GridDirections[index][0];
+			dy = GridDirections[index][1];
+		}
+
+		int GridPathfinderMap::GetNeighbourCount(PathfinderNode* node)
+		{
+			return GetDirectionCount();
+		}
+
+		PathfinderNodeID GridPathfinderMap::GetNeighbour(PathfinderNode* node, int index)
+		{
+			int32 x = GetNodeX(node->_NodeID);
+			int32 y = GetNodeY(node->_NodeID);
+			int32 dx = GridDirections[index][0];
+			int32 dy = GridDirections[index][1];
+
+			if (!CanMove(x, y, dx, dy))
+				return PathfinderNodeID_Invalid;
+
+			return GetNodeID(x + dx, y + dy);
+		}
+	}
+}
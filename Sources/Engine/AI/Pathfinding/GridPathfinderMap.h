@@ -0,0 +1,81 @@
+/*=============================================================================
+GridPathfinderMap.h
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+#ifndef _SE_AI_GRIDPATHFINDERMAP_H_
+#define _SE_AI_GRIDPATHFINDERMAP_H_
+
+#include "AI/Common.h"
+#include "AI/Pathfinding/AStarPathfinder.h"
+
+namespace SonataEngine
+{
+	namespace AI
+	{
+		/**
+			@brief Map of a grid of cells.
+
+			The identifier of the cell (x, y) is y * width + x. The cells are linked
+			to their four orthogonal neighbours, and to their four diagonal neighbours
+			when the diagonals are allowed. A diagonal move is only allowed when the
+			two orthogonal cells next to it are walkable, so the paths don't cut the
+			corners of the obstacles.
+
+			The straight moves cost 1 and the diagonal moves cost the square root of 2.
+			The map can be used by the AStarPathfinder, the JPSPathfinder and the
+			HierarchicalPathfinder.
+		*/
+		class SE_AI_EXPORT GridPathfinderMap : public AStarPathfinderMap
+		{
+		public:
+			GridPathfinderMap();
+			virtual ~GridPathfinderMap();
+
+			int32 GetWidth() const { return _Width; }
+			int32 GetHeight() const { return _Height; }
+
+			/** Sets the size of the grid. */
+			void SetSize(int32 width, int32 height);
+
+			bool GetAllowDiagonals() const { return _AllowDiagonals; }
+			void SetAllowDiagonals(bool value) { _AllowDiagonals = value; }
+
+			/** Determines whether a cell inside the grid can be crossed. */
+			virtual bool IsWalkable(int32 x, int32 y) = 0;
+
+			/** Determines whether a cell is inside the grid and can be crossed. */
+			bool IsWalkableAt(int32 x, int32 y)
+			{
+				return (x >= 0 && y >= 0 && x < _Width && y < _Height && IsWalkable(x, y));
+			}
+
+			/** Determines whether a unit at (x, y) can move by (dx, dy), with dx and dy in [-1, 1]. */
+			bool CanMove(int32 x, int32 y, int32 dx, int32 dy);
+
+			PathfinderNodeID GetNodeID(int32 x, int32 y) const { return (PathfinderNodeID)(y * _Width + x); }
+			int32 GetNodeX(PathfinderNodeID node) const { return (int32)node % _Width; }
+			int32 GetNodeY(PathfinderNodeID node) const { return (int32)node / _Width; }
+
+			/** Gets the cost of the shortest path between two cells without obstacles. */
+			real32 GetDistance(int32 x0, int32 y0, int32 x1, int32 y1) const;
+
+			/** Gets the number of directions, 8 with the diagonals or 4. */
+			int32 GetDirectionCount() const { return (_AllowDiagonals ? 8 : 4); }
+
+			/** Gets a direction, the orthogonal directions come first. */
+			static void GetDirection(int32 index, int32& dx, int32& dy);
+
+			virtual int GetNeighbourCount(PathfinderNode* node);
+			virtual PathfinderNodeID GetNeighbour(PathfinderNode* node, int index);
+
+		protected:
+			int32 _Width;
+			int32 _Height;
+			bool _AllowDiagonals;
+		};
+	}
+}
+
+#endif
@@ -0,0 +1,715 @@
+/*=============================================================================
+HierarchicalPathfinder.cpp
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+#include "HierarchicalPathfinder.h"
+
+namespace SonataEngine
+{
+	namespace AI
+	{
+		/// Entrances shorter than this length get a single transition in their middle.
+		static const int32 HierarchicalMaxSingleEntrance = 6;
+
+		int HierarchicalPathfinder::RegionMap::GetNeighbourCount(PathfinderNode* node)
+		{
+			return _Map->GetDirectionCount();
+		}
+
+		PathfinderNodeID HierarchicalPathfinder::RegionMap::GetNeighbour(PathfinderNode* node, int index)
+		{
+			int32 x = node->_NodeID % _Width;
+			int32 y = node->_NodeID / _Width;
+			int32 dx, dy;
+			GridPathfinderMap::GetDirection(index, dx, dy);
+
+			if (x + dx < 0 || y + dy < 0 || x + dx >= _Width || y + dy >= _Height)
+				return PathfinderNodeID_Invalid;
+
+			if (!_Map->CanMove(_X + x, _Y + y, dx, dy))
+				return PathfinderNodeID_Invalid;
+
+			return (y + dy) * _Width + (x + dx);
+		}
+
+		real32 HierarchicalPathfinder::RegionGoal::GetHeuristic(AStarPathfinderNode* node)
+		{
+			if (_Destination == PathfinderNodeID_Invalid)
+				return 0.0f;
+
+			int32 width = _Region->_Width;
+			return _Region->_Map->GetDistance(node->_NodeID % width, node->_NodeID / width,
+				_Destination % width, _Destination / width);
+		}
+
+		real32 HierarchicalPathfinder::RegionGoal::GetCost(AStarPathfinderNode* nodeA, AStarPathfinderNode* nodeB)
+		{
+			int32 width = _Region->_Width;
+			return _Region->_Map->GetDistance(nodeA->_NodeID % width, nodeA->_NodeID / width,
+				nodeB->_NodeID % width, nodeB->_NodeID / width);
+		}
+
+		bool HierarchicalPathfinder::RegionGoal::IsSearchFinished(AStarPathfinderNode* node)
+		{
+			if (_Destination != PathfinderNodeID_Invalid)
+				return (node->_NodeID == _Destination);
+
+			// Without heuristic, the nodes are closed by increasing cost
+			int32 target = _TargetIndices[node->_NodeID];
+			if (target >= 0 && _TargetCosts[target] < 0.0f)
+			{
+				_TargetCosts[target] = node->_Goal;
+				_RemainingTargets--;
+			}
+
+			return (_RemainingTargets == 0);
+		}
+
+		int HierarchicalPathfinder::AbstractMap::GetNeighbourCount(PathfinderNode* node)
+		{
+			return _Owner->_Nodes[node->_NodeID]._Edges.Count();
+		}
+
+		PathfinderNodeID HierarchicalPathfinder::AbstractMap::GetNeighbour(PathfinderNode* node, int index)
+		{
+			return _Owner->_Nodes[node->_NodeID]._Edges[index]._Target;
+		}
+
+		real32 HierarchicalPathfinder::AbstractGoal::GetHeuristic(AStarPathfinderNode* node)
+		{
+			GridPathfinderMap* map = _Owner->_Map;
+			PathfinderNodeID source = _Owner->_Nodes[node->_NodeID]._Cell;
+			PathfinderNodeID destination = _Owner->_Nodes[_Destination]._Cell;
+			return map->GetDistance(map->GetNodeX(source), map->GetNodeY(source),
+				map->GetNodeX(destination), map->GetNodeY(destination));
+		}
+
+		real32 HierarchicalPathfinder::AbstractGoal::GetCost(AStarPathfinderNode* nodeA, AStarPathfinderNode* nodeB)
+		{
+			const BaseArray<AbstractEdge>& edges = _Owner->_Nodes[nodeA->_NodeID]._Edges;
+			real32 cost = SE_MAX_R32;
+			int32 count = edges.Count();
+			for (int32 i = 0; i < count; ++i)
+			{
+				if (edges[i]._Target == nodeB->_NodeID)
+					cost = Math::Min(cost, edges[i]._Cost);
+			}
+			return cost;
+		}
+
+		bool HierarchicalPathfinder::AbstractGoal::IsSearchFinished(AStarPathfinderNode* node)
+		{
+			return (node->_NodeID == _Destination);
+		}
+
+
+		HierarchicalPathfinder::HierarchicalPathfinder() :
+			Pathfinder(),
+			_Goal(NULL),
+			_Map(NULL),
+			_ClusterSize(0),
+			_ClusterCountX(0),
+			_ClusterCountY(0),
+			_IsDirty(false),
+			_SourceNode(PathfinderNodeID_Invalid),
+			_DestinationNode(PathfinderNodeID_Invalid),
+			_CurrentNode(NULL)
+		{
+			_RegionGoal._Region = &_RegionMap;
+			_RegionPathfinder.Initialize(&_RegionStorage, &_RegionGoal, &_RegionMap);
+
+			_AbstractMap._Owner = this;
+			_AbstractGoal._Owner = this;
+			_AbstractPathfinder.Initialize(&_AbstractStorage, &_AbstractGoal, &_AbstractMap);
+		}
+
+		HierarchicalPathfinder::~HierarchicalPathfinder()
+		{
+		}
+
+		void HierarchicalPathfinder::SetSourceNode(PathfinderNodeID value)
+		{
+			_SourceNode = value;
+		}
+
+		void HierarchicalPathfinder::SetDestinationNode(PathfinderNodeID value)
+		{
+			_DestinationNode = value;
+			if (_Goal != NULL)
+				_Goal->SetDestinationNode(value);
+		}
+
+		void HierarchicalPathfinder::Initialize(PathfinderGoal* goal, GridPathfinderMap* map, int32 clusterSize)
+		{
+			_Goal = goal;
+			_Map = map;
+			_ClusterSize = Math::Max(clusterSize, 2);
+			_CurrentNode = NULL;
+			_SourceNode = PathfinderNodeID_Invalid;
+			_DestinationNode = PathfinderNodeID_Invalid;
+
+			_ClusterCountX = (_Map->GetWidth() + _ClusterSize - 1) / _ClusterSize;
+			_ClusterCountY = (_Map->GetHeight() + _ClusterSize - 1) / _ClusterSize;
+
+			_Nodes.Clear();
+			_FreeNodes.Clear();
+			_CellNodes.Clear();
+			_Path.Clear();
+
+			_Clusters.Clear();
+			_Clusters.Resize(_ClusterCountX * _ClusterCountY);
+			for (int32 j = 0; j < _ClusterCountY; ++j)
+			{
+				for (int32 i = 0; i < _ClusterCountX; ++i)
+				{
+					Cluster& cluster = _Clusters[j * _ClusterCountX + i];
+					cluster._X = i * _ClusterSize;
+					cluster._Y = j * _ClusterSize;
+					cluster._Width = Math::Min(_ClusterSize, _Map->GetWidth() - cluster._X);
+					cluster._Height = Math::Min(_ClusterSize, _Map->GetHeight() - cluster._Y);
+					cluster._IsDirty = true;
+				}
+			}
+
+			_Borders.Clear();
+			_Borders.Resize((_ClusterCountX - 1) * _ClusterCountY + _ClusterCountX * (_ClusterCountY - 1));
+
+			_RegionMap._Map = _Map;
+			_RegionStorage.SetNodeCount(_ClusterSize * _ClusterSize);
+			_RegionGoal._TargetIndices.Resize(_ClusterSize * _ClusterSize);
+			for (int32 i = 0; i < _ClusterSize * _ClusterSize; ++i)
+				_RegionGoal._TargetIndices[i] = -1;
+
+			_IsDirty = true;
+			Update();
+		}
+
+		void HierarchicalPathfinder::InvalidateNode(PathfinderNodeID node)
+		{
+			if (_Map == NULL || node == PathfinderNodeID_Invalid)
+				return;
+
+			// The borders of the cluster are rebuilt with it, the clusters on the other side follow
+			int32 cluster = GetClusterIndex(_Map->GetNodeX(node), _Map->GetNodeY(node));
+			_Clusters[cluster]._IsDirty = true;
+			_IsDirty = true;
+		}
+
+		void HierarchicalPathfinder::Update()
+		{
+			if (!_IsDirty)
+				return;
+
+			int32 verticalBorderCount = (_ClusterCountX - 1) * _ClusterCountY;
+			int32 borderCount = _Borders.Count();
+			int32 clusterCount = _Clusters.Count();
+
+			BaseArray<uint8> dirtyBorders;
+			dirtyBorders.Resize(borderCount);
+			BaseArray<uint8> dirtyClusters;
+			dirtyClusters.Resize(clusterCount);
+
+			// Mark the four borders of the invalid clusters and the clusters on their other side
+			for (int32 j = 0; j < _ClusterCountY; ++j)
+			{
+				for (int32 i = 0; i < _ClusterCountX; ++i)
+				{
+					int32 index = j * _ClusterCountX + i;
+					if (!_Clusters[index]._IsDirty)
+						continue;
+
+					dirtyClusters[index] = 1;
+					if (i > 0)
+					{
+						dirtyBorders[j * (_ClusterCountX - 1) + i - 1] = 1;
+						dirtyClusters[index - 1] = 1;
+					}
+					if (i < _ClusterCountX - 1)
+					{
+						dirtyBorders[j * (_ClusterCountX - 1) + i] = 1;
+						dirtyClusters[index + 1] = 1;
+					}
+					if (j > 0)
+					{
+						dirtyBorders[verticalBorderCount + (j - 1) * _ClusterCountX + i] = 1;
+						dirtyClusters[index - _ClusterCountX] = 1;
+					}
+					if (j < _ClusterCountY - 1)
+					{
+						dirtyBorders[verticalBorderCount + j * _ClusterCountX + i] = 1;
+						dirtyClusters[index + _ClusterCountX] = 1;
+					}
+					_Clusters[index]._IsDirty = false;
+				}
+			}
+
+			// The entrances are removed first, so the nodes of the cells that stay entrances are recreated
+			for (int32 i = 0; i < borderCount; ++i)
+			{
+				if (dirtyBorders[i])
+					ClearBorder(i);
+			}
+
+			for (int32 i = 0; i < borderCount; ++i)
+			{
+				if (dirtyBorders[i])
+					BuildBorder(i);
+			}
+
+			for (int32 i = 0; i < clusterCount; ++i)
+			{
+				if (dirtyClusters[i])
+					BuildClusterEdges(i);
+			}
+
+			_IsDirty = false;
+		}
+
+		void HierarchicalPathfinder::Run()
+		{
+			_Path.Clear();
+			_CurrentNode = NULL;
+			_Status = Status_Failed;
+
+			if (_Map == NULL || _SourceNode == PathfinderNodeID_Invalid || _DestinationNode == PathfinderNodeID_Invalid)
+				return;
+
+			Update();
+
+			int32 sourceX = _Map->GetNodeX(_SourceNode);
+			int32 sourceY = _Map->GetNodeY(_SourceNode);
+			int32 destinationX = _Map->GetNodeX(_DestinationNode);
+			int32 destinationY = _Map->GetNodeY(_DestinationNode);
+			if (!_Map->IsWalkableAt(sourceX, sourceY) || !_Map->IsWalkableAt(destinationX, destinationY))
+				return;
+
+			_Status = Status_Searching;
+			_Path.Add(_SourceNode);
+
+			// Inside a cluster, try a local search first
+			int32 sourceCluster = GetClusterIndex(sourceX, sourceY);
+			int32 destinationCluster = GetClusterIndex(destinationX, destinationY);
+			if (sourceCluster == destinationCluster)
+			{
+				if (_SourceNode == _DestinationNode || RefinePath(sourceCluster, _SourceNode, _DestinationNode))
+				{
+					_Status = Status_Succeeded;
+					return;
+				}
+			}
+
+			// Insert the source and the destination in the abstract graph
+			int32 source = -1;
+			int32 destination = -1;
+			bool isSourceTemporary = false;
+			bool isDestinationTemporary = false;
+			bool isConnected = true;
+
+			const int32* sourceNode = _CellNodes.Find(_SourceNode);
+			if (sourceNode != NULL)
+			{
+				source = *sourceNode;
+			}
+			else
+			{
+				source = AllocateNode(_SourceNode);
+				isSourceTemporary = true;
+				isConnected = ConnectNode(source, false);
+			}
+
+			const int32* destinationNode = _CellNodes.Find(_DestinationNode);
+			if (destinationNode != NULL)
+			{
+				destination = *destinationNode;
+			}
+			else
+			{
+				destination = AllocateNode(_DestinationNode);
+				isDestinationTemporary = true;
+				isConnected = ConnectNode(destination, true) && isConnected;
+			}
+
+			if (isConnected)
+			{
+				_AbstractStorage.SetNodeCount(_Nodes.Count());
+				_AbstractPathfinder.SetSourceNode(source);
+				_AbstractPathfinder.SetDestinationNode(destination);
+				_AbstractPathfinder.Run();
+
+				PathfinderNode* node = _AbstractPathfinder.GetCurrentNode();
+				if (node != NULL && node->_NodeID == destination)
+				{
+					// Collect the abstract nodes from the source to the destination
+					BaseArray<int32> abstractPath;
+					for (PathfinderNode* it = node; it != NULL; it = it->_Parent)
+						abstractPath.Add(it->_NodeID);
+
+					bool isRefined = true;
+					for (int32 i = abstractPath.Count() - 1; i > 0 && isRefined; --i)
+					{
+						const AbstractNode& from = _Nodes[abstractPath[i]];
+						const AbstractNode& to = _Nodes[abstractPath[i - 1]];
+
+						// The nodes of an inter-cluster edge are next to each other
+						if (from._Cluster != to._Cluster)
+							_Path.Add(to._Cell);
+						else
+							isRefined = RefinePath(from._Cluster, from._Cell, to._Cell);
+					}
+
+					if (isRefined)
+					{
+						_CurrentNode = node;
+						_Status = Status_Succeeded;
+					}
+				}
+			}
+
+			// Remove the temporary nodes
+			if (isDestinationTemporary)
+			{
+				const BaseArray<int32>& nodes = _Clusters[destinationCluster]._Nodes;
+				int32 count = nodes.Count();
+				for (int32 i = 0; i < count; ++i)
+					RemoveEdge(nodes[i], destination);
+				FreeNode(destination);
+			}
+			if (isSourceTemporary)
+			{
+				FreeNode(source);
+			}
+
+			if (_Status != Status_Succeeded)
+			{
+				_Path.Clear();
+				_Status = Status_Failed;
+			}
+		}
+
+		bool HierarchicalPathfinder::GetPath(BaseArray<PathfinderNodeID>& path) const
+		{
+			path = _Path;
+			return (_Status == Status_Succeeded);
+		}
+
+		int32 HierarchicalPathfinder::GetAbstractNodeCount() const
+		{
+			return _Nodes.Count() - _FreeNodes.Count();
+		}
+
+		int32 HierarchicalPathfinder::GetAbstractEdgeCount() const
+		{
+			int32 result = 0;
+			int32 count = _Nodes.Count();
+			for (int32 i = 0; i < count; ++i)
+				result += _Nodes[i]._Edges.Count();
+			return result;
+		}
+
+		int32 HierarchicalPathfinder::GetClusterIndex(int32 x, int32 y) const
+		{
+			return (y / _ClusterSize) * _ClusterCountX + (x / _ClusterSize);
+		}
+
+		int32 HierarchicalPathfinder::AllocateNode(PathfinderNodeID cell)
+		{
+			int32 node;
+			if (!_FreeNodes.IsEmpty())
+			{
+				node = _FreeNodes[_FreeNodes.Count() - 1];
+				_FreeNodes.RemoveAt(_FreeNodes.Count() - 1);
+			}
+			else
+			{
+				node = _Nodes.Count();
+				_Nodes.EmplaceBack();
+			}
+
+			AbstractNode& abstractNode = _Nodes[node];
+			abstractNode._Cell = cell;
+			abstractNode._Cluster = GetClusterIndex(_Map->GetNodeX(cell), _Map->GetNodeY(cell));
+			abstractNode._ReferenceCount = 0;
+			abstractNode._Edges.Clear();
+			return node;
+		}
+
+		void HierarchicalPathfinder::FreeNode(int32 node)
+		{
+			AbstractNode& abstractNode = _Nodes[node];
+			abstractNode._Cell = PathfinderNodeID_Invalid;
+			abstractNode._ReferenceCount = 0;
+			abstractNode._Edges.Clear();
+			_FreeNodes.Add(node);
+		}
+
+		int32 HierarchicalPathfinder::AddAbstractNode(PathfinderNodeID cell)
+		{
+			int32* existing = _CellNodes.Find(cell);
+			if (existing != NULL)
+			{
+				_Nodes[*existing]._ReferenceCount++;
+				return *existing;
+			}
+
+			int32 node = AllocateNode(cell);
+			_Nodes[node]._ReferenceCount = 1;
+			_Clusters[_Nodes[node]._Cluster]._Nodes.Add(node);
+			_CellNodes.Add(cell, node);
+			return node;
+		}
+
+		void HierarchicalPathfinder::ReleaseAbstractNode(int32 node)
+		{
+			AbstractNode& abstractNode = _Nodes[node];
+			if (--abstractNode._ReferenceCount > 0)
+				return;
+
+			// The intra-cluster edges pointing to the node are removed when its cluster is rebuilt
+			BaseArray<int32>& nodes = _Clusters[abstractNode._Cluster]._Nodes;
+			int32 count = nodes.Count();
+			for (int32 i = 0; i < count; ++i)
+			{
+				if (nodes[i] == node)
+				{
+					nodes.RemoveAt(i);
+					break;
+				}
+			}
+
+			_CellNodes.Remove(abstractNode._Cell);
+			FreeNode(node);
+		}
+
+		void HierarchicalPathfinder::AddEdge(int32 nodeA, int32 nodeB, real32 cost, bool isInterCluster)
+		{
+			AbstractEdge edge;
+			edge._Target = nodeB;
+			edge._Cost = cost;
+			edge._IsInterCluster = isInterCluster;
+			_Nodes[nodeA]._Edges.Add(edge);
+		}
+
+		void HierarchicalPathfinder::RemoveEdge(int32 nodeA, int32 nodeB)
+		{
+			BaseArray<AbstractEdge>& edges = _Nodes[nodeA]._Edges;
+			for (int32 i = edges.Count() - 1; i >= 0; --i)
+			{
+				if (edges[i]._Target == nodeB)
+				{
+					edges.RemoveAt(i);
+					return;
+				}
+			}
+		}
+
+		void HierarchicalPathfinder::ClearBorder(int32 border)
+		{
+			BaseArray<int32>& transitions = _Borders[border];
+			int32 count = transitions.Count();
+			for (int32 i = 0; i < count; i += 2)
+			{
+				RemoveEdge(transitions[i + 0], transitions[i + 1]);
+				RemoveEdge(transitions[i + 1], transitions[i + 0]);
+				ReleaseAbstractNode(transitions[i + 0]);
+				ReleaseAbstractNode(transitions[i + 1]);
+			}
+			transitions.Clear();
+		}
+
+		void HierarchicalPathfinder::BuildBorder(int32 border)
+		{
+			int32 verticalBorderCount = (_ClusterCountX - 1) * _ClusterCountY;
+
+			// Cells of the border in the first cluster, and the direction to the second cluster
+			int32 x, y, length, stepX, stepY, acrossX, acrossY;
+			if (border < verticalBorderCount)
+			{
+				int32 i = border % (_ClusterCountX - 1);
+				int32 j = border / (_ClusterCountX - 1);
+				const Cluster& cluster = _Clusters[j * _ClusterCountX + i];
+				x = cluster._X + cluster._Width - 1;
+				y = cluster._Y;
+				length = cluster._Height;
+				stepX = 0; stepY = 1;
+				acrossX = 1; acrossY = 0;
+			}
+			else
+			{
+				int32 i = (border - verticalBorderCount) % _ClusterCountX;
+				int32 j = (border - verticalBorderCount) / _ClusterCountX;
+				const Cluster& cluster = _Clusters[j * _ClusterCountX + i];
+				x = cluster._X;
+				y = cluster._Y + cluster._Height - 1;
+				length = cluster._Width;
+				stepX = 1; stepY = 0;
+				acrossX = 0; acrossY = 1;
+			}
+
+			BaseArray<int32>& transitions = _Borders[border];
+			int32 start = -1;
+			for (int32 k = 0; k <= length; ++k)
+			{
+				int32 cellX = x + k * stepX;
+				int32 cellY = y + k * stepY;
+				bool isOpen = (k < length &&
+					_Map->IsWalkable(cellX, cellY) && _Map->IsWalkable(cellX + acrossX, cellY + acrossY));
+
+				if (isOpen && start < 0)
+				{
+					start = k;
+				}
+				else if (!isOpen && start >= 0)
+				{
+					// The entrance is [start, k - 1], long entrances get a transition at each end
+					int32 positions[2];
+					int32 positionCount;
+					if (k - start < HierarchicalMaxSingleEntrance)
+					{
+						positions[0] = (start + k - 1) / 2;
+						positionCount = 1;
+					}
+					else
+					{
+						positions[0] = start;
+						positions[1] = k - 1;
+						positionCount = 2;
+					}
+
+					for (int32 p = 0; p < positionCount; ++p)
+					{
+						int32 positionX = x + positions[p] * stepX;
+						int32 positionY = y + positions[p] * stepY;
+						int32 nodeA = AddAbstractNode(_Map->GetNodeID(positionX, positionY));
+						int32 nodeB = AddAbstractNode(_Map->GetNodeID(positionX + acrossX, positionY + acrossY));
+						AddEdge(nodeA, nodeB, 1.0f, true);
+						AddEdge(nodeB, nodeA, 1.0f, true);
+						transitions.Add(nodeA);
+						transitions.Add(nodeB);
+					}
+
+					start = -1;
+				}
+			}
+		}
+
+		void HierarchicalPathfinder::BuildClusterEdges(int32 cluster)
+		{
+			const BaseArray<int32>& nodes = _Clusters[cluster]._Nodes;
+			int32 count = nodes.Count();
+
+			// Remove the previous intra-cluster edges
+			for (int32 i = 0; i < count; ++i)
+			{
+				BaseArray<AbstractEdge>& edges = _Nodes[nodes[i]]._Edges;
+				for (int32 e = edges.Count() - 1; e >= 0; --e)
+				{
+					if (!edges[e]._IsInterCluster)
+						edges.RemoveAt(e);
+				}
+			}
+
+			for (int32 i = 0; i < count; ++i)
+			{
+				SearchRegion(cluster, _Nodes[nodes[i]]._Cell, nodes);
+				for (int32 j = 0; j < count; ++j)
+				{
+					if (j != i && _RegionGoal._TargetCosts[j] >= 0.0f)
+						AddEdge(nodes[i], nodes[j], _RegionGoal._TargetCosts[j], false);
+				}
+			}
+		}
+
+		bool HierarchicalPathfinder::ConnectNode(int32 node, bool isDestination)
+		{
+			int32 cluster = _Nodes[node]._Cluster;
+			const BaseArray<int32>& nodes = _Clusters[cluster]._Nodes;
+			int32 count = nodes.Count();
+			if (count == 0)
+				return false;
+
+			SearchRegion(cluster, _Nodes[node]._Cell, nodes);
+
+			bool result = false;
+			for (int32 i = 0; i < count; ++i)
+			{
+				real32 cost = _RegionGoal._TargetCosts[i];
+				if (cost < 0.0f)
+					continue;
+
+				if (isDestination)
+					AddEdge(nodes[i], node, cost, false);
+				else
+					AddEdge(node, nodes[i], cost, false);
+				result = true;
+			}
+
+			return result;
+		}
+
+		void HierarchicalPathfinder::SearchRegion(int32 cluster, PathfinderNodeID source, const BaseArray<int32>& nodes)
+		{
+			const Cluster& region = _Clusters[cluster];
+			_RegionMap._X = region._X;
+			_RegionMap._Y = region._Y;
+			_RegionMap._Width = region._Width;
+			_RegionMap._Height = region._Height;
+
+			int32 count = nodes.Count();
+			_RegionGoal._Targets.Resize(count);
+			_RegionGoal._TargetCosts.Resize(count);
+			for (int32 i = 0; i < count; ++i)
+			{
+				PathfinderNodeID cell = _Nodes[nodes[i]]._Cell;
+				PathfinderNodeID target = (_Map->GetNodeY(cell) - region._Y) * region._Width + (_Map->GetNodeX(cell) - region._X);
+				_RegionGoal._Targets[i] = target;
+				_RegionGoal._TargetCosts[i] = -1.0f;
+				_RegionGoal._TargetIndices[target] = i;
+			}
+			_RegionGoal._RemainingTargets = count;
+
+			_RegionPathfinder.SetSourceNode((_Map->GetNodeY(source) - region._Y) * region._Width + (_Map->GetNodeX(source) - region._X));
+			_RegionPathfinder.SetDestinationNode(PathfinderNodeID_Invalid);
+			_RegionPathfinder.Run();
+
+			for (int32 i = 0; i < count; ++i)
+				_RegionGoal._TargetIndices[_RegionGoal._Targets[i]] = -1;
+		}
+
+		bool HierarchicalPathfinder::RefinePath(int32 cluster, PathfinderNodeID source, PathfinderNodeID destination)
+		{
+			const Cluster& region = _Clusters[cluster];
+			_RegionMap._X = region._X;
+			_RegionMap._Y = region._Y;
+			_RegionMap._Width = region._Width;
+			_RegionMap._Height = region._Height;
+			_RegionGoal._Targets.Clear();
+			_RegionGoal._RemainingTargets = 0;
+
+			PathfinderNodeID localDestination = (_Map->GetNodeY(destination) - region._Y) * region._Width + (_Map->GetNodeX(destination) - region._X);
+			_RegionPathfinder.SetSourceNode((_Map->GetNodeY(source) - region._Y) * region._Width + (_Map->GetNodeX(source) - region._X));
+			_RegionPathfinder.SetDestinationNode(localDestination);
+			_RegionPathfinder.Run();
+
+			PathfinderNode* node = _RegionPathfinder.GetCurrentNode();
+			if (node == NULL || node->_NodeID != localDestination)
+				return false;
+
+			// Add the cells after the source, the parents go from the destination to the source
+			int32 first = _Path.Count();
+			for (; node->_Parent != NULL; node = node->_Parent)
+			{
+				int32 x = region._X + node->_NodeID % region._Width;
+				int32 y = region._Y + node->_NodeID / region._Width;
+				_Path.Add(_Map->GetNodeID(x, y));
+			}
+
+			int32 last = _Path.Count() - 1;
+			for (; first < last; ++first, --last)
+				SE_Swap(_Path[first], _Path[last]);
+
+			return true;
+		}
+	}
+}
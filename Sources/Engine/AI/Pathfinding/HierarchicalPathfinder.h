@@ -0,0 +1,256 @@
+/*=============================================================================
+HierarchicalPathfinder.h
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+#ifndef _SE_AI_HIERARCHICALPATHFINDER_H_
+#define _SE_AI_HIERARCHICALPATHFINDER_H_
+
+#include "AI/Common.h"
+#include "AI/Pathfinding/Pathfinder.h"
+#include "AI/Pathfinding/AStarPathfinder.h"
+#include "AI/Pathfinding/GridPathfinderMap.h"
+#include "AI/Pathfinding/IndexedAStarPathfinderStorage.h"
+
+namespace SonataEngine
+{
+	namespace AI
+	{
+		/**
+			@brief Hierarchical Pathfinder (HPA*).
+
+			The grid is divided in square clusters. The walkable segments along the
+			border of two clusters are entrances, each entrance adds one or two pairs
+			of abstract nodes linked across the border, and the abstract nodes of a
+			cluster are linked by the cost of the shortest path between them inside
+			the cluster.
+
+			A search links the source and the destination to the abstract nodes of
+			their cluster, searches the abstract graph with A*, then refines each
+			abstract edge with a search limited to its cluster. The paths are close to
+			the shortest ones, and the cost of a search mostly depends on the number
+			of clusters crossed.
+
+			The abstract graph is built from the walkable cells of the map. When a
+			cell changes, InvalidateNode marks its clusters, which are rebuilt at the
+			next search.
+		*/
+		class SE_AI_EXPORT HierarchicalPathfinder : public Pathfinder
+		{
+		public:
+			HierarchicalPathfinder();
+			virtual ~HierarchicalPathfinder();
+
+			virtual PathfinderGoal* GetGoal() const { return _Goal; }
+			virtual PathfinderMap* GetMap() const { return _Map; }
+
+			virtual PathfinderNodeID GetSourceNode() const { return _SourceNode; }
+			virtual void SetSourceNode(PathfinderNodeID value);
+
+			virtual PathfinderNodeID GetDestinationNode() const { return _DestinationNode; }
+			virtual void SetDestinationNode(PathfinderNodeID value);
+
+			/** Gets the abstract node of the destination, its parents are the previous abstract nodes. */
+			virtual PathfinderNode* GetCurrentNode() const { return _CurrentNode; }
+
+			/**
+				Initializes the pathfinder and builds the abstract graph.
+				@param goal The goal notified of the destination.
+				@param map The grid.
+				@param clusterSize The width and height of the clusters in cells.
+			*/
+			void Initialize(PathfinderGoal* goal, GridPathfinderMap* map, int32 clusterSize = 16);
+
+			/** Marks the clusters of a cell whose walkability changed, they are rebuilt at the next search. */
+			void InvalidateNode(PathfinderNodeID node);
+
+			/** Rebuilds the invalidated clusters. */
+			void Update();
+
+			virtual void Run();
+
+			/**
+				Gets the cells of the path found by the last search, from the source to the destination.
+				@return false if no path was found.
+			*/
+			bool GetPath(BaseArray<PathfinderNodeID>& path) const;
+
+			/** @name Statistics. */
+			//@{
+			int32 GetClusterSize() const { return _ClusterSize; }
+			int32 GetAbstractNodeCount() const;
+			int32 GetAbstractEdgeCount() const;
+			//@}
+
+		protected:
+			/// Link between two abstract nodes.
+			struct AbstractEdge
+			{
+				int32 _Target;
+				real32 _Cost;
+				bool _IsInterCluster;
+			};
+
+			/// Cell on the border of a cluster.
+			struct AbstractNode
+			{
+				PathfinderNodeID _Cell;
+				int32 _Cluster;
+
+				/// Number of entrances using the node, 0 for a free node.
+				int32 _ReferenceCount;
+
+				BaseArray<AbstractEdge> _Edges;
+			};
+
+			struct Cluster
+			{
+				int32 _X;
+				int32 _Y;
+				int32 _Width;
+				int32 _Height;
+				BaseArray<int32> _Nodes;
+				bool _IsDirty;
+			};
+
+			/** Map of the cells of a rectangle of the grid, the node identifiers are local to the rectangle. */
+			class RegionMap : public AStarPathfinderMap
+			{
+			public:
+				virtual int GetNeighbourCount(PathfinderNode* node);
+				virtual PathfinderNodeID GetNeighbour(PathfinderNode* node, int index);
+
+				GridPathfinderMap* _Map;
+				int32 _X;
+				int32 _Y;
+				int32 _Width;
+				int32 _Height;
+			};
+
+			/**
+				Goal of a search in a region. Without destination, the search stops
+				when every target is reached and records the cost of each target.
+			*/
+			class RegionGoal : public AStarPathfinderGoal
+			{
+			public:
+				virtual void SetDestinationNode(PathfinderNodeID node) { _Destination = node; }
+				virtual real32 GetHeuristic(AStarPathfinderNode* node);
+				virtual real32 GetCost(AStarPathfinderNode* nodeA, AStarPathfinderNode* nodeB);
+				virtual bool IsSearchFinished(AStarPathfinderNode* node);
+
+				RegionMap* _Region;
+				PathfinderNodeID _Destination;
+				BaseArray<PathfinderNodeID> _Targets;
+				BaseArray<real32> _TargetCosts;
+
+				/// Index of the target of each cell of the region, or -1.
+				BaseArray<int32> _TargetIndices;
+				int32 _RemainingTargets;
+			};
+
+			/** Map of the abstract graph, the node identifiers are the indices of the abstract nodes. */
+			class AbstractMap : public AStarPathfinderMap
+			{
+			public:
+				virtual int GetNeighbourCount(PathfinderNode* node);
+				virtual PathfinderNodeID GetNeighbour(PathfinderNode* node, int index);
+
+				HierarchicalPathfinder* _Owner;
+			};
+
+			class AbstractGoal : public AStarPathfinderGoal
+			{
+			public:
+				virtual void SetDestinationNode(PathfinderNodeID node) { _Destination = node; }
+				virtual real32 GetHeuristic(AStarPathfinderNode* node);
+				virtual real32 GetCost(AStarPathfinderNode* nodeA, AStarPathfinderNode* nodeB);
+				virtual bool IsSearchFinished(AStarPathfinderNode* node);
+
+				HierarchicalPathfinder* _Owner;
+				PathfinderNodeID _Destination;
+			};
+
+			friend class AbstractMap;
+			friend class AbstractGoal;
+
+			int32 GetClusterIndex(int32 x, int32 y) const;
+
+			/** @name Abstract graph. */
+			//@{
+			/** Allocates an abstract node that doesn't belong to its cluster yet. */
+			int32 AllocateNode(PathfinderNodeID cell);
+			void FreeNode(int32 node);
+
+			/** Gets the abstract node of an entrance cell, it is shared by the entrances of the cell. */
+			int32 AddAbstractNode(PathfinderNodeID cell);
+			void ReleaseAbstractNode(int32 node);
+
+			void AddEdge(int32 nodeA, int32 nodeB, real32 cost, bool isInterCluster);
+			void RemoveEdge(int32 nodeA, int32 nodeB);
+
+			/** Removes the entrances of the border between a cluster and its right or bottom neighbour. */
+			void ClearBorder(int32 border);
+
+			/** Finds the entrances of the border between a cluster and its right or bottom neighbour. */
+			void BuildBorder(int32 border);
+
+			/** Links the abstract nodes of a cluster by their shortest paths inside the cluster. */
+			void BuildClusterEdges(int32 cluster);
+
+			/**
+				Links a temporary abstract node to the other abstract nodes of its cluster.
+				@return false if no abstract node can be reached.
+			*/
+			bool ConnectNode(int32 node, bool isDestination);
+			//@}
+
+			/** Searches a path between two cells of a cluster, the cells are added to _Path without the first one. */
+			bool RefinePath(int32 cluster, PathfinderNodeID source, PathfinderNodeID destination);
+
+			/**
+				Searches the shortest paths inside a cluster from a cell to the cells of abstract nodes.
+				The costs are stored in _RegionGoal._TargetCosts, negative for the unreachable nodes.
+			*/
+			void SearchRegion(int32 cluster, PathfinderNodeID source, const BaseArray<int32>& nodes);
+
+		protected:
+			PathfinderGoal* _Goal;
+			GridPathfinderMap* _Map;
+			int32 _ClusterSize;
+			int32 _ClusterCountX;
+			int32 _ClusterCountY;
+
+			BaseArray<Cluster> _Clusters;
+			BaseArray<AbstractNode> _Nodes;
+			BaseArray<int32> _FreeNodes;
+			Hashtable<PathfinderNodeID, int32> _CellNodes;
+
+			/// Pairs of abstract nodes of the entrances of each border, the vertical borders come first.
+			BaseArray< BaseArray<int32> > _Borders;
+			bool _IsDirty;
+
+			PathfinderNodeID _SourceNode;
+			PathfinderNodeID _DestinationNode;
+			PathfinderNode* _CurrentNode;
+			BaseArray<PathfinderNodeID> _Path;
+
+			RegionMap _RegionMap;
+			RegionGoal _RegionGoal;
+			PooledAStarPathfinderStorage<AStarPathfinderNode> _RegionStorage;
+			AStarPathfinder _RegionPathfinder;
+
+			AbstractMap _AbstractMap;
+			AbstractGoal _AbstractGoal;
+			PooledAStarPathfinderStorage<AStarPathfinderNode> _AbstractStorage;
+			AStarPathfinder _AbstractPathfinder;
+
+		private:
+			HierarchicalPathfinder(const HierarchicalPathfinder&);
+			HierarchicalPathfinder& operator=(const HierarchicalPathfinder&);
+		};
+	}
+}
+
+#endif
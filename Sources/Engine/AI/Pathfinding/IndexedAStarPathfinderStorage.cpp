@@ -0,0 +1,202 @@
+/*=============================================================================
+IndexedAStarPathfinderStorage.cpp
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+#include "IndexedAStarPathfinderStorage.h"
+
+namespace SonataEngine
+{
+	namespace AI
+	{
+		IndexedAStarPathfinderStorage::IndexedAStarPathfinderStorage() :
+			AStarPathfinderStorage(),
+			_Generation(1)
+		{
+		}
+
+		IndexedAStarPathfinderStorage::~IndexedAStarPathfinderStorage()
+		{
+		}
+
+		void IndexedAStarPathfinderStorage::SetNodeCount(int32 value)
+		{
+			if (value > _Entries.Count())
+				_Entries.Resize(value);
+		}
+
+		void IndexedAStarPathfinderStorage::Reset()
+		{
+			_Heap.Clear();
+
+			++_Generation;
+			if (_Generation == 0)
+			{
+				// The generation wrapped around, clear the stamps of the old searches
+				int32 count = _Entries.Count();
+				for (int32 i = 0; i < count; ++i)
+					_Entries[i]._Generation = 0;
+				_Generation = 1;
+			}
+		}
+
+		void IndexedAStarPathfinderStorage::AddToOpenList(AStarPathfinderNode* node, AStarPathfinderMap* map)
+		{
+			if (node->_NodeID >= _Entries.Count())
+				_Entries.Resize(Math::Max(node->_NodeID + 1, _Entries.Count() * 2));
+
+			NodeEntry& entry = _Entries[node->_NodeID];
+			if (entry._Generation != _Generation)
+			{
+				entry._Generation = _Generation;
+				entry._HeapIndex = HeapIndex_None;
+			}
+			entry._Node = node;
+
+			HeapItem item;
+			item._Fitness = node->_Fitness;
+			item._Heuristic = node->_Heuristic;
+			item._Node = node;
+
+			if (entry._HeapIndex >= 0)
+			{
+				// The node is already in the Open list, its fitness can only decrease
+				int32 index = entry._HeapIndex;
+				_Heap[index] = item;
+				SiftUp(index);
+			}
+			else
+			{
+				_Heap.Add(item);
+				entry._HeapIndex = _Heap.Count() - 1;
+				SiftUp(entry._HeapIndex);
+			}
+		}
+
+		void IndexedAStarPathfinderStorage::AddToClosedList(AStarPathfinderNode* node, AStarPathfinderMap* map)
+		{
+			NodeEntry* entry = GetEntry(node->_NodeID);
+			if (entry == NULL)
+				return;
+
+			if (entry->_HeapIndex >= 0)
+				RemoveHeapItem(entry->_HeapIndex);
+
+			entry->_HeapIndex = HeapIndex_Closed;
+		}
+
+		void IndexedAStarPathfinderStorage::RemoveFromOpenList(AStarPathfinderNode* node)
+		{
+			NodeEntry* entry = GetEntry(node->_NodeID);
+			if (entry == NULL || entry->_HeapIndex < 0)
+				return;
+
+			RemoveHeapItem(entry->_HeapIndex);
+			entry->_HeapIndex = HeapIndex_None;
+		}
+
+		void IndexedAStarPathfinderStorage::RemoveFromClosedList(AStarPathfinderNode* node)
+		{
+			NodeEntry* entry = GetEntry(node->_NodeID);
+			if (entry == NULL || entry->_HeapIndex != HeapIndex_Closed)
+				return;
+
+			entry->_HeapIndex = HeapIndex_None;
+		}
+
+		AStarPathfinderNode* IndexedAStarPathfinderStorage::FindInOpenList(PathfinderNodeID node)
+		{
+			NodeEntry* entry = GetEntry(node);
+			if (entry == NULL || entry->_HeapIndex < 0)
+				return NULL;
+
+			return entry->_Node;
+		}
+
+		AStarPathfinderNode* IndexedAStarPathfinderStorage::FindInClosedList(PathfinderNodeID node)
+		{
+			NodeEntry* entry = GetEntry(node);
+			if (entry == NULL || entry->_HeapIndex != HeapIndex_Closed)
+				return NULL;
+
+			return entry->_Node;
+		}
+
+		AStarPathfinderNode* IndexedAStarPathfinderStorage::RemoveBestOpenNode()
+		{
+			if (_Heap.IsEmpty())
+				return NULL;
+
+			AStarPathfinderNode* node = _Heap[0]._Node;
+			RemoveHeapItem(0);
+			_Entries[node->_NodeID]._HeapIndex = HeapIndex_None;
+
+			return node;
+		}
+
+		void IndexedAStarPathfinderStorage::SetHeapItem(int32 index, const HeapItem& item)
+		{
+			_Heap[index] = item;
+			_Entries[item._Node->_NodeID]._HeapIndex = index;
+		}
+
+		void IndexedAStarPathfinderStorage::SiftUp(int32 index)
+		{
+			HeapItem item = _Heap[index];
+			while (index > 0)
+			{
+				int32 parent = (index - 1) / 2;
+				if (!IsBefore(item, _Heap[parent]))
+					break;
+
+				SetHeapItem(index, _Heap[parent]);
+				index = parent;
+			}
+			SetHeapItem(index, item);
+		}
+
+		void IndexedAStarPathfinderStorage::SiftDown(int32 index)
+		{
+			int32 count = _Heap.Count();
+			HeapItem item = _Heap[index];
+			while (true)
+			{
+				int32 child = index * 2 + 1;
+				if (child >= count)
+					break;
+
+				if (child + 1 < count && IsBefore(_Heap[child + 1], _Heap[child]))
+					++child;
+				if (!IsBefore(_Heap[child], item))
+					break;
+
+				SetHeapItem(index, _Heap[child]);
+				index = child;
+			}
+			SetHeapItem(index, item);
+		}
+
+		void IndexedAStarPathfinderStorage::RemoveHeapItem(int32 index)
+		{
+			int32 last = _Heap.Count() - 1;
+			if (index != last)
+			{
+				// Move the last item to the hole and restore the order from there
+				HeapItem item = _Heap[last];
+				bool isBefore = IsBefore(item, _Heap[index]);
+				_Heap.RemoveAt(last);
+				SetHeapItem(index, item);
+
+				if (isBefore)
+					SiftUp(index);
+				else
+					SiftDown(index);
+			}
+			else
+			{
+				_Heap.RemoveAt(last);
+			}
+		}
+	}
+}
@@ -0,0 +1,170 @@
+/*=============================================================================
+IndexedAStarPathfinderStorage.h
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+#ifndef _SE_AI_INDEXEDASTARPATHFINDERSTORAGE_H_
+#define _SE_AI_INDEXEDASTARPATHFINDERSTORAGE_H_
+
+#include "AI/Common.h"
+#include "AI/Pathfinding/AStarPathfinder.h"
+
+namespace SonataEngine
+{
+	namespace AI
+	{
+		/**
+			@brief A* storage with an indexed binary heap.
+
+			The Open list is a binary heap of nodes. The state of each node and its
+			position in the heap are stored in a table indexed by the node identifiers,
+			so the lookups in the lists are done in constant time and a node of the
+			Open list whose fitness decreases is moved up in place.
+
+			The node identifiers must be dense, like the index of a cell in a grid.
+			The entries of the table are stamped with the number of the search, and
+			Reset only increments this number.
+		*/
+		class SE_AI_EXPORT IndexedAStarPathfinderStorage : public AStarPathfinderStorage
+		{
+		public:
+			IndexedAStarPathfinderStorage();
+			virtual ~IndexedAStarPathfinderStorage();
+
+			/**
+				Sets the number of node identifiers.
+				The table also grows when a larger identifier is added to the Open list.
+			*/
+			void SetNodeCount(int32 value);
+			int32 GetNodeCount() const { return _Entries.Count(); }
+
+			/** Gets the number of nodes in the Open list. */
+			int32 GetOpenCount() const { return _Heap.Count(); }
+
+			virtual void Reset();
+			virtual void AddToOpenList(AStarPathfinderNode* node, AStarPathfinderMap* map);
+			virtual void AddToClosedList(AStarPathfinderNode* node, AStarPathfinderMap* map);
+			virtual void RemoveFromOpenList(AStarPathfinderNode* node);
+			virtual void RemoveFromClosedList(AStarPathfinderNode* node);
+
+			virtual AStarPathfinderNode* FindInOpenList(PathfinderNodeID node);
+			virtual AStarPathfinderNode* FindInClosedList(PathfinderNodeID node);
+
+			virtual AStarPathfinderNode* RemoveBestOpenNode();
+
+		protected:
+			/// Position of the nodes that are not in the heap.
+			enum HeapIndex
+			{
+				HeapIndex_None = -1,
+				HeapIndex_Closed = -2
+			};
+
+			/// State of a node identifier. The entry is valid when its generation is the current one.
+			struct NodeEntry
+			{
+				AStarPathfinderNode* _Node;
+				uint32 _Generation;
+				int32 _HeapIndex;
+			};
+
+			/// Node of the heap, the keys are copied to avoid reading the nodes while sorting.
+			struct HeapItem
+			{
+				real32 _Fitness;
+				real32 _Heuristic;
+				AStarPathfinderNode* _Node;
+			};
+
+			/** Gets the entry of a node in the current search, or NULL. */
+			NodeEntry* GetEntry(PathfinderNodeID node)
+			{
+				if (node < 0 || node >= _Entries.Count())
+					return NULL;
+
+				NodeEntry* entry = &_Entries[node];
+				return (entry->_Generation == _Generation ? entry : NULL);
+			}
+
+			/** The nodes are sorted by fitness, then by heuristic to expand the nodes nearest to the goal first. */
+			static bool IsBefore(const HeapItem& left, const HeapItem& right)
+			{
+				if (left._Fitness != right._Fitness)
+					return (left._Fitness < right._Fitness);
+				return (left._Heuristic < right._Heuristic);
+			}
+
+			void SetHeapItem(int32 index, const HeapItem& item);
+			void SiftUp(int32 index);
+			void SiftDown(int32 index);
+			void RemoveHeapItem(int32 index);
+
+			BaseArray<NodeEntry> _Entries;
+			BaseArray<HeapItem> _Heap;
+			uint32 _Generation;
+		};
+
+		/**
+			A* storage creating its nodes from a pool.
+			The nodes are allocated by blocks and are reused by the next searches,
+			Reset and DestroyNode don't free them.
+			@remark The nodes returned by a search are valid until the next search.
+		*/
+		template <class T>
+		class PooledAStarPathfinderStorage : public IndexedAStarPathfinderStorage
+		{
+		public:
+			PooledAStarPathfinderStorage(int32 blockSize = 1024) :
+				IndexedAStarPathfinderStorage(),
+				_BlockSize(blockSize),
+				_UsedCount(0)
+			{
+			}
+
+			virtual ~PooledAStarPathfinderStorage()
+			{
+				for (int32 i = 0; i < _Blocks.Count(); ++i)
+					delete[] _Blocks[i];
+			}
+
+			virtual AStarPathfinderNode* CreateNode(PathfinderNodeID node)
+			{
+				int32 block = _UsedCount / _BlockSize;
+				if (block == _Blocks.Count())
+					_Blocks.Add(new T[_BlockSize]);
+
+				T* result = &_Blocks[block][_UsedCount % _BlockSize];
+				++_UsedCount;
+
+				*result = T();
+				result->_NodeID = node;
+				return result;
+			}
+
+			virtual void DestroyNode(AStarPathfinderNode* node)
+			{
+			}
+
+			virtual void Reset()
+			{
+				IndexedAStarPathfinderStorage::Reset();
+				_UsedCount = 0;
+			}
+
+			/** Gets the number of nodes created since the last reset. */
+			int32 GetUsedCount() const { return _UsedCount; }
+
+		protected:
+			BaseArray<T*> _Blocks;
+			int32 _BlockSize;
+			int32 _UsedCount;
+
+		private:
+			PooledAStarPathfinderStorage(const PooledAStarPathfinderStorage&);
+			PooledAStarPathfinderStorage& operator=(const PooledAStarPathfinderStorage&);
+		};
+	}
+}
+
+#endif
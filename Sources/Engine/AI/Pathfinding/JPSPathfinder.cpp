@@ -0,0 +1,306 @@
+/*=============================================================================
+JPSPathfinder.cpp
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+#include "JPSPathfinder.h"
+
+namespace SonataEngine
+{
+	namespace AI
+	{
+		static void AddDirection(int32* directions, int32& count, int32 dx, int32 dy)
+		{
+			directions[count * 2 + 0] = dx;
+			directions[count * 2 + 1] = dy;
+			count++;
+		}
+
+		JPSPathfinder::JPSPathfinder() :
+			Pathfinder(),
+			_Goal(NULL),
+			_Map(NULL),
+			_CurrentNode(NULL),
+			_SourceNode(PathfinderNodeID_Invalid),
+			_DestinationNode(PathfinderNodeID_Invalid),
+			_DestinationX(0),
+			_DestinationY(0),
+			_ExpandedNodeCount(0)
+		{
+		}
+
+		JPSPathfinder::~JPSPathfinder()
+		{
+		}
+
+		void JPSPathfinder::SetSourceNode(PathfinderNodeID value)
+		{
+			_SourceNode = value;
+		}
+
+		void JPSPathfinder::SetDestinationNode(PathfinderNodeID value)
+		{
+			_DestinationNode = value;
+			if (_Goal != NULL)
+				_Goal->SetDestinationNode(value);
+		}
+
+		void JPSPathfinder::Initialize(PathfinderGoal* goal, GridPathfinderMap* map)
+		{
+			_Goal = goal;
+			_Map = map;
+
+			_CurrentNode = NULL;
+
+			_SourceNode = PathfinderNodeID_Invalid;
+			_DestinationNode = PathfinderNodeID_Invalid;
+		}
+
+		void JPSPathfinder::Run()
+		{
+			_Storage.Reset();
+			_CurrentNode = NULL;
+			_ExpandedNodeCount = 0;
+			_Status = Status_Failed;
+
+			if (_Map == NULL || !_Map->GetAllowDiagonals() ||
+				_SourceNode == PathfinderNodeID_Invalid || _DestinationNode == PathfinderNodeID_Invalid)
+			{
+				return;
+			}
+
+			_Storage.SetNodeCount(_Map->GetWidth() * _Map->GetHeight());
+			_DestinationX = _Map->GetNodeX(_DestinationNode);
+			_DestinationY = _Map->GetNodeY(_DestinationNode);
+
+			int32 x = _Map->GetNodeX(_SourceNode);
+			int32 y = _Map->GetNodeY(_SourceNode);
+			if (!_Map->IsWalkableAt(x, y) || !_Map->IsWalkableAt(_DestinationX, _DestinationY))
+			{
+				return;
+			}
+
+			_Status = Status_Searching;
+
+			AStarPathfinderNode* node = _Storage.CreateNode(_SourceNode);
+			node->_Goal = 0.0f;
+			node->_Heuristic = _Map->GetDistance(x, y, _DestinationX, _DestinationY);
+			node->_Fitness = node->_Heuristic;
+			_Storage.AddToOpenList(node, _Map);
+
+			int32 directions[16];
+			while ((node = _Storage.RemoveBestOpenNode()) != NULL)
+			{
+				_Storage.AddToClosedList(node, _Map);
+				_ExpandedNodeCount++;
+
+				if (node->_NodeID == _DestinationNode)
+				{
+					_CurrentNode = node;
+					_Status = Status_Succeeded;
+					return;
+				}
+
+				x = _Map->GetNodeX(node->_NodeID);
+				y = _Map->GetNodeY(node->_NodeID);
+
+				int32 directionCount = GetDirections(node, directions);
+				for (int32 i = 0; i < directionCount; ++i)
+				{
+					int32 dx = directions[i * 2 + 0];
+					int32 dy = directions[i * 2 + 1];
+
+					PathfinderNodeID jumpPoint = Jump(x + dx, y + dy, dx, dy);
+					if (jumpPoint == PathfinderNodeID_Invalid)
+						continue;
+
+					if (_Storage.FindInClosedList(jumpPoint) != NULL)
+						continue;
+
+					// The cells between the node and the jump point are on a straight or diagonal line
+					int32 jumpX = _Map->GetNodeX(jumpPoint);
+					int32 jumpY = _Map->GetNodeY(jumpPoint);
+					real32 g = node->_Goal + _Map->GetDistance(x, y, jumpX, jumpY);
+
+					AStarPathfinderNode* jumpNode = _Storage.FindInOpenList(jumpPoint);
+					if (jumpNode == NULL)
+					{
+						jumpNode = _Storage.CreateNode(jumpPoint);
+						jumpNode->_Heuristic = _Map->GetDistance(jumpX, jumpY, _DestinationX, _DestinationY);
+					}
+					else if (g >= jumpNode->_Goal)
+					{
+						continue;
+					}
+
+					jumpNode->_Goal = g;
+					jumpNode->_Fitness = g + jumpNode->_Heuristic;
+					jumpNode->_Parent = node;
+					_Storage.AddToOpenList(jumpNode, _Map);
+				}
+			}
+
+			_Status = Status_Failed;
+		}
+
+		int32 JPSPathfinder::GetDirections(AStarPathfinderNode* node, int32* directions)
+		{
+			int32 x = _Map->GetNodeX(node->_NodeID);
+			int32 y = _Map->GetNodeY(node->_NodeID);
+			int32 count = 0;
+
+			if (node->_Parent == NULL)
+			{
+				// The source node follows every direction
+				for (int32 i = 0; i < 8; ++i)
+				{
+					int32 dx, dy;
+					GridPathfinderMap::GetDirection(i, dx, dy);
+					if (_Map->CanMove(x, y, dx, dy))
+						AddDirection(directions, count, dx, dy);
+				}
+				return count;
+			}
+
+			int32 parentX = _Map->GetNodeX(node->_Parent->_NodeID);
+			int32 parentY = _Map->GetNodeY(node->_Parent->_NodeID);
+			int32 dx = (x > parentX ? 1 : (x < parentX ? -1 : 0));
+			int32 dy = (y > parentY ? 1 : (y < parentY ? -1 : 0));
+
+			if (dx != 0 && dy != 0)
+			{
+				// Diagonal: the two straight components and the diagonal
+				bool isHorizontalWalkable = _Map->IsWalkableAt(x + dx, y);
+				bool isVerticalWalkable = _Map->IsWalkableAt(x, y + dy);
+				if (isVerticalWalkable)
+					AddDirection(directions, count, 0, dy);
+				if (isHorizontalWalkable)
+					AddDirection(directions, count, dx, 0);
+				if (isHorizontalWalkable && isVerticalWalkable)
+					AddDirection(directions, count, dx, dy);
+			}
+			else if (dx != 0)
+			{
+				// Horizontal: the next cell, and the sides that may hide a forced neighbour
+				bool isNextWalkable = _Map->IsWalkableAt(x + dx, y);
+				bool isUpWalkable = _Map->IsWalkableAt(x, y + 1);
+				bool isDownWalkable = _Map->IsWalkableAt(x, y - 1);
+				if (isNextWalkable)
+				{
+					AddDirection(directions, count, dx, 0);
+					if (isUpWalkable)
+						AddDirection(directions, count, dx, 1);
+					if (isDownWalkable)
+						AddDirection(directions, count, dx, -1);
+				}
+				if (isUpWalkable)
+					AddDirection(directions, count, 0, 1);
+				if (isDownWalkable)
+					AddDirection(directions, count, 0, -1);
+			}
+			else
+			{
+				// Vertical
+				bool isNextWalkable = _Map->IsWalkableAt(x, y + dy);
+				bool isRightWalkable = _Map->IsWalkableAt(x + 1, y);
+				bool isLeftWalkable = _Map->IsWalkableAt(x - 1, y);
+				if (isNextWalkable)
+				{
+					AddDirection(directions, count, 0, dy);
+					if (isRightWalkable)
+						AddDirection(directions, count, 1, dy);
+					if (isLeftWalkable)
+						AddDirection(directions, count, -1, dy);
+				}
+				if (isRightWalkable)
+					AddDirection(directions, count, 1, 0);
+				if (isLeftWalkable)
+					AddDirection(directions, count, -1, 0);
+			}
+
+			return count;
+		}
+
+		PathfinderNodeID JPSPathfinder::Jump(int32 x, int32 y, int32 dx, int32 dy)
+		{
+			while (true)
+			{
+				if (!_Map->IsWalkableAt(x, y))
+					return PathfinderNodeID_Invalid;
+
+				if (x == _DestinationX && y == _DestinationY)
+					return _DestinationNode;
+
+				if (dx != 0 && dy != 0)
+				{
+					// A diagonal cell is a jump point when a straight line from it reaches one
+					if (Jump(x + dx, y, dx, 0) != PathfinderNodeID_Invalid ||
+						Jump(x, y + dy, 0, dy) != PathfinderNodeID_Invalid)
+					{
+						return _Map->GetNodeID(x, y);
+					}
+
+					// Don't cut the corners
+					if (!_Map->IsWalkableAt(x + dx, y) || !_Map->IsWalkableAt(x, y + dy))
+						return PathfinderNodeID_Invalid;
+				}
+				else if (dx != 0)
+				{
+					// A side cell that was blocked behind opens: it can only be reached through this cell
+					if ((_Map->IsWalkableAt(x, y + 1) && !_Map->IsWalkableAt(x - dx, y + 1)) ||
+						(_Map->IsWalkableAt(x, y - 1) && !_Map->IsWalkableAt(x - dx, y - 1)))
+					{
+						return _Map->GetNodeID(x, y);
+					}
+				}
+				else
+				{
+					if ((_Map->IsWalkableAt(x + 1, y) && !_Map->IsWalkableAt(x + 1, y - dy)) ||
+						(_Map->IsWalkableAt(x - 1, y) && !_Map->IsWalkableAt(x - 1, y - dy)))
+					{
+						return _Map->GetNodeID(x, y);
+					}
+				}
+
+				x += dx;
+				y += dy;
+			}
+		}
+
+		bool JPSPathfinder::GetPath(BaseArray<PathfinderNodeID>& path) const
+		{
+			path.Clear();
+			if (_CurrentNode == NULL)
+				return false;
+
+			// Add the cells from the destination to the source, then reverse them
+			const PathfinderNode* node = _CurrentNode;
+			path.Add(node->_NodeID);
+			while (node->_Parent != NULL)
+			{
+				int32 x = _Map->GetNodeX(node->_NodeID);
+				int32 y = _Map->GetNodeY(node->_NodeID);
+				int32 parentX = _Map->GetNodeX(node->_Parent->_NodeID);
+				int32 parentY = _Map->GetNodeY(node->_Parent->_NodeID);
+				int32 dx = (parentX > x ? 1 : (parentX < x ? -1 : 0));
+				int32 dy = (parentY > y ? 1 : (parentY < y ? -1 : 0));
+
+				while (x != parentX || y != parentY)
+				{
+					x += dx;
+					y += dy;
+					path.Add(_Map->GetNodeID(x, y));
+				}
+
+				node = node->_Parent;
+			}
+
+			int32 count = path.Count();
+			for (int32 i = 0; i < count / 2; ++i)
+				SE_Swap(path[i], path[count - 1 - i]);
+
+			return true;
+		}
+	}
+}
@@ -0,0 +1,86 @@
+/*=============================================================================
+JPSPathfinder.h
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+#ifndef _SE_AI_JPSPATHFINDER_H_
+#define _SE_AI_JPSPATHFINDER_H_
+
+#include "AI/Common.h"
+#include "AI/Pathfinding/Pathfinder.h"
+#include "AI/Pathfinding/GridPathfinderMap.h"
+#include "AI/Pathfinding/IndexedAStarPathfinderStorage.h"
+
+namespace SonataEngine
+{
+	namespace AI
+	{
+		/**
+			@brief Jump Point Search Pathfinder.
+
+			A* on a uniform cost grid where the straight and diagonal lines without
+			branching are skipped: from each node, the search only follows the
+			directions that can't be reached more cheaply through its parent, and
+			jumps along them until a cell with a forced neighbour or the destination.
+			Only these jump points are added to the Open list, so the open areas of
+			the grid are crossed without expanding their cells.
+
+			The map must allow the diagonals. The walkable cells are given by the map
+			and the goal is only notified of the destination.
+		*/
+		class SE_AI_EXPORT JPSPathfinder : public Pathfinder
+		{
+		public:
+			JPSPathfinder();
+			virtual ~JPSPathfinder();
+
+			virtual PathfinderGoal* GetGoal() const { return _Goal; }
+			virtual PathfinderMap* GetMap() const { return _Map; }
+
+			virtual PathfinderNodeID GetSourceNode() const { return _SourceNode; }
+			virtual void SetSourceNode(PathfinderNodeID value);
+
+			virtual PathfinderNodeID GetDestinationNode() const { return _DestinationNode; }
+			virtual void SetDestinationNode(PathfinderNodeID value);
+
+			/** Gets the last jump point of the path, its parents are the previous jump points. */
+			virtual PathfinderNode* GetCurrentNode() const { return _CurrentNode; }
+
+			void Initialize(PathfinderGoal* goal, GridPathfinderMap* map);
+
+			virtual void Run();
+
+			/**
+				Gets the cells of the path found by the last search, from the source to the destination.
+				The cells between the jump points are added.
+				@return false if no path was found.
+			*/
+			bool GetPath(BaseArray<PathfinderNodeID>& path) const;
+
+			/** Gets the number of jump points expanded by the last search. */
+			int32 GetExpandedNodeCount() const { return _ExpandedNodeCount; }
+
+		protected:
+			/** Gets the (dx, dy) pairs of the directions to follow from a node, pruned with the direction from its parent. */
+			int32 GetDirections(AStarPathfinderNode* node, int32* directions);
+
+			/** Follows a direction from a cell and returns the first jump point, or PathfinderNodeID_Invalid. */
+			PathfinderNodeID Jump(int32 x, int32 y, int32 dx, int32 dy);
+
+		protected:
+			PathfinderGoal* _Goal;
+			GridPathfinderMap* _Map;
+			PooledAStarPathfinderStorage<AStarPathfinderNode> _Storage;
+
+			AStarPathfinderNode* _CurrentNode;
+			PathfinderNodeID _SourceNode;
+			PathfinderNodeID _DestinationNode;
+			int32 _DestinationX;
+			int32 _DestinationY;
+			int32 _ExpandedNodeCount;
+		};
+	}
+}
+
+#endif
@@ -0,0 +1,604 @@
+/*=============================================================================
+PathRequestQueue.cpp
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+#include "PathRequestQueue.h"
+
+namespace SonataEngine
+{
+	namespace AI
+	{
+		/// The handles store the index of the request in the low bits and its generation in the high bits.
+		static const int32 RequestIndexBits = 20;
+		static const int32 RequestIndexMask = (1 << RequestIndexBits) - 1;
+		static const int32 RequestGenerationMask = 0x7FF;
+
+		/// Number of nodes expanded between two checks of the time.
+		static const int32 StepIterationCount = 32;
+
+		PathRequestQueue::PathRequestQueue() :
+			_Map(NULL),
+			_Mode(Mode_TimeSliced),
+			_TimeBudget(1000),
+			_CacheSize(256),
+			_PendingCount(0),
+			_BatchCursor(0),
+			_CacheHead(0),
+			_Job(NULL),
+			_CacheHitCount(0),
+			_CoalescedCount(0)
+		{
+		}
+
+		PathRequestQueue::~PathRequestQueue()
+		{
+			Destroy();
+		}
+
+		void PathRequestQueue::Initialize(AStarPathfinderMap* map, Mode mode, int32 searchCount)
+		{
+			Destroy();
+
+			_Map = map;
+			_Mode = mode;
+
+			if (searchCount < 0)
+			{
+				searchCount = 1;
+				if (mode == Mode_Threaded && JobScheduler::Instance()->IsCreated())
+					searchCount = JobScheduler::Instance()->GetThreadCount();
+			}
+			searchCount = Math::Max(searchCount, 1);
+
+			for (int32 i = 0; i < searchCount; ++i)
+			{
+				Search* search = new Search();
+				search->_Queue = this;
+				search->_Storage = CreateStorage();
+				search->_Goal = CreateGoal();
+				search->_Pathfinder.Initialize(search->_Storage, search->_Goal, _Map);
+				search->_Result = -1;
+				_Searches.Add(search);
+			}
+		}
+
+		void PathRequestQueue::Destroy()
+		{
+			Wait();
+
+			for (int32 i = 0; i < _Searches.Count(); ++i)
+			{
+				SE_DELETE(_Searches[i]->_Storage);
+				SE_DELETE(_Searches[i]->_Goal);
+				delete _Searches[i];
+			}
+			_Searches.Clear();
+
+			_Requests.Clear();
+			_FreeRequests.Clear();
+			_Results.Clear();
+			_FreeResults.Clear();
+			_SharedResults.Clear();
+			_PendingResults.Clear();
+			_PendingCount = 0;
+			_Batch.Clear();
+			_BatchCursor = 0;
+			_CachedResults.Clear();
+			_CacheHead = 0;
+			_Map = NULL;
+		}
+
+		void PathRequestQueue::SetCacheSize(int32 value)
+		{
+			_CacheSize = Math::Max(value, 0);
+
+			while (GetCachedPathCount() > _CacheSize)
+			{
+				int32 result = _CachedResults[_CacheHead++];
+				_Results[result]._IsCached = false;
+				Unshare(result);
+			}
+		}
+
+		bool PathRequestQueue::IsThreaded() const
+		{
+			if (_Mode != Mode_Threaded)
+				return false;
+
+			JobScheduler* scheduler = JobScheduler::Instance();
+			return (scheduler->IsCreated() && scheduler->GetThreadIndex() >= 0);
+		}
+
+		PathRequestHandle PathRequestQueue::Request(PathfinderNodeID source, PathfinderNodeID destination, int32 type)
+		{
+			PathKey key;
+			key._Source = source;
+			key._Destination = destination;
+			key._Type = type;
+
+			int32 result;
+			int32* shared = _SharedResults.Find(key);
+			if (shared != NULL)
+			{
+				result = *shared;
+				if (_Results[result]._Status == RequestStatus_Pending)
+					++_CoalescedCount;
+				else
+					++_CacheHitCount;
+			}
+			else
+			{
+				result = AllocateResult(key);
+				_SharedResults.Add(key, result);
+				_Results[result]._IsShared = true;
+
+				_PendingResults.Add(result);
+				++_PendingCount;
+			}
+			++_Results[result]._ReferenceCount;
+
+			int32 index;
+			if (!_FreeRequests.IsEmpty())
+			{
+				index = _FreeRequests[_FreeRequests.Count() - 1];
+				_FreeRequests.RemoveAt(_FreeRequests.Count() - 1);
+			}
+			else
+			{
+				SE_ASSERT(_Requests.Count() <= RequestIndexMask);
+				index = _Requests.Count();
+				RequestEntry& request = _Requests.EmplaceBack();
+				request._Generation = 0;
+			}
+
+			RequestEntry& request = _Requests[index];
+			request._Result = result;
+			return (index | (request._Generation << RequestIndexBits));
+		}
+
+		PathRequestQueue::RequestStatus PathRequestQueue::GetStatus(PathRequestHandle handle) const
+		{
+			int32 index = handle & RequestIndexMask;
+			if (handle < 0 || index >= _Requests.Count())
+				return RequestStatus_Invalid;
+
+			const RequestEntry& request = _Requests[index];
+			if (request._Result < 0 || request._Generation != (handle >> RequestIndexBits))
+				return RequestStatus_Invalid;
+
+			return _Results[request._Result]._Status;
+		}
+
+		bool PathRequestQueue::GetPath(PathRequestHandle handle, BaseArray<PathfinderNodeID>& path) const
+		{
+			path.Clear();
+
+			if (GetStatus(handle) != RequestStatus_Succeeded)
+				return false;
+
+			path = _Results[_Requests[handle & RequestIndexMask]._Result]._Path;
+			return true;
+		}
+
+		void PathRequestQueue::Release(PathRequestHandle handle)
+		{
+			if (GetStatus(handle) == RequestStatus_Invalid)
+				return;
+
+			int32 index = handle & RequestIndexMask;
+			RequestEntry& request = _Requests[index];
+			int32 result = request._Result;
+			request._Result = -1;
+			request._Generation = (request._Generation + 1) & RequestGenerationMask;
+			_FreeRequests.Add(index);
+
+			PathResult& pathResult = _Results[result];
+			--pathResult._ReferenceCount;
+
+			if (pathResult._ReferenceCount == 0 && pathResult._Status == RequestStatus_Pending)
+			{
+				// Nobody waits for the search anymore, it is dropped if it isn't started yet
+				Unshare(result);
+			}
+			else
+			{
+				ReleaseResult(result);
+			}
+		}
+
+		int32 PathRequestQueue::AllocateResult(const PathKey& key)
+		{
+			int32 result;
+			if (!_FreeResults.IsEmpty())
+			{
+				result = _FreeResults[_FreeResults.Count() - 1];
+				_FreeResults.RemoveAt(_FreeResults.Count() - 1);
+			}
+			else
+			{
+				result = _Results.Count();
+				_Results.EmplaceBack();
+			}
+
+			PathResult& pathResult = _Results[result];
+			pathResult._Key = key;
+			pathResult._Status = RequestStatus_Pending;
+			pathResult._Path.Clear();
+			pathResult._ReferenceCount = 0;
+			pathResult._IsShared = false;
+			pathResult._IsCached = false;
+			pathResult._IsSearching = false;
+			return result;
+		}
+
+		void PathRequestQueue::ReleaseResult(int32 result)
+		{
+			PathResult& pathResult = _Results[result];
+
+			// The pending results stay in the pending list until PrepareBatch drops them
+			if (pathResult._ReferenceCount > 0 || pathResult._IsShared || pathResult._IsSearching ||
+				pathResult._Status == RequestStatus_Pending)
+			{
+				return;
+			}
+
+			pathResult._Status = RequestStatus_Invalid;
+			pathResult._Path.Clear();
+			_FreeResults.Add(result);
+		}
+
+		void PathRequestQueue::Unshare(int32 result)
+		{
+			PathResult& pathResult = _Results[result];
+			if (pathResult._IsShared)
+			{
+				_SharedResults.Remove(pathResult._Key);
+				pathResult._IsShared = false;
+			}
+
+			ReleaseResult(result);
+		}
+
+		void PathRequestQueue::AddToCache(int32 result)
+		{
+			if (_CacheSize == 0)
+			{
+				Unshare(result);
+				return;
+			}
+
+			_Results[result]._IsCached = true;
+			_CachedResults.Add(result);
+
+			// Evict the oldest paths
+			while (GetCachedPathCount() > _CacheSize)
+			{
+				int32 oldest = _CachedResults[_CacheHead++];
+				_Results[oldest]._IsCached = false;
+				Unshare(oldest);
+			}
+
+			if (_CacheHead > _CacheSize)
+			{
+				int32 count = GetCachedPathCount();
+				for (int32 i = 0; i < count; ++i)
+					_CachedResults[i] = _CachedResults[_CacheHead + i];
+				_CachedResults.Resize(count);
+				_CacheHead = 0;
+			}
+		}
+
+		void PathRequestQueue::PrepareBatch()
+		{
+			int32 i;
+			int32 count = 0;
+
+			// Keep the results not taken by the searches
+			for (i = Math::Min((int32)_BatchCursor, _Batch.Count()); i < _Batch.Count(); ++i)
+				_Batch[count++] = _Batch[i];
+			_Batch.Resize(count);
+
+			for (i = 0; i < _PendingResults.Count(); ++i)
+			{
+				BatchItem& item = _Batch.EmplaceBack();
+				item._Result = _PendingResults[i];
+				item._Key = _Results[item._Result]._Key;
+				_Results[item._Result]._IsSearching = true;
+			}
+			_PendingResults.Clear();
+
+			// Drop the cancelled results
+			count = 0;
+			for (i = 0; i < _Batch.Count(); ++i)
+			{
+				PathResult& pathResult = _Results[_Batch[i]._Result];
+				if (pathResult._IsShared)
+				{
+					_Batch[count++] = _Batch[i];
+				}
+				else
+				{
+					--_PendingCount;
+					pathResult._IsSearching = false;
+					pathResult._Status = RequestStatus_Invalid;
+					ReleaseResult(_Batch[i]._Result);
+				}
+			}
+			_Batch.Resize(count);
+
+			_BatchCursor = 0;
+		}
+
+		void PathRequestQueue::CollectSearches()
+		{
+			for (int32 i = 0; i < _Searches.Count(); ++i)
+			{
+				Search* search = _Searches[i];
+				for (int32 j = 0; j < search->_Finished.Count(); ++j)
+				{
+					const FinishedSearch& finished = search->_Finished[j];
+					PathResult& pathResult = _Results[finished._Result];
+					pathResult._IsSearching = false;
+					--_PendingCount;
+
+					if (!pathResult._IsShared)
+					{
+						// Cancelled while it was running
+						pathResult._Status = RequestStatus_Invalid;
+						ReleaseResult(finished._Result);
+						continue;
+					}
+
+					if (finished._HasPath)
+					{
+						pathResult._Path.Resize(finished._Count);
+						for (int32 k = 0; k < finished._Count; ++k)
+							pathResult._Path[k] = search->_FinishedNodes[finished._Start + k];
+						pathResult._Status = RequestStatus_Succeeded;
+					}
+					else
+					{
+						pathResult._Path.Clear();
+						pathResult._Status = RequestStatus_Failed;
+					}
+
+					AddToCache(finished._Result);
+				}
+
+				search->_Finished.Clear();
+				search->_FinishedNodes.Clear();
+			}
+		}
+
+		void PathRequestQueue::RestartSearches(PathfinderNodeID node)
+		{
+			for (int32 i = 0; i < _Searches.Count(); ++i)
+			{
+				Search* search = _Searches[i];
+				if (search->_Result < 0)
+					continue;
+
+				// The searches that didn't reach the node are not affected
+				if (node != PathfinderNodeID_Invalid &&
+					search->_Storage->FindInOpenList(node) == NULL &&
+					search->_Storage->FindInClosedList(node) == NULL)
+				{
+					continue;
+				}
+
+				StartSearch(search, search->_Result, _Results[search->_Result]._Key);
+			}
+		}
+
+		void PathRequestQueue::StartSearch(Search* search, int32 result, const PathKey& key)
+		{
+			search->_Result = result;
+
+			InitializeGoal(search->_Goal, key._Type);
+			search->_Pathfinder.SetSourceNode(key._Source);
+			search->_Pathfinder.SetDestinationNode(key._Destination);
+			search->_Pathfinder.Start();
+		}
+
+		bool PathRequestQueue::RunSearch(Search* search, const Timer& timer, real64 budget)
+		{
+			while (!search->_Pathfinder.Step(StepIterationCount))
+			{
+				if (timer.Elapsed() >= budget)
+					return false;
+			}
+
+			return true;
+		}
+
+		void PathRequestQueue::AdvanceSearch(Search* search, const Timer& timer, real64 budget)
+		{
+			PathRequestQueue* queue = search->_Queue;
+
+			while (true)
+			{
+				if (search->_Result < 0)
+				{
+					// Take the next result of the batch
+					int32 index = Interlocked::Increment(&queue->_BatchCursor) - 1;
+					if (index >= queue->_Batch.Count())
+						return;
+
+					const BatchItem& item = queue->_Batch[index];
+					queue->StartSearch(search, item._Result, item._Key);
+				}
+
+				if (!RunSearch(search, timer, budget))
+					return;
+
+				// The nodes are linked from the destination to the source
+				FinishedSearch& finished = search->_Finished.EmplaceBack();
+				finished._Result = search->_Result;
+				finished._HasPath = (search->_Pathfinder.GetStatus() == Pathfinder::Status_Succeeded);
+				finished._Start = search->_FinishedNodes.Count();
+				finished._Count = 0;
+
+				if (finished._HasPath)
+				{
+					PathfinderNode* node;
+					for (node = search->_Pathfinder.GetCurrentNode(); node != NULL; node = node->_Parent)
+						++finished._Count;
+
+					search->_FinishedNodes.Resize(finished._Start + finished._Count);
+					int32 index = finished._Start + finished._Count;
+					for (node = search->_Pathfinder.GetCurrentNode(); node != NULL; node = node->_Parent)
+						search->_FinishedNodes[--index] = node->_NodeID;
+				}
+
+				search->_Result = -1;
+
+				if (timer.Elapsed() >= budget)
+					return;
+			}
+		}
+
+		void PathRequestQueue::SearchJob(Job* job, void* data)
+		{
+			Search* search = (Search*)data;
+
+			Timer timer;
+			timer.Start();
+			AdvanceSearch(search, timer, search->_Queue->_TimeBudget * 1.0e-6);
+		}
+
+		void PathRequestQueue::Update()
+		{
+			int32 i;
+
+			// Collect the searches run since the previous update
+			Wait();
+			CollectSearches();
+
+			PrepareBatch();
+
+			if (IsThreaded())
+			{
+				JobScheduler* scheduler = JobScheduler::Instance();
+				if (_Batch.IsEmpty())
+				{
+					for (i = 0; i < _Searches.Count() && _Searches[i]->_Result < 0; ++i)
+					{
+					}
+
+					if (i == _Searches.Count())
+						return;
+				}
+
+				Job* job = scheduler->CreateJob(NULL);
+				for (i = 0; i < _Searches.Count(); ++i)
+					scheduler->Run(scheduler->CreateChildJob(job, SearchJob, _Searches[i]));
+				scheduler->Run(job);
+				_Job = job;
+			}
+			else
+			{
+				Timer timer;
+				timer.Start();
+				real64 budget = _TimeBudget * 1.0e-6;
+
+				for (i = 0; i < _Searches.Count(); ++i)
+				{
+					AdvanceSearch(_Searches[i], timer, budget);
+					if (timer.Elapsed() >= budget)
+						break;
+				}
+
+				CollectSearches();
+			}
+		}
+
+		void PathRequestQueue::Wait()
+		{
+			if (_Job != NULL)
+			{
+				JobScheduler::Instance()->Wait(_Job);
+				_Job = NULL;
+			}
+		}
+
+		void PathRequestQueue::InvalidateNode(PathfinderNodeID node)
+		{
+			int32 i, j;
+
+			Wait();
+			CollectSearches();
+
+			// Invalidate the paths through the node, and the failed searches that could now succeed
+			for (i = 0; i < _Results.Count(); ++i)
+			{
+				PathResult& pathResult = _Results[i];
+				if (pathResult._Status == RequestStatus_Failed)
+				{
+					pathResult._Status = RequestStatus_Invalidated;
+				}
+				else if (pathResult._Status == RequestStatus_Succeeded)
+				{
+					const PathfinderNodeID* path = pathResult._Path.Data();
+					int32 count = pathResult._Path.Count();
+					for (j = 0; j < count; ++j)
+					{
+						if (path[j] == node)
+						{
+							pathResult._Status = RequestStatus_Invalidated;
+							break;
+						}
+					}
+				}
+			}
+
+			// Remove the invalidated paths from the cache
+			int32 count = 0;
+			for (i = _CacheHead; i < _CachedResults.Count(); ++i)
+			{
+				int32 result = _CachedResults[i];
+				if (_Results[result]._Status == RequestStatus_Invalidated)
+				{
+					_Results[result]._IsCached = false;
+					Unshare(result);
+				}
+				else
+				{
+					_CachedResults[count++] = result;
+				}
+			}
+			_CachedResults.Resize(count);
+			_CacheHead = 0;
+
+			// The running searches may have seen the old node
+			RestartSearches(node);
+		}
+
+		void PathRequestQueue::InvalidateAll()
+		{
+			int32 i;
+
+			Wait();
+			CollectSearches();
+
+			for (i = 0; i < _Results.Count(); ++i)
+			{
+				PathResult& pathResult = _Results[i];
+				if (pathResult._Status == RequestStatus_Succeeded || pathResult._Status == RequestStatus_Failed)
+					pathResult._Status = RequestStatus_Invalidated;
+			}
+
+			for (i = _CacheHead; i < _CachedResults.Count(); ++i)
+			{
+				int32 result = _CachedResults[i];
+				_Results[result]._IsCached = false;
+				Unshare(result);
+			}
+			_CachedResults.Clear();
+			_CacheHead = 0;
+
+			RestartSearches(PathfinderNodeID_Invalid);
+		}
+	}
+}
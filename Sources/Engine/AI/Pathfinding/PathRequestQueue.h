@@ -0,0 +1,328 @@
+/*=============================================================================
+PathRequestQueue.h
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+#ifndef _SE_AI_PATHREQUESTQUEUE_H_
+#define _SE_AI_PATHREQUESTQUEUE_H_
+
+#include "AI/Common.h"
+#include "AI/Pathfinding/Pathfinder.h"
+#include "AI/Pathfinding/AStarPathfinder.h"
+
+namespace SonataEngine
+{
+	namespace AI
+	{
+		/// Handle of a path request.
+		typedef int32 PathRequestHandle;
+		const PathRequestHandle PathRequestHandle_Invalid = -1;
+
+		/**
+			@brief Path request service.
+
+			The agents submit path requests and get a handle back, the searches are
+			advanced by Update and the agents poll their request until it is
+			finished. A search never runs to completion inside the caller:
+			- Mode_TimeSliced advances the searches on the calling thread, in the
+			order of the requests, until the time budget of the update is spent.
+			- Mode_Threaded advances the searches on the JobScheduler threads while
+			the frame goes on. Each search runs for at most the time budget per
+			update, and the results are collected at the next update.
+
+			The searches take the pending requests from a batch prepared by each
+			update, so a search that finishes a path goes on with the next request.
+
+			Each concurrent search has its own storage and goal, created by the
+			derived class. The map is shared by the searches and is only read while
+			they run.
+
+			The requests with the same source, destination and type share one
+			search, and the paths found are kept in a cache, so the following
+			identical requests are finished at once. When a node of the map
+			changes, InvalidateNode drops the cached paths through the node and
+			restarts the running searches that reached it. The requests whose path
+			went through the node get the RequestStatus_Invalidated status. The
+			other paths are kept, even if the change opened a shorter way.
+
+			The methods must be called from the thread that created the
+			JobScheduler. Derived classes must call Destroy in their destructor.
+		*/
+		class SE_AI_EXPORT PathRequestQueue
+		{
+		public:
+			enum Mode
+			{
+				/// The searches run on the thread calling Update.
+				Mode_TimeSliced,
+
+				/// The searches run on the JobScheduler threads.
+				Mode_Threaded
+			};
+
+			enum RequestStatus
+			{
+				/// The handle is not a valid request.
+				RequestStatus_Invalid,
+
+				/// The search is pending or running.
+				RequestStatus_Pending,
+
+				/// A path was found.
+				RequestStatus_Succeeded,
+
+				/// No path exists.
+				RequestStatus_Failed,
+
+				/// The map changed along the path, a new request must be submitted.
+				RequestStatus_Invalidated
+			};
+
+		public:
+			PathRequestQueue();
+			virtual ~PathRequestQueue();
+
+			/**
+				Initializes the queue.
+				@param map The map shared by the searches.
+				@param mode How the searches are run. Mode_Threaded falls back to
+					Mode_TimeSliced when the JobScheduler is not created.
+				@param searchCount The number of concurrent searches.
+					Specify -1 to use one search per JobScheduler thread.
+			*/
+			void Initialize(AStarPathfinderMap* map, Mode mode, int32 searchCount = -1);
+
+			/** Waits for the running searches and destroys the searches, the requests and the cache. */
+			void Destroy();
+
+			/** @name Properties. */
+			//@{
+			AStarPathfinderMap* GetMap() const { return _Map; }
+			Mode GetMode() const { return _Mode; }
+			int32 GetSearchCount() const { return _Searches.Count(); }
+
+			/**
+				Gets or sets the time budget in microseconds.
+				In Mode_TimeSliced, it is the time spent by each update in the
+				searches. In Mode_Threaded, it is the time each search runs per update.
+			*/
+			int32 GetTimeBudget() const { return _TimeBudget; }
+			void SetTimeBudget(int32 value) { _TimeBudget = value; }
+
+			/** Gets or sets the maximum number of cached paths, 0 disables the cache. */
+			int32 GetCacheSize() const { return _CacheSize; }
+			void SetCacheSize(int32 value);
+			//@}
+
+			/** @name Requests. */
+			//@{
+			/**
+				Submits a path request.
+				@param source The source node.
+				@param destination The destination node.
+				@param type The type of the request, passed to InitializeGoal.
+					Only the requests of the same type share their paths.
+				@return The handle of the request, to release with Release.
+			*/
+			PathRequestHandle Request(PathfinderNodeID source, PathfinderNodeID destination, int32 type = 0);
+
+			/** Gets the status of a request. */
+			RequestStatus GetStatus(PathRequestHandle handle) const;
+
+			/**
+				Gets the nodes of the path of a request, from the source to the destination.
+				@return false if the request didn't succeed.
+			*/
+			bool GetPath(PathRequestHandle handle, BaseArray<PathfinderNodeID>& path) const;
+
+			/** Releases a request, a pending search is cancelled if no other request waits for it. */
+			void Release(PathRequestHandle handle);
+			//@}
+
+			/**
+				Advances the searches and finishes the requests.
+				Must be called once per frame.
+			*/
+			void Update();
+
+			/** Waits for the searches running on the JobScheduler threads. */
+			void Wait();
+
+			/**
+				Notifies the queue that a node of the map is about to change.
+				Waits for the running searches, which must not see the change, then
+				restarts the ones that reached the node. The map can be modified when
+				the method returns.
+			*/
+			void InvalidateNode(PathfinderNodeID node);
+
+			/** Notifies the queue that the whole map is about to change. */
+			void InvalidateAll();
+
+			/** @name Statistics. */
+			//@{
+			/** Gets the number of searches waiting or running. */
+			int32 GetPendingCount() const { return _PendingCount; }
+
+			int32 GetCachedPathCount() const { return _CachedResults.Count() - _CacheHead; }
+
+			/** Gets the number of requests finished from the cache. */
+			int32 GetCacheHitCount() const { return _CacheHitCount; }
+
+			/** Gets the number of requests that joined the search of another request. */
+			int32 GetCoalescedCount() const { return _CoalescedCount; }
+			//@}
+
+		protected:
+			/** Creates the storage of a search. */
+			virtual AStarPathfinderStorage* CreateStorage() = 0;
+
+			/** Creates the goal of a search. */
+			virtual AStarPathfinderGoal* CreateGoal() = 0;
+
+			/**
+				Prepares the goal of a search for a request type.
+				In Mode_Threaded, it is called from the JobScheduler threads.
+			*/
+			virtual void InitializeGoal(AStarPathfinderGoal* goal, int32 type) {}
+
+		protected:
+			struct PathKey
+			{
+				PathfinderNodeID _Source;
+				PathfinderNodeID _Destination;
+				int32 _Type;
+
+				bool operator==(const PathKey& value) const
+				{
+					return (_Source == value._Source && _Destination == value._Destination && _Type == value._Type);
+				}
+			};
+
+			/// Path shared by the requests with the same key.
+			struct PathResult
+			{
+				PathKey _Key;
+				RequestStatus _Status;
+				BaseArray<PathfinderNodeID> _Path;
+
+				/// Number of requests using the result.
+				int32 _ReferenceCount;
+
+				/// Whether the result is in the table of the keys, where the requests find it.
+				bool _IsShared;
+
+				bool _IsCached;
+
+				/// Whether the result is in the batch of the searches.
+				bool _IsSearching;
+			};
+
+			struct RequestEntry
+			{
+				/// Index of the result, or -1 for a free request.
+				int32 _Result;
+				int32 _Generation;
+			};
+
+			/// Result to search, copied for the searches running during the frame.
+			struct BatchItem
+			{
+				int32 _Result;
+				PathKey _Key;
+			};
+
+			/// Search finished by a Search, collected by the next update.
+			struct FinishedSearch
+			{
+				int32 _Result;
+				bool _HasPath;
+				int32 _Start;
+				int32 _Count;
+			};
+
+			/// Concurrent search with its own pathfinder.
+			struct Search
+			{
+				PathRequestQueue* _Queue;
+				AStarPathfinder _Pathfinder;
+				AStarPathfinderStorage* _Storage;
+				AStarPathfinderGoal* _Goal;
+
+				/// Index of the result being searched, or -1.
+				int32 _Result;
+
+				/// Searches finished since the last update, their nodes are in _FinishedNodes.
+				BaseArray<FinishedSearch> _Finished;
+				BaseArray<PathfinderNodeID> _FinishedNodes;
+			};
+
+			bool IsThreaded() const;
+
+			int32 AllocateResult(const PathKey& key);
+			void ReleaseResult(int32 result);
+			void Unshare(int32 result);
+			void AddToCache(int32 result);
+
+			/** Moves the pending results to the batch, after the results not taken by the searches yet. */
+			void PrepareBatch();
+
+			/** Stores the paths of the finished searches in their results. */
+			void CollectSearches();
+
+			/** Restarts the running searches that reached a node, or all of them for PathfinderNodeID_Invalid. */
+			void RestartSearches(PathfinderNodeID node);
+
+			void StartSearch(Search* search, int32 result, const PathKey& key);
+
+			/**
+				Advances a search until it is finished or the time is spent.
+				@return true if the search is finished.
+			*/
+			static bool RunSearch(Search* search, const Timer& timer, real64 budget);
+
+			/** Advances a search and starts the next results of the batch until the time is spent. */
+			static void AdvanceSearch(Search* search, const Timer& timer, real64 budget);
+
+			static void SearchJob(Job* job, void* data);
+
+		protected:
+			AStarPathfinderMap* _Map;
+			Mode _Mode;
+			int32 _TimeBudget;
+			int32 _CacheSize;
+
+			BaseArray<RequestEntry> _Requests;
+			BaseArray<int32> _FreeRequests;
+
+			BaseArray<PathResult> _Results;
+			BaseArray<int32> _FreeResults;
+			Hashtable<PathKey, int32> _SharedResults;
+
+			/// Results requested since the last update.
+			BaseArray<int32> _PendingResults;
+			int32 _PendingCount;
+
+			/// Results taken by the searches from _BatchCursor, only read during the frame.
+			BaseArray<BatchItem> _Batch;
+			volatile int32 _BatchCursor;
+
+			/// Cached results from the oldest one, from _CacheHead.
+			BaseArray<int32> _CachedResults;
+			int32 _CacheHead;
+
+			BaseArray<Search*> _Searches;
+			Job* _Job;
+
+			int32 _CacheHitCount;
+			int32 _CoalescedCount;
+
+		private:
+			PathRequestQueue(const PathRequestQueue&);
+			PathRequestQueue& operator=(const PathRequestQueue&);
+		};
+	}
+}
+
+#endif
@@ -41,6 +41,8 @@ namespace SonataEngine
 		class SE_AI_EXPORT PathfinderGoal
 		{
 		public:
+			virtual ~PathfinderGoal() {}
+
 			virtual void SetDestinationNode(PathfinderNodeID node) = 0;
 			virtual bool IsNodeValid(PathfinderNodeID node) { return true; }
 		};
@@ -24,6 +24,12 @@ namespace SonataEngine
 
 			virtual void Execute() const = 0;
 
+			/**
+				Gets the symbol set by the action, used by CompiledFSM.
+				@return false if the action doesn't only set a symbol to a value.
+			*/
+			virtual bool GetSymbolAssignment(String& symbol, bool& value) const { return false; }
+
 		protected:
 			Action();
 		};
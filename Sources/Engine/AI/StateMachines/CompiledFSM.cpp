@@ -0,0 +1,231 @@
+/*=============================================================================
+CompiledFSM.cpp
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+#include "CompiledFSM.h"
+
+namespace SonataEngine
+{
+	namespace AI
+	{
+		const int32 CompiledFSM::NullState = 0;
+
+		CompiledFSM::CompiledFSM() :
+			RefObject(),
+			_Machine(NULL),
+			_StartState(NullState),
+			_HasExternalObjects(false)
+		{
+		}
+
+		CompiledFSM::~CompiledFSM()
+		{
+		}
+
+		int32 CompiledFSM::GetStateIndex(State* state) const
+		{
+			if (state == NULL)
+				return NullState;
+
+			const int32* index = _StateIndices.Find(state);
+			return (index != NULL ? *index : -1);
+		}
+
+		int32 CompiledFSM::GetSymbolIndex(const String& name) const
+		{
+			const int32* index = _SymbolIndices.Find(name);
+			return (index != NULL ? *index : -1);
+		}
+
+		int32 CompiledFSM::AddState(State* state)
+		{
+			if (state == NULL)
+				return NullState;
+
+			const int32* index = _StateIndices.Find(state);
+			if (index != NULL)
+				return *index;
+
+			_States.Add(CompiledState(state));
+			_StateIndices.Add(state, _States.Count() - 1);
+			return _States.Count() - 1;
+		}
+
+		int32 CompiledFSM::AddSymbol(const String& name)
+		{
+			const int32* index = _SymbolIndices.Find(name);
+			if (index != NULL)
+				return *index;
+
+			_SymbolNames.Add(name);
+			_SymbolIndices.Add(name, _SymbolNames.Count() - 1);
+			return _SymbolNames.Count() - 1;
+		}
+
+		void CompiledFSM::CompileActions(const State::ActionList& actions, int32& start, int32& count)
+		{
+			start = _Actions.Count();
+			count = actions.Count();
+
+			for (int32 i = 0; i < actions.Count(); i++)
+			{
+				CompiledAction compiledAction;
+				String symbol;
+				bool value;
+				if (actions[i]->GetSymbolAssignment(symbol, value))
+				{
+					int32 index = AddSymbol(symbol);
+					compiledAction._Word = index >> 5;
+					compiledAction._Mask = 1u << (index & 31);
+					compiledAction._Value = value;
+					compiledAction._Action = NULL;
+				}
+				else
+				{
+					compiledAction._Word = 0;
+					compiledAction._Mask = 0;
+					compiledAction._Value = false;
+					compiledAction._Action = actions[i];
+					_HasExternalObjects = true;
+				}
+				_Actions.Add(compiledAction);
+			}
+		}
+
+		void CompiledFSM::Compile(FSM* machine)
+		{
+			SE_ASSERT(machine != NULL);
+
+			_Machine = machine;
+			_HasExternalObjects = false;
+			_States.Clear();
+			_Transitions.Clear();
+			_Tests.Clear();
+			_Conditions.Clear();
+			_Actions.Clear();
+			_StateIndices.Clear();
+			_SymbolNames.Clear();
+			_SymbolIndices.Clear();
+			_InitialSymbols.Clear();
+
+			// The null state
+			_States.Add(CompiledState());
+
+			int32 i;
+			for (i = 0; i < machine->States.Count(); i++)
+			{
+				AddState(machine->States[i]);
+			}
+			_StartState = AddState(machine->GetStartState());
+
+			BaseArray<Symbol> symbols;
+			if (machine->GetSymbolTable() != NULL)
+			{
+				symbols = machine->GetSymbolTable()->GetSymbols();
+				for (i = 0; i < symbols.Count(); i++)
+				{
+					AddSymbol(symbols[i].Name);
+				}
+			}
+
+			// Compile the transitions in the order of the machine, then sort them by start state
+			BaseArray<CompiledTransition> transitions;
+			BaseArray<int32> startStates;
+			for (i = 0; i < machine->Transitions.Count(); i++)
+			{
+				Transition* transition = machine->Transitions[i];
+
+				CompiledTransition compiledTransition;
+				compiledTransition._EndState = AddState(transition->GetEndState());
+				compiledTransition._TestStart = _Tests.Count();
+				compiledTransition._ConditionStart = _Conditions.Count();
+
+				for (int32 j = 0; j < transition->Conditions.Count(); j++)
+				{
+					Condition* condition = transition->Conditions[j];
+					String symbol;
+					bool value;
+					if (!condition->GetSymbolTest(symbol, value))
+					{
+						_Conditions.Add(condition);
+						_HasExternalObjects = true;
+						continue;
+					}
+
+					int32 index = AddSymbol(symbol);
+					int32 word = index >> 5;
+					uint32 mask = 1u << (index & 31);
+
+					int32 test = compiledTransition._TestStart;
+					while (test < _Tests.Count() && _Tests[test]._Word != word)
+						test++;
+
+					if (test == _Tests.Count())
+					{
+						SymbolTest symbolTest;
+						symbolTest._Word = word;
+						symbolTest._TrueMask = 0;
+						symbolTest._FalseMask = 0;
+						_Tests.Add(symbolTest);
+					}
+
+					if (value)
+						_Tests[test]._TrueMask |= mask;
+					else
+						_Tests[test]._FalseMask |= mask;
+				}
+
+				compiledTransition._TestCount = _Tests.Count() - compiledTransition._TestStart;
+				compiledTransition._ConditionCount = _Conditions.Count() - compiledTransition._ConditionStart;
+
+				transitions.Add(compiledTransition);
+				startStates.Add(AddState(transition->GetStartState()));
+			}
+
+			for (i = 0; i < transitions.Count(); i++)
+			{
+				_States[startStates[i]]._TransitionCount++;
+			}
+
+			int32 start = 0;
+			for (i = 0; i < _States.Count(); i++)
+			{
+				_States[i]._TransitionStart = start;
+				start += _States[i]._TransitionCount;
+				_States[i]._TransitionCount = 0;
+			}
+
+			_Transitions.Resize(transitions.Count());
+			for (i = 0; i < transitions.Count(); i++)
+			{
+				CompiledState& state = _States[startStates[i]];
+				_Transitions[state._TransitionStart + state._TransitionCount] = transitions[i];
+				state._TransitionCount++;
+			}
+
+			for (i = 1; i < _States.Count(); i++)
+			{
+				CompiledState& state = _States[i];
+				CompileActions(state._State->EnterActions, state._EnterStart, state._EnterCount);
+				CompileActions(state._State->ExitActions, state._ExitStart, state._ExitCount);
+			}
+
+			_InitialSymbols.Resize((_SymbolNames.Count() + 31) >> 5);
+			for (i = 0; i < _InitialSymbols.Count(); i++)
+			{
+				_InitialSymbols[i] = 0;
+			}
+
+			for (i = 0; i < symbols.Count(); i++)
+			{
+				if (symbols[i].Value)
+				{
+					int32 index = GetSymbolIndex(symbols[i].Name);
+					_InitialSymbols[index >> 5] |= 1u << (index & 31);
+				}
+			}
+		}
+	}
+}
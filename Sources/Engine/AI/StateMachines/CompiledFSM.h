@@ -0,0 +1,223 @@
+/*=============================================================================
+CompiledFSM.h
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+#ifndef _SE_AI_COMPILEDFSM_H_
+#define _SE_AI_COMPILEDFSM_H_
+
+#include "Core/Core.h"
+#include "AI/Common.h"
+#include "AI/StateMachines/FSM.h"
+
+namespace SonataEngine
+{
+	namespace AI
+	{
+		/** AI Compiled FSM.
+			Flat form of an FSM, shared by the agents of an FSMAgentBatch.
+
+			The states are numbered, 0 being the null state, and the transitions
+			are stored by start state in the order of FSM::Transitions. The symbols
+			of the symbol table and of the symbol conditions and actions are
+			numbered too, each agent keeping their values in a bitset.
+			A transition tests the bits of its symbol conditions with one mask per
+			word, the other conditions are checked after them.
+
+			The compiled machine keeps a reference on the FSM, which must not be
+			modified afterwards.
+		*/
+		class CompiledFSM : public RefObject
+		{
+		public:
+			/// Index of the null state.
+			static const int32 NullState;
+
+			/// Test of the symbols of a word, true if a bit of _TrueMask is set or a bit of _FalseMask is cleared.
+			struct SymbolTest
+			{
+				int32 _Word;
+				uint32 _TrueMask;
+				uint32 _FalseMask;
+			};
+
+			struct CompiledTransition
+			{
+				int32 _EndState;
+				int32 _TestStart;
+				int32 _TestCount;
+
+				/// Conditions that are not symbol conditions.
+				int32 _ConditionStart;
+				int32 _ConditionCount;
+			};
+
+			/// Action setting a symbol, or any other action when _Action is not NULL.
+			struct CompiledAction
+			{
+				int32 _Word;
+				uint32 _Mask;
+				bool _Value;
+				Action* _Action;
+			};
+
+			struct CompiledState
+			{
+				State* _State;
+				int32 _TransitionStart;
+				int32 _TransitionCount;
+				int32 _EnterStart;
+				int32 _EnterCount;
+				int32 _ExitStart;
+				int32 _ExitCount;
+
+				CompiledState(State* state = NULL) :
+					_State(state),
+					_TransitionStart(0),
+					_TransitionCount(0),
+					_EnterStart(0),
+					_EnterCount(0),
+					_ExitStart(0),
+					_ExitCount(0)
+				{
+				}
+			};
+
+		public:
+			CompiledFSM();
+			virtual ~CompiledFSM();
+
+			/** Compiles a machine, the previous compiled data is discarded. */
+			void Compile(FSM* machine);
+
+			FSM* GetMachine() const { return _Machine; }
+
+			/** @name States. */
+			//@{
+			int32 GetStateCount() const { return _States.Count(); }
+			int32 GetStartState() const { return _StartState; }
+
+			State* GetState(int32 index) const { return _States[index]._State; }
+
+			/** Gets the index of a state, or -1 if the state is not in the machine. */
+			int32 GetStateIndex(State* state) const;
+			//@}
+
+			/** @name Symbols. */
+			//@{
+			int32 GetSymbolCount() const { return _SymbolNames.Count(); }
+
+			/** Gets the number of 32-bit words of the symbols of an agent. */
+			int32 GetWordCount() const { return _InitialSymbols.Count(); }
+
+			const String& GetSymbolName(int32 index) const { return _SymbolNames[index]; }
+
+			/** Gets the index of a symbol, or -1 if the machine doesn't use the symbol. */
+			int32 GetSymbolIndex(const String& name) const;
+
+			/** Gets the symbol values of the symbol table at compile time. */
+			const uint32* GetInitialSymbols() const { return _InitialSymbols.Data(); }
+			//@}
+
+			/**
+				Gets whether the machine has conditions or actions that are not
+				symbol conditions or actions. They are shared by all the agents and
+				can't be run in parallel.
+			*/
+			bool HasExternalObjects() const { return _HasExternalObjects; }
+
+			/**
+				Updates the state of an agent like FSM::Update: the first transition
+				from the current state with a true condition is taken.
+				@return true if a transition was taken.
+			*/
+			bool Update(int32& state, uint32* symbols) const
+			{
+				const CompiledState& current = _States[state];
+				const CompiledTransition* transition = _Transitions.Data() + current._TransitionStart;
+				const CompiledTransition* end = transition + current._TransitionCount;
+				for (; transition != end; ++transition)
+				{
+					if (IsTransitionValid(*transition, symbols))
+					{
+						ChangeState(state, transition->_EndState, symbols);
+						return true;
+					}
+				}
+
+				return false;
+			}
+
+			/** Runs the exit actions of the current state and the enter actions of the new state. */
+			void ChangeState(int32& state, int32 value, uint32* symbols) const
+			{
+				const CompiledState& current = _States[state];
+				ExecuteActions(current._ExitStart, current._ExitCount, symbols);
+				state = value;
+				const CompiledState& next = _States[state];
+				ExecuteActions(next._EnterStart, next._EnterCount, symbols);
+			}
+
+		protected:
+			int32 AddState(State* state);
+			int32 AddSymbol(const String& name);
+			void CompileActions(const State::ActionList& actions, int32& start, int32& count);
+
+			bool IsTransitionValid(const CompiledTransition& transition, const uint32* symbols) const
+			{
+				const SymbolTest* test = _Tests.Data() + transition._TestStart;
+				const SymbolTest* end = test + transition._TestCount;
+				for (; test != end; ++test)
+				{
+					uint32 bits = symbols[test->_Word];
+					if (((bits & test->_TrueMask) | (~bits & test->_FalseMask)) != 0)
+						return true;
+				}
+
+				for (int32 i = 0; i < transition._ConditionCount; i++)
+				{
+					if (_Conditions[transition._ConditionStart + i]->Check())
+						return true;
+				}
+
+				return false;
+			}
+
+			void ExecuteActions(int32 start, int32 count, uint32* symbols) const
+			{
+				const CompiledAction* action = _Actions.Data() + start;
+				const CompiledAction* end = action + count;
+				for (; action != end; ++action)
+				{
+					if (action->_Action != NULL)
+						action->_Action->Execute();
+					else if (action->_Value)
+						symbols[action->_Word] |= action->_Mask;
+					else
+						symbols[action->_Word] &= ~action->_Mask;
+				}
+			}
+
+		protected:
+			FSMPtr _Machine;
+			int32 _StartState;
+			bool _HasExternalObjects;
+
+			BaseArray<CompiledState> _States;
+			BaseArray<CompiledTransition> _Transitions;
+			BaseArray<SymbolTest> _Tests;
+			BaseArray<Condition*> _Conditions;
+			BaseArray<CompiledAction> _Actions;
+			Hashtable<State*, int32> _StateIndices;
+
+			BaseArray<String> _SymbolNames;
+			Hashtable<String, int32> _SymbolIndices;
+			BaseArray<uint32> _InitialSymbols;
+		};
+
+		typedef SmartPtr<CompiledFSM> CompiledFSMPtr;
+	}
+}
+
+#endif
@@ -25,6 +25,12 @@ namespace SonataEngine
 
 			virtual bool Check() const = 0;
 
+			/**
+				Gets the symbol tested by the condition, used by CompiledFSM.
+				@return false if the condition doesn't only compare a symbol to a value.
+			*/
+			virtual bool GetSymbolTest(String& symbol, bool& value) const { return false; }
+
 		protected:
 			Condition();
 		};
@@ -0,0 +1,82 @@
+/*=============================================================================
+FSMAgentBatch.cpp
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+#include "FSMAgentBatch.h"
+
+namespace SonataEngine
+{
+	namespace AI
+	{
+		FSMAgentBatch::FSMAgentBatch() :
+			_Machine(NULL),
+			_WordCount(0)
+		{
+		}
+
+		FSMAgentBatch::~FSMAgentBatch()
+		{
+		}
+
+		void FSMAgentBatch::Initialize(CompiledFSM* machine, int32 agentCount)
+		{
+			SE_ASSERT(machine != NULL && agentCount >= 0);
+
+			_Machine = machine;
+			_WordCount = machine->GetWordCount();
+
+			_States.Resize(agentCount);
+			_Symbols.Resize(agentCount * _WordCount);
+
+			const uint32* symbols = machine->GetInitialSymbols();
+			for (int32 i = 0; i < agentCount; i++)
+			{
+				_States[i] = machine->GetStartState();
+				for (int32 j = 0; j < _WordCount; j++)
+				{
+					_Symbols[i * _WordCount + j] = symbols[j];
+				}
+			}
+		}
+
+		void FSMAgentBatch::SetState(int32 agent, int32 state)
+		{
+			_Machine->ChangeState(_States[agent], state, _Symbols.Data() + agent * _WordCount);
+		}
+
+		void FSMAgentBatch::Update()
+		{
+			Update(0, _States.Count());
+		}
+
+		void FSMAgentBatch::Update(int32 start, int32 end)
+		{
+			const CompiledFSM* machine = _Machine;
+			int32* states = _States.Data();
+			uint32* symbols = _Symbols.Data() + start * _WordCount;
+			for (int32 i = start; i < end; i++, symbols += _WordCount)
+			{
+				machine->Update(states[i], symbols);
+			}
+		}
+
+		void FSMAgentBatch::ParallelUpdate(int32 chunkSize)
+		{
+			JobScheduler* scheduler = JobScheduler::Instance();
+			if (!scheduler->IsCreated() || _Machine->HasExternalObjects())
+			{
+				Update();
+				return;
+			}
+
+			scheduler->ParallelFor(_States.Count(), UpdateRange, this, chunkSize);
+		}
+
+		void FSMAgentBatch::UpdateRange(int32 start, int32 end, void* data)
+		{
+			((FSMAgentBatch*)data)->Update(start, end);
+		}
+	}
+}
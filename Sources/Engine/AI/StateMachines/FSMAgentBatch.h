@@ -0,0 +1,92 @@
+/*=============================================================================
+FSMAgentBatch.h
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+#ifndef _SE_AI_FSMAGENTBATCH_H_
+#define _SE_AI_FSMAGENTBATCH_H_
+
+#include "Core/Core.h"
+#include "AI/Common.h"
+#include "AI/StateMachines/CompiledFSM.h"
+
+namespace SonataEngine
+{
+	namespace AI
+	{
+		/** AI FSM Agent Batch.
+			Agents sharing a compiled machine, each with its own current state and
+			symbol values. The states and the symbols of the agents are stored in
+			contiguous arrays and the agents are updated together.
+		*/
+		class FSMAgentBatch
+		{
+		public:
+			FSMAgentBatch();
+			virtual ~FSMAgentBatch();
+
+			/**
+				Initializes the agents in the start state of the machine, with the
+				symbol values of the symbol table. No enter action is run.
+			*/
+			void Initialize(CompiledFSM* machine, int32 agentCount);
+
+			CompiledFSM* GetMachine() const { return _Machine; }
+			int32 GetAgentCount() const { return _States.Count(); }
+
+			/** @name Agents. */
+			//@{
+			int32 GetState(int32 agent) const { return _States[agent]; }
+
+			/** Changes the state of an agent like FSM::SetCurrentState. */
+			void SetState(int32 agent, int32 state);
+
+			bool GetSymbol(int32 agent, int32 symbol) const
+			{
+				return (_Symbols[agent * _WordCount + (symbol >> 5)] & (1u << (symbol & 31))) != 0;
+			}
+
+			void SetSymbol(int32 agent, int32 symbol, bool value)
+			{
+				uint32& word = _Symbols[agent * _WordCount + (symbol >> 5)];
+				if (value)
+					word |= 1u << (symbol & 31);
+				else
+					word &= ~(1u << (symbol & 31));
+			}
+			//@}
+
+			/** Updates all the agents on the calling thread. */
+			void Update();
+
+			/** Updates the agents from start to end, excluded. */
+			void Update(int32 start, int32 end);
+
+			/**
+				Updates all the agents on the JobScheduler threads and waits for them.
+				Falls back to Update when the JobScheduler is not created or when the
+				machine has external conditions or actions.
+				@param chunkSize The number of agents per job, 0 for a default size.
+			*/
+			void ParallelUpdate(int32 chunkSize = 0);
+
+		protected:
+			static void UpdateRange(int32 start, int32 end, void* data);
+
+		protected:
+			CompiledFSMPtr _Machine;
+			int32 _WordCount;
+			BaseArray<int32> _States;
+
+			/// _WordCount words per agent.
+			BaseArray<uint32> _Symbols;
+
+		private:
+			FSMAgentBatch(const FSMAgentBatch&);
+			FSMAgentBatch& operator=(const FSMAgentBatch&);
+		};
+	}
+}
+
+#endif
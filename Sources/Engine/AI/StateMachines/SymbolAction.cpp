@@ -27,5 +27,12 @@ namespace SonataEngine
 
 			return GetMachine()->GetSymbolTable()->SetSymbol(Symbol, Value);
 		}
+
+		bool SymbolAction::GetSymbolAssignment(String& symbol, bool& value) const
+		{
+			symbol = Symbol;
+			value = Value;
+			return true;
+		}
 	}
 }
@@ -25,6 +25,8 @@ namespace SonataEngine
 
 			virtual void Execute() const;
 
+			virtual bool GetSymbolAssignment(String& symbol, bool& value) const;
+
 			String Symbol;
 			bool Value;
 		};
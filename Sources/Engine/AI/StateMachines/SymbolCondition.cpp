@@ -34,5 +34,12 @@ namespace SonataEngine
 
 			return GetMachine()->GetSymbolTable()->GetSymbol(Symbol) == Value;
 		}
+
+		bool SymbolCondition::GetSymbolTest(String& symbol, bool& value) const
+		{
+			symbol = Symbol;
+			value = Value;
+			return true;
+		}
 	}
 }
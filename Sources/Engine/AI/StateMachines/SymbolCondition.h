@@ -25,6 +25,8 @@ namespace SonataEngine
 
 			virtual bool Check() const;
 
+			virtual bool GetSymbolTest(String& symbol, bool& value) const;
+
 			String Symbol;
 			bool Value;
 		};
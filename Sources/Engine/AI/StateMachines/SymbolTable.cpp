@@ -31,10 +31,11 @@ namespace SonataEngine
 
 		bool SymbolTable::GetSymbol(const String& name)
 		{
-			if (!_Symbols.Contains(name))
+			const Symbol* symbol = _Symbols.Find(name);
+			if (symbol == NULL)
 				return false;
 
-			return _Symbols[name].Value;
+			return symbol->Value;
 		}
 
 		void SymbolTable::SetSymbol(const String& name, bool value)
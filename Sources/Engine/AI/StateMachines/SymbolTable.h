@@ -45,8 +45,11 @@ namespace SonataEngine
 
 			void SetSymbol(const String& name, bool value);
 
+			/** Gets the symbols of the table. */
+			BaseArray<Symbol> GetSymbols() const { return _Symbols.Values(); }
+
 		protected:
-			typedef Dictionary<String, Symbol> SymbolList;
+			typedef Hashtable<String, Symbol> SymbolList;
 			SymbolList _Symbols;
 		};
 
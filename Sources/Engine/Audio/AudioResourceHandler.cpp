@@ -93,6 +93,9 @@ namespace SonataEngine
 						resource->SetSize(sound->GetLength());
 						resource->SetData(sound);
 
+						// The resource holds a reference on the sound, released when it is unloaded
+						sound->AddRef();
+
 						return resource;
 					}
 				}
@@ -114,7 +117,15 @@ namespace SonataEngine
 			if (!CanHandle(resource->GetResourceType()))
 				return false;
 
-			return false;
+			Sound* sound = (Sound*)resource->GetData();
+			if (sound == NULL)
+				return false;
+
+			resource->SetData(NULL);
+			resource->SetSize(0);
+			sound->Release();
+
+			return true;
 		}
 
 		// Creates an instance of this handler
@@ -25,9 +25,15 @@ Author: Julien Delezenne
 /** System byte-order. */
 #define SE_USE_BIGENDIAN 0
 
-/** Memory information. */
+/** Memory statistics, counts the heap operations. */
+#define SE_USE_MEMORYSTATS 1
+
+/** Memory information, tracks the allocations by call site and tag. */
 #define SE_USE_MEMORYINFO 0
 
+/** SIMD instructions (SSE) for the batch operations. */
+#define SE_USE_SIMD 1
+
 /** Reflection support. */
 #define SE_USE_REFLECTION 1
 
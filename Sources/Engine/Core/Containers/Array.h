@@ -14,20 +14,23 @@ namespace SonataEngine
 {
 
 /** Array for types that can be compared. */
-template <class T>
-class Array : public BaseArray<T>
+template <class T, class TAllocator = HeapAllocator<T> >
+class Array : public BaseArray<T, TAllocator>
 {
 public:
 	Array();
+	Array(const TAllocator& allocator);
 	Array(int size);
 	Array(T* data, int size);
 	Array(const T* data, int size);
-	Array(const Array<T>& value);
-	virtual ~Array();
+	Array(const Array<T, TAllocator>& value);
+	~Array();
 
-	virtual bool Contains(const T& value) const;
+	void Remove(const T& value);
 
-	virtual int IndexOf(const T& value) const;
+	bool Contains(const T& value) const;
+
+	int IndexOf(const T& value) const;
 };
 
 #include "Array.inl"
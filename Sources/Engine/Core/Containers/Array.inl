@@ -4,62 +4,72 @@ Project: Sonata Engine
 Author: Julien Delezenne
 =============================================================================*/
 
-template <class T>
-Array<T>::Array() :
-	BaseArray<T>()
+template <class T, class TAllocator>
+Array<T, TAllocator>::Array() :
+	BaseArray<T, TAllocator>()
 {
 }
 
-template <class T>
-Array<T>::Array(int size) :
-	BaseArray<T>(size)
+template <class T, class TAllocator>
+Array<T, TAllocator>::Array(const TAllocator& allocator) :
+	BaseArray<T, TAllocator>(allocator)
 {
 }
 
-template <class T>
-Array<T>::Array(T* data, int size) :
-	BaseArray<T>(data, size)
+template <class T, class TAllocator>
+Array<T, TAllocator>::Array(int size) :
+	BaseArray<T, TAllocator>(size)
 {
 }
 
-template <class T>
-Array<T>::Array(const T* data, int size) :
-	BaseArray<T>(data, size)
+template <class T, class TAllocator>
+Array<T, TAllocator>::Array(T* data, int size) :
+	BaseArray<T, TAllocator>(data, size)
 {
 }
 
-template <class T>
-Array<T>::Array(const Array<T>& value) :
-	BaseArray<T>(value)
+template <class T, class TAllocator>
+Array<T, TAllocator>::Array(const T* data, int size) :
+	BaseArray<T, TAllocator>(data, size)
 {
 }
 
-template <class T>
-Array<T>::~Array()
+template <class T, class TAllocator>
+Array<T, TAllocator>::Array(const Array<T, TAllocator>& value) :
+	BaseArray<T, TAllocator>(value)
 {
 }
 
-template <class T>
-bool Array<T>::Contains(const T& value) const
+template <class T, class TAllocator>
+Array<T, TAllocator>::~Array()
 {
-	for (InnerType::const_iterator it = _internal.begin(); it != _internal.end(); it++)
+}
+
+template <class T, class TAllocator>
+void Array<T, TAllocator>::Remove(const T& value)
+{
+	int index = IndexOf(value);
+	if (index >= 0)
 	{
-		if (*it == value)
-			return true;
+		this->RemoveAt(index);
 	}
+}
 
-	return false;
+template <class T, class TAllocator>
+bool Array<T, TAllocator>::Contains(const T& value) const
+{
+	return IndexOf(value) >= 0;
 }
 
-template <class T>
-int Array<T>::IndexOf(const T& value) const
+template <class T, class TAllocator>
+int Array<T, TAllocator>::IndexOf(const T& value) const
 {
-	int index = 0;
-	for (InnerType::const_iterator it = _internal.begin(); it != _internal.end(); it++)
+	const T* data = this->Data();
+	int count = this->Count();
+	for (int i = 0; i < count; ++i)
 	{
-		if (*it == value)
-			return index;
-		index++;
+		if (data[i] == value)
+			return i;
 	}
 
 	return -1;
@@ -11,83 +11,114 @@ Author: Julien Delezenne
 #include <algorithm>
 
 #include "Core/Common.h"
-#include "Core/Containers/IList.h"
+#include "Core/System/Allocator.h"
 
 namespace SonataEngine
 {
 
-/** Array for types that can't be compared. */
-template <class T>
-class BaseArray : public IList<T>
+/**
+	@brief Array for types that can't be compared.
+
+	The elements are stored contiguously and the methods are not virtual so
+	they can be inlined in the inner loops. The elements can be accessed
+	directly with Data() or with the begin() and end() pointers.
+	Use ListAdapter to access an array through the IList interface.
+	The memory is allocated with TAllocator, use a FrameAllocator for the
+	temporary arrays of a frame.
+*/
+template <class T, class TAllocator = HeapAllocator<T> >
+class BaseArray
 {
 protected:
-	typedef typename std::vector<T> InnerType;
-	typename InnerType _internal;
+	typedef typename std::vector<T, TAllocator> InnerType;
+	InnerType _internal;
 
-	class BaseArrayIterator : public IIterator<T>
+	class BaseArrayIterator
 	{
 	private:
-		const BaseArray<T>* _array;
-		typename InnerType::const_iterator _it;
+		const T* _current;
+		const T* _end;
 		bool _isFirst;
 
 	public:
-		BaseArrayIterator(const BaseArray<T>* array);
+		BaseArrayIterator(const BaseArray<T, TAllocator>* array);
 
-		virtual BaseArrayIterator& operator++();
-		virtual T Current() const;
-		virtual bool Next();
+		BaseArrayIterator& operator++();
+		const T& Current() const;
+		bool Next();
 	};
 
-	friend BaseArrayIterator;
+	friend class BaseArrayIterator;
 
 public:
-	typedef typename BaseArrayIterator Iterator;
+	typedef BaseArrayIterator Iterator;
 	typedef bool (*SortFunction) (const T& left, const T& right);
 
 	BaseArray();
+	BaseArray(const TAllocator& allocator);
 	BaseArray(int size);
 	BaseArray(T* data, int size);
 	BaseArray(const T* data, int size);
-	BaseArray(const BaseArray<T>& value);
-	virtual ~BaseArray();
+	BaseArray(const BaseArray<T, TAllocator>& value);
+	~BaseArray();
 
-	BaseArray<T>& operator=(const BaseArray<T>& value);
-	virtual T& operator[](int index);
-	virtual const T& operator[](int index) const;
+	BaseArray<T, TAllocator>& operator=(const BaseArray<T, TAllocator>& value);
+	T& operator[](int index);
+	const T& operator[](int index) const;
 
-	virtual Iterator GetIterator() const;
+	Iterator GetIterator() const;
 
-	virtual int GetCapacity();
+	/** Gets the allocator of the array. */
+	TAllocator GetAllocator() const;
 
-	virtual void SetCapacity(int value);
+	/** Gets a pointer to the first element, or NULL if the array is empty. */
+	T* Data();
+	const T* Data() const;
 
-	virtual void Resize(int value);
+	/** Gets a pointer to the first element. */
+	T* begin();
+	const T* begin() const;
 
-	virtual int Count() const;
+	/** Gets a pointer past the last element. */
+	T* end();
+	const T* end() const;
 
-	virtual bool IsEmpty() const;
+	int GetCapacity() const;
 
-	virtual void Clear();
+	void SetCapacity(int value);
 
-	virtual void Add(const T& value);
+	void Resize(int value);
 
-	virtual void Insert(int index, const T& value) { SEthrow("NotSupportedException"); }
+	int Count() const;
 
-	virtual void Remove(const T& value) { SEthrow("NotSupportedException"); }
+	bool IsEmpty() const;
 
-	virtual void RemoveAt(int index) { SEthrow("NotSupportedException"); }
+	void Clear();
 
-	virtual bool Contains(const T& value) const { SEthrow("NotSupportedException"); return false; }
+	void Add(const T& value);
 
-	virtual int IndexOf(const T& value) const { SEthrow("NotSupportedException"); return 0; }
+	/** Adds a default constructed element to the end of the array and returns it. */
+	T& EmplaceBack();
 
-	virtual T& GetItem(int index);
-	virtual const T& GetItem(int index) const;
+	void Insert(int index, const T& value);
 
-	virtual void SetItem(int index, const T& value);
+	void Remove(const T& value) { SEthrow("NotSupportedException"); }
 
-	virtual void Sort(SortFunction fnSort);
+	void RemoveAt(int index);
+
+	bool Contains(const T& value) const { SEthrow("NotSupportedException"); return false; }
+
+	int IndexOf(const T& value) const { SEthrow("NotSupportedException"); return 0; }
+
+	T& GetItem(int index);
+	const T& GetItem(int index) const;
+
+	void SetItem(int index, const T& value);
+
+	void Sort(SortFunction fnSort);
+
+	/** Exchanges the elements of two arrays without copying them. */
+	void Swap(BaseArray<T, TAllocator>& value);
 };
 
 #include "BaseArray.inl"
@@ -4,36 +4,36 @@ Project: Sonata Engine
 Author: Julien Delezenne
 =============================================================================*/
 
-template <class T>
-BaseArray<T>::BaseArrayIterator::BaseArrayIterator(const BaseArray<T>* array) :
-	_array(array),
+template <class T, class TAllocator>
+SE_INLINE BaseArray<T, TAllocator>::BaseArrayIterator::BaseArrayIterator(const BaseArray<T, TAllocator>* array) :
+	_current(array->begin()),
+	_end(array->end()),
 	_isFirst(true)
 {
-	_it = _array->_internal.begin();
 }
 
-template <class T>
-typename BaseArray<T>::Iterator& BaseArray<T>::BaseArrayIterator::operator++()
+template <class T, class TAllocator>
+SE_INLINE typename BaseArray<T, TAllocator>::Iterator& BaseArray<T, TAllocator>::BaseArrayIterator::operator++()
 {
 	Next();
 	return *this;
 }
 
-template <class T>
-T BaseArray<T>::BaseArrayIterator::Current() const
+template <class T, class TAllocator>
+SE_INLINE const T& BaseArray<T, TAllocator>::BaseArrayIterator::Current() const
 {
 	if (_isFirst)
 	{
 		SEthrow("InvalidOperationException");
 	}
 
-	return *_it;
+	return *_current;
 }
 
-template <class T>
-bool BaseArray<T>::BaseArrayIterator::Next()
+template <class T, class TAllocator>
+SE_INLINE bool BaseArray<T, TAllocator>::BaseArrayIterator::Next()
 {
-	if (_it == _array->_internal.end())
+	if (_current == _end)
 	{
 		return false;
 	}
@@ -44,137 +44,203 @@ bool BaseArray<T>::BaseArrayIterator::Next()
 	}
 	else
 	{
-		_it++;
-		return (_it != _array->_internal.end());
+		_current++;
+		return (_current != _end);
 	}
 }
 
 
-template <class T>
-BaseArray<T>::BaseArray() :
+template <class T, class TAllocator>
+BaseArray<T, TAllocator>::BaseArray() :
 	_internal()
 {
 }
 
-template <class T>
-BaseArray<T>::BaseArray(int size) :
+template <class T, class TAllocator>
+BaseArray<T, TAllocator>::BaseArray(const TAllocator& allocator) :
+	_internal(allocator)
+{
+}
+
+template <class T, class TAllocator>
+BaseArray<T, TAllocator>::BaseArray(int size) :
 	_internal(size)
 {
 }
 
-template <class T>
-BaseArray<T>::BaseArray(T* data, int size)
+template <class T, class TAllocator>
+BaseArray<T, TAllocator>::BaseArray(T* data, int size) :
+	_internal(data, data + size)
 {
-	for (int i = 0; i < size; ++i)
-	{
-		_internal.push_back(data[i]);
-	}
 }
 
-template <class T>
-BaseArray<T>::BaseArray(const T* data, int size)
+template <class T, class TAllocator>
+BaseArray<T, TAllocator>::BaseArray(const T* data, int size) :
+	_internal(data, data + size)
 {
-	for (int i = 0; i < size; ++i)
-	{
-		_internal.push_back(data[i]);
-	}
 }
 
-template <class T>
-BaseArray<T>::BaseArray(const BaseArray<T>& value)
+template <class T, class TAllocator>
+BaseArray<T, TAllocator>::BaseArray(const BaseArray<T, TAllocator>& value) :
+	_internal(value._internal)
 {
-	Iterator it = value.GetIterator();
-	while (it.Next())
-	{
-		Add(it.Current());
-	}
 }
 
-template <class T>
-BaseArray<T>::~BaseArray()
+template <class T, class TAllocator>
+BaseArray<T, TAllocator>::~BaseArray()
 {
 }
 
-template <class T>
-BaseArray<T>& BaseArray<T>::operator=(const BaseArray<T>& value)
+template <class T, class TAllocator>
+BaseArray<T, TAllocator>& BaseArray<T, TAllocator>::operator=(const BaseArray<T, TAllocator>& value)
 {
 	if (this != &value)
 	{
-		Clear();
-		int count = value.Count();
-		for (int i=0; i<count; i++)
-		{
-			_internal.push_back(value[i]);
-		}
+		_internal = value._internal;
 	}
 	return *this;
 }
 
-template <class T>
-T& BaseArray<T>::operator[](int index)
+template <class T, class TAllocator>
+SE_INLINE T& BaseArray<T, TAllocator>::operator[](int index)
 {
-	return GetItem(index);
+	SE_ASSERT(0 <= index && index < (int)_internal.size());
+	return _internal[index];
 }
 
-template <class T>
-const T& BaseArray<T>::operator[](int index) const
+template <class T, class TAllocator>
+SE_INLINE const T& BaseArray<T, TAllocator>::operator[](int index) const
 {
-	return GetItem(index);
+	SE_ASSERT(0 <= index && index < (int)_internal.size());
+	return _internal[index];
 }
 
-template <class T>
-typename BaseArray<T>::Iterator BaseArray<T>::GetIterator() const
+template <class T, class TAllocator>
+SE_INLINE typename BaseArray<T, TAllocator>::Iterator BaseArray<T, TAllocator>::GetIterator() const
 {
 	BaseArrayIterator it(this);
 	return it;
 }
 
-template <class T>
-int BaseArray<T>::GetCapacity()
+template <class T, class TAllocator>
+SE_INLINE TAllocator BaseArray<T, TAllocator>::GetAllocator() const
+{
+	return _internal.get_allocator();
+}
+
+template <class T, class TAllocator>
+SE_INLINE T* BaseArray<T, TAllocator>::Data()
+{
+	return (_internal.empty() ? NULL : &_internal[0]);
+}
+
+template <class T, class TAllocator>
+SE_INLINE const T* BaseArray<T, TAllocator>::Data() const
+{
+	return (_internal.empty() ? NULL : &_internal[0]);
+}
+
+template <class T, class TAllocator>
+SE_INLINE T* BaseArray<T, TAllocator>::begin()
+{
+	return Data();
+}
+
+template <class T, class TAllocator>
+SE_INLINE const T* BaseArray<T, TAllocator>::begin() const
+{
+	return Data();
+}
+
+template <class T, class TAllocator>
+SE_INLINE T* BaseArray<T, TAllocator>::end()
+{
+	return Data() + _internal.size();
+}
+
+template <class T, class TAllocator>
+SE_INLINE const T* BaseArray<T, TAllocator>::end() const
+{
+	return Data() + _internal.size();
+}
+
+template <class T, class TAllocator>
+SE_INLINE int BaseArray<T, TAllocator>::GetCapacity() const
 {
-	return (int) _internal.capacity();
+	return (int)_internal.capacity();
 }
 
-template <class T>
-void BaseArray<T>::SetCapacity(int value)
+template <class T, class TAllocator>
+SE_INLINE void BaseArray<T, TAllocator>::SetCapacity(int value)
 {
 	_internal.reserve(value);
 }
 
-template <class T>
-void BaseArray<T>::Resize(int value)
+template <class T, class TAllocator>
+SE_INLINE void BaseArray<T, TAllocator>::Resize(int value)
 {
 	_internal.resize(value);
 }
 
-template <class T>
-int BaseArray<T>::Count() const
+template <class T, class TAllocator>
+SE_INLINE int BaseArray<T, TAllocator>::Count() const
 {
 	return (int)_internal.size();
 }
 
-template <class T>
-bool BaseArray<T>::IsEmpty() const
+template <class T, class TAllocator>
+SE_INLINE bool BaseArray<T, TAllocator>::IsEmpty() const
 {
-	return _internal.size() == 0;
+	return _internal.empty();
 }
 
-template <class T>
-void BaseArray<T>::Clear()
+template <class T, class TAllocator>
+SE_INLINE void BaseArray<T, TAllocator>::Clear()
 {
 	_internal.clear();
 }
 
-template <class T>
-void BaseArray<T>::Add(const T& value)
+template <class T, class TAllocator>
+SE_INLINE void BaseArray<T, TAllocator>::Add(const T& value)
 {
 	_internal.push_back(value);
 }
 
-template <class T>
-T& BaseArray<T>::GetItem(int index)
+template <class T, class TAllocator>
+SE_INLINE T& BaseArray<T, TAllocator>::EmplaceBack()
+{
+	_internal.resize(_internal.size() + 1);
+	return _internal.back();
+}
+
+template <class T, class TAllocator>
+void BaseArray<T, TAllocator>::Insert(int index, const T& value)
 {
 	if (index < 0 || index > (int)_internal.size())
+	{
+		SEthrow("OutOfRangeException");
+		return;
+	}
+
+	_internal.insert(_internal.begin() + index, value);
+}
+
+template <class T, class TAllocator>
+void BaseArray<T, TAllocator>::RemoveAt(int index)
+{
+	if (index < 0 || index >= (int)_internal.size())
+	{
+		SEthrow("OutOfRangeException");
+		return;
+	}
+
+	_internal.erase(_internal.begin() + index);
+}
+
+template <class T, class TAllocator>
+SE_INLINE T& BaseArray<T, TAllocator>::GetItem(int index)
+{
+	if (index < 0 || index >= (int)_internal.size())
 	{
 		SEthrow("OutOfRangeException");
 	}
@@ -182,10 +248,10 @@ T& BaseArray<T>::GetItem(int index)
 	return _internal[index];
 }
 
-template <class T>
-const T& BaseArray<T>::GetItem(int index) const
+template <class T, class TAllocator>
+SE_INLINE const T& BaseArray<T, TAllocator>::GetItem(int index) const
 {
-	if (index < 0 || index > (int)_internal.size())
+	if (index < 0 || index >= (int)_internal.size())
 	{
 		SEthrow("OutOfRangeException");
 	}
@@ -193,10 +259,10 @@ const T& BaseArray<T>::GetItem(int index) const
 	return _internal[index];
 }
 
-template <class T>
-void BaseArray<T>::SetItem(int index, const T& value)
+template <class T, class TAllocator>
+SE_INLINE void BaseArray<T, TAllocator>::SetItem(int index, const T& value)
 {
-	if (index < 0 || index > (int)_internal.size())
+	if (index < 0 || index >= (int)_internal.size())
 	{
 		SEthrow("OutOfRangeException");
 		return;
@@ -205,8 +271,14 @@ void BaseArray<T>::SetItem(int index, const T& value)
 	_internal[index] = value;
 }
 
-template <class T>
-void BaseArray<T>::Sort(SortFunction fnSort)
+template <class T, class TAllocator>
+void BaseArray<T, TAllocator>::Sort(SortFunction fnSort)
 {
 	std::sort(_internal.begin(), _internal.end(), fnSort);
 }
+
+template <class T, class TAllocator>
+SE_INLINE void BaseArray<T, TAllocator>::Swap(BaseArray<T, TAllocator>& value)
+{
+	_internal.swap(value._internal);
+}
@@ -0,0 +1,108 @@
+/*=============================================================================
+Hash.h
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+#ifndef _SE_HASH_H_
+#define _SE_HASH_H_
+
+#include "Core/Common.h"
+
+namespace SonataEngine
+{
+
+/// Computes the FNV-1a hash code of a block of memory.
+SE_INLINE uint32 SE_HashBytes(const void* data, size_t size)
+{
+	const uint8* bytes = (const uint8*)data;
+	uint32 hash = 2166136261U;
+	for (size_t i = 0; i < size; ++i)
+	{
+		hash ^= bytes[i];
+		hash *= 16777619U;
+	}
+	return hash;
+}
+
+/// Computes the hash code of a 32-bits integer (MurmurHash3 finalizer).
+SE_INLINE uint32 SE_HashUInt32(uint32 value)
+{
+	value ^= value >> 16;
+	value *= 0x85ebca6bU;
+	value ^= value >> 13;
+	value *= 0xc2b2ae35U;
+	value ^= value >> 16;
+	return value;
+}
+
+/// Computes the hash code of a 64-bits integer.
+SE_INLINE uint32 SE_HashUInt64(uint64 value)
+{
+	return SE_HashUInt32((uint32)value ^ SE_HashUInt32((uint32)(value >> 32)));
+}
+
+/// Combines two hash codes.
+SE_INLINE uint32 SE_HashCombine(uint32 seed, uint32 value)
+{
+	return seed ^ (value + 0x9e3779b9U + (seed << 6) + (seed >> 2));
+}
+
+/**
+	@brief Hash function.
+
+	Computes the hash code of a key for the hashed containers.
+	The default implementation hashes the bytes of the value and is only
+	valid for plain types without padding. Specialize this template to
+	provide the hash function of other key types.
+*/
+template <class T>
+struct Hash
+{
+	uint32 operator()(const T& value) const
+	{
+		return SE_HashBytes(&value, sizeof(T));
+	}
+};
+
+/** Hash function for the pointers. */
+template <class T>
+struct Hash<T*>
+{
+	uint32 operator()(T* value) const
+	{
+		return SE_HashUInt64((uint64)(SEptr)value);
+	}
+};
+
+#define SE_HASH_INTEGER32(type) \
+	template <> \
+	struct Hash<type> \
+	{ \
+		uint32 operator()(type value) const { return SE_HashUInt32((uint32)value); } \
+	};
+
+#define SE_HASH_INTEGER64(type) \
+	template <> \
+	struct Hash<type> \
+	{ \
+		uint32 operator()(type value) const { return SE_HashUInt64((uint64)value); } \
+	};
+
+SE_HASH_INTEGER32(bool)
+SE_HASH_INTEGER32(char)
+SE_HASH_INTEGER32(int8)
+SE_HASH_INTEGER32(uint8)
+SE_HASH_INTEGER32(int16)
+SE_HASH_INTEGER32(uint16)
+SE_HASH_INTEGER32(int32)
+SE_HASH_INTEGER32(uint32)
+SE_HASH_INTEGER64(int64)
+SE_HASH_INTEGER64(uint64)
+
+#undef SE_HASH_INTEGER32
+#undef SE_HASH_INTEGER64
+
+}
+
+#endif
@@ -7,18 +7,186 @@ Author: Julien Delezenne
 #ifndef _SE_HASHTABLE_H_
 #define _SE_HASHTABLE_H_
 
-#include <hash_map>
+#include <new>
 
 #include "Core/Common.h"
-#include "Core/Containers/IDictionaryIterator.h"
+#include "Core/System/Memory.h"
+#include "Core/Containers/BaseArray.h"
+#include "Core/Containers/Hash.h"
+#include "Core/Containers/IDictionary.h"
 
 namespace SonataEngine
 {
 
-/** Represents a collection of key/value pairs that are organized based on the hash code of the key. */
-template <class TKey, class TValue>
-class Hashtable
+/**
+	@brief Represents a collection of key/value pairs that are organized based on the hash code of the key.
+
+	The pairs are stored in a single flat table using open addressing with
+	robin-hood hashing: each slot records its distance to the slot its key
+	hashes to, and an insertion takes the slot of any element that is closer
+	to its own home slot. This keeps the probe sequences short so a lookup
+	usually touches a single cache line. Removals shift the following
+	elements back instead of leaving tombstones.
+
+	The hash function is provided by the THash parameter, which defaults to
+	the Hash template.
+*/
+template <class TKey, class TValue, class THash = Hash<TKey> >
+class Hashtable : public IDictionary<TKey, TValue>
 {
+protected:
+	struct Slot
+	{
+		TKey Key;
+		TValue Value;
+
+		Slot(const TKey& key, const TValue& value) :
+			Key(key),
+			Value(value)
+		{
+		}
+	};
+
+	/// Maximum load factor of the table, in eighths.
+	static const int MaxLoad = 7;
+
+	/// Minimum number of slots of the table.
+	static const int MinCapacity = 8;
+
+	/// Maximum probe distance, a larger distance forces the table to grow.
+	static const int MaxDistance = 0xffff;
+
+	Slot* _slots;
+	/// Probe distance of each slot plus one, zero for the empty slots.
+	uint16* _distances;
+	int _capacity;
+	int _count;
+	THash _hash;
+
+public:
+	class HashtableIterator;
+
+	class KeyValuePair : public IKeyValuePair<TKey, TValue>
+	{
+	protected:
+		TKey _key;
+		TValue _value;
+
+	public:
+		KeyValuePair(const TKey& key, const TValue& value);
+
+		virtual TKey Key() const;
+
+		virtual TValue Value() const;
+	};
+
+	class HashtableEntry : public IDictionaryEntry<TKey, TValue>
+	{
+	protected:
+		Slot* _slot;
+
+	public:
+		HashtableEntry();
+		HashtableEntry(Slot* slot);
+
+		virtual TKey GetKey() const;
+
+		virtual void SetKey(const TKey& key);
+
+		virtual TValue GetValue() const;
+
+		virtual void SetValue(const TValue& value);
+	};
+
+	class HashtableIterator : public IDictionaryIterator<TKey, TValue>
+	{
+	protected:
+		const Hashtable<TKey, TValue, THash>* _table;
+		int _index;
+
+	public:
+		HashtableIterator(const Hashtable<TKey, TValue, THash>* table);
+		virtual HashtableIterator& operator++();
+
+		virtual IKeyValuePair<TKey, TValue> Current() const;
+
+		virtual bool Next();
+
+		virtual IDictionaryEntry<TKey, TValue> Entry() const;
+
+		virtual TKey Key() const;
+
+		virtual TValue Value() const;
+	};
+
+	friend class HashtableIterator;
+
+public:
+	typedef HashtableIterator Iterator;
+
+	Hashtable();
+	Hashtable(int capacity);
+	Hashtable(const Hashtable<TKey, TValue, THash>& value);
+	virtual ~Hashtable();
+
+	Hashtable<TKey, TValue, THash>& operator=(const Hashtable<TKey, TValue, THash>& value);
+	virtual TValue& operator[](const TKey& key);
+	virtual const TValue& operator[](const TKey& key) const;
+
+	virtual Iterator GetIterator() const;
+
+	/** Gets the number of elements that the Hashtable can contain before growing. */
+	int GetCapacity() const;
+
+	/** Reserves enough space to contain the specified number of elements without growing. */
+	void SetCapacity(int value);
+
+	virtual void Clear();
+
+	virtual int Count() const;
+
+	virtual bool IsEmpty() const;
+
+	virtual void Add(const TKey& key, const TValue& value);
+
+	virtual void Remove(const TKey& key);
+
+	virtual bool Contains(const TKey& key) const;
+
+	virtual bool ContainsKey(const TKey& key) const;
+
+	virtual bool ContainsValue(const TValue& value) const { SEthrow("NotSupportedException"); return false; }
+
+	virtual TValue& GetItem(const TKey& key);
+	virtual const TValue& GetItem(const TKey& key) const;
+
+	virtual void SetItem(const TKey& key, const TValue& value);
+
+	virtual BaseArray<TKey> Keys() const;
+
+	virtual BaseArray<TValue> Values() const;
+
+	/**
+		Gets the value associated with the specified key with a single lookup.
+		@param key The key of the value to get.
+		@return A pointer to the value, or NULL if the key is not found.
+	*/
+	TValue* Find(const TKey& key);
+	const TValue* Find(const TKey& key) const;
+
+	/**
+		Gets the value associated with the specified key with a single lookup.
+		@param key The key of the value to get.
+		@param value Receives the value if the key is found.
+		@return true if the key is found; otherwise, false.
+	*/
+	bool TryGetValue(const TKey& key, TValue& value) const;
+
+protected:
+	int FindIndex(const TKey& key) const;
+	int InsertIndex(const TKey& key, const TValue& value);
+	void Rehash(int capacity);
+	void Destroy();
 };
 
 #include "Hashtable.inl"
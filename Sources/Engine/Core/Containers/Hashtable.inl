@@ -3,3 +3,514 @@ Hashtable.inl
 Project: Sonata Engine
 Author: Julien Delezenne
 =============================================================================*/
+
+template <class TKey, class TValue, class THash>
+Hashtable<TKey, TValue, THash>::KeyValuePair::KeyValuePair(const TKey& key, const TValue& value) :
+	_key(key),
+	_value(value)
+{
+}
+
+template <class TKey, class TValue, class THash>
+TKey Hashtable<TKey, TValue, THash>::KeyValuePair::Key() const
+{
+	return _key;
+}
+
+template <class TKey, class TValue, class THash>
+TValue Hashtable<TKey, TValue, THash>::KeyValuePair::Value() const
+{
+	return _value;
+}
+
+
+template <class TKey, class TValue, class THash>
+Hashtable<TKey, TValue, THash>::HashtableEntry::HashtableEntry() :
+	_slot(NULL)
+{
+}
+
+template <class TKey, class TValue, class THash>
+Hashtable<TKey, TValue, THash>::HashtableEntry::HashtableEntry(Slot* slot) :
+	_slot(slot)
+{
+}
+
+template <class TKey, class TValue, class THash>
+TKey Hashtable<TKey, TValue, THash>::HashtableEntry::GetKey() const
+{
+	return _slot->Key;
+}
+
+template <class TKey, class TValue, class THash>
+void Hashtable<TKey, TValue, THash>::HashtableEntry::SetKey(const TKey& key)
+{
+}
+
+template <class TKey, class TValue, class THash>
+TValue Hashtable<TKey, TValue, THash>::HashtableEntry::GetValue() const
+{
+	return _slot->Value;
+}
+
+template <class TKey, class TValue, class THash>
+void Hashtable<TKey, TValue, THash>::HashtableEntry::SetValue(const TValue& value)
+{
+	_slot->Value = value;
+}
+
+
+template <class TKey, class TValue, class THash>
+Hashtable<TKey, TValue, THash>::HashtableIterator::HashtableIterator(const Hashtable<TKey, TValue, THash>* table) :
+	_table(table),
+	_index(-1)
+{
+}
+
+template <class TKey, class TValue, class THash>
+typename Hashtable<TKey, TValue, THash>::HashtableIterator& Hashtable<TKey, TValue, THash>::HashtableIterator::operator++()
+{
+	Next();
+	return *this;
+}
+
+template <class TKey, class TValue, class THash>
+bool Hashtable<TKey, TValue, THash>::HashtableIterator::Next()
+{
+	while (++_index < _table->_capacity)
+	{
+		if (_table->_distances[_index] != 0)
+		{
+			return true;
+		}
+	}
+
+	_index = _table->_capacity;
+	return false;
+}
+
+template <class TKey, class TValue, class THash>
+IKeyValuePair<TKey, TValue> Hashtable<TKey, TValue, THash>::HashtableIterator::Current() const
+{
+	if (_index < 0 || _index >= _table->_capacity)
+	{
+		SEthrow("InvalidOperationException");
+	}
+
+	const Slot& slot = _table->_slots[_index];
+	return KeyValuePair(slot.Key, slot.Value);
+}
+
+template <class TKey, class TValue, class THash>
+IDictionaryEntry<TKey, TValue> Hashtable<TKey, TValue, THash>::HashtableIterator::Entry() const
+{
+	HashtableEntry entry(&_table->_slots[_index]);
+	return entry;
+}
+
+template <class TKey, class TValue, class THash>
+TKey Hashtable<TKey, TValue, THash>::HashtableIterator::Key() const
+{
+	if (_index < 0 || _index >= _table->_capacity)
+	{
+		SEthrow("InvalidOperationException");
+	}
+
+	return _table->_slots[_index].Key;
+}
+
+template <class TKey, class TValue, class THash>
+TValue Hashtable<TKey, TValue, THash>::HashtableIterator::Value() const
+{
+	if (_index < 0 || _index >= _table->_capacity)
+	{
+		SEthrow("InvalidOperationException");
+	}
+
+	return _table->_slots[_index].Value;
+}
+
+
+template <class TKey, class TValue, class THash>
+Hashtable<TKey, TValue, THash>::Hashtable() :
+	_slots(NULL),
+	_distances(NULL),
+	_capacity(0),
+	_count(0)
+{
+}
+
+template <class TKey, class TValue, class THash>
+Hashtable<TKey, TValue, THash>::Hashtable(int capacity) :
+	_slots(NULL),
+	_distances(NULL),
+	_capacity(0),
+	_count(0)
+{
+	SetCapacity(capacity);
+}
+
+template <class TKey, class TValue, class THash>
+Hashtable<TKey, TValue, THash>::Hashtable(const Hashtable<TKey, TValue, THash>& value) :
+	_slots(NULL),
+	_distances(NULL),
+	_capacity(0),
+	_count(0),
+	_hash(value._hash)
+{
+	*this = value;
+}
+
+template <class TKey, class TValue, class THash>
+Hashtable<TKey, TValue, THash>::~Hashtable()
+{
+	Destroy();
+}
+
+template <class TKey, class TValue, class THash>
+Hashtable<TKey, TValue, THash>& Hashtable<TKey, TValue, THash>::operator=(const Hashtable<TKey, TValue, THash>& value)
+{
+	if (this != &value)
+	{
+		Clear();
+		SetCapacity(value._count);
+		for (int i = 0; i < value._capacity; ++i)
+		{
+			if (value._distances[i] != 0)
+			{
+				InsertIndex(value._slots[i].Key, value._slots[i].Value);
+			}
+		}
+	}
+	return *this;
+}
+
+template <class TKey, class TValue, class THash>
+TValue& Hashtable<TKey, TValue, THash>::operator[](const TKey& key)
+{
+	int index = FindIndex(key);
+	if (index < 0)
+	{
+		index = InsertIndex(key, TValue());
+	}
+	return _slots[index].Value;
+}
+
+template <class TKey, class TValue, class THash>
+const TValue& Hashtable<TKey, TValue, THash>::operator[](const TKey& key) const
+{
+	return GetItem(key);
+}
+
+template <class TKey, class TValue, class THash>
+typename Hashtable<TKey, TValue, THash>::Iterator Hashtable<TKey, TValue, THash>::GetIterator() const
+{
+	HashtableIterator it(this);
+	return it;
+}
+
+template <class TKey, class TValue, class THash>
+int Hashtable<TKey, TValue, THash>::GetCapacity() const
+{
+	return (_capacity * MaxLoad) / 8;
+}
+
+template <class TKey, class TValue, class THash>
+void Hashtable<TKey, TValue, THash>::SetCapacity(int value)
+{
+	int capacity = MinCapacity;
+	while ((capacity * MaxLoad) / 8 < value)
+	{
+		capacity <<= 1;
+	}
+
+	if (capacity > _capacity)
+	{
+		Rehash(capacity);
+	}
+}
+
+template <class TKey, class TValue, class THash>
+void Hashtable<TKey, TValue, THash>::Clear()
+{
+	for (int i = 0; i < _capacity; ++i)
+	{
+		if (_distances[i] != 0)
+		{
+			_slots[i].~Slot();
+			_distances[i] = 0;
+		}
+	}
+	_count = 0;
+}
+
+template <class TKey, class TValue, class THash>
+int Hashtable<TKey, TValue, THash>::Count() const
+{
+	return _count;
+}
+
+template <class TKey, class TValue, class THash>
+bool Hashtable<TKey, TValue, THash>::IsEmpty() const
+{
+	return _count == 0;
+}
+
+template <class TKey, class TValue, class THash>
+void Hashtable<TKey, TValue, THash>::Add(const TKey& key, const TValue& value)
+{
+	if (FindIndex(key) < 0)
+	{
+		InsertIndex(key, value);
+	}
+}
+
+template <class TKey, class TValue, class THash>
+void Hashtable<TKey, TValue, THash>::Remove(const TKey& key)
+{
+	int index = FindIndex(key);
+	if (index < 0)
+		return;
+
+	// Shift the following elements of the cluster back by one slot.
+	int mask = _capacity - 1;
+	int next = (index + 1) & mask;
+	while (_distances[next] > 1)
+	{
+		_slots[index] = _slots[next];
+		_distances[index] = _distances[next] - 1;
+		index = next;
+		next = (next + 1) & mask;
+	}
+
+	_slots[index].~Slot();
+	_distances[index] = 0;
+	_count--;
+}
+
+template <class TKey, class TValue, class THash>
+bool Hashtable<TKey, TValue, THash>::Contains(const TKey& key) const
+{
+	return FindIndex(key) >= 0;
+}
+
+template <class TKey, class TValue, class THash>
+bool Hashtable<TKey, TValue, THash>::ContainsKey(const TKey& key) const
+{
+	return FindIndex(key) >= 0;
+}
+
+template <class TKey, class TValue, class THash>
+TValue& Hashtable<TKey, TValue, THash>::GetItem(const TKey& key)
+{
+	int index = FindIndex(key);
+	if (index < 0)
+	{
+		SEthrow("ArgumentException");
+	}
+
+	return _slots[index].Value;
+}
+
+template <class TKey, class TValue, class THash>
+const TValue& Hashtable<TKey, TValue, THash>::GetItem(const TKey& key) const
+{
+	int index = FindIndex(key);
+	if (index < 0)
+	{
+		SEthrow("ArgumentException");
+	}
+
+	return _slots[index].Value;
+}
+
+template <class TKey, class TValue, class THash>
+void Hashtable<TKey, TValue, THash>::SetItem(const TKey& key, const TValue& value)
+{
+	int index = FindIndex(key);
+	if (index < 0)
+	{
+		InsertIndex(key, value);
+	}
+	else
+	{
+		_slots[index].Value = value;
+	}
+}
+
+template <class TKey, class TValue, class THash>
+BaseArray<TKey> Hashtable<TKey, TValue, THash>::Keys() const
+{
+	BaseArray<TKey> values;
+	values.SetCapacity(_count);
+
+	for (int i = 0; i < _capacity; ++i)
+	{
+		if (_distances[i] != 0)
+			values.Add(_slots[i].Key);
+	}
+
+	return values;
+}
+
+template <class TKey, class TValue, class THash>
+BaseArray<TValue> Hashtable<TKey, TValue, THash>::Values() const
+{
+	BaseArray<TValue> values;
+	values.SetCapacity(_count);
+
+	for (int i = 0; i < _capacity; ++i)
+	{
+		if (_distances[i] != 0)
+			values.Add(_slots[i].Value);
+	}
+
+	return values;
+}
+
+template <class TKey, class TValue, class THash>
+TValue* Hashtable<TKey, TValue, THash>::Find(const TKey& key)
+{
+	int index = FindIndex(key);
+	return (index < 0 ? NULL : &_slots[index].Value);
+}
+
+template <class TKey, class TValue, class THash>
+const TValue* Hashtable<TKey, TValue, THash>::Find(const TKey& key) const
+{
+	int index = FindIndex(key);
+	return (index < 0 ? NULL : &_slots[index].Value);
+}
+
+template <class TKey, class TValue, class THash>
+bool Hashtable<TKey, TValue, THash>::TryGetValue(const TKey& key, TValue& value) const
+{
+	int index = FindIndex(key);
+	if (index < 0)
+		return false;
+
+	value = _slots[index].Value;
+	return true;
+}
+
+template <class TKey, class TValue, class THash>
+int Hashtable<TKey, TValue, THash>::FindIndex(const TKey& key) const
+{
+	if (_count == 0)
+		return -1;
+
+	int mask = _capacity - 1;
+	int index = _hash(key) & mask;
+	int distance = 1;
+
+	// An element further from its home slot than the key would be means
+	// the key would have taken its slot, so the search can stop there.
+	while (distance <= _distances[index])
+	{
+		if (distance == _distances[index] && _slots[index].Key == key)
+		{
+			return index;
+		}
+
+		index = (index + 1) & mask;
+		distance++;
+	}
+
+	return -1;
+}
+
+template <class TKey, class TValue, class THash>
+int Hashtable<TKey, TValue, THash>::InsertIndex(const TKey& key, const TValue& value)
+{
+	if ((_count + 1) * 8 > _capacity * MaxLoad)
+	{
+		Rehash(_capacity < MinCapacity ? MinCapacity : _capacity * 2);
+	}
+
+	int mask = _capacity - 1;
+	int index = _hash(key) & mask;
+	int distance = 1;
+	int result = -1;
+
+	TKey currentKey = key;
+	TValue currentValue = value;
+
+	while (true)
+	{
+		if (_distances[index] == 0)
+		{
+			new (&_slots[index]) Slot(currentKey, currentValue);
+			_distances[index] = (uint16)distance;
+			_count++;
+			return (result < 0 ? index : result);
+		}
+
+		// Take the slot of an element that is closer to its home slot
+		// and carry on inserting that element instead.
+		if (_distances[index] < distance)
+		{
+			SE_Swap(currentKey, _slots[index].Key);
+			SE_Swap(currentValue, _slots[index].Value);
+			uint16 swapped = _distances[index];
+			_distances[index] = (uint16)distance;
+			distance = swapped;
+
+			if (result < 0)
+				result = index;
+		}
+
+		index = (index + 1) & mask;
+		distance++;
+
+		if (distance == MaxDistance)
+		{
+			// Pathological clustering, grow the table and start over with
+			// the element being carried.
+			Rehash(_capacity * 2);
+			InsertIndex(currentKey, currentValue);
+			return FindIndex(key);
+		}
+	}
+}
+
+template <class TKey, class TValue, class THash>
+void Hashtable<TKey, TValue, THash>::Rehash(int capacity)
+{
+	Slot* slots = _slots;
+	uint16* distances = _distances;
+	int oldCapacity = _capacity;
+
+	_slots = (Slot*)Memory::Alloc(capacity * sizeof(Slot));
+	_distances = (uint16*)Memory::Calloc(capacity, sizeof(uint16));
+	_capacity = capacity;
+	_count = 0;
+
+	for (int i = 0; i < oldCapacity; ++i)
+	{
+		if (distances[i] != 0)
+		{
+			InsertIndex(slots[i].Key, slots[i].Value);
+			slots[i].~Slot();
+		}
+	}
+
+	if (slots != NULL)
+	{
+		Memory::Free(slots);
+		Memory::Free(distances);
+	}
+}
+
+template <class TKey, class TValue, class THash>
+void Hashtable<TKey, TValue, THash>::Destroy()
+{
+	Clear();
+	if (_slots != NULL)
+	{
+		Memory::Free(_slots);
+		Memory::Free(_distances);
+	}
+	_slots = NULL;
+	_distances = NULL;
+	_capacity = 0;
+}
@@ -8,6 +8,7 @@ Author: Julien Delezenne
 #define _SE_IDICTIONARYITERATOR_H_
 
 #include "Core/Common.h"
+#include "Core/Containers/IIterator.h"
 
 namespace SonataEngine
 {
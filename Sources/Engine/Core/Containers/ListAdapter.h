@@ -0,0 +1,68 @@
+/*=============================================================================
+ListAdapter.h
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+#ifndef _SE_LISTADAPTER_H_
+#define _SE_LISTADAPTER_H_
+
+#include "Core/Common.h"
+#include "Core/Containers/IList.h"
+#include "Core/Containers/BaseArray.h"
+
+namespace SonataEngine
+{
+
+/**
+	@brief Exposes an array through the IList interface.
+
+	The arrays don't implement IList so their methods can be inlined.
+	Use this adapter to pass an array to a code expecting a polymorphic list.
+	The adapter doesn't own the array.
+*/
+template <class T, class TArray = BaseArray<T> >
+class ListAdapter : public IList<T>
+{
+protected:
+	TArray* _array;
+
+public:
+	ListAdapter(TArray* array);
+	virtual ~ListAdapter();
+
+	/** Gets the adapted array. */
+	TArray* GetArray() const;
+
+	virtual T& operator[](int index);
+	virtual const T& operator[](int index) const;
+
+	virtual int Count() const;
+
+	virtual bool IsEmpty() const;
+
+	virtual void Clear();
+
+	virtual void Add(const T& value);
+
+	virtual void Insert(int index, const T& value);
+
+	virtual void Remove(const T& value);
+
+	virtual void RemoveAt(int index);
+
+	virtual bool Contains(const T& value) const;
+
+	virtual int IndexOf(const T& value) const;
+
+	virtual T& GetItem(int index);
+	virtual const T& GetItem(int index) const;
+
+	virtual void SetItem(int index, const T& value);
+};
+
+#include "ListAdapter.inl"
+
+}
+
+#endif
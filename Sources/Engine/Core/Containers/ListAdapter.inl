@@ -0,0 +1,107 @@
+/*=============================================================================
+ListAdapter.inl
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+template <class T, class TArray>
+ListAdapter<T, TArray>::ListAdapter(TArray* array) :
+	_array(array)
+{
+	SE_ASSERT(array != NULL);
+}
+
+template <class T, class TArray>
+ListAdapter<T, TArray>::~ListAdapter()
+{
+}
+
+template <class T, class TArray>
+TArray* ListAdapter<T, TArray>::GetArray() const
+{
+	return _array;
+}
+
+template <class T, class TArray>
+T& ListAdapter<T, TArray>::operator[](int index)
+{
+	return (*_array)[index];
+}
+
+template <class T, class TArray>
+const T& ListAdapter<T, TArray>::operator[](int index) const
+{
+	return (*_array)[index];
+}
+
+template <class T, class TArray>
+int ListAdapter<T, TArray>::Count() const
+{
+	return _array->Count();
+}
+
+template <class T, class TArray>
+bool ListAdapter<T, TArray>::IsEmpty() const
+{
+	return _array->IsEmpty();
+}
+
+template <class T, class TArray>
+void ListAdapter<T, TArray>::Clear()
+{
+	_array->Clear();
+}
+
+template <class T, class TArray>
+void ListAdapter<T, TArray>::Add(const T& value)
+{
+	_array->Add(value);
+}
+
+template <class T, class TArray>
+void ListAdapter<T, TArray>::Insert(int index, const T& value)
+{
+	_array->Insert(index, value);
+}
+
+template <class T, class TArray>
+void ListAdapter<T, TArray>::Remove(const T& value)
+{
+	_array->Remove(value);
+}
+
+template <class T, class TArray>
+void ListAdapter<T, TArray>::RemoveAt(int index)
+{
+	_array->RemoveAt(index);
+}
+
+template <class T, class TArray>
+bool ListAdapter<T, TArray>::Contains(const T& value) const
+{
+	return _array->Contains(value);
+}
+
+template <class T, class TArray>
+int ListAdapter<T, TArray>::IndexOf(const T& value) const
+{
+	return _array->IndexOf(value);
+}
+
+template <class T, class TArray>
+T& ListAdapter<T, TArray>::GetItem(int index)
+{
+	return _array->GetItem(index);
+}
+
+template <class T, class TArray>
+const T& ListAdapter<T, TArray>::GetItem(int index) const
+{
+	return _array->GetItem(index);
+}
+
+template <class T, class TArray>
+void ListAdapter<T, TArray>::SetItem(int index, const T& value)
+{
+	_array->SetItem(index, value);
+}
@@ -35,8 +35,10 @@ Author: Julien Delezenne
 #include "Core/Containers/BaseList.h"
 #include "Core/Containers/Dictionary.h"
 #include "Core/Containers/Graph.h"
+#include "Core/Containers/Hash.h"
 #include "Core/Containers/Hashtable.h"
 #include "Core/Containers/List.h"
+#include "Core/Containers/ListAdapter.h"
 #include "Core/Containers/PriorityQueue.h"
 #include "Core/Containers/Queue.h"
 #include "Core/Containers/Stack.h"
@@ -75,6 +77,7 @@ Author: Julien Delezenne
 #include "Core/IO/FileStream.h"
 #include "Core/IO/FileSystem.h"
 #include "Core/IO/IOException.h"
+#include "Core/IO/MappedFileStream.h"
 #include "Core/IO/MemoryStream.h"
 #include "Core/IO/Path.h"
 #include "Core/IO/Stream.h"
@@ -91,9 +94,11 @@ Author: Julien Delezenne
 
 // Math
 #include "Core/Math/AABB.h"
+#include "Core/Math/AABBTree.h"
 #include "Core/Math/AxisAngle.h"
 #include "Core/Math/BoundingBox.h"
 #include "Core/Math/BoundingSphere.h"
+#include "Core/Math/BoundsArray.h"
 #include "Core/Math/Capsule.h"
 #include "Core/Math/Complex.h"
 #include "Core/Math/Cylinder.h"
@@ -139,11 +144,15 @@ Author: Julien Delezenne
 #include "Core/Serialization/XMLSerializer.h"
 
 // System
+#include "Core/System/Allocator.h"
 #include "Core/System/Console.h"
 #include "Core/System/DateTime.h"
 #include "Core/System/Environment.h"
+#include "Core/System/FrameArena.h"
 #include "Core/System/Library.h"
 #include "Core/System/Memory.h"
+#include "Core/System/MemoryTracker.h"
+#include "Core/System/PoolAllocator.h"
 #include "Core/System/Timer.h"
 #include "Core/System/TimeValue.h"
 #include "Core/System/Window.h"
@@ -157,6 +166,7 @@ Author: Julien Delezenne
 
 // Threading
 #include "Core/Threading/Threading.h"
+#include "Core/Threading/JobScheduler.h"
 
 // Types
 #include "Core/Char.h"
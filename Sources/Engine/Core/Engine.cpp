@@ -24,6 +24,8 @@ namespace
 			SE_REFLECTION_PRIMITIVE(byte);
 			SE_REFLECTION_PRIMITIVE(uint8);
 			SE_REFLECTION_PRIMITIVE(int8);
+			SE_REFLECTION_PRIMITIVE(uint16);
+			SE_REFLECTION_PRIMITIVE(int16);
 			SE_REFLECTION_PRIMITIVE(uint32);
 			SE_REFLECTION_PRIMITIVE(int32);
 			SE_REFLECTION_PRIMITIVE(uint64);
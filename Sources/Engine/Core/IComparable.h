@@ -32,7 +32,7 @@ public:
 	};
 
 	/// Compares the current instance with another object of the same type.
-	virtual int CompareTo(const T value) const = 0;
+	virtual int CompareTo(const T& value) const = 0;
 };
 
 }
@@ -34,7 +34,7 @@ bool Archive::ExtractFile(const String& name, const String& destination)
 	}
 
 	// Check the length of the stream
-	int32 length = streamIn->GetLength();
+	int32 length = (int32)streamIn->GetLength();
 	if (length == 0)
 	{
 		SE_DELETE(streamIn);
@@ -8,208 +8,399 @@ Author: Julien Delezenne
 #include "Core/IO/IOException.h"
 #include "Core/Exception/ArgumentNullException.h"
 #include "Core/Exception/ArgumentOutOfRangeException.h"
+#include "Core/IO/MappedFileStream.h"
+#include "Core/IO/MemoryStream.h"
  
 namespace SonataEngine
 {
 
-BinaryStream::BinaryStream(Stream* stream)
+const int32 BinaryStream::DefaultBufferSize = 65536;
+
+BinaryStream::BinaryStream(Stream* stream) :
+	_stream(stream),
+	_bufferMode(BufferMode_None),
+	_buffer(NULL),
+	_bufferSize(0),
+	_span(false),
+	_spanStart(NULL),
+	_readCurrent(NULL),
+	_readEnd(NULL),
+	_writeCurrent(NULL),
+	_writeEnd(NULL)
+{
+	if (stream == NULL)
+	{
+		SEthrow(ArgumentNullException("stream", "stream is a null reference."));
+	}
+}
+
+BinaryStream::BinaryStream(Stream* stream, int32 bufferSize) :
+	_stream(stream),
+	_bufferMode(BufferMode_None),
+	_buffer(NULL),
+	_bufferSize(bufferSize),
+	_span(false),
+	_spanStart(NULL),
+	_readCurrent(NULL),
+	_readEnd(NULL),
+	_writeCurrent(NULL),
+	_writeEnd(NULL)
 {
 	if (stream == NULL)
 	{
 		SEthrow(ArgumentNullException("stream", "stream is a null reference."));
 	}
 
-	_stream = stream;
+	if (bufferSize <= 0)
+	{
+		SEthrow(ArgumentOutOfRangeException("bufferSize"));
+	}
 }
 
 BinaryStream::~BinaryStream()
 {
+	if (_stream != NULL)
+	{
+		Flush();
+	}
+
+	SE_DELETE_ARRAY(_buffer);
 }
 
 void BinaryStream::Close()
 {
+	Flush();
 	_stream->Close();
 }
 
-SEbyte BinaryStream::Peek()
+void BinaryStream::Flush()
 {
-	if (!_stream->CanRead() || !_stream->CanSeek())
-		SEthrow(IOException("The stream must be readable and seekable."));
+	if (_bufferMode == BufferMode_Write)
+	{
+		int32 count = (int32)(_writeCurrent - _buffer);
+		if (count > 0)
+		{
+			_stream->Write(_buffer, count);
+		}
+	}
+	else if (_bufferMode == BufferMode_Read)
+	{
+		if (_span)
+		{
+			_stream->SetPosition((int64)(_readCurrent - _spanStart));
+		}
+		else if (_readEnd != _readCurrent && _stream->CanSeek())
+		{
+			_stream->Seek(-(int64)(_readEnd - _readCurrent), SeekOrigin_Current);
+		}
+	}
 
-	SEbyte value;
-	value = _stream->ReadByte();
-	_stream->SetPosition(_stream->GetPosition() - 1);
-	return value;
+	_bufferMode = BufferMode_None;
+	_span = false;
+	_spanStart = NULL;
+	_readCurrent = _readEnd = NULL;
+	_writeCurrent = _writeEnd = NULL;
 }
 
-SEbyte BinaryStream::Read()
+void BinaryStream::BeginRead()
 {
 	if (!_stream->CanRead())
 		SEthrow(IOException("The stream must be readable."));
 
-	SEbyte value;
-	value = _stream->ReadByte();
-	return value;
-}
+	if (_bufferMode == BufferMode_Read || !IsBuffered())
+		return;
 
-int8 BinaryStream::ReadInt8()
-{
-	int8 value;
-	Read((SEbyte*)&value, sizeof(int8));
-	return value;
-}
+	Flush();
+	_bufferMode = BufferMode_Read;
 
-uint8 BinaryStream::ReadUInt8()
-{
-	uint8 value;
-	Read((SEbyte*)&value, sizeof(uint8));
-	return value;
-}
+	// Read the memory of a memory stream or a mapped file in place
+	const SEbyte* data = NULL;
+	if (_stream->GetStreamType() == StreamType_Memory)
+	{
+		data = ((MemoryStream*)_stream)->GetBuffer();
+	}
+	else if (_stream->GetStreamType() == StreamType_MappedFile)
+	{
+		data = ((MappedFileStream*)_stream)->GetSpan(0, 0);
+	}
 
-int16 BinaryStream::ReadInt16()
-{
-	int16 value;
-	Read((SEbyte*)&value, sizeof(int16));
-	return value;
+	if (data != NULL)
+	{
+		int64 position = _stream->GetPosition();
+		int64 length = _stream->GetLength();
+		if (position <= length)
+		{
+			_span = true;
+			_spanStart = data;
+			_readCurrent = data + position;
+			_readEnd = data + length;
+		}
+	}
 }
 
-uint16 BinaryStream::ReadUInt16()
+void BinaryStream::BeginWrite()
 {
-	uint16 value;
-	Read((SEbyte*)&value, sizeof(uint16));
-	return value;
-}
+	if (!_stream->CanWrite())
+		SEthrow(IOException("The stream must be writable."));
 
-int32 BinaryStream::ReadInt32()
-{
-	int32 value;
-	Read((SEbyte*)&value, sizeof(int32));
-	return value;
-}
+	if (_bufferMode == BufferMode_Write || !IsBuffered())
+		return;
 
-uint32 BinaryStream::ReadUInt32()
-{
-	uint32 value;
-	Read((SEbyte*)&value, sizeof(uint32));
-	return value;
-}
+	Flush();
+	_bufferMode = BufferMode_Write;
 
-int64 BinaryStream::ReadInt64()
-{
-	int64 value;
-	Read((SEbyte*)&value, sizeof(int64));
-	return value;
+	if (_buffer == NULL)
+	{
+		_buffer = new SEbyte[_bufferSize];
+	}
+	_writeCurrent = _buffer;
+	_writeEnd = _buffer + _bufferSize;
 }
 
-uint64 BinaryStream::ReadUInt64()
+bool BinaryStream::FillBuffer()
 {
-	uint64 value;
-	Read((SEbyte*)&value, sizeof(uint64));
-	return value;
+	if (_span)
+		return false;
+
+	if (_buffer == NULL)
+	{
+		_buffer = new SEbyte[_bufferSize];
+	}
+
+	int32 count = _stream->Read(_buffer, _bufferSize);
+	if (count <= 0)
+	{
+		_readCurrent = _readEnd = _buffer;
+		return false;
+	}
+
+	_readCurrent = _buffer;
+	_readEnd = _buffer + count;
+	return true;
 }
 
-real32 BinaryStream::ReadReal32()
+int32 BinaryStream::ReadBytes(SEbyte* buffer, int32 count)
 {
-	real32 value;
-	Read((SEbyte*)&value, sizeof(real32));
-	return value;
+	BeginRead();
+
+	int32 total = 0;
+	if (!IsBuffered())
+	{
+		total = _stream->Read(buffer, count);
+		if (total < 0)
+		{
+			total = 0;
+		}
+	}
+	else
+	{
+		while (total < count)
+		{
+			int64 available = _readEnd - _readCurrent;
+			if (available > 0)
+			{
+				int32 size = (available < count - total ? (int32)available : count - total);
+				memcpy(buffer + total, _readCurrent, size);
+				_readCurrent += size;
+				total += size;
+			}
+			else if (!_span && count - total >= _bufferSize)
+			{
+				// Large reads skip the buffer
+				int32 size = _stream->Read(buffer + total, count - total);
+				if (size <= 0)
+					break;
+				total += size;
+			}
+			else if (!FillBuffer())
+			{
+				break;
+			}
+		}
+	}
+
+	if (total < count)
+	{
+		memset(buffer + total, 0, count - total);
+	}
+	return total;
 }
 
-real64 BinaryStream::ReadReal64()
+void BinaryStream::WriteBytes(const SEbyte* buffer, int32 count)
 {
-	real64 value;
-	Read((SEbyte*)&value, sizeof(real64));
-	return value;
+	BeginWrite();
+
+	if (!IsBuffered())
+	{
+		_stream->Write(buffer, count);
+		return;
+	}
+
+	if (_writeEnd - _writeCurrent < count)
+	{
+		int32 size = (int32)(_writeCurrent - _buffer);
+		if (size > 0)
+		{
+			_stream->Write(_buffer, size);
+		}
+		_writeCurrent = _buffer;
+	}
+
+	if (count >= _bufferSize)
+	{
+		// Large writes skip the buffer
+		_stream->Write(buffer, count);
+		return;
+	}
+
+	memcpy(_writeCurrent, buffer, count);
+	_writeCurrent += count;
 }
 
-String BinaryStream::ReadString()
+SEbyte BinaryStream::Peek()
 {
-	uint32 length;
-	SEchar* buffer;
+	if (IsBuffered())
+	{
+		BeginRead();
+		if (_readCurrent == _readEnd)
+		{
+			FillBuffer();
+		}
+		return (_readCurrent != _readEnd ? *_readCurrent : (SEbyte)-1);
+	}
 
-	length = ReadUInt32();
-	buffer = new SEchar[length+1];
-	Read((SEbyte*)buffer, length*sizeof(SEchar));
-	buffer[length] = _T('\0');
-	String str = buffer;
-	delete[] buffer;
-	return str;
+	if (!_stream->CanRead() || !_stream->CanSeek())
+		SEthrow(IOException("The stream must be readable and seekable."));
+
+	SEbyte value;
+	value = _stream->ReadByte();
+	_stream->SetPosition(_stream->GetPosition() - 1);
+	return value;
 }
 
-int32 BinaryStream::Read(SEbyte* buffer, int32 count)
+SEbyte BinaryStream::Read()
 {
+	if (IsBuffered())
+	{
+		return ReadUInt8();
+	}
+
 	if (!_stream->CanRead())
 		SEthrow(IOException("The stream must be readable."));
 
-	return _stream->Read(buffer, count);
+	SEbyte value;
+	value = _stream->ReadByte();
+	return value;
 }
 
-void BinaryStream::Write(SEbyte value)
+int64 BinaryStream::GetRemainingLength() const
 {
-	if (!_stream->CanWrite())
-		SEthrow(IOException("The stream must be writable."));
+	int64 length = 0;
+	if (_bufferMode == BufferMode_Read)
+	{
+		length = (int64)(_readEnd - _readCurrent);
+		if (_span)
+			return length;
+	}
 
-	_stream->WriteByte(value);
-}
+	if (!_stream->CanSeek())
+		return -1;
 
-void BinaryStream::WriteInt8(int8 value)
-{
-	Write((SEbyte*)&value, sizeof(int8));
+	return length + _stream->GetLength() - _stream->GetPosition();
 }
 
-void BinaryStream::WriteUInt8(uint8 value)
+String BinaryStream::ReadString()
 {
-	Write((SEbyte*)&value, sizeof(uint8));
-}
+	uint32 length = ReadUInt32();
 
-void BinaryStream::WriteInt16(int16 value)
-{
-	Write((SEbyte*)&value, sizeof(int16));
-}
+	// A corrupted length must not allocate more than the stream holds,
+	// the stream is only queried when the buffer doesn't hold the string
+	uint64 size = (uint64)length * sizeof(SEchar);
+	if (_bufferMode != BufferMode_Read || size > (uint64)(_readEnd - _readCurrent))
+	{
+		int64 remaining = GetRemainingLength();
+		if (size > (uint64)(remaining < 0 ? 0x7FFFFFFF : remaining))
+			SEthrow(IOException("The string length exceeds the stream length."));
+	}
 
-void BinaryStream::WriteUInt16(uint16 value)
-{
-	Write((SEbyte*)&value, sizeof(uint16));
+	// The storage of the previous strings is reused
+	_chars.Resize(length + 1);
+	SEchar* buffer = _chars.Data();
+	ReadBytes((SEbyte*)buffer, length * sizeof(SEchar));
+	if (sizeof(SEchar) > 1 && IsSwapped())
+	{
+		Environment::SwapEndian((SEbyte*)buffer, sizeof(SEchar), length);
+	}
+	buffer[length] = _T('\0');
+	return String(buffer);
 }
 
-void BinaryStream::WriteInt32(int32 value)
+int32 BinaryStream::Read(SEbyte* buffer, int32 count)
 {
-	Write((SEbyte*)&value, sizeof(int32));
-}
+	if (IsBuffered())
+	{
+		// The window may hold the bytes
+		if (_readEnd - _readCurrent >= count)
+		{
+			memcpy(buffer, _readCurrent, count);
+			_readCurrent += count;
+			return count;
+		}
+		return ReadBytes(buffer, count);
+	}
 
-void BinaryStream::WriteUInt32(uint32 value)
-{
-	Write((SEbyte*)&value, sizeof(uint32));
-}
+	if (!_stream->CanRead())
+		SEthrow(IOException("The stream must be readable."));
 
-void BinaryStream::WriteInt64(int64 value)
-{
-	Write((SEbyte*)&value, sizeof(int64));
+	return _stream->Read(buffer, count);
 }
 
-void BinaryStream::WriteUInt64(uint64 value)
+void BinaryStream::Write(SEbyte value)
 {
-	Write((SEbyte*)&value, sizeof(uint64));
-}
+	if (IsBuffered())
+	{
+		WriteUInt8(value);
+		return;
+	}
 
-void BinaryStream::WriteReal32(real32 value)
-{
-	Write((SEbyte*)&value, sizeof(real32));
-}
+	if (!_stream->CanWrite())
+		SEthrow(IOException("The stream must be writable."));
 
-void BinaryStream::WriteReal64(real64 value)
-{
-	Write((SEbyte*)&value, sizeof(real64));
+	_stream->WriteByte(value);
 }
 
 void BinaryStream::WriteString(const String& value)
 {
-	WriteUInt32(value.Length());
-	Write((SEbyte*)value.Data(), value.Length()*sizeof(SEchar));
+	int32 length = value.Length();
+	WriteUInt32(length);
+
+	if (sizeof(SEchar) > 1 && IsSwapped())
+	{
+		_chars.Resize(length + 1);
+		memcpy(_chars.Data(), value.Data(), length * sizeof(SEchar));
+		Environment::SwapEndian((SEbyte*)_chars.Data(), sizeof(SEchar), length);
+		WriteBytes((const SEbyte*)_chars.Data(), length * sizeof(SEchar));
+	}
+	else
+	{
+		WriteBytes((const SEbyte*)value.Data(), length * sizeof(SEchar));
+	}
 }
 
 void BinaryStream::Write(SEbyte* buffer, int32 count)
 {
+	if (IsBuffered())
+	{
+		if (_writeEnd - _writeCurrent >= count)
+		{
+			memcpy(_writeCurrent, buffer, count);
+			_writeCurrent += count;
+			return;
+		}
+		WriteBytes(buffer, count);
+		return;
+	}
+
 	if (!_stream->CanWrite())
 		SEthrow(IOException("The stream must be writable."));
 
@@ -8,7 +8,11 @@ Author: Julien Delezenne
 #define _SE_BINARYSTREAM_H_
 
 #include "Core/Common.h"
+#include "Core/Containers/BaseArray.h"
 #include "Core/IO/Stream.h"
+#include "Core/System/Environment.h"
+
+#include <string.h>
 
 namespace SonataEngine
 {
@@ -19,12 +23,49 @@ class File;
 	@brief Binary stream.
 
 	This class can stream data types.
+	The values are read and written in the byte order of the source stream.
+
+	A buffered binary stream reads the source stream by windows of its
+	buffer size, or directly from the memory of a memory stream exposing
+	its buffer or of a memory-mapped file. It writes the source stream
+	when its buffer is full. The values are then decoded from the buffer
+	without calling the source stream. The source stream must not be used
+	directly before calling Flush.
 	@see Stream TextStream.
 */
 class SE_CORE_EXPORT BinaryStream
 {
-private:
+public:
+	/** Default size of the buffer of a buffered binary stream, in bytes. */
+	static const int32 DefaultBufferSize;
+
+protected:
+	enum BufferMode
+	{
+		BufferMode_None,
+		BufferMode_Read,
+		BufferMode_Write
+	};
+
 	Stream* _stream;
+	BufferMode _bufferMode;
+	SEbyte* _buffer;
+	int32 _bufferSize;
+
+	/// Whether the read window is the memory of a memory stream or a mapped file.
+	bool _span;
+	const SEbyte* _spanStart;
+
+	/// Bytes read from the source stream and not decoded yet.
+	const SEbyte* _readCurrent;
+	const SEbyte* _readEnd;
+
+	/// Free space of the buffer for the written bytes.
+	SEbyte* _writeCurrent;
+	SEbyte* _writeEnd;
+
+	/// Storage of the strings, reused by each string.
+	BaseArray<SEchar> _chars;
 
 public:
 	/** @name Constructors / Destructor. */
@@ -34,7 +75,15 @@ public:
 	*/
 	BinaryStream(Stream* stream);
 
-	/** Destructor. */
+	/** Constructor of a buffered binary stream.
+		@param stream The source steam.
+		@param bufferSize The size of the buffer in bytes.
+	*/
+	BinaryStream(Stream* stream, int32 bufferSize);
+
+	/** Destructor.
+		The buffered data is flushed to the source stream.
+	*/
 	virtual ~BinaryStream();
 	//@}
 
@@ -42,26 +91,38 @@ public:
 	/** Returns the source stream. */
 	Stream* GetStream() const { return _stream; }
 
+	/** Returns whether the binary stream is buffered. */
+	bool IsBuffered() const { return (_bufferSize > 0); }
+
 	/** Closes the stream. */
 	virtual void Close();
 
+	/**
+		Writes the buffered data to the source stream and moves the source
+		stream to the position of the binary stream.
+		@remarks
+			The bytes read ahead are given back with a seek, the source stream
+			must be seekable to be used directly after reading.
+	*/
+	void Flush();
+
 	/** Returns the next available byte from the stream if seeking is possible. */
 	virtual SEbyte Peek();
 
 	/** Reads the next byte from the stream. */
 	virtual SEbyte Read();
 
-	virtual int8 ReadInt8();
-	virtual uint8 ReadUInt8();
-	virtual int16 ReadInt16();
-	virtual uint16 ReadUInt16();
-	virtual int32 ReadInt32();
-	virtual uint32 ReadUInt32();
-	virtual int64 ReadInt64();
-	virtual uint64 ReadUInt64();
-	virtual real32 ReadReal32();
-	virtual real64 ReadReal64();
-	virtual String ReadString();
+	int8 ReadInt8() { return ReadValue<int8>(); }
+	uint8 ReadUInt8() { return ReadValue<uint8>(); }
+	int16 ReadInt16() { return ReadValue<int16>(); }
+	uint16 ReadUInt16() { return ReadValue<uint16>(); }
+	int32 ReadInt32() { return ReadValue<int32>(); }
+	uint32 ReadUInt32() { return ReadValue<uint32>(); }
+	int64 ReadInt64() { return ReadValue<int64>(); }
+	uint64 ReadUInt64() { return ReadValue<uint64>(); }
+	real32 ReadReal32() { return ReadValue<real32>(); }
+	real64 ReadReal64() { return ReadValue<real64>(); }
+	String ReadString();
 
 	/** Reads the next set of bytes from the stream. */
 	virtual int Read(SEbyte* buffer, int32 count);
@@ -69,22 +130,57 @@ public:
 	/** Writes a byte to the text stream. */
 	virtual void Write(SEbyte value);
 
-	virtual void WriteInt8(int8 value);
-	virtual void WriteUInt8(uint8 value);
-	virtual void WriteInt16(int16 value);
-	virtual void WriteUInt16(uint16 value);
-	virtual void WriteInt32(int32 value);
-	virtual void WriteUInt32(uint32 value);
-	virtual void WriteInt64(int64 value);
-	virtual void WriteUInt64(uint64 value);
-	virtual void WriteReal32(real32 value);
-	virtual void WriteReal64(real64 value);
-	virtual void WriteString(const String& value);
+	void WriteInt8(int8 value) { WriteValue(value); }
+	void WriteUInt8(uint8 value) { WriteValue(value); }
+	void WriteInt16(int16 value) { WriteValue(value); }
+	void WriteUInt16(uint16 value) { WriteValue(value); }
+	void WriteInt32(int32 value) { WriteValue(value); }
+	void WriteUInt32(uint32 value) { WriteValue(value); }
+	void WriteInt64(int64 value) { WriteValue(value); }
+	void WriteUInt64(uint64 value) { WriteValue(value); }
+	void WriteReal32(real32 value) { WriteValue(value); }
+	void WriteReal64(real64 value) { WriteValue(value); }
+	void WriteString(const String& value);
 
 	/** Writes an array of bytes to the stream. */
 	virtual void Write(SEbyte* buffer, int32 count);
+
+protected:
+	/** Whether the bytes of the values are swapped to the byte order of the source stream. */
+	bool IsSwapped() const { return (_stream->GetByteOrder() != SE_ENDIAN); }
+
+	/** Reads a value from the buffer, or from the source stream when the buffer is empty. */
+	template <class T>
+	T ReadValue();
+
+	/** Writes a value to the buffer, or to the source stream when the buffer is full. */
+	template <class T>
+	void WriteValue(T value);
+
+	/**
+		Reads bytes when the read window does not hold them.
+		The bytes after the end of the stream are zeroed.
+		@return The number of bytes read.
+	*/
+	int32 ReadBytes(SEbyte* buffer, int32 count);
+
+	/** Writes bytes when the buffer cannot hold them. */
+	void WriteBytes(const SEbyte* buffer, int32 count);
+
+	/** Returns the number of bytes left to read, or -1 if the source stream is not seekable. */
+	int64 GetRemainingLength() const;
+
+	void BeginRead();
+	void BeginWrite();
+	bool FillBuffer();
+
+private:
+	BinaryStream(const BinaryStream&);
+	BinaryStream& operator=(const BinaryStream&);
 };
 
+#include "BinaryStream.inl"
+
 }
 
-#endif 
+#endif
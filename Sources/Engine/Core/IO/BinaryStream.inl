@@ -0,0 +1,45 @@
+/*=============================================================================
+BinaryStream.inl
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+template <class T>
+SE_INLINE T BinaryStream::ReadValue()
+{
+	T value;
+	if (_readEnd - _readCurrent >= (int32)sizeof(T))
+	{
+		memcpy(&value, _readCurrent, sizeof(T));
+		_readCurrent += sizeof(T);
+	}
+	else
+	{
+		ReadBytes((SEbyte*)&value, sizeof(T));
+	}
+
+	if (sizeof(T) > 1 && IsSwapped())
+	{
+		Environment::SwapEndian((SEbyte*)&value, sizeof(T));
+	}
+	return value;
+}
+
+template <class T>
+SE_INLINE void BinaryStream::WriteValue(T value)
+{
+	if (sizeof(T) > 1 && IsSwapped())
+	{
+		Environment::SwapEndian((SEbyte*)&value, sizeof(T));
+	}
+
+	if (_writeEnd - _writeCurrent >= (int32)sizeof(T))
+	{
+		memcpy(_writeCurrent, &value, sizeof(T));
+		_writeCurrent += sizeof(T);
+	}
+	else
+	{
+		WriteBytes((const SEbyte*)&value, sizeof(T));
+	}
+}
@@ -53,13 +53,13 @@ public:
 	virtual bool CanWrite() const;
 	virtual bool CanSeek() const;
 
-	virtual int32 GetLength() const;
-	virtual void SetLength(int32 value);
-	virtual int32 GetPosition() const;
-	virtual void SetPosition(int32 value);
+	virtual int64 GetLength() const;
+	virtual void SetLength(int64 value);
+	virtual int64 GetPosition() const;
+	virtual void SetPosition(int64 value);
 	virtual void Close();
 	virtual void Flush();
-	virtual int32 Seek(int32 offset, SeekOrigin origin);
+	virtual int64 Seek(int64 offset, SeekOrigin origin);
 	virtual bool IsEOF() const;
 	virtual SEbyte ReadByte();
 	virtual int32 Read(SEbyte* buffer, int32 count);
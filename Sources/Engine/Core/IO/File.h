@@ -87,7 +87,7 @@ public:
 		Gets the length of a file.
 		@return The length of a file.
 	*/
-	int32 GetLength() const;
+	int64 GetLength() const;
 
 	/**
 		Gets whether a file is opened.
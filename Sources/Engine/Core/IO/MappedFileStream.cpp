@@ -0,0 +1,145 @@
+/*=============================================================================
+MappedFileStream.cpp
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+#include "MappedFileStream.h"
+#include "Core/System/Memory.h"
+#include "Core/IO/IOException.h"
+#include "Core/Exception/ArgumentNullException.h"
+#include "Core/Exception/ArgumentOutOfRangeException.h"
+
+namespace SonataEngine
+{
+
+const SEbyte* MappedFileStream::GetSpan(int64 offset, int64 length) const
+{
+	if (offset < 0 || length < 0 || offset + length > _length)
+		return NULL;
+
+	return _data + offset;
+}
+
+SEbyte* MappedFileStream::GetWritableSpan(int64 offset, int64 length)
+{
+	if (!_copyOnWrite)
+		return NULL;
+
+	return (SEbyte*)GetSpan(offset, length);
+}
+
+int64 MappedFileStream::GetLength() const
+{
+	return _length;
+}
+
+void MappedFileStream::SetLength(int64 value)
+{
+}
+
+int64 MappedFileStream::GetPosition() const
+{
+	return _position;
+}
+
+void MappedFileStream::SetPosition(int64 value)
+{
+	Seek(value, SeekOrigin_Begin);
+}
+
+void MappedFileStream::Flush()
+{
+}
+
+int64 MappedFileStream::Seek(int64 offset, SeekOrigin origin)
+{
+	if (!IsOpen())
+		return 0;
+
+	int64 position;
+	switch (origin)
+	{
+	case SeekOrigin_Begin:
+		position = offset;
+		break;
+
+	case SeekOrigin_Current:
+		position = _position + offset;
+		break;
+
+	case SeekOrigin_End:
+		position = _length + offset;
+		break;
+
+	default:
+		SEthrow(IOException("InvalidSeekOrigin"));
+		return 0;
+	}
+
+	if (position < 0)
+	{
+		SEthrow(IOException("SeekBeforeBegin"));
+		return 0;
+	}
+
+	_position = position;
+	return _position;
+}
+
+bool MappedFileStream::IsEOF() const
+{
+	return _position >= _length;
+}
+
+SEbyte MappedFileStream::ReadByte()
+{
+	if (_position >= _length)
+	{
+		return -1;
+	}
+
+	return _data[_position++];
+}
+
+int32 MappedFileStream::Read(SEbyte* buffer, int32 count)
+{
+	if (buffer == NULL)
+	{
+		SEthrow(ArgumentNullException("buffer"));
+		return 0;
+	}
+
+	if (count < 0)
+	{
+		SEthrow(ArgumentOutOfRangeException("count"));
+		return 0;
+	}
+
+	if (_position >= _length)
+	{
+		return -1;
+	}
+
+	int64 size = _length - _position;
+	if (size > count)
+	{
+		size = count;
+	}
+
+	Memory::Copy(buffer, (void*)(_data + _position), (int32)size);
+
+	_position += size;
+	return (int32)size;
+}
+
+void MappedFileStream::WriteByte(SEbyte value)
+{
+}
+
+int32 MappedFileStream::Write(const SEbyte* buffer, int32 count)
+{
+	return -1;
+}
+
+}
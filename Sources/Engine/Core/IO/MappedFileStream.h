@@ -0,0 +1,164 @@
+/*=============================================================================
+MappedFileStream.h
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+#ifndef _SE_MAPPEDFILESTREAM_H_
+#define _SE_MAPPEDFILESTREAM_H_
+
+#include "Core/Common.h"
+#include "Core/IO/Stream.h"
+
+namespace SonataEngine
+{
+
+class MappedFileStreamInternal;
+
+/** Access pattern of a memory-mapped file. */
+enum MappedFileAccess
+{
+	/** No particular access pattern. */
+	MappedFileAccess_Normal,
+
+	/** The file is read once from the beginning to the end. */
+	MappedFileAccess_Sequential,
+
+	/**
+		The file is read at random offsets, the pages are not read ahead.
+		Each page is then loaded by a separate read of the device.
+	*/
+	MappedFileAccess_Random
+};
+
+/**
+	@class MappedFileStream.
+	@brief Provides read-only data streaming with memory-mapped files.
+
+	The file is mapped in memory when it is opened and its pages are loaded
+	by the system when they are first accessed. Read copies the bytes from
+	the mapped pages without calling the system, and GetSpan returns a
+	pointer to the mapped pages so a reader can parse the file in place.
+	The access pattern is given to the system to read the pages ahead or not.
+	A file mapped copy-on-write can be modified in memory: the pages written
+	are copied for the process and the file is never changed.
+	@remarks
+		The whole file is mapped, its size is limited by the address space
+		of the process. The gain comes from parsing the spans in place, a
+		file copied with Read is loaded faster by a file stream when it is
+		not in the system cache.
+	@see FileStream
+*/
+class SE_CORE_EXPORT MappedFileStream : public Stream
+{
+protected:
+	MappedFileStreamInternal* _internal;
+	String _fileName;
+	MappedFileAccess _access;
+	bool _copyOnWrite;
+	const SEbyte* _data;
+	int64 _length;
+	int64 _position;
+
+public:
+	/** @name Constructor / Destructor */
+	//@{
+	/** Constructor. */
+	MappedFileStream();
+
+	/**
+		Initializes a new instance of a memory-mapped file stream and opens a file.
+		@param fileName The name of the file.
+		@param access The access pattern of the file.
+		@param copyOnWrite Whether the mapped pages can be written.
+	*/
+	MappedFileStream(const String& fileName, MappedFileAccess access = MappedFileAccess_Normal, bool copyOnWrite = false);
+
+	/** Destructor. */
+	virtual ~MappedFileStream();
+	//@}
+
+	virtual StreamType GetStreamType() const { return StreamType_MappedFile; }
+
+	virtual bool CanRead() const { return IsOpen(); }
+	virtual bool CanWrite() const { return false; }
+	virtual bool CanSeek() const { return IsOpen(); }
+
+	/** @name Platform specific. */
+	//@{
+	/**
+		Opens a file and maps it in memory.
+		@param fileName The name of the file.
+		@param access The access pattern of the file.
+		@param copyOnWrite Whether the mapped pages can be written, the
+			writes being private to the process.
+		@return true if successful; otherwise, false.
+	*/
+	bool Open(const String& fileName, MappedFileAccess access = MappedFileAccess_Normal, bool copyOnWrite = false);
+
+	/** Returns whether a file is opened. */
+	bool IsOpen() const;
+
+	/**
+		Sets the access pattern of the file.
+		@remarks
+			The pages are read ahead for a sequential access, and only on demand
+			for a random access. On Windows the access pattern is only used
+			when the file is opened.
+	*/
+	void SetAccess(MappedFileAccess value);
+
+	virtual void Close();
+	//@}
+
+	/** Returns the access pattern of the file. */
+	MappedFileAccess GetAccess() const { return _access; }
+
+	/** Returns whether the file is mapped copy-on-write. */
+	bool IsCopyOnWrite() const { return _copyOnWrite; }
+
+	/**
+		Returns the file name of the file stream.
+		@return The file name of the file stream.
+	*/
+	String GetFileName() const { return _fileName; }
+
+	/**
+		Returns a pointer to the mapped bytes of a range of the file.
+		@param offset The offset of the range from the beginning of the file.
+		@param length The length of the range in bytes.
+		@return A pointer valid until the stream is closed, or NULL if the
+			range is not in the file.
+	*/
+	const SEbyte* GetSpan(int64 offset, int64 length) const;
+
+	/**
+		Returns a pointer to the mapped bytes of a range of the file, that
+		can be written when the file is mapped copy-on-write.
+		@return A pointer valid until the stream is closed, or NULL if the
+			range is not in the file or the file is mapped read-only.
+	*/
+	SEbyte* GetWritableSpan(int64 offset, int64 length);
+
+	virtual int64 GetLength() const;
+	virtual void SetLength(int64 value);
+	virtual int64 GetPosition() const;
+	virtual void SetPosition(int64 value);
+	virtual void Flush();
+	virtual int64 Seek(int64 offset, SeekOrigin origin);
+	virtual bool IsEOF() const;
+	virtual SEbyte ReadByte();
+	virtual int32 Read(SEbyte* buffer, int32 count);
+	virtual void WriteByte(SEbyte value);
+	virtual int32 Write(const SEbyte* buffer, int32 count);
+
+private:
+	MappedFileStream(const MappedFileStream&);
+	MappedFileStream& operator=(const MappedFileStream&);
+};
+
+typedef SmartPtr<MappedFileStream> MappedFileStreamPtr;
+
+}
+
+#endif
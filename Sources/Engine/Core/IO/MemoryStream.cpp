@@ -29,7 +29,7 @@ MemoryStream::MemoryStream(int32 capacity) :
 
 	Initialize();
 
-	_capacity = capacity;
+	SetCapacity(capacity);
 }
 
 MemoryStream::MemoryStream(SEbyte* buffer, int32 count, bool writable) :
@@ -91,6 +91,10 @@ MemoryStream::MemoryStream(SEbyte* buffer, int32 index, int32 count, bool writab
 
 MemoryStream::~MemoryStream()
 {
+	if (_expandable)
+	{
+		Memory::Free(_buffer);
+	}
 }
 
 void MemoryStream::Initialize()
@@ -121,7 +125,7 @@ bool MemoryStream::CanSeek() const
 	return _isOpen;
 }
 
-int32 MemoryStream::GetLength() const
+int64 MemoryStream::GetLength() const
 {
 	if (!_isOpen)
 		return 0;
@@ -129,7 +133,7 @@ int32 MemoryStream::GetLength() const
 	return _length;
 }
 
-void MemoryStream::SetLength(int32 value)
+void MemoryStream::SetLength(int64 value)
 {
 	if (!_isOpen)
 		return;
@@ -137,12 +141,21 @@ void MemoryStream::SetLength(int32 value)
 	if (!_writable)
 		return;
 
-	_length = value;
+	if (value < 0 || value > SE_MAX_I32)
+	{
+		SEthrow(ArgumentOutOfRangeException("value"));
+		return;
+	}
+
+	if (!EnsureCapacity((int32)value))
+		return;
+
+	_length = (int32)value;
 	if (_position > _length)
 		_position = _length;
 }
 
-int32 MemoryStream::GetPosition() const
+int64 MemoryStream::GetPosition() const
 {
 	if (!_isOpen)
 		return 0;
@@ -150,7 +163,7 @@ int32 MemoryStream::GetPosition() const
 	return _position;
 }
 
-void MemoryStream::SetPosition(int32 value)
+void MemoryStream::SetPosition(int64 value)
 {
 	Seek(value, SeekOrigin_Begin);
 }
@@ -165,22 +178,39 @@ int32 MemoryStream::GetCapacity() const
 
 void MemoryStream::SetCapacity(int32 value)
 {
-	if (!_isOpen)
+	// Only the streams owning their buffer can resize it
+	if (!_isOpen || !_expandable)
 		return;
 
-	if (value <= 0)
-	{
-		_buffer = NULL;
-		_capacity = 0;
-	}
-	else if (value < _capacity)
-	{
-		_capacity = value;
-	}
-	else if (value > _capacity)
+	if (value < _length)
+		value = _length;
+
+	if (value == _capacity)
+		return;
+
+	SEbyte* buffer = NULL;
+	if (value > 0)
 	{
-		_capacity = value;
+		buffer = (SEbyte*)Memory::Alloc(value);
+		if (_length > 0)
+			Memory::Copy(buffer, _buffer, _length);
 	}
+
+	Memory::Free(_buffer);
+	_buffer = buffer;
+	_capacity = value;
+}
+
+bool MemoryStream::EnsureCapacity(int32 value)
+{
+	if (value <= _capacity)
+		return true;
+
+	if (!_expandable)
+		return false;
+
+	SetCapacity(value < _capacity * 2 ? _capacity * 2 : value);
+	return true;
 }
 
 SEbyte* MemoryStream::GetBuffer() const
@@ -193,6 +223,11 @@ SEbyte* MemoryStream::GetBuffer() const
 
 void MemoryStream::Close()
 {
+	if (_expandable)
+	{
+		Memory::Free(_buffer);
+	}
+
 	Initialize();
 }
 
@@ -200,38 +235,24 @@ void MemoryStream::Flush()
 {
 }
 
-int32 MemoryStream::Seek(int32 offset, SeekOrigin origin)
+int64 MemoryStream::Seek(int64 offset, SeekOrigin origin)
 {
 	if (!_isOpen)
 		return 0;
 
+	int64 position;
 	switch (origin)
 	{
 	case SeekOrigin_Begin:
-		if (offset < 0)
-		{
-			SEthrow(IOException("SeekBeforeBegin"));
-			return 0;
-		}
-		_position = (_origin + offset);
+		position = (_origin + offset);
 		break;
 
 	case SeekOrigin_Current:
-		if ((_position + offset) < _origin)
-		{
-			SEthrow(IOException("SeekBeforeBegin"));
-			return 0;
-		}
-		_position += offset;
+		position = (_position + offset);
 		break;
 
 	case SeekOrigin_End:
-		if ((_length + offset) < _origin)
-		{
-			SEthrow(IOException("SeekBeforeBegin"));
-			return 0;
-		}
-		_position = (_length + offset);
+		position = (_length + offset);
 		break;
 
 	default:
@@ -239,6 +260,18 @@ int32 MemoryStream::Seek(int32 offset, SeekOrigin origin)
 		return 0;
 	}
 
+	if (position < _origin)
+	{
+		SEthrow(IOException("SeekBeforeBegin"));
+		return 0;
+	}
+	if (position > SE_MAX_I32)
+	{
+		SEthrow(IOException("SeekPastMaximum"));
+		return 0;
+	}
+
+	_position = (int32)position;
 	return _position;
 }
 
@@ -298,7 +331,7 @@ int32 MemoryStream::Read(SEbyte* buffer, int32 count)
 	Memory::Copy(buffer, _buffer + _position, size);
 
 	_position += size;
-	return _position;
+	return size;
 }
 
 void MemoryStream::WriteByte(SEbyte value)
@@ -309,18 +342,12 @@ void MemoryStream::WriteByte(SEbyte value)
 	if (!_writable)
 		return;
 
-	int32 size = _position + 1;
-	if (size >= _capacity)
-	{
-		if (size < _capacity * 2)
-			_capacity = _capacity * 2;
-		else
-			_capacity = size;
-
-		_length = size;
-	}
+	if (!EnsureCapacity(_position + 1))
+		return;
 
 	_buffer[_position++] = value;
+	if (_position > _length)
+		_length = _position;
 }
 
 int32 MemoryStream::Write(const SEbyte* buffer, int32 count)
@@ -343,26 +370,24 @@ int32 MemoryStream::Write(const SEbyte* buffer, int32 count)
 		return 0;
 	}
 
-	int32 size = (_position + count);
-	if (size > count)
+	// The streams wrapping a buffer write up to its end
+	int32 size = count;
+	if (!EnsureCapacity(_position + count))
 	{
-		size = count;
+		size = _capacity - _position;
 	}
 
-	if (size < 0)
+	if (size <= 0)
 	{
 		return 0;
 	}
 
-	if (_position >= _length)
-	{
-		return -1;
-	}
-
 	Memory::Copy(_buffer + _position, (void*)buffer, size);
 
 	_position += size;
-	return _position;
+	if (_position > _length)
+		_length = _position;
+	return size;
 }
 
 }
@@ -69,13 +69,13 @@ public:
 	virtual bool CanWrite() const;
 	virtual bool CanSeek() const;
 
-	virtual int32 GetLength() const;
-	virtual void SetLength(int32 value);
-	virtual int32 GetPosition() const;
-	virtual void SetPosition(int32 value);
+	virtual int64 GetLength() const;
+	virtual void SetLength(int64 value);
+	virtual int64 GetPosition() const;
+	virtual void SetPosition(int64 value);
 	virtual void Close();
 	virtual void Flush();
-	virtual int32 Seek(int32 offset, SeekOrigin origin);
+	virtual int64 Seek(int64 offset, SeekOrigin origin);
 	virtual bool IsEOF() const;
 	virtual SEbyte ReadByte();
 	virtual int32 Read(SEbyte* buffer, int32 count);
@@ -92,11 +92,17 @@ public:
 	*/
 	void SetCapacity(int32 value);
 
-	/// Returns the array of unsigned bytes from which this stream was created.
+	/** Returns the buffer of the stream.
+		@return The buffer allocated by the stream, or NULL when the stream
+		wraps an array of unsigned bytes.
+	*/
 	SEbyte* GetBuffer() const;
 
 private:
 	void Initialize();
+
+	/// Grows the buffer of an expandable stream, returns false if it can't hold the value.
+	bool EnsureCapacity(int32 value);
 };
 
 typedef SmartPtr<MemoryStream> MemoryStreamPtr;
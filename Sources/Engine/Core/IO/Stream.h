@@ -26,6 +26,9 @@ enum StreamType
 	/** File stream. */
 	StreamType_File,
 
+	/** Memory-mapped file stream. */
+	StreamType_MappedFile,
+
 	/** Network stream. */
 	StreamType_Network
 };
@@ -46,6 +49,10 @@ enum SeekOrigin
 /**
 	@class Stream.
 	@brief Base class for binary stream implementations.
+
+	The lengths, positions and offsets are 64-bit so that a stream can be
+	larger than 2 GB, the number of bytes of a single read or write is
+	32-bit.
 */
 class SE_CORE_EXPORT Stream : public RefCounter
 {
@@ -103,25 +110,25 @@ public:
 		Returns the length of the stream.
 		@return The length of the stream.
 	*/
-	virtual int32 GetLength() const = 0;
+	virtual int64 GetLength() const = 0;
 
 	/**
 		Sets the length of the stream.
 		@param value Length of the stream.
 	*/
-	virtual void SetLength(int32 value) = 0;
+	virtual void SetLength(int64 value) = 0;
 
 	/**
 		Returns the position within the stream.
 		@return The position within the stream.
 	*/
-	virtual int32 GetPosition() const = 0;
+	virtual int64 GetPosition() const = 0;
 
 	/**
 		Sets the position within the stream.
 		@param value Position within the stream.
 	*/
-	virtual void SetPosition(int32 value) = 0;
+	virtual void SetPosition(int64 value) = 0;
 
 	/** Closes the stream. */
 	virtual void Close() = 0;
@@ -135,7 +142,7 @@ public:
 		@param origin The origin of the new position.
 		@return The new position within the stream.
 	*/
-	virtual int32 Seek(int32 offset, SeekOrigin origin) = 0;
+	virtual int64 Seek(int64 offset, SeekOrigin origin) = 0;
 
 	/**
 		Returns whether the stream has reached the end position.
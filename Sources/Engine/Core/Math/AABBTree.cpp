@@ -0,0 +1,633 @@
+/*=============================================================================
+AABBTree.cpp
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+#include "AABBTree.h"
+#include "Core/System/Memory.h"
+
+namespace SonataEngine
+{
+
+const int32 AABBTree::NullProxy = -1;
+const real AABBTree::DefaultMargin = (real)0.2;
+
+/// Initial number of nodes in the buffer.
+static const int32 InitialNodeCapacity = 16;
+
+/// Factor of the displacement of a moving proxy added to its box.
+static const real DisplacementFactor = (real)2.0;
+
+/// Maximum depth of the traversals, the height of a balanced tree stays far below.
+static const int32 MaxStackSize = 256;
+
+/// Gets the surface area of a box, used as the cost of a node.
+static real _GetSurfaceArea(const AABB& box)
+{
+	Vector3 size = box.Max - box.Min;
+	return (real)2.0 * (size.X * size.Y + size.Y * size.Z + size.Z * size.X);
+}
+
+/// Gets the inverse of a component of a direction, a null component gives a large value of the same sign.
+static real _GetInverse(real value)
+{
+	if (Math::Abs(value) < Math::Epsilon)
+	{
+		return (value < (real)0.0 ? -SE_MAX_R32 : SE_MAX_R32);
+	}
+	return (real)1.0 / value;
+}
+
+/// Determines whether the segment [0, maxDistance] of a ray crosses a box (slab test), and where it enters.
+static bool _IntersectsSegment(const AABB& box, const Vector3& origin, const Vector3& invDirection, real maxDistance, real& distance)
+{
+	real t1 = (box.Min.X - origin.X) * invDirection.X;
+	real t2 = (box.Max.X - origin.X) * invDirection.X;
+	real tmin = Math::Min(t1, t2);
+	real tmax = Math::Max(t1, t2);
+
+	t1 = (box.Min.Y - origin.Y) * invDirection.Y;
+	t2 = (box.Max.Y - origin.Y) * invDirection.Y;
+	tmin = Math::Max(tmin, Math::Min(t1, t2));
+	tmax = Math::Min(tmax, Math::Max(t1, t2));
+
+	t1 = (box.Min.Z - origin.Z) * invDirection.Z;
+	t2 = (box.Max.Z - origin.Z) * invDirection.Z;
+	tmin = Math::Max(tmin, Math::Min(t1, t2));
+	tmax = Math::Min(tmax, Math::Max(t1, t2));
+
+	distance = Math::Max(tmin, (real)0.0);
+	return (tmax >= distance && distance <= maxDistance);
+}
+
+
+AABBTree::AABBTree(real margin) :
+	_nodes(NULL),
+	_nodeCount(0),
+	_nodeCapacity(0),
+	_freeList(NullProxy),
+	_root(NullProxy),
+	_proxyCount(0),
+	_margin(margin)
+{
+}
+
+AABBTree::~AABBTree()
+{
+	if (_nodes != NULL)
+	{
+		Memory::Free(_nodes);
+	}
+}
+
+int32 AABBTree::GetHeight() const
+{
+	return (_root != NullProxy ? _nodes[_root]._height : 0);
+}
+
+void* AABBTree::GetUserData(int32 proxy) const
+{
+	SE_ASSERT(proxy >= 0 && proxy < _nodeCapacity);
+	return _nodes[proxy]._userData;
+}
+
+const AABB& AABBTree::GetFatBox(int32 proxy) const
+{
+	SE_ASSERT(proxy >= 0 && proxy < _nodeCapacity);
+	return _nodes[proxy]._box;
+}
+
+int32 AABBTree::CreateProxy(const AABB& box, void* userData)
+{
+	int32 proxy = AllocateNode();
+
+	Vector3 margin = (box.Max - box.Min) * _margin;
+	Node& node = _nodes[proxy];
+	node._box.Min = box.Min - margin;
+	node._box.Max = box.Max + margin;
+	node._userData = userData;
+	node._height = 0;
+
+	InsertLeaf(proxy);
+	_proxyCount++;
+
+	return proxy;
+}
+
+void AABBTree::DestroyProxy(int32 proxy)
+{
+	SE_ASSERT(proxy >= 0 && proxy < _nodeCapacity && _nodes[proxy].IsLeaf());
+
+	RemoveLeaf(proxy);
+	FreeNode(proxy);
+	_proxyCount--;
+}
+
+bool AABBTree::MoveProxy(int32 proxy, const AABB& box)
+{
+	SE_ASSERT(proxy >= 0 && proxy < _nodeCapacity && _nodes[proxy].IsLeaf());
+
+	if (_nodes[proxy]._box.Contains(box))
+	{
+		return false;
+	}
+
+	RemoveLeaf(proxy);
+
+	// Enlarge the box in the direction of the movement, so that an object
+	// moving steadily is reinserted every few frames only
+	AABB& fatBox = _nodes[proxy]._box;
+	Vector3 displacement = ((box.Min + box.Max) - (fatBox.Min + fatBox.Max)) * ((real)0.5 * DisplacementFactor);
+	Vector3 margin = (box.Max - box.Min) * _margin;
+	fatBox.Min = box.Min - margin;
+	fatBox.Max = box.Max + margin;
+	fatBox.Min = Vector3::Min(fatBox.Min, fatBox.Min + displacement);
+	fatBox.Max = Vector3::Max(fatBox.Max, fatBox.Max + displacement);
+
+	InsertLeaf(proxy);
+	return true;
+}
+
+void AABBTree::Clear()
+{
+	_nodeCount = 0;
+	_freeList = NullProxy;
+	_root = NullProxy;
+	_proxyCount = 0;
+}
+
+void AABBTree::Query(const Frustum& frustum, BaseArray<void*>& result) const
+{
+	if (_root == NullProxy)
+	{
+		return;
+	}
+
+	int32 stack[MaxStackSize];
+	uint32 masks[MaxStackSize];
+	int32 count = 0;
+
+	stack[count] = _root;
+	masks[count] = FrustumPlaneMask_All;
+	count++;
+
+	while (count > 0)
+	{
+		count--;
+		int32 index = stack[count];
+		uint32 planeMask = masks[count];
+		const Node& node = _nodes[index];
+
+		ContainmentType containment = frustum.Intersects(node._box, planeMask);
+		if (containment == ContainmentType_Disjoint)
+		{
+			continue;
+		}
+
+		if (node.IsLeaf())
+		{
+			result.Add(node._userData);
+		}
+		else if (containment == ContainmentType_Contains)
+		{
+			// The whole subtree is visible
+			AddLeaves(index, result);
+		}
+		else
+		{
+			SE_ASSERT(count + 2 <= MaxStackSize);
+
+			stack[count] = node._child1;
+			masks[count] = planeMask;
+			count++;
+			stack[count] = node._child2;
+			masks[count] = planeMask;
+			count++;
+		}
+	}
+}
+
+void AABBTree::Query(const AABB& box, BaseArray<void*>& result) const
+{
+	if (_root == NullProxy)
+	{
+		return;
+	}
+
+	int32 stack[MaxStackSize];
+	int32 count = 0;
+	stack[count++] = _root;
+
+	while (count > 0)
+	{
+		const Node& node = _nodes[stack[--count]];
+		if (!node._box.Intersects(box))
+		{
+			continue;
+		}
+
+		if (node.IsLeaf())
+		{
+			result.Add(node._userData);
+		}
+		else
+		{
+			SE_ASSERT(count + 2 <= MaxStackSize);
+
+			stack[count++] = node._child1;
+			stack[count++] = node._child2;
+		}
+	}
+}
+
+void AABBTree::Raycast(const Ray3& ray, real maxDistance, RaycastFunction function, void* context) const
+{
+	if (_root == NullProxy)
+	{
+		return;
+	}
+
+	Vector3 invDirection(_GetInverse(ray.Direction.X), _GetInverse(ray.Direction.Y), _GetInverse(ray.Direction.Z));
+
+	// The entry distance of each node is kept to skip it if the segment was shortened meanwhile
+	int32 stack[MaxStackSize];
+	real distances[MaxStackSize];
+	int32 count = 0;
+
+	real distance;
+	if (!_IntersectsSegment(_nodes[_root]._box, ray.Origin, invDirection, maxDistance, distance))
+	{
+		return;
+	}
+	stack[count] = _root;
+	distances[count] = distance;
+	count++;
+
+	while (count > 0)
+	{
+		count--;
+		if (distances[count] > maxDistance)
+		{
+			continue;
+		}
+
+		const Node& node = _nodes[stack[count]];
+		if (node.IsLeaf())
+		{
+			real result = function(node._userData, ray, maxDistance, context);
+			if (result < (real)0.0)
+			{
+				return;
+			}
+			maxDistance = Math::Min(maxDistance, result);
+			continue;
+		}
+
+		real distance1, distance2;
+		bool isHit1 = _IntersectsSegment(_nodes[node._child1]._box, ray.Origin, invDirection, maxDistance, distance1);
+		bool isHit2 = _IntersectsSegment(_nodes[node._child2]._box, ray.Origin, invDirection, maxDistance, distance2);
+
+		SE_ASSERT(count + 2 <= MaxStackSize);
+
+		// The closest child is pushed last to be visited first
+		if (isHit1 && isHit2 && distance1 < distance2)
+		{
+			stack[count] = node._child2;
+			distances[count] = distance2;
+			count++;
+			isHit2 = false;
+		}
+		if (isHit1)
+		{
+			stack[count] = node._child1;
+			distances[count] = distance1;
+			count++;
+		}
+		if (isHit2)
+		{
+			stack[count] = node._child2;
+			distances[count] = distance2;
+			count++;
+		}
+	}
+}
+
+int32 AABBTree::AllocateNode()
+{
+	if (_freeList == NullProxy)
+	{
+		if (_nodeCount == _nodeCapacity)
+		{
+			_nodeCapacity = (_nodeCapacity == 0 ? InitialNodeCapacity : _nodeCapacity * 2);
+			_nodes = (Node*)Memory::ReAlloc(_nodes, _nodeCapacity * sizeof(Node));
+		}
+
+		_nodes[_nodeCount]._parent = _freeList;
+		_freeList = _nodeCount;
+		_nodeCount++;
+	}
+
+	int32 index = _freeList;
+	Node& node = _nodes[index];
+	_freeList = node._parent;
+
+	node._userData = NULL;
+	node._parent = NullProxy;
+	node._child1 = NullProxy;
+	node._child2 = NullProxy;
+	node._height = 0;
+	return index;
+}
+
+void AABBTree::FreeNode(int32 index)
+{
+	Node& node = _nodes[index];
+	node._parent = _freeList;
+	node._height = -1;
+	_freeList = index;
+}
+
+void AABBTree::InsertLeaf(int32 leaf)
+{
+	if (_root == NullProxy)
+	{
+		_root = leaf;
+		_nodes[_root]._parent = NullProxy;
+		return;
+	}
+
+	// Find the sibling that increases the least the surface of the tree
+	AABB leafBox = _nodes[leaf]._box;
+	int32 index = _root;
+	while (!_nodes[index].IsLeaf())
+	{
+		const Node& node = _nodes[index];
+		int32 child1 = node._child1;
+		int32 child2 = node._child2;
+
+		real area = _GetSurfaceArea(node._box);
+		real combinedArea = _GetSurfaceArea(AABB::CreateMerged(node._box, leafBox));
+
+		// Cost of creating a parent for this node and the new leaf
+		real cost = (real)2.0 * combinedArea;
+
+		// Minimum cost of pushing the leaf further down the tree
+		real inheritanceCost = (real)2.0 * (combinedArea - area);
+
+		real cost1 = _GetSurfaceArea(AABB::CreateMerged(leafBox, _nodes[child1]._box)) + inheritanceCost;
+		if (!_nodes[child1].IsLeaf())
+		{
+			cost1 -= _GetSurfaceArea(_nodes[child1]._box);
+		}
+
+		real cost2 = _GetSurfaceArea(AABB::CreateMerged(leafBox, _nodes[child2]._box)) + inheritanceCost;
+		if (!_nodes[child2].IsLeaf())
+		{
+			cost2 -= _GetSurfaceArea(_nodes[child2]._box);
+		}
+
+		if (cost < cost1 && cost < cost2)
+		{
+			break;
+		}
+
+		index = (cost1 < cost2 ? child1 : child2);
+	}
+
+	// Create a new parent for the sibling and the leaf
+	int32 sibling = index;
+	int32 oldParent = _nodes[sibling]._parent;
+	int32 newParent = AllocateNode();
+	_nodes[newParent]._parent = oldParent;
+	_nodes[newParent]._box = AABB::CreateMerged(leafBox, _nodes[sibling]._box);
+	_nodes[newParent]._height = _nodes[sibling]._height + 1;
+	_nodes[newParent]._child1 = sibling;
+	_nodes[newParent]._child2 = leaf;
+	_nodes[sibling]._parent = newParent;
+	_nodes[leaf]._parent = newParent;
+
+	if (oldParent != NullProxy)
+	{
+		if (_nodes[oldParent]._child1 == sibling)
+		{
+			_nodes[oldParent]._child1 = newParent;
+		}
+		else
+		{
+			_nodes[oldParent]._child2 = newParent;
+		}
+	}
+	else
+	{
+		_root = newParent;
+	}
+
+	// Update the ancestors
+	index = _nodes[leaf]._parent;
+	while (index != NullProxy)
+	{
+		index = Balance(index);
+
+		Node& node = _nodes[index];
+		const Node& child1 = _nodes[node._child1];
+		const Node& child2 = _nodes[node._child2];
+		node._height = 1 + Math::Max(child1._height, child2._height);
+		node._box = AABB::CreateMerged(child1._box, child2._box);
+
+		index = node._parent;
+	}
+}
+
+void AABBTree::RemoveLeaf(int32 leaf)
+{
+	if (leaf == _root)
+	{
+		_root = NullProxy;
+		return;
+	}
+
+	int32 parent = _nodes[leaf]._parent;
+	int32 grandParent = _nodes[parent]._parent;
+	int32 sibling = (_nodes[parent]._child1 == leaf ? _nodes[parent]._child2 : _nodes[parent]._child1);
+
+	// Replace the parent by the sibling
+	FreeNode(parent);
+	if (grandParent == NullProxy)
+	{
+		_root = sibling;
+		_nodes[sibling]._parent = NullProxy;
+		return;
+	}
+
+	if (_nodes[grandParent]._child1 == parent)
+	{
+		_nodes[grandParent]._child1 = sibling;
+	}
+	else
+	{
+		_nodes[grandParent]._child2 = sibling;
+	}
+	_nodes[sibling]._parent = grandParent;
+
+	// Update the ancestors
+	int32 index = grandParent;
+	while (index != NullProxy)
+	{
+		index = Balance(index);
+
+		Node& node = _nodes[index];
+		const Node& child1 = _nodes[node._child1];
+		const Node& child2 = _nodes[node._child2];
+		node._height = 1 + Math::Max(child1._height, child2._height);
+		node._box = AABB::CreateMerged(child1._box, child2._box);
+
+		index = node._parent;
+	}
+}
+
+int32 AABBTree::Balance(int32 iA)
+{
+	Node& A = _nodes[iA];
+	if (A.IsLeaf() || A._height < 2)
+	{
+		return iA;
+	}
+
+	int32 iB = A._child1;
+	int32 iC = A._child2;
+	Node& B = _nodes[iB];
+	Node& C = _nodes[iC];
+	int32 balance = C._height - B._height;
+
+	// Rotate C up
+	if (balance > 1)
+	{
+		int32 iF = C._child1;
+		int32 iG = C._child2;
+		Node& F = _nodes[iF];
+		Node& G = _nodes[iG];
+
+		C._child1 = iA;
+		C._parent = A._parent;
+		A._parent = iC;
+
+		if (C._parent != NullProxy)
+		{
+			if (_nodes[C._parent]._child1 == iA)
+			{
+				_nodes[C._parent]._child1 = iC;
+			}
+			else
+			{
+				_nodes[C._parent]._child2 = iC;
+			}
+		}
+		else
+		{
+			_root = iC;
+		}
+
+		if (F._height > G._height)
+		{
+			C._child2 = iF;
+			A._child2 = iG;
+			G._parent = iA;
+			A._box = AABB::CreateMerged(B._box, G._box);
+			C._box = AABB::CreateMerged(A._box, F._box);
+			A._height = 1 + Math::Max(B._height, G._height);
+			C._height = 1 + Math::Max(A._height, F._height);
+		}
+		else
+		{
+			C._child2 = iG;
+			A._child2 = iF;
+			F._parent = iA;
+			A._box = AABB::CreateMerged(B._box, F._box);
+			C._box = AABB::CreateMerged(A._box, G._box);
+			A._height = 1 + Math::Max(B._height, F._height);
+			C._height = 1 + Math::Max(A._height, G._height);
+		}
+
+		return iC;
+	}
+
+	// Rotate B up
+	if (balance < -1)
+	{
+		int32 iD = B._child1;
+		int32 iE = B._child2;
+		Node& D = _nodes[iD];
+		Node& E = _nodes[iE];
+
+		B._child1 = iA;
+		B._parent = A._parent;
+		A._parent = iB;
+
+		if (B._parent != NullProxy)
+		{
+			if (_nodes[B._parent]._child1 == iA)
+			{
+				_nodes[B._parent]._child1 = iB;
+			}
+			else
+			{
+				_nodes[B._parent]._child2 = iB;
+			}
+		}
+		else
+		{
+			_root = iB;
+		}
+
+		if (D._height > E._height)
+		{
+			B._child2 = iD;
+			A._child1 = iE;
+			E._parent = iA;
+			A._box = AABB::CreateMerged(C._box, E._box);
+			B._box = AABB::CreateMerged(A._box, D._box);
+			A._height = 1 + Math::Max(C._height, E._height);
+			B._height = 1 + Math::Max(A._height, D._height);
+		}
+		else
+		{
+			B._child2 = iE;
+			A._child1 = iD;
+			D._parent = iA;
+			A._box = AABB::CreateMerged(C._box, D._box);
+			B._box = AABB::CreateMerged(A._box, E._box);
+			A._height = 1 + Math::Max(C._height, D._height);
+			B._height = 1 + Math::Max(A._height, E._height);
+		}
+
+		return iB;
+	}
+
+	return iA;
+}
+
+void AABBTree::AddLeaves(int32 index, BaseArray<void*>& result) const
+{
+	int32 stack[MaxStackSize];
+	int32 count = 0;
+	stack[count++] = index;
+
+	while (count > 0)
+	{
+		const Node& node = _nodes[stack[--count]];
+		if (node.IsLeaf())
+		{
+			result.Add(node._userData);
+		}
+		else
+		{
+			SE_ASSERT(count + 2 <= MaxStackSize);
+
+			stack[count++] = node._child1;
+			stack[count++] = node._child2;
+		}
+	}
+}
+
+}
@@ -0,0 +1,161 @@
+/*=============================================================================
+AABBTree.h
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+#ifndef _SE_AABBTREE_H_
+#define _SE_AABBTREE_H_
+
+#include "Core/Common.h"
+#include "Core/Math/AABB.h"
+#include "Core/Math/Frustum.h"
+#include "Core/Math/Ray3.h"
+#include "Core/Containers/BaseArray.h"
+
+namespace SonataEngine
+{
+
+/**
+	Represents the method called for each proxy crossed by a ray.
+	@return The new maximum distance of the ray, or a negative value to stop the query.
+*/
+typedef real (*RaycastFunction)(void* userData, const Ray3& ray, real maxDistance, void* context);
+
+/**
+	@brief Dynamic bounding volume hierarchy of axis aligned bounding boxes.
+
+	Each object is stored in a leaf, called a proxy, with a box enlarged by a
+	margin so that the small movements of the object don't modify the tree.
+	The tree is kept balanced by rotations when the leaves are inserted or
+	removed, and the nodes are stored in a single buffer.
+
+	The frustum queries test each node against the planes crossed by its parent
+	only, so that a subtree entirely inside or outside of the frustum is
+	accepted or rejected with one test.
+*/
+class SE_CORE_EXPORT AABBTree
+{
+public:
+	/** Identifier of an invalid proxy. */
+	static const int32 NullProxy;
+
+	/** Default margin of the boxes, relative to the size of the boxes. */
+	static const real DefaultMargin;
+
+public:
+	/** @name Constructors / Destructor. */
+	//@{
+	/**
+		Initializes a new instance of the AABBTree class.
+		@param margin The margin added to each side of the boxes, relative to the size of the boxes.
+	*/
+	AABBTree(real margin = DefaultMargin);
+
+	/** Destructor. */
+	~AABBTree();
+	//@}
+
+	/** @name Properties. */
+	//@{
+	/** Gets the number of proxies. */
+	int32 Count() const { return _proxyCount; }
+
+	/** Gets the height of the tree, zero for a single leaf. */
+	int32 GetHeight() const;
+
+	/** Gets the relative margin of the boxes. */
+	real GetMargin() const { return _margin; }
+
+	/** Gets the user data of a proxy. */
+	void* GetUserData(int32 proxy) const;
+
+	/** Gets the enlarged box of a proxy. */
+	const AABB& GetFatBox(int32 proxy) const;
+	//@}
+
+	/** @name Operations. */
+	//@{
+	/**
+		Creates a proxy.
+		@param box The box of the object.
+		@param userData The data returned by the queries.
+		@return The identifier of the proxy.
+	*/
+	int32 CreateProxy(const AABB& box, void* userData);
+
+	/** Destroys a proxy. */
+	void DestroyProxy(int32 proxy);
+
+	/**
+		Moves a proxy.
+		@param proxy The identifier of the proxy.
+		@param box The new box of the object.
+		@return true if the proxy was reinserted; false if the box is still inside of the enlarged box.
+	*/
+	bool MoveProxy(int32 proxy, const AABB& box);
+
+	/** Removes all the proxies. */
+	void Clear();
+
+	/**
+		Gets the user data of the proxies intersecting a frustum.
+		@param frustum The frustum.
+		@param result The list where the user data is added.
+	*/
+	void Query(const Frustum& frustum, BaseArray<void*>& result) const;
+
+	/**
+		Gets the user data of the proxies intersecting a box.
+		@param box The box.
+		@param result The list where the user data is added.
+	*/
+	void Query(const AABB& box, BaseArray<void*>& result) const;
+
+	/**
+		Casts a ray against the proxies, the closest boxes are visited first.
+		@param ray The ray.
+		@param maxDistance The length of the segment, in units of the direction of the ray.
+		@param function The function called for each proxy crossed by the segment.
+			It returns the new length of the segment, or a negative value to stop the query.
+		@param context The data passed to the function.
+	*/
+	void Raycast(const Ray3& ray, real maxDistance, RaycastFunction function, void* context) const;
+	//@}
+
+private:
+	AABBTree(const AABBTree&);
+	AABBTree& operator=(const AABBTree&);
+
+	/// Node of the tree. The free nodes are linked with _parent.
+	struct Node
+	{
+		AABB _box;
+		void* _userData;
+		int32 _parent;
+		int32 _child1;
+		int32 _child2;
+		int32 _height;
+
+		bool IsLeaf() const { return (_child1 == NullProxy); }
+	};
+
+	int32 AllocateNode();
+	void FreeNode(int32 node);
+	void InsertLeaf(int32 leaf);
+	void RemoveLeaf(int32 leaf);
+	int32 Balance(int32 node);
+	void AddLeaves(int32 node, BaseArray<void*>& result) const;
+
+	Node* _nodes;
+	int32 _nodeCount;
+	int32 _nodeCapacity;
+	int32 _freeList;
+	int32 _root;
+	int32 _proxyCount;
+	real _margin;
+};
+
+}
+
+#endif
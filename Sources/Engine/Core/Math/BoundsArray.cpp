@@ -0,0 +1,320 @@
+/*=============================================================================
+BoundsArray.cpp
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+#include "BoundsArray.h"
+#include "Core/System/Memory.h"
+
+#if SE_USE_SIMD && (defined(_M_IX86) || defined(_M_X64) || defined(__SSE__))
+#	define SE_BOUNDSARRAY_SSE 1
+#	include <xmmintrin.h>
+#else
+#	define SE_BOUNDSARRAY_SSE 0
+#endif
+
+namespace SonataEngine
+{
+
+/// Number of volumes tested at once, the capacity is a multiple of this value.
+static const int32 BatchSize = 4;
+
+/// Alignment of the streams, in bytes.
+static const int32 StreamAlignment = 16;
+
+/// Initial capacity of the array.
+static const int32 InitialCapacity = 64;
+
+/// Plane of the frustum with the absolute values of its normal, used by the box test.
+struct CullingPlane
+{
+	real32 NormalX, NormalY, NormalZ, D;
+	real32 AbsNormalX, AbsNormalY, AbsNormalZ;
+};
+
+static void _GetCullingPlanes(const Frustum& frustum, CullingPlane* planes)
+{
+	for (int i = 0; i < NumFrustumPlanes; i++)
+	{
+		Plane plane = frustum.GetFrustumPlane((FrustumPlane)i);
+		planes[i].NormalX = plane.Normal.X;
+		planes[i].NormalY = plane.Normal.Y;
+		planes[i].NormalZ = plane.Normal.Z;
+		planes[i].D = plane.D;
+		planes[i].AbsNormalX = Math::Abs(plane.Normal.X);
+		planes[i].AbsNormalY = Math::Abs(plane.Normal.Y);
+		planes[i].AbsNormalZ = Math::Abs(plane.Normal.Z);
+	}
+}
+
+/// Clears the visibility mask and the bits following the last volume.
+static void _ClearMask(uint32* visibility, int32 count)
+{
+	Memory::Zero(visibility, BoundsArray::GetMaskSize(count) * sizeof(uint32));
+}
+
+static void _MaskLastWord(uint32* visibility, int32 count)
+{
+	if ((count & 31) != 0)
+	{
+		visibility[count / 32] &= (1u << (count & 31)) - 1;
+	}
+}
+
+
+BoundsArray::BoundsArray() :
+	_buffer(NULL),
+	_count(0),
+	_capacity(0)
+{
+	for (int i = 0; i < Stream_Count; i++)
+	{
+		_streams[i] = NULL;
+	}
+}
+
+BoundsArray::~BoundsArray()
+{
+	if (_buffer != NULL)
+	{
+		Memory::Free(_buffer);
+	}
+}
+
+BoundingSphere BoundsArray::GetSphere(int32 index) const
+{
+	SE_ASSERT(index >= 0 && index < _count);
+
+	return BoundingSphere(
+		Vector3(_streams[Stream_SphereX][index], _streams[Stream_SphereY][index], _streams[Stream_SphereZ][index]),
+		_streams[Stream_SphereRadius][index]);
+}
+
+BoundingBox BoundsArray::GetBox(int32 index) const
+{
+	SE_ASSERT(index >= 0 && index < _count);
+
+	Vector3 center(_streams[Stream_BoxCenterX][index], _streams[Stream_BoxCenterY][index], _streams[Stream_BoxCenterZ][index]);
+	Vector3 extents(_streams[Stream_BoxExtentX][index], _streams[Stream_BoxExtentY][index], _streams[Stream_BoxExtentZ][index]);
+	return BoundingBox(center - extents, center + extents);
+}
+
+int32 BoundsArray::Add(const BoundingSphere& sphere, const BoundingBox& box)
+{
+	if (_count == _capacity)
+	{
+		SetCapacity(_capacity == 0 ? InitialCapacity : _capacity * 2);
+	}
+
+	int32 index = _count++;
+	Set(index, sphere, box);
+	return index;
+}
+
+void BoundsArray::Set(int32 index, const BoundingSphere& sphere, const BoundingBox& box)
+{
+	SE_ASSERT(index >= 0 && index < _count);
+
+	_streams[Stream_SphereX][index] = sphere.Center.X;
+	_streams[Stream_SphereY][index] = sphere.Center.Y;
+	_streams[Stream_SphereZ][index] = sphere.Center.Z;
+	_streams[Stream_SphereRadius][index] = sphere.Radius;
+	_streams[Stream_BoxCenterX][index] = (box.Min.X + box.Max.X) * 0.5f;
+	_streams[Stream_BoxCenterY][index] = (box.Min.Y + box.Max.Y) * 0.5f;
+	_streams[Stream_BoxCenterZ][index] = (box.Min.Z + box.Max.Z) * 0.5f;
+	_streams[Stream_BoxExtentX][index] = (box.Max.X - box.Min.X) * 0.5f;
+	_streams[Stream_BoxExtentY][index] = (box.Max.Y - box.Min.Y) * 0.5f;
+	_streams[Stream_BoxExtentZ][index] = (box.Max.Z - box.Min.Z) * 0.5f;
+}
+
+void BoundsArray::RemoveAt(int32 index)
+{
+	SE_ASSERT(index >= 0 && index < _count);
+
+	_count--;
+	for (int i = 0; i < Stream_Count; i++)
+	{
+		_streams[i][index] = _streams[i][_count];
+		_streams[i][_count] = 0.0f;
+	}
+}
+
+void BoundsArray::Clear()
+{
+	if (_buffer != NULL)
+	{
+		Memory::Zero(_streams[0], Stream_Count * _capacity * sizeof(real32));
+	}
+	_count = 0;
+}
+
+void BoundsArray::SetCapacity(int32 capacity)
+{
+	capacity = (capacity + BatchSize - 1) & ~(BatchSize - 1);
+
+	// The streams follow each other in a single block, the padding is zeroed
+	void* buffer = Memory::Alloc(Stream_Count * capacity * sizeof(real32) + StreamAlignment);
+	real32* data = (real32*)(((SEptr)buffer + StreamAlignment - 1) & ~(SEptr)(StreamAlignment - 1));
+	Memory::Zero(data, Stream_Count * capacity * sizeof(real32));
+
+	for (int i = 0; i < Stream_Count; i++)
+	{
+		real32* stream = data + i * capacity;
+		if (_count > 0)
+		{
+			Memory::Copy(stream, _streams[i], _count * sizeof(real32));
+		}
+		_streams[i] = stream;
+	}
+
+	if (_buffer != NULL)
+	{
+		Memory::Free(_buffer);
+	}
+	_buffer = buffer;
+	_capacity = capacity;
+}
+
+void BoundsArray::CullSpheres(const Frustum& frustum, uint32* visibility) const
+{
+	CullingPlane planes[NumFrustumPlanes];
+	_GetCullingPlanes(frustum, planes);
+	_ClearMask(visibility, _count);
+
+	const real32* x = _streams[Stream_SphereX];
+	const real32* y = _streams[Stream_SphereY];
+	const real32* z = _streams[Stream_SphereZ];
+	const real32* radius = _streams[Stream_SphereRadius];
+
+#if SE_BOUNDSARRAY_SSE
+	__m128 nx[NumFrustumPlanes], ny[NumFrustumPlanes], nz[NumFrustumPlanes], d[NumFrustumPlanes];
+	for (int p = 0; p < NumFrustumPlanes; p++)
+	{
+		nx[p] = _mm_set1_ps(planes[p].NormalX);
+		ny[p] = _mm_set1_ps(planes[p].NormalY);
+		nz[p] = _mm_set1_ps(planes[p].NormalZ);
+		d[p] = _mm_set1_ps(planes[p].D);
+	}
+
+	for (int32 i = 0; i < _count; i += BatchSize)
+	{
+		__m128 cx = _mm_load_ps(x + i);
+		__m128 cy = _mm_load_ps(y + i);
+		__m128 cz = _mm_load_ps(z + i);
+		__m128 negRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_load_ps(radius + i));
+		__m128 outside = _mm_setzero_ps();
+
+		for (int p = 0; p < NumFrustumPlanes; p++)
+		{
+			__m128 distance = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(cx, nx[p]), _mm_mul_ps(cy, ny[p])),
+				_mm_add_ps(_mm_mul_ps(cz, nz[p]), d[p]));
+			outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, negRadius));
+		}
+
+		uint32 visible = (uint32)(~_mm_movemask_ps(outside) & 0xF);
+		visibility[i / 32] |= visible << (i & 31);
+	}
+#else
+	for (int32 i = 0; i < _count; i++)
+	{
+		bool isVisible = true;
+		for (int p = 0; p < NumFrustumPlanes; p++)
+		{
+			real32 distance = x[i] * planes[p].NormalX + y[i] * planes[p].NormalY + z[i] * planes[p].NormalZ + planes[p].D;
+			if (distance < -radius[i])
+			{
+				isVisible = false;
+				break;
+			}
+		}
+
+		if (isVisible)
+		{
+			visibility[i / 32] |= 1u << (i & 31);
+		}
+	}
+#endif
+
+	_MaskLastWord(visibility, _count);
+}
+
+void BoundsArray::CullBoxes(const Frustum& frustum, uint32* visibility) const
+{
+	CullingPlane planes[NumFrustumPlanes];
+	_GetCullingPlanes(frustum, planes);
+	_ClearMask(visibility, _count);
+
+	const real32* x = _streams[Stream_BoxCenterX];
+	const real32* y = _streams[Stream_BoxCenterY];
+	const real32* z = _streams[Stream_BoxCenterZ];
+	const real32* ex = _streams[Stream_BoxExtentX];
+	const real32* ey = _streams[Stream_BoxExtentY];
+	const real32* ez = _streams[Stream_BoxExtentZ];
+
+#if SE_BOUNDSARRAY_SSE
+	__m128 nx[NumFrustumPlanes], ny[NumFrustumPlanes], nz[NumFrustumPlanes], d[NumFrustumPlanes];
+	__m128 ax[NumFrustumPlanes], ay[NumFrustumPlanes], az[NumFrustumPlanes];
+	for (int p = 0; p < NumFrustumPlanes; p++)
+	{
+		nx[p] = _mm_set1_ps(planes[p].NormalX);
+		ny[p] = _mm_set1_ps(planes[p].NormalY);
+		nz[p] = _mm_set1_ps(planes[p].NormalZ);
+		d[p] = _mm_set1_ps(planes[p].D);
+		ax[p] = _mm_set1_ps(planes[p].AbsNormalX);
+		ay[p] = _mm_set1_ps(planes[p].AbsNormalY);
+		az[p] = _mm_set1_ps(planes[p].AbsNormalZ);
+	}
+
+	for (int32 i = 0; i < _count; i += BatchSize)
+	{
+		__m128 cx = _mm_load_ps(x + i);
+		__m128 cy = _mm_load_ps(y + i);
+		__m128 cz = _mm_load_ps(z + i);
+		__m128 hx = _mm_load_ps(ex + i);
+		__m128 hy = _mm_load_ps(ey + i);
+		__m128 hz = _mm_load_ps(ez + i);
+		__m128 outside = _mm_setzero_ps();
+
+		for (int p = 0; p < NumFrustumPlanes; p++)
+		{
+			// Distance of the center and projected radius of the box on the normal of the plane
+			__m128 distance = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(cx, nx[p]), _mm_mul_ps(cy, ny[p])),
+				_mm_add_ps(_mm_mul_ps(cz, nz[p]), d[p]));
+			__m128 radius = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(hx, ax[p]), _mm_mul_ps(hy, ay[p])),
+				_mm_mul_ps(hz, az[p]));
+			outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(distance, radius), _mm_setzero_ps()));
+		}
+
+		uint32 visible = (uint32)(~_mm_movemask_ps(outside) & 0xF);
+		visibility[i / 32] |= visible << (i & 31);
+	}
+#else
+	for (int32 i = 0; i < _count; i++)
+	{
+		bool isVisible = true;
+		for (int p = 0; p < NumFrustumPlanes; p++)
+		{
+			real32 distance = x[i] * planes[p].NormalX + y[i] * planes[p].NormalY + z[i] * planes[p].NormalZ + planes[p].D;
+			real32 radius = ex[i] * planes[p].AbsNormalX + ey[i] * planes[p].AbsNormalY + ez[i] * planes[p].AbsNormalZ;
+			if (distance + radius < 0.0f)
+			{
+				isVisible = false;
+				break;
+			}
+		}
+
+		if (isVisible)
+		{
+			visibility[i / 32] |= 1u << (i & 31);
+		}
+	}
+#endif
+
+	_MaskLastWord(visibility, _count);
+}
+
+}
@@ -0,0 +1,118 @@
+/*=============================================================================
+BoundsArray.h
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+#ifndef _SE_BOUNDSARRAY_H_
+#define _SE_BOUNDSARRAY_H_
+
+#include "Core/Common.h"
+#include "Core/Math/BoundingBox.h"
+#include "Core/Math/BoundingSphere.h"
+#include "Core/Math/Frustum.h"
+
+namespace SonataEngine
+{
+
+/**
+	@brief Array of bounding volumes stored as a structure of arrays.
+
+	Each component of the bounding spheres and of the bounding boxes is stored
+	in its own contiguous stream, so that the culling methods test several
+	volumes at once with the SIMD instructions when SE_USE_SIMD is enabled.
+
+	The results of the culling are written in a visibility mask, where the bit
+	(i % 32) of the word (i / 32) is set when the volume at index i is visible.
+*/
+class SE_CORE_EXPORT BoundsArray
+{
+public:
+	/** @name Constructors / Destructor. */
+	//@{
+	BoundsArray();
+
+	~BoundsArray();
+	//@}
+
+	/** @name Properties. */
+	//@{
+	/** Gets the number of volumes. */
+	int32 Count() const { return _count; }
+
+	/** Gets the number of words of the visibility mask of the specified number of volumes. */
+	static int32 GetMaskSize(int32 count) { return (count + 31) / 32; }
+
+	/** Gets the bounding sphere at the specified index. */
+	BoundingSphere GetSphere(int32 index) const;
+
+	/** Gets the bounding box at the specified index. */
+	BoundingBox GetBox(int32 index) const;
+	//@}
+
+	/** @name Operations. */
+	//@{
+	/**
+		Adds the bounds of an object.
+		@return The index of the bounds.
+	*/
+	int32 Add(const BoundingSphere& sphere, const BoundingBox& box);
+
+	/** Sets the bounds at the specified index. */
+	void Set(int32 index, const BoundingSphere& sphere, const BoundingBox& box);
+
+	/**
+		Removes the bounds at the specified index.
+		The last bounds are moved to this index.
+	*/
+	void RemoveAt(int32 index);
+
+	/** Removes all the bounds. */
+	void Clear();
+
+	/**
+		Tests the bounding spheres against a frustum.
+		@param frustum The frustum.
+		@param visibility The visibility mask, must contain GetMaskSize(Count()) words.
+	*/
+	void CullSpheres(const Frustum& frustum, uint32* visibility) const;
+
+	/**
+		Tests the bounding boxes against a frustum.
+		@param frustum The frustum.
+		@param visibility The visibility mask, must contain GetMaskSize(Count()) words.
+	*/
+	void CullBoxes(const Frustum& frustum, uint32* visibility) const;
+	//@}
+
+private:
+	BoundsArray(const BoundsArray&);
+	BoundsArray& operator=(const BoundsArray&);
+
+	/// Streams of the components, the boxes are stored as centers and extents.
+	enum Stream
+	{
+		Stream_SphereX,
+		Stream_SphereY,
+		Stream_SphereZ,
+		Stream_SphereRadius,
+		Stream_BoxCenterX,
+		Stream_BoxCenterY,
+		Stream_BoxCenterZ,
+		Stream_BoxExtentX,
+		Stream_BoxExtentY,
+		Stream_BoxExtentZ,
+		Stream_Count
+	};
+
+	void SetCapacity(int32 capacity);
+
+	void* _buffer;
+	real32* _streams[Stream_Count];
+	int32 _count;
+	int32 _capacity;
+};
+
+}
+
+#endif
@@ -178,12 +178,61 @@ bool Frustum::Contains(const OBB& obb) const
 
 int Frustum::Intersects(const BoundingSphere& sphere) const
 {
+	for (int i = 0; i < NumFrustumPlanes; i++)
+	{
+		// The sphere is entirely behind a side of the frustum
+		if (_planes[i].GetDistance(sphere.Center) < -sphere.Radius)
+		{
+			return 0;
+		}
+	}
+
 	return 1;
 }
 
 int Frustum::Intersects(const BoundingBox& box) const
 {
-	return 1;
+	uint32 planeMask = FrustumPlaneMask_All;
+	return (Intersects(box, planeMask) != ContainmentType_Disjoint ? 1 : 0);
+}
+
+ContainmentType Frustum::Intersects(const BoundingBox& box, uint32& planeMask) const
+{
+	Vector3 center = (box.Min + box.Max) * (real)0.5;
+	Vector3 extents = (box.Max - box.Min) * (real)0.5;
+
+	uint32 crossedMask = FrustumPlaneMask_None;
+	for (int i = 0; i < NumFrustumPlanes; i++)
+	{
+		uint32 bit = (1 << i);
+		if ((planeMask & bit) == 0)
+		{
+			continue;
+		}
+
+		// Distance of the center and projected radius of the box on the normal of the plane
+		const Plane& plane = _planes[i];
+		real distance = plane.GetDistance(center);
+		real radius =
+			extents.X * Math::Abs(plane.Normal.X) +
+			extents.Y * Math::Abs(plane.Normal.Y) +
+			extents.Z * Math::Abs(plane.Normal.Z);
+
+		if (distance < -radius)
+		{
+			// The box is entirely behind the plane
+			planeMask = crossedMask;
+			return ContainmentType_Disjoint;
+		}
+
+		if (distance < radius)
+		{
+			crossedMask |= bit;
+		}
+	}
+
+	planeMask = crossedMask;
+	return (crossedMask == FrustumPlaneMask_None ? ContainmentType_Contains : ContainmentType_Intersects);
 }
 
 int Frustum::Intersects(const OBB& obb) const
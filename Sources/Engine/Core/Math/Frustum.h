@@ -31,6 +31,29 @@ enum FrustumPlane
 	NumFrustumPlanes = 6
 };
 
+/** Masks of the frustum clipping planes. */
+enum FrustumPlaneMask
+{
+	/** No plane. */
+	FrustumPlaneMask_None = 0,
+
+	/** All the planes. */
+	FrustumPlaneMask_All = (1 << NumFrustumPlanes) - 1
+};
+
+/** Classification of a bounding volume against another volume. */
+enum ContainmentType
+{
+	/** The volumes don't intersect. */
+	ContainmentType_Disjoint,
+
+	/** The volume is entirely inside of the other volume. */
+	ContainmentType_Contains,
+
+	/** The volumes partially intersect. */
+	ContainmentType_Intersects
+};
+
 /**
 	@brief Frustum.
 
@@ -122,6 +145,17 @@ public:
 	/** Checks whether the current Frustum intersects a BoundingBox. */
 	int Intersects(const BoundingBox& box) const;
 
+	/**
+		Classifies a BoundingBox against a subset of the planes of the Frustum.
+		@param box The box.
+		@param planeMask On input, the planes to test, usually FrustumPlaneMask_All.
+			On output, the planes crossed by the box. The boxes contained in this
+			box only need to be tested against these planes.
+		@return ContainmentType_Contains if the box is inside of all the tested planes,
+			ContainmentType_Disjoint if it is outside of one plane.
+	*/
+	ContainmentType Intersects(const BoundingBox& box, uint32& planeMask) const;
+
 	/** Checks whether the current Frustum intersects an OBB. */
 	int Intersects(const OBB& obb) const;
 
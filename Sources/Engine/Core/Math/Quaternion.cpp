@@ -112,7 +112,7 @@ Quaternion Quaternion::Lerp(const Quaternion& left, const Quaternion& right, rea
 		result.W = (remaining * left.W) - (amount * right.W);
 	}
 
-	real invLength = result.Length();
+	real invLength = (real)1.0 / result.Length();
 	result.X *= invLength;
 	result.Y *= invLength;
 	result.Z *= invLength;
@@ -145,6 +145,9 @@ public:
 	StructObject() : Object() {}
 	virtual void Get(void* value) = 0;
 	virtual void Set(void* value) = 0;
+
+	/** Gets a pointer to the value of the structure. */
+	virtual void* GetData() = 0;
 };
 
 
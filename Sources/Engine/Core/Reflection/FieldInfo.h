@@ -28,6 +28,9 @@ public:
 
 	virtual TypeInfo* GetFieldType() const;
 
+	/** Gets the offset of the field from the beginning of the object. */
+	int GetOffset() const;
+
 	virtual Variant GetValue(Object* obj) const;
 
 	virtual void SetValue(Object* obj, const Variant& value) const;
@@ -28,6 +28,11 @@ SE_INLINE TypeInfo* FieldInfo::GetFieldType() const
 	return _FieldType;
 }
 
+SE_INLINE int FieldInfo::GetOffset() const
+{
+	return _Offset;
+}
+
 /*template <class T>
 T& FieldInfo::GetValue(Object* obj)
 {
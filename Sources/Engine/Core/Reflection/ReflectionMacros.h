@@ -128,6 +128,10 @@ public: \
 		{ \
 			Memory::Copy(&_value, value, sizeof(structname)); \
 		} \
+		virtual void* GetData() \
+		{ \
+			return &_value; \
+		} \
 		structname _value; \
 	};
 
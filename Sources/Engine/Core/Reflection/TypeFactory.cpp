@@ -12,7 +12,7 @@ namespace SonataEngine
 
 TypeFactory::~TypeFactory()
 {
-	TypeTable::DictionaryIterator it = _types.GetIterator();
+	TypeTable::Iterator it = _types.GetIterator();
 	while (it.Next())
 	{
 		//FIX
@@ -39,14 +39,8 @@ void TypeFactory::UnregisterType(TypeInfo* type)
 
 TypeInfo* TypeFactory::GetType(const String& typeName)
 {
-	if (_types.Contains(typeName))
-	{
-		return _types[typeName];
-	}
-	else
-	{
-		return NULL;
-	}
+	TypeInfo** type = _types.Find(typeName);
+	return (type != NULL ? *type : NULL);
 }
 
 TypeInfoList TypeFactory::GetTypes()
@@ -62,8 +56,9 @@ Object* TypeFactory::CreateInstance(TypeInfo* type)
 
 Object* TypeFactory::CreateInstance(const String& typeName)
 {
-	if (_types.ContainsKey(typeName))
-		return _types[typeName]->Create();
+	TypeInfo** type = _types.Find(typeName);
+	if (type != NULL)
+		return (*type)->Create();
 	else
 		return NULL;
 }
@@ -11,7 +11,7 @@ Author: Julien Delezenne
 #include "Core/Singleton.h"
 #include "Core/String.h"
 #include "Core/Containers/Array.h"
-#include "Core/Containers/Dictionary.h"
+#include "Core/Containers/Hashtable.h"
 
 namespace SonataEngine
 {
@@ -47,7 +47,7 @@ public:
 	Object* CreateInstance(const String& typeName);
 
 private:
-	typedef Dictionary<String, TypeInfo*> TypeTable;
+	typedef Hashtable<String, TypeInfo*> TypeTable;
 	TypeTable _types;
 };
 
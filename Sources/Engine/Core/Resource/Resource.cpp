@@ -12,7 +12,7 @@ namespace SonataEngine
 
 Resource::Resource() :
 	RefObject(),
-	_handle(NULL),
+	_handle(ResourceHandleInvalid),
 	_size(0),
 	_data(NULL),
 	_lastAccessed(0.0)
@@ -34,4 +34,9 @@ bool Resource::Unload()
 	return true;
 }
 
+bool Resource::Reload()
+{
+	return ResourceManager::Instance()->Reload(_handle);
+}
+
 }
@@ -6,6 +6,7 @@ Author: Julien Delezenne
 
 #include "ResourceHandler.h"
 #include "Core/Resource/ResourceManager.h"
+#include "Core/IO/MemoryStream.h"
 
 namespace SonataEngine
 {
@@ -28,4 +29,15 @@ void ResourceHandler::Destroy()
 {
 }
 
+Resource* ResourceHandler::LoadBuffer(const String& name, const SE_ID& type, const String& path, SEbyte*& buffer, int32 size)
+{
+	MemoryStream stream(buffer, size, false);
+	return Load(name, type, path, stream);
+}
+
+bool ResourceHandler::CanLoadAsync(const SE_ID& type, Stream& stream)
+{
+	return false;
+}
+
 }
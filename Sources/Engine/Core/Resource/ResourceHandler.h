@@ -34,6 +34,23 @@ public:
 
 	virtual Resource* Load(const String& name, const SE_ID& type, const String& path, Stream& stream) = 0;
 
+	/**
+		Loads a resource from the content of its file, read by the
+		ResourceManager in a buffer allocated with new[].
+		The handler takes the ownership of the buffer by setting it to NULL,
+		so a resource can keep the data without copying it.
+		Calls Load with a memory stream over the buffer by default.
+	*/
+	virtual Resource* LoadBuffer(const String& name, const SE_ID& type, const String& path, SEbyte*& buffer, int32 size);
+
+	/**
+		Returns whether a resource can be loaded on a worker thread of the
+		ResourceManager, the stream holding the data read from its file.
+		Returns false by default, the resources are then loaded on the main
+		thread.
+	*/
+	virtual bool CanLoadAsync(const SE_ID& type, Stream& stream);
+
 	virtual bool Save(Resource* resource, const String& path, Stream& stream) = 0;
 
 	virtual bool Unload(Resource* resource) = 0;
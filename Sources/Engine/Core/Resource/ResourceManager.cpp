@@ -5,16 +5,279 @@ Author: Julien Delezenne
 =============================================================================*/
 
 #include "ResourceManager.h"
+#include "Core/IO/File.h"
+#include "Core/IO/FileStream.h"
+#include "Core/IO/MemoryStream.h"
+#include "Core/System/Environment.h"
+#include "Core/System/Timer.h"
+#include "Core/Threading/Interlocked.h"
+#include "Core/Threading/Thread.h"
 
 namespace SonataEngine
 {
 
-ResourceManager::ResourceManager()
+/// Default time spent by Update loading on the main thread, in microseconds.
+static const int32 DefaultTimeBudget = 2000;
+
+/// Size of the blocks read from the files, a cancellation is seen between two blocks.
+static const int32 ReadBlockSize = 256 * 1024;
+
+/// Number of failed and cancelled requests kept for GetState.
+static const int32 MaxFinishedRequestCount = 64;
+
+struct ResourceRequestCallback
+{
+	ResourceCallback _Callback;
+	void* _UserData;
+};
+
+/** Request of an asynchronous load. */
+struct ResourceRequest
+{
+	ResourceRequest() :
+		_Handle(ResourceHandleInvalid),
+		_Handler(NULL),
+		_Priority(0.0f),
+		_Sequence(0),
+		_State(ResourceState_Queued),
+		_Cancelled(0),
+		_Blockers(1),
+		_Async(false),
+		_Queue(NULL),
+		_QueueIndex(-1),
+		_Buffer(NULL),
+		_BufferSize(0),
+		_Resource(NULL)
+	{
+	}
+
+	ResourceHandle _Handle;
+	String _Name;
+	SE_ID _Type;
+	String _Path;
+	ResourceHandler* _Handler;
+
+	/// Order in the queues, the oldest request first for the same priority.
+	real32 _Priority;
+	uint32 _Sequence;
+
+	/// The ResourceState, also written by the threads.
+	volatile int32 _State;
+	volatile int32 _Cancelled;
+
+	/// Number of reads and dependencies to finish before decoding.
+	volatile int32 _Blockers;
+
+	/// Whether the handler can decode the request on a worker thread.
+	bool _Async;
+
+	/// Queue holding the request and index in its heap, guarded by the lock.
+	BaseArray<ResourceRequest*>* _Queue;
+	int32 _QueueIndex;
+
+	/// Content of the file.
+	SEbyte* _Buffer;
+	int32 _BufferSize;
+
+	/// Decoded resource, registered by Update.
+	Resource* _Resource;
+
+	/// Requests this one waits for and requests waiting for it, only accessed by the main thread.
+	BaseArray<ResourceRequest*> _Dependencies;
+	BaseArray<ResourceRequest*> _Dependents;
+
+	BaseArray<ResourceRequestCallback> _Callbacks;
+};
+
+static bool HasPriority(const ResourceRequest* left, const ResourceRequest* right)
+{
+	if (left->_Priority != right->_Priority)
+		return (left->_Priority > right->_Priority);
+
+	return (left->_Sequence < right->_Sequence);
+}
+
+static void SetQueueItem(BaseArray<ResourceRequest*>& queue, int32 index, ResourceRequest* request)
+{
+	queue[index] = request;
+	request->_QueueIndex = index;
+}
+
+static void SiftUp(BaseArray<ResourceRequest*>& queue, int32 index)
+{
+	ResourceRequest* request = queue[index];
+	while (index > 0)
+	{
+		int32 parent = (index - 1) / 2;
+		if (!HasPriority(request, queue[parent]))
+			break;
+
+		SetQueueItem(queue, index, queue[parent]);
+		index = parent;
+	}
+
+	SetQueueItem(queue, index, request);
+}
+
+static void SiftDown(BaseArray<ResourceRequest*>& queue, int32 index)
+{
+	ResourceRequest* request = queue[index];
+	int32 count = queue.Count();
+	while (true)
+	{
+		int32 child = 2 * index + 1;
+		if (child >= count)
+			break;
+
+		if (child + 1 < count && HasPriority(queue[child + 1], queue[child]))
+			++child;
+
+		if (!HasPriority(queue[child], request))
+			break;
+
+		SetQueueItem(queue, index, queue[child]);
+		index = child;
+	}
+
+	SetQueueItem(queue, index, request);
+}
+
+static void PushRequest(BaseArray<ResourceRequest*>& queue, ResourceRequest* request)
+{
+	request->_Queue = &queue;
+	queue.Add(request);
+	SiftUp(queue, queue.Count() - 1);
+}
+
+static void RemoveRequest(ResourceRequest* request)
+{
+	BaseArray<ResourceRequest*>& queue = *request->_Queue;
+	int32 index = request->_QueueIndex;
+	int32 last = queue.Count() - 1;
+
+	request->_Queue = NULL;
+	request->_QueueIndex = -1;
+
+	if (index != last)
+	{
+		ResourceRequest* moved = queue[last];
+		SetQueueItem(queue, index, moved);
+		queue.RemoveAt(last);
+		SiftDown(queue, index);
+		SiftUp(queue, moved->_QueueIndex);
+	}
+	else
+	{
+		queue.RemoveAt(last);
+	}
+}
+
+/** Moves a request in its queue after a change of priority. */
+static void UpdateRequest(ResourceRequest* request)
+{
+	if (request->_Queue != NULL)
+	{
+		SiftUp(*request->_Queue, request->_QueueIndex);
+		SiftDown(*request->_Queue, request->_QueueIndex);
+	}
+}
+
+static void RemoveFromArray(BaseArray<ResourceRequest*>& requests, ResourceRequest* request)
+{
+	for (int32 i = 0; i < requests.Count(); ++i)
+	{
+		if (requests[i] == request)
+		{
+			requests.RemoveAt(i);
+			return;
+		}
+	}
+}
+
+/** Returns whether a request waits for another, directly or not. */
+static bool DependsOn(ResourceRequest* request, ResourceRequest* dependency)
+{
+	BaseArray<ResourceRequest*> stack;
+	stack.Add(request);
+	while (!stack.IsEmpty())
+	{
+		ResourceRequest* current = stack[stack.Count() - 1];
+		stack.RemoveAt(stack.Count() - 1);
+
+		for (int32 i = 0; i < current->_Dependencies.Count(); ++i)
+		{
+			if (current->_Dependencies[i] == dependency)
+				return true;
+
+			stack.Add(current->_Dependencies[i]);
+		}
+	}
+
+	return false;
+}
+
+
+/** Thread reading the files or decoding the resources of the requests. */
+class ResourceLoaderThread : public Thread
+{
+public:
+	ResourceLoaderThread(ResourceManager* manager, bool decode);
+
+	virtual void Run();
+
+protected:
+	ResourceManager* _manager;
+	bool _decode;
+};
+
+ResourceLoaderThread::ResourceLoaderThread(ResourceManager* manager, bool decode) :
+	Thread(),
+	_manager(manager),
+	_decode(decode)
+{
+}
+
+void ResourceLoaderThread::Run()
+{
+	Semaphore* semaphore = (_decode ? _manager->_DecodeSemaphore : _manager->_ReadSemaphore);
+	BaseArray<ResourceRequest*>& queue = (_decode ? _manager->_DecodeQueue : _manager->_ReadQueue);
+	ResourceState state = (_decode ? ResourceState_Decoding : ResourceState_Reading);
+
+	while (true)
+	{
+		// Released once per queued request, and once per thread to stop
+		semaphore->Wait();
+		if (Interlocked::Load(&_manager->_Running, MemoryOrder_Acquire) == 0)
+			break;
+
+		// The request may have been cancelled
+		ResourceRequest* request = _manager->TakeRequest(queue, state);
+		if (request == NULL)
+			continue;
+
+		if (_decode)
+			_manager->DecodeRequest(request);
+		else
+			_manager->ReadRequest(request);
+	}
+}
+
+
+ResourceManager::ResourceManager() :
+	_NextHandle(0),
+	_MemorySize(0),
+	_MemoryUsage(0),
+	_NextSequence(0),
+	_ReadSemaphore(NULL),
+	_DecodeSemaphore(NULL),
+	_Running(0),
+	_TimeBudget(DefaultTimeBudget)
 {
 }
 
 ResourceManager::~ResourceManager()
 {
+	DestroyThreads();
 }
 
 void ResourceManager::Create()
@@ -28,6 +291,29 @@ void ResourceManager::Create()
 
 void ResourceManager::Destroy()
 {
+	DestroyThreads();
+
+	// No thread holds a request anymore
+	BaseArray<ResourceRequest*> requests = _Requests.Values();
+	for (int32 i = 0; i < requests.Count(); ++i)
+	{
+		ResourceRequest* request = requests[i];
+		if (request->_Resource != NULL)
+		{
+			request->_Handler->Unload(request->_Resource);
+			delete request->_Resource;
+		}
+		DeleteRequest(request);
+	}
+
+	_Requests.Clear();
+	_RequestNames.Clear();
+	_FinishedRequests.Clear();
+	_ReadQueue.Clear();
+	_DecodeQueue.Clear();
+	_MainDecodeQueue.Clear();
+	_CompletedRequests.Clear();
+
 	ResourceHandlerList::Iterator it = _ResourceHandlers.GetIterator();
 	while (it.Next())
 	{
@@ -62,6 +348,8 @@ ResourceHandler* ResourceManager::FindHandler(const SE_ID& type) const
 
 Resource* ResourceManager::Load(const String& name, const SE_ID& type, const String& path, Stream& stream)
 {
+	SE_MEMORY_TAG(MemoryTag_Resources);
+
 	Resource* resource = ResourceManager::Get(name);
 	if (resource != NULL)
 	{
@@ -77,9 +365,19 @@ Resource* ResourceManager::Load(const String& name, const SE_ID& type, const Str
 		resource = handler->Load(name, type, path, stream);
 		if (resource != NULL)
 		{
-			resource->_handle = GetNextHandle();
-			_resourceNames.Add(resource->GetName(), resource);
-			_ResourceHandles.Add(resource->GetHandle(), resource);
+			// The handle returned by LoadAsync resolves to this resource, and
+			// its request is completed with it
+			ResourceRequest** request = _RequestNames.Find(name);
+			if (request != NULL && IsPending((ResourceState)Interlocked::Load(&(*request)->_State)) &&
+				(resource->GetName().IsEmpty() || resource->GetName() == name))
+			{
+				RegisterResource(resource, (*request)->_Handle, name, path);
+				Cancel((*request)->_Handle);
+			}
+			else
+			{
+				RegisterResource(resource, GetNextHandle(), name, path);
+			}
 		}
 		return resource;
 	}
@@ -124,24 +422,748 @@ bool ResourceManager::Unload(Resource* resource)
 
 Resource* ResourceManager::Get(const String& name)
 {
-	if (_resourceNames.Contains(name))
+	Resource** resource = _resourceNames.Find(name);
+	return (resource != NULL ? *resource : NULL);
+}
+
+Resource* ResourceManager::Get(ResourceHandle handle)
+{
+	Resource** resource = _ResourceHandles.Find(handle);
+	return (resource != NULL ? *resource : NULL);
+}
+
+void ResourceManager::RegisterResource(Resource* resource, ResourceHandle handle, const String& name, const String& path)
+{
+	// The handlers don't always name the resources
+	if (resource->GetName().IsEmpty())
+		resource->SetName(name);
+
+	if (resource->GetSourceName().IsEmpty())
+		resource->SetSourceName(path);
+
+	resource->_handle = handle;
+	_resourceNames.Add(resource->GetName(), resource);
+	_ResourceHandles.Add(resource->GetHandle(), resource);
+}
+
+void ResourceManager::UnloadResource(Resource* resource)
+{
+	resource->Unload();
+
+	ResourceHandler* handler = FindHandler(resource->GetResourceType());
+	if (handler != NULL)
 	{
-		return _resourceNames[name];
+		handler->Unload(resource);
 	}
-	else
+}
+
+void ResourceManager::UnloadAll()
+{
+	// The requests being loaded are dropped when they are finished
+	BaseArray<ResourceRequest*> requests = _Requests.Values();
+	for (int32 i = 0; i < requests.Count(); ++i)
 	{
-		return NULL;
+		Unload(requests[i]->_Handle);
 	}
+
+	BaseArray<Resource*> resources = _ResourceHandles.Values();
+	for (int32 i = 0; i < resources.Count(); ++i)
+	{
+		UnloadResource(resources[i]);
+	}
+
+	_resourceNames.Clear();
+	_ResourceHandles.Clear();
 }
 
-Resource* ResourceManager::Get(ResourceHandle handle)
+void ResourceManager::ReloadAll()
+{
+	BaseArray<ResourceHandle> handles = _ResourceHandles.Keys();
+	for (int32 i = 0; i < handles.Count(); ++i)
+	{
+		Reload(handles[i]);
+	}
+}
+
+void ResourceManager::Unload(const String& name)
 {
+	ResourceRequest** request = _RequestNames.Find(name);
+	if (request != NULL)
+	{
+		Unload((*request)->_Handle);
+		return;
+	}
+
+	Resource* resource = Get(name);
+	if (resource != NULL)
+	{
+		Unload(resource->GetHandle());
+	}
+}
+
+void ResourceManager::Unload(ResourceHandle handle)
+{
+	ResourceRequest** found = _Requests.Find(handle);
+	if (found != NULL)
+	{
+		ResourceRequest* request = *found;
+		if (IsPending((ResourceState)Interlocked::Load(&request->_State)))
+		{
+			Cancel(handle);
+		}
+		else
+		{
+			ReleaseRequest(request);
+		}
+	}
+
+	// A resource loaded by Load while its request is pending has the same handle
 	if (_ResourceHandles.Contains(handle))
 	{
-		return _ResourceHandles[handle];}	else
+		Resource* resource = _ResourceHandles[handle];
+		UnloadResource(resource);
+
+		String name = resource->GetName();
+		_ResourceHandles.Remove(handle);
+		_resourceNames.Remove(name);
+	}
+}
+
+bool ResourceManager::Reload(const String& name)
+{
+	Resource* resource = Get(name);
+	if (resource == NULL)
+		return false;
+
+	return Reload(resource->GetHandle());
+}
+
+bool ResourceManager::Reload(ResourceHandle handle)
+{
+	Resource* resource = Get(handle);
+	if (resource == NULL)
+		return false;
+
+	String path = resource->GetSourceName();
+	if (path.IsEmpty())
+		return false;
+
+	ResourceHandler* handler = FindHandler(resource->GetResourceType());
+	if (handler == NULL)
+		return false;
+
+	File file(path);
+	FileStreamPtr stream = file.Open(FileMode_Open, FileAccess_Read, FileShare_Read);
+	if (stream == NULL)
+		return false;
+
+	SE_MEMORY_TAG(MemoryTag_Resources);
+
+	Resource* reloaded = handler->Load(resource->GetName(), resource->GetResourceType(), path, *stream);
+	stream->Close();
+	if (reloaded == NULL)
+		return false;
+
+	// The Resource object is kept, the users only see its data change
+	handler->Unload(resource);
+	resource->SetData(reloaded->GetData());
+	resource->SetSize(reloaded->GetSize());
+
+	reloaded->SetData(NULL);
+	delete reloaded;
+
+	return true;
+}
+
+void ResourceManager::CreateThreads(int32 readThreadCount, int32 decodeThreadCount)
+{
+	if (IsThreaded())
+	{
+		return;
+	}
+
+	if (readThreadCount < 1)
+	{
+		readThreadCount = 1;
+	}
+
+	if (decodeThreadCount < 0)
+	{
+		decodeThreadCount = Environment::ProcessorCount() - 1;
+		if (decodeThreadCount < 0)
+		{
+			decodeThreadCount = 0;
+		}
+	}
+
+	// Released once per queued request, there is no useful maximum
+	_ReadSemaphore = new Semaphore(0, 0x7FFFFFFF);
+	_DecodeSemaphore = new Semaphore(0, 0x7FFFFFFF);
+	Interlocked::Store(&_Running, 1);
+
+	// The read threads look at the decode threads when they queue a request
+	int32 i;
+	for (i = 0; i < decodeThreadCount; ++i)
 	{
+		_DecodeThreads.Add(new ResourceLoaderThread(this, true));
+	}
+	for (i = 0; i < readThreadCount; ++i)
+	{
+		_ReadThreads.Add(new ResourceLoaderThread(this, false));
+	}
+
+	for (i = 0; i < _DecodeThreads.Count(); ++i)
+	{
+		_DecodeThreads[i]->Start();
+	}
+	for (i = 0; i < _ReadThreads.Count(); ++i)
+	{
+		_ReadThreads[i]->Start();
+	}
+
+	// The requests queued before the threads
+	MutexLocker locker(&_QueueLock);
+	if (!_ReadQueue.IsEmpty())
+	{
+		_ReadSemaphore->Release(_ReadQueue.Count());
+	}
+}
+
+void ResourceManager::DestroyThreads()
+{
+	if (!IsThreaded())
+	{
+		return;
+	}
+
+	Interlocked::Store(&_Running, 0);
+	_ReadSemaphore->Release(_ReadThreads.Count());
+	if (!_DecodeThreads.IsEmpty())
+	{
+		_DecodeSemaphore->Release(_DecodeThreads.Count());
+	}
+
+	int32 i;
+	for (i = 0; i < _ReadThreads.Count(); ++i)
+	{
+		_ReadThreads[i]->Join(Thread::Infinite);
+		delete _ReadThreads[i];
+	}
+	for (i = 0; i < _DecodeThreads.Count(); ++i)
+	{
+		_DecodeThreads[i]->Join(Thread::Infinite);
+		delete _DecodeThreads[i];
+	}
+	_ReadThreads.Clear();
+	_DecodeThreads.Clear();
+
+	// The requests left are decoded by Update
+	ResourceRequest* request;
+	while ((request = TakeRequest(_DecodeQueue, ResourceState_Decoding)) != NULL)
+	{
+		MutexLocker locker(&_QueueLock);
+		PushRequest(_MainDecodeQueue, request);
+	}
+
+	SE_DELETE(_ReadSemaphore);
+	SE_DELETE(_DecodeSemaphore);
+}
+
+bool ResourceManager::IsPending(ResourceState state)
+{
+	return (state == ResourceState_Queued || state == ResourceState_Reading ||
+		state == ResourceState_Waiting || state == ResourceState_Decoding);
+}
+
+ResourceHandle ResourceManager::LoadAsync(const String& name, const SE_ID& type, const String& path, real32 priority, ResourceCallback callback, void* userData)
+{
+	Resource* resource = Get(name);
+	if (resource != NULL)
+	{
+		if (resource->GetResourceType() != type)
+			return ResourceHandleInvalid;
+
+		if (callback != NULL)
+			callback(resource->GetHandle(), ResourceState_Loaded, resource, userData);
+
+		return resource->GetHandle();
+	}
+
+	ResourceRequest* request;
+	ResourceRequest** found = _RequestNames.Find(name);
+	if (found != NULL)
+	{
+		request = *found;
+		bool pending = IsPending((ResourceState)Interlocked::Load(&request->_State));
+		if (pending && Interlocked::Load(&request->_Cancelled) == 0)
+		{
+			if (request->_Type != type)
+				return ResourceHandleInvalid;
+
+			if (callback != NULL)
+			{
+				ResourceRequestCallback& requestCallback = request->_Callbacks.EmplaceBack();
+				requestCallback._Callback = callback;
+				requestCallback._UserData = userData;
+			}
+
+			MutexLocker locker(&_QueueLock);
+			RaisePriority(request, priority);
+			return request->_Handle;
+		}
+
+		// A cancelled request keeps loading under its handle until it is finished
+		if (pending)
+		{
+			_RequestNames.Remove(name);
+		}
+		else
+		{
+			ReleaseRequest(request);
+		}
+	}
+
+	ResourceHandler* handler = FindHandler(type);
+	if (handler == NULL)
+		return ResourceHandleInvalid;
+
+	request = new ResourceRequest();
+	request->_Handle = GetNextHandle();
+	request->_Name = name;
+	request->_Type = type;
+	request->_Path = path;
+	request->_Handler = handler;
+	request->_Priority = priority;
+	if (callback != NULL)
+	{
+		ResourceRequestCallback& requestCallback = request->_Callbacks.EmplaceBack();
+		requestCallback._Callback = callback;
+		requestCallback._UserData = userData;
+	}
+
+	_Requests.Add(request->_Handle, request);
+	_RequestNames.Add(name, request);
+
+	MutexLocker locker(&_QueueLock);
+	request->_Sequence = _NextSequence++;
+	PushRequest(_ReadQueue, request);
+	if (IsThreaded())
+	{
+		_ReadSemaphore->Release();
+	}
+
+	return request->_Handle;
+}
+
+ResourceState ResourceManager::GetState(ResourceHandle handle) const
+{
+	if (_ResourceHandles.Contains(handle))
+		return ResourceState_Loaded;
+
+	ResourceRequest* const* found = _Requests.Find(handle);
+	if (found == NULL)
+		return ResourceState_Invalid;
+
+	ResourceRequest* request = *found;
+	ResourceState state = (ResourceState)Interlocked::Load(&request->_State);
+	if (IsPending(state) && Interlocked::Load(&request->_Cancelled) != 0)
+		return ResourceState_Cancelled;
+
+	return state;
+}
+
+bool ResourceManager::SetPriority(ResourceHandle handle, real32 priority)
+{
+	ResourceRequest** found = _Requests.Find(handle);
+	if (found == NULL)
+		return false;
+
+	ResourceRequest* request = *found;
+	if (!IsPending((ResourceState)Interlocked::Load(&request->_State)))
+		return false;
+
+	MutexLocker locker(&_QueueLock);
+	request->_Priority = priority;
+	UpdateRequest(request);
+
+	for (int32 i = 0; i < request->_Dependencies.Count(); ++i)
+	{
+		RaisePriority(request->_Dependencies[i], priority);
+	}
+
+	return true;
+}
+
+void ResourceManager::RaisePriority(ResourceRequest* request, real32 priority)
+{
+	if (request->_Priority >= priority)
+		return;
+
+	request->_Priority = priority;
+	UpdateRequest(request);
+
+	for (int32 i = 0; i < request->_Dependencies.Count(); ++i)
+	{
+		RaisePriority(request->_Dependencies[i], priority);
+	}
+}
+
+bool ResourceManager::AddDependency(ResourceHandle handle, ResourceHandle dependency)
+{
+	ResourceRequest** found = _Requests.Find(handle);
+	if (found == NULL)
+		return false;
+
+	ResourceRequest* request = *found;
+	if (!IsPending((ResourceState)Interlocked::Load(&request->_State)) ||
+		Interlocked::Load(&request->_Cancelled) != 0)
+		return false;
+
+	found = _Requests.Find(dependency);
+	if (found == NULL || !IsPending((ResourceState)Interlocked::Load(&(*found)->_State)))
+	{
+		// A finished dependency doesn't delay the request
+		return (found != NULL || _ResourceHandles.Contains(dependency));
+	}
+
+	ResourceRequest* dependencyRequest = *found;
+	if (dependencyRequest == request || DependsOn(dependencyRequest, request))
+		return false;
+
+	for (int32 i = 0; i < request->_Dependencies.Count(); ++i)
+	{
+		if (request->_Dependencies[i] == dependencyRequest)
+			return true;
+	}
+
+	// The read thread may release the last blocker at the same time
+	int32 blockers;
+	do
+	{
+		blockers = Interlocked::Load(&request->_Blockers);
+		if (blockers == 0)
+			return false;
+	}
+	while (Interlocked::CompareExchange(&request->_Blockers, blockers + 1, blockers) != blockers);
+
+	request->_Dependencies.Add(dependencyRequest);
+	dependencyRequest->_Dependents.Add(request);
+
+	MutexLocker locker(&_QueueLock);
+	RaisePriority(dependencyRequest, request->_Priority);
+
+	return true;
+}
+
+bool ResourceManager::Cancel(ResourceHandle handle)
+{
+	ResourceRequest** found = _Requests.Find(handle);
+	if (found == NULL)
+		return false;
+
+	ResourceRequest* request = *found;
+	if (!IsPending((ResourceState)Interlocked::Load(&request->_State)) ||
+		Interlocked::Load(&request->_Cancelled) != 0)
+		return false;
+
+	MutexLocker locker(&_QueueLock);
+	Interlocked::Store(&request->_Cancelled, 1);
+
+	// The other requests are completed by the thread holding them, or
+	// once their dependencies are finished
+	if (request->_Queue != NULL)
+	{
+		RemoveRequest(request);
+		_CompletedRequests.Add(request);
+	}
+
+	return true;
+}
+
+void ResourceManager::Update()
+{
+	Timer timer;
+	timer.Start();
+	real64 budget = _TimeBudget * 1.0e-6;
+
+	ResourceRequest* request;
+
+	// Without threads, the files are read here
+	if (!IsThreaded())
+	{
+		while (timer.Elapsed() < budget)
+		{
+			request = TakeRequest(_ReadQueue, ResourceState_Reading);
+			if (request == NULL)
+				break;
+
+			ReadRequest(request);
+		}
+	}
+
+	// At least one resource is decoded per update so the loads always progress
+	bool first = true;
+	while (first || timer.Elapsed() < budget)
+	{
+		request = TakeRequest(_MainDecodeQueue, ResourceState_Decoding);
+		if (request == NULL)
+			break;
+
+		DecodeRequest(request);
+		first = false;
+	}
+
+	ProcessCompletedRequests();
+}
+
+ResourceState ResourceManager::Wait(ResourceHandle handle)
+{
+	ResourceState state = GetState(handle);
+	while (IsPending(state))
+	{
+		Update();
+
+		state = GetState(handle);
+		if (IsPending(state) && IsThreaded())
+		{
+			Thread::Sleep(1);
+		}
+	}
+
+	return state;
+}
+
+ResourceRequest* ResourceManager::TakeRequest(BaseArray<ResourceRequest*>& queue, ResourceState state)
+{
+	MutexLocker locker(&_QueueLock);
+	if (queue.IsEmpty())
 		return NULL;
+
+	ResourceRequest* request = queue[0];
+	RemoveRequest(request);
+	Interlocked::Store(&request->_State, state);
+
+	return request;
+}
+
+void ResourceManager::ReadRequest(ResourceRequest* request)
+{
+	bool succeeded = false;
+
+	File file(request->_Path);
+	FileStreamPtr stream = file.Open(FileMode_Open, FileAccess_Read, FileShare_Read);
+	if (stream != NULL)
+	{
+		// The handlers read from a memory stream, limited to 32 bits
+		int64 length = stream->GetLength();
+		if (length >= 0 && length <= 0x7FFFFFFF)
+		{
+			int32 size = (int32)length;
+			request->_Buffer = new SEbyte[size];
+			request->_BufferSize = size;
+
+			int32 offset = 0;
+			while (offset < size && Interlocked::Load(&request->_Cancelled, MemoryOrder_Relaxed) == 0)
+			{
+				int32 count = (size - offset < ReadBlockSize ? size - offset : ReadBlockSize);
+				int32 read = stream->Read(request->_Buffer + offset, count);
+				if (read <= 0)
+					break;
+
+				offset += read;
+			}
+
+			succeeded = (offset == size);
+		}
+
+		stream->Close();
 	}
+
+	if (!succeeded || Interlocked::Load(&request->_Cancelled) != 0)
+	{
+		CompleteRequest(request);
+		return;
+	}
+
+	MemoryStream memoryStream(request->_Buffer, request->_BufferSize, false);
+	request->_Async = request->_Handler->CanLoadAsync(request->_Type, memoryStream);
+
+	// The last dependency may be finished by the main thread at the same
+	// time, the request is not touched once the read is released
+	Interlocked::Store(&request->_State, ResourceState_Waiting);
+	if (Interlocked::Decrement(&request->_Blockers) == 0)
+	{
+		QueueDecode(request);
+	}
+}
+
+void ResourceManager::QueueDecode(ResourceRequest* request)
+{
+	MutexLocker locker(&_QueueLock);
+	if (Interlocked::Load(&request->_Cancelled) != 0)
+	{
+		_CompletedRequests.Add(request);
+		return;
+	}
+
+	Interlocked::Store(&request->_State, ResourceState_Decoding);
+	if (request->_Async && !_DecodeThreads.IsEmpty())
+	{
+		PushRequest(_DecodeQueue, request);
+		_DecodeSemaphore->Release();
+	}
+	else
+	{
+		PushRequest(_MainDecodeQueue, request);
+	}
+}
+
+void ResourceManager::DecodeRequest(ResourceRequest* request)
+{
+	if (Interlocked::Load(&request->_Cancelled) == 0)
+	{
+		SE_MEMORY_TAG(MemoryTag_Resources);
+
+		// The handler can keep the buffer instead of copying it
+		request->_Resource = request->_Handler->LoadBuffer(request->_Name, request->_Type, request->_Path,
+			request->_Buffer, request->_BufferSize);
+	}
+
+	SE_DELETE_ARRAY(request->_Buffer);
+	request->_BufferSize = 0;
+
+	CompleteRequest(request);
+}
+
+void ResourceManager::CompleteRequest(ResourceRequest* request)
+{
+	MutexLocker locker(&_QueueLock);
+	_CompletedRequests.Add(request);
+}
+
+void ResourceManager::ProcessCompletedRequests()
+{
+	// Finishing a request can queue or complete its dependents
+	while (true)
+	{
+		BaseArray<ResourceRequest*> requests;
+		_QueueLock.Enter();
+		requests.Swap(_CompletedRequests);
+		_QueueLock.Exit();
+
+		if (requests.IsEmpty())
+			break;
+
+		for (int32 i = 0; i < requests.Count(); ++i)
+		{
+			FinishRequest(requests[i]);
+		}
+	}
+}
+
+void ResourceManager::FinishRequest(ResourceRequest* request)
+{
+	int32 i;
+	ResourceState state;
+	Resource* resource = request->_Resource;
+	request->_Resource = NULL;
+	SE_DELETE_ARRAY(request->_Buffer);
+	request->_BufferSize = 0;
+
+	// The resource may have been loaded by Load in the meantime, under the
+	// handle of the request, or by another name given by its handler
+	Resource* existing = Get(request->_Handle);
+	if (existing == NULL && Interlocked::Load(&request->_Cancelled) == 0)
+	{
+		existing = Get(request->_Name);
+	}
+
+	if (resource != NULL && (existing != NULL || Interlocked::Load(&request->_Cancelled) != 0))
+	{
+		request->_Handler->Unload(resource);
+		delete resource;
+		resource = NULL;
+	}
+
+	if (existing != NULL)
+	{
+		resource = existing;
+		state = ResourceState_Loaded;
+	}
+	else if (Interlocked::Load(&request->_Cancelled) != 0)
+	{
+		state = ResourceState_Cancelled;
+	}
+	else if (resource == NULL)
+	{
+		state = ResourceState_Failed;
+	}
+	else
+	{
+		RegisterResource(resource, request->_Handle, request->_Name, request->_Path);
+		state = ResourceState_Loaded;
+	}
+	Interlocked::Store(&request->_State, state);
+
+	for (i = 0; i < request->_Dependencies.Count(); ++i)
+	{
+		RemoveFromArray(request->_Dependencies[i]->_Dependents, request);
+	}
+	request->_Dependencies.Clear();
+
+	BaseArray<ResourceRequest*> dependents;
+	dependents.Swap(request->_Dependents);
+	for (i = 0; i < dependents.Count(); ++i)
+	{
+		ResourceRequest* dependent = dependents[i];
+		RemoveFromArray(dependent->_Dependencies, request);
+		if (Interlocked::Decrement(&dependent->_Blockers) == 0)
+		{
+			QueueDecode(dependent);
+		}
+	}
+
+	// The callbacks may load or unload other resources
+	BaseArray<ResourceRequestCallback> callbacks;
+	callbacks.Swap(request->_Callbacks);
+	ResourceHandle handle = request->_Handle;
+
+	// The most recent failed and cancelled requests are kept for GetState
+	if (state == ResourceState_Loaded)
+	{
+		ReleaseRequest(request);
+	}
+	else
+	{
+		_FinishedRequests.Add(request);
+		if (_FinishedRequests.Count() > MaxFinishedRequestCount)
+		{
+			ReleaseRequest(_FinishedRequests[0]);
+		}
+	}
+
+	for (i = 0; i < callbacks.Count(); ++i)
+	{
+		callbacks[i]._Callback(handle, state, resource, callbacks[i]._UserData);
+	}
+}
+
+void ResourceManager::ReleaseRequest(ResourceRequest* request)
+{
+	_Requests.Remove(request->_Handle);
+	ResourceRequest** named = _RequestNames.Find(request->_Name);
+	if (named != NULL && *named == request)
+	{
+		_RequestNames.Remove(request->_Name);
+	}
+	RemoveFromArray(_FinishedRequests, request);
+	DeleteRequest(request);
+}
+
+void ResourceManager::DeleteRequest(ResourceRequest* request)
+{
+	SE_DELETE_ARRAY(request->_Buffer);
+	delete request;
 }
 
 }
@@ -11,24 +11,81 @@ Author: Julien Delezenne
 #include "Core/Singleton.h"
 #include "Core/String.h"
 #include "Core/SE_ID.h"
-#include "Core/Containers/Dictionary.h"
+#include "Core/Containers/Hashtable.h"
 #include "Core/Resource/Resource.h"
 #include "Core/Resource/ResourceHandler.h"
+#include "Core/Threading/Mutex.h"
+#include "Core/Threading/Semaphore.h"
 
 namespace SonataEngine
 {
 
+struct ResourceRequest;
+class ResourceLoaderThread;
+
+/** Loading states of a resource. */
+enum ResourceState
+{
+	/// The handle is neither a resource nor a request.
+	ResourceState_Invalid,
+
+	/// The file of the resource waits to be read.
+	ResourceState_Queued,
+
+	/// The file of the resource is being read.
+	ResourceState_Reading,
+
+	/// The file was read and the resource waits for its dependencies.
+	ResourceState_Waiting,
+
+	/// The resource waits to be decoded or is being decoded.
+	ResourceState_Decoding,
+
+	/// The resource is loaded.
+	ResourceState_Loaded,
+
+	/// The file could not be read or decoded.
+	ResourceState_Failed,
+
+	/// The request was cancelled.
+	ResourceState_Cancelled
+};
+
+/**
+	Represents the method called on the main thread when an asynchronous
+	load is finished. The resource is NULL unless the state is
+	ResourceState_Loaded.
+*/
+typedef void (*ResourceCallback)(ResourceHandle handle, ResourceState state, Resource* resource, void* userData);
+
 /** @brief Resource manager.
 	This class is responsible for managing the external resources.
 	It contains a list of resource handlers that are implemented
 	for each type of resource.
+
+	The resources are loaded either at once by Load, or in the background
+	by LoadAsync which returns the handle of the resource immediately:
+	- The files are read by dedicated threads, the request with the highest
+	priority first.
+	- The resources are then decoded by worker threads when their handler
+	supports it, or else by Update on the main thread within a time budget.
+	- A resource is decoded only after its dependencies are finished, such
+	as a model after its textures.
+	- Update registers the loaded resources and calls the callbacks of the
+	requests, so the callbacks are always called on the main thread.
+
+	Without threads, the files are read by Update within the time budget.
+	@remarks
+		The methods must be called from the main thread. The handlers
+		returning true from ResourceHandler::CanLoadAsync must be able to
+		load resources concurrently.
 */
 class SE_CORE_EXPORT ResourceManager : public Singleton<ResourceManager>
 {
 public:
 	typedef Array<ResourceHandler*> ResourceHandlerList;
-	typedef Dictionary<String, Resource*> ResourceNameList;
-	typedef Dictionary<ResourceHandle, Resource*> ResourceHandleList;
+	typedef Hashtable<String, Resource*> ResourceNameList;
+	typedef Hashtable<ResourceHandle, Resource*> ResourceHandleList;
 
 protected:
 	ResourceHandlerList _ResourceHandlers;
@@ -40,6 +97,30 @@ protected:
 	uint32 _MemorySize;
 	uint32 _MemoryUsage;
 
+	/// Asynchronous requests, only accessed by the main thread.
+	Hashtable<ResourceHandle, ResourceRequest*> _Requests;
+	Hashtable<String, ResourceRequest*> _RequestNames;
+
+	/// Failed and cancelled requests kept for GetState, the oldest first.
+	BaseArray<ResourceRequest*> _FinishedRequests;
+
+	/// Priority queues shared with the threads, guarded by _QueueLock.
+	Mutex _QueueLock;
+	BaseArray<ResourceRequest*> _ReadQueue;
+	BaseArray<ResourceRequest*> _DecodeQueue;
+	BaseArray<ResourceRequest*> _MainDecodeQueue;
+	BaseArray<ResourceRequest*> _CompletedRequests;
+	uint32 _NextSequence;
+
+	Semaphore* _ReadSemaphore;
+	Semaphore* _DecodeSemaphore;
+	BaseArray<ResourceLoaderThread*> _ReadThreads;
+	BaseArray<ResourceLoaderThread*> _DecodeThreads;
+	volatile int32 _Running;
+
+	/// Time spent by Update in the main thread loads, in microseconds.
+	int32 _TimeBudget;
+
 public:
 	ResourceManager();
 	virtual ~ResourceManager();
@@ -77,47 +158,108 @@ public:
 
 	ResourceHandle AddResource(Resource* value);
 
-	void UnloadAll()
-	{
-	}
-
-	void ReloadAll()
-	{
-	}
-
-	void Unload(const String& name)
-	{
-		if (_resourceNames.Contains(name))
-		{
-			Resource* resource = _resourceNames[name];
-			resource->Unload();
-
-			ResourceHandle handle = resource->GetHandle();
-			_resourceNames.Remove(name);
-			_ResourceHandles.Remove(handle);
-		}
-	}
-
-	void Unload(ResourceHandle handle)
-	{
-		if (_ResourceHandles.Contains(handle))
-		{
-			Resource* resource = _ResourceHandles[handle];
-			resource->Unload();
-
-			String name = resource->GetName();
-			_ResourceHandles.Remove(handle);
-			_resourceNames.Remove(name);
-		}
-	}
-
-	void Reload(const String& name)
-	{
-	}
-
-	void Reload(ResourceHandle handle)
-	{
-	}
+	/**
+		Cancels the requests and unloads all the resources.
+		The data of the resources is released by their handler, the Resource
+		objects stay valid for the users holding them.
+	*/
+	void UnloadAll();
+
+	/** Reloads all the resources from their files. */
+	void ReloadAll();
+
+	/** Unloads a resource, or cancels its request. */
+	void Unload(const String& name);
+	void Unload(ResourceHandle handle);
+
+	/**
+		Reloads a resource from its file. The Resource object is kept and its
+		data is replaced.
+		@return true if successful; otherwise, false.
+	*/
+	bool Reload(const String& name);
+	bool Reload(ResourceHandle handle);
+
+	/** @name Asynchronous loading. */
+	//@{
+	/**
+		Starts the loading threads.
+		@param readThreadCount The number of threads reading the files.
+		@param decodeThreadCount The number of threads decoding the resources.
+			Specify -1 to create one thread per additional processor.
+	*/
+	void CreateThreads(int32 readThreadCount = 1, int32 decodeThreadCount = -1);
+
+	/**
+		Stops the loading threads once their current request is done. The
+		pending requests are then loaded by Update.
+	*/
+	void DestroyThreads();
+
+	/** Gets whether the loading threads are created. */
+	bool IsThreaded() const { return (_ReadThreads.Count() != 0); }
+
+	/** Gets or sets the time spent by Update loading on the main thread, in microseconds. */
+	int32 GetTimeBudget() const { return _TimeBudget; }
+	void SetTimeBudget(int32 value) { _TimeBudget = value; }
+
+	/**
+		Starts loading a resource in the background.
+		If the resource is loaded or being loaded, its handle is returned, the
+		priority of its request is raised and the callback is added to it.
+		@param name The name of the resource.
+		@param type The type of the resource.
+		@param path The file of the resource.
+		@param priority The requests with the highest priority are loaded first.
+		@param callback The method called by Update when the load is finished.
+		@param userData The data passed to the callback.
+		@return The handle of the resource. A resource loaded by Load while
+			its request is pending is given the same handle.
+	*/
+	ResourceHandle LoadAsync(const String& name, const SE_ID& type, const String& path, real32 priority = 0.0f, ResourceCallback callback = NULL, void* userData = NULL);
+
+	/**
+		Gets the loading state of a resource.
+		The most recent failed and cancelled requests keep their state until
+		they are unloaded or loaded again, the older ones are released and
+		their state is ResourceState_Invalid.
+	*/
+	ResourceState GetState(ResourceHandle handle) const;
+
+	/**
+		Changes the priority of a request, such as from the distance to the
+		camera. The priority of its dependencies is raised to the same value.
+		@return false if the resource is not being loaded.
+	*/
+	bool SetPriority(ResourceHandle handle, real32 priority);
+
+	/**
+		Delays the decoding of a resource until another is finished, loaded
+		or not.
+		@param handle The resource to delay. Must not be decoding yet.
+		@param dependency The resource it depends on.
+		@return false if the dependency cannot be added, such as for a cycle.
+	*/
+	bool AddDependency(ResourceHandle handle, ResourceHandle dependency);
+
+	/**
+		Cancels a request. A request that is read or decoded by a thread is
+		cancelled when the thread is done, and a request waiting for its
+		dependencies when they are finished.
+		@return false if the resource is not being loaded.
+	*/
+	bool Cancel(ResourceHandle handle);
+
+	/**
+		Loads on the main thread within the time budget, registers the loaded
+		resources and calls the callbacks of the finished requests.
+		Must be called once per frame.
+	*/
+	void Update();
+
+	/** Updates until a request is finished and returns its final state. */
+	ResourceState Wait(ResourceHandle handle);
+	//@}
 
 	Array<String>::Iterator GetResourceNameIterator() const
 	{
@@ -153,7 +295,8 @@ public:
 
 	void SetResourceName(ResourceHandle handle, const String& name)
 	{
-		if (_ResourceHandles.Contains(handle) && !_resourceNames.Contains(name))
+		// The name of a request is kept for the resource it loads
+		if (_ResourceHandles.Contains(handle) && !_resourceNames.Contains(name) && !_RequestNames.Contains(name))
 		{
 			Resource* resource = _ResourceHandles[handle];
 			_resourceNames.Remove(resource->GetName());
@@ -167,6 +310,42 @@ protected:
 	{
 		return _NextHandle++;
 	}
+
+	friend class ResourceLoaderThread;
+
+	static bool IsPending(ResourceState state);
+
+	/** Adds a resource to the tables of the names and the handles. */
+	void RegisterResource(Resource* resource, ResourceHandle handle, const String& name, const String& path);
+
+	/** Releases the data of a resource, which stays in the tables. */
+	void UnloadResource(Resource* resource);
+
+	/** Raises the priority of a request and of its dependencies, while holding the lock. */
+	void RaisePriority(ResourceRequest* request, real32 priority);
+
+	/** Removes the request with the highest priority from a queue and sets its state. */
+	ResourceRequest* TakeRequest(BaseArray<ResourceRequest*>& queue, ResourceState state);
+
+	/** Reads the file of a request, then queues it for decoding if it doesn't wait for a dependency. */
+	void ReadRequest(ResourceRequest* request);
+
+	/** Queues a request for decoding on a thread or on the main thread. */
+	void QueueDecode(ResourceRequest* request);
+
+	void DecodeRequest(ResourceRequest* request);
+
+	/** Passes a request to the next Update. */
+	void CompleteRequest(ResourceRequest* request);
+
+	/** Finishes the completed requests and calls their callbacks. */
+	void ProcessCompletedRequests();
+	void FinishRequest(ResourceRequest* request);
+
+	/** Removes a finished request from the tables and deletes it. */
+	void ReleaseRequest(ResourceRequest* request);
+
+	void DeleteRequest(ResourceRequest* request);
 };
 
 }
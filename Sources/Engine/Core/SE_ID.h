@@ -9,6 +9,7 @@ Author: Julien Delezenne
 
 #include "Core/Common.h"
 #include "Core/String.h"
+#include "Core/Containers/Hash.h"
 #include "Core/Exception/ArgumentException.h"
 
 namespace SonataEngine
@@ -64,6 +65,19 @@ public:
 	friend Stream& operator>>(Stream& stream, SE_ID& id);
 };
 
+/** Hash function for the SE_IDs. */
+template <>
+struct Hash<SE_ID>
+{
+	uint32 operator()(const SE_ID& value) const
+	{
+		uint32 hash = SE_HashUInt32(value.Data1);
+		hash = SE_HashCombine(hash, SE_HashUInt32(value.Data2));
+		hash = SE_HashCombine(hash, SE_HashUInt32(value.Data3));
+		return SE_HashCombine(hash, SE_HashUInt32(value.Data4));
+	}
+};
+
 #include "SE_ID.inl"
 
 }
@@ -6,244 +6,643 @@ Author: Julien Delezenne
 
 #include "BinarySerializer.h"
 #include "Core/IO/BinaryStream.h"
+#include "Core/Exception/FormatException.h"
 #include "Core/Logging/Logger.h"
 
 namespace SonataEngine
 {
 
-template <typename T>
-class VariantHolder
+const uint32 BinarySerializer::Magic = 0x53424553;
+const uint16 BinarySerializer::Version = 1;
+
+BinarySerializer::BinarySerializer()
+{
+}
+
+BinarySerializer::~BinarySerializer()
+{
+	Hashtable<TypeInfo*, TypePlan*>::Iterator it = _WritePlans.GetIterator();
+	while (it.Next())
+	{
+		delete it.Value();
+	}
+	_WritePlans.Clear();
+
+	ClearReadTypes();
+}
+
+void BinarySerializer::ClearWriteTypes()
+{
+	_WriteTypes.Clear();
+	_WriteTypePlans.Clear();
+}
+
+void BinarySerializer::ClearReadTypes()
+{
+	int32 count = _ReadTypes.Count();
+	for (int32 i = 0; i < count; i++)
+	{
+		delete _ReadTypes[i];
+	}
+	_ReadTypes.Clear();
+}
+
+BinarySerializer::FieldKind BinarySerializer::GetFieldKind(TypeInfo* type)
+{
+	if (type == NULL)
+		return FieldKind_None;
+
+	if (type == typeof(bool))
+		return FieldKind_Bool;
+	if (type == typeof(int8))
+		return FieldKind_Int8;
+	if (type == typeof(uint8))
+		return FieldKind_UInt8;
+	if (type == typeof(int16))
+		return FieldKind_Int16;
+	if (type == typeof(uint16))
+		return FieldKind_UInt16;
+	if (type == typeof(int32))
+		return FieldKind_Int32;
+	if (type == typeof(uint32))
+		return FieldKind_UInt32;
+	if (type == typeof(int64))
+		return FieldKind_Int64;
+	if (type == typeof(uint64))
+		return FieldKind_UInt64;
+	if (type == typeof(real32))
+		return FieldKind_Real32;
+	if (type == typeof(real64))
+		return FieldKind_Real64;
+	if (type == typeof(String))
+		return FieldKind_String;
+	if (type->IsStruct())
+		return FieldKind_Struct;
+	if (type->IsClass())
+		return FieldKind_Object;
+	if (type->IsEnum())
+		return FieldKind_Int32;
+
+	return FieldKind_None;
+}
+
+bool BinarySerializer::IsNumericKind(uint8 kind)
+{
+	return (kind >= FieldKind_Bool && kind <= FieldKind_Real64);
+}
+
+int32 BinarySerializer::GetBlockSize(uint8 kind)
 {
-public:
-	static T GetValue(const Variant& value)
+	switch (kind)
 	{
-		switch (value.GetType())
+	case FieldKind_Int8:
+	case FieldKind_UInt8:
+		return 1;
+	case FieldKind_Int16:
+	case FieldKind_UInt16:
+		return 2;
+	case FieldKind_Int32:
+	case FieldKind_UInt32:
+	case FieldKind_Real32:
+		return 4;
+	case FieldKind_Int64:
+	case FieldKind_UInt64:
+	case FieldKind_Real64:
+		return 8;
+	default:
+		return 0;
+	}
+}
+
+BaseArray<FieldInfo*> BinarySerializer::GetSerializableFields(TypeInfo* type)
+{
+	BaseArray<FieldInfo*> fields;
+	FieldList allfields = type->GetFields();
+	FieldInfo* fi;
+	foreach (fi, allfields, FieldList)
+	{
+		if ((fi->GetFieldAttributes() & FieldAttributes_Static) != 0)
+			continue;
+
+		if (GetFieldKind(fi->GetFieldType()) != FieldKind_None)
+			fields.Add(fi);
+	}
+
+	return fields;
+}
+
+int32 BinarySerializer::GetStructOffset(TypeInfo* type)
+{
+	// The fields of a structure are registered with their offset in the StructObject
+	StructObject* value = (StructObject*)type->Create();
+	SE_ASSERT(value);
+	int32 offset = (int32)((SEbyte*)value->GetData() - (SEbyte*)value);
+	delete value;
+
+	return offset;
+}
+
+void BinarySerializer::BuildWriteOps(TypeInfo* type, int32 offset, BaseArray<PlanOp>& ops)
+{
+	BaseArray<FieldInfo*> fields = GetSerializableFields(type);
+	int32 count = fields.Count();
+	for (int32 i = 0; i < count; i++)
+	{
+		FieldInfo* field = fields[i];
+		TypeInfo* fieldType = field->GetFieldType();
+		FieldKind kind = GetFieldKind(fieldType);
+		if (kind == FieldKind_Struct)
 		{
-		case Variant_Boolean:
-			return value.ToBoolean());
-		case Variant_Int32:
-			return value.ToInt32();
-		case Variant_UInt32:
-			return value.ToUInt32();
-		case Variant_Int64:
-			return value.ToInt64();
-		case Variant_UInt64:
-			return value.ToUInt64();
-		case Variant_Real64:
-			return value.ToReal64();
-		case Variant_String:
-			return value.ToString();
+			BuildWriteOps(fieldType, offset + field->GetOffset() - GetStructOffset(fieldType), ops);
+			continue;
 		}
+
+		PlanOp& op = ops.EmplaceBack();
+		op._Kind = kind;
+		op._FieldKind = kind;
+		op._Offset = offset + field->GetOffset();
+		op._Size = 0;
+		op._Type = fieldType;
 	}
-};
+}
 
-void BinarySerializer::Serialize(BinaryStream& writer, Object* obj, TypeInfo* type)
+void BinarySerializer::BuildReadOps(const StreamType* streamType, BaseArray<PlanOp>& ops) const
 {
-	if (type->IsAbstract())
-		return;
+	BaseArray<FieldInfo*> fields;
+	if (streamType->_Type != NULL)
+		fields = GetSerializableFields(streamType->_Type);
+
+	int32 count = streamType->_Fields.Count();
+	for (int32 i = 0; i < count; i++)
+	{
+		const StreamField& streamField = streamType->_Fields[i];
+
+		// Find the field with the same name, the others keep their default value
+		FieldInfo* field = NULL;
+		for (int32 j = 0; j < fields.Count(); j++)
+		{
+			if (fields[j]->GetName() == streamField._Name)
+			{
+				field = fields[j];
+				break;
+			}
+		}
+
+		TypeInfo* fieldType = (field != NULL ? field->GetFieldType() : NULL);
+		FieldKind fieldKind = GetFieldKind(fieldType);
+
+		if (streamField._Kind == FieldKind_Struct)
+		{
+			// Expand the plan of the structure, or skip its values
+			const StreamType* structType = _ReadTypes[streamField._StructType - 1];
+			bool matches = (fieldKind == FieldKind_Struct && structType->_Type == fieldType);
+			int32 offset = (matches ? field->GetOffset() - GetStructOffset(fieldType) : 0);
+
+			const BaseArray<PlanOp>& structOps = structType->_Plan._Ops;
+			for (int32 j = 0; j < structOps.Count(); j++)
+			{
+				PlanOp op = structOps[j];
+				if (!matches)
+					op._FieldKind = FieldKind_None;
+				else if (op._FieldKind != FieldKind_None)
+					op._Offset += offset;
+				ops.Add(op);
+			}
+			continue;
+		}
+
+		bool compatible = (streamField._Kind == fieldKind ||
+			(IsNumericKind(streamField._Kind) && IsNumericKind(fieldKind)));
+
+		PlanOp& op = ops.EmplaceBack();
+		op._Kind = streamField._Kind;
+		op._FieldKind = (compatible ? fieldKind : FieldKind_None);
+		op._Offset = (compatible ? field->GetOffset() : 0);
+		op._Size = 0;
+		op._Type = (compatible ? fieldType : NULL);
+	}
+}
+
+void BinarySerializer::BuildBlocks(TypePlan& plan)
+{
+	plan._Blocks.Clear();
+
+	int32 count = plan._Ops.Count();
+	for (int32 i = 0; i < count; i++)
+	{
+		const PlanOp& op = plan._Ops[i];
+		int32 size = (op._Kind == op._FieldKind ? GetBlockSize(op._Kind) : 0);
+
+		if (size > 0 && !plan._Blocks.IsEmpty())
+		{
+			PlanOp& last = plan._Blocks[plan._Blocks.Count() - 1];
+			int32 lastSize = (last._Kind == FieldKind_Block ? last._Size :
+				(last._Kind == last._FieldKind ? GetBlockSize(last._Kind) : 0));
+
+			if (lastSize > 0 && last._Offset + lastSize == op._Offset)
+			{
+				last._Kind = FieldKind_Block;
+				last._FieldKind = FieldKind_Block;
+				last._Size = lastSize + size;
+				continue;
+			}
+		}
+
+		plan._Blocks.Add(op);
+	}
+}
+
+BinarySerializer::TypePlan* BinarySerializer::GetWritePlan(TypeInfo* type)
+{
+	TypePlan** found = _WritePlans.Find(type);
+	if (found != NULL)
+		return *found;
 
+	TypePlan* plan = new TypePlan();
+	BuildWriteOps(type, 0, plan->_Ops);
+	BuildBlocks(*plan);
+	_WritePlans.Add(type, plan);
+
+	return plan;
+}
+
+int32 BinarySerializer::WriteTypeReference(BinaryStream& writer, TypeInfo* type)
+{
+	int32* found = _WriteTypes.Find(type);
+	if (found != NULL)
+	{
+		writer.WriteInt32(*found);
+		return *found;
+	}
+
+	int32 index = _WriteTypePlans.Count() + 1;
+	_WriteTypes.Add(type, index);
+	_WriteTypePlans.Add(GetWritePlan(type));
+
+	writer.WriteInt32(index);
 	writer.WriteString(type->GetName());
 
-	int8 refindex = (obj == NULL ? 0 : 1);
-	writer.WriteInt8(refindex);
+	BaseArray<FieldInfo*> fields = GetSerializableFields(type);
+	int32 count = fields.Count();
+	SE_ASSERT(count <= 0xffff);
+	writer.WriteUInt16((uint16)count);
+	for (int32 i = 0; i < count; i++)
+	{
+		FieldInfo* field = fields[i];
+		FieldKind kind = GetFieldKind(field->GetFieldType());
+		writer.WriteString(field->GetName());
+		writer.WriteUInt8((uint8)kind);
+		if (kind == FieldKind_Struct)
+		{
+			WriteTypeReference(writer, field->GetFieldType());
+		}
+	}
 
-	if (obj == NULL)
-		return;
+	return index;
+}
 
-	Array<MemberInfo*> members;
-	members = ISerializer::GetSerializableMembers(obj->GetType());
+int32 BinarySerializer::ReadTypeReference(BinaryStream& reader)
+{
+	int32 index = reader.ReadInt32();
+	if (index == _ReadTypes.Count() + 1)
+	{
+		ReadTypeDefinition(reader);
+	}
+	else if (index < 0 || index > _ReadTypes.Count())
+	{
+		SEthrow(FormatException("Invalid type index."));
+		return 0;
+	}
 
-	BaseArray<Variant> values;
-	values = ISerializer::GetObjectValues(obj, members);
+	return index;
+}
 
-	int32 index = 0;
-	BaseArray<Variant>::Iterator it = values.GetIterator();
-	while (it.Next())
+void BinarySerializer::ReadTypeDefinition(BinaryStream& reader)
+{
+	StreamType* streamType = new StreamType();
+	streamType->_Name = reader.ReadString();
+	streamType->_Type = TypeFactory::Instance()->GetType(streamType->_Name);
+	streamType->_Defined = false;
+	_ReadTypes.Add(streamType);
+
+	int32 count = reader.ReadUInt16();
+	for (int32 i = 0; i < count; i++)
 	{
-		MemberInfo* member = members[index];
-		FieldInfo* field = (FieldInfo*)member;
-		const Variant& value = it.Current();
-		switch (value.GetType())
+		StreamField& field = streamType->_Fields.EmplaceBack();
+		field._Name = reader.ReadString();
+		field._Kind = reader.ReadUInt8();
+		field._StructType = 0;
+
+		if (field._Kind == FieldKind_Struct)
 		{
-		case Variant_Boolean:
-			writer.WriteUInt8(value.ToBoolean());
-			break;
-		case Variant_Int8:
-			writer.WriteInt8(value.ToInt8());
+			// The structure must be defined to expand its plan
+			int32 structType = ReadTypeReference(reader);
+			if (structType == 0 || !_ReadTypes[structType - 1]->_Defined)
+			{
+				SEthrow(FormatException("Invalid structure type."));
+				return;
+			}
+			field._StructType = structType;
+		}
+		else if (field._Kind == FieldKind_None || field._Kind >= FieldKind_Block)
+		{
+			SEthrow(FormatException("Invalid field kind."));
+			return;
+		}
+	}
+
+	BuildReadOps(streamType, streamType->_Plan._Ops);
+	BuildBlocks(streamType->_Plan);
+	streamType->_Defined = true;
+}
+
+void BinarySerializer::WriteFields(BinaryStream& writer, const TypePlan& plan, const SEbyte* data)
+{
+	const BaseArray<PlanOp>& ops = (writer.GetStream()->GetByteOrder() == SE_ENDIAN ?
+		plan._Blocks : plan._Ops);
+
+	const PlanOp* op = ops.begin();
+	const PlanOp* end = ops.end();
+	for (; op != end; ++op)
+	{
+		const SEbyte* ptr = data + op->_Offset;
+		switch (op->_Kind)
+		{
+		case FieldKind_Bool:
+			writer.WriteUInt8(*(const bool*)ptr ? 1 : 0);
 			break;
-		case Variant_UInt8:
-			writer.WriteUInt8(value.ToUInt8());
+		case FieldKind_Int8:
+			writer.WriteInt8(*(const int8*)ptr);
 			break;
-		case Variant_Int16:
-			writer.WriteInt16(value.ToInt16());
+		case FieldKind_UInt8:
+			writer.WriteUInt8(*(const uint8*)ptr);
 			break;
-		case Variant_UInt16:
-			writer.WriteUInt16(value.ToUInt16());
+		case FieldKind_Int16:
+			writer.WriteInt16(*(const int16*)ptr);
 			break;
-		case Variant_Int32:
-			writer.WriteInt32(value.ToInt32());
+		case FieldKind_UInt16:
+			writer.WriteUInt16(*(const uint16*)ptr);
 			break;
-		case Variant_UInt32:
-			writer.WriteUInt32(value.ToUInt32());
+		case FieldKind_Int32:
+			writer.WriteInt32(*(const int32*)ptr);
 			break;
-		case Variant_Int64:
-			writer.WriteInt64(value.ToInt64());
+		case FieldKind_UInt32:
+			writer.WriteUInt32(*(const uint32*)ptr);
 			break;
-		case Variant_UInt64:
-			writer.WriteUInt64(value.ToUInt64());
+		case FieldKind_Int64:
+			writer.WriteInt64(*(const int64*)ptr);
 			break;
-		case Variant_Real32:
-			writer.WriteReal32(value.ToReal32());
+		case FieldKind_UInt64:
+			writer.WriteUInt64(*(const uint64*)ptr);
 			break;
-		case Variant_Real64:
-			writer.WriteReal64(value.ToReal64());
+		case FieldKind_Real32:
+			writer.WriteReal32(*(const real32*)ptr);
 			break;
-		case Variant_String:
-			writer.WriteString(value.ToString());
+		case FieldKind_Real64:
+			writer.WriteReal64(*(const real64*)ptr);
 			break;
-		case Variant_Struct:
-			{
-			FieldInfo* field = (FieldInfo*)member;
-
-			StructObject* structField = (StructObject*)
-				TypeFactory::Instance()->CreateInstance(field->GetFieldType()->GetName());
-
-			void* ptr = value.GetData();
-			structField->Set(ptr);
-			Serialize(writer, structField, structField->GetType());
-			delete structField;
-			}
+		case FieldKind_String:
+			writer.WriteString(*(const String*)ptr);
 			break;
-		case Variant_Object:
-			{
-			Object* objField = value.ToObject();
-			Serialize(writer, objField, field->GetFieldType());
-			}
+		case FieldKind_Object:
+			Serialize(writer, *(Object* const*)ptr, op->_Type);
 			break;
-		case Variant_Enum:
-			writer.WriteString(EnumObject::GetName(field->GetFieldType(),
-				Variant((int32)value.ToEnum())));
+		case FieldKind_Block:
+			writer.Write((SEbyte*)ptr, op->_Size);
 			break;
 		}
-
-		index++;
 	}
-
-	obj->OnSerialized(this, writer);
 }
 
-Object* BinarySerializer::Deserialize(BinaryStream& reader)
+void BinarySerializer::ReadFields(BinaryStream& reader, const TypePlan& plan, SEbyte* data)
 {
-	String typeName = reader.ReadString();
-
-	int8 refindex = reader.ReadInt8();
-	if (refindex == 0)
-		return NULL;
-
-	Object* obj = TypeFactory::Instance()->CreateInstance(typeName);
-	if (obj == NULL)
+	// Skip the values of an object that cannot be created
+	if (data == NULL)
 	{
-		Logger::Current()->Log(LogLevel::Error, _T("BinarySerializer.Deserialize"),
-			_T("The instance of the object cannot be created because the type name is not registered.") +
-			String(_T("Type name: ")) + typeName);
-		return NULL;
+		const PlanOp* op = plan._Ops.begin();
+		const PlanOp* end = plan._Ops.end();
+		for (; op != end; ++op)
+		{
+			ReadField(reader, op->_Kind, FieldKind_None, NULL, NULL);
+		}
+		return;
 	}
 
-	Array<MemberInfo*> members;
-	members = ISerializer::GetSerializableMembers(obj->GetType());
+	const BaseArray<PlanOp>& ops = (reader.GetStream()->GetByteOrder() == SE_ENDIAN ?
+		plan._Blocks : plan._Ops);
 
-	BaseArray<Variant> values;
-	Array<MemberInfo*>::Iterator it = members.GetIterator();
-	while (it.Next())
+	const PlanOp* op = ops.begin();
+	const PlanOp* end = ops.end();
+	for (; op != end; ++op)
 	{
-		if (it.Current()->GetMemberType() == MemberTypes_Field)
+		SEbyte* ptr = data + op->_Offset;
+		if (op->_Kind != op->_FieldKind)
 		{
-			FieldInfo* field = (FieldInfo*)it.Current();
-			TypeInfo* fieldType = field->GetFieldType();
-
-			Variant* value = NULL;
-			if (fieldType == typeof(bool))
-				value = new Variant(reader.ReadUInt8());
-			else if (fieldType == typeof(int8))
-				value = new Variant(reader.ReadInt8());
-			else if (fieldType == typeof(uint8))
-				value = new Variant(reader.ReadUInt8());
-			else if (fieldType == typeof(int16))
-				value = new Variant(reader.ReadInt16());
-			else if (fieldType == typeof(uint16))
-				value = new Variant(reader.ReadUInt16());
-			else if (fieldType == typeof(int32))
-				value = new Variant(reader.ReadInt32());
-			else if (fieldType == typeof(uint32))
-				value = new Variant(reader.ReadUInt32());
-			else if (fieldType == typeof(int64))
-				value = new Variant(reader.ReadInt64());
-			else if (fieldType == typeof(uint64))
-				value = new Variant(reader.ReadUInt64());
-			else if (fieldType == typeof(real32))
-				value = new Variant(reader.ReadReal32());
-			else if (fieldType == typeof(real64))
-				value = new Variant(reader.ReadReal64());
-			else if (fieldType == typeof(String))
-				value = new Variant(reader.ReadString());
-			else if (fieldType->IsStruct())
-			{
-				StructObject* structField = (StructObject*)
-					Deserialize(reader);
-				value = new Variant((StructObject*)structField);
-			}
-			else if (fieldType->IsClass())
-			{
-				Object* objField = Deserialize(reader);
-				value = new Variant((Object*)objField);
-			}
-			else if (fieldType->IsEnum())
-			{
-				String enumName = reader.ReadString();
-				value = new Variant(EnumObject::GetValue(fieldType, enumName));
-			}
-
-			if (value != NULL)
-			{
-				values.Add(*value);
-				delete value;
-			}
-			else
-			{
-				values.Add(Variant());
-			}
+			ReadField(reader, op->_Kind, op->_FieldKind, ptr, op->_Type);
+			continue;
 		}
-		else
+
+		switch (op->_Kind)
 		{
-			values.Add(Variant());
+		case FieldKind_Bool:
+			*(bool*)ptr = (reader.ReadUInt8() != 0);
+			break;
+		case FieldKind_Int8:
+			*(int8*)ptr = reader.ReadInt8();
+			break;
+		case FieldKind_UInt8:
+			*(uint8*)ptr = reader.ReadUInt8();
+			break;
+		case FieldKind_Int16:
+			*(int16*)ptr = reader.ReadInt16();
+			break;
+		case FieldKind_UInt16:
+			*(uint16*)ptr = reader.ReadUInt16();
+			break;
+		case FieldKind_Int32:
+			*(int32*)ptr = reader.ReadInt32();
+			break;
+		case FieldKind_UInt32:
+			*(uint32*)ptr = reader.ReadUInt32();
+			break;
+		case FieldKind_Int64:
+			*(int64*)ptr = reader.ReadInt64();
+			break;
+		case FieldKind_UInt64:
+			*(uint64*)ptr = reader.ReadUInt64();
+			break;
+		case FieldKind_Real32:
+			*(real32*)ptr = reader.ReadReal32();
+			break;
+		case FieldKind_Real64:
+			*(real64*)ptr = reader.ReadReal64();
+			break;
+		case FieldKind_String:
+			*(String*)ptr = reader.ReadString();
+			break;
+		case FieldKind_Object:
+			ReadField(reader, op->_Kind, op->_FieldKind, ptr, op->_Type);
+			break;
+		case FieldKind_Block:
+			reader.Read(ptr, op->_Size);
+			break;
 		}
 	}
+}
 
-	Object* res = ISerializer::BuildObjectMembers(obj, members, values);
+void BinarySerializer::ReadField(BinaryStream& reader, uint8 kind, uint8 fieldKind, SEbyte* ptr, TypeInfo* type)
+{
+	if (kind == FieldKind_String)
+	{
+		String value = reader.ReadString();
+		if (fieldKind == FieldKind_String)
+			*(String*)ptr = value;
+		return;
+	}
 
-	//FIX
-	BaseArray<Variant>::Iterator itValue = values.GetIterator();
-	while (itValue.Next())
+	if (kind == FieldKind_Object)
 	{
-		const Variant& value = itValue.Current();
-		if (value.GetType() == Variant_Struct)
-			delete value.GetData();
+		Object* value = Deserialize(reader);
+		if (value != NULL && (fieldKind != FieldKind_Object ||
+			!(value->GetType() == type || value->GetType()->IsSubclassOf(type))))
+		{
+			delete value;
+			value = NULL;
+		}
+
+		if (fieldKind == FieldKind_Object)
+			*(Object**)ptr = value;
+		return;
 	}
 
-	if (res != NULL)
+	int64 i;
+	real64 r;
+	switch (kind)
 	{
-		res->OnDeserialized(this, reader);
+	case FieldKind_Bool:
+	case FieldKind_UInt8:
+		i = reader.ReadUInt8();
+		r = (real64)i;
+		break;
+	case FieldKind_Int8:
+		i = reader.ReadInt8();
+		r = (real64)i;
+		break;
+	case FieldKind_Int16:
+		i = reader.ReadInt16();
+		r = (real64)i;
+		break;
+	case FieldKind_UInt16:
+		i = reader.ReadUInt16();
+		r = (real64)i;
+		break;
+	case FieldKind_Int32:
+		i = reader.ReadInt32();
+		r = (real64)i;
+		break;
+	case FieldKind_UInt32:
+		i = reader.ReadUInt32();
+		r = (real64)i;
+		break;
+	case FieldKind_Int64:
+		i = reader.ReadInt64();
+		r = (real64)i;
+		break;
+	case FieldKind_UInt64:
+		{
+		uint64 value = reader.ReadUInt64();
+		i = (int64)value;
+		r = (real64)value;
+		}
+		break;
+	case FieldKind_Real32:
+		r = reader.ReadReal32();
+		i = (int64)r;
+		break;
+	case FieldKind_Real64:
+		r = reader.ReadReal64();
+		i = (int64)r;
+		break;
+	default:
+		SEthrow(FormatException("Invalid field kind."));
+		return;
 	}
 
-	return res;
+	switch (fieldKind)
+	{
+	case FieldKind_Bool:
+		*(bool*)ptr = (i != 0);
+		break;
+	case FieldKind_Int8:
+		*(int8*)ptr = (int8)i;
+		break;
+	case FieldKind_UInt8:
+		*(uint8*)ptr = (uint8)i;
+		break;
+	case FieldKind_Int16:
+		*(int16*)ptr = (int16)i;
+		break;
+	case FieldKind_UInt16:
+		*(uint16*)ptr = (uint16)i;
+		break;
+	case FieldKind_Int32:
+		*(int32*)ptr = (int32)i;
+		break;
+	case FieldKind_UInt32:
+		*(uint32*)ptr = (uint32)i;
+		break;
+	case FieldKind_Int64:
+		*(int64*)ptr = i;
+		break;
+	case FieldKind_UInt64:
+		*(uint64*)ptr = (uint64)i;
+		break;
+	case FieldKind_Real32:
+		*(real32*)ptr = (real32)r;
+		break;
+	case FieldKind_Real64:
+		*(real64*)ptr = r;
+		break;
+	}
 }
 
-BinarySerializer::BinarySerializer()
+void BinarySerializer::Serialize(BinaryStream& writer, Object* obj, TypeInfo* type)
 {
+	if (obj == NULL)
+	{
+		writer.WriteInt32(0);
+		return;
+	}
+
+	int32 index = WriteTypeReference(writer, obj->GetType());
+	WriteFields(writer, *_WriteTypePlans[index - 1], (const SEbyte*)obj);
+
+	obj->OnSerialized(this, writer);
 }
 
-BinarySerializer::~BinarySerializer()
+Object* BinarySerializer::Deserialize(BinaryStream& reader)
 {
+	int32 index = ReadTypeReference(reader);
+	if (index == 0)
+		return NULL;
+
+	const StreamType* streamType = _ReadTypes[index - 1];
+	Object* obj = (streamType->_Type != NULL ? streamType->_Type->Create() : NULL);
+	if (obj == NULL)
+	{
+		ReadFields(reader, streamType->_Plan, NULL);
+
+		Logger::Current()->Log(LogLevel::Error, _T("BinarySerializer.Deserialize"),
+			_T("The instance of the object cannot be created because the type name is not registered.") +
+			String(_T("Type name: ")) + streamType->_Name);
+		return NULL;
+	}
+
+	ReadFields(reader, streamType->_Plan, (SEbyte*)obj);
+
+	obj->OnDeserialized(this, reader);
+
+	return obj;
 }
 
 void BinarySerializer::Serialize(Stream* stream, Object* obj)
@@ -251,9 +650,13 @@ void BinarySerializer::Serialize(Stream* stream, Object* obj)
 	if (stream == NULL || obj == NULL)
 		return;
 
-	BinaryStream writer(stream);
+	BinaryStream writer(stream, BinaryStream::DefaultBufferSize);
+	writer.WriteUInt32(Magic);
+	writer.WriteUInt16(Version);
 
+	ClearWriteTypes();
 	Serialize(writer, obj, obj->GetType());
+	ClearWriteTypes();
 }
 
 Object* BinarySerializer::Deserialize(Stream* stream)
@@ -261,9 +664,28 @@ Object* BinarySerializer::Deserialize(Stream* stream)
 	if (stream == NULL)
 		return NULL;
 
-	BinaryStream reader(stream);
+	BinaryStream reader(stream, BinaryStream::DefaultBufferSize);
+	if (reader.ReadUInt32() != Magic)
+	{
+		Logger::Current()->Log(LogLevel::Error, _T("BinarySerializer.Deserialize"),
+			_T("The stream was not written by the binary serializer."));
+		return NULL;
+	}
+
+	uint16 version = reader.ReadUInt16();
+	if (version > Version)
+	{
+		Logger::Current()->Log(LogLevel::Error, _T("BinarySerializer.Deserialize"),
+			_T("The version of the stream is not supported.") +
+			String(_T(" Version: ")) + String::ToString((int32)version));
+		return NULL;
+	}
+
+	ClearReadTypes();
+	Object* obj = Deserialize(reader);
+	ClearReadTypes();
 
-	return Deserialize(reader);
+	return obj;
 }
 
 }
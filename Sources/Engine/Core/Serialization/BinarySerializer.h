@@ -10,15 +10,135 @@ Author: Julien Delezenne
 #include "Core/Common.h"
 #include "Core/Serialization/ISerializer.h"
 #include "Core/IO/BinaryStream.h"
+#include "Core/Containers/BaseArray.h"
+#include "Core/Containers/Hashtable.h"
 
 namespace SonataEngine
 {
 
 /**
 	@brief Binary serializer.
+
+	A stream starts with a header holding the magic number and the version
+	of the format. Each object is then written as a type index followed by
+	its field values, 0 being a NULL object. The first time a type is used
+	in a stream its index is the count of the types already written plus one,
+	and it is followed by the name of the type and the name and kind of each
+	field. The type and field names are thus written once per stream.
+
+	The fields are copied from their offset in the object with a plan built
+	once per type, the fields of the structures being expanded in the plan
+	of the object. The contiguous fields of the same numeric type are copied
+	as a single block when the stream has the byte order of the platform.
+
+	When reading, the fields of the stream are matched by name with the
+	fields of the types of the application: the fields that were removed
+	are skipped, the fields that were added keep the value set by the
+	constructor, and the numeric fields that changed of type are converted.
+	An object of a type that no longer exists is skipped and read as NULL.
+	@remarks
+		The data written by Object::OnSerialized is not described by the
+		type table, it cannot be skipped and the type of an object with
+		custom data must still exist to read a stream.
+		The enumerations are written as their value.
 */
 class SE_CORE_EXPORT BinarySerializer : public ISerializer
 {
+public:
+	/** Magic number at the beginning of the streams. */
+	static const uint32 Magic;
+
+	/** Version of the format of the streams. */
+	static const uint16 Version;
+
+protected:
+	/// Kind of the value of a field, as written in the type table.
+	enum FieldKind
+	{
+		FieldKind_None,
+		FieldKind_Bool,
+		FieldKind_Int8,
+		FieldKind_UInt8,
+		FieldKind_Int16,
+		FieldKind_UInt16,
+		FieldKind_Int32,
+		FieldKind_UInt32,
+		FieldKind_Int64,
+		FieldKind_UInt64,
+		FieldKind_Real32,
+		FieldKind_Real64,
+		FieldKind_String,
+		FieldKind_Struct,
+		FieldKind_Object,
+
+		/// Contiguous numeric fields copied at once, never written in a stream.
+		FieldKind_Block
+	};
+
+	/// Copy of a field value, or of a block of fields.
+	struct PlanOp
+	{
+		/// Kind of the value in the stream.
+		uint8 _Kind;
+
+		/// Kind of the field of the object, FieldKind_None if the value is skipped.
+		uint8 _FieldKind;
+
+		/// Offset of the field in the object.
+		int32 _Offset;
+
+		/// Size of a block in bytes.
+		int32 _Size;
+
+		/// Declared type of an object field.
+		TypeInfo* _Type;
+	};
+
+	/// Copies of the fields of a type, in the order of the type table.
+	struct TypePlan
+	{
+		/// One operation per value, used when the bytes are swapped.
+		BaseArray<PlanOp> _Ops;
+
+		/// The operations with the contiguous numeric fields merged.
+		BaseArray<PlanOp> _Blocks;
+	};
+
+	/// Field of a type read from a stream.
+	struct StreamField
+	{
+		String _Name;
+		uint8 _Kind;
+
+		/// Index of the type of a structure field.
+		int32 _StructType;
+	};
+
+	/// Type read from a stream.
+	struct StreamType
+	{
+		String _Name;
+
+		/// Type of the application with that name, NULL if there is none.
+		TypeInfo* _Type;
+
+		BaseArray<StreamField> _Fields;
+		TypePlan _Plan;
+
+		/// Whether all the fields were read, the plan is built then.
+		bool _Defined;
+	};
+
+	/// Plans of the types written, kept from one stream to the next.
+	Hashtable<TypeInfo*, TypePlan*> _WritePlans;
+
+	/// Indices of the types written in the current stream, starting at 1.
+	Hashtable<TypeInfo*, int32> _WriteTypes;
+	BaseArray<TypePlan*> _WriteTypePlans;
+
+	/// Types read from the current stream.
+	BaseArray<StreamType*> _ReadTypes;
+
 public:
 	/** @name Constructor / Destructor. */
 	//@{
@@ -31,13 +151,66 @@ public:
 
 	/** Serialize this object. */
 	virtual void Serialize(Stream* stream, Object* obj);
+
+	/**
+		Writes an object to a stream that is being serialized, such as from
+		Object::OnSerialized. The type written is the type of the instance.
+	*/
 	void Serialize(BinaryStream& writer, Object* obj, TypeInfo* type);
 
 	/** Deserialize this object. */
 	virtual Object* Deserialize(Stream* stream);
+
+	/** Reads an object from a stream that is being deserialized. */
 	Object* Deserialize(BinaryStream& reader);
+
+protected:
+	void ClearWriteTypes();
+	void ClearReadTypes();
+
+	/** Returns the kind of the fields of a type, FieldKind_None if it cannot be serialized. */
+	static FieldKind GetFieldKind(TypeInfo* type);
+
+	static bool IsNumericKind(uint8 kind);
+
+	/** Returns the size of the numeric kinds that can be copied as bytes, bool having no fixed representation. */
+	static int32 GetBlockSize(uint8 kind);
+
+	/** Returns the fields of a type that are serialized. */
+	static BaseArray<FieldInfo*> GetSerializableFields(TypeInfo* type);
+
+	/** Returns the offset of the value of a structure in its StructObject. */
+	static int32 GetStructOffset(TypeInfo* type);
+
+	/** Builds the operations writing the fields of a type at the offset of an object. */
+	static void BuildWriteOps(TypeInfo* type, int32 offset, BaseArray<PlanOp>& ops);
+
+	/** Builds the operations reading the fields of a type of the stream into a type of the application. */
+	void BuildReadOps(const StreamType* streamType, BaseArray<PlanOp>& ops) const;
+
+	/** Merges the contiguous numeric fields of a plan. */
+	static void BuildBlocks(TypePlan& plan);
+
+	TypePlan* GetWritePlan(TypeInfo* type);
+
+	/** Writes the index of a type, followed by its definition the first time. */
+	int32 WriteTypeReference(BinaryStream& writer, TypeInfo* type);
+
+	/** Reads the index of a type and its definition the first time. */
+	int32 ReadTypeReference(BinaryStream& reader);
+	void ReadTypeDefinition(BinaryStream& reader);
+
+	void WriteFields(BinaryStream& writer, const TypePlan& plan, const SEbyte* data);
+	void ReadFields(BinaryStream& reader, const TypePlan& plan, SEbyte* data);
+
+	/** Reads a value of the stream and converts it to the kind of a field, or skips it. */
+	void ReadField(BinaryStream& reader, uint8 kind, uint8 fieldKind, SEbyte* ptr, TypeInfo* type);
+
+private:
+	BinarySerializer(const BinarySerializer&);
+	BinarySerializer& operator=(const BinarySerializer&);
 };
 
 }
 
-#endif 
+#endif
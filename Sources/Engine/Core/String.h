@@ -12,6 +12,7 @@ Author: Julien Delezenne
 #include "Core/Common.h"
 #include "Core/Char.h"
 #include "Core/Containers/Array.h"
+#include "Core/Containers/Hash.h"
 
 namespace SonataEngine
 {
@@ -195,6 +196,16 @@ SE_INLINE const String operator+(const String& left, const Char& right)
 SE_INLINE const String operator+(const Char& left, const String& right)
 { String s(left); s += right; return s; }
 
+/** Hash function for the strings. */
+template <>
+struct Hash<String>
+{
+	uint32 operator()(const String& value) const
+	{
+		return SE_HashBytes(value.Data(), value.Length() * sizeof(SEchar));
+	}
+};
+
 #include "String.inl"
 
 }
@@ -0,0 +1,124 @@
+/*=============================================================================
+Allocator.h
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+#ifndef _SE_ALLOCATOR_H_
+#define _SE_ALLOCATOR_H_
+
+#include <cstddef>
+#include <new>
+
+#include "Core/Common.h"
+#include "Core/System/Memory.h"
+#include "Core/System/FrameArena.h"
+
+namespace SonataEngine
+{
+
+/**
+	@brief Standard allocator using the Memory class.
+
+	This is the default allocator of the arrays, so that their allocations
+	are counted by the memory statistics.
+*/
+template <class T>
+class HeapAllocator
+{
+public:
+	typedef T value_type;
+	typedef T* pointer;
+	typedef const T* const_pointer;
+	typedef T& reference;
+	typedef const T& const_reference;
+	typedef size_t size_type;
+	typedef ptrdiff_t difference_type;
+
+	template <class U>
+	struct rebind
+	{
+		typedef HeapAllocator<U> other;
+	};
+
+	HeapAllocator();
+	HeapAllocator(const HeapAllocator<T>& value);
+	template <class U>
+	HeapAllocator(const HeapAllocator<U>& value) {}
+
+	pointer address(reference value) const;
+	const_pointer address(const_reference value) const;
+
+	pointer allocate(size_type count, const void* hint = 0);
+	void deallocate(pointer ptr, size_type count);
+
+	size_type max_size() const;
+
+	void construct(pointer ptr, const T& value);
+	void destroy(pointer ptr);
+
+	bool operator==(const HeapAllocator<T>& value) const;
+	bool operator!=(const HeapAllocator<T>& value) const;
+};
+
+/**
+	@brief Standard allocator using a FrameArena.
+
+	The memory is released when the arena is reset, the deallocations are
+	ignored. A container using this allocator must be destroyed before
+	the arena is reset, and must not be shared with another thread.
+*/
+template <class T>
+class FrameAllocator
+{
+public:
+	typedef T value_type;
+	typedef T* pointer;
+	typedef const T* const_pointer;
+	typedef T& reference;
+	typedef const T& const_reference;
+	typedef size_t size_type;
+	typedef ptrdiff_t difference_type;
+
+	template <class U>
+	struct rebind
+	{
+		typedef FrameAllocator<U> other;
+	};
+
+	/** Initializes a new instance using the arena of the current thread. */
+	FrameAllocator();
+
+	/** Initializes a new instance using the specified arena. */
+	FrameAllocator(FrameArena* arena);
+
+	FrameAllocator(const FrameAllocator<T>& value);
+	template <class U>
+	FrameAllocator(const FrameAllocator<U>& value) : _arena(value.GetArena()) {}
+
+	/** Gets the arena. */
+	FrameArena* GetArena() const;
+
+	pointer address(reference value) const;
+	const_pointer address(const_reference value) const;
+
+	pointer allocate(size_type count, const void* hint = 0);
+	void deallocate(pointer ptr, size_type count);
+
+	size_type max_size() const;
+
+	void construct(pointer ptr, const T& value);
+	void destroy(pointer ptr);
+
+	bool operator==(const FrameAllocator<T>& value) const;
+	bool operator!=(const FrameAllocator<T>& value) const;
+
+private:
+	FrameArena* _arena;
+};
+
+#include "Allocator.inl"
+
+}
+
+#endif
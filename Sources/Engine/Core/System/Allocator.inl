@@ -0,0 +1,171 @@
+/*=============================================================================
+Allocator.inl
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+template <class T>
+SE_INLINE HeapAllocator<T>::HeapAllocator()
+{
+}
+
+template <class T>
+SE_INLINE HeapAllocator<T>::HeapAllocator(const HeapAllocator<T>& value)
+{
+}
+
+template <class T>
+SE_INLINE typename HeapAllocator<T>::pointer HeapAllocator<T>::address(reference value) const
+{
+	return &value;
+}
+
+template <class T>
+SE_INLINE typename HeapAllocator<T>::const_pointer HeapAllocator<T>::address(const_reference value) const
+{
+	return &value;
+}
+
+template <class T>
+SE_INLINE typename HeapAllocator<T>::pointer HeapAllocator<T>::allocate(size_type count, const void* hint)
+{
+	if (count == 0)
+	{
+		return NULL;
+	}
+
+	pointer ptr = (pointer)Memory::Alloc(count * sizeof(T));
+	if (ptr == NULL)
+	{
+		SEthrow("OutOfMemoryException");
+	}
+	return ptr;
+}
+
+template <class T>
+SE_INLINE void HeapAllocator<T>::deallocate(pointer ptr, size_type count)
+{
+	if (ptr != NULL)
+	{
+		Memory::Free(ptr);
+	}
+}
+
+template <class T>
+SE_INLINE typename HeapAllocator<T>::size_type HeapAllocator<T>::max_size() const
+{
+	return ((size_type)-1) / sizeof(T);
+}
+
+template <class T>
+SE_INLINE void HeapAllocator<T>::construct(pointer ptr, const T& value)
+{
+	new ((void*)ptr) T(value);
+}
+
+template <class T>
+SE_INLINE void HeapAllocator<T>::destroy(pointer ptr)
+{
+	ptr->~T();
+}
+
+template <class T>
+SE_INLINE bool HeapAllocator<T>::operator==(const HeapAllocator<T>& value) const
+{
+	return true;
+}
+
+template <class T>
+SE_INLINE bool HeapAllocator<T>::operator!=(const HeapAllocator<T>& value) const
+{
+	return false;
+}
+
+
+template <class T>
+SE_INLINE FrameAllocator<T>::FrameAllocator() :
+	_arena(FrameArena::Current())
+{
+}
+
+template <class T>
+SE_INLINE FrameAllocator<T>::FrameAllocator(FrameArena* arena) :
+	_arena(arena)
+{
+}
+
+template <class T>
+SE_INLINE FrameAllocator<T>::FrameAllocator(const FrameAllocator<T>& value) :
+	_arena(value._arena)
+{
+}
+
+template <class T>
+SE_INLINE FrameArena* FrameAllocator<T>::GetArena() const
+{
+	return _arena;
+}
+
+template <class T>
+SE_INLINE typename FrameAllocator<T>::pointer FrameAllocator<T>::address(reference value) const
+{
+	return &value;
+}
+
+template <class T>
+SE_INLINE typename FrameAllocator<T>::const_pointer FrameAllocator<T>::address(const_reference value) const
+{
+	return &value;
+}
+
+template <class T>
+SE_INLINE typename FrameAllocator<T>::pointer FrameAllocator<T>::allocate(size_type count, const void* hint)
+{
+	if (count == 0)
+	{
+		return NULL;
+	}
+
+	size_t alignment = (sizeof(T) < FrameArena::DefaultAlignment ? sizeof(void*) : FrameArena::DefaultAlignment);
+	pointer ptr = (pointer)_arena->Alloc(count * sizeof(T), alignment);
+	if (ptr == NULL)
+	{
+		SEthrow("OutOfMemoryException");
+	}
+	return ptr;
+}
+
+template <class T>
+SE_INLINE void FrameAllocator<T>::deallocate(pointer ptr, size_type count)
+{
+}
+
+template <class T>
+SE_INLINE typename FrameAllocator<T>::size_type FrameAllocator<T>::max_size() const
+{
+	return ((size_type)-1) / sizeof(T);
+}
+
+template <class T>
+SE_INLINE void FrameAllocator<T>::construct(pointer ptr, const T& value)
+{
+	new ((void*)ptr) T(value);
+}
+
+template <class T>
+SE_INLINE void FrameAllocator<T>::destroy(pointer ptr)
+{
+	ptr->~T();
+}
+
+template <class T>
+SE_INLINE bool FrameAllocator<T>::operator==(const FrameAllocator<T>& value) const
+{
+	return (_arena == value._arena);
+}
+
+template <class T>
+SE_INLINE bool FrameAllocator<T>::operator!=(const FrameAllocator<T>& value) const
+{
+	return (_arena != value._arena);
+}
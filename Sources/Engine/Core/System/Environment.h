@@ -97,6 +97,9 @@ public:
 	/** Gets the number of milliseconds elapsed since the system started. */
 	static uint32 TickCount(); 
 
+	/** Gets the number of processors on the current machine. */
+	static int32 ProcessorCount();
+
 	/** Gets the newline string defined for this environment. */
 	static String NewLine();
 
@@ -0,0 +1,226 @@
+/*=============================================================================
+FrameArena.cpp
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+#include "FrameArena.h"
+#include "Core/Threading/Thread.h"
+#include "Core/Exception/InvalidOperationException.h"
+
+namespace SonataEngine
+{
+
+const size_t FrameArena::DefaultCapacity = 256 * 1024;
+const size_t FrameArena::DefaultAlignment = 16;
+const int32 FrameArena::MaxThreadCount = 64;
+
+/// Arena of the current thread.
+static SE_THREAD_LOCAL FrameArena* _CurrentArena = NULL;
+
+/// Value of _DestroyCount when the arena of the current thread was created.
+static SE_THREAD_LOCAL int32 _CurrentDestroyCount = 0;
+
+/// Arenas of all the threads, a free slot is NULL and is claimed atomically.
+static FrameArena* volatile _Arenas[FrameArena::MaxThreadCount];
+
+/// Incremented by ResetAll, an arena of a thread is reset when its generation is older.
+static volatile int32 _ResetGeneration = 0;
+
+/// Incremented by DestroyAll, the arenas of the threads created before are deleted.
+static volatile int32 _DestroyCount = 0;
+
+/// Rounds a size up to a multiple of the default alignment.
+static size_t _AlignSize(size_t size)
+{
+	return (size + FrameArena::DefaultAlignment - 1) & ~(FrameArena::DefaultAlignment - 1);
+}
+
+
+FrameArena::FrameArena(size_t capacity) :
+	_buffer(NULL),
+	_isThreadArena(false),
+	_generation(0),
+	_capacity(_AlignSize(capacity)),
+	_offset(0),
+	_usedSize(0),
+	_peakSize(0),
+	_overflow(NULL),
+	_overflowCount(0)
+{
+	if (_capacity > 0)
+	{
+		_buffer = (SEbyte*)Memory::Alloc(_capacity);
+	}
+}
+
+FrameArena::~FrameArena()
+{
+	Reset();
+
+	if (_buffer != NULL)
+	{
+		Memory::Free(_buffer);
+	}
+}
+
+void* FrameArena::Alloc(size_t size, size_t alignment)
+{
+	SE_ASSERT(alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+	// ResetAll was called since the last allocation
+	if (_isThreadArena && _generation != Interlocked::Load(&_ResetGeneration, MemoryOrder_Relaxed))
+	{
+		Reset();
+	}
+
+	SEptr address = (SEptr)(_buffer + _offset);
+	size_t padding = (size_t)((alignment - (address & (alignment - 1))) & (alignment - 1));
+
+	if (_buffer != NULL && _offset + padding + size <= _capacity)
+	{
+		void* ptr = _buffer + _offset + padding;
+		_offset += padding + size;
+		_usedSize += padding + size;
+		return ptr;
+	}
+
+	// The buffer is full, allocate a heap block released on the next reset
+	size_t headerSize = _AlignSize(sizeof(OverflowBlock));
+	if (headerSize < alignment)
+	{
+		headerSize = alignment;
+	}
+
+	SEbyte* block = (SEbyte*)Memory::Alloc(headerSize + size + alignment);
+	if (block == NULL)
+	{
+		return NULL;
+	}
+
+	OverflowBlock* header = (OverflowBlock*)block;
+	header->_next = _overflow;
+	_overflow = header;
+	_overflowCount++;
+	_usedSize += size + alignment;
+
+	address = (SEptr)(block + headerSize);
+	padding = (size_t)((alignment - (address & (alignment - 1))) & (alignment - 1));
+	return block + headerSize + padding;
+}
+
+void FrameArena::Reset()
+{
+	if (_usedSize > _peakSize)
+	{
+		_peakSize = _usedSize;
+	}
+
+	if (_overflow != NULL)
+	{
+		while (_overflow != NULL)
+		{
+			OverflowBlock* next = _overflow->_next;
+			Memory::Free(_overflow);
+			_overflow = next;
+		}
+
+		// Enlarge the buffer to hold all the allocations of the largest frame
+		if (_peakSize > _capacity)
+		{
+			if (_buffer != NULL)
+			{
+				Memory::Free(_buffer);
+			}
+			_capacity = _AlignSize(_peakSize + _peakSize / 4);
+			_buffer = (SEbyte*)Memory::Alloc(_capacity);
+		}
+	}
+
+	_offset = 0;
+	_usedSize = 0;
+
+	if (_isThreadArena)
+	{
+		_generation = Interlocked::Load(&_ResetGeneration, MemoryOrder_Relaxed);
+	}
+}
+
+FrameArena* FrameArena::Current()
+{
+	// The arena of the thread was deleted by DestroyAll
+	int32 destroyCount = Interlocked::Load(&_DestroyCount, MemoryOrder_Acquire);
+	if (_CurrentArena != NULL && _CurrentDestroyCount != destroyCount)
+	{
+		_CurrentArena = NULL;
+	}
+
+	if (_CurrentArena == NULL)
+	{
+		FrameArena* arena = new FrameArena();
+		arena->_isThreadArena = true;
+		arena->_generation = Interlocked::Load(&_ResetGeneration, MemoryOrder_Relaxed);
+
+		int32 index = 0;
+		while (index < MaxThreadCount &&
+			Interlocked::CompareExchange((volatile void**)&_Arenas[index], arena, NULL) != NULL)
+		{
+			index++;
+		}
+
+		if (index == MaxThreadCount)
+		{
+			// The arena could not be reset nor destroyed with the others
+			delete arena;
+			SE_ASSERT(false);
+			throw InvalidOperationException(_T("Too many threads have a FrameArena."));
+		}
+
+		_CurrentArena = arena;
+		_CurrentDestroyCount = destroyCount;
+	}
+
+	return _CurrentArena;
+}
+
+void FrameArena::ReleaseCurrent()
+{
+	if (_CurrentArena == NULL)
+	{
+		return;
+	}
+
+	// The arena is not deleted twice if DestroyAll was called
+	if (_CurrentDestroyCount == Interlocked::Load(&_DestroyCount, MemoryOrder_Acquire))
+	{
+		for (int32 i = 0; i < MaxThreadCount; i++)
+		{
+			if (Interlocked::CompareExchange((volatile void**)&_Arenas[i], NULL, _CurrentArena) == _CurrentArena)
+			{
+				delete _CurrentArena;
+				break;
+			}
+		}
+	}
+
+	_CurrentArena = NULL;
+}
+
+void FrameArena::ResetAll()
+{
+	Interlocked::Increment(&_ResetGeneration);
+}
+
+void FrameArena::DestroyAll()
+{
+	Interlocked::Increment(&_DestroyCount);
+	for (int32 i = 0; i < MaxThreadCount; i++)
+	{
+		FrameArena* arena = (FrameArena*)Interlocked::Exchange((volatile void**)&_Arenas[i], NULL);
+		delete arena;
+	}
+
+	_CurrentArena = NULL;
+}
+
+}
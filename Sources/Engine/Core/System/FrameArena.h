@@ -0,0 +1,124 @@
+/*=============================================================================
+FrameArena.h
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+#ifndef _SE_FRAMEARENA_H_
+#define _SE_FRAMEARENA_H_
+
+#include "Core/Common.h"
+#include "Core/System/Memory.h"
+
+namespace SonataEngine
+{
+
+/**
+	@brief Linear allocator for the temporary allocations of a frame.
+
+	The memory is allocated by incrementing an offset in a buffer, and is
+	released all at once when the arena is reset, usually once per frame.
+	The destructors of the objects allocated in the arena are not called.
+
+	When the buffer is full, the allocations are made on the heap and the
+	buffer is enlarged on the next reset, so that the arena stops allocating
+	after the first frames.
+
+	An arena is not thread-safe. Each thread has its own arena that is
+	returned by Current, and all these arenas are reset by ResetAll.
+	The arena of a thread is destroyed when the Thread ends, so that its
+	slot can be used by another thread.
+*/
+class SE_CORE_EXPORT FrameArena
+{
+public:
+	/** Default size of the buffer, in bytes. */
+	static const size_t DefaultCapacity;
+
+	/** Default alignment of the allocations, in bytes. */
+	static const size_t DefaultAlignment;
+
+	/** Maximum number of threads having an arena. */
+	static const int32 MaxThreadCount;
+
+public:
+	/**
+		Initializes a new instance of the FrameArena class.
+		@param capacity The initial size of the buffer, in bytes.
+	*/
+	FrameArena(size_t capacity = DefaultCapacity);
+
+	/** Destructor. */
+	~FrameArena();
+
+	/**
+		Allocates memory in the arena.
+		@param size The number of bytes in memory required, in bytes.
+		@param alignment The alignment of the memory. Must be a power of two.
+		@return The pointer to the allocated memory, valid until the next reset.
+	*/
+	void* Alloc(size_t size, size_t alignment = DefaultAlignment);
+
+	/** Releases all the allocations of the arena. */
+	void Reset();
+
+	/** Gets the size of the buffer, in bytes. */
+	size_t GetCapacity() const { return _capacity; }
+
+	/** Gets the number of bytes allocated since the last reset. */
+	size_t GetUsedSize() const { return _usedSize; }
+
+	/** Gets the largest number of bytes allocated between two resets. */
+	size_t GetPeakSize() const { return _peakSize; }
+
+	/** Gets the number of allocations that didn't fit in the buffer since the arena was created. */
+	int32 GetOverflowCount() const { return _overflowCount; }
+
+	/**
+		Gets the arena of the current thread. The arena is created on the first call.
+		@exception InvalidOperationException MaxThreadCount threads already have an arena.
+	*/
+	static FrameArena* Current();
+
+	/** Destroys the arena of the current thread, if it has one, and releases its slot. */
+	static void ReleaseCurrent();
+
+	/**
+		Resets the arenas of all the threads, usually at the beginning of a frame.
+		Each arena is reset by its own thread on its next allocation, so the
+		arenas can be used by other threads during the call. The allocations
+		of the previous frame must no longer be used.
+	*/
+	static void ResetAll();
+
+	/**
+		Destroys the arenas of all the threads.
+		Must be called when the other threads using an arena are stopped or
+		idle. They get a new arena on their next call to Current.
+	*/
+	static void DestroyAll();
+
+private:
+	FrameArena(const FrameArena&);
+	FrameArena& operator=(const FrameArena&);
+
+	/// Header of a heap block used when the buffer is full.
+	struct OverflowBlock
+	{
+		OverflowBlock* _next;
+	};
+
+	SEbyte* _buffer;
+	bool _isThreadArena;
+	int32 _generation;
+	size_t _capacity;
+	size_t _offset;
+	size_t _usedSize;
+	size_t _peakSize;
+	OverflowBlock* _overflow;
+	int32 _overflowCount;
+};
+
+}
+
+#endif
@@ -5,62 +5,77 @@ Author: Julien Delezenne
 =============================================================================*/
 
 #include "Memory.h"
+#include <new>
 
 namespace SonataEngine
 {
-/*
+
+volatile int32 Memory::_allocationCount = 0;
+volatile int32 Memory::_freeCount = 0;
+
+}
+
 #if SE_USE_MEMORYINFO
-	void* operator new(size_t size, const char* file, int line)
-	{
-		return Memory::Alloc(size);
-	}
+using namespace SonataEngine;
 
-	void* operator new[](size_t size, const char* file, int line)
+// All the allocations made with new are recorded by the tracker
+void* operator new(size_t size)
+{
+	void* ptr = Memory::Alloc(size);
+	if (ptr == NULL)
 	{
-		return Memory::Alloc(size);
+		throw std::bad_alloc();
 	}
+	return ptr;
+}
 
-	void operator delete(void* ptr, const char* file, int line)
+void* operator new[](size_t size)
+{
+	void* ptr = Memory::Alloc(size);
+	if (ptr == NULL)
 	{
-		if (ptr != NULL)
-		{
-			Memory::Free(ptr);
-		}
+		throw std::bad_alloc();
 	}
+	return ptr;
+}
 
-	void operator delete[](void* ptr, const char* file, int line)
-	{
-		if (ptr != NULL)
-		{
-			Memory::Free(ptr);
-		}
-	}
-#else
-	void* operator new(size_t size)
-	{
-		return Memory::Alloc(size);
-	}
+void operator delete(void* ptr)
+{
+	Memory::Free(ptr);
+}
 
-	void* operator new[](size_t size)
-	{
-		return Memory::Alloc(size);
-	}
+void operator delete[](void* ptr)
+{
+	Memory::Free(ptr);
+}
 
-	void operator delete(void* ptr)
+void* operator new(size_t size, const char* file, int line)
+{
+	void* ptr = Memory::Alloc(size, file, line);
+	if (ptr == NULL)
 	{
-		if (ptr != NULL)
-		{
-			Memory::Free(ptr);
-		}
+		throw std::bad_alloc();
 	}
+	return ptr;
+}
 
-	void operator delete[](void* ptr)
+void* operator new[](size_t size, const char* file, int line)
+{
+	void* ptr = Memory::Alloc(size, file, line);
+	if (ptr == NULL)
 	{
-		if (ptr != NULL)
-		{
-			Memory::Free(ptr);
-		}
+		throw std::bad_alloc();
 	}
-#endif
-*/
+	return ptr;
 }
+
+void operator delete(void* ptr, const char* file, int line)
+{
+	Memory::Free(ptr);
+}
+
+void operator delete[](void* ptr, const char* file, int line)
+{
+	Memory::Free(ptr);
+}
+#endif
@@ -8,41 +8,46 @@ Author: Julien Delezenne
 #define _SE_MEMORY_H_
 
 #include "Core/Common.h"
+#include "Core/Threading/Interlocked.h"
+#include "Core/System/MemoryTracker.h"
+
+#if SE_USE_MEMORYSTATS
+#	define SE_MEMORY_COUNT(counter) Interlocked::Increment(&counter, MemoryOrder_Relaxed)
+#else
+#	define SE_MEMORY_COUNT(counter)
+#endif
 
-namespace SonataEngine
-{
-/*
 #if SE_USE_MEMORYINFO
 	void* operator new(size_t size, const char* file, int line);
 	void* operator new[](size_t size, const char* file, int line);
 	void operator delete(void* ptr, const char* file, int line);
 	void operator delete[](void* ptr, const char* file, int line);
-#else
-	void* operator new(size_t size);
-	void* operator new[](size_t size);
-	void operator delete(void* ptr);
-	void operator delete[](void* ptr);
 #endif
 
-#ifdef SE_USE_MEMORYINFO
-#	define SE_OP_NEW(size) operator new(size, __FILE__, __LINE__)
-#	define SE_NEW(size) new(__FILE__, __LINE__)
-#	define SE_OP_NEW_TYPE(size, type) operator new(size, __FILE__, __LINE__, type)
-#	define SE_NEW_TYPE(size) new(__FILE__, __LINE__, type)
+/// Allocations recording their call site when the memory tracking is enabled.
+#if SE_USE_MEMORYINFO
+#	define SE_ALLOC(size) SonataEngine::Memory::Alloc(size, __FILE__, __LINE__)
+#	define SE_CALLOC(num, size) SonataEngine::Memory::Calloc(num, size, __FILE__, __LINE__)
+#	define SE_REALLOC(ptr, size) SonataEngine::Memory::ReAlloc(ptr, size, __FILE__, __LINE__)
+#	define SE_NEW new(__FILE__, __LINE__)
 #else
-#	define SE_OP_NEW(size) operator new(size)
-#	define SE_NEW(size) new()
-#	define SE_OP_NEW_TYPE(size, type) operator new(size, type)
-#	define SE_NEW_TYPE(type) new(type)
+#	define SE_ALLOC(size) SonataEngine::Memory::Alloc(size)
+#	define SE_CALLOC(num, size) SonataEngine::Memory::Calloc(num, size)
+#	define SE_REALLOC(ptr, size) SonataEngine::Memory::ReAlloc(ptr, size)
+#	define SE_NEW new
 #endif
-*/
+
+namespace SonataEngine
+{
+
 /**
 	@brief Memory manager.
 
 	Provides memory management methods.
-
-	@todo
-		Track the memory allocations using the file and line parameters.
+	The number of heap operations is counted when SE_USE_MEMORYSTATS is enabled,
+	so that the allocations made during a frame can be measured.
+	The allocations are recorded by the MemoryTracker when SE_USE_MEMORYINFO
+	is enabled. Use the SE_ALLOC and SE_NEW macros to record the call site.
 */
 class SE_CORE_EXPORT Memory
 {
@@ -82,6 +87,23 @@ public:
 	*/
 	static void Free(void* ptr);
 
+#if SE_USE_MEMORYINFO
+	/** @name Allocations recording the call site. */
+	//@{
+	static void* Alloc(size_t size, const char* file, int32 line);
+	static void* Calloc(size_t num, size_t size, const char* file, int32 line);
+	static void* ReAlloc(void* ptr, size_t size, const char* file, int32 line);
+	//@}
+#endif
+
+	/** @name Allocations from the system, neither counted nor tracked. */
+	//@{
+	static void* SystemAlloc(size_t size);
+	static void* SystemCalloc(size_t num, size_t size);
+	static void* SystemReAlloc(void* ptr, size_t size);
+	static void SystemFree(void* ptr);
+	//@}
+
 	/**
 		Stores a value into a buffer repeatedly, for a specified number of times.
 		@param ptr The pointer to the memory to copy data into.
@@ -121,8 +143,23 @@ public:
 	*/
 	static size_t Compare(void* left, void* right, size_t size);
 
+	/**
+		Gets the number of allocations made since the program started.
+		The counter wraps around, compare two values by their difference.
+	*/
+	static int32 GetAllocationCount();
+
+	/**
+		Gets the number of blocks freed since the program started.
+		The counter wraps around, compare two values by their difference.
+	*/
+	static int32 GetFreeCount();
+
 private:
 	Memory();
+
+	static volatile int32 _allocationCount;
+	static volatile int32 _freeCount;
 };
 
 }
@@ -137,4 +174,6 @@ private:
 #	include "Platforms/Std/StdMemory.inl"
 #endif
 
+#include "Memory.inl"
+
 #endif 
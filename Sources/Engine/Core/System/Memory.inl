@@ -0,0 +1,101 @@
+/*=============================================================================
+Memory.inl
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+namespace SonataEngine
+{
+
+SE_INLINE void* Memory::Alloc(size_t size)
+{
+	SE_MEMORY_COUNT(_allocationCount);
+#if SE_USE_MEMORYINFO
+	return MemoryTracker::Alloc(size, NULL, 0);
+#else
+	return SystemAlloc(size);
+#endif
+}
+
+SE_INLINE void* Memory::Calloc(size_t num, size_t size)
+{
+#if SE_USE_MEMORYINFO
+	return Calloc(num, size, NULL, 0);
+#else
+	SE_MEMORY_COUNT(_allocationCount);
+	return SystemCalloc(num, size);
+#endif
+}
+
+SE_INLINE void* Memory::ReAlloc(void* ptr, size_t size)
+{
+#if SE_USE_MEMORYINFO
+	return ReAlloc(ptr, size, NULL, 0);
+#else
+	if (ptr == NULL)
+	{
+		return Alloc(size);
+	}
+
+	SE_MEMORY_COUNT(_allocationCount);
+	SE_MEMORY_COUNT(_freeCount);
+	return SystemReAlloc(ptr, size);
+#endif
+}
+
+SE_INLINE void Memory::Free(void* ptr)
+{
+	if (ptr == NULL)
+	{
+		return;
+	}
+
+	SE_MEMORY_COUNT(_freeCount);
+#if SE_USE_MEMORYINFO
+	MemoryTracker::Free(ptr);
+#else
+	SystemFree(ptr);
+#endif
+}
+
+#if SE_USE_MEMORYINFO
+SE_INLINE void* Memory::Alloc(size_t size, const char* file, int32 line)
+{
+	SE_MEMORY_COUNT(_allocationCount);
+	return MemoryTracker::Alloc(size, file, line);
+}
+
+SE_INLINE void* Memory::Calloc(size_t num, size_t size, const char* file, int32 line)
+{
+	void* ptr = Alloc(num * size, file, line);
+	if (ptr != NULL)
+	{
+		Zero(ptr, num * size);
+	}
+	return ptr;
+}
+
+SE_INLINE void* Memory::ReAlloc(void* ptr, size_t size, const char* file, int32 line)
+{
+	if (ptr == NULL)
+	{
+		return Alloc(size, file, line);
+	}
+
+	SE_MEMORY_COUNT(_allocationCount);
+	SE_MEMORY_COUNT(_freeCount);
+	return MemoryTracker::ReAlloc(ptr, size, file, line);
+}
+#endif
+
+SE_INLINE int32 Memory::GetAllocationCount()
+{
+	return Interlocked::Load(&_allocationCount, MemoryOrder_Relaxed);
+}
+
+SE_INLINE int32 Memory::GetFreeCount()
+{
+	return Interlocked::Load(&_freeCount, MemoryOrder_Relaxed);
+}
+
+}
@@ -0,0 +1,378 @@
+/*=============================================================================
+MemoryTracker.cpp
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+#include "MemoryTracker.h"
+#include "Core/System/Memory.h"
+#include "Core/Threading/Thread.h"
+#include "Core/IO/TextStream.h"
+
+namespace SonataEngine
+{
+
+/// Header stored before each tracked allocation.
+struct AllocationHeader
+{
+	AllocationHeader* _previous;
+	AllocationHeader* _next;
+	const char* _file;
+	size_t _size;
+	int32 _line;
+	int32 _tag;
+};
+
+/// Size of the header, keeping the alignment of the allocations.
+static const size_t HeaderSize = (sizeof(AllocationHeader) + 15) & ~(size_t)15;
+
+/// Tag of the allocations of the current thread.
+static SE_THREAD_LOCAL int32 _CurrentTag = MemoryTag_Default;
+
+/// Names of the tags.
+static const char* _TagNames[MemoryTag_Max] =
+{
+	"Default",
+	"Core",
+	"Containers",
+	"Graphics",
+	"Physics",
+	"Audio",
+	"Input",
+	"AI",
+	"Resources",
+	"User"
+};
+
+/// Statistics of the tags, protected by the lock.
+static MemoryTagStats _TagStats[MemoryTag_Max];
+
+/// List of the live allocations, protected by the lock.
+static AllocationHeader* _Allocations = NULL;
+
+/// Spin lock protecting the allocation list, it doesn't allocate memory itself.
+static volatile int32 _Lock = 0;
+
+static void _Lock_Enter()
+{
+	while (Interlocked::CompareExchange(&_Lock, 1, 0, MemoryOrder_Acquire) != 0)
+	{
+		while (Interlocked::Load(&_Lock, MemoryOrder_Relaxed) != 0)
+		{
+		}
+	}
+}
+
+static void _Lock_Exit()
+{
+	Interlocked::Store(&_Lock, 0, MemoryOrder_Release);
+}
+
+static int32 _ValidTag(int32 tag)
+{
+	return ((tag >= 0 && tag < MemoryTag_Max) ? tag : MemoryTag_Default);
+}
+
+/// Adds an allocation to the list and to the statistics. The lock must be held.
+static void _Link(AllocationHeader* header)
+{
+	header->_previous = NULL;
+	header->_next = _Allocations;
+	if (_Allocations != NULL)
+	{
+		_Allocations->_previous = header;
+	}
+	_Allocations = header;
+
+	MemoryTagStats& stats = _TagStats[header->_tag];
+	stats.LiveBytes += header->_size;
+	stats.LiveCount++;
+	stats.TotalBytes += header->_size;
+	stats.TotalCount++;
+}
+
+/// Removes an allocation from the list and from the statistics. The lock must be held.
+static void _Unlink(AllocationHeader* header)
+{
+	if (header->_previous != NULL)
+	{
+		header->_previous->_next = header->_next;
+	}
+	else
+	{
+		_Allocations = header->_next;
+	}
+
+	if (header->_next != NULL)
+	{
+		header->_next->_previous = header->_previous;
+	}
+
+	MemoryTagStats& stats = _TagStats[header->_tag];
+	stats.LiveBytes -= header->_size;
+	stats.LiveCount--;
+}
+
+
+MemorySnapshot::MemorySnapshot() :
+	_siteCount(0),
+	_isTruncated(false)
+{
+	Memory::Zero(_tags, sizeof(_tags));
+}
+
+const MemoryTagStats& MemorySnapshot::GetTagStats(MemoryTag tag) const
+{
+	return _tags[_ValidTag(tag)];
+}
+
+const MemorySiteStats& MemorySnapshot::GetSiteStats(int32 index) const
+{
+	SE_ASSERT(index >= 0 && index < _siteCount);
+	return _sites[index];
+}
+
+const MemorySiteStats* MemorySnapshot::FindSite(const char* file, int32 line, MemoryTag tag) const
+{
+	for (int32 i = 0; i < _siteCount; i++)
+	{
+		const MemorySiteStats& site = _sites[i];
+		if (site.File == file && site.Line == line && site.Tag == tag)
+		{
+			return &site;
+		}
+	}
+	return NULL;
+}
+
+
+bool MemoryTracker::IsEnabled()
+{
+	return (SE_USE_MEMORYINFO != 0);
+}
+
+MemoryTag MemoryTracker::GetCurrentTag()
+{
+	return (MemoryTag)_CurrentTag;
+}
+
+void MemoryTracker::SetCurrentTag(MemoryTag tag)
+{
+	_CurrentTag = _ValidTag(tag);
+}
+
+const char* MemoryTracker::GetTagName(MemoryTag tag)
+{
+	const char* name = _TagNames[_ValidTag(tag)];
+	return (name != NULL ? name : "");
+}
+
+void MemoryTracker::SetTagName(MemoryTag tag, const char* name)
+{
+	_TagNames[_ValidTag(tag)] = name;
+}
+
+void MemoryTracker::GetTagStats(MemoryTag tag, MemoryTagStats& stats)
+{
+	_Lock_Enter();
+	stats = _TagStats[_ValidTag(tag)];
+	_Lock_Exit();
+}
+
+void MemoryTracker::TakeSnapshot(MemorySnapshot& snapshot)
+{
+	_Lock_Enter();
+
+	Memory::Copy(snapshot._tags, _TagStats, sizeof(_TagStats));
+	snapshot._siteCount = 0;
+	snapshot._isTruncated = false;
+
+	// Group the live allocations by call site
+	for (AllocationHeader* header = _Allocations; header != NULL; header = header->_next)
+	{
+		MemorySiteStats* site = (MemorySiteStats*)snapshot.FindSite(header->_file, header->_line, (MemoryTag)header->_tag);
+		if (site == NULL)
+		{
+			if (snapshot._siteCount == MemorySnapshot::MaxSiteCount)
+			{
+				snapshot._isTruncated = true;
+				continue;
+			}
+
+			site = &snapshot._sites[snapshot._siteCount++];
+			site->File = header->_file;
+			site->Line = header->_line;
+			site->Tag = (MemoryTag)header->_tag;
+			site->LiveBytes = 0;
+			site->LiveCount = 0;
+		}
+
+		site->LiveBytes += header->_size;
+		site->LiveCount++;
+	}
+
+	_Lock_Exit();
+}
+
+void MemoryTracker::Dump(TextStream* stream, const MemorySnapshot& snapshot)
+{
+	if (stream == NULL)
+	{
+		return;
+	}
+
+	stream->WriteLine(String(_T("Tag; Live bytes; Live count; Total bytes; Total count")));
+	for (int32 i = 0; i < MemoryTag_Max; i++)
+	{
+		const MemoryTagStats& stats = snapshot.GetTagStats((MemoryTag)i);
+		if (stats.TotalCount == 0)
+		{
+			continue;
+		}
+
+		stream->WriteLine(String::Format(_T("%s; %lld; %d; %lld; %d"),
+			GetTagName((MemoryTag)i), stats.LiveBytes, stats.LiveCount, stats.TotalBytes, stats.TotalCount));
+	}
+
+	stream->WriteLine(String(_T("Site; Tag; Live bytes; Live count")));
+	for (int32 i = 0; i < snapshot.GetSiteCount(); i++)
+	{
+		const MemorySiteStats& site = snapshot.GetSiteStats(i);
+		stream->WriteLine(String::Format(_T("%s(%d); %s; %lld; %d"),
+			(site.File != NULL ? site.File : "Unknown"), site.Line, GetTagName(site.Tag), site.LiveBytes, site.LiveCount));
+	}
+
+	if (snapshot.IsTruncated())
+	{
+		stream->WriteLine(String(_T("The snapshot is truncated.")));
+	}
+}
+
+void MemoryTracker::DumpDifference(TextStream* stream, const MemorySnapshot& from, const MemorySnapshot& to)
+{
+	if (stream == NULL)
+	{
+		return;
+	}
+
+	stream->WriteLine(String(_T("Tag; Live bytes; Live count; Allocated bytes; Allocation count")));
+	for (int32 i = 0; i < MemoryTag_Max; i++)
+	{
+		const MemoryTagStats& before = from.GetTagStats((MemoryTag)i);
+		const MemoryTagStats& after = to.GetTagStats((MemoryTag)i);
+		if (before.TotalCount == after.TotalCount && before.LiveBytes == after.LiveBytes)
+		{
+			continue;
+		}
+
+		stream->WriteLine(String::Format(_T("%s; %+lld; %+d; %lld; %d"),
+			GetTagName((MemoryTag)i),
+			after.LiveBytes - before.LiveBytes, after.LiveCount - before.LiveCount,
+			after.TotalBytes - before.TotalBytes, after.TotalCount - before.TotalCount));
+	}
+
+	stream->WriteLine(String(_T("Site; Tag; Live bytes; Live count")));
+
+	// Sites that changed or appeared
+	for (int32 i = 0; i < to.GetSiteCount(); i++)
+	{
+		const MemorySiteStats& site = to.GetSiteStats(i);
+		const MemorySiteStats* previous = from.FindSite(site.File, site.Line, site.Tag);
+		int64 liveBytes = site.LiveBytes - (previous != NULL ? previous->LiveBytes : 0);
+		int32 liveCount = site.LiveCount - (previous != NULL ? previous->LiveCount : 0);
+		if (liveBytes == 0 && liveCount == 0)
+		{
+			continue;
+		}
+
+		stream->WriteLine(String::Format(_T("%s(%d); %s; %+lld; %+d"),
+			(site.File != NULL ? site.File : "Unknown"), site.Line, GetTagName(site.Tag), liveBytes, liveCount));
+	}
+
+	// Sites that disappeared
+	for (int32 i = 0; i < from.GetSiteCount(); i++)
+	{
+		const MemorySiteStats& site = from.GetSiteStats(i);
+		if (to.FindSite(site.File, site.Line, site.Tag) != NULL)
+		{
+			continue;
+		}
+
+		stream->WriteLine(String::Format(_T("%s(%d); %s; %+lld; %+d"),
+			(site.File != NULL ? site.File : "Unknown"), site.Line, GetTagName(site.Tag), -site.LiveBytes, -site.LiveCount));
+	}
+}
+
+void* MemoryTracker::Alloc(size_t size, const char* file, int32 line)
+{
+	AllocationHeader* header = (AllocationHeader*)Memory::SystemAlloc(HeaderSize + size);
+	if (header == NULL)
+	{
+		return NULL;
+	}
+
+	header->_file = file;
+	header->_size = size;
+	header->_line = line;
+	header->_tag = _CurrentTag;
+
+	_Lock_Enter();
+	_Link(header);
+	_Lock_Exit();
+
+	return (SEbyte*)header + HeaderSize;
+}
+
+void* MemoryTracker::ReAlloc(void* ptr, size_t size, const char* file, int32 line)
+{
+	if (ptr == NULL)
+	{
+		return Alloc(size, file, line);
+	}
+
+	AllocationHeader* header = (AllocationHeader*)((SEbyte*)ptr - HeaderSize);
+
+	// The block can move, so it is removed from the list while it is resized
+	_Lock_Enter();
+	_Unlink(header);
+	_Lock_Exit();
+
+	AllocationHeader* newHeader = (AllocationHeader*)Memory::SystemReAlloc(header, HeaderSize + size);
+	if (newHeader == NULL)
+	{
+		// The original block is unchanged
+		_Lock_Enter();
+		_Link(header);
+		_Lock_Exit();
+		return NULL;
+	}
+
+	newHeader->_file = file;
+	newHeader->_size = size;
+	newHeader->_line = line;
+	newHeader->_tag = _CurrentTag;
+
+	_Lock_Enter();
+	_Link(newHeader);
+	_Lock_Exit();
+
+	return (SEbyte*)newHeader + HeaderSize;
+}
+
+void MemoryTracker::Free(void* ptr)
+{
+	if (ptr == NULL)
+	{
+		return;
+	}
+
+	AllocationHeader* header = (AllocationHeader*)((SEbyte*)ptr - HeaderSize);
+
+	_Lock_Enter();
+	_Unlink(header);
+	_Lock_Exit();
+
+	Memory::SystemFree(header);
+}
+
+}
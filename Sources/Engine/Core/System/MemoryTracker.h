@@ -0,0 +1,206 @@
+/*=============================================================================
+MemoryTracker.h
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+#ifndef _SE_MEMORYTRACKER_H_
+#define _SE_MEMORYTRACKER_H_
+
+#include "Core/Common.h"
+
+namespace SonataEngine
+{
+
+class TextStream;
+
+/** Identifies the subsystem owning an allocation. */
+enum MemoryTag
+{
+	/// The allocations made outside of a tag scope.
+	MemoryTag_Default,
+
+	/// The allocations of the core systems.
+	MemoryTag_Core,
+
+	/// The allocations of the containers.
+	MemoryTag_Containers,
+
+	/// The allocations of the graphics system.
+	MemoryTag_Graphics,
+
+	/// The allocations of the physics system.
+	MemoryTag_Physics,
+
+	/// The allocations of the audio system.
+	MemoryTag_Audio,
+
+	/// The allocations of the input system.
+	MemoryTag_Input,
+
+	/// The allocations of the artificial intelligence.
+	MemoryTag_AI,
+
+	/// The allocations of the resources.
+	MemoryTag_Resources,
+
+	/// The first tag available to the applications.
+	MemoryTag_User,
+
+	/// The maximum number of tags.
+	MemoryTag_Max = 32
+};
+
+/** Statistics of the allocations of a tag. */
+struct MemoryTagStats
+{
+	/// Number of bytes currently allocated.
+	int64 LiveBytes;
+
+	/// Number of blocks currently allocated.
+	int32 LiveCount;
+
+	/// Number of bytes allocated since the program started.
+	int64 TotalBytes;
+
+	/// Number of allocations since the program started.
+	int32 TotalCount;
+};
+
+/** Statistics of the live allocations made at a call site. */
+struct MemorySiteStats
+{
+	/// The file of the call site, or NULL if it is unknown.
+	const char* File;
+
+	/// The line of the call site.
+	int32 Line;
+
+	/// The tag of the allocations.
+	MemoryTag Tag;
+
+	/// Number of bytes currently allocated.
+	int64 LiveBytes;
+
+	/// Number of blocks currently allocated.
+	int32 LiveCount;
+};
+
+/**
+	@brief Statistics of the allocations at a given time.
+
+	Two snapshots taken at different frames can be compared with
+	MemoryTracker::DumpDifference to find where the memory is allocated.
+	The snapshot doesn't allocate memory.
+*/
+class SE_CORE_EXPORT MemorySnapshot
+{
+public:
+	/** Maximum number of call sites in a snapshot. */
+	enum { MaxSiteCount = 1024 };
+
+	MemorySnapshot();
+
+	/** Gets the statistics of a tag. */
+	const MemoryTagStats& GetTagStats(MemoryTag tag) const;
+
+	/** Gets the number of call sites. */
+	int32 GetSiteCount() const { return _siteCount; }
+
+	/** Gets the statistics of a call site. */
+	const MemorySiteStats& GetSiteStats(int32 index) const;
+
+	/** Finds the statistics of a call site. Returns NULL if the site has no live allocation. */
+	const MemorySiteStats* FindSite(const char* file, int32 line, MemoryTag tag) const;
+
+	/** Gets whether some call sites were not recorded because the snapshot is full. */
+	bool IsTruncated() const { return _isTruncated; }
+
+private:
+	friend class MemoryTracker;
+
+	MemoryTagStats _tags[MemoryTag_Max];
+	MemorySiteStats _sites[MaxSiteCount];
+	int32 _siteCount;
+	bool _isTruncated;
+};
+
+/**
+	@brief Records the allocations made by the Memory class.
+
+	The tracking is enabled by SE_USE_MEMORYINFO. Each allocation records its
+	size, its call site and the tag of the current thread, set with
+	SE_MEMORY_TAG. The call site is known for the allocations made with the
+	SE_ALLOC and SE_NEW macros.
+
+	When the tracking is disabled, the Memory methods don't call the tracker
+	and the macros expand to the untracked calls.
+*/
+class SE_CORE_EXPORT MemoryTracker
+{
+public:
+	/** Gets whether the allocations are tracked. */
+	static bool IsEnabled();
+
+	/** Gets or sets the tag of the allocations of the current thread. */
+	static MemoryTag GetCurrentTag();
+	static void SetCurrentTag(MemoryTag tag);
+
+	/** Gets or sets the name of a tag. */
+	static const char* GetTagName(MemoryTag tag);
+	static void SetTagName(MemoryTag tag, const char* name);
+
+	/** Gets the statistics of a tag. */
+	static void GetTagStats(MemoryTag tag, MemoryTagStats& stats);
+
+	/** Records the statistics of the live allocations. */
+	static void TakeSnapshot(MemorySnapshot& snapshot);
+
+	/** Writes the statistics of the tags and of the call sites of a snapshot. */
+	static void Dump(TextStream* stream, const MemorySnapshot& snapshot);
+
+	/**
+		Writes the differences between two snapshots.
+		The allocation rate of each tag is the difference of its allocation count.
+	*/
+	static void DumpDifference(TextStream* stream, const MemorySnapshot& from, const MemorySnapshot& to);
+
+	/** @name Allocations, called by the Memory class. */
+	//@{
+	static void* Alloc(size_t size, const char* file, int32 line);
+	static void* ReAlloc(void* ptr, size_t size, const char* file, int32 line);
+	static void Free(void* ptr);
+	//@}
+
+private:
+	MemoryTracker();
+};
+
+/** Sets the tag of the current thread until the end of the scope. */
+class SE_CORE_EXPORT MemoryTagScope
+{
+public:
+	explicit MemoryTagScope(MemoryTag tag) :
+		_previousTag(MemoryTracker::GetCurrentTag())
+	{
+		MemoryTracker::SetCurrentTag(tag);
+	}
+
+	~MemoryTagScope()
+	{
+		MemoryTracker::SetCurrentTag(_previousTag);
+	}
+
+private:
+	MemoryTag _previousTag;
+};
+
+}
+
+#if SE_USE_MEMORYINFO
+#	define SE_MEMORY_TAG(tag) SonataEngine::MemoryTagScope _memoryTagScope(tag)
+#else
+#	define SE_MEMORY_TAG(tag)
+#endif
+
+#endif
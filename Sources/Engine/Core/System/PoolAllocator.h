@@ -0,0 +1,100 @@
+/*=============================================================================
+PoolAllocator.h
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+#ifndef _SE_POOLALLOCATOR_H_
+#define _SE_POOLALLOCATOR_H_
+
+#include <new>
+
+#include "Core/Common.h"
+#include "Core/System/Memory.h"
+
+namespace SonataEngine
+{
+
+/**
+	@brief Allocator for objects of a fixed size.
+
+	The objects are allocated in pages holding several objects, and the
+	freed objects are kept in a list to be reused by the next allocations.
+	The pages are only released when the pool is destroyed or cleared, so
+	the pool stops allocating once it reaches its working size.
+
+	A pool is not thread-safe.
+*/
+template <class T>
+class PoolAllocator
+{
+public:
+	/**
+		Initializes a new instance of the PoolAllocator class.
+		@param pageSize The number of objects allocated at once when the pool is empty.
+	*/
+	PoolAllocator(int32 pageSize = 64);
+
+	/** Destructor. The objects still allocated are not destroyed. */
+	~PoolAllocator();
+
+	/** Gets the number of allocated objects. */
+	int32 Count() const;
+
+	/** Gets the number of objects that can be allocated without allocating a page. */
+	int32 GetCapacity() const;
+
+	/** Allocates pages until the specified number of objects can be allocated. */
+	void Reserve(int32 count);
+
+	/** Allocates the memory for an object, without constructing it. */
+	T* Allocate();
+
+	/** Frees the memory of an object, without destroying it. */
+	void Free(T* ptr);
+
+	/** Allocates and constructs an object. */
+	T* New();
+
+	/** Allocates and constructs an object by copy. */
+	T* New(const T& value);
+
+	/** Destroys and frees an object. */
+	void Delete(T* ptr);
+
+	/** Releases all the pages. The objects must have been destroyed. */
+	void Clear();
+
+private:
+	PoolAllocator(const PoolAllocator<T>&);
+	PoolAllocator<T>& operator=(const PoolAllocator<T>&);
+
+	/// Storage of an object, or link to the next free slot.
+	union Slot
+	{
+		Slot* _next;
+		double _alignment;
+		SEbyte _data[sizeof(T)];
+	};
+
+	/// Header of a page, followed by the slots.
+	union Page
+	{
+		Page* _next;
+		Slot _alignment;
+	};
+
+	void AllocatePage();
+
+	Page* _pages;
+	Slot* _freeSlots;
+	int32 _pageSize;
+	int32 _count;
+	int32 _capacity;
+};
+
+#include "PoolAllocator.inl"
+
+}
+
+#endif
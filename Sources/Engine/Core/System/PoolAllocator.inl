@@ -0,0 +1,136 @@
+/*=============================================================================
+PoolAllocator.inl
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+template <class T>
+PoolAllocator<T>::PoolAllocator(int32 pageSize) :
+	_pages(NULL),
+	_freeSlots(NULL),
+	_pageSize(pageSize > 0 ? pageSize : 1),
+	_count(0),
+	_capacity(0)
+{
+}
+
+template <class T>
+PoolAllocator<T>::~PoolAllocator()
+{
+	Clear();
+}
+
+template <class T>
+SE_INLINE int32 PoolAllocator<T>::Count() const
+{
+	return _count;
+}
+
+template <class T>
+SE_INLINE int32 PoolAllocator<T>::GetCapacity() const
+{
+	return _capacity;
+}
+
+template <class T>
+void PoolAllocator<T>::Reserve(int32 count)
+{
+	while (_capacity < count)
+	{
+		AllocatePage();
+	}
+}
+
+template <class T>
+SE_INLINE T* PoolAllocator<T>::Allocate()
+{
+	if (_freeSlots == NULL)
+	{
+		AllocatePage();
+	}
+
+	Slot* slot = _freeSlots;
+	_freeSlots = slot->_next;
+	_count++;
+	return (T*)slot;
+}
+
+template <class T>
+SE_INLINE void PoolAllocator<T>::Free(T* ptr)
+{
+	if (ptr == NULL)
+	{
+		return;
+	}
+
+	SE_ASSERT(_count > 0);
+
+	Slot* slot = (Slot*)ptr;
+	slot->_next = _freeSlots;
+	_freeSlots = slot;
+	_count--;
+}
+
+template <class T>
+SE_INLINE T* PoolAllocator<T>::New()
+{
+	return new (Allocate()) T();
+}
+
+template <class T>
+SE_INLINE T* PoolAllocator<T>::New(const T& value)
+{
+	return new (Allocate()) T(value);
+}
+
+template <class T>
+SE_INLINE void PoolAllocator<T>::Delete(T* ptr)
+{
+	if (ptr == NULL)
+	{
+		return;
+	}
+
+	ptr->~T();
+	Free(ptr);
+}
+
+template <class T>
+void PoolAllocator<T>::Clear()
+{
+	while (_pages != NULL)
+	{
+		Page* next = _pages->_next;
+		Memory::Free(_pages);
+		_pages = next;
+	}
+
+	_freeSlots = NULL;
+	_count = 0;
+	_capacity = 0;
+}
+
+template <class T>
+void PoolAllocator<T>::AllocatePage()
+{
+	Page* page = (Page*)Memory::Alloc(sizeof(Page) + _pageSize * sizeof(Slot));
+	if (page == NULL)
+	{
+		SEthrow("OutOfMemoryException");
+		return;
+	}
+
+	page->_next = _pages;
+	_pages = page;
+
+	// Link the slots in address order so the first allocations are contiguous
+	Slot* slots = (Slot*)(page + 1);
+	for (int32 i = 0; i < _pageSize - 1; i++)
+	{
+		slots[i]._next = &slots[i + 1];
+	}
+	slots[_pageSize - 1]._next = _freeSlots;
+	_freeSlots = slots;
+
+	_capacity += _pageSize;
+}
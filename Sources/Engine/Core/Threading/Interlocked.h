@@ -13,26 +13,75 @@ Author: Julien Delezenne
 namespace SonataEngine
 {
 
+/** Specifies how the memory accesses around an atomic operation are ordered. */
+enum MemoryOrder
+{
+	/// Only the atomicity of the operation is guaranteed.
+	MemoryOrder_Relaxed,
+
+	/// No memory access after the operation can be reordered before it.
+	MemoryOrder_Acquire,
+
+	/// No memory access before the operation can be reordered after it.
+	MemoryOrder_Release,
+
+	/// Combines the Acquire and Release orders.
+	MemoryOrder_AcquireRelease,
+
+	/// Combines the Acquire and Release orders, and all the sequential operations are seen in the same order by all the threads.
+	MemoryOrder_Sequential
+};
+
 /**
 	@class Interlocked
 	@group Threading
 	@brief Provides atomic operations for variables that are shared by multiple threads.
 	@remarks
 		The volatile keyword is a type qualifier used to declare that an object can be modified in the program by something such as the operating system, the hardware, or a concurrently executing thread.
+		The operations are sequentially consistent unless a weaker MemoryOrder is specified. A platform may provide a stronger order than the one specified.
+		The 64-bits variables must be aligned on 8 bytes.
 */
 class SE_CORE_EXPORT Interlocked
 {
 public:
+	/**
+		Reads a variable as an atomic operation.
+		@param location
+			The variable to read.
+		@param order
+			The memory order of the operation. Release orders are not valid for a read.
+		@return The value of location.
+	*/
+	static void* Load(volatile void** location, MemoryOrder order = MemoryOrder_Sequential);
+	static int32 Load(volatile int32* location, MemoryOrder order = MemoryOrder_Sequential);
+	static int64 Load(volatile int64* location, MemoryOrder order = MemoryOrder_Sequential);
+
+	/**
+		Writes a variable as an atomic operation.
+		@param location
+			The variable to write.
+		@param value
+			The value to which the location parameter is set.
+		@param order
+			The memory order of the operation. Acquire orders are not valid for a write.
+	*/
+	static void Store(volatile void** location, void* value, MemoryOrder order = MemoryOrder_Sequential);
+	static void Store(volatile int32* location, int32 value, MemoryOrder order = MemoryOrder_Sequential);
+	static void Store(volatile int64* location, int64 value, MemoryOrder order = MemoryOrder_Sequential);
+
 	/**
 		Sets a variable to a specified value as an atomic operation.
 		@param location
 			The variable to set to the specified value.
 		@param value
 			The value to which the location parameter is set.
+		@param order
+			The memory order of the operation.
 		@return The original value of location.
 	*/
-	static void* Exchange(volatile void** location, void* value);
-	static int32 Exchange(volatile int32* location, int32 value);
+	static void* Exchange(volatile void** location, void* value, MemoryOrder order = MemoryOrder_Sequential);
+	static int32 Exchange(volatile int32* location, int32 value, MemoryOrder order = MemoryOrder_Sequential);
+	static int64 Exchange(volatile int64* location, int64 value, MemoryOrder order = MemoryOrder_Sequential);
 
 	/**
 		Compares two values for equality and, if they are equal, replaces one of the values.
@@ -42,26 +91,35 @@ public:
 			The value that replaces the destination value if the comparison results in equality.
 		@param comparand
 			The value that is compared to the value at location.
-		@return The new value stored at location.
+		@param order
+			The memory order of the operation when the value is replaced. When the comparison fails, the release part of the order is dropped.
+		@return The original value of location. The exchange happened if it is equal to comparand.
 	*/
-	static void* CompareExchange(volatile void** location, void* value, void* comparand);
-	static int32 CompareExchange(volatile int32* location, int32 value, int32 comparand);
+	static void* CompareExchange(volatile void** location, void* value, void* comparand, MemoryOrder order = MemoryOrder_Sequential);
+	static int32 CompareExchange(volatile int32* location, int32 value, int32 comparand, MemoryOrder order = MemoryOrder_Sequential);
+	static int64 CompareExchange(volatile int64* location, int64 value, int64 comparand, MemoryOrder order = MemoryOrder_Sequential);
 
 	/**
 		Increments a specified variable and stores the result, as an atomic operation.
 		@param location
 			The variable whose value is to be incremented.
+		@param order
+			The memory order of the operation.
 		@return The incremented value.
 	*/
-	static int32 Increment(volatile int32* location);
+	static int32 Increment(volatile int32* location, MemoryOrder order = MemoryOrder_Sequential);
+	static int64 Increment(volatile int64* location, MemoryOrder order = MemoryOrder_Sequential);
 
 	/**
 		Decrements a specified variable and stores the result, as an atomic operation.
 		@param location
 			The variable whose value is to be decremented.
+		@param order
+			The memory order of the operation.
 		@return The decremented value.
 	*/
-	static int32 Decrement(volatile int32* location);
+	static int32 Decrement(volatile int32* location, MemoryOrder order = MemoryOrder_Sequential);
+	static int64 Decrement(volatile int64* location, MemoryOrder order = MemoryOrder_Sequential);
 
 	/**
 		Adds two integers and replaces the first integer with the sum, as an atomic operation.
@@ -69,9 +127,19 @@ public:
 			A variable containing the first value to be added. The sum of the two values is stored in location.
 		@param value
 			The value to be added to the integer at location.
+		@param order
+			The memory order of the operation.
 		@return The new value stored at location.
 	*/
-	static int32 Add(volatile int32* location, int32 value);
+	static int32 Add(volatile int32* location, int32 value, MemoryOrder order = MemoryOrder_Sequential);
+	static int64 Add(volatile int64* location, int64 value, MemoryOrder order = MemoryOrder_Sequential);
+
+	/**
+		Prevents the compiler and the processor from reordering the memory accesses across this call.
+		@param order
+			The memory order of the fence.
+	*/
+	static void MemoryFence(MemoryOrder order = MemoryOrder_Sequential);
 };
 
 }
@@ -86,4 +154,4 @@ public:
 #	include "Platforms/Std/StdInterlocked.inl"
 #endif
 
-#endif 
+#endif
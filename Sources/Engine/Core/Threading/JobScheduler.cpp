@@ -0,0 +1,455 @@
+/*=============================================================================
+JobScheduler.cpp
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+#include "JobScheduler.h"
+#include "Core/Threading/Thread.h"
+#include "Core/Threading/WorkStealingQueue.h"
+#include "Core/System/Environment.h"
+#include <new>
+
+namespace SonataEngine
+{
+
+const int32 JobScheduler::MaxJobCount = 4096;
+
+/// Size of a cache line, used to keep the jobs of different threads apart.
+static const int32 CacheLineSize = 64;
+
+/// Maximum number of jobs created by a parallel loop.
+static const int32 MaxChunkCount = 1024;
+
+/// Number of failed attempts to get a job before a worker goes to sleep.
+static const int32 SpinCount = 64;
+
+/// Index of the current thread in the scheduler.
+static SE_THREAD_LOCAL int32 _ThreadIndex = -1;
+
+/// Distance between two jobs, so that jobs running on different threads don't share a cache line.
+static const int32 JobStride = (sizeof(Job) + CacheLineSize - 1) & ~(CacheLineSize - 1);
+
+/// Data owned by each thread executing the jobs.
+class JobThreadData
+{
+public:
+	JobThreadData();
+	~JobThreadData();
+
+	/** Gets the job at an index of the ring buffer. */
+	Job* GetJob(uint32 index) const
+	{
+		return (Job*)(_jobs + (index & (JobScheduler::MaxJobCount - 1)) * JobStride);
+	}
+
+public:
+	WorkStealingQueue _queue;
+	SEbyte* _buffer;
+	SEbyte* _jobs;
+	uint32 _jobIndex;
+};
+
+JobThreadData::JobThreadData() :
+	_queue(JobScheduler::MaxJobCount),
+	_buffer(NULL),
+	_jobs(NULL),
+	_jobIndex(0)
+{
+	// The buffer is aligned on a cache line, new only aligns it for the largest primitive type
+	_buffer = new SEbyte[JobScheduler::MaxJobCount * JobStride + CacheLineSize - 1];
+	_jobs = (SEbyte*)(((size_t)_buffer + CacheLineSize - 1) & ~(size_t)(CacheLineSize - 1));
+	for (int32 i = 0; i < JobScheduler::MaxJobCount; i++)
+	{
+		new (_jobs + i * JobStride) Job();
+	}
+}
+
+JobThreadData::~JobThreadData()
+{
+	// The jobs have no destructor to call
+	delete[] _buffer;
+}
+
+/// Thread executing the jobs.
+class JobWorker : public Thread
+{
+public:
+	JobWorker(JobScheduler* scheduler, int32 index);
+
+	virtual void Run();
+
+protected:
+	JobScheduler* _scheduler;
+	int32 _index;
+};
+
+JobWorker::JobWorker(JobScheduler* scheduler, int32 index) :
+	Thread(),
+	_scheduler(scheduler),
+	_index(index)
+{
+}
+
+void JobWorker::Run()
+{
+	_ThreadIndex = _index;
+
+	int32 failedCount = 0;
+	while (Interlocked::Load(&_scheduler->_running, MemoryOrder_Acquire) != 0)
+	{
+		if (_scheduler->ExecuteNextJob())
+		{
+			failedCount = 0;
+		}
+		else if (++failedCount >= SpinCount)
+		{
+			_scheduler->Idle();
+			failedCount = 0;
+		}
+	}
+
+	_ThreadIndex = -1;
+}
+
+/// Shared data of the jobs of a parallel loop.
+struct ParallelForData
+{
+	ParallelForFunction _function;
+	void* _data;
+};
+
+
+JobScheduler::JobScheduler() :
+	_threadCount(0),
+	_threads(NULL),
+	_workers(NULL),
+	_semaphore(NULL),
+	_sleepingCount(0),
+	_running(0)
+{
+}
+
+JobScheduler::~JobScheduler()
+{
+	Destroy();
+}
+
+void JobScheduler::Create(int32 workerCount)
+{
+	if (IsCreated())
+	{
+		return;
+	}
+
+	if (workerCount < 0)
+	{
+		workerCount = Environment::ProcessorCount() - 1;
+		if (workerCount < 0)
+		{
+			workerCount = 0;
+		}
+	}
+
+	_threadCount = workerCount + 1;
+	_threads = new JobThreadData*[_threadCount];
+	for (int32 i = 0; i < _threadCount; i++)
+	{
+		_threads[i] = new JobThreadData();
+	}
+
+	// Each sleeping worker is released at most once by WakeUp and once by Destroy
+	_semaphore = new Semaphore(0, 2 * _threadCount);
+	_sleepingCount = 0;
+	Interlocked::Store(&_running, 1);
+
+	_ThreadIndex = 0;
+
+	_workers = new JobWorker*[_threadCount];
+	_workers[0] = NULL;
+	for (int32 i = 1; i < _threadCount; i++)
+	{
+		_workers[i] = new JobWorker(this, i);
+		_workers[i]->Start();
+	}
+}
+
+void JobScheduler::Destroy()
+{
+	if (!IsCreated())
+	{
+		return;
+	}
+
+	Interlocked::Store(&_running, 0);
+	if (_threadCount > 1)
+	{
+		_semaphore->Release(_threadCount - 1);
+	}
+
+	for (int32 i = 1; i < _threadCount; i++)
+	{
+		_workers[i]->Join(Thread::Infinite);
+		delete _workers[i];
+	}
+	delete[] _workers;
+	_workers = NULL;
+
+	for (int32 i = 0; i < _threadCount; i++)
+	{
+		delete _threads[i];
+	}
+	delete[] _threads;
+	_threads = NULL;
+
+	delete _semaphore;
+	_semaphore = NULL;
+
+	_threadCount = 0;
+	_ThreadIndex = -1;
+}
+
+int32 JobScheduler::GetThreadIndex() const
+{
+	return _ThreadIndex;
+}
+
+Job* JobScheduler::AllocateJob()
+{
+	SE_ASSERT(IsCreated() && _ThreadIndex >= 0);
+
+	JobThreadData* thread = _threads[_ThreadIndex];
+	Job* job = thread->GetJob(thread->_jobIndex++);
+
+	// Too many jobs are created by the thread before the jobs are finished
+	SE_ASSERT(IsFinished(job));
+
+	return job;
+}
+
+Job* JobScheduler::CreateJob(JobFunction function, void* data)
+{
+	Job* job = AllocateJob();
+	job->_function = function;
+	job->_data = data;
+	job->_parent = NULL;
+	job->_start = 0;
+	job->_end = 0;
+	job->_chunkSize = 0;
+	Interlocked::Store(&job->_unfinishedJobs, 1, MemoryOrder_Relaxed);
+	return job;
+}
+
+Job* JobScheduler::CreateChildJob(Job* parent, JobFunction function, void* data)
+{
+	SE_ASSERT(parent != NULL && !IsFinished(parent));
+
+	Interlocked::Increment(&parent->_unfinishedJobs);
+
+	Job* job = CreateJob(function, data);
+	job->_parent = parent;
+	return job;
+}
+
+void JobScheduler::Run(Job* job)
+{
+	SE_ASSERT(IsCreated() && _ThreadIndex >= 0);
+
+	if (!_threads[_ThreadIndex]->_queue.Push(job))
+	{
+		Execute(job);
+		return;
+	}
+
+	WakeUp();
+}
+
+void JobScheduler::Wait(Job* job)
+{
+	while (!IsFinished(job))
+	{
+		if (!ExecuteNextJob())
+		{
+			Thread::Sleep(0);
+		}
+	}
+}
+
+bool JobScheduler::IsFinished(const Job* job) const
+{
+	return (Interlocked::Load((volatile int32*)&job->_unfinishedJobs, MemoryOrder_Acquire) == 0);
+}
+
+void JobScheduler::ParallelFor(int32 count, ParallelForFunction function, void* data, int32 chunkSize)
+{
+	if (count <= 0)
+	{
+		return;
+	}
+
+	if (!IsCreated() || _ThreadIndex < 0)
+	{
+		function(0, count, data);
+		return;
+	}
+
+	if (chunkSize <= 0)
+	{
+		// Several chunks per thread to balance the load
+		chunkSize = count / (_threadCount * 4);
+		if (chunkSize < 1)
+		{
+			chunkSize = 1;
+		}
+	}
+
+	// The jobs of the loop must not wrap around the job buffers
+	int32 minChunkSize = (count + MaxChunkCount - 1) / MaxChunkCount;
+	if (chunkSize < minChunkSize)
+	{
+		chunkSize = minChunkSize;
+	}
+
+	ParallelForData loop;
+	loop._function = function;
+	loop._data = data;
+
+	Job* root = CreateJob(ParallelForJob, &loop);
+	root->_start = 0;
+	root->_end = count;
+	root->_chunkSize = chunkSize;
+
+	Execute(root);
+	Wait(root);
+}
+
+Job* JobScheduler::GetNextJob()
+{
+	SE_ASSERT(IsCreated() && _ThreadIndex >= 0);
+
+	Job* job = (Job*)_threads[_ThreadIndex]->_queue.Pop();
+	if (job != NULL)
+	{
+		return job;
+	}
+
+	// Steal from the other threads, starting with the next one
+	for (int32 i = 1; i < _threadCount; i++)
+	{
+		int32 victim = (_ThreadIndex + i) % _threadCount;
+		job = (Job*)_threads[victim]->_queue.Steal();
+		if (job != NULL)
+		{
+			return job;
+		}
+	}
+
+	return NULL;
+}
+
+bool JobScheduler::ExecuteNextJob()
+{
+	Job* job = GetNextJob();
+	if (job == NULL)
+	{
+		return false;
+	}
+
+	Execute(job);
+	return true;
+}
+
+void JobScheduler::Execute(Job* job)
+{
+	if (job->_function != NULL)
+	{
+		job->_function(job, job->_data);
+	}
+
+	Finish(job);
+}
+
+void JobScheduler::Finish(Job* job)
+{
+	// Once the job is finished, its thread can reuse it, so the parent is read before
+	Job* parent = job->_parent;
+	if (Interlocked::Decrement(&job->_unfinishedJobs) == 0 && parent != NULL)
+	{
+		Finish(parent);
+	}
+}
+
+void JobScheduler::Idle()
+{
+	Interlocked::Increment(&_sleepingCount);
+
+	// Look for a job pushed before the sleeping count was visible
+	Job* job = GetNextJob();
+	if (job != NULL)
+	{
+		if (!ClaimSleeper())
+		{
+			// A thread already released the semaphore for this worker
+			_semaphore->Wait();
+		}
+
+		Execute(job);
+		return;
+	}
+
+	_semaphore->Wait();
+}
+
+void JobScheduler::WakeUp()
+{
+	// The pushed job must be visible before reading the sleeping count
+	Interlocked::MemoryFence(MemoryOrder_Sequential);
+
+	if (ClaimSleeper())
+	{
+		_semaphore->Release();
+	}
+}
+
+bool JobScheduler::ClaimSleeper()
+{
+	int32 count = Interlocked::Load(&_sleepingCount);
+	while (count > 0)
+	{
+		int32 previous = Interlocked::CompareExchange(&_sleepingCount, count - 1, count);
+		if (previous == count)
+		{
+			return true;
+		}
+		count = previous;
+	}
+	return false;
+}
+
+void JobScheduler::ParallelForJob(Job* job, void* data)
+{
+	JobScheduler* scheduler = JobScheduler::Instance();
+	ParallelForData* loop = (ParallelForData*)data;
+
+	int32 start = job->_start;
+	int32 end = job->_end;
+	int32 chunkSize = job->_chunkSize;
+
+	// Split the range in halves so that the thieves take large ranges
+	while (end - start > chunkSize)
+	{
+		int32 middle = start + (end - start) / 2;
+
+		Job* child = scheduler->CreateChildJob(job, ParallelForJob, data);
+		child->_start = middle;
+		child->_end = end;
+		child->_chunkSize = chunkSize;
+		scheduler->Run(child);
+
+		end = middle;
+	}
+
+	loop->_function(start, end, loop->_data);
+}
+
+}
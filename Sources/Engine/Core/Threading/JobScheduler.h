@@ -0,0 +1,188 @@
+/*=============================================================================
+JobScheduler.h
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+#ifndef _SE_JOBSCHEDULER_H_
+#define _SE_JOBSCHEDULER_H_
+
+#include "Core/Common.h"
+#include "Core/Singleton.h"
+#include "Core/Threading/Interlocked.h"
+#include "Core/Threading/Semaphore.h"
+
+namespace SonataEngine
+{
+
+class Job;
+class JobThreadData;
+class JobWorker;
+
+/** Represents the method that executes a Job. */
+typedef void (*JobFunction)(Job* job, void* data);
+
+/** Represents the method that executes a range of iterations of a parallel loop. */
+typedef void (*ParallelForFunction)(int32 start, int32 end, void* data);
+
+/**
+	@class Job
+	@group Threading
+	@brief A unit of work executed by the JobScheduler.
+	@remarks
+		A job is finished when its function and all its children have been executed.
+		The jobs are allocated by the scheduler and remain valid until the same thread creates JobScheduler::MaxJobCount other jobs.
+*/
+class SE_CORE_EXPORT Job
+{
+	friend class JobScheduler;
+
+public:
+	/** Initializes a new instance of the Job class. */
+	Job() :
+		_function(NULL),
+		_data(NULL),
+		_parent(NULL),
+		_unfinishedJobs(0),
+		_start(0),
+		_end(0),
+		_chunkSize(0)
+	{
+	}
+
+	/** Gets the function executed by the job. */
+	JobFunction GetFunction() const { return _function; }
+
+	/** Gets the data passed to the function. */
+	void* GetData() const { return _data; }
+
+	/** Gets the parent job. */
+	Job* GetParent() const { return _parent; }
+
+private:
+	JobFunction _function;
+	void* _data;
+	Job* _parent;
+	volatile int32 _unfinishedJobs;
+	int32 _start;
+	int32 _end;
+	int32 _chunkSize;
+};
+
+/**
+	@class JobScheduler
+	@group Threading
+	@brief Executes jobs on a pool of worker threads.
+	@remarks
+		Each thread has its own queue of jobs. A thread pushes and pops the jobs at the bottom of its queue,
+		and an idle thread steals the jobs at the top of the queues of the other threads.
+		The thread calling Create has the index 0 and takes part in the execution of the jobs while it waits for a job.
+		The jobs can only be created from that thread and from the jobs.
+		Use CreateChildJob to create jobs that must be finished before their parent is finished.
+*/
+class SE_CORE_EXPORT JobScheduler : public Singleton<JobScheduler>
+{
+	friend class JobWorker;
+
+public:
+	/** Maximum number of jobs that can be created by each thread before the jobs are reused. */
+	static const int32 MaxJobCount;
+
+public:
+	/** @name Constructors / Destructor. */
+	//@{
+	JobScheduler();
+	virtual ~JobScheduler();
+	//@}
+
+	/**
+		Starts the worker threads.
+		@param workerCount
+			The number of worker threads besides the calling thread.
+			Specify -1 to create one worker per additional processor.
+	*/
+	void Create(int32 workerCount = -1);
+
+	/** Stops the worker threads. The pending jobs are not executed. */
+	void Destroy();
+
+	/** Gets whether the worker threads are created. */
+	bool IsCreated() const { return (_threads != NULL); }
+
+	/** Gets the number of threads executing the jobs, including the thread that created the scheduler. */
+	int32 GetThreadCount() const { return _threadCount; }
+
+	/** Gets the index of the current thread, or -1 if the thread doesn't execute jobs. */
+	int32 GetThreadIndex() const;
+
+	/**
+		Creates a job.
+		@param function
+			The function executed by the job. Can be NULL for a job grouping child jobs.
+		@param data
+			The data passed to the function.
+		@return The new job.
+	*/
+	Job* CreateJob(JobFunction function, void* data = NULL);
+
+	/**
+		Creates a job that must be finished before its parent is finished.
+		@param parent
+			The parent job. Must not be finished.
+		@param function
+			The function executed by the job.
+		@param data
+			The data passed to the function.
+		@return The new job.
+	*/
+	Job* CreateChildJob(Job* parent, JobFunction function, void* data = NULL);
+
+	/** Queues a job for execution. The job is executed immediately if the queue is full. */
+	void Run(Job* job);
+
+	/** Executes other jobs until the specified job is finished. */
+	void Wait(Job* job);
+
+	/** Gets whether a job is finished. */
+	bool IsFinished(const Job* job) const;
+
+	/**
+		Executes a loop in parallel.
+		The iteration range is split in chunks that are executed as jobs, and the function returns when all the iterations are executed.
+		@param count
+			The number of iterations.
+		@param function
+			The function executed for each chunk of iterations.
+		@param data
+			The data passed to the function.
+		@param chunkSize
+			The maximum number of iterations of each chunk.
+			Specify 0 to choose the size from the number of threads.
+			The size is increased if the loop would create too many jobs.
+	*/
+	void ParallelFor(int32 count, ParallelForFunction function, void* data, int32 chunkSize = 0);
+
+protected:
+	Job* AllocateJob();
+	Job* GetNextJob();
+	bool ExecuteNextJob();
+	void Execute(Job* job);
+	void Finish(Job* job);
+	void Idle();
+	void WakeUp();
+	bool ClaimSleeper();
+
+	static void ParallelForJob(Job* job, void* data);
+
+protected:
+	int32 _threadCount;
+	JobThreadData** _threads;
+	JobWorker** _workers;
+	Semaphore* _semaphore;
+	volatile int32 _sleepingCount;
+	volatile int32 _running;
+};
+
+}
+
+#endif
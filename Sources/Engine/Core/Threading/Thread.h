@@ -67,6 +67,13 @@ typedef void* (*ThreadStart)(void);
 	typedef uint32 ThreadId;
 #endif
 
+/// Declares a variable with one instance per thread.
+#if defined(_MSC_VER)
+#	define SE_THREAD_LOCAL __declspec(thread)
+#else
+#	define SE_THREAD_LOCAL __thread
+#endif
+
 class ThreadInternal;
 
 /**
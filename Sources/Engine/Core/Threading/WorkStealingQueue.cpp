@@ -0,0 +1,28 @@
+/*=============================================================================
+WorkStealingQueue.cpp
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+#include "WorkStealingQueue.h"
+#include "Core/System/Memory.h"
+
+namespace SonataEngine
+{
+
+WorkStealingQueue::WorkStealingQueue(int32 capacity) :
+	_elements(NULL),
+	_mask(capacity - 1),
+	_top(0),
+	_bottom(0)
+{
+	SE_ASSERT(capacity > 0 && (capacity & (capacity - 1)) == 0);
+	_elements = (volatile void**)Memory::Calloc(capacity, sizeof(void*));
+}
+
+WorkStealingQueue::~WorkStealingQueue()
+{
+	Memory::Free((void*)_elements);
+}
+
+}
@@ -0,0 +1,165 @@
+/*=============================================================================
+WorkStealingQueue.h
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+#ifndef _SE_WORKSTEALINGQUEUE_H_
+#define _SE_WORKSTEALINGQUEUE_H_
+
+#include "Core/Common.h"
+#include "Core/Threading/Interlocked.h"
+
+namespace SonataEngine
+{
+
+/**
+	@class WorkStealingQueue
+	@group Threading
+	@brief Fixed-size double-ended queue of pointers that can be stolen by other threads (Chase-Lev deque).
+	@remarks
+		Only the thread owning the queue can call Push and Pop, which work on the bottom of the queue without locking in most cases.
+		Any other thread can call Steal, which takes the element at the top of the queue.
+		The indices are only compared by their difference so they can wrap around.
+*/
+class SE_CORE_EXPORT WorkStealingQueue
+{
+public:
+	/**
+		Initializes a new instance of the WorkStealingQueue class.
+		@param capacity
+			The maximum number of elements in the queue. Must be a power of two.
+	*/
+	WorkStealingQueue(int32 capacity);
+
+	/** Destructor. */
+	~WorkStealingQueue();
+
+	/** Gets the maximum number of elements in the queue. */
+	int32 GetCapacity() const;
+
+	/** Gets the number of elements in the queue. The value may be outdated if other threads are using the queue. */
+	int32 Count() const;
+
+	/**
+		Adds an element to the bottom of the queue. Can only be called by the owner thread.
+		@return false if the queue is full.
+	*/
+	bool Push(void* value);
+
+	/**
+		Removes the element at the bottom of the queue. Can only be called by the owner thread.
+		@return The removed element, or NULL if the queue is empty.
+	*/
+	void* Pop();
+
+	/**
+		Removes the element at the top of the queue. Can be called by any thread.
+		@return The removed element, or NULL if the queue is empty or if another thread took the element.
+	*/
+	void* Steal();
+
+private:
+	WorkStealingQueue(const WorkStealingQueue&);
+	WorkStealingQueue& operator=(const WorkStealingQueue&);
+
+	static int32 Distance(int32 from, int32 to);
+
+private:
+	volatile void** _elements;
+	int32 _mask;
+	volatile int32 _top;
+	volatile int32 _bottom;
+};
+
+
+SE_INLINE int32 WorkStealingQueue::GetCapacity() const
+{
+	return _mask + 1;
+}
+
+SE_INLINE int32 WorkStealingQueue::Distance(int32 from, int32 to)
+{
+	return (int32)((uint32)to - (uint32)from);
+}
+
+SE_INLINE int32 WorkStealingQueue::Count() const
+{
+	int32 count = Distance(_top, _bottom);
+	return (count > 0 ? count : 0);
+}
+
+SE_INLINE bool WorkStealingQueue::Push(void* value)
+{
+	int32 bottom = Interlocked::Load(&_bottom, MemoryOrder_Relaxed);
+	int32 top = Interlocked::Load(&_top, MemoryOrder_Acquire);
+	if (Distance(top, bottom) > _mask)
+	{
+		return false;
+	}
+
+	Interlocked::Store(&_elements[bottom & _mask], value, MemoryOrder_Relaxed);
+
+	// Publish the element before the new bottom
+	Interlocked::Store(&_bottom, (int32)((uint32)bottom + 1), MemoryOrder_Release);
+	return true;
+}
+
+SE_INLINE void* WorkStealingQueue::Pop()
+{
+	int32 bottom = (int32)((uint32)Interlocked::Load(&_bottom, MemoryOrder_Relaxed) - 1);
+	Interlocked::Store(&_bottom, bottom, MemoryOrder_Relaxed);
+
+	// The new bottom must be visible to the thieves before reading the top
+	Interlocked::MemoryFence(MemoryOrder_Sequential);
+
+	int32 top = Interlocked::Load(&_top, MemoryOrder_Relaxed);
+	int32 count = Distance(top, bottom);
+	if (count < 0)
+	{
+		// Empty queue
+		Interlocked::Store(&_bottom, top, MemoryOrder_Relaxed);
+		return NULL;
+	}
+
+	void* value = Interlocked::Load(&_elements[bottom & _mask], MemoryOrder_Relaxed);
+	if (count > 0)
+	{
+		// More than one element, no thief can reach this one
+		return value;
+	}
+
+	// Last element, race against the thieves for it
+	if (Interlocked::CompareExchange(&_top, (int32)((uint32)top + 1), top) != top)
+	{
+		value = NULL;
+	}
+	Interlocked::Store(&_bottom, (int32)((uint32)top + 1), MemoryOrder_Relaxed);
+	return value;
+}
+
+SE_INLINE void* WorkStealingQueue::Steal()
+{
+	int32 top = Interlocked::Load(&_top, MemoryOrder_Acquire);
+
+	// The top must be read before the bottom
+	Interlocked::MemoryFence(MemoryOrder_Sequential);
+
+	int32 bottom = Interlocked::Load(&_bottom, MemoryOrder_Acquire);
+	if (Distance(top, bottom) <= 0)
+	{
+		return NULL;
+	}
+
+	void* value = Interlocked::Load(&_elements[top & _mask], MemoryOrder_Relaxed);
+	if (Interlocked::CompareExchange(&_top, (int32)((uint32)top + 1), top) != top)
+	{
+		// Another thread took the element first
+		return NULL;
+	}
+	return value;
+}
+
+}
+
+#endif
@@ -15,6 +15,7 @@ Author: Julien Delezenne
 #include "MorphAnimationTrack.h"
 #include "MorphKeyFrame.h"
 #include "NodeAnimationTrack.h"
+#include "TransformAnimationTrack.h"
 #include "TransformKeyFrame.h"
 #include "ValueKeyFrame.h"
 
@@ -11,7 +11,8 @@ namespace SonataEngine
 
 AnimationTrack::AnimationTrack() :
 	NamedObject(),
-	_isEnabled(true)
+	_isEnabled(true),
+	_keyFramesChanged(false)
 {
 }
 
@@ -43,41 +44,18 @@ int AnimationTrack::GetKeyFrameCount() const
 
 KeyFrame* AnimationTrack::AddKeyFrame(const TimeValue& timeValue)
 {
-	KeyFrame* keyFrame = NULL;//GetKeyFrameAtTime(timeValue);
-	if (keyFrame != NULL)
+	int index = FindKeyFrameAfter(timeValue);
+	if (index > 0 && _keyFrames[index - 1]->GetTime() == timeValue)
 	{
-		return keyFrame;
+		return _keyFrames[index - 1];
 	}
 
-	keyFrame = _CreateKeyFrame(timeValue);
+	KeyFrame* keyFrame = _CreateKeyFrame(timeValue);
+	keyFrame->_parentTrack = this;
 
-	if (_keyFrames.Count() == 0)
-	{
-		// There are no keyframes, just add the first one
-		_keyFrames.AddLast(keyFrame);
-		return keyFrame;
-	}
-	else
-	{
-#if 0
-		const TimeValue& timeValue = keyFrame->GetTime();
-		KeyFrameList::Node node = _keyFrames.First();
-		while (node != _keyFrames.Last())
-		{
-			KeyFrame* current = node.GetValue();
-			if (current->GetTime() > timeValue)
-			{
-				// The time value is lower than the keyframe, insert at this index
-				_keyFrames.AddAfter(node, keyFrame);
-				return keyFrame;
-			}
-			node = node.Next();
-		}
-#endif
-		// The time value is higher than all the first keyframe, insert at the end
-		_keyFrames.AddLast(keyFrame);
-		return keyFrame;
-	}
+	_keyFrames.Insert(index, keyFrame);
+	_keyFramesChanged = true;
+	return keyFrame;
 }
 
 void AnimationTrack::RemoveKeyFrame(KeyFrame* value)
@@ -88,12 +66,19 @@ void AnimationTrack::RemoveKeyFrame(KeyFrame* value)
 		return;
 	}
 
-	_keyFrames.Remove(value);
+	int index = GetKeyFrameIndex(value);
+	if (index >= 0)
+	{
+		_keyFrames.RemoveAt(index);
+		value->_parentTrack = NULL;
+		_keyFramesChanged = true;
+	}
 }
 
 void AnimationTrack::RemoveAllKeyFrames()
 {
 	_keyFrames.Clear();
+	_keyFramesChanged = true;
 }
 
 int AnimationTrack::GetKeyFrameIndex(KeyFrame* value) const
@@ -103,15 +88,24 @@ int AnimationTrack::GetKeyFrameIndex(KeyFrame* value) const
 		SEthrow(ArgumentNullException("value"));
 		return -1;
 	}
-	else
+
+	int index = FindKeyFrameAfter(value->GetTime()) - 1;
+	if (index >= 0 && _keyFrames[index] == value)
 	{
-		return 0;//_keyFrames.IndexOf(value);
+		return index;
 	}
+
+	return -1;
 }
 
 KeyFrame* AnimationTrack::GetKeyFrameByIndex(int index) const
 {
-	return NULL;//_keyFrames[index];
+	if (index < 0 || index >= _keyFrames.Count())
+	{
+		return NULL;
+	}
+
+	return _keyFrames[index];
 }
 
 void AnimationTrack::SetStartEndTimes(const TimeValue& startTime, const TimeValue& endTime)
@@ -131,17 +125,35 @@ KeyFrame* AnimationTrack::_CreateKeyFrame(const TimeValue& timeValue)
 	return new KeyFrame(timeValue);
 }
 
-KeyFrame* AnimationTrack::GetKeyFrameAtTime(const TimeValue& timeValue) const
+int AnimationTrack::FindKeyFrameAfter(const TimeValue& timeValue) const
 {
-	KeyFrameList::Iterator it = _keyFrames.GetIterator();
-	while (it.Next())
+	real64 time = (real64)timeValue;
+	int low = 0;
+	int high = _keyFrames.Count();
+	while (low < high)
 	{
-		if (it.Current()->GetTime() == timeValue)
+		int middle = (low + high) / 2;
+		if ((real64)_keyFrames[middle]->GetTime() <= time)
+		{
+			low = middle + 1;
+		}
+		else
 		{
-			return it.Current();
+			high = middle;
 		}
 	}
 
+	return low;
+}
+
+KeyFrame* AnimationTrack::GetKeyFrameAtTime(const TimeValue& timeValue) const
+{
+	int index = FindKeyFrameAfter(timeValue) - 1;
+	if (index >= 0 && _keyFrames[index]->GetTime() == timeValue)
+	{
+		return _keyFrames[index];
+	}
+
 	return NULL;
 }
 
@@ -158,25 +170,24 @@ TimeValue AnimationTrack::GetKeyFramesAtTime(const TimeValue& timeValue, KeyFram
 		return TimeValue(0.0);
 	}
 
-	KeyFrame* previous = NULL;
-	KeyFrameList::Iterator it = _keyFrames.GetIterator();
-	while (it.Next())
+	if (_keyFrames.Count() == 0)
 	{
-		KeyFrame* current = it.Current();
-		if (current->GetTime() > timeValue)
-		{
-			*keyA = (previous != NULL) ? previous : current;
-			*keyB = current;
-			return ((*keyB)->GetTime() - (*keyA)->GetTime());
-		}
-
-		previous = current;
+		*keyA = NULL;
+		*keyB = NULL;
+		return TimeValue(0.0);
 	}
 
-	*keyA = previous;
-	*keyB = previous;
+	int index = FindKeyFrameAfter(timeValue);
+	if (index == _keyFrames.Count())
+	{
+		*keyA = _keyFrames[index - 1];
+		*keyB = _keyFrames[index - 1];
+		return TimeValue(0.0);
+	}
 
-	return TimeValue(0.0);
+	*keyA = (index > 0) ? _keyFrames[index - 1] : _keyFrames[index];
+	*keyB = _keyFrames[index];
+	return ((*keyB)->GetTime() - (*keyA)->GetTime());
 }
 
 void AnimationTrack::SetKeyFrameTime(KeyFrame* keyFrame, const TimeValue& timeValue)
@@ -195,27 +206,22 @@ void AnimationTrack::SetKeyFrameTime(KeyFrame* keyFrame, const TimeValue& timeVa
 		return;
 	}
 
-	//TODO
-	/*int index = 0;
-	KeyFrameList::Iterator it = _keyFrames.GetIterator();
-	while (it.Next())
+	// A key frame at that time already exists
+	if (GetKeyFrameAtTime(timeValue) != NULL)
 	{
-		// A key frame at that time already exists
-		if (it.Current()->GetTime() == timeValue)
-		{
-			return;
-		}
-		// This key frame has a greater time valuer, move the key frame before it
-		if (it.Current()->GetTime() > timeValue)
-		{
-			_keyFrames.Remove(keyFrame);
-			_keyFrames.Insert(index, keyFrame);
-			return;
-		}
-		index++;
+		return;
+	}
+
+	int index = GetKeyFrameIndex(keyFrame);
+	if (index < 0)
+	{
+		return;
 	}
-	_keyFrames.Remove(keyFrame);
-	_keyFrames.AddLast(keyFrame);*/
+
+	_keyFrames.RemoveAt(index);
+	keyFrame->_timeValue = timeValue;
+	_keyFrames.Insert(FindKeyFrameAfter(timeValue), keyFrame);
+	_keyFramesChanged = true;
 }
 
 void AnimationTrack::Update(const TimeValue& timeValue)
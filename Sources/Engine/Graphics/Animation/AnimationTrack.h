@@ -25,11 +25,12 @@ class SE_GRAPHICS_EXPORT AnimationTrack : public NamedObject
 	friend KeyFrame;
 
 public:
-	typedef List<KeyFrame*> KeyFrameList;
+	typedef Array<KeyFrame*> KeyFrameList;
 
 protected:
 	bool _isEnabled;
 	KeyFrameList _keyFrames;
+	bool _keyFramesChanged;
 	TimeValue _startTime;
 	TimeValue _endTime;
 	TimeValue _length;
@@ -114,8 +115,9 @@ public:
 	/** Sets the length of the animation track by setting the start time to zero and the end time to the specified length. */
 	void SetLength(const TimeValue& length);
 
-	/** Retrieves the number of key frame of a given type.
-		To retrieve the total number of key frame, see GetKeyFrameCount.
+	/** Retrieves the key frame at a given time value.
+		@param time The time value.
+		@return The key frame if found, NULL otherwise.
 	*/
 	KeyFrame* GetKeyFrameAtTime(const TimeValue& timeValue) const;
 
@@ -140,6 +142,14 @@ public:
 	//@}
 
 protected:
+	/** Gets the index of the first key frame after a given time value.
+		@remarks
+			The key frames are sorted, the index is found by a binary search.
+		@return The index of the key frame, or the number of key frames if
+			there is no key frame after the time value.
+	*/
+	int FindKeyFrameAfter(const TimeValue& timeValue) const;
+
 	/** Creates a specialized key frame. */
 	virtual KeyFrame* _CreateKeyFrame(const TimeValue& timeValue) = 0;
 };
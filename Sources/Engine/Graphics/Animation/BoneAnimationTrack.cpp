@@ -10,7 +10,7 @@ namespace SonataEngine
 {
 
 BoneAnimationTrack::BoneAnimationTrack() :
-	AnimationTrack(),
+	TransformAnimationTrack(),
 	_bone(NULL)
 {
 }
@@ -21,51 +21,7 @@ BoneAnimationTrack::~BoneAnimationTrack()
 
 TransformKeyFrame* BoneAnimationTrack::GetBoneKeyFrame(int index) const
 {
-	return (TransformKeyFrame*)GetKeyFrameByIndex(index);
-}
-
-void BoneAnimationTrack::GetTranslationKeys(BaseArray<KeyVector3>& translationKeys)
-{
-	KeyFrameList::Iterator it = _keyFrames.GetIterator();
-	while (it.Next())
-	{
-		TransformKeyFrame* keyFrame = (TransformKeyFrame*)it.Current();
-		if ((keyFrame->GetTransformType() & TransformKeyFrameType_Translation) != 0)
-		{
-			translationKeys.Add(KeyVector3(keyFrame->GetTime(), keyFrame->GetTranslation()));
-		}
-	}
-}
-
-void BoneAnimationTrack::GetRotationKeys(BaseArray<KeyQuaternion>& rotationKeys)
-{
-	KeyFrameList::Iterator it = _keyFrames.GetIterator();
-	while (it.Next())
-	{
-		TransformKeyFrame* keyFrame = (TransformKeyFrame*)it.Current();
-		if ((keyFrame->GetTransformType() & TransformKeyFrameType_Rotation) != 0)
-		{
-			rotationKeys.Add(KeyQuaternion(keyFrame->GetTime(), keyFrame->GetRotation()));
-		}
-	}
-}
-
-void BoneAnimationTrack::GetScaleKeys(BaseArray<KeyVector3>& scaleKeys)
-{
-	KeyFrameList::Iterator it = _keyFrames.GetIterator();
-	while (it.Next())
-	{
-		TransformKeyFrame* keyFrame = (TransformKeyFrame*)it.Current();
-		if ((keyFrame->GetTransformType() & TransformKeyFrameType_Scale) != 0)
-		{
-			scaleKeys.Add(KeyVector3(keyFrame->GetTime(), keyFrame->GetScale()));
-		}
-	}
-}
-
-KeyFrame* BoneAnimationTrack::_CreateKeyFrame(const TimeValue& timeValue)
-{
-	return new TransformKeyFrame(timeValue);
+	return GetTransformKeyFrame(index);
 }
 
 void BoneAnimationTrack::Update(const TimeValue& timeValue)
@@ -75,40 +31,23 @@ void BoneAnimationTrack::Update(const TimeValue& timeValue)
 		return;
 	}
 
-	KeyFrame* keyA = NULL;
-	KeyFrame* keyB = NULL;
-	TimeValue delta = GetKeyFramesAtTime(timeValue, &keyA, &keyB);
-
-	if (keyA == NULL || keyB == NULL)
-	{
-		return;
-	}
-
-	real64 t = 0.0;
-	if (timeValue != keyA->GetTime())
-	{
-		t = (real64)(delta / (timeValue - keyA->GetTime()));
-	}
+	UpdateKeys();
 
-	TransformKeyFrame* key1 = (TransformKeyFrame*)keyA;
-	TransformKeyFrame* key2 = (TransformKeyFrame*)keyB;
+	Vector3 translation;
+	Quaternion rotation;
+	Vector3 scale;
+	int32 components = Sample((real64)timeValue, _cursor, translation, rotation, scale);
 
-	if ((key1->GetTransformType() & TransformKeyFrameType_Translation) != 0 &&
-		(key2->GetTransformType() & TransformKeyFrameType_Translation) != 0)
+	if ((components & TransformKeyFrameType_Translation) != 0)
 	{
-		Vector3 translation = Vector3::Lerp(key1->GetTranslation(), key2->GetTranslation(), t);
 		_bone->SetLocalPosition(translation);
 	}
-	if ((key1->GetTransformType() & TransformKeyFrameType_Rotation) != 0 &&
-		(key2->GetTransformType() & TransformKeyFrameType_Rotation) != 0)
+	if ((components & TransformKeyFrameType_Rotation) != 0)
 	{
-		Quaternion rotation = Quaternion::Slerp(key1->GetRotation(), key2->GetRotation(), t);
 		_bone->SetLocalOrientation(rotation);
 	}
-	if ((key1->GetTransformType() & TransformKeyFrameType_Scale) != 0 &&
-		(key2->GetTransformType() & TransformKeyFrameType_Scale) != 0)
+	if ((components & TransformKeyFrameType_Scale) != 0)
 	{
-		Vector3 scale = Vector3::Lerp(key1->GetScale(), key2->GetScale(), t);
 		_bone->SetLocalScale(scale);
 	}
 }
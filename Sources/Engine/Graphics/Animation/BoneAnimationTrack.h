@@ -9,8 +9,7 @@ Author: Julien Delezenne
 
 #include "Core/Core.h"
 #include "Graphics/Common.h"
-#include "Graphics/Animation/AnimationTrack.h"
-#include "Graphics/Animation/TransformKeyFrame.h"
+#include "Graphics/Animation/TransformAnimationTrack.h"
 #include "Graphics/Model/Bone.h"
 #include "Graphics/System/RenderData.h"
 
@@ -22,7 +21,7 @@ namespace SonataEngine
 
 	A bone track represents the animation of a bone transformation.
 */
-class SE_GRAPHICS_EXPORT BoneAnimationTrack : public AnimationTrack
+class SE_GRAPHICS_EXPORT BoneAnimationTrack : public TransformAnimationTrack
 {
 protected:
 	Bone* _bone;
@@ -45,19 +44,8 @@ public:
 
 	virtual TransformKeyFrame* GetBoneKeyFrame(int index) const;
 
-	/** Fills an array with translational key data used for key frame animation. */
-	void GetTranslationKeys(BaseArray<KeyVector3>& translationKeys);
-
-	/** Fills an array with rotational key data used for key frame animation. */
-	void GetRotationKeys(BaseArray<KeyQuaternion>& rotationKeys);
- 
-	/** Fills an array with scale key data used for key frame animation. */
-	void GetScaleKeys(BaseArray<KeyVector3>& scaleKeys);
-
+	/** Updates the transformation of the bone with the cursor of the track. */
 	virtual void Update(const TimeValue& timeValue);
-
-protected:
-	virtual KeyFrame* _CreateKeyFrame(const TimeValue& timeValue);
 };
 
 }
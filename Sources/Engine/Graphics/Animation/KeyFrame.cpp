@@ -37,4 +37,12 @@ void KeyFrame::SetTime(const TimeValue& value)
 	}
 }
 
+void KeyFrame::NotifyChanged()
+{
+	if (_parentTrack != NULL)
+	{
+		_parentTrack->_keyFramesChanged = true;
+	}
+}
+
 }
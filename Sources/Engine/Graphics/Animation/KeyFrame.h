@@ -51,6 +51,8 @@ enum RotationInterpolationMode
 */
 class SE_GRAPHICS_EXPORT KeyFrame : public Object
 {
+	friend class AnimationTrack;
+
 protected:
 	AnimationTrack* _parentTrack;
 	TimeValue _timeValue;
@@ -90,6 +92,10 @@ public:
 	/** Sets the interpolation mode of the key frame. */
 	void SetInterpolation(InterpolationMode value) { _interpolation = value; }
 	//@}
+
+protected:
+	/** Notifies the parent track that the data of the key frame changed. */
+	void NotifyChanged();
 };
 
 }
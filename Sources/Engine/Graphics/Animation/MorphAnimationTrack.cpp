@@ -54,10 +54,12 @@ void MorphAnimationTrack::Update(const TimeValue& timeValue)
 		return;
 	}
 
+	// The keys are the same before the first key and after the last key
 	real64 t = 0.0;
-	if (timeValue != keyA->GetTime())
+	real64 length = (real64)delta;
+	if (length > 0.0)
 	{
-		t = (real64)(delta / (timeValue - keyA->GetTime()));
+		t = ((real64)timeValue - (real64)keyA->GetTime()) / length;
 	}
 
 	MorphKeyFrame* key1 = (MorphKeyFrame*)keyA;
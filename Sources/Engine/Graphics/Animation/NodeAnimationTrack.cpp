@@ -10,7 +10,7 @@ namespace SonataEngine
 {
 
 NodeAnimationTrack::NodeAnimationTrack() :
-	AnimationTrack(),
+	TransformAnimationTrack(),
 	_node(NULL)
 {
 }
@@ -21,87 +21,34 @@ NodeAnimationTrack::~NodeAnimationTrack()
 
 TransformKeyFrame* NodeAnimationTrack::GetNodeKeyFrame(int index) const
 {
-	return (TransformKeyFrame*)GetKeyFrameByIndex(index);
+	return GetTransformKeyFrame(index);
 }
 
-void NodeAnimationTrack::GetTranslationKeys(BaseArray<KeyVector3>& translationKeys)
+void NodeAnimationTrack::Update(const TimeValue& timeValue)
 {
-	KeyFrameList::Iterator it = _keyFrames.GetIterator();
-	while (it.Next())
+	if (_node == NULL)
 	{
-		TransformKeyFrame* keyFrame = (TransformKeyFrame*)it.Current();
-		if ((keyFrame->GetTransformType() & TransformKeyFrameType_Translation) != 0)
-		{
-			translationKeys.Add(KeyVector3(keyFrame->GetTime(), keyFrame->GetTranslation()));
-		}
+		return;
 	}
-}
 
-void NodeAnimationTrack::GetRotationKeys(BaseArray<KeyQuaternion>& rotationKeys)
-{
-	KeyFrameList::Iterator it = _keyFrames.GetIterator();
-	while (it.Next())
-	{
-		TransformKeyFrame* keyFrame = (TransformKeyFrame*)it.Current();
-		if ((keyFrame->GetTransformType() & TransformKeyFrameType_Rotation) != 0)
-		{
-			rotationKeys.Add(KeyQuaternion(keyFrame->GetTime(), keyFrame->GetRotation()));
-		}
-	}
-}
+	UpdateKeys();
 
-void NodeAnimationTrack::GetScaleKeys(BaseArray<KeyVector3>& scaleKeys)
-{
-	KeyFrameList::Iterator it = _keyFrames.GetIterator();
-	while (it.Next())
+	Vector3 translation;
+	Quaternion rotation;
+	Vector3 scale;
+	int32 components = Sample((real64)timeValue, _cursor, translation, rotation, scale);
+
+	if ((components & TransformKeyFrameType_Translation) != 0)
 	{
-		TransformKeyFrame* keyFrame = (TransformKeyFrame*)it.Current();
-		if ((keyFrame->GetTransformType() & TransformKeyFrameType_Scale) != 0)
-		{
-			scaleKeys.Add(KeyVector3(keyFrame->GetTime(), keyFrame->GetScale()));
-		}
+		_node->SetLocalPosition(translation);
 	}
-}
-
-KeyFrame* NodeAnimationTrack::_CreateKeyFrame(const TimeValue& timeValue)
-{
-	return new TransformKeyFrame(timeValue);
-}
-
-void NodeAnimationTrack::Update(const TimeValue& timeValue)
-{
-	KeyFrame* keyA = NULL;
-	KeyFrame* keyB = NULL;
-	GetKeyFramesAtTime(timeValue, &keyA, &keyB);
-
-	if (keyA == NULL || keyB == NULL)
+	if ((components & TransformKeyFrameType_Rotation) != 0)
 	{
-		return;
+		_node->SetLocalOrientation(rotation);
 	}
-
-	if (_node != NULL)
+	if ((components & TransformKeyFrameType_Scale) != 0)
 	{
-		TransformKeyFrame* key = (TransformKeyFrame*)keyA;
-		if ((key->GetTransformType() & TransformKeyFrameType_Translation) != 0)
-		{
-			Vector3 translation = key->GetTranslation();
-			_node->SetLocalPosition(translation);
-		}
-		if ((key->GetTransformType() & TransformKeyFrameType_Rotation) != 0)
-		{
-			Quaternion rotation = key->GetRotation();
-			_node->SetLocalOrientation(rotation);
-		}
-		if ((key->GetTransformType() & TransformKeyFrameType_Scale) != 0)
-		{
-			Vector3 scale = key->GetScale();
-			_node->SetLocalScale(scale);
-		}
-
-		//Matrix4 transform = Matrix4::CreateScale(scale);
-		//transform *= Matrix4::CreateFromQuaternion(rotation);
-		//transform.SetTranslation(translation);
-		//_node->SetLocalTransform(transform);
+		_node->SetLocalScale(scale);
 	}
 }
 
@@ -0,0 +1,165 @@
+/*=============================================================================
+TransformAnimationTrack.cpp
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+#include "TransformAnimationTrack.h"
+
+namespace SonataEngine
+{
+
+TransformAnimationTrack::TransformAnimationTrack() :
+	AnimationTrack(),
+	_rotationInterpolation(RotationInterpolationMode_Spherical)
+{
+}
+
+TransformAnimationTrack::~TransformAnimationTrack()
+{
+}
+
+TransformKeyFrame* TransformAnimationTrack::GetTransformKeyFrame(int index) const
+{
+	return (TransformKeyFrame*)GetKeyFrameByIndex(index);
+}
+
+void TransformAnimationTrack::GetTranslationKeys(BaseArray<KeyVector3>& translationKeys)
+{
+	UpdateKeys();
+
+	for (int i = 0; i < _translationKeys.Count(); i++)
+	{
+		translationKeys.Add(_translationKeys[i]);
+	}
+}
+
+void TransformAnimationTrack::GetRotationKeys(BaseArray<KeyQuaternion>& rotationKeys)
+{
+	UpdateKeys();
+
+	for (int i = 0; i < _rotationKeys.Count(); i++)
+	{
+		rotationKeys.Add(_rotationKeys[i]);
+	}
+}
+
+void TransformAnimationTrack::GetScaleKeys(BaseArray<KeyVector3>& scaleKeys)
+{
+	UpdateKeys();
+
+	for (int i = 0; i < _scaleKeys.Count(); i++)
+	{
+		scaleKeys.Add(_scaleKeys[i]);
+	}
+}
+
+void TransformAnimationTrack::UpdateKeys()
+{
+	if (!_keyFramesChanged)
+	{
+		return;
+	}
+
+	_translationKeys.Clear();
+	_rotationKeys.Clear();
+	_scaleKeys.Clear();
+
+	// The key frames are sorted by time
+	KeyFrameList::Iterator it = _keyFrames.GetIterator();
+	while (it.Next())
+	{
+		TransformKeyFrame* keyFrame = (TransformKeyFrame*)it.Current();
+		real64 time = (real64)keyFrame->GetTime();
+		if ((keyFrame->GetTransformType() & TransformKeyFrameType_Translation) != 0)
+		{
+			_translationKeys.Add(KeyVector3(time, keyFrame->GetTranslation()));
+		}
+		if ((keyFrame->GetTransformType() & TransformKeyFrameType_Rotation) != 0)
+		{
+			_rotationKeys.Add(KeyQuaternion(time, keyFrame->GetRotation()));
+		}
+		if ((keyFrame->GetTransformType() & TransformKeyFrameType_Scale) != 0)
+		{
+			_scaleKeys.Add(KeyVector3(time, keyFrame->GetScale()));
+		}
+	}
+
+	_cursor = TransformKeyCursor();
+	_keyFramesChanged = false;
+}
+
+int32 TransformAnimationTrack::Sample(real64 time, TransformKeyCursor& cursor, Vector3& translation, Quaternion& rotation, Vector3& scale) const
+{
+	int32 components = 0;
+
+	if (!_translationKeys.IsEmpty())
+	{
+		int32 index = FindKey(_translationKeys, time, cursor.Translation);
+		real amount = GetAmount(_translationKeys, index, time);
+		if (amount > (real)0.0)
+		{
+			translation = Vector3::Lerp(_translationKeys[index].Value, _translationKeys[index + 1].Value, amount);
+		}
+		else
+		{
+			translation = _translationKeys[index].Value;
+		}
+		components |= TransformKeyFrameType_Translation;
+	}
+
+	if (!_rotationKeys.IsEmpty())
+	{
+		int32 index = FindKey(_rotationKeys, time, cursor.Rotation);
+		real amount = GetAmount(_rotationKeys, index, time);
+		if (amount > (real)0.0 && _rotationInterpolation != RotationInterpolationMode_Constant)
+		{
+			const Quaternion& left = _rotationKeys[index].Value;
+			Quaternion right = _rotationKeys[index + 1].Value;
+
+			if (_rotationInterpolation == RotationInterpolationMode_Linear)
+			{
+				// Lerp takes the shortest path and normalizes the result
+				rotation = Quaternion::Lerp(left, right, amount);
+			}
+			else
+			{
+				// Take the shortest path
+				if (Quaternion::Dot(left, right) < (real)0.0)
+				{
+					right = -right;
+				}
+				rotation = Quaternion::Slerp(left, right, amount);
+			}
+		}
+		else
+		{
+			rotation = _rotationKeys[index].Value;
+		}
+		components |= TransformKeyFrameType_Rotation;
+	}
+
+	if (!_scaleKeys.IsEmpty())
+	{
+		int32 index = FindKey(_scaleKeys, time, cursor.Scale);
+		real amount = GetAmount(_scaleKeys, index, time);
+		if (amount > (real)0.0)
+		{
+			scale = Vector3::Lerp(_scaleKeys[index].Value, _scaleKeys[index + 1].Value, amount);
+		}
+		else
+		{
+			scale = _scaleKeys[index].Value;
+		}
+		components |= TransformKeyFrameType_Scale;
+	}
+
+	return components;
+}
+
+KeyFrame* TransformAnimationTrack::_CreateKeyFrame(const TimeValue& timeValue)
+{
+	return new TransformKeyFrame(timeValue);
+}
+
+}
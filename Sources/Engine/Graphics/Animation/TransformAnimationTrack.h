@@ -0,0 +1,178 @@
+/*=============================================================================
+TransformAnimationTrack.h
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+#ifndef _SE_TRANSFORMANIMATIONTRACK_H_
+#define _SE_TRANSFORMANIMATIONTRACK_H_
+
+#include "Core/Core.h"
+#include "Graphics/Common.h"
+#include "Graphics/Animation/AnimationTrack.h"
+#include "Graphics/Animation/TransformKeyFrame.h"
+
+namespace SonataEngine
+{
+
+/**
+	@brief Transform key cursor.
+
+	Indices of the last keys sampled in a transform track. The next sample
+	starts from these keys, so a sequential playback finds its keys without
+	searching. Each object playing the track keeps its own cursor.
+*/
+struct TransformKeyCursor
+{
+	int32 Translation;
+	int32 Rotation;
+	int32 Scale;
+
+	TransformKeyCursor() :
+		Translation(0),
+		Rotation(0),
+		Scale(0)
+	{
+	}
+};
+
+/**
+	@brief Transform animation track.
+
+	A transform track represents the animation of a transformation.
+	The translation, rotation and scale keys of the key frames are copied to
+	contiguous arrays sorted by time, which are sampled without going
+	through the key frames.
+*/
+class SE_GRAPHICS_EXPORT TransformAnimationTrack : public AnimationTrack
+{
+protected:
+	RotationInterpolationMode _rotationInterpolation;
+	BaseArray<KeyVector3> _translationKeys;
+	BaseArray<KeyQuaternion> _rotationKeys;
+	BaseArray<KeyVector3> _scaleKeys;
+	TransformKeyCursor _cursor;
+
+public:
+	/** @name Constructors / Destructor. */
+	//@{
+	/** Constructor. */
+	TransformAnimationTrack();
+
+	/** Destructor. */
+	virtual ~TransformAnimationTrack();
+	//@}
+
+	/** Properties. */
+	//@{
+	/** Gets or sets the interpolation of the rotation keys. */
+	RotationInterpolationMode GetRotationInterpolation() const { return _rotationInterpolation; }
+	void SetRotationInterpolation(RotationInterpolationMode value) { _rotationInterpolation = value; }
+	//@}
+
+	virtual TransformKeyFrame* GetTransformKeyFrame(int index) const;
+
+	/** Fills an array with translational key data used for key frame animation. */
+	void GetTranslationKeys(BaseArray<KeyVector3>& translationKeys);
+
+	/** Fills an array with rotational key data used for key frame animation. */
+	void GetRotationKeys(BaseArray<KeyQuaternion>& rotationKeys);
+
+	/** Fills an array with scale key data used for key frame animation. */
+	void GetScaleKeys(BaseArray<KeyVector3>& scaleKeys);
+
+	/** Copies the keys of the key frames to the key arrays if the key frames changed.
+		@remarks
+			Update calls this method, it must be called before Sample when the
+			track is sampled directly.
+	*/
+	void UpdateKeys();
+
+	/** Samples the transform of the track at a given time.
+		@param time The time in seconds.
+		@param cursor The cursor of the caller, updated with the sampled keys.
+		@param translation Receives the translation.
+		@param rotation Receives the rotation.
+		@param scale Receives the scale.
+		@return The TransformKeyFrameType flags of the sampled components,
+			a component without keys is not modified.
+	*/
+	int32 Sample(real64 time, TransformKeyCursor& cursor, Vector3& translation, Quaternion& rotation, Vector3& scale) const;
+
+protected:
+	virtual KeyFrame* _CreateKeyFrame(const TimeValue& timeValue);
+
+	/** Gets the index of the last key before a given time, starting from the cursor.
+		@remarks
+			The key is searched after the key of the cursor, then with a binary
+			search. The first key is returned if the time is before it.
+	*/
+	template <class T>
+	static int32 FindKey(const BaseArray<T>& keys, real64 time, int32& cursor);
+
+	/** Gets the interpolation amount between a key and the next one. */
+	template <class T>
+	static real GetAmount(const BaseArray<T>& keys, int32 index, real64 time);
+};
+
+template <class T>
+SE_INLINE int32 TransformAnimationTrack::FindKey(const BaseArray<T>& keys, real64 time, int32& cursor)
+{
+	const T* data = keys.Data();
+	int32 count = keys.Count();
+	int32 index = cursor;
+	if (index < count && data[index].Time <= time)
+	{
+		// Same key or the next one
+		if (index + 1 == count || time < data[index + 1].Time)
+		{
+			return index;
+		}
+		if (index + 2 == count || time < data[index + 2].Time)
+		{
+			cursor = index + 1;
+			return index + 1;
+		}
+	}
+
+	int32 low = 0;
+	int32 high = count;
+	while (low < high)
+	{
+		int32 middle = (low + high) / 2;
+		if (data[middle].Time <= time)
+		{
+			low = middle + 1;
+		}
+		else
+		{
+			high = middle;
+		}
+	}
+
+	index = (low > 0 ? low - 1 : 0);
+	cursor = index;
+	return index;
+}
+
+template <class T>
+SE_INLINE real TransformAnimationTrack::GetAmount(const BaseArray<T>& keys, int32 index, real64 time)
+{
+	if (index + 1 == keys.Count())
+	{
+		return (real)0.0;
+	}
+
+	const T& key = keys[index];
+	const T& next = keys[index + 1];
+	if (time <= key.Time)
+	{
+		return (real)0.0;
+	}
+
+	return (real)((time - key.Time) / (next.Time - key.Time));
+}
+
+}
+
+#endif
@@ -96,25 +96,25 @@ public:
 	TransformKeyFrameType GetTransformType() const { return _transformType; }
 
 	/** Sets the type of transform in the key frame. */
-	void SetTransformType(TransformKeyFrameType value) { _transformType = value; }
+	void SetTransformType(TransformKeyFrameType value) { _transformType = value; NotifyChanged(); }
 
 	/** Gets the translation value of the key frame. */
 	const Vector3& GetTranslation() const { return _translation; }
 
-	/** Sets the time value of the key frame. */
-	void SetTranslation(const Vector3& value) { _translation = value; }
+	/** Sets the translation value of the key frame. */
+	void SetTranslation(const Vector3& value) { _translation = value; NotifyChanged(); }
 
 	/** Gets the rotation value of the key frame. */
 	const Quaternion& GetRotation() const { return _rotation; }
 
 	/** Sets the rotation value of the key frame. */
-	void SetRotation(const Quaternion& value) { _rotation = value; }
+	void SetRotation(const Quaternion& value) { _rotation = value; NotifyChanged(); }
 
 	/** Gets the scale value of the key frame. */
 	const Vector3& GetScale() const { return _scale; }
 
 	/** Sets the scale value of the key frame. */
-	void SetScale(const Vector3& value) { _scale = value; }
+	void SetScale(const Vector3& value) { _scale = value; NotifyChanged(); }
 	//@}
 };
 
@@ -31,6 +31,7 @@ Author: Julien Delezenne
 #include "Graphics/Font/Text.h"
 
 // IO
+#include "Graphics/IO/CookedAsset.h"
 #include "Graphics/IO/ImageDataPlugin.h"
 #include "Graphics/IO/ImageReader.h"
 #include "Graphics/IO/ImageWriter.h"
@@ -21,9 +21,23 @@ Author: Julien Delezenne
 #include "Graphics/IO/SceneReader.h"
 #include "Graphics/IO/SceneWriter.h"
 
+#include "Graphics/IO/CookedAsset.h"
+
 namespace SonataEngine
 {
 
+// The resource holds a reference on its data, released when it is unloaded
+static Resource* CreateResource(const SE_ID& type, RefObject* data, uint32 size)
+{
+	Resource* resource = new Resource();
+	resource->SetResourceType(type);
+	resource->SetSize(size);
+	resource->SetData(data);
+	data->AddRef();
+
+	return resource;
+}
+
 GraphicsResourceHandler::GraphicsResourceHandler() :
 	ResourceHandler()
 {
@@ -52,6 +66,12 @@ Resource* GraphicsResourceHandler::Load(const String& name, const SE_ID& type, c
 	if (!CanHandle(type))
 		return NULL;
 
+	// The cooked asset containers do not need a data plugin
+	if (CookedAsset::CanRead(stream))
+	{
+		return LoadCookedAsset(type, path, stream);
+	}
+
 	String ext = Path::GetExtension(path);
 
 	PluginManager::PluginList::Iterator it = PluginManager::Instance()->GetPluginIterator();
@@ -102,12 +122,7 @@ Resource* GraphicsResourceHandler::Load(const String& name, const SE_ID& type, c
 					return NULL;
 				}
 
-				Resource* resource = new Resource();
-				resource->SetResourceType(SE_ID_DATA_IMAGE);
-				resource->SetSize(image->GetDataSize());
-				resource->SetData(image);
-
-				return resource;
+				return CreateResource(SE_ID_DATA_IMAGE, image, image->GetDataSize());
 			}
 
 			else if (dataPlugin->GetDataType() == SE_ID_DATA_SCENE)
@@ -127,12 +142,7 @@ Resource* GraphicsResourceHandler::Load(const String& name, const SE_ID& type, c
 					return NULL;
 				}
 
-				Resource* resource = new Resource();
-				resource->SetResourceType(SE_ID_DATA_SCENE);
-				resource->SetSize(0);
-				resource->SetData(scene);
-
-				return resource;
+				return CreateResource(SE_ID_DATA_SCENE, scene, 0);
 			}
 
 			else if (dataPlugin->GetDataType() == SE_ID_DATA_MODEL)
@@ -152,12 +162,7 @@ Resource* GraphicsResourceHandler::Load(const String& name, const SE_ID& type, c
 					return NULL;
 				}
 
-				Resource* resource = new Resource();
-				resource->SetResourceType(SE_ID_DATA_MODEL);
-				resource->SetSize(0);
-				resource->SetData(model);
-
-				return resource;
+				return CreateResource(SE_ID_DATA_MODEL, model, 0);
 			}
 		}
 	}
@@ -165,6 +170,76 @@ Resource* GraphicsResourceHandler::Load(const String& name, const SE_ID& type, c
 	return NULL;
 }
 
+Resource* GraphicsResourceHandler::LoadBuffer(const String& name, const SE_ID& type, const String& path, SEbyte*& buffer, int32 size)
+{
+	MemoryStream stream(buffer, size, false);
+	if (!CanHandle(type) || !CookedAsset::CanRead(stream))
+	{
+		return Load(name, type, path, stream);
+	}
+
+	// The container keeps the buffer, the images are created over it
+	CookedAssetPtr asset = new CookedAsset();
+	SEbyte* data = buffer;
+	buffer = NULL;
+	if (!asset->Load(data, size))
+	{
+		return NULL;
+	}
+
+	return CreateCookedResource(type, asset);
+}
+
+bool GraphicsResourceHandler::CanLoadAsync(const SE_ID& type, Stream& stream)
+{
+	return (type == SE_ID_DATA_IMAGE && CookedAsset::CanRead(stream));
+}
+
+Resource* GraphicsResourceHandler::LoadCookedAsset(const SE_ID& type, const String& path, Stream& stream)
+{
+	CookedAssetPtr asset = new CookedAsset();
+
+	// A file is mapped, the images are then created over the mapped pages
+	bool loaded = false;
+	if (stream.GetStreamType() == StreamType_File)
+	{
+		loaded = asset->Open(path);
+	}
+	if (!loaded && !asset->Load(stream))
+	{
+		return NULL;
+	}
+
+	return CreateCookedResource(type, asset);
+}
+
+Resource* GraphicsResourceHandler::CreateCookedResource(const SE_ID& type, CookedAsset* asset)
+{
+	if (type == SE_ID_DATA_IMAGE)
+	{
+		Image* image = asset->CreateImage(asset->FindAsset(CookedAssetType_Image));
+		if (image == NULL)
+		{
+			return NULL;
+		}
+
+		return CreateResource(SE_ID_DATA_IMAGE, image, image->GetDataSize());
+	}
+
+	else if (type == SE_ID_DATA_MODEL)
+	{
+		Model* model = asset->CreateModel(asset->FindAsset(CookedAssetType_Model));
+		if (model == NULL)
+		{
+			return NULL;
+		}
+
+		return CreateResource(SE_ID_DATA_MODEL, model, 0);
+	}
+
+	return NULL;
+}
+
 bool GraphicsResourceHandler::Save(Resource* resource, const String& path, Stream& stream)
 {
 	if (resource == NULL)
@@ -266,10 +341,24 @@ bool GraphicsResourceHandler::Unload(Resource* resource)
 	if (resource == NULL)
 		return false;
 
-	if (!CanHandle(resource->GetResourceType()))
+	RefObject* data;
+	if (resource->GetResourceType() == SE_ID_DATA_IMAGE)
+		data = (Image*)resource->GetData();
+	else if (resource->GetResourceType() == SE_ID_DATA_SCENE)
+		data = (Scene*)resource->GetData();
+	else if (resource->GetResourceType() == SE_ID_DATA_MODEL)
+		data = (Model*)resource->GetData();
+	else
 		return false;
 
-	return false;
+	if (data == NULL)
+		return false;
+
+	resource->SetData(NULL);
+	resource->SetSize(0);
+	data->Release();
+
+	return true;
 }
 
 // Creates an instance of this handler
@@ -12,6 +12,8 @@ Author: Julien Delezenne
 namespace SonataEngine
 {
 
+class CookedAsset;
+
 /**
 	@brief Graphics resource handler.
 
@@ -27,9 +29,26 @@ public:
 
 	virtual Resource* Load(const String& name, const SE_ID& type, const String& path, Stream& stream);
 
+	/** The cooked asset containers are loaded in place from the buffer. */
+	virtual Resource* LoadBuffer(const String& name, const SE_ID& type, const String& path, SEbyte*& buffer, int32 size);
+
+	/**
+		Only the images of the cooked asset containers are loaded on a worker
+		thread. The data plugins are not thread safe, and the models create
+		their hardware buffers on the main thread.
+	*/
+	virtual bool CanLoadAsync(const SE_ID& type, Stream& stream);
+
 	virtual bool Save(Resource* resource, const String& path, Stream& stream);
 
 	virtual bool Unload(Resource* resource);
+
+protected:
+	/** Loads the first model or image of a cooked asset container. */
+	Resource* LoadCookedAsset(const SE_ID& type, const String& path, Stream& stream);
+
+	/** Creates the first model or image of a loaded cooked asset container. */
+	Resource* CreateCookedResource(const SE_ID& type, CookedAsset* asset);
 };
 
 }
@@ -0,0 +1,1375 @@
+/*=============================================================================
+CookedAsset.cpp
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+#include "CookedAsset.h"
+#include "Graphics/System/RenderSystem.h"
+
+#include <stddef.h>
+
+namespace SonataEngine
+{
+
+/// Pointer of a descriptor, written as an offset in the file.
+template <class T>
+struct CookedPointer
+{
+	union
+	{
+		uint64 _Offset;
+		T* _Pointer;
+	};
+};
+
+struct CookedSection
+{
+	uint64 _Offset;
+	uint64 _Size;
+};
+
+struct CookedHeader
+{
+	uint32 _Magic;
+	uint16 _Version;
+	uint8 _ByteOrder;
+	uint8 _Reserved;
+	uint32 _AssetCount;
+	uint32 _FixupCount;
+	uint64 _AssetOffset;
+	uint64 _FixupOffset;
+	CookedSection _Sections[CookedSectionType_Count];
+};
+
+struct CookedAssetEntry
+{
+	uint32 _Type;
+	uint32 _Reserved;
+	CookedPointer<void> _Asset;
+};
+
+struct CookedVertexElement
+{
+	uint16 _Stream;
+	uint16 _Offset;
+	uint8 _Format;
+	uint8 _Semantic;
+	uint8 _SemanticIndex;
+	uint8 _Reserved;
+};
+
+struct CookedVertexStream
+{
+	CookedPointer<SEbyte> _Data;
+	uint32 _Size;
+	uint32 _Stride;
+};
+
+struct CookedVertexData
+{
+	CookedPointer<CookedVertexElement> _Elements;
+	CookedPointer<CookedVertexStream> _Streams;
+	uint32 _ElementCount;
+	uint32 _StreamCount;
+	uint32 _VertexCount;
+	uint32 _Reserved;
+};
+
+struct CookedIndexData
+{
+	CookedPointer<SEbyte> _Data;
+	uint32 _Size;
+	uint32 _Format;
+	int32 _IndexCount;
+	uint32 _Reserved;
+};
+
+struct CookedMeshPart
+{
+	CookedPointer<uint16> _Name;
+	CookedPointer<CookedVertexData> _VertexData;
+	CookedPointer<CookedIndexData> _IndexData;
+	uint32 _NameLength;
+	uint32 _PrimitiveType;
+	uint32 _PrimitiveCount;
+	uint32 _StartVertex;
+	uint32 _StartIndex;
+	uint32 _Indexed;
+};
+
+struct CookedMesh
+{
+	CookedPointer<uint16> _Name;
+	CookedPointer<CookedVertexData> _VertexData;
+	CookedPointer<CookedIndexData> _IndexData;
+	CookedPointer<CookedMeshPart> _MeshParts;
+	uint32 _NameLength;
+	uint32 _MeshPartCount;
+	real32 _BoxMin[3];
+	real32 _BoxMax[3];
+	real32 _SphereCenter[3];
+	real32 _SphereRadius;
+};
+
+struct CookedModel
+{
+	CookedPointer<uint16> _Name;
+	CookedPointer<CookedMesh> _Meshes;
+	uint32 _NameLength;
+	uint32 _MeshCount;
+	real32 _Transform[16];
+};
+
+struct CookedImage
+{
+	CookedPointer<SEbyte> _Data;
+	CookedPointer<CookedPointer<CookedImage> > _Mipmaps;
+	uint32 _Format;
+	int32 _Width;
+	int32 _Height;
+	int32 _Depth;
+	int32 _DataSize;
+	int32 _MipLevels;
+};
+
+struct CookedHeightField
+{
+	CookedPointer<real32> _Data;
+	int32 _Width;
+	int32 _Height;
+};
+
+// Offsets and target sections of the pointers of the descriptors
+static const int32 VertexStreamPointers[] = { offsetof(CookedVertexStream, _Data) };
+static const CookedSectionType VertexStreamSections[] = { CookedSectionType_Vertices };
+
+static const int32 VertexDataPointers[] = { offsetof(CookedVertexData, _Elements), offsetof(CookedVertexData, _Streams) };
+static const CookedSectionType VertexDataSections[] = { CookedSectionType_Descriptors, CookedSectionType_Descriptors };
+
+static const int32 IndexDataPointers[] = { offsetof(CookedIndexData, _Data) };
+static const CookedSectionType IndexDataSections[] = { CookedSectionType_Indices };
+
+static const int32 MeshPartPointers[] = { offsetof(CookedMeshPart, _Name), offsetof(CookedMeshPart, _VertexData), offsetof(CookedMeshPart, _IndexData) };
+static const CookedSectionType MeshPartSections[] = { CookedSectionType_Descriptors, CookedSectionType_Descriptors, CookedSectionType_Descriptors };
+
+static const int32 MeshPointers[] = { offsetof(CookedMesh, _Name), offsetof(CookedMesh, _VertexData), offsetof(CookedMesh, _IndexData), offsetof(CookedMesh, _MeshParts) };
+static const CookedSectionType MeshSections[] = { CookedSectionType_Descriptors, CookedSectionType_Descriptors, CookedSectionType_Descriptors, CookedSectionType_Descriptors };
+
+static const int32 ModelPointers[] = { offsetof(CookedModel, _Name), offsetof(CookedModel, _Meshes) };
+static const CookedSectionType ModelSections[] = { CookedSectionType_Descriptors, CookedSectionType_Descriptors };
+
+static const int32 MipmapPointers[] = { 0 };
+static const CookedSectionType MipmapSections[] = { CookedSectionType_Descriptors };
+
+static const int32 ImagePointers[] = { offsetof(CookedImage, _Data), offsetof(CookedImage, _Mipmaps) };
+static const CookedSectionType ImageSections[] = { CookedSectionType_Pixels, CookedSectionType_Descriptors };
+
+static const int32 HeightFieldPointers[] = { offsetof(CookedHeightField, _Data) };
+static const CookedSectionType HeightFieldSections[] = { CookedSectionType_Heights };
+
+/// Alignment of the descriptors, the size of a pointer in the file.
+static const int32 DescriptorAlignment = sizeof(uint64);
+
+/// Offset of the first section, after the header.
+static const int64 HeaderSize = (sizeof(CookedHeader) + 15) & ~15;
+
+static int64 Align(int64 value, int64 alignment)
+{
+	return (value + alignment - 1) & ~(alignment - 1);
+}
+
+/** Sets a pointer to an offset in a section while cooking, 0 being NULL. */
+template <class T>
+static void SetOffset(CookedPointer<T>& ptr, int64 offset)
+{
+	ptr._Offset = (offset < 0 ? 0 : (uint64)offset + 1);
+}
+
+static bool CopyToBuffer(HardwareBuffer* buffer, const SEbyte* data, uint32 size)
+{
+	SEbyte* bufferData;
+	if (!buffer->Map(HardwareBufferMode_WriteOnly, (void**)&bufferData))
+	{
+		return false;
+	}
+
+	Memory::Copy(bufferData, (void*)data, size);
+	buffer->Unmap();
+
+	return true;
+}
+
+
+const uint32 CookedAsset::Magic = 0x4B434553;
+const uint16 CookedAsset::Version = 1;
+const int32 CookedAsset::SectionAlignment = 16;
+
+CookedAsset::CookedAsset() :
+	RefObject(),
+	_buffer(NULL),
+	_data(NULL),
+	_length(0),
+	_descriptors(NULL),
+	_descriptorCopy(NULL),
+	_descriptorOffset(0),
+	_descriptorSize(0),
+	_assets(NULL),
+	_assetCount(0)
+{
+}
+
+CookedAsset::~CookedAsset()
+{
+	Close();
+}
+
+bool CookedAsset::CanRead(Stream& stream)
+{
+	if (!stream.CanRead() || !stream.CanSeek())
+	{
+		return false;
+	}
+
+	int64 position = stream.GetPosition();
+	uint32 magic = 0;
+	int32 count = stream.Read((SEbyte*)&magic, sizeof(magic));
+	stream.SetPosition(position);
+
+	return (count == sizeof(magic) && magic == Magic);
+}
+
+bool CookedAsset::Open(const String& fileName)
+{
+	Close();
+
+	MappedFileStreamPtr mappedFile = new MappedFileStream();
+	// The images and height fields can be modified over the mapped pages
+	if (!mappedFile->Open(fileName, MappedFileAccess_Sequential, true))
+	{
+		return false;
+	}
+
+	_mappedFile = mappedFile;
+	_data = _mappedFile->GetWritableSpan(0, _mappedFile->GetLength());
+	_length = _mappedFile->GetLength();
+
+	if (!Relocate(false))
+	{
+		Close();
+		return false;
+	}
+
+	return true;
+}
+
+bool CookedAsset::Load(Stream& stream)
+{
+	Close();
+
+	int64 length = stream.GetLength() - stream.GetPosition();
+	if (length < HeaderSize || (uint64)length > (uint64)(size_t)-1 - SectionAlignment)
+	{
+		return false;
+	}
+
+	// A single read in a buffer aligned for the sections
+	_buffer = new SEbyte[(size_t)length + SectionAlignment];
+	_data = (SEbyte*)Align((int64)(size_t)_buffer, SectionAlignment);
+	_length = length;
+
+	int64 offset = 0;
+	while (offset < length)
+	{
+		int32 count = (int32)Math::Min(length - offset, (int64)0x40000000);
+		if (stream.Read(_data + offset, count) != count)
+		{
+			Close();
+			return false;
+		}
+		offset += count;
+	}
+
+	if (!Relocate(true))
+	{
+		Close();
+		return false;
+	}
+
+	return true;
+}
+
+bool CookedAsset::Load(SEbyte* buffer, int64 length)
+{
+	Close();
+
+	if (buffer == NULL)
+	{
+		return false;
+	}
+
+	_buffer = buffer;
+	_data = buffer;
+	_length = length;
+	if (length < HeaderSize || (uint64)length > (uint64)(size_t)-1 - SectionAlignment)
+	{
+		Close();
+		return false;
+	}
+
+	if (((size_t)buffer & (SectionAlignment - 1)) != 0)
+	{
+		_buffer = new SEbyte[(size_t)length + SectionAlignment];
+		_data = (SEbyte*)Align((int64)(size_t)_buffer, SectionAlignment);
+		Memory::Copy(_data, buffer, (size_t)length);
+		delete[] buffer;
+	}
+
+	if (!Relocate(true))
+	{
+		Close();
+		return false;
+	}
+
+	return true;
+}
+
+void CookedAsset::Close()
+{
+	SE_DELETE_ARRAY(_descriptorCopy);
+	SE_DELETE_ARRAY(_buffer);
+	_mappedFile = NULL;
+
+	_data = NULL;
+	_length = 0;
+	_descriptors = NULL;
+	_descriptorOffset = 0;
+	_descriptorSize = 0;
+	_assets = NULL;
+	_assetCount = 0;
+}
+
+CookedAssetType CookedAsset::GetAssetType(int32 index) const
+{
+	if (index < 0 || index >= _assetCount)
+	{
+		SEthrow(ArgumentOutOfRangeException("index"));
+	}
+
+	return (CookedAssetType)_assets[index]._Type;
+}
+
+int32 CookedAsset::FindAsset(CookedAssetType type) const
+{
+	for (int32 i = 0; i < _assetCount; i++)
+	{
+		if (_assets[i]._Type == (uint32)type)
+		{
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+bool CookedAsset::Relocate(bool inPlace)
+{
+	if (_data == NULL || _length < HeaderSize)
+	{
+		return false;
+	}
+
+	const CookedHeader* header = (const CookedHeader*)_data;
+	if (header->_Magic != Magic || header->_Version != Version)
+	{
+		Logger::Current()->Log(LogLevel::Error, _T("CookedAsset.Relocate"),
+			_T("Invalid cooked asset container."));
+		return false;
+	}
+
+	if (header->_ByteOrder != SE_ENDIAN)
+	{
+		Logger::Current()->Log(LogLevel::Error, _T("CookedAsset.Relocate"),
+			_T("The cooked asset container was cooked for another byte order."));
+		return false;
+	}
+
+	for (int i = 0; i < CookedSectionType_Count; i++)
+	{
+		const CookedSection& section = header->_Sections[i];
+		if (section._Offset > (uint64)_length || section._Size > (uint64)_length - section._Offset ||
+			(section._Offset % SectionAlignment) != 0)
+		{
+			Logger::Current()->Log(LogLevel::Error, _T("CookedAsset.Relocate"),
+				_T("Invalid section."));
+			return false;
+		}
+	}
+
+	_descriptorOffset = header->_Sections[CookedSectionType_Descriptors]._Offset;
+	_descriptorSize = header->_Sections[CookedSectionType_Descriptors]._Size;
+
+	if (header->_FixupOffset > (uint64)_length ||
+		(uint64)header->_FixupCount > ((uint64)_length - header->_FixupOffset) / sizeof(uint64) ||
+		(header->_FixupOffset % sizeof(uint64)) != 0 ||
+		(header->_FixupCount > 0 && (uint64)_descriptorSize < sizeof(uint64)))
+	{
+		Logger::Current()->Log(LogLevel::Error, _T("CookedAsset.Relocate"),
+			_T("Invalid fixup table."));
+		return false;
+	}
+
+	// The descriptors are copied so the mapped pages stay shared with the system cache
+	if (inPlace)
+	{
+		_descriptors = _data + _descriptorOffset;
+	}
+	else
+	{
+		_descriptorCopy = new SEbyte[(size_t)_descriptorSize];
+		Memory::Copy(_descriptorCopy, _data + _descriptorOffset, (size_t)_descriptorSize);
+		_descriptors = _descriptorCopy;
+	}
+
+	const uint64* fixups = (const uint64*)(_data + header->_FixupOffset);
+	for (uint32 i = 0; i < header->_FixupCount; i++)
+	{
+		uint64 fixup = fixups[i];
+		if (fixup < (uint64)_descriptorOffset || fixup - _descriptorOffset + sizeof(uint64) > (uint64)_descriptorSize ||
+			(fixup % sizeof(uint64)) != 0)
+		{
+			Logger::Current()->Log(LogLevel::Error, _T("CookedAsset.Relocate"),
+				_T("Invalid fixup."));
+			return false;
+		}
+
+		CookedPointer<SEbyte>* ptr = (CookedPointer<SEbyte>*)(_descriptors + (fixup - _descriptorOffset));
+		uint64 offset = ptr->_Offset;
+		if (offset >= (uint64)_length)
+		{
+			Logger::Current()->Log(LogLevel::Error, _T("CookedAsset.Relocate"),
+				_T("Invalid pointer."));
+			return false;
+		}
+
+		if (offset >= (uint64)_descriptorOffset && offset - _descriptorOffset < (uint64)_descriptorSize)
+			ptr->_Pointer = _descriptors + (offset - _descriptorOffset);
+		else
+			ptr->_Pointer = _data + offset;
+	}
+
+	if (header->_AssetOffset < (uint64)_descriptorOffset ||
+		header->_AssetOffset - _descriptorOffset > (uint64)_descriptorSize)
+	{
+		Logger::Current()->Log(LogLevel::Error, _T("CookedAsset.Relocate"),
+			_T("Invalid asset table."));
+		return false;
+	}
+
+	const CookedAssetEntry* assets = (const CookedAssetEntry*)(_descriptors + (header->_AssetOffset - _descriptorOffset));
+	if (!IsInDescriptors(assets, (uint64)header->_AssetCount * sizeof(CookedAssetEntry)))
+	{
+		Logger::Current()->Log(LogLevel::Error, _T("CookedAsset.Relocate"),
+			_T("Invalid asset table."));
+		return false;
+	}
+
+	_assets = assets;
+	_assetCount = header->_AssetCount;
+
+	return true;
+}
+
+bool CookedAsset::IsInData(const void* ptr, uint64 size) const
+{
+	if (ptr == NULL)
+		return (size == 0);
+
+	const SEbyte* p = (const SEbyte*)ptr;
+	return (p >= _data && (uint64)(p - _data) <= (uint64)_length && size <= (uint64)_length - (p - _data));
+}
+
+bool CookedAsset::IsInDescriptors(const void* ptr, uint64 size) const
+{
+	if (ptr == NULL)
+		return (size == 0);
+
+	const SEbyte* p = (const SEbyte*)ptr;
+	return (p >= _descriptors && (uint64)(p - _descriptors) <= (uint64)_descriptorSize &&
+		size <= (uint64)_descriptorSize - (p - _descriptors) &&
+		((p - _descriptors) % DescriptorAlignment) == 0);
+}
+
+static String GetCookedName(const uint16* name, uint32 length)
+{
+	String value;
+	for (uint32 i = 0; i < length; i++)
+	{
+		value += (SEchar)name[i];
+	}
+	return value;
+}
+
+Model* CookedAsset::CreateModel(int32 index, ModelReaderOptions* options)
+{
+	if (index < 0 || index >= _assetCount || _assets[index]._Type != CookedAssetType_Model)
+	{
+		return NULL;
+	}
+
+	const CookedModel* cookedModel = (const CookedModel*)_assets[index]._Asset._Pointer;
+	if (!IsInDescriptors(cookedModel, sizeof(CookedModel)) ||
+		!IsInDescriptors(cookedModel->_Name._Pointer, (uint64)cookedModel->_NameLength * sizeof(uint16)) ||
+		!IsInDescriptors(cookedModel->_Meshes._Pointer, (uint64)cookedModel->_MeshCount * sizeof(CookedMesh)))
+	{
+		Logger::Current()->Log(LogLevel::Error, _T("CookedAsset.CreateModel"),
+			_T("Invalid model."));
+		return NULL;
+	}
+
+	Model* model = new Model();
+	model->SetName(GetCookedName(cookedModel->_Name._Pointer, cookedModel->_NameLength));
+
+	Matrix4 transform;
+	for (int i = 0; i < 16; i++)
+	{
+		transform.M[i / 4][i % 4] = cookedModel->_Transform[i];
+	}
+	model->SetTransform(transform);
+
+	for (uint32 i = 0; i < cookedModel->_MeshCount; i++)
+	{
+		Mesh* mesh = CreateMesh(&cookedModel->_Meshes._Pointer[i], options);
+		if (mesh == NULL)
+		{
+			delete model;
+			return NULL;
+		}
+
+		model->AddMesh(mesh);
+	}
+
+	model->UpdateBounds();
+
+	return model;
+}
+
+Mesh* CookedAsset::CreateMesh(const CookedMesh* cookedMesh, ModelReaderOptions* options)
+{
+	if (!IsInDescriptors(cookedMesh->_Name._Pointer, (uint64)cookedMesh->_NameLength * sizeof(uint16)) ||
+		!IsInDescriptors(cookedMesh->_MeshParts._Pointer, (uint64)cookedMesh->_MeshPartCount * sizeof(CookedMeshPart)))
+	{
+		Logger::Current()->Log(LogLevel::Error, _T("CookedAsset.CreateMesh"),
+			_T("Invalid mesh."));
+		return NULL;
+	}
+
+	Mesh* mesh = new Mesh();
+	mesh->SetName(GetCookedName(cookedMesh->_Name._Pointer, cookedMesh->_NameLength));
+	mesh->SetBoundingBox(BoundingBox(
+		Vector3(cookedMesh->_BoxMin[0], cookedMesh->_BoxMin[1], cookedMesh->_BoxMin[2]),
+		Vector3(cookedMesh->_BoxMax[0], cookedMesh->_BoxMax[1], cookedMesh->_BoxMax[2])));
+	mesh->SetBoundingSphere(BoundingSphere(
+		Vector3(cookedMesh->_SphereCenter[0], cookedMesh->_SphereCenter[1], cookedMesh->_SphereCenter[2]),
+		cookedMesh->_SphereRadius));
+
+	// The vertex and index data shared by the mesh and its parts are created once
+	Hashtable<const CookedVertexData*, VertexData*> vertexDataTable;
+	Hashtable<const CookedIndexData*, IndexData*> indexDataTable;
+
+	if (cookedMesh->_VertexData._Pointer != NULL)
+	{
+		VertexData* vertexData = CreateVertexData(cookedMesh->_VertexData._Pointer, options);
+		if (vertexData == NULL)
+		{
+			delete mesh;
+			return NULL;
+		}
+		mesh->SetVertexData(vertexData);
+		vertexDataTable.Add(cookedMesh->_VertexData._Pointer, vertexData);
+	}
+
+	if (cookedMesh->_IndexData._Pointer != NULL)
+	{
+		IndexData* indexData = CreateIndexData(cookedMesh->_IndexData._Pointer, options);
+		if (indexData == NULL)
+		{
+			delete mesh;
+			return NULL;
+		}
+		mesh->SetIndexData(indexData);
+		indexDataTable.Add(cookedMesh->_IndexData._Pointer, indexData);
+	}
+
+	for (uint32 i = 0; i < cookedMesh->_MeshPartCount; i++)
+	{
+		const CookedMeshPart& cookedMeshPart = cookedMesh->_MeshParts._Pointer[i];
+		if (!IsInDescriptors(cookedMeshPart._Name._Pointer, (uint64)cookedMeshPart._NameLength * sizeof(uint16)))
+		{
+			delete mesh;
+			return NULL;
+		}
+
+		MeshPart* meshPart = new MeshPart();
+		meshPart->SetName(GetCookedName(cookedMeshPart._Name._Pointer, cookedMeshPart._NameLength));
+		meshPart->SetPrimitiveType((PrimitiveType)cookedMeshPart._PrimitiveType);
+		meshPart->SetPrimitiveCount(cookedMeshPart._PrimitiveCount);
+		meshPart->SetStartVertex(cookedMeshPart._StartVertex);
+		meshPart->SetStartIndex(cookedMeshPart._StartIndex);
+		meshPart->SetIndexed(cookedMeshPart._Indexed != 0);
+		mesh->AddMeshPart(meshPart);
+
+		const CookedVertexData* cookedVertexData = cookedMeshPart._VertexData._Pointer;
+		if (cookedVertexData != NULL)
+		{
+			VertexData** found = vertexDataTable.Find(cookedVertexData);
+			VertexData* vertexData = (found != NULL ? *found : CreateVertexData(cookedVertexData, options));
+			if (vertexData == NULL)
+			{
+				delete mesh;
+				return NULL;
+			}
+			if (found == NULL)
+				vertexDataTable.Add(cookedVertexData, vertexData);
+			meshPart->SetVertexData(vertexData);
+		}
+
+		const CookedIndexData* cookedIndexData = cookedMeshPart._IndexData._Pointer;
+		if (cookedIndexData != NULL)
+		{
+			IndexData** found = indexDataTable.Find(cookedIndexData);
+			IndexData* indexData = (found != NULL ? *found : CreateIndexData(cookedIndexData, options));
+			if (indexData == NULL)
+			{
+				delete mesh;
+				return NULL;
+			}
+			if (found == NULL)
+				indexDataTable.Add(cookedIndexData, indexData);
+			meshPart->SetIndexData(indexData);
+		}
+	}
+
+	return mesh;
+}
+
+VertexData* CookedAsset::CreateVertexData(const CookedVertexData* cookedVertexData, ModelReaderOptions* options)
+{
+	if (!IsInDescriptors(cookedVertexData, sizeof(CookedVertexData)) ||
+		!IsInDescriptors(cookedVertexData->_Elements._Pointer, (uint64)cookedVertexData->_ElementCount * sizeof(CookedVertexElement)) ||
+		!IsInDescriptors(cookedVertexData->_Streams._Pointer, (uint64)cookedVertexData->_StreamCount * sizeof(CookedVertexStream)))
+	{
+		Logger::Current()->Log(LogLevel::Error, _T("CookedAsset.CreateVertexData"),
+			_T("Invalid vertex data."));
+		return NULL;
+	}
+
+	// The elements must read the vertices of existing streams
+	for (uint32 i = 0; i < cookedVertexData->_ElementCount; i++)
+	{
+		if (cookedVertexData->_Elements._Pointer[i]._Stream >= cookedVertexData->_StreamCount)
+		{
+			Logger::Current()->Log(LogLevel::Error, _T("CookedAsset.CreateVertexData"),
+				_T("Invalid vertex data."));
+			return NULL;
+		}
+	}
+	for (uint32 i = 0; i < cookedVertexData->_StreamCount; i++)
+	{
+		const CookedVertexStream& stream = cookedVertexData->_Streams._Pointer[i];
+		if ((uint64)cookedVertexData->_VertexCount * stream._Stride > stream._Size)
+		{
+			Logger::Current()->Log(LogLevel::Error, _T("CookedAsset.CreateVertexData"),
+				_T("Invalid vertex data."));
+			return NULL;
+		}
+	}
+
+	RenderSystem* renderer = RenderSystem::Current();
+	if (renderer == NULL)
+	{
+		Logger::Current()->Log(LogLevel::Error, _T("CookedAsset.CreateVertexData"),
+			_T("No active render system."));
+		return NULL;
+	}
+
+	VertexLayout* vertexLayout;
+	if (!renderer->CreateVertexLayout(&vertexLayout))
+	{
+		return NULL;
+	}
+
+	for (uint32 i = 0; i < cookedVertexData->_ElementCount; i++)
+	{
+		const CookedVertexElement& element = cookedVertexData->_Elements._Pointer[i];
+		vertexLayout->AddElement(VertexElement(element._Stream, element._Offset,
+			(VertexFormat)element._Format, (VertexSemantic)element._Semantic, element._SemanticIndex));
+	}
+
+	if (!renderer->UpdateVertexLayout(vertexLayout))
+	{
+		delete vertexLayout;
+		return NULL;
+	}
+
+	VertexData* vertexData = new VertexData();
+	vertexData->VertexLayout = vertexLayout;
+	vertexData->VertexCount = cookedVertexData->_VertexCount;
+
+	HardwareBufferUsage usage = (options != NULL ? options->VertexUsage : HardwareBufferUsage_Static);
+	for (uint32 i = 0; i < cookedVertexData->_StreamCount; i++)
+	{
+		const CookedVertexStream& stream = cookedVertexData->_Streams._Pointer[i];
+		if (!IsInData(stream._Data._Pointer, stream._Size))
+		{
+			delete vertexData;
+			return NULL;
+		}
+
+		HardwareBuffer* vertexBuffer;
+		if (!renderer->CreateVertexBuffer(stream._Size, usage, &vertexBuffer))
+		{
+			delete vertexData;
+			return NULL;
+		}
+
+		vertexData->VertexStreams.Add(VertexStream(vertexBuffer, stream._Stride));
+		if (!CopyToBuffer(vertexBuffer, stream._Data._Pointer, stream._Size))
+		{
+			delete vertexData;
+			return NULL;
+		}
+	}
+
+	return vertexData;
+}
+
+IndexData* CookedAsset::CreateIndexData(const CookedIndexData* cookedIndexData, ModelReaderOptions* options)
+{
+	if (!IsInDescriptors(cookedIndexData, sizeof(CookedIndexData)) ||
+		!IsInData(cookedIndexData->_Data._Pointer, cookedIndexData->_Size) ||
+		cookedIndexData->_Format > IndexBufferFormat_Int32 || cookedIndexData->_IndexCount < 0 ||
+		(uint64)cookedIndexData->_IndexCount * (cookedIndexData->_Format == IndexBufferFormat_Int16 ? 2 : 4) > cookedIndexData->_Size)
+	{
+		Logger::Current()->Log(LogLevel::Error, _T("CookedAsset.CreateIndexData"),
+			_T("Invalid index data."));
+		return NULL;
+	}
+
+	RenderSystem* renderer = RenderSystem::Current();
+	if (renderer == NULL)
+	{
+		Logger::Current()->Log(LogLevel::Error, _T("CookedAsset.CreateIndexData"),
+			_T("No active render system."));
+		return NULL;
+	}
+
+	HardwareBufferUsage usage = (options != NULL ? options->IndexUsage : HardwareBufferUsage_Static);
+	HardwareBuffer* indexBuffer;
+	if (!renderer->CreateIndexBuffer(cookedIndexData->_Size, (IndexBufferFormat)cookedIndexData->_Format,
+		usage, &indexBuffer))
+	{
+		return NULL;
+	}
+
+	IndexData* indexData = new IndexData();
+	indexData->IndexBuffer = indexBuffer;
+	indexData->IndexCount = cookedIndexData->_IndexCount;
+
+	if (!CopyToBuffer(indexBuffer, cookedIndexData->_Data._Pointer, cookedIndexData->_Size))
+	{
+		delete indexData;
+		return NULL;
+	}
+
+	return indexData;
+}
+
+Image* CookedAsset::CreateImage(int32 index)
+{
+	if (index < 0 || index >= _assetCount || _assets[index]._Type != CookedAssetType_Image)
+	{
+		return NULL;
+	}
+
+	return CreateImage((const CookedImage*)_assets[index]._Asset._Pointer);
+}
+
+Image* CookedAsset::CreateImage(const CookedImage* cookedImage)
+{
+	if (!IsInDescriptors(cookedImage, sizeof(CookedImage)) ||
+		cookedImage->_Format > PixelFormat_Depth || cookedImage->_Width < 0 ||
+		cookedImage->_Height < 0 || cookedImage->_Depth < 0 || cookedImage->_MipLevels < 0 ||
+		!IsInData(cookedImage->_Data._Pointer, cookedImage->_DataSize) ||
+		!IsInDescriptors(cookedImage->_Mipmaps._Pointer, (uint64)cookedImage->_MipLevels * sizeof(CookedPointer<CookedImage>)))
+	{
+		Logger::Current()->Log(LogLevel::Error, _T("CookedAsset.CreateImage"),
+			_T("Invalid image."));
+		return NULL;
+	}
+
+	// Each product is checked so it cannot overflow
+	int64 dataSize = (int64)cookedImage->_Width * cookedImage->_Height;
+	if (dataSize <= cookedImage->_DataSize)
+	{
+		dataSize *= cookedImage->_Depth;
+	}
+	if (dataSize <= cookedImage->_DataSize)
+	{
+		dataSize *= PixelFormatDesc((PixelFormat)cookedImage->_Format).GetDepth() / 8;
+	}
+	if (dataSize > cookedImage->_DataSize)
+	{
+		Logger::Current()->Log(LogLevel::Error, _T("CookedAsset.CreateImage"),
+			_T("Invalid image size."));
+		return NULL;
+	}
+
+	Image* image = new Image();
+	image->Create((PixelFormat)cookedImage->_Format, cookedImage->_Width, cookedImage->_Height,
+		cookedImage->_Depth, cookedImage->_Data._Pointer, this);
+
+	image->SetMipLevels(cookedImage->_MipLevels);
+	for (int32 i = 0; i < cookedImage->_MipLevels; i++)
+	{
+		const CookedImage* cookedMipmap = cookedImage->_Mipmaps._Pointer[i]._Pointer;
+		if (cookedMipmap == NULL)
+			continue;
+
+		// The mipmaps are written before their image, which also prevents cycles
+		Image* mipmap = (cookedMipmap < cookedImage ? CreateImage(cookedMipmap) : NULL);
+		if (mipmap == NULL)
+		{
+			delete image;
+			return NULL;
+		}
+		image->SetMipmap(i, mipmap);
+	}
+
+	return image;
+}
+
+HeightField* CookedAsset::CreateHeightField(int32 index)
+{
+	if (index < 0 || index >= _assetCount || _assets[index]._Type != CookedAssetType_HeightField)
+	{
+		return NULL;
+	}
+
+	const CookedHeightField* cookedHeightField = (const CookedHeightField*)_assets[index]._Asset._Pointer;
+	if (!IsInDescriptors(cookedHeightField, sizeof(CookedHeightField)) ||
+		cookedHeightField->_Width < 0 || cookedHeightField->_Height < 0 ||
+		!IsInData(cookedHeightField->_Data._Pointer, (uint64)cookedHeightField->_Width * cookedHeightField->_Height * sizeof(real32)))
+	{
+		Logger::Current()->Log(LogLevel::Error, _T("CookedAsset.CreateHeightField"),
+			_T("Invalid height field."));
+		return NULL;
+	}
+
+	HeightField* heightField = new HeightField();
+	heightField->Create(cookedHeightField->_Width, cookedHeightField->_Height,
+		cookedHeightField->_Data._Pointer, this);
+
+	return heightField;
+}
+
+
+CookedAssetWriter::CookedAssetWriter()
+{
+}
+
+CookedAssetWriter::~CookedAssetWriter()
+{
+}
+
+void CookedAssetWriter::Clear()
+{
+	for (int i = 0; i < CookedSectionType_Count; i++)
+	{
+		_sections[i].Clear();
+	}
+	_fixups.Clear();
+	_assetTypes.Clear();
+	_assetOffsets.Clear();
+	_vertexData.Clear();
+	_indexData.Clear();
+}
+
+int64 CookedAssetWriter::AddData(CookedSectionType section, const void* data, int32 size)
+{
+	BaseArray<SEbyte>& bytes = _sections[section];
+	int32 alignment = (section == CookedSectionType_Descriptors ? DescriptorAlignment : CookedAsset::SectionAlignment);
+
+	int32 offset = (int32)Align(bytes.Count(), alignment);
+	bytes.Resize((int32)Align(offset + size, alignment));
+	Memory::Zero(bytes.Data() + offset, bytes.Count() - offset);
+	if (size > 0)
+	{
+		Memory::Copy(bytes.Data() + offset, (void*)data, size);
+	}
+
+	return offset;
+}
+
+int64 CookedAssetWriter::AddDescriptor(const void* data, int32 size, const int32* pointers, const CookedSectionType* sections, int32 pointerCount)
+{
+	int64 offset = AddData(CookedSectionType_Descriptors, data, size);
+
+	for (int32 i = 0; i < pointerCount; i++)
+	{
+		const CookedPointer<SEbyte>* ptr = (const CookedPointer<SEbyte>*)((const SEbyte*)data + pointers[i]);
+		if (ptr->_Offset != 0)
+		{
+			Fixup fixup;
+			fixup._Offset = offset + pointers[i];
+			fixup._Section = sections[i];
+			_fixups.Add(fixup);
+		}
+	}
+
+	return offset;
+}
+
+int64 CookedAssetWriter::AddName(const String& name)
+{
+	int32 length = name.Length();
+	if (length == 0)
+	{
+		return -1;
+	}
+
+	BaseArray<uint16> chars(length);
+	const SEchar* data = name.Data();
+	for (int32 i = 0; i < length; i++)
+	{
+		chars[i] = (uint16)data[i];
+	}
+
+	return AddData(CookedSectionType_Descriptors, chars.Data(), length * sizeof(uint16));
+}
+
+int64 CookedAssetWriter::AddBuffer(CookedSectionType section, HardwareBuffer* buffer)
+{
+	void* data;
+	if (!buffer->Map(HardwareBufferMode_ReadOnly, &data))
+	{
+		Logger::Current()->Log(LogLevel::Error, _T("CookedAssetWriter.AddBuffer"),
+			_T("Failed to read a hardware buffer."));
+		return -1;
+	}
+
+	int64 offset = AddData(section, data, buffer->GetSize());
+	buffer->Unmap();
+
+	return offset;
+}
+
+int64 CookedAssetWriter::AddVertexData(VertexData* vertexData)
+{
+	if (vertexData == NULL)
+	{
+		return -1;
+	}
+
+	const int64* written = _vertexData.Find(vertexData);
+	if (written != NULL)
+	{
+		return *written;
+	}
+
+	CookedVertexData cookedVertexData;
+	Memory::Zero(&cookedVertexData, sizeof(cookedVertexData));
+	cookedVertexData._VertexCount = vertexData->VertexCount;
+
+	VertexLayout* vertexLayout = vertexData->VertexLayout;
+	if (vertexLayout != NULL && vertexLayout->GetElementCount() > 0)
+	{
+		BaseArray<CookedVertexElement> elements(vertexLayout->GetElementCount());
+		for (int i = 0; i < elements.Count(); i++)
+		{
+			const VertexElement& element = vertexLayout->GetElement(i);
+			elements[i]._Stream = element.GetStream();
+			elements[i]._Offset = element.GetOffset();
+			elements[i]._Format = (uint8)element.GetVertexFormat();
+			elements[i]._Semantic = (uint8)element.GetVertexSemantic();
+			elements[i]._SemanticIndex = element.GetSemanticIndex();
+			elements[i]._Reserved = 0;
+		}
+
+		SetOffset(cookedVertexData._Elements, AddData(CookedSectionType_Descriptors,
+			elements.Data(), elements.Count() * sizeof(CookedVertexElement)));
+		cookedVertexData._ElementCount = elements.Count();
+	}
+
+	int32 streamCount = vertexData->VertexStreams.Count();
+	if (streamCount > 0)
+	{
+		BaseArray<CookedVertexStream> streams(streamCount);
+		for (int i = 0; i < streamCount; i++)
+		{
+			const VertexStream& stream = vertexData->VertexStreams[i];
+			Memory::Zero(&streams[i], sizeof(CookedVertexStream));
+			streams[i]._Stride = stream.Stride;
+			if (stream.VertexBuffer != NULL)
+			{
+				int64 offset = AddBuffer(CookedSectionType_Vertices, stream.VertexBuffer);
+				if (offset < 0)
+				{
+					return -1;
+				}
+				SetOffset(streams[i]._Data, offset);
+				streams[i]._Size = stream.VertexBuffer->GetSize();
+			}
+		}
+
+		for (int i = 0; i < streamCount; i++)
+		{
+			int64 offset = AddDescriptor(&streams[i], sizeof(CookedVertexStream),
+				VertexStreamPointers, VertexStreamSections, 1);
+			if (i == 0)
+			{
+				SetOffset(cookedVertexData._Streams, offset);
+			}
+		}
+		cookedVertexData._StreamCount = streamCount;
+	}
+
+	int64 offset = AddDescriptor(&cookedVertexData, sizeof(CookedVertexData),
+		VertexDataPointers, VertexDataSections, 2);
+	_vertexData.Add(vertexData, offset);
+
+	return offset;
+}
+
+int64 CookedAssetWriter::AddIndexData(IndexData* indexData)
+{
+	if (indexData == NULL || indexData->IndexBuffer == NULL)
+	{
+		return -1;
+	}
+
+	const int64* written = _indexData.Find(indexData);
+	if (written != NULL)
+	{
+		return *written;
+	}
+
+	HardwareBuffer* indexBuffer = indexData->IndexBuffer;
+
+	CookedIndexData cookedIndexData;
+	Memory::Zero(&cookedIndexData, sizeof(cookedIndexData));
+	cookedIndexData._Size = indexBuffer->GetSize();
+	cookedIndexData._IndexCount = indexData->IndexCount;
+
+	// The hardware buffers do not expose their format, it is given by the size of the indices
+	if (indexData->IndexCount > 0 && indexBuffer->GetSize() / indexData->IndexCount >= sizeof(uint32))
+		cookedIndexData._Format = IndexBufferFormat_Int32;
+	else
+		cookedIndexData._Format = IndexBufferFormat_Int16;
+
+	int64 dataOffset = AddBuffer(CookedSectionType_Indices, indexBuffer);
+	if (dataOffset < 0)
+	{
+		return -1;
+	}
+	SetOffset(cookedIndexData._Data, dataOffset);
+
+	int64 offset = AddDescriptor(&cookedIndexData, sizeof(CookedIndexData),
+		IndexDataPointers, IndexDataSections, 1);
+	_indexData.Add(indexData, offset);
+
+	return offset;
+}
+
+bool CookedAssetWriter::AddModel(Model* model)
+{
+	if (model == NULL)
+	{
+		return false;
+	}
+
+	CookedModel cookedModel;
+	Memory::Zero(&cookedModel, sizeof(cookedModel));
+	SetOffset(cookedModel._Name, AddName(model->GetName()));
+	cookedModel._NameLength = model->GetName().Length();
+
+	const Matrix4& transform = model->GetTransform();
+	for (int i = 0; i < 16; i++)
+	{
+		cookedModel._Transform[i] = (real32)transform.M[i / 4][i % 4];
+	}
+
+	// The children are written first, the arrays of descriptors are then contiguous
+	int32 meshCount = model->GetMeshCount();
+	BaseArray<CookedMesh> meshes(meshCount);
+	for (int32 i = 0; i < meshCount; i++)
+	{
+		if (!AddMesh(model->GetMeshByIndex(i), meshes[i]))
+		{
+			return false;
+		}
+	}
+
+	for (int32 i = 0; i < meshCount; i++)
+	{
+		int64 offset = AddDescriptor(&meshes[i], sizeof(CookedMesh), MeshPointers, MeshSections, 4);
+		if (i == 0)
+		{
+			SetOffset(cookedModel._Meshes, offset);
+		}
+	}
+	cookedModel._MeshCount = meshCount;
+
+	_assetTypes.Add(CookedAssetType_Model);
+	_assetOffsets.Add(AddDescriptor(&cookedModel, sizeof(CookedModel), ModelPointers, ModelSections, 2));
+
+	return true;
+}
+
+bool CookedAssetWriter::AddMesh(Mesh* mesh, CookedMesh& cookedMesh)
+{
+	Memory::Zero(&cookedMesh, sizeof(cookedMesh));
+	SetOffset(cookedMesh._Name, AddName(mesh->GetName()));
+	cookedMesh._NameLength = mesh->GetName().Length();
+
+	const BoundingBox& boundingBox = mesh->GetBoundingBox();
+	const BoundingSphere& boundingSphere = mesh->GetBoundingSphere();
+	cookedMesh._BoxMin[0] = boundingBox.Min.X;
+	cookedMesh._BoxMin[1] = boundingBox.Min.Y;
+	cookedMesh._BoxMin[2] = boundingBox.Min.Z;
+	cookedMesh._BoxMax[0] = boundingBox.Max.X;
+	cookedMesh._BoxMax[1] = boundingBox.Max.Y;
+	cookedMesh._BoxMax[2] = boundingBox.Max.Z;
+	cookedMesh._SphereCenter[0] = boundingSphere.Center.X;
+	cookedMesh._SphereCenter[1] = boundingSphere.Center.Y;
+	cookedMesh._SphereCenter[2] = boundingSphere.Center.Z;
+	cookedMesh._SphereRadius = boundingSphere.Radius;
+
+	if (mesh->GetVertexData() != NULL)
+	{
+		int64 offset = AddVertexData(mesh->GetVertexData());
+		if (offset < 0)
+			return false;
+		SetOffset(cookedMesh._VertexData, offset);
+	}
+
+	if (mesh->GetIndexData() != NULL)
+	{
+		int64 offset = AddIndexData(mesh->GetIndexData());
+		if (offset < 0)
+			return false;
+		SetOffset(cookedMesh._IndexData, offset);
+	}
+
+	int32 meshPartCount = mesh->GetMeshPartCount();
+	BaseArray<CookedMeshPart> meshParts(meshPartCount);
+	for (int32 i = 0; i < meshPartCount; i++)
+	{
+		MeshPart* meshPart = mesh->GetMeshPart(i);
+		CookedMeshPart& cookedMeshPart = meshParts[i];
+		Memory::Zero(&cookedMeshPart, sizeof(cookedMeshPart));
+		SetOffset(cookedMeshPart._Name, AddName(meshPart->GetName()));
+		cookedMeshPart._NameLength = meshPart->GetName().Length();
+		cookedMeshPart._PrimitiveType = meshPart->GetPrimitiveType();
+		cookedMeshPart._PrimitiveCount = meshPart->GetPrimitiveCount();
+		cookedMeshPart._StartVertex = meshPart->GetStartVertex();
+		cookedMeshPart._StartIndex = meshPart->GetStartIndex();
+		cookedMeshPart._Indexed = (meshPart->IsIndexed() ? 1 : 0);
+
+		if (meshPart->GetVertexData() != NULL)
+		{
+			int64 offset = AddVertexData(meshPart->GetVertexData());
+			if (offset < 0)
+				return false;
+			SetOffset(cookedMeshPart._VertexData, offset);
+		}
+
+		if (meshPart->GetIndexData() != NULL)
+		{
+			int64 offset = AddIndexData(meshPart->GetIndexData());
+			if (offset < 0)
+				return false;
+			SetOffset(cookedMeshPart._IndexData, offset);
+		}
+	}
+
+	for (int32 i = 0; i < meshPartCount; i++)
+	{
+		int64 offset = AddDescriptor(&meshParts[i], sizeof(CookedMeshPart), MeshPartPointers, MeshPartSections, 3);
+		if (i == 0)
+		{
+			SetOffset(cookedMesh._MeshParts, offset);
+		}
+	}
+	cookedMesh._MeshPartCount = meshPartCount;
+
+	return true;
+}
+
+bool CookedAssetWriter::AddImage(Image* image)
+{
+	int64 offset = AddImageDescriptor(image);
+	if (offset < 0)
+	{
+		return false;
+	}
+
+	_assetTypes.Add(CookedAssetType_Image);
+	_assetOffsets.Add(offset);
+
+	return true;
+}
+
+int64 CookedAssetWriter::AddImageDescriptor(Image* image)
+{
+	if (image == NULL || image->GetData() == NULL)
+	{
+		return -1;
+	}
+
+	CookedImage cookedImage;
+	Memory::Zero(&cookedImage, sizeof(cookedImage));
+	cookedImage._Format = image->GetFormat();
+	cookedImage._Width = image->GetWidth();
+	cookedImage._Height = image->GetHeight();
+	cookedImage._Depth = image->GetDepth();
+	cookedImage._DataSize = image->GetDataSize();
+	cookedImage._MipLevels = image->GetMipLevels();
+	SetOffset(cookedImage._Data, AddData(CookedSectionType_Pixels, image->GetData(), image->GetDataSize()));
+
+	int32 mipLevels = image->GetMipLevels();
+	if (mipLevels > 0)
+	{
+		BaseArray< CookedPointer<CookedImage> > mipmaps(mipLevels);
+		for (int32 i = 0; i < mipLevels; i++)
+		{
+			Image* mipmap = image->GetMipmap(i);
+			SetOffset(mipmaps[i], (mipmap != NULL ? AddImageDescriptor(mipmap) : -1));
+		}
+
+		for (int32 i = 0; i < mipLevels; i++)
+		{
+			int64 offset = AddDescriptor(&mipmaps[i], sizeof(CookedPointer<CookedImage>),
+				MipmapPointers, MipmapSections, 1);
+			if (i == 0)
+			{
+				SetOffset(cookedImage._Mipmaps, offset);
+			}
+		}
+	}
+
+	return AddDescriptor(&cookedImage, sizeof(CookedImage), ImagePointers, ImageSections, 2);
+}
+
+bool CookedAssetWriter::AddHeightField(HeightField* heightField)
+{
+	if (heightField == NULL || heightField->GetData() == NULL)
+	{
+		return false;
+	}
+
+	CookedHeightField cookedHeightField;
+	Memory::Zero(&cookedHeightField, sizeof(cookedHeightField));
+	cookedHeightField._Width = heightField->GetWidth();
+	cookedHeightField._Height = heightField->GetHeight();
+	SetOffset(cookedHeightField._Data, AddData(CookedSectionType_Heights, heightField->GetData(),
+		heightField->GetWidth() * heightField->GetHeight() * sizeof(real32)));
+
+	_assetTypes.Add(CookedAssetType_HeightField);
+	_assetOffsets.Add(AddDescriptor(&cookedHeightField, sizeof(CookedHeightField),
+		HeightFieldPointers, HeightFieldSections, 1));
+
+	return true;
+}
+
+bool CookedAssetWriter::Save(Stream& stream)
+{
+	if (!stream.CanWrite())
+	{
+		return false;
+	}
+
+	// The asset table is appended to a copy of the descriptors
+	BaseArray<SEbyte> descriptors = _sections[CookedSectionType_Descriptors];
+	BaseArray<Fixup> fixups = _fixups;
+
+	int32 assetOffset = (int32)Align(descriptors.Count(), DescriptorAlignment);
+	int32 assetCount = _assetTypes.Count();
+	descriptors.Resize(assetOffset + assetCount * sizeof(CookedAssetEntry));
+	for (int32 i = 0; i < assetCount; i++)
+	{
+		CookedAssetEntry* entry = (CookedAssetEntry*)(descriptors.Data() + assetOffset) + i;
+		entry->_Type = _assetTypes[i];
+		entry->_Reserved = 0;
+		SetOffset(entry->_Asset, _assetOffsets[i]);
+
+		Fixup fixup;
+		fixup._Offset = (SEbyte*)&entry->_Asset - descriptors.Data();
+		fixup._Section = CookedSectionType_Descriptors;
+		fixups.Add(fixup);
+	}
+
+	CookedHeader header;
+	Memory::Zero(&header, sizeof(header));
+	header._Magic = CookedAsset::Magic;
+	header._Version = CookedAsset::Version;
+	header._ByteOrder = SE_ENDIAN;
+	header._AssetCount = assetCount;
+	header._FixupCount = fixups.Count();
+
+	int64 offset = HeaderSize;
+	for (int i = 0; i < CookedSectionType_Count; i++)
+	{
+		int32 size = (i == CookedSectionType_Descriptors ? descriptors.Count() : _sections[i].Count());
+		header._Sections[i]._Offset = offset;
+		header._Sections[i]._Size = size;
+		offset = Align(offset + size, CookedAsset::SectionAlignment);
+	}
+	header._FixupOffset = offset;
+
+	int64 descriptorOffset = header._Sections[CookedSectionType_Descriptors]._Offset;
+	header._AssetOffset = descriptorOffset + assetOffset;
+
+	// Relocates the pointers from their section to the file
+	BaseArray<uint64> fixupTable(fixups.Count());
+	for (int32 i = 0; i < fixups.Count(); i++)
+	{
+		CookedPointer<SEbyte>* ptr = (CookedPointer<SEbyte>*)(descriptors.Data() + fixups[i]._Offset);
+		ptr->_Offset = header._Sections[fixups[i]._Section]._Offset + ptr->_Offset - 1;
+		fixupTable[i] = descriptorOffset + fixups[i]._Offset;
+	}
+
+	SEbyte padding[16];
+	Memory::Zero(padding, sizeof(padding));
+
+	int64 position = 0;
+	stream.Write((const SEbyte*)&header, sizeof(header));
+	position += sizeof(header);
+
+	for (int i = 0; i < CookedSectionType_Count; i++)
+	{
+		stream.Write(padding, (int32)(header._Sections[i]._Offset - position));
+		position = header._Sections[i]._Offset;
+
+		const BaseArray<SEbyte>& bytes = (i == CookedSectionType_Descriptors ? descriptors : _sections[i]);
+		if (!bytes.IsEmpty() && stream.Write(bytes.Data(), bytes.Count()) != bytes.Count())
+		{
+			return false;
+		}
+		position += bytes.Count();
+	}
+
+	stream.Write(padding, (int32)(header._FixupOffset - position));
+	if (!fixupTable.IsEmpty())
+	{
+		int32 size = fixupTable.Count() * sizeof(uint64);
+		if (stream.Write((const SEbyte*)fixupTable.Data(), size) != size)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+}
@@ -0,0 +1,306 @@
+/*=============================================================================
+CookedAsset.h
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+#ifndef _SE_COOKEDASSET_H_
+#define _SE_COOKEDASSET_H_
+
+#include "Core/Core.h"
+#include "Core/IO/MappedFileStream.h"
+#include "Graphics/Common.h"
+#include "Graphics/Image.h"
+#include "Graphics/Model/Model.h"
+#include "Graphics/IO/ModelReader.h"
+#include "Graphics/Terrain/HeightField.h"
+
+namespace SonataEngine
+{
+
+/** Types of the assets of a cooked asset container. */
+enum CookedAssetType
+{
+	CookedAssetType_Model,
+	CookedAssetType_Image,
+	CookedAssetType_HeightField
+};
+
+/** Sections of a cooked asset container. */
+enum CookedSectionType
+{
+	/// Descriptions of the assets, with the pointers to relocate.
+	CookedSectionType_Descriptors,
+	CookedSectionType_Vertices,
+	CookedSectionType_Indices,
+	CookedSectionType_Pixels,
+	CookedSectionType_Heights,
+	CookedSectionType_Count
+};
+
+struct CookedAssetEntry;
+struct CookedVertexData;
+struct CookedIndexData;
+struct CookedMesh;
+struct CookedImage;
+
+/**
+	@brief Cooked asset container.
+
+	A cooked asset container holds models, images and height fields in the
+	layout of their objects in memory, so they are loaded without parsing
+	their elements. The file starts with a header, followed by a section of
+	descriptors, the aligned sections of the vertices, indices, pixels and
+	heights, and a table of the offsets of the pointers in the descriptors.
+	The pointers are written as offsets in the file and are relocated once
+	when the file is loaded.
+
+	A container opened from a file is mapped copy-on-write: only the
+	descriptors are copied to be relocated, and the images and height fields
+	are created over the mapped pages, a page being copied the first time
+	its pixels or heights are modified. A container loaded from a stream is read at once
+	in a single buffer and relocated in place. The vertices and the indices
+	are copied once in the hardware buffers created for them.
+	@remarks
+		The container is written in the byte order of the platform that
+		cooked it and cannot be loaded on a platform of another byte order.
+		The shaders, skins, skeletons and animations of the models are not
+		cooked.
+	@see CookedAssetWriter
+*/
+class SE_GRAPHICS_EXPORT CookedAsset : public RefObject
+{
+public:
+	/** Magic number at the beginning of the containers. */
+	static const uint32 Magic;
+
+	/** Version of the format of the containers. */
+	static const uint16 Version;
+
+	/** Alignment of the data of the sections in the file, in bytes. */
+	static const int32 SectionAlignment;
+
+protected:
+	MappedFileStreamPtr _mappedFile;
+
+	/// Buffer of a container read from a stream.
+	SEbyte* _buffer;
+
+	/// Data of the container, aligned on SectionAlignment.
+	SEbyte* _data;
+	int64 _length;
+
+	/// Relocated descriptors, copied when the data is mapped.
+	SEbyte* _descriptors;
+	SEbyte* _descriptorCopy;
+	int64 _descriptorOffset;
+	int64 _descriptorSize;
+
+	const CookedAssetEntry* _assets;
+	int32 _assetCount;
+
+public:
+	/** @name Constructors / Destructor. */
+	//@{
+	/** Constructor. */
+	CookedAsset();
+
+	/** Destructor. */
+	virtual ~CookedAsset();
+	//@}
+
+	/**
+		Returns whether a stream holds a cooked asset container.
+		The position of the stream is not changed.
+	*/
+	static bool CanRead(Stream& stream);
+
+	/**
+		Opens a cooked asset container by mapping its file in memory.
+		@param fileName The name of the file.
+		@return true if successful; otherwise, false.
+	*/
+	bool Open(const String& fileName);
+
+	/**
+		Loads a cooked asset container from a stream, from its current
+		position to its end.
+		@param stream The source stream.
+		@return true if successful; otherwise, false.
+	*/
+	bool Load(Stream& stream);
+
+	/**
+		Loads a cooked asset container from a buffer allocated with new[].
+		The container takes the ownership of the buffer, even if it fails.
+		The pointers are relocated in place when the buffer is aligned on
+		SectionAlignment, or else the data is moved to an aligned buffer.
+		@param buffer The content of the container.
+		@param length The length of the container, in bytes.
+		@return true if successful; otherwise, false.
+	*/
+	bool Load(SEbyte* buffer, int64 length);
+
+	/** Releases the data of the container. */
+	void Close();
+
+	/** Returns whether the container is loaded. */
+	bool IsLoaded() const { return (_data != NULL); }
+
+	/** Returns whether the data of the container is mapped in memory. */
+	bool IsMapped() const { return (_mappedFile.Get() != NULL); }
+
+	/** Returns the number of assets of the container. */
+	int32 GetAssetCount() const { return _assetCount; }
+
+	/** Returns the type of an asset. */
+	CookedAssetType GetAssetType(int32 index) const;
+
+	/** Returns the index of the first asset of a type, or -1 if there is none. */
+	int32 FindAsset(CookedAssetType type) const;
+
+	/**
+		Creates a model from an asset.
+		@param index The index of the asset.
+		@param options The usages of the hardware buffers, static if NULL.
+		@return The model, or NULL if the asset is not a valid model.
+	*/
+	Model* CreateModel(int32 index, ModelReaderOptions* options = NULL);
+
+	/**
+		Creates an image from an asset. The image holds a reference to the
+		container and its pixels are not copied.
+		@param index The index of the asset.
+		@return The image, or NULL if the asset is not a valid image.
+	*/
+	Image* CreateImage(int32 index);
+
+	/**
+		Creates a height field from an asset. The height field holds a
+		reference to the container and its heights are not copied.
+		@param index The index of the asset.
+		@return The height field, or NULL if the asset is not a valid height field.
+	*/
+	HeightField* CreateHeightField(int32 index);
+
+protected:
+	/** Validates the header and relocates the pointers of the descriptors. */
+	bool Relocate(bool inPlace);
+
+	/** Returns whether a range of bytes is in the data of the container. */
+	bool IsInData(const void* ptr, uint64 size) const;
+
+	/** Returns whether a range of bytes is in the descriptors. */
+	bool IsInDescriptors(const void* ptr, uint64 size) const;
+
+	VertexData* CreateVertexData(const CookedVertexData* cookedVertexData, ModelReaderOptions* options);
+	IndexData* CreateIndexData(const CookedIndexData* cookedIndexData, ModelReaderOptions* options);
+	Mesh* CreateMesh(const CookedMesh* cookedMesh, ModelReaderOptions* options);
+	Image* CreateImage(const CookedImage* cookedImage);
+
+private:
+	CookedAsset(const CookedAsset&);
+	CookedAsset& operator=(const CookedAsset&);
+};
+
+typedef SmartPtr<CookedAsset> CookedAssetPtr;
+
+
+/**
+	@brief Cooked asset container writer.
+
+	Cooks models, images and height fields into a cooked asset container.
+	The vertices and the indices are read back from the hardware buffers of
+	the models, which must be readable.
+	@see CookedAsset
+*/
+class SE_GRAPHICS_EXPORT CookedAssetWriter
+{
+protected:
+	/// A pointer written in a descriptor, relocated when saving.
+	struct Fixup
+	{
+		/// Offset of the pointer in the descriptors.
+		int64 _Offset;
+
+		/// Section of the target of the pointer.
+		CookedSectionType _Section;
+	};
+
+	BaseArray<SEbyte> _sections[CookedSectionType_Count];
+	BaseArray<Fixup> _fixups;
+
+	/// Type and descriptor offset of each asset.
+	BaseArray<uint32> _assetTypes;
+	BaseArray<int64> _assetOffsets;
+
+	/// Descriptors of the vertex and index data already written, shared by the meshes.
+	Hashtable<VertexData*, int64> _vertexData;
+	Hashtable<IndexData*, int64> _indexData;
+
+public:
+	/** @name Constructors / Destructor. */
+	//@{
+	/** Constructor. */
+	CookedAssetWriter();
+
+	/** Destructor. */
+	virtual ~CookedAssetWriter();
+	//@}
+
+	/** Returns the number of assets added. */
+	int32 GetAssetCount() const { return _assetTypes.Count(); }
+
+	/** Adds a model to the container. */
+	bool AddModel(Model* model);
+
+	/** Adds an image and its mipmaps to the container. */
+	bool AddImage(Image* image);
+
+	/** Adds a height field to the container. */
+	bool AddHeightField(HeightField* heightField);
+
+	/**
+		Writes the container to a stream.
+		@param stream The destination stream.
+		@return true if successful; otherwise, false.
+	*/
+	bool Save(Stream& stream);
+
+	/** Removes all the assets. */
+	void Clear();
+
+protected:
+	/**
+		Appends data to a section.
+		@return The offset of the data in the section.
+	*/
+	int64 AddData(CookedSectionType section, const void* data, int32 size);
+
+	/**
+		Appends a descriptor holding pointers.
+		@param pointers The offsets of the pointers in the descriptor.
+		@param sections The sections of the targets of the pointers.
+		@return The offset of the descriptor in the descriptors.
+	*/
+	int64 AddDescriptor(const void* data, int32 size, const int32* pointers, const CookedSectionType* sections, int32 pointerCount);
+
+	/** Appends a name as 16-bit characters. */
+	int64 AddName(const String& name);
+
+	/** Appends the data of a hardware buffer. */
+	int64 AddBuffer(CookedSectionType section, HardwareBuffer* buffer);
+
+	int64 AddVertexData(VertexData* vertexData);
+	int64 AddIndexData(IndexData* indexData);
+	bool AddMesh(Mesh* mesh, CookedMesh& cookedMesh);
+	int64 AddImageDescriptor(Image* image);
+
+private:
+	CookedAssetWriter(const CookedAssetWriter&);
+	CookedAssetWriter& operator=(const CookedAssetWriter&);
+};
+
+}
+
+#endif
@@ -101,6 +101,22 @@ void Image::Create(PixelFormat format, int32 width, int32 height, int32 depth, i
 	_data = new SEbyte[_dataSize];
 }
 
+void Image::Create(PixelFormat format, int32 width, int32 height, int32 depth, SEbyte* data, RefObject* dataOwner)
+{
+	Destroy();
+
+	_format = format;
+	_width = width;
+	_height = height;
+	_depth = depth;
+	_bitsPerPixel = PixelFormatDesc(_format).GetDepth();
+	_bytesPerLine = (_bitsPerPixel / 8) * _width;
+
+	_dataSize = _width * _height * _depth * (_bitsPerPixel / 8);
+	_data = data;
+	_dataOwner = dataOwner;
+}
+
 void Image::Destroy()
 {
 	for (int i = 0; i < _mipLevels; i++)
@@ -114,7 +130,15 @@ void Image::Destroy()
 	_bytesPerLine = 0;
 	_mipLevels = 0;
 	_dataSize = 0;
-	SE_DELETE_ARRAY(_data);
+	if (_dataOwner.Get() != NULL)
+	{
+		_data = NULL;
+		_dataOwner = NULL;
+	}
+	else
+	{
+		SE_DELETE_ARRAY(_data);
+	}
 }
 
 }
@@ -32,6 +32,9 @@ protected:
 	int32 _dataSize;
 	SEbyte* _data;
 
+	/// Owner of the data of an image created over existing data.
+	SmartPtr<RefObject> _dataOwner;
+
 public:
 	/** @name Constructors / Destructor. */
 	//@{
@@ -93,6 +96,20 @@ public:
 
 	void Create(PixelFormat format, int32 width, int32 height, int32 depth = 1, int32 mipLevels = 0);
 
+	/**
+		Creates an image over existing data, without copying it.
+		@param format The pixel format of the data.
+		@param width The width of the image, in pixels.
+		@param height The height of the image, in pixels.
+		@param depth The depth of the image, in pixels.
+		@param data The pixels, which are not deleted by the image.
+		@param dataOwner The object holding the data, kept alive by the image.
+		@remarks
+			The data of an image created over the pages of a memory-mapped
+			file can only be written when the file is mapped copy-on-write.
+	*/
+	void Create(PixelFormat format, int32 width, int32 height, int32 depth, SEbyte* data, RefObject* dataOwner);
+
 	void Destroy();
 };
 
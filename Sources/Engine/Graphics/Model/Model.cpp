@@ -161,7 +161,7 @@ void Model::Update(const TimeValue& timeValue)
 	}
 
 	MeshList::Iterator it = _meshes.GetIterator();
-	if (it.Next())
+	while (it.Next())
 	{
 		it.Current()->Update(timeValue);
 	}
@@ -12,7 +12,9 @@ namespace SonataEngine
 Skeleton::Skeleton() :
 	NamedObject(),
 	_rootBone(NULL),
-	_animationSet(NULL)
+	_animationSet(NULL),
+	_skinMatricesValid(false),
+	_skinDualQuaternionsValid(false)
 {
 }
 
@@ -55,6 +57,7 @@ Bone* Skeleton::AddBone()
 {
 	Bone* bone = new Bone(this, _bones.Count());
 	_bones.Add(bone);
+	InvalidateSkinPalette();
 	return bone;
 }
 
@@ -67,6 +70,7 @@ void Skeleton::RemoveAllBones()
 	}
 
 	_bones.Clear();
+	InvalidateSkinPalette();
 }
 
 Bone* Skeleton::GetBoneByIndex(int index) const
@@ -147,8 +151,91 @@ Socket* Skeleton::GetSocketByName(const String& name) const
 	return NULL;
 }
 
+const SkinMatrix* Skeleton::GetSkinMatrices()
+{
+	if (_skinMatricesValid)
+	{
+		return _skinMatrices.Data();
+	}
+
+	_skinMatrices.Resize(_bones.Count());
+	for (int i = 0; i < _bones.Count(); ++i)
+	{
+		const Matrix4& transform = _bones[i]->GetSkinTransform();
+		SkinMatrix& matrix = _skinMatrices[i];
+		for (int row = 0; row < 3; ++row)
+		{
+			for (int column = 0; column < 4; ++column)
+			{
+				matrix.Rows[row][column] = (real32)transform.Data[row * 4 + column];
+			}
+		}
+	}
+
+	_skinMatricesValid = true;
+	return _skinMatrices.Data();
+}
+
+const SkinDualQuaternion* Skeleton::GetSkinDualQuaternions()
+{
+	if (_skinDualQuaternionsValid && _skinMatricesValid)
+	{
+		return _skinDualQuaternions.Data();
+	}
+
+	const SkinMatrix* matrices = GetSkinMatrices();
+	_skinDualQuaternions.Resize(_bones.Count());
+	for (int i = 0; i < _bones.Count(); ++i)
+	{
+		const SkinMatrix& matrix = matrices[i];
+
+		// Remove the scale from the columns of the rotation
+		real32 scale[3];
+		for (int column = 0; column < 3; ++column)
+		{
+			real32 length = Math::Sqrt(
+				matrix.Rows[0][column] * matrix.Rows[0][column] +
+				matrix.Rows[1][column] * matrix.Rows[1][column] +
+				matrix.Rows[2][column] * matrix.Rows[2][column]);
+			scale[column] = (length > Math::Epsilon ? 1.0f / length : 0.0f);
+		}
+
+		Matrix3 rotation(
+			matrix.Rows[0][0] * scale[0], matrix.Rows[0][1] * scale[1], matrix.Rows[0][2] * scale[2],
+			matrix.Rows[1][0] * scale[0], matrix.Rows[1][1] * scale[1], matrix.Rows[1][2] * scale[2],
+			matrix.Rows[2][0] * scale[0], matrix.Rows[2][1] * scale[1], matrix.Rows[2][2] * scale[2]);
+		Quaternion q = Quaternion::Normalize(Quaternion::CreateFromRotationMatrix(rotation));
+		real32 tx = matrix.Rows[0][3];
+		real32 ty = matrix.Rows[1][3];
+		real32 tz = matrix.Rows[2][3];
+
+		// Dual part: 0.5 * (t, 0) * q
+		SkinDualQuaternion& dq = _skinDualQuaternions[i];
+		dq.Real[0] = (real32)q.X;
+		dq.Real[1] = (real32)q.Y;
+		dq.Real[2] = (real32)q.Z;
+		dq.Real[3] = (real32)q.W;
+		dq.Dual[0] = 0.5f * ( tx * dq.Real[3] + ty * dq.Real[2] - tz * dq.Real[1]);
+		dq.Dual[1] = 0.5f * (-tx * dq.Real[2] + ty * dq.Real[3] + tz * dq.Real[0]);
+		dq.Dual[2] = 0.5f * ( tx * dq.Real[1] - ty * dq.Real[0] + tz * dq.Real[3]);
+		dq.Dual[3] = -0.5f * (tx * dq.Real[0] + ty * dq.Real[1] + tz * dq.Real[2]);
+	}
+
+	_skinDualQuaternionsValid = true;
+	return _skinDualQuaternions.Data();
+}
+
+void Skeleton::InvalidateSkinPalette()
+{
+	_skinMatricesValid = false;
+	_skinDualQuaternionsValid = false;
+}
+
 void Skeleton::Update(const TimeValue& timeValue)
 {
+	// The bones move, the palette is computed again for the skins
+	InvalidateSkinPalette();
+
 	if (_animationSet != NULL)
 	{
 		_animationSet->Update(timeValue);
@@ -16,6 +16,28 @@ Author: Julien Delezenne
 namespace SonataEngine
 {
 
+/**
+	Skinning transform of a bone, as the three first rows of its skin
+	transform. The last row of an affine transform is always (0, 0, 0, 1).
+*/
+struct SkinMatrix
+{
+	real32 Rows[3][4];
+};
+
+/**
+	Skinning transform of a bone, as a unit dual quaternion.
+	Only the rotation and the translation of the skin transform are kept.
+*/
+struct SkinDualQuaternion
+{
+	/// Rotation, as X, Y, Z, W.
+	real32 Real[4];
+
+	/// Translation, as X, Y, Z, W.
+	real32 Dual[4];
+};
+
 /** Skeleton. */
 class SE_GRAPHICS_EXPORT Skeleton : public NamedObject
 {
@@ -28,6 +50,10 @@ protected:
 	BoneList _bones;
 	SocketList _sockets;
 	AnimationSet* _animationSet;
+	BaseArray<SkinMatrix> _skinMatrices;
+	BaseArray<SkinDualQuaternion> _skinDualQuaternions;
+	bool _skinMatricesValid;
+	bool _skinDualQuaternionsValid;
 
 public:
 	/** @name Constructors / Destructor. */
@@ -69,6 +95,22 @@ public:
 	Socket* GetSocketByName(const String& name) const;
 	//@}
 
+	/** Skin palette. */
+	//@{
+	/**
+		Gets the skin transforms of the bones, indexed like the bones.
+		The palette is computed by the first call following Update and
+		shared by all the skins of the skeleton.
+	*/
+	const SkinMatrix* GetSkinMatrices();
+
+	/** Gets the skin transforms of the bones as dual quaternions. */
+	const SkinDualQuaternion* GetSkinDualQuaternions();
+
+	/** Invalidates the palette, it is computed again on the next request. */
+	void InvalidateSkinPalette();
+	//@}
+
 	/** Gets the animation set. */
 	AnimationSet* GetAnimationSet() const { return _animationSet; }
 
@@ -5,64 +5,323 @@ Author: Julien Delezenne
 =============================================================================*/
 
 #include "Skin.h"
-#include "Graphics/System/RenderSystem.h"
 #include "Graphics/Model/Skeleton.h"
 
+#if SE_USE_SIMD && (defined(_M_IX86) || defined(_M_X64) || defined(__SSE__))
+#	define SE_SKIN_SSE 1
+#	include <xmmintrin.h>
+#else
+#	define SE_SKIN_SSE 0
+#endif
+
 namespace SonataEngine
 {
 
+/// Number of vertices deformed at once, the streams are padded to a multiple of this value.
+static const int32 BatchSize = 4;
+
+/// Alignment of the streams, in bytes.
+static const int32 StreamAlignment = 16;
+
+const int32 Skin::ParallelVertexCount = 16384;
+const int32 Skin::ParallelChunkSize = 4096;
+
+#if SE_SKIN_SSE
+/// Blends the bone matrices of 4 vertices, the result is transposed to rows and columns of 4 vertices.
+static SE_INLINE void _BlendMatrices4(const SkinMatrix* palette, const real32* weights, const uint8* indices, __m128 m[3][4])
+{
+	__m128 rows[BatchSize][3];
+	for (int v = 0; v < BatchSize; ++v, weights += 4, indices += 4)
+	{
+		// The influences without weight use the first bone, no branch is needed
+		__m128 row0 = _mm_setzero_ps();
+		__m128 row1 = _mm_setzero_ps();
+		__m128 row2 = _mm_setzero_ps();
+		for (int b = 0; b < 4; ++b)
+		{
+			const SkinMatrix& matrix = palette[indices[b]];
+			__m128 weight = _mm_set1_ps(weights[b]);
+			row0 = _mm_add_ps(row0, _mm_mul_ps(weight, _mm_loadu_ps(matrix.Rows[0])));
+			row1 = _mm_add_ps(row1, _mm_mul_ps(weight, _mm_loadu_ps(matrix.Rows[1])));
+			row2 = _mm_add_ps(row2, _mm_mul_ps(weight, _mm_loadu_ps(matrix.Rows[2])));
+		}
+		rows[v][0] = row0;
+		rows[v][1] = row1;
+		rows[v][2] = row2;
+	}
+
+	for (int r = 0; r < 3; ++r)
+	{
+		m[r][0] = rows[0][r];
+		m[r][1] = rows[1][r];
+		m[r][2] = rows[2][r];
+		m[r][3] = rows[3][r];
+		_MM_TRANSPOSE4_PS(m[r][0], m[r][1], m[r][2], m[r][3]);
+	}
+}
+
+/// Blends the bone dual quaternions of 4 vertices and converts them to rows and columns of 4 vertices.
+static SE_INLINE void _BlendDualQuaternions4(const SkinDualQuaternion* palette, const real32* weights, const uint8* indices, __m128 m[3][4])
+{
+	// One weight of each vertex per register
+	__m128 w[4];
+	w[0] = _mm_load_ps(weights);
+	w[1] = _mm_load_ps(weights + 4);
+	w[2] = _mm_load_ps(weights + 8);
+	w[3] = _mm_load_ps(weights + 12);
+	_MM_TRANSPOSE4_PS(w[0], w[1], w[2], w[3]);
+
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 signMask = _mm_set1_ps(-0.0f);
+	__m128 firstX = zero, firstY = zero, firstZ = zero, firstW = zero;
+	__m128 x = zero, y = zero, z = zero, qw = zero;
+	__m128 dx = zero, dy = zero, dz = zero, dw = zero;
+	for (int b = 0; b < 4; ++b)
+	{
+		const SkinDualQuaternion& dq0 = palette[indices[b]];
+		const SkinDualQuaternion& dq1 = palette[indices[4 + b]];
+		const SkinDualQuaternion& dq2 = palette[indices[8 + b]];
+		const SkinDualQuaternion& dq3 = palette[indices[12 + b]];
+
+		__m128 rx = _mm_loadu_ps(dq0.Real), ry = _mm_loadu_ps(dq1.Real), rz = _mm_loadu_ps(dq2.Real), rw = _mm_loadu_ps(dq3.Real);
+		__m128 ex = _mm_loadu_ps(dq0.Dual), ey = _mm_loadu_ps(dq1.Dual), ez = _mm_loadu_ps(dq2.Dual), ew = _mm_loadu_ps(dq3.Dual);
+		_MM_TRANSPOSE4_PS(rx, ry, rz, rw);
+		_MM_TRANSPOSE4_PS(ex, ey, ez, ew);
+
+		__m128 weight = w[b];
+		if (b == 0)
+		{
+			firstX = rx; firstY = ry; firstZ = rz; firstW = rw;
+		}
+		else
+		{
+			// Blend in the hemisphere of the first influence
+			__m128 dot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(rx, firstX), _mm_mul_ps(ry, firstY)),
+				_mm_add_ps(_mm_mul_ps(rz, firstZ), _mm_mul_ps(rw, firstW)));
+			weight = _mm_xor_ps(weight, _mm_and_ps(_mm_cmplt_ps(dot, zero), signMask));
+		}
+
+		x = _mm_add_ps(x, _mm_mul_ps(weight, rx));
+		y = _mm_add_ps(y, _mm_mul_ps(weight, ry));
+		z = _mm_add_ps(z, _mm_mul_ps(weight, rz));
+		qw = _mm_add_ps(qw, _mm_mul_ps(weight, rw));
+		dx = _mm_add_ps(dx, _mm_mul_ps(weight, ex));
+		dy = _mm_add_ps(dy, _mm_mul_ps(weight, ey));
+		dz = _mm_add_ps(dz, _mm_mul_ps(weight, ez));
+		dw = _mm_add_ps(dw, _mm_mul_ps(weight, ew));
+	}
+
+	__m128 length = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_add_ps(_mm_mul_ps(z, z), _mm_mul_ps(qw, qw)));
+	__m128 invLength = _mm_and_ps(_mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(length)),
+		_mm_cmpgt_ps(length, _mm_set1_ps((real32)Math::Epsilon)));
+	x = _mm_mul_ps(x, invLength); y = _mm_mul_ps(y, invLength); z = _mm_mul_ps(z, invLength); qw = _mm_mul_ps(qw, invLength);
+	dx = _mm_mul_ps(dx, invLength); dy = _mm_mul_ps(dy, invLength); dz = _mm_mul_ps(dz, invLength); dw = _mm_mul_ps(dw, invLength);
+
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 two = _mm_set1_ps(2.0f);
+	__m128 xx = _mm_mul_ps(x, x), yy = _mm_mul_ps(y, y), zz = _mm_mul_ps(z, z);
+	__m128 xy = _mm_mul_ps(x, y), xz = _mm_mul_ps(x, z), yz = _mm_mul_ps(y, z);
+	__m128 wx = _mm_mul_ps(qw, x), wy = _mm_mul_ps(qw, y), wz = _mm_mul_ps(qw, z);
+
+	m[0][0] = _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz)));
+	m[0][1] = _mm_mul_ps(two, _mm_sub_ps(xy, wz));
+	m[0][2] = _mm_mul_ps(two, _mm_add_ps(xz, wy));
+	m[1][0] = _mm_mul_ps(two, _mm_add_ps(xy, wz));
+	m[1][1] = _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz)));
+	m[1][2] = _mm_mul_ps(two, _mm_sub_ps(yz, wx));
+	m[2][0] = _mm_mul_ps(two, _mm_sub_ps(xz, wy));
+	m[2][1] = _mm_mul_ps(two, _mm_add_ps(yz, wx));
+	m[2][2] = _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy)));
+
+	// Translation: 2 * dual * conjugate(real)
+	m[0][3] = _mm_mul_ps(two, _mm_add_ps(_mm_sub_ps(_mm_mul_ps(qw, dx), _mm_mul_ps(dw, x)), _mm_sub_ps(_mm_mul_ps(y, dz), _mm_mul_ps(z, dy))));
+	m[1][3] = _mm_mul_ps(two, _mm_add_ps(_mm_sub_ps(_mm_mul_ps(qw, dy), _mm_mul_ps(dw, y)), _mm_sub_ps(_mm_mul_ps(z, dx), _mm_mul_ps(x, dz))));
+	m[2][3] = _mm_mul_ps(two, _mm_add_ps(_mm_sub_ps(_mm_mul_ps(qw, dz), _mm_mul_ps(dw, z)), _mm_sub_ps(_mm_mul_ps(x, dy), _mm_mul_ps(y, dx))));
+}
+#else
+/// Blends the dual quaternions of the influences and converts the result to a 3x4 matrix.
+static void _BlendDualQuaternions(const SkinDualQuaternion* palette, const real32* weights, const uint8* indices, real32 rows[3][4])
+{
+	real32 real[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	real32 dual[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	const SkinDualQuaternion& first = palette[indices[0]];
+	for (int b = 0; b < 4; ++b)
+	{
+		if (weights[b] > Math::Epsilon)
+		{
+			const SkinDualQuaternion& dq = palette[indices[b]];
+
+			// Blend in the hemisphere of the first influence
+			real32 weight = weights[b];
+			if (dq.Real[0] * first.Real[0] + dq.Real[1] * first.Real[1] +
+				dq.Real[2] * first.Real[2] + dq.Real[3] * first.Real[3] < 0.0f)
+			{
+				weight = -weight;
+			}
+
+			for (int i = 0; i < 4; ++i)
+			{
+				real[i] += weight * dq.Real[i];
+				dual[i] += weight * dq.Dual[i];
+			}
+		}
+	}
+
+	real32 length = real[0] * real[0] + real[1] * real[1] + real[2] * real[2] + real[3] * real[3];
+	real32 invLength = (length > Math::Epsilon ? 1.0f / Math::Sqrt(length) : 0.0f);
+	real32 x = real[0] * invLength, y = real[1] * invLength, z = real[2] * invLength, w = real[3] * invLength;
+	real32 dx = dual[0] * invLength, dy = dual[1] * invLength, dz = dual[2] * invLength, dw = dual[3] * invLength;
+
+	rows[0][0] = 1.0f - 2.0f * (y * y + z * z);
+	rows[0][1] = 2.0f * (x * y - w * z);
+	rows[0][2] = 2.0f * (x * z + w * y);
+	rows[1][0] = 2.0f * (x * y + w * z);
+	rows[1][1] = 1.0f - 2.0f * (x * x + z * z);
+	rows[1][2] = 2.0f * (y * z - w * x);
+	rows[2][0] = 2.0f * (x * z - w * y);
+	rows[2][1] = 2.0f * (y * z + w * x);
+	rows[2][2] = 1.0f - 2.0f * (x * x + y * y);
+
+	// Translation: 2 * dual * conjugate(real)
+	rows[0][3] = 2.0f * (w * dx - dw * x + y * dz - z * dy);
+	rows[1][3] = 2.0f * (w * dy - dw * y + z * dx - x * dz);
+	rows[2][3] = 2.0f * (w * dz - dw * z + x * dy - y * dx);
+}
+
+#endif
+
 Skin::Skin() :
 	RefObject(),
-	_sourceVertexData(NULL),
 	_destVertexData(NULL),
-	_boneCount(0),
-	_boneMatrixPalette(NULL),
-	SkinningMethod(SkinningMethod_Software)
+	_streamIndex(-1),
+	_positionOffset(0),
+	_normalOffset(0),
+	_stride(0),
+	_vertexCount(0),
+	_buffer(NULL),
+	_blendWeights(NULL),
+	_blendIndices(NULL),
+	_destVertices(NULL),
+	SkinningMethod(SkinningMethod_Software),
+	BlendMode(SkinBlendMode_Linear)
 {
+	for (int i = 0; i < Stream_Count; i++)
+	{
+		_streams[i] = NULL;
+	}
 }
 
 Skin::~Skin()
 {
+	if (_buffer != NULL)
+	{
+		Memory::Free(_buffer);
+	}
 }
 
 void Skin::Initialize(VertexData* vertexData)
 {
-	RenderSystem* renderSystem = RenderSystem::Current();
-
 	if (SkinningMethod != SkinningMethod_Software)
 	{
 		return;
 	}
 
 	_destVertexData = vertexData;
+	_streamIndex = -1;
+	_vertexCount = 0;
+
+	VertexLayout* vertexLayout = vertexData->VertexLayout;
+	const VertexElement* positionElement = vertexLayout->GetElementBySemantic(VertexSemantic_Position);
+	const VertexElement* blendWeightsElement = vertexLayout->GetElementBySemantic(VertexSemantic_BlendWeight);
+	const VertexElement* blendIndicesElement = vertexLayout->GetElementBySemantic(VertexSemantic_BlendIndices);
+	const VertexElement* normalElement = vertexLayout->GetElementBySemantic(VertexSemantic_Normal);
+
+	if (positionElement == NULL || blendWeightsElement == NULL ||
+		blendIndicesElement == NULL || normalElement == NULL)
+	{
+		return;
+	}
+
+	// The skinned elements are read from the stream of the position
+	int streamIndex = positionElement->GetStream();
+	if (blendWeightsElement->GetStream() != streamIndex ||
+		blendIndicesElement->GetStream() != streamIndex ||
+		normalElement->GetStream() != streamIndex ||
+		streamIndex >= vertexData->VertexStreams.Count())
+	{
+		return;
+	}
+
+	HardwareBuffer* vertexBuffer = vertexData->VertexStreams[streamIndex].VertexBuffer;
+	if (vertexBuffer == NULL)
+	{
+		return;
+	}
+
+	_stride = vertexData->VertexStreams[streamIndex].Stride;
+	_positionOffset = positionElement->GetOffset();
+	_normalOffset = normalElement->GetOffset();
+	uint16 blendWeightsOffset = blendWeightsElement->GetOffset();
+	uint16 blendIndicesOffset = blendIndicesElement->GetOffset();
+	VertexFormat weightFormat = blendWeightsElement->GetVertexFormat();
 
-	_sourceVertexData = new VertexData();
-	_sourceVertexData->VertexLayout = vertexData->VertexLayout;
-	_sourceVertexData->VertexCount = vertexData->VertexCount;
+	// The streams, the weights and the indices follow each other in a single block,
+	// the padding vertices have no influence
+	int32 capacity = ((int32)vertexData->VertexCount + BatchSize - 1) & ~(BatchSize - 1);
+	SEptr size = (Stream_Count + 4) * capacity * sizeof(real32) + 4 * capacity * sizeof(uint8);
+	if (_buffer != NULL)
+	{
+		Memory::Free(_buffer);
+	}
+	_buffer = Memory::Alloc(size + StreamAlignment);
+	real32* data = (real32*)(((SEptr)_buffer + StreamAlignment - 1) & ~(SEptr)(StreamAlignment - 1));
+	Memory::Zero(data, size);
 
-	for (int i = 0; i < vertexData->VertexStreams.Count(); ++i)
+	for (int i = 0; i < Stream_Count; i++)
 	{
-		HardwareBuffer* destBuffer = vertexData->VertexStreams[i].VertexBuffer;
-		uint32 stride = vertexData->VertexStreams[i].Stride;
+		_streams[i] = data + i * capacity;
+	}
+	_blendWeights = data + Stream_Count * capacity;
+	_blendIndices = (uint8*)(_blendWeights + 4 * capacity);
 
-		HardwareBuffer* sourceBuffer;
-		if (!renderSystem->CreateVertexBuffer(vertexData->VertexCount * stride, HardwareBufferUsage_Dynamic, &sourceBuffer))
+	SEbyte* vertices;
+	vertexBuffer->Map(HardwareBufferMode_ReadOnly, (void**)&vertices);
+
+	for (uint32 i = 0; i < vertexData->VertexCount; ++i)
+	{
+		const real32* position = (const real32*)(vertices + _positionOffset);
+		const real32* normal = (const real32*)(vertices + _normalOffset);
+		_streams[Stream_PositionX][i] = position[0];
+		_streams[Stream_PositionY][i] = position[1];
+		_streams[Stream_PositionZ][i] = position[2];
+		_streams[Stream_NormalX][i] = normal[0];
+		_streams[Stream_NormalY][i] = normal[1];
+		_streams[Stream_NormalZ][i] = normal[2];
+
+		real32* weights = _blendWeights + i * 4;
+		uint8* indices = _blendIndices + i * 4;
+		ProcessWeights(weightFormat, vertices + blendWeightsOffset, weights);
+		for (int b = 0; b < 4; ++b)
 		{
-			_sourceVertexData->VertexStreams.Add(VertexStream(NULL, stride));
-			continue;
+			if (weights[b] > Math::Epsilon)
+			{
+				indices[b] = ((uint8*)(vertices + blendIndicesOffset))[b];
+			}
+			else
+			{
+				// The deformation skips the influences without weight
+				weights[b] = 0.0f;
+				indices[b] = 0;
+			}
 		}
-		_sourceVertexData->VertexStreams.Add(VertexStream(sourceBuffer, stride));
 
-		SEbyte* vertices;
-		SEbyte* sourceVertices;
-		destBuffer->Map(HardwareBufferMode_ReadOnly, (void**)&vertices);
-		sourceBuffer->Map(HardwareBufferMode_WriteOnly, (void**)&sourceVertices);
+		vertices += _stride;
+	}
 
-		Memory::Copy(sourceVertices, vertices, vertexData->VertexCount * stride);
+	vertexBuffer->Unmap();
 
-		destBuffer->Unmap();
-		sourceBuffer->Unmap();
-	}
+	_streamIndex = streamIndex;
+	_vertexCount = (int32)vertexData->VertexCount;
 }
 
 void Skin::Update(Skeleton* skeleton)
@@ -74,20 +333,26 @@ void Skin::Update(Skeleton* skeleton)
 		return;
 	}
 
-	if (_boneCount != boneCount)
-	{
-		SE_DELETE_ARRAY(_boneMatrixPalette);
-		_boneCount = boneCount;
-	}
-	if (_boneMatrixPalette == NULL)
+	// The skeleton computes its palette once for all its skins
+	if (BlendMode == SkinBlendMode_DualQuaternion)
 	{
-		_boneMatrixPalette = new Matrix4[boneCount];
+		const SkinDualQuaternion* palette = skeleton->GetSkinDualQuaternions();
+		_boneDualQuaternionPalette.Resize(boneCount);
+		for (i = 0; i < boneCount; ++i)
+		{
+			SE_ASSERT(SkinVertices[i].BoneIndex < skeleton->GetBoneCount());
+			_boneDualQuaternionPalette[i] = palette[SkinVertices[i].BoneIndex];
+		}
 	}
-
-	for (i = 0; i < boneCount; ++i)
+	else
 	{
-		Bone* bone = skeleton->GetBoneByIndex(SkinVertices[i].BoneIndex);
-		_boneMatrixPalette[i] = bone->GetSkinTransform();
+		const SkinMatrix* palette = skeleton->GetSkinMatrices();
+		_boneMatrixPalette.Resize(boneCount);
+		for (i = 0; i < boneCount; ++i)
+		{
+			SE_ASSERT(SkinVertices[i].BoneIndex < skeleton->GetBoneCount());
+			_boneMatrixPalette[i] = palette[SkinVertices[i].BoneIndex];
+		}
 	}
 }
 
@@ -98,17 +363,33 @@ void Skin::Deform()
 		return;
 	}
 
-	if (_sourceVertexData == NULL)
+	if (_streamIndex < 0 || _vertexCount == 0)
 	{
 		return;
 	}
 
-	int i;
-	for (i = 0; i < _destVertexData->VertexStreams.Count(); ++i)
+	if (BlendMode == SkinBlendMode_DualQuaternion ? _boneDualQuaternionPalette.IsEmpty() : _boneMatrixPalette.IsEmpty())
+	{
+		return;
+	}
+
+	HardwareBuffer* destBuffer = _destVertexData->VertexStreams[_streamIndex].VertexBuffer;
+	destBuffer->Map(HardwareBufferMode_WriteOnly, (void**)&_destVertices);
+
+	JobScheduler* scheduler = JobScheduler::Instance();
+	if (_vertexCount >= ParallelVertexCount && scheduler->IsCreated())
+	{
+		// The jobs process whole groups of vertices
+		int32 groupCount = (_vertexCount + BatchSize - 1) / BatchSize;
+		scheduler->ParallelFor(groupCount, UpdateRange, this, ParallelChunkSize / BatchSize);
+	}
+	else
 	{
-		HardwareBuffer* destBuffer = _destVertexData->VertexStreams[i].VertexBuffer;
-		UpdateVertexBuffer(i, destBuffer);
+		UpdateVertexBuffer(0, _vertexCount, _destVertices);
 	}
+
+	destBuffer->Unmap();
+	_destVertices = NULL;
 }
 
 void Skin::ProcessWeights(VertexFormat format, SEbyte* weightsIn, real32* weightsOut)
@@ -127,68 +408,130 @@ void Skin::ProcessWeights(VertexFormat format, SEbyte* weightsIn, real32* weight
 		weightsOut[2] = weightsIn[2] / 255.0f;
 		weightsOut[3] = weightsIn[3] / 255.0f;
 	}
+	else
+	{
+		weightsOut[0] = weightsOut[1] = weightsOut[2] = weightsOut[3] = 0.0f;
+	}
 }
 
-void Skin::UpdateVertexBuffer(int streamIndex, HardwareBuffer* destBuffer)
+void Skin::UpdateRange(int32 start, int32 end, void* data)
 {
-	VertexLayout* vertexLayout = _sourceVertexData->VertexLayout;
-	uint32 vertexCount = _sourceVertexData->VertexCount;
-	HardwareBuffer* sourceBuffer = _sourceVertexData->VertexStreams[streamIndex].VertexBuffer;
-	uint32 stride = _sourceVertexData->VertexStreams[streamIndex].Stride;
-
-	const VertexElement* positionElement = vertexLayout->GetElementBySemantic(VertexSemantic_Position);
-	const VertexElement* blendWeightsElement = vertexLayout->GetElementBySemantic(VertexSemantic_BlendWeight);
-	const VertexElement* blendIndicesElement = vertexLayout->GetElementBySemantic(VertexSemantic_BlendIndices);
-	const VertexElement* normalElement = vertexLayout->GetElementBySemantic(VertexSemantic_Normal);
-	const VertexElement* tangentElement = vertexLayout->GetElementBySemantic(VertexSemantic_Tangent);
-
-	if (positionElement == NULL || blendWeightsElement == NULL ||
-		blendIndicesElement == NULL || normalElement == NULL)
+	Skin* skin = (Skin*)data;
+	int32 last = end * BatchSize;
+	if (last > skin->_vertexCount)
 	{
-		return;
+		last = skin->_vertexCount;
 	}
 
-	uint16 positionOffset = positionElement->GetOffset();
-	uint16 blendWeightsOffset = blendWeightsElement->GetOffset();
-	uint16 blendIndicesOffset = blendIndicesElement->GetOffset();
-	uint16 normalOffset = normalElement->GetOffset();
-	VertexFormat weightFormat = blendWeightsElement->GetVertexFormat();
+	skin->UpdateVertexBuffer(start * BatchSize, last, skin->_destVertices);
+}
 
-	SEbyte* sourceVertices;
-	sourceBuffer->Map(HardwareBufferMode_ReadOnly, (void**)&sourceVertices);
+void Skin::UpdateVertexBuffer(int32 start, int32 end, SEbyte* destVertices)
+{
+	SE_ASSERT((start % BatchSize) == 0 && end <= _vertexCount);
+
+	const SkinMatrix* matrixPalette = _boneMatrixPalette.Data();
+	const SkinDualQuaternion* dualQuaternionPalette = _boneDualQuaternionPalette.Data();
+	bool dualQuaternion = (BlendMode == SkinBlendMode_DualQuaternion);
+
+	const real32* positionX = _streams[Stream_PositionX];
+	const real32* positionY = _streams[Stream_PositionY];
+	const real32* positionZ = _streams[Stream_PositionZ];
+	const real32* normalX = _streams[Stream_NormalX];
+	const real32* normalY = _streams[Stream_NormalY];
+	const real32* normalZ = _streams[Stream_NormalZ];
+	uint16 positionOffset = _positionOffset;
+	uint16 normalOffset = _normalOffset;
+	uint32 stride = _stride;
+
+#if SE_SKIN_SSE
+	__m128 result[6];
+	const real32* values = (const real32*)result;
+
+	for (int32 i = start; i < end; i += BatchSize)
+	{
+		// Blended transforms of the group, as a row and column of 4 vertices
+		__m128 m[3][4];
+		if (dualQuaternion)
+		{
+			_BlendDualQuaternions4(dualQuaternionPalette, _blendWeights + i * 4, _blendIndices + i * 4, m);
+		}
+		else
+		{
+			_BlendMatrices4(matrixPalette, _blendWeights + i * 4, _blendIndices + i * 4, m);
+		}
 
-	SEbyte* destVertices;
-	destBuffer->Map(HardwareBufferMode_WriteOnly, (void**)&destVertices);
+		__m128 px = _mm_load_ps(positionX + i);
+		__m128 py = _mm_load_ps(positionY + i);
+		__m128 pz = _mm_load_ps(positionZ + i);
+		__m128 nx = _mm_load_ps(normalX + i);
+		__m128 ny = _mm_load_ps(normalY + i);
+		__m128 nz = _mm_load_ps(normalZ + i);
+
+		for (int r = 0; r < 3; ++r)
+		{
+			result[r] = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(m[r][0], px), _mm_mul_ps(m[r][1], py)),
+				_mm_add_ps(_mm_mul_ps(m[r][2], pz), m[r][3]));
+			result[3 + r] = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(m[r][0], nx), _mm_mul_ps(m[r][1], ny)),
+				_mm_mul_ps(m[r][2], nz));
+		}
 
-	for (uint i = 0; i < vertexCount; ++i)
+		int32 count = (end - i < BatchSize ? end - i : BatchSize);
+		SEbyte* vertex = destVertices + i * stride;
+		for (int v = 0; v < count; ++v, vertex += stride)
+		{
+			real32* position = (real32*)(vertex + positionOffset);
+			real32* normal = (real32*)(vertex + normalOffset);
+			position[0] = values[0 * BatchSize + v];
+			position[1] = values[1 * BatchSize + v];
+			position[2] = values[2 * BatchSize + v];
+			normal[0] = values[3 * BatchSize + v];
+			normal[1] = values[4 * BatchSize + v];
+			normal[2] = values[5 * BatchSize + v];
+		}
+	}
+#else
+	SEbyte* vertex = destVertices + start * stride;
+	for (int32 i = start; i < end; ++i, vertex += stride)
 	{
-		Vector3 position = *(Vector3*)(sourceVertices + positionOffset);
-		real32 blendWeights[4];
-		ProcessWeights(weightFormat, sourceVertices + blendWeightsOffset, (real32*)blendWeights);
-		uint8* blendIndices = (uint8*)(sourceVertices + blendIndicesOffset);
-		Vector3 normal = *(Vector3*)(sourceVertices + normalOffset);
+		const real32* weights = _blendWeights + i * 4;
+		const uint8* indices = _blendIndices + i * 4;
 
-		Vector3 transformedPos = Vector3::Zero;
-		Vector3 transformedNormal = Vector3::Zero;
-		for (int b = 0; b < 4; ++b)
+		real32 rows[3][4];
+		if (dualQuaternion)
+		{
+			_BlendDualQuaternions(dualQuaternionPalette, weights, indices, rows);
+		}
+		else
 		{
-			if (blendWeights[b] > Math::Epsilon)
+			Memory::Zero(rows, sizeof(rows));
+			for (int b = 0; b < 4; ++b)
 			{
-				Matrix4 matBone = _boneMatrixPalette[blendIndices[b]];
-				transformedPos += blendWeights[b] * Vector3::Transform(position, matBone);
-				transformedNormal += blendWeights[b] * Vector3::TransformNormal(normal, matBone);
+				if (weights[b] > 0.0f)
+				{
+					const SkinMatrix& matrix = matrixPalette[indices[b]];
+					for (int r = 0; r < 3; ++r)
+					{
+						rows[r][0] += weights[b] * matrix.Rows[r][0];
+						rows[r][1] += weights[b] * matrix.Rows[r][1];
+						rows[r][2] += weights[b] * matrix.Rows[r][2];
+						rows[r][3] += weights[b] * matrix.Rows[r][3];
+					}
+				}
 			}
 		}
 
-		*(Vector3*)(destVertices + positionOffset) = transformedPos;
-		*(Vector3*)(destVertices + normalOffset) = transformedNormal;
-
-		sourceVertices += stride;
-		destVertices += stride;
+		real32* position = (real32*)(vertex + positionOffset);
+		real32* normal = (real32*)(vertex + normalOffset);
+		for (int r = 0; r < 3; ++r)
+		{
+			position[r] = rows[r][0] * positionX[i] + rows[r][1] * positionY[i] + rows[r][2] * positionZ[i] + rows[r][3];
+			normal[r] = rows[r][0] * normalX[i] + rows[r][1] * normalY[i] + rows[r][2] * normalZ[i];
+		}
 	}
-
-	destBuffer->Unmap();
-	sourceBuffer->Unmap();
+#endif
 }
 
 }
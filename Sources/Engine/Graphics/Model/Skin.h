@@ -9,12 +9,11 @@ Author: Julien Delezenne
 
 #include "Graphics/Common.h"
 #include "Graphics/System/RenderData.h"
+#include "Graphics/Model/Skeleton.h"
 
 namespace SonataEngine
 {
 
-class Skeleton;
-
 enum SkinningMethod
 {
 	SkinningMethod_Software,
@@ -22,6 +21,17 @@ enum SkinningMethod
 	SkinningMethod_Hardware
 };
 
+/** Blending of the bone transforms of the software skinning. */
+enum SkinBlendMode
+{
+	/// Blends the bone matrices.
+	SkinBlendMode_Linear,
+
+	/// Blends the bone dual quaternions, keeps the volume around the joints
+	/// but ignores the scale of the bones.
+	SkinBlendMode_DualQuaternion
+};
+
 /** Bone Influence. */
 class SE_GRAPHICS_EXPORT BoneInfluence
 {
@@ -38,32 +48,87 @@ public:
 	BaseArray<BoneInfluence> BoneInfluences;
 };
 
-/** Skin. */
+/**
+	@brief Skin.
+
+	The software skinning decodes the vertices of the bind pose once to
+	contiguous position, normal, weight and index streams. The vertices are
+	deformed by groups of 4 with the SIMD instructions when SE_USE_SIMD is
+	enabled, and the large meshes are split in chunks deformed by the
+	JobScheduler threads.
+*/
 class SE_GRAPHICS_EXPORT Skin : public RefObject
 {
 protected:
-	VertexData* _sourceVertexData;
+	enum Stream
+	{
+		Stream_PositionX,
+		Stream_PositionY,
+		Stream_PositionZ,
+		Stream_NormalX,
+		Stream_NormalY,
+		Stream_NormalZ,
+		Stream_Count
+	};
+
 	VertexData* _destVertexData;
-	int _boneCount;
-	Matrix4* _boneMatrixPalette;
+	int _streamIndex;
+	uint16 _positionOffset;
+	uint16 _normalOffset;
+	uint32 _stride;
+	int32 _vertexCount;
+
+	/// Single block holding the streams.
+	void* _buffer;
+	real32* _streams[Stream_Count];
+
+	/// 4 weights per vertex.
+	real32* _blendWeights;
+
+	/// 4 palette indices per vertex.
+	uint8* _blendIndices;
+
+	BaseArray<SkinMatrix> _boneMatrixPalette;
+	BaseArray<SkinDualQuaternion> _boneDualQuaternionPalette;
+
+	/// Destination of the vertices while deforming.
+	SEbyte* _destVertices;
 
 public:
 	BaseArray<SkinVertex> SkinVertices;
 	SkinningMethod SkinningMethod;
+	SkinBlendMode BlendMode;
+
+	/** Minimum number of vertices of a mesh deformed on several threads. */
+	static const int32 ParallelVertexCount;
+
+	/** Number of vertices deformed by each job. */
+	static const int32 ParallelChunkSize;
 
 public:
 	Skin();
 	virtual ~Skin();
 
 	void Initialize(VertexData* vertexData);
+
+	/** Copies the skin transforms of the bones from the palette of the skeleton. */
 	void Update(Skeleton* skeleton);
+
+	/** Deforms the vertices with the bone transforms of the last Update. */
 	void Deform();
 
 protected:
 	void ProcessWeights(VertexFormat format, SEbyte* weightsIn, real32* weightsOut);
-	void UpdateVertexBuffer(int streamIndex, HardwareBuffer* vertexBuffer);
-};
 
+	/** Deforms the vertices from start to end, excluded, to the destination buffer. */
+	void UpdateVertexBuffer(int32 start, int32 end, SEbyte* destVertices);
+
+	static void UpdateRange(int32 start, int32 end, void* data);
+
+private:
+	Skin(const Skin&);
+	Skin& operator=(const Skin&);
+};
 }
 
 #endif
@@ -48,7 +48,7 @@ ParticleEmitter::~ParticleEmitter()
 	ParticleArray::Iterator it = _Particles.GetIterator();
 	while (it.Next())
 	{
-		delete it.Current();
+		_ParticlePool.Delete(it.Current());
 	}
 }
 
@@ -65,7 +65,7 @@ void ParticleEmitter::SetMaxParticles(uint32 maxParticles)
 	ParticleArray::Iterator it = _Particles.GetIterator();
 	while (it.Next())
 	{
-		delete it.Current();
+		_ParticlePool.Delete(it.Current());
 	}
 
 	_MaxParticles = maxParticles;
@@ -77,11 +77,12 @@ void ParticleEmitter::SetMaxParticles(uint32 maxParticles)
 	// Increase size
 	_Particles.Resize(_MaxParticles);
 
-	// Create new particles
+	// Create new particles, contiguous in the pool
 	uint count = _Particles.Count();
+	_ParticlePool.Reserve(count);
 	for (uint i = 0; i < count; i++)
 	{
-		Particle* particle = new Particle();
+		Particle* particle = _ParticlePool.New();
 		_Particles.SetItem(i, particle);
 	}
 
@@ -10,6 +10,7 @@ Author: Julien Delezenne
 #include "Core/Object.h"
 #include "Core/Range.h"
 #include "Core/Scale.h"
+#include "Core/System/PoolAllocator.h"
 #include "Graphics/Materials/ShaderMaterial.h"
 #include "Graphics/Particle/Particle.h"
 #include "Graphics/Particle/ParticleLocation.h"
@@ -59,6 +60,7 @@ protected:
 	ParticleTemplate* _ParticleTemplate;
 	ShaderMaterial* _shader;
 	ParticleArray _Particles;
+	PoolAllocator<Particle> _ParticlePool;
 
 	bool _Enabled;
 	bool _Looped;
@@ -27,14 +27,37 @@ Scene::Scene() :
 
 Scene::~Scene()
 {
+	// Detach the objects so that they don't notify the scene anymore
+	SceneObjectList::Iterator it = _sceneObjects.GetIterator();
+	while (it.Next())
+	{
+		SceneObject* obj = it.Current();
+		obj->_scene = NULL;
+		obj->_sceneProxy = AABBTree::NullProxy;
+		obj->_sceneBoundsIndex = -1;
+		obj->_needSceneUpdate = false;
+	}
+
 	_root = NULL;
 }
 
 void Scene::AddObject(SceneObject* obj)
 {
+	if (obj == NULL)
+	{
+		SEthrow(ArgumentNullException("obj"));
+		return;
+	}
+
 	if (!_sceneObjects.Contains(obj))
 	{
+		if (obj->_scene != NULL)
+		{
+			obj->_scene->RemoveObject(obj);
+		}
+
 		_sceneObjects.Add(obj);
+		_InsertObject(obj);
 	}
 }
 
@@ -70,6 +93,7 @@ void Scene::RemoveObject(SceneObject* obj)
 {
 	if (_sceneObjects.Contains(obj))
 	{
+		_RemoveObject(obj);
 		_sceneObjects.Remove(obj);
 	}
 }
@@ -109,6 +133,181 @@ void Scene::Render()
 	}
 }
 
+void Scene::UpdateObjectBounds()
+{
+	int count = _updatedObjects.Count();
+	for (int i = 0; i < count; ++i)
+	{
+		SceneObject* obj = _updatedObjects[i];
+		obj->_needSceneUpdate = false;
+
+		BoundingSphere sphere;
+		AABB box;
+		if (_GetObjectBounds(obj, sphere, box))
+		{
+			if (obj->_sceneProxy != AABBTree::NullProxy)
+			{
+				_objectTree.MoveProxy(obj->_sceneProxy, box);
+				_objectBounds.Set(obj->_sceneBoundsIndex, sphere, box);
+			}
+			else
+			{
+				_unboundedObjects.Remove(obj);
+				_AddBounds(obj, sphere, box);
+			}
+		}
+		else if (obj->_sceneProxy != AABBTree::NullProxy)
+		{
+			_RemoveBounds(obj);
+			_unboundedObjects.Add(obj);
+		}
+	}
+
+	_updatedObjects.Clear();
+}
+
+void Scene::GetVisibleObjects(const Frustum& frustum, SceneObjectList& result)
+{
+	_queryResult.Clear();
+	_objectTree.Query(frustum, _queryResult);
+
+	int count = _queryResult.Count();
+	result.SetCapacity(result.Count() + count + _unboundedObjects.Count());
+	for (int i = 0; i < count; ++i)
+	{
+		result.Add((SceneObject*)_queryResult[i]);
+	}
+
+	count = _unboundedObjects.Count();
+	for (int i = 0; i < count; ++i)
+	{
+		result.Add(_unboundedObjects[i]);
+	}
+}
+
+void Scene::CullObjects(const Frustum& frustum, SceneObjectList& result)
+{
+	int count = _objectBounds.Count();
+	int maskSize = BoundsArray::GetMaskSize(count);
+	_visibilityMask.Resize(maskSize);
+	_objectBounds.CullBoxes(frustum, _visibilityMask.Data());
+
+	result.SetCapacity(result.Count() + count + _unboundedObjects.Count());
+
+	// Skip the words of the mask without visible objects
+	const uint32* mask = _visibilityMask.Data();
+	for (int word = 0; word < maskSize; ++word)
+	{
+		uint32 bits = mask[word];
+		for (int i = word * 32; bits != 0; ++i, bits >>= 1)
+		{
+			if ((bits & 1) != 0)
+			{
+				result.Add(_boundedObjects[i]);
+			}
+		}
+	}
+
+	count = _unboundedObjects.Count();
+	for (int i = 0; i < count; ++i)
+	{
+		result.Add(_unboundedObjects[i]);
+	}
+}
+
+void Scene::_NotifyObjectUpdate(SceneObject* obj)
+{
+	_updatedObjects.Add(obj);
+}
+
+void Scene::_InsertObject(SceneObject* obj)
+{
+	obj->_scene = this;
+	obj->_needSceneUpdate = false;
+
+	BoundingSphere sphere;
+	AABB box;
+	if (_GetObjectBounds(obj, sphere, box))
+	{
+		_AddBounds(obj, sphere, box);
+	}
+	else
+	{
+		obj->_sceneProxy = AABBTree::NullProxy;
+		obj->_sceneBoundsIndex = -1;
+		_unboundedObjects.Add(obj);
+	}
+}
+
+void Scene::_RemoveObject(SceneObject* obj)
+{
+	if (obj->_sceneProxy != AABBTree::NullProxy)
+	{
+		_RemoveBounds(obj);
+	}
+	else
+	{
+		_unboundedObjects.Remove(obj);
+	}
+
+	if (obj->_needSceneUpdate)
+	{
+		_updatedObjects.Remove(obj);
+	}
+
+	obj->_scene = NULL;
+	obj->_needSceneUpdate = false;
+}
+
+void Scene::_AddBounds(SceneObject* obj, const BoundingSphere& sphere, const AABB& box)
+{
+	obj->_sceneProxy = _objectTree.CreateProxy(box, obj);
+	obj->_sceneBoundsIndex = _objectBounds.Add(sphere, box);
+	_boundedObjects.Add(obj);
+}
+
+void Scene::_RemoveBounds(SceneObject* obj)
+{
+	_objectTree.DestroyProxy(obj->_sceneProxy);
+
+	// The last bounds are moved to the removed index
+	int index = obj->_sceneBoundsIndex;
+	int last = _boundedObjects.Count() - 1;
+	_objectBounds.RemoveAt(index);
+	if (index != last)
+	{
+		SceneObject* moved = _boundedObjects[last];
+		_boundedObjects[index] = moved;
+		moved->_sceneBoundsIndex = index;
+	}
+	_boundedObjects.RemoveAt(last);
+
+	obj->_sceneProxy = AABBTree::NullProxy;
+	obj->_sceneBoundsIndex = -1;
+}
+
+bool Scene::_GetObjectBounds(SceneObject* obj, BoundingSphere& sphere, AABB& box)
+{
+	// The lights only have a bounding sphere
+	if (!obj->GetLocalBoundingBox().IsEmpty())
+	{
+		box = obj->GetWorldBoundingBox();
+		sphere = (obj->GetLocalBoundingSphere().Radius > (real)0.0 ?
+			obj->GetWorldBoundingSphere() : BoundingSphere::CreateFromBox(box));
+		return true;
+	}
+	else if (obj->GetLocalBoundingSphere().Radius > (real)0.0)
+	{
+		sphere = obj->GetWorldBoundingSphere();
+		box = AABB::CreateFromSphere(sphere);
+		return true;
+	}
+	else
+	{
+		return false;
+	}
+}
+
 SEPointer(Scene);
 
 }
@@ -44,6 +44,8 @@ class SE_GRAPHICS_EXPORT Scene : public SceneObject
 		SE_Field(_fogState, FogState, Public);
 	SE_END_REFLECTION(Scene);
 
+	friend SceneObject;
+
 public:
 	typedef Array<SceneObject*> SceneObjectList;
 
@@ -61,6 +63,14 @@ protected:
 	SceneObjectList _sceneObjects;
 	AnimationSet* _animationSet;
 
+	AABBTree _objectTree;
+	BoundsArray _objectBounds;
+	SceneObjectList _boundedObjects;
+	SceneObjectList _unboundedObjects;
+	SceneObjectList _updatedObjects;
+	BaseArray<void*> _queryResult;
+	BaseArray<uint32> _visibilityMask;
+
 public:
 	/** @name Constructors / Destructor. */
 	//@{
@@ -106,6 +116,44 @@ public:
 	SceneObjectList::Iterator GetSceneObjectIterator() const;
 	//@}
 
+	/** @name Spatial queries. */
+	//@{
+	/** Gets the bounding volume hierarchy of the scene objects. */
+	const AABBTree& GetObjectTree() const { return _objectTree; }
+
+	/**
+		Gets the bounds of the scene objects, stored as a structure of arrays.
+		The bounds at index i are the bounds of the bounded object at index i.
+	*/
+	const BoundsArray& GetObjectBounds() const { return _objectBounds; }
+
+	/**
+		Updates the bounds of the objects that moved since the last update.
+		Must be called before the spatial queries.
+	*/
+	void UpdateObjectBounds();
+
+	/**
+		Gets the objects that can be visible in a frustum.
+		The objects without bounds, like the directional lights, are always returned.
+		The hierarchy tests the enlarged boxes of the objects, so objects near
+		the frustum but outside of it can be returned.
+		@param frustum The frustum.
+		@param result The list where the objects are added.
+	*/
+	void GetVisibleObjects(const Frustum& frustum, SceneObjectList& result);
+
+	/**
+		Gets the objects that can be visible in a frustum by testing the bounds
+		of all the objects at once.
+		This is faster than the hierarchy when most of the objects are visible,
+		like for the shadow casters of a light.
+		@param frustum The frustum.
+		@param result The list where the objects are added.
+	*/
+	void CullObjects(const Frustum& frustum, SceneObjectList& result);
+	//@}
+
 	/** @name Animations. */
 	//@{
 	/** Gets the animation set. */
@@ -118,6 +166,14 @@ public:
 	virtual void Initialize();
 	virtual void Update(const TimeValue& timeValue);
 	virtual void Render();
+
+protected:
+	void _NotifyObjectUpdate(SceneObject* obj);
+	void _InsertObject(SceneObject* obj);
+	void _RemoveObject(SceneObject* obj);
+	void _AddBounds(SceneObject* obj, const BoundingSphere& sphere, const AABB& box);
+	void _RemoveBounds(SceneObject* obj);
+	static bool _GetObjectBounds(SceneObject* obj, BoundingSphere& sphere, AABB& box);
 };
 
 SEPointer(Scene);
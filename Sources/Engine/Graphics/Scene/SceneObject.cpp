@@ -6,6 +6,7 @@ Author: Julien Delezenne
 
 #include "SceneObject.h"
 #include "SceneNode.h"
+#include "Scene.h"
 
 namespace SonataEngine
 {
@@ -17,6 +18,10 @@ SceneObject::SceneObject() :
 	NamedObject(),
 	_parent(NULL),
 	_isVisible(true),
+	_scene(NULL),
+	_sceneProxy(AABBTree::NullProxy),
+	_sceneBoundsIndex(-1),
+	_needSceneUpdate(false),
 	_needLocalTransformUpdate(true),
 	_needWorldTransformUpdate(true),
 	_needWorldBoundsUpdate(true),
@@ -30,6 +35,10 @@ SceneObject::SceneObject() :
 
 SceneObject::~SceneObject()
 {
+	if (_scene != NULL)
+	{
+		_scene->RemoveObject(this);
+	}
 }
 
 bool SceneObject::IsAncestor(SceneObject* value)
@@ -253,16 +262,28 @@ void SceneObject::_SetParent(SceneNode* value)
 void SceneObject::_NotifyLocalTransformUpdate()
 {
 	_needLocalTransformUpdate = true;
+	_NotifySceneUpdate();
 }
 
 void SceneObject::_NotifyWorldTransformUpdate()
 {
 	_needWorldTransformUpdate = true;
+	_NotifySceneUpdate();
 }
 
 void SceneObject::_NotifyWorldBoundsUpdate()
 {
 	_needWorldBoundsUpdate = true;
+	_NotifySceneUpdate();
+}
+
+void SceneObject::_NotifySceneUpdate()
+{
+	if (_scene != NULL && !_needSceneUpdate)
+	{
+		_needSceneUpdate = true;
+		_scene->_NotifyObjectUpdate(this);
+	}
 }
 
 void SceneObject::_UpdateLocalTransform()
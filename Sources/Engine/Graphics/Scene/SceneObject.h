@@ -14,6 +14,7 @@ namespace SonataEngine
 {
 
 class SceneNode;
+class Scene;
 
 /** SceneObject object. */
 class SE_GRAPHICS_EXPORT SceneObject : public NamedObject
@@ -26,11 +27,17 @@ class SE_GRAPHICS_EXPORT SceneObject : public NamedObject
 	SE_END_REFLECTION(SceneObject);
 
 	friend SceneNode;
+	friend Scene;
 
 protected:
 	SceneNode* _parent;
 	bool _isVisible;
 
+	Scene* _scene;
+	int32 _sceneProxy;
+	int32 _sceneBoundsIndex;
+	bool _needSceneUpdate;
+
 	bool _needLocalTransformUpdate;
 	bool _needWorldTransformUpdate;
 	bool _needWorldBoundsUpdate;
@@ -260,6 +267,11 @@ protected:
 
 	virtual void _NotifyWorldBoundsUpdate();
 
+	/**
+		Notifies the scene containing the object that its bounds need to be updated.
+	*/
+	void _NotifySceneUpdate();
+
 	/**
 		Updates the local transformation matrix.
 	*/
@@ -30,7 +30,7 @@ real DistanceFromCamera(const Vector3& cameraPos, const Vector3& modelPos, real
 	return Math::Abs(distance);
 }
 
-typedef BaseArray<ModelDistance> ModelDistanceList;
+typedef BaseArray<ModelDistance, FrameAllocator<ModelDistance> > ModelDistanceList;
 
 bool ModelSortFunction(const ModelDistance& left, const ModelDistance& right)
 {
@@ -40,7 +40,8 @@ bool ModelSortFunction(const ModelDistance& left, const ModelDistance& right)
 SceneManager::SceneManager() :
 	_scene(NULL),
 	_camera(NULL),
-	_frustumCulling(true)
+	_frustumCulling(true),
+	_spatialCulling(true)
 {
 	DefaultMaterial* shader = new DefaultMaterial();
 	FFPPass* pass = (FFPPass*)shader->GetTechnique()->GetPassByIndex(0);
@@ -87,10 +88,13 @@ void SceneManager::ClearSceneState()
 	_sceneState.ActivePointLights.Clear();
 	_sceneState.ActiveDirectionalLights.Clear();
 	_sceneState.ActiveSpotLights.Clear();
+	_sceneState.ShadowCasters.Clear();
 }
 
 void SceneManager::Update(const TimeValue& timeValue)
 {
+	SE_MEMORY_TAG(MemoryTag_Graphics);
+
 	_sceneState.ElapsedTime = (real64)timeValue - _sceneState.CurrentTime;
 	_sceneState.LastTime = _sceneState.CurrentTime;
 	_sceneState.CurrentTime = timeValue;
@@ -104,6 +108,8 @@ void SceneManager::Update(const TimeValue& timeValue)
 
 void SceneManager::Render()
 {
+	SE_MEMORY_TAG(MemoryTag_Graphics);
+
 	ClearSceneState();
 
     if (_scene == NULL || _camera == NULL)
@@ -117,7 +123,23 @@ void SceneManager::Render()
 	_sceneState.View = _camera->GetView();
 	_sceneState.ViewProjection = _sceneState.Projection * _sceneState.View;
 
-	Scene::SceneObjectList::Iterator it = _scene->GetSceneObjectIterator();
+	// Only the objects that can be visible are processed
+	if (_frustumCulling)
+	{
+		_visibleObjects.Clear();
+		_scene->UpdateObjectBounds();
+		if (_spatialCulling)
+		{
+			_scene->GetVisibleObjects(_camera->GetFrustum(), _visibleObjects);
+		}
+		else
+		{
+			_scene->CullObjects(_camera->GetFrustum(), _visibleObjects);
+		}
+	}
+
+	Scene::SceneObjectList::Iterator it = (_frustumCulling ?
+		_visibleObjects.GetIterator() : _scene->GetSceneObjectIterator());
 	while (it.Next())
 	{
 		SceneObject* obj = it.Current();
@@ -334,15 +356,19 @@ void SceneManager::BuildVisibilityList()
 	int i;
 	const Frustum& viewFrustum = _camera->GetFrustum();
 
+	const Vector3 cameraPos = _camera->GetWorldPosition();
+
 	int modelCount = _sceneState.AllModels.Count();
+	ModelNode* const* models = _sceneState.AllModels.Data();
 
+	// Temporary list allocated in the frame arena
 	ModelDistanceList modelSortList;
 	modelSortList.SetCapacity(modelCount);
 
 	ModelDistance md;
 	for (i = 0; i < modelCount; ++i)
 	{
-		ModelNode* model = _sceneState.AllModels[i];
+		ModelNode* model = models[i];
 
 		if (!model->IsVisible())
 		{
@@ -352,30 +378,26 @@ void SceneManager::BuildVisibilityList()
 		const BoundingSphere& worldBound = model->GetWorldBoundingSphere();
 		const Vector3 worldPosition = model->GetWorldPosition();
 
-		Vector3 cameraPos = _camera->GetWorldPosition();
+		// The hierarchy of the scene tests the enlarged boxes of its leaves,
+		// its candidates are tested against their own bounds
+		if (_frustumCulling && _spatialCulling && !viewFrustum.Intersects(worldBound))
+		{
+			continue;
+		}
 
 		md.Model = model;
 		md.DistanceFromCamera = DistanceFromCamera(cameraPos, worldPosition, worldBound.Radius);
-
-		if (_frustumCulling)
-		{
-			if (viewFrustum.Intersects(worldBound))
-			{
-				modelSortList.Add(md);
-			}
-		}
-		else
-		{
-			modelSortList.Add(md);
-		}
+		modelSortList.Add(md);
 	}
 
 	modelSortList.Sort(ModelSortFunction);
 
 	int visibleModelCount = modelSortList.Count();
+	const ModelDistance* sortedModels = modelSortList.Data();
+	_sceneState.VisibleModels.SetCapacity(visibleModelCount);
 	for (i = 0; i < visibleModelCount; ++i)
 	{
-		_sceneState.VisibleModels.Add(modelSortList[i].Model);
+		_sceneState.VisibleModels.Add(sortedModels[i].Model);
 	}
 
 	int pointLightCount = _sceneState.AllPointLights.Count();
@@ -428,6 +450,26 @@ void SceneManager::BuildVisibilityList()
 	}
 }
 
+void SceneManager::BuildShadowCasterList(SpotLight* spotLight)
+{
+	_sceneState.ShadowCasters.Clear();
+	_shadowCasterObjects.Clear();
+
+	// Most of the objects are usually inside of the light frustum, so the bounds are tested at once
+	_scene->UpdateObjectBounds();
+	_scene->CullObjects(spotLight->GetLightFrustum(), _shadowCasterObjects);
+
+	int objectCount = _shadowCasterObjects.Count();
+	for (int i = 0; i < objectCount; ++i)
+	{
+		SceneObject* obj = _shadowCasterObjects[i];
+		if (is(obj, ModelNode) && obj->IsVisible())
+		{
+			_sceneState.ShadowCasters.Add((ModelNode*)obj);
+		}
+	}
+}
+
 void SceneManager::RenderZPass()
 {
 }
@@ -496,6 +538,7 @@ void SceneManager::RenderScene()
 
 void SceneManager::RenderShadowMap(SpotLight* spotLight, Texture* destTexture, const Matrix4& lightViewProjection)
 {
+	BuildShadowCasterList(spotLight);
 }
 
 void SceneManager::RenderPostEffects()
@@ -55,6 +55,8 @@ struct SceneState
 	Array<PointLight*> ActivePointLights;
 	Array<DirectionalLight*> ActiveDirectionalLights;
 	Array<SpotLight*> ActiveSpotLights;
+
+	Array<ModelNode*> ShadowCasters;
 };
 
 /** Base class for the managers. */
@@ -66,6 +68,9 @@ protected:
 	Camera* _camera;
 	ShaderMaterial* _defaultShader;
 	bool _frustumCulling;
+	bool _spatialCulling;
+	Scene::SceneObjectList _visibleObjects;
+	Scene::SceneObjectList _shadowCasterObjects;
 
 public:
 	/** @name Constructors / Destructor. */
@@ -90,6 +95,17 @@ public:
 
 	ShaderMaterial* GetDefaultShader() const { return _defaultShader; }
 	void SetDefaultShader(ShaderMaterial* value) { _defaultShader = value; }
+
+	/** Gets or sets whether the objects outside of the camera frustum are culled. */
+	bool GetFrustumCulling() const { return _frustumCulling; }
+	void SetFrustumCulling(bool value) { _frustumCulling = value; }
+
+	/**
+		Gets or sets whether the frustum culling uses the bounding volume hierarchy of the scene.
+		Otherwise, the bounds of all the objects are tested at once against the frustum.
+	*/
+	bool GetSpatialCulling() const { return _spatialCulling; }
+	void SetSpatialCulling(bool value) { _spatialCulling = value; }
 	//@}
 
 	virtual void Update(const TimeValue& timeValue);
@@ -101,6 +117,7 @@ public:
 
 protected:
 	void BuildVisibilityList();
+	void BuildShadowCasterList(SpotLight* spotLight);
 	void RenderZPass();
 	void RenderScene();
 	void RenderShadowMap(SpotLight* spotLight, Texture* destTexture, const Matrix4& lightViewProjection);
@@ -132,12 +132,32 @@ void HeightField::Create(int32 width, int32 height, HeightFieldFormat format)
 	_Data = new real32[_Width * _Height];
 }
 
+void HeightField::Create(int32 width, int32 height, real32* data, RefObject* dataOwner)
+{
+	if (_Data)
+		Destroy();
+
+	_Width = width;
+	_Height = height;
+	_Format = HeightFieldFormat_Real;
+	_Data = data;
+	_DataOwner = dataOwner;
+}
+
 void HeightField::Destroy()
 {
 	_Width = 0;
 	_Height = 0;
 	_Format = HeightFieldFormat_Int8;
-	SE_DELETE_ARRAY(_Data);
+	if (_DataOwner.Get() != NULL)
+	{
+		_Data = NULL;
+		_DataOwner = NULL;
+	}
+	else
+	{
+		SE_DELETE_ARRAY(_Data);
+	}
 }
 
 bool HeightField::LoadFromRAW(Stream& stream, int32 width, int32 height, HeightFieldFormat format)
@@ -164,24 +184,45 @@ bool HeightField::LoadFromRAW(Stream& stream, int32 width, int32 height, HeightF
 		else
 			return false;
 
-		SEbyte* data = new SEbyte[size * element];
-		if (stream.Read((SEbyte*)data, size * element) != size * element)
+		// Convert the mapped pages of a mapped file in place
+		const SEbyte* data;
+		SEbyte* copy = NULL;
+		if (stream.GetStreamType() == StreamType_MappedFile)
 		{
-			delete[] data;
-			return false;
+			MappedFileStream& mappedStream = (MappedFileStream&)stream;
+			data = mappedStream.GetSpan(mappedStream.GetPosition(), size * element);
+			if (data == NULL)
+				return false;
+			mappedStream.Seek(size * element, SeekOrigin_Current);
+		}
+		else
+		{
+			copy = new SEbyte[size * element];
+			if (stream.Read(copy, size * element) != size * element)
+			{
+				delete[] copy;
+				return false;
+			}
+			data = copy;
 		}
 
-		for (i = 0; i < size; ++i)
+		if (format == HeightFieldFormat_Int8)
+		{
+			for (i = 0; i < size; ++i)
+				_Data[i] = (real32)((const int8*)data)[i];
+		}
+		else if (format == HeightFieldFormat_Int16)
+		{
+			for (i = 0; i < size; ++i)
+				_Data[i] = (real32)((const int16*)data)[i];
+		}
+		else
 		{
-			if (format == HeightFieldFormat_Int8)
-				_Data[i] = (real32)*(int8*)&data[i*element];
-			else if (format == HeightFieldFormat_Int16)
-				_Data[i] = (real32)*(int16*)&data[i*element];
-			else if (format == HeightFieldFormat_Int32)
-				_Data[i] = (real32)*(int32*)&data[i*element];
+			for (i = 0; i < size; ++i)
+				_Data[i] = (real32)((const int32*)data)[i];
 		}
 
-		delete[] data;
+		delete[] copy;
 	}
 
 	return true;
@@ -103,6 +103,19 @@ public:
 	*/
 	void Create(int32 width, int32 height, HeightFieldFormat format);
 
+	/**
+		Creates a height field over existing heights, without copying them.
+		@param width The width of the height field.
+		@param height The height of the height field.
+		@param data The heights, which are not deleted by the height field.
+		@param dataOwner The object holding the heights, kept alive by the height field.
+		@remarks
+			The heights of a height field created over the pages of a
+			memory-mapped file can only be set when the file is mapped
+			copy-on-write.
+	*/
+	void Create(int32 width, int32 height, real32* data, RefObject* dataOwner);
+
 	/**	Destroys the height field. */
 	void Destroy();
 
@@ -117,6 +130,7 @@ protected:
 	int32 _Height;
 	HeightFieldFormat _Format;
 	real32* _Data;
+	SmartPtr<RefObject> _DataOwner;
 };
 
 typedef SmartPtr<HeightField> HeightFieldPtr;
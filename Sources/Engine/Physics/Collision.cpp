@@ -32,5 +32,22 @@ namespace SonataEngine
 			_Normal(Vector3::Zero)
 		{
 		}
+
+		RaycastHit::RaycastHit() :
+			_Body(NULL),
+			_Shape(NULL),
+			_Position(Vector3::Zero),
+			_Normal(Vector3::Zero),
+			_Distance(0.0)
+		{
+		}
+
+		RaycastQuery::RaycastQuery() :
+			_Ray(),
+			_MaxDistance(SE_MAX_R32),
+			_HasHit(false),
+			_Hit()
+		{
+		}
 	}
 }
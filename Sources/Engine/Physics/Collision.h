@@ -96,6 +96,52 @@ namespace SonataEngine
 			Vector3 _Position;
 			Vector3 _Normal;
 		};
+
+		/**
+			@brief Result of a scene query.
+		*/
+		struct SE_PHYSICS_EXPORT RaycastHit
+		{
+			RaycastHit();
+
+			/** Body that was hit. */
+			IBody* _Body;
+
+			/** Shape that was hit. */
+			IShape* _Shape;
+
+			/** Position of the hit, in world space. */
+			Vector3 _Position;
+
+			/**
+				Normal of the surface that was hit, facing the query.
+				The normal is the opposite of the direction when the query starts inside of the shape.
+			*/
+			Vector3 _Normal;
+
+			/** Distance from the origin of the query, 0 if the query starts inside of the shape. */
+			real _Distance;
+		};
+
+		/**
+			@brief Ray of a batched raycast, with its result.
+		*/
+		struct SE_PHYSICS_EXPORT RaycastQuery
+		{
+			RaycastQuery();
+
+			/** Ray to cast. */
+			Ray3 _Ray;
+
+			/** Maximum distance of the hits. */
+			real _MaxDistance;
+
+			/** Determines whether the ray hit a shape. */
+			bool _HasHit;
+
+			/** Closest hit, valid if _HasHit is true. */
+			RaycastHit _Hit;
+		};
 	}
 }
 
@@ -43,6 +43,19 @@ namespace SonataEngine
 			TimeStepType_Variable
 		};
 
+		/** Types of broad phase algorithms. */
+		enum BroadPhaseType
+		{
+			/** Every pair of bodies is passed to the narrow phase. */
+			BroadPhaseType_None,
+
+			/** The bodies are stored in a dynamic bounding volume hierarchy. */
+			BroadPhaseType_AABBTree,
+
+			/** The bounds of the bodies are sorted along the axis of largest variance. */
+			BroadPhaseType_SweepAndPrune
+		};
+
 		/** Types of shapes. */
 		enum ShapeType
 		{
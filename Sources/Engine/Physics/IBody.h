@@ -115,6 +115,18 @@ namespace SonataEngine
 			/** Sets the world space orientation of the body. */
 			virtual void SetOrientation(const Quaternion& value) = 0;
 			virtual void SetOrientationMatrix(const Matrix3& value) = 0;
+
+			/**
+				Retrieves the position interpolated between the last two steps.
+				@param alpha Interpolation factor returned by IScene::GetInterpolationAlpha.
+			*/
+			virtual Vector3 GetInterpolatedPosition(real alpha) const { return GetPosition(); }
+
+			/**
+				Retrieves the orientation interpolated between the last two steps.
+				@param alpha Interpolation factor returned by IScene::GetInterpolationAlpha.
+			*/
+			virtual Quaternion GetInterpolatedOrientation(real alpha) const { return GetOrientation(); }
 			//@}
 
 			/** @name State. */
@@ -12,12 +12,15 @@ namespace SonataEngine
 	namespace Physics
 	{
 		SceneDescription::SceneDescription() :
-			_BroadPhase(true),
+			_BroadPhase(BroadPhaseType_AABBTree),
 			_CollisionDetection(true),
 			_Gravity(PhysicsSystem::DefaultGravity),
 			_TimeStepType(TimeStepType_Fixed),
 			_TimeStep(1.0f/60.0f),
 			_Iterations(8),
+			_MaxSubsteps(4),
+			_SleepEnergy(0.01f),
+			_SleepTime(0.5f),
 			_Bounds(AABB::Empty),
 			_MaxBodies(0),
 			_MaxJoints(0)
@@ -33,5 +36,33 @@ namespace SonataEngine
 		IScene::~IScene()
 		{
 		}
+
+		/// Rays of a batch and the scene they are cast in.
+		struct RaycastBatchData
+		{
+			const IScene* _Scene;
+			RaycastQuery* _Queries;
+		};
+
+		static void _RaycastRange(int32 start, int32 end, void* data)
+		{
+			RaycastBatchData* batch = (RaycastBatchData*)data;
+			for (int32 i = start; i < end; ++i)
+			{
+				RaycastQuery& query = batch->_Queries[i];
+				query._HasHit = batch->_Scene->Raycast(query._Ray, query._MaxDistance, query._Hit);
+			}
+		}
+
+		void IScene::RaycastBatch(RaycastQuery* queries, int count) const
+		{
+			if (queries == NULL || count <= 0)
+				return;
+
+			RaycastBatchData batch;
+			batch._Scene = this;
+			batch._Queries = queries;
+			JobScheduler::Instance()->ParallelFor(count, _RaycastRange, &batch);
+		}
 	}
 }
@@ -41,8 +41,8 @@ namespace SonataEngine
 		{
 			SceneDescription();
 
-			/** Determines whether the broad phase algorithm is enabled. */
-			bool _BroadPhase;
+			/** Broad phase algorithm. */
+			BroadPhaseType _BroadPhase;
 
 			/** Determines whether the collision detection is enabled. */
 			bool _CollisionDetection;
@@ -56,9 +56,18 @@ namespace SonataEngine
 			/** Maximum time step value if the integration method is fixed. */
 			real _TimeStep;
 
-			/** Maximum number of substeps to take. */
+			/** Number of iterations of the constraint solver. */
 			uint32 _Iterations;
 
+			/** Maximum number of fixed steps taken by an update, the remaining time is dropped. */
+			uint32 _MaxSubsteps;
+
+			/** Sum of the squared linear and angular speeds below which a body is resting, 0 to disable the sleeping. */
+			real _SleepEnergy;
+
+			/** Time during which the bodies touching each other must rest before they sleep. */
+			real _SleepTime;
+
 			/** Maximum scene bounds. */
 			AABB _Bounds;
 
@@ -113,6 +122,12 @@ namespace SonataEngine
 
 			virtual uint32 GetIterations() const = 0;
 			virtual void SetIterations(uint32 value) = 0;
+
+			/**
+				Retrieves the fraction of the fixed time step accumulated since the last step.
+				Used to interpolate the transforms of the bodies between the last two steps.
+			*/
+			virtual real GetInterpolationAlpha() const { return 1.0; }
 			//@}
 
 			/** @name Operations. */
@@ -150,6 +165,75 @@ namespace SonataEngine
 			virtual void Update(real64 elapsed) = 0;
 			//@}
 
+			/**
+				@name Queries.
+				The queries use the state of the bodies after the last update and can be
+				called from several threads while the scene is not updated. The
+				implementations of which the collision library is not reentrant
+				serialize the queries, such as ODE.
+				The directions don't need to be normalized, the distances are measured
+				along the normalized directions.
+				@remarks
+					The RenderWare physics system doesn't support the queries, they
+					log a warning and return no hit.
+			*/
+			//@{
+			/**
+				Finds the closest shape hit by a ray.
+				@param ray The ray.
+				@param maxDistance The maximum distance of the hit.
+				@param hit [out] The closest hit.
+				@return true if a shape was hit; otherwise, false.
+			*/
+			virtual bool Raycast(const Ray3& ray, real maxDistance, RaycastHit& hit) const = 0;
+
+			/**
+				Finds all the shapes hit by a ray.
+				@param ray The ray.
+				@param maxDistance The maximum distance of the hits.
+				@param hits [out] The list where the hits are added, sorted by distance.
+				@return The number of hits.
+			*/
+			virtual int RaycastAll(const Ray3& ray, real maxDistance, BaseArray<RaycastHit>& hits) const = 0;
+
+			/**
+				Finds the first shape hit by a moving sphere.
+				@param sphere The sphere at the start of the movement.
+				@param direction The direction of the movement.
+				@param maxDistance The length of the movement.
+				@param hit [out] The first hit.
+				@return true if a shape was hit; otherwise, false.
+			*/
+			virtual bool SweepSphere(const BoundingSphere& sphere, const Vector3& direction, real maxDistance, RaycastHit& hit) const = 0;
+
+			/**
+				Finds the first shape hit by a moving box.
+				@param box The box at the start of the movement.
+				@param direction The direction of the movement.
+				@param maxDistance The length of the movement.
+				@param hit [out] The first hit.
+				@return true if a shape was hit; otherwise, false.
+			*/
+			virtual bool SweepBox(const OBB& box, const Vector3& direction, real maxDistance, RaycastHit& hit) const = 0;
+
+			/**
+				Finds the bodies overlapping a box.
+				@param box The box.
+				@param bodies [out] The list where the bodies are added.
+				@return The number of bodies.
+			*/
+			virtual int OverlapAABB(const AABB& box, BaseArray<IBody*>& bodies) const = 0;
+
+			/**
+				Finds the closest hit of several rays.
+				The default implementation distributes the rays to the job scheduler
+				and calls Raycast for each ray.
+				@param queries The rays, the results are written to each query.
+				@param count The number of rays.
+			*/
+			virtual void RaycastBatch(RaycastQuery* queries, int count) const;
+			//@}
+
 			/** @name Events. */
 			//@{
 			/** Occurs when two bodies are in contact. */
@@ -30,6 +30,12 @@ uint32 LinuxEnvironment::TickCount()
 	return 0;
 }
 
+int32 LinuxEnvironment::ProcessorCount()
+{
+	long count = sysconf(_SC_NPROCESSORS_ONLN);
+	return (count > 0 ? (int32)count : 1);
+}
+
 String LinuxEnvironment::NewLine()
 {
 	return _T("\n");
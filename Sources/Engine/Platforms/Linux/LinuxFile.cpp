@@ -4,6 +4,11 @@ Project: Sonata Engine
 Author: Julien Delezenne
 =============================================================================*/
 
+// 64-bit file offsets on 32-bit platforms
+#if !defined(_FILE_OFFSET_BITS)
+#define _FILE_OFFSET_BITS 64
+#endif
+
 #include "Core/IO/File.h"
 #include "Core/IO/FileStream.h"
 #include "Core/IO/FileSystem.h"
@@ -80,22 +85,13 @@ WindowHandle LinuxFile::GetHandle() const
 	return _handle;
 }
 
-uint32 LinuxFile::GetLength() const
+int64 LinuxFile::GetLength() const
 {
-	FILE *fp;
-
-	fp = fopen(_name.Data(), "rb");
-	if (fp == NULL)
+	struct stat status;
+	if (stat(_name.Data(), &status) != 0)
 		return 0;
 
-	int pos = ftell(fp);
-	fseek(fp, 0, SEEK_END);
-	int len = ftell(fp);
-	fseek(fp, pos, SEEK_SET);
-
-	fclose(fp);
-
-	return len;
+	return (int64)status.st_size;
 }
 
 bool LinuxFile::IsOpen() const
@@ -0,0 +1,174 @@
+/*=============================================================================
+LinuxMappedFileStream.cpp
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+// 64-bit file offsets on 32-bit platforms
+#if !defined(_FILE_OFFSET_BITS)
+#define _FILE_OFFSET_BITS 64
+#endif
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+#include "Core/IO/MappedFileStream.h"
+#include "Core/IO/IOException.h"
+
+namespace SonataEngine
+{
+
+class MappedFileStreamInternal
+{
+public:
+	MappedFileStreamInternal();
+
+public:
+	int _handle;
+	void* _mapping;
+	size_t _mappingSize;
+};
+
+
+MappedFileStreamInternal::MappedFileStreamInternal() :
+	_handle(-1),
+	_mapping(NULL),
+	_mappingSize(0)
+{
+}
+
+
+MappedFileStream::MappedFileStream() :
+	Stream(),
+	_internal(new MappedFileStreamInternal()),
+	_access(MappedFileAccess_Normal),
+	_copyOnWrite(false),
+	_data(NULL),
+	_length(0),
+	_position(0)
+{
+}
+
+MappedFileStream::MappedFileStream(const String& fileName, MappedFileAccess access, bool copyOnWrite) :
+	Stream(),
+	_internal(new MappedFileStreamInternal()),
+	_access(MappedFileAccess_Normal),
+	_copyOnWrite(false),
+	_data(NULL),
+	_length(0),
+	_position(0)
+{
+	if (!Open(fileName, access, copyOnWrite))
+	{
+		SEthrow(IOException("Failed mapping the file."));
+	}
+}
+
+MappedFileStream::~MappedFileStream()
+{
+	Close();
+
+	delete _internal;
+}
+
+bool MappedFileStream::Open(const String& fileName, MappedFileAccess access, bool copyOnWrite)
+{
+	Close();
+
+	int handle = open(fileName.Data(), O_RDONLY);
+	if (handle == -1)
+	{
+		return false;
+	}
+
+	struct stat status;
+	if (fstat(handle, &status) != 0 || (uint64)status.st_size > (uint64)(size_t)-1)
+	{
+		close(handle);
+		return false;
+	}
+
+	// An empty file cannot be mapped
+	void* mapping = NULL;
+	size_t size = (size_t)status.st_size;
+	if (size > 0)
+	{
+		// The private mapping copies the pages written, when they can be written
+		int protection = (copyOnWrite ? PROT_READ | PROT_WRITE : PROT_READ);
+		mapping = mmap(NULL, size, protection, MAP_PRIVATE, handle, 0);
+		if (mapping == MAP_FAILED)
+		{
+			close(handle);
+			return false;
+		}
+	}
+
+	_internal->_handle = handle;
+	_internal->_mapping = mapping;
+	_internal->_mappingSize = size;
+
+	_fileName = fileName;
+	_copyOnWrite = copyOnWrite;
+	_data = (const SEbyte*)mapping;
+	_length = (int64)size;
+	_position = 0;
+
+	SetAccess(access);
+
+	return true;
+}
+
+bool MappedFileStream::IsOpen() const
+{
+	return (_internal->_handle != -1);
+}
+
+void MappedFileStream::SetAccess(MappedFileAccess value)
+{
+	_access = value;
+
+	if (_internal->_mapping == NULL)
+	{
+		return;
+	}
+
+	int advice;
+	if (value == MappedFileAccess_Sequential)
+		advice = MADV_SEQUENTIAL;
+	else if (value == MappedFileAccess_Random)
+		advice = MADV_RANDOM;
+	else
+		advice = MADV_NORMAL;
+
+	// The advice is only a hint, a failure is not an error
+	madvise(_internal->_mapping, _internal->_mappingSize, advice);
+}
+
+void MappedFileStream::Close()
+{
+	if (!IsOpen())
+	{
+		return;
+	}
+
+	if (_internal->_mapping != NULL)
+	{
+		munmap(_internal->_mapping, _internal->_mappingSize);
+	}
+	close(_internal->_handle);
+
+	_internal->_handle = -1;
+	_internal->_mapping = NULL;
+	_internal->_mappingSize = 0;
+
+	_fileName = String::Empty;
+	_copyOnWrite = false;
+	_data = NULL;
+	_length = 0;
+	_position = 0;
+}
+
+}
@@ -5,9 +5,13 @@ Author: Julien Delezenne
 =============================================================================*/
 
 #include <unistd.h>
+#include <errno.h>
+#include <time.h>
 #include <pthread.h>
+#include <semaphore.h>
 
 #include "Core/Threading/Semaphore.h"
+#include "Core/Threading/Thread.h"
 #include "Core/Exception/Exception.h"
 
 namespace SonataEngine
@@ -24,7 +28,7 @@ public:
 
 
 SemaphoreInternal::SemaphoreInternal() :
-	_handle((sem_t)0)
+	_handle()
 {
 }
 
@@ -48,7 +52,12 @@ Semaphore::~Semaphore()
 
 void Semaphore::Wait()
 {
-	if (sem_wait(&_internal->_handle) != 0)
+	int result;
+	while ((result = sem_wait(&_internal->_handle)) != 0 && errno == EINTR)
+	{
+	}
+
+	if (result != 0)
 	{
 		SEthrow(Exception("Failed locking the semaphore object."));
 	}
@@ -56,14 +65,38 @@ void Semaphore::Wait()
 
 void Semaphore::Wait(int32 millisecondsTimeout)
 {
-	while (millisecondsTimeout-- > 0) 
+	if (millisecondsTimeout == Thread::Infinite)
+	{
+		Wait();
+		return;
+	}
+
+	// sem_timedwait expects an absolute time
+	struct timespec abstime;
+	clock_gettime(CLOCK_REALTIME, &abstime);
+	abstime.tv_sec += millisecondsTimeout / 1000;
+	abstime.tv_nsec += (millisecondsTimeout % 1000) * 1000000L;
+	if (abstime.tv_nsec >= 1000000000L)
+	{
+		abstime.tv_sec++;
+		abstime.tv_nsec -= 1000000000L;
+	}
+
+	int result;
+	while ((result = sem_timedwait(&_internal->_handle, &abstime)) != 0 && errno == EINTR)
 	{
-		if (sem_trywait(&_internal->_handle) != 0)
+	}
+
+	if (result != 0)
+	{
+		if (errno == ETIMEDOUT)
+		{
+			SEthrow(Exception("Semaphore was nonsignaled, so a time-out occurred."));
+		}
+		else
 		{
 			SEthrow(Exception("Failed locking the semaphore object."));
-			return;
 		}
-		usleep(1000);
 	}
 }
 
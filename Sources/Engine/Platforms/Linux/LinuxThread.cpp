@@ -8,6 +8,7 @@ Author: Julien Delezenne
 #include <pthread.h>
 
 #include "Core/Threading/Thread.h"
+#include "Core/System/FrameArena.h"
 #include "Core/Exception/Exception.h"
 
 namespace SonataEngine
@@ -38,9 +39,15 @@ const int32 Thread::Infinite = -1;
 void* _ThreadFunc(void* arg)
 {
     ((Thread*)arg)->Run();
+    FrameArena::ReleaseCurrent();
 	return NULL;
 }
 
+Thread::Thread() :
+	_internal(new ThreadInternal())
+{
+}
+
 Thread::Thread(ThreadStart start) :
 	_internal(new ThreadInternal())
 {
@@ -54,15 +61,17 @@ Thread::~Thread()
 		Abort();
 	}
 
-	pthread_detach(_internal->_handle);
+	if (_internal->_handle != (pthread_t)0)
+	{
+		pthread_detach(_internal->_handle);
+	}
 
 	delete _internal;
 }
 
 ThreadId Thread::GetCurrentThreadId()
 {
-	// Unsupported with POSIX
-	return (ThreadId)0;
+	return pthread_self();
 }
 
 void Thread::Sleep(int32 millisecondsTimeout)
@@ -72,6 +81,7 @@ void Thread::Sleep(int32 millisecondsTimeout)
 
 void Thread::Exit()
 {
+	FrameArena::ReleaseCurrent();
 	pthread_exit(0);
 }
 
@@ -112,7 +122,6 @@ void Thread::Start()
 	}
 	else
 	{
-		_internal->_id = (ThreadId)::GetThreadId(_internal->_handle);
 		_internal->_state = ThreadState_Running;
 	}
 }
@@ -142,7 +151,11 @@ void Thread::Join(int32 millisecondsTimeout)
 		return;
 
 	// millisecondsTimeout unsupported with POSIX
-	pthread_join(_internal->_handle, NULL);
+	if (pthread_join(_internal->_handle, NULL) == 0)
+	{
+		_internal->_state = ThreadState_Stopped;
+		_internal->_handle = (pthread_t)0;
+	}
 }
 
 void Thread::Run()
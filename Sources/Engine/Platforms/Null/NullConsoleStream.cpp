@@ -50,21 +50,21 @@ bool NullConsoleStream::CanSeek() const
 	return false;
 }
 
-int32 NullConsoleStream::GetLength() const
+int64 NullConsoleStream::GetLength() const
 {
 	return 0;
 }
 
-void NullConsoleStream::SetLength(int32 value)
+void NullConsoleStream::SetLength(int64 value)
 {
 }
 
-int32 NullConsoleStream::GetPosition() const
+int64 NullConsoleStream::GetPosition() const
 {
 	return 0;
 }
 
-void NullConsoleStream::SetPosition(int32 value)
+void NullConsoleStream::SetPosition(int64 value)
 {
 }
 
@@ -78,7 +78,7 @@ void NullConsoleStream::Flush()
 {
 }
 
-int32 NullConsoleStream::Seek(int32 offset, SeekOrigin origin)
+int64 NullConsoleStream::Seek(int64 offset, SeekOrigin origin)
 {
 	return 0;
 }
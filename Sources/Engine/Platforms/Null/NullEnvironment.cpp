@@ -24,6 +24,11 @@ uint32 NullEnvironment::TickCount()
 	return 0;
 }
 
+int32 NullEnvironment::ProcessorCount()
+{
+	return 1;
+}
+
 String NullEnvironment::NewLine()
 {
 	return String::Empty;
@@ -64,7 +64,7 @@ WindowHandle NullFile::GetHandle() const
 	return _handle;
 }
 
-int32 NullFile::GetLength() const
+int64 NullFile::GetLength() const
 {
 	return 0;
 }
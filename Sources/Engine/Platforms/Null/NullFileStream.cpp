@@ -44,21 +44,21 @@ void NullFileStream::Init()
 	_file = NULL;
 }
 
-int32 NullFileStream::GetLength() const
+int64 NullFileStream::GetLength() const
 {
 	return 0;
 }
 
-void NullFileStream::SetLength(int32 value)
+void NullFileStream::SetLength(int64 value)
 {
 }
 
-int32 NullFileStream::GetPosition() const
+int64 NullFileStream::GetPosition() const
 {
 	return 0;
 }
 
-void NullFileStream::SetPosition(int32 value)
+void NullFileStream::SetPosition(int64 value)
 {
 }
 
@@ -75,7 +75,7 @@ void NullFileStream::Flush()
 {
 }
 
-int32 NullFileStream::Seek(int32 offset, SeekOrigin origin)
+int64 NullFileStream::Seek(int64 offset, SeekOrigin origin)
 {
 	if (_file == NULL || !_file->IsOpen())
 	{
@@ -7,39 +7,95 @@ Author: Julien Delezenne
 namespace SonataEngine
 {
 
-SE_INLINE void* Interlocked::Exchange(volatile void** location, void* value)
+SE_INLINE void* Interlocked::Load(volatile void** location, MemoryOrder order)
 {
 	return NULL;
 }
 
-SE_INLINE int32 Interlocked::Exchange(volatile int32* location, int32 value)
+SE_INLINE int32 Interlocked::Load(volatile int32* location, MemoryOrder order)
 {
 	return 0;
 }
 
-SE_INLINE void* Interlocked::CompareExchange(volatile void** location, void* value, void* comparand)
+SE_INLINE int64 Interlocked::Load(volatile int64* location, MemoryOrder order)
+{
+	return 0;
+}
+
+SE_INLINE void Interlocked::Store(volatile void** location, void* value, MemoryOrder order)
+{
+}
+
+SE_INLINE void Interlocked::Store(volatile int32* location, int32 value, MemoryOrder order)
+{
+}
+
+SE_INLINE void Interlocked::Store(volatile int64* location, int64 value, MemoryOrder order)
+{
+}
+
+SE_INLINE void* Interlocked::Exchange(volatile void** location, void* value, MemoryOrder order)
+{
+	return NULL;
+}
+
+SE_INLINE int32 Interlocked::Exchange(volatile int32* location, int32 value, MemoryOrder order)
+{
+	return 0;
+}
+
+SE_INLINE int64 Interlocked::Exchange(volatile int64* location, int64 value, MemoryOrder order)
+{
+	return 0;
+}
+
+SE_INLINE void* Interlocked::CompareExchange(volatile void** location, void* value, void* comparand, MemoryOrder order)
 {
 	return NULL;
 }
 
-SE_INLINE int32 Interlocked::CompareExchange(volatile int32* location, int32 value, int32 comparand)
+SE_INLINE int32 Interlocked::CompareExchange(volatile int32* location, int32 value, int32 comparand, MemoryOrder order)
+{
+	return 0;
+}
+
+SE_INLINE int64 Interlocked::CompareExchange(volatile int64* location, int64 value, int64 comparand, MemoryOrder order)
+{
+	return 0;
+}
+
+SE_INLINE int32 Interlocked::Increment(volatile int32* location, MemoryOrder order)
 {
 	return 0;
 }
 
-SE_INLINE int32 Interlocked::Increment(volatile int32* location)
+SE_INLINE int64 Interlocked::Increment(volatile int64* location, MemoryOrder order)
 {
 	return 0;
 }
 
-SE_INLINE int32 Interlocked::Decrement(volatile int32* location)
+SE_INLINE int32 Interlocked::Decrement(volatile int32* location, MemoryOrder order)
 {
 	return 0;
 }
 
-SE_INLINE int32 Interlocked::Add(volatile int32* location, int32 value)
+SE_INLINE int64 Interlocked::Decrement(volatile int64* location, MemoryOrder order)
 {
 	return 0;
 }
 
+SE_INLINE int32 Interlocked::Add(volatile int32* location, int32 value, MemoryOrder order)
+{
+	return 0;
+}
+
+SE_INLINE int64 Interlocked::Add(volatile int64* location, int64 value, MemoryOrder order)
+{
+	return 0;
+}
+
+SE_INLINE void Interlocked::MemoryFence(MemoryOrder order)
+{
+}
+
 }
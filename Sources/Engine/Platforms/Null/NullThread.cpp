@@ -16,6 +16,11 @@ class ThreadInternal
 
 const int32 Thread::Infinite = -1;
 
+Thread::Thread() :
+	_internal(NULL)
+{
+}
+
 Thread::Thread(ThreadStart start) :
 	_internal(NULL)
 {
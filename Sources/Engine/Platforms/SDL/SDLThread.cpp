@@ -8,6 +8,7 @@ Author: Julien Delezenne
 #include <SDL_thread.h>
 
 #include "Core/Threading/Thread.h"
+#include "Core/System/FrameArena.h"
 #include "Core/Exception/Exception.h"
 
 namespace SonataEngine
@@ -40,9 +41,15 @@ const int32 Thread::Infinite = -1;
 int _ThreadFunc(void* arg)
 {
     ((Thread*)arg)->Run();
+    FrameArena::ReleaseCurrent();
     return 0;
 }
 
+Thread::Thread() :
+	_internal(new ThreadInternal())
+{
+}
+
 Thread::Thread(ThreadStart start) :
 	_internal(new ThreadInternal())
 {
@@ -66,21 +66,21 @@ bool StdConsoleStream::CanSeek() const
 	return false;
 }
 
-int32 StdConsoleStream::GetLength() const
+int64 StdConsoleStream::GetLength() const
 {
 	return 0;
 }
 
-void StdConsoleStream::SetLength(int32 value)
+void StdConsoleStream::SetLength(int64 value)
 {
 }
 
-int32 StdConsoleStream::GetPosition() const
+int64 StdConsoleStream::GetPosition() const
 {
 	return 0;
 }
 
-void StdConsoleStream::SetPosition(int32 value)
+void StdConsoleStream::SetPosition(int64 value)
 {
 }
 
@@ -97,7 +97,7 @@ void StdConsoleStream::Flush()
 {
 }
 
-int32 StdConsoleStream::Seek(int32 offset, SeekOrigin origin)
+int64 StdConsoleStream::Seek(int64 offset, SeekOrigin origin)
 {
 	return 0;
 }
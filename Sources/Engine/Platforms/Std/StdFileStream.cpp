@@ -4,6 +4,11 @@ Project: Sonata Engine
 Author: Julien Delezenne
 =============================================================================*/
 
+// 64-bit file offsets on 32-bit platforms
+#if !defined(_FILE_OFFSET_BITS)
+#define _FILE_OFFSET_BITS 64
+#endif
+
 #include "Core/IO/FileStream.h"
 #include "Core/IO/File.h"
 #include "Core/Exception/ArgumentNullException.h"
@@ -12,6 +17,14 @@ Author: Julien Delezenne
 #include <sys/types.h>
 #include <sys/stat.h>
 
+#if defined(_MSC_VER)
+	#define SE_FSEEK _fseeki64
+	#define SE_FTELL _ftelli64
+#else
+	#define SE_FSEEK fseeko
+	#define SE_FTELL ftello
+#endif
+
 namespace SonataEngine
 {
 
@@ -47,7 +60,7 @@ void StdFileStream::Init()
 	_file = NULL;
 }
 
-int32 StdFileStream::GetLength() const
+int64 StdFileStream::GetLength() const
 {
 	SE_ASSERT(_file);
 	if (_file == NULL)
@@ -56,17 +69,17 @@ int32 StdFileStream::GetLength() const
 	return _file->GetLength();
 }
 
-int32 StdFileStream::GetPosition() const
+int64 StdFileStream::GetPosition() const
 {
 	SE_ASSERT(_file);
 	if (_file == NULL)
 		return 0;
 
 	FILE* fp = (FILE*)_file->GetHandle();
-	return ftell(fp);
+	return (int64)SE_FTELL(fp);
 }
 
-void StdFileStream::SetPosition(int32 value)
+void StdFileStream::SetPosition(int64 value)
 {
 	Seek(value, SeekOrigin_Begin);
 }
@@ -99,7 +112,7 @@ void StdFileStream::Flush()
 	}
 }
 
-int32 StdFileStream::Seek(int32 offset, SeekOrigin origin)
+int64 StdFileStream::Seek(int64 offset, SeekOrigin origin)
 {
 	SE_ASSERT(_file);
 	if (_file == NULL || !_file->IsOpen())
@@ -121,9 +134,9 @@ int32 StdFileStream::Seek(int32 offset, SeekOrigin origin)
 		return 0;
 
 	FILE* fp = (FILE*)_file->GetHandle();
-	if (fseek(fp, offset, stdOrigin) == 0)
+	if (SE_FSEEK(fp, offset, stdOrigin) != 0)
 	{
-		return 0;
+		return -1;
 	}
 
 	return GetPosition();
@@ -170,8 +183,8 @@ int32 StdFileStream::Read(byte* buffer, int32 count)
 	}
 
 	FILE* fp = (FILE*)_file->GetHandle();
-	size_t read = fread(buffer, count, 1, fp);
-	if ((int)read < count)
+	size_t read = fread(buffer, 1, count, fp);
+	if (read == 0 && count > 0)
 	{
 		return EOF;
 	}
@@ -214,8 +227,8 @@ int32 StdFileStream::Write(const byte* buffer, int32 count)
 	}
 
 	FILE* fp = (FILE*)_file->GetHandle();
-	size_t written = fwrite(buffer, count, 1, fp);
-	if ((int)written < count)
+	size_t written = fwrite(buffer, 1, count, fp);
+	if (written == 0 && count > 0)
 	{
 		return EOF;
 	}
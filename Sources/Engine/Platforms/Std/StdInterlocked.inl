@@ -4,57 +4,141 @@ Project: Sonata Engine
 Author: Julien Delezenne
 =============================================================================*/
 
+#if !defined(__GNUC__)
+#	error The atomic operations are not implemented for this compiler.
+#endif
+
 namespace SonataEngine
 {
 
-SE_INLINE void* Interlocked::Exchange(volatile void** location, void* value)
+/// Converts a memory order to the compiler memory model.
+SE_INLINE int _SE_AtomicOrder(MemoryOrder order)
 {
-	volatile void* oldLocation = (*val);
-	(*location) = value;
-	return oldLocation;
+	switch (order)
+	{
+	case MemoryOrder_Relaxed: return __ATOMIC_RELAXED;
+	case MemoryOrder_Acquire: return __ATOMIC_ACQUIRE;
+	case MemoryOrder_Release: return __ATOMIC_RELEASE;
+	case MemoryOrder_AcquireRelease: return __ATOMIC_ACQ_REL;
+	default: return __ATOMIC_SEQ_CST;
+	}
 }
 
-SE_INLINE int32 Interlocked::Exchange(volatile int32* location, int32 value)
+/// Gets the memory model of a failed compare and exchange, which can't contain a release.
+SE_INLINE int _SE_AtomicFailureOrder(MemoryOrder order)
 {
-	int32 oldLocation = (*val);
-	(*location) = value;
-	return oldLocation;
+	switch (order)
+	{
+	case MemoryOrder_Relaxed:
+	case MemoryOrder_Release: return __ATOMIC_RELAXED;
+	case MemoryOrder_Acquire:
+	case MemoryOrder_AcquireRelease: return __ATOMIC_ACQUIRE;
+	default: return __ATOMIC_SEQ_CST;
+	}
 }
 
-SE_INLINE void* Interlocked::CompareExchange(volatile void** location, void* value, void* comparand)
+SE_INLINE void* Interlocked::Load(volatile void** location, MemoryOrder order)
 {
-	volatile void* oldLocation = (*location);
-	if ((*location) == comparand)
-	{
-		(*location) = value;
-	}
-	return (void*)oldLocation;
+	return (void*)__atomic_load_n(location, _SE_AtomicOrder(order));
 }
 
-SE_INLINE int32 Interlocked::CompareExchange(volatile int32* location, int32 value, int32 comparand)
+SE_INLINE int32 Interlocked::Load(volatile int32* location, MemoryOrder order)
 {
-	int32 oldLocation = (*location);
-	if ((*location) == comparand)
-	{
-		(*location) = value;
-	}
-	return oldLocation;
+	return __atomic_load_n(location, _SE_AtomicOrder(order));
+}
+
+SE_INLINE int64 Interlocked::Load(volatile int64* location, MemoryOrder order)
+{
+	return __atomic_load_n(location, _SE_AtomicOrder(order));
+}
+
+SE_INLINE void Interlocked::Store(volatile void** location, void* value, MemoryOrder order)
+{
+	__atomic_store_n(location, (volatile void*)value, _SE_AtomicOrder(order));
+}
+
+SE_INLINE void Interlocked::Store(volatile int32* location, int32 value, MemoryOrder order)
+{
+	__atomic_store_n(location, value, _SE_AtomicOrder(order));
+}
+
+SE_INLINE void Interlocked::Store(volatile int64* location, int64 value, MemoryOrder order)
+{
+	__atomic_store_n(location, value, _SE_AtomicOrder(order));
+}
+
+SE_INLINE void* Interlocked::Exchange(volatile void** location, void* value, MemoryOrder order)
+{
+	return (void*)__atomic_exchange_n(location, (volatile void*)value, _SE_AtomicOrder(order));
+}
+
+SE_INLINE int32 Interlocked::Exchange(volatile int32* location, int32 value, MemoryOrder order)
+{
+	return __atomic_exchange_n(location, value, _SE_AtomicOrder(order));
+}
+
+SE_INLINE int64 Interlocked::Exchange(volatile int64* location, int64 value, MemoryOrder order)
+{
+	return __atomic_exchange_n(location, value, _SE_AtomicOrder(order));
+}
+
+SE_INLINE void* Interlocked::CompareExchange(volatile void** location, void* value, void* comparand, MemoryOrder order)
+{
+	volatile void* expected = comparand;
+	__atomic_compare_exchange_n(location, &expected, (volatile void*)value, false,
+		_SE_AtomicOrder(order), _SE_AtomicFailureOrder(order));
+	return (void*)expected;
+}
+
+SE_INLINE int32 Interlocked::CompareExchange(volatile int32* location, int32 value, int32 comparand, MemoryOrder order)
+{
+	int32 expected = comparand;
+	__atomic_compare_exchange_n(location, &expected, value, false,
+		_SE_AtomicOrder(order), _SE_AtomicFailureOrder(order));
+	return expected;
+}
+
+SE_INLINE int64 Interlocked::CompareExchange(volatile int64* location, int64 value, int64 comparand, MemoryOrder order)
+{
+	int64 expected = comparand;
+	__atomic_compare_exchange_n(location, &expected, value, false,
+		_SE_AtomicOrder(order), _SE_AtomicFailureOrder(order));
+	return expected;
+}
+
+SE_INLINE int32 Interlocked::Increment(volatile int32* location, MemoryOrder order)
+{
+	return __atomic_add_fetch(location, 1, _SE_AtomicOrder(order));
+}
+
+SE_INLINE int64 Interlocked::Increment(volatile int64* location, MemoryOrder order)
+{
+	return __atomic_add_fetch(location, 1, _SE_AtomicOrder(order));
+}
+
+SE_INLINE int32 Interlocked::Decrement(volatile int32* location, MemoryOrder order)
+{
+	return __atomic_sub_fetch(location, 1, _SE_AtomicOrder(order));
+}
+
+SE_INLINE int64 Interlocked::Decrement(volatile int64* location, MemoryOrder order)
+{
+	return __atomic_sub_fetch(location, 1, _SE_AtomicOrder(order));
 }
 
-SE_INLINE int32 Interlocked::Increment(volatile int32* location)
+SE_INLINE int32 Interlocked::Add(volatile int32* location, int32 value, MemoryOrder order)
 {
-	return ++(*location);
+	return __atomic_add_fetch(location, value, _SE_AtomicOrder(order));
 }
 
-SE_INLINE int32 Interlocked::Decrement(volatile int32* location)
+SE_INLINE int64 Interlocked::Add(volatile int64* location, int64 value, MemoryOrder order)
 {
-	return --(*location);
+	return __atomic_add_fetch(location, value, _SE_AtomicOrder(order));
 }
 
-SE_INLINE int32 Interlocked::Add(volatile int32* location, int32 value)
+SE_INLINE void Interlocked::MemoryFence(MemoryOrder order)
 {
-	(*location) += value;
-	return *location;
+	__atomic_thread_fence(_SE_AtomicOrder(order));
 }
 
 }
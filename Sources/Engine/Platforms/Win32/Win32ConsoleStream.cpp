@@ -64,21 +64,21 @@ bool Win32ConsoleStream::CanSeek() const
 	return false;
 }
 
-int32 Win32ConsoleStream::GetLength() const
+int64 Win32ConsoleStream::GetLength() const
 {
 	return 0;
 }
 
-void Win32ConsoleStream::SetLength(int32 value)
+void Win32ConsoleStream::SetLength(int64 value)
 {
 }
 
-int32 Win32ConsoleStream::GetPosition() const
+int64 Win32ConsoleStream::GetPosition() const
 {
 	return 0;
 }
 
-void Win32ConsoleStream::SetPosition(int32 value)
+void Win32ConsoleStream::SetPosition(int64 value)
 {
 }
 
@@ -95,7 +95,7 @@ void Win32ConsoleStream::Flush()
 {
 }
 
-int32 Win32ConsoleStream::Seek(int32 offset, SeekOrigin origin)
+int64 Win32ConsoleStream::Seek(int64 offset, SeekOrigin origin)
 {
 	return 0;
 }
@@ -226,6 +226,13 @@ uint32 Environment::TickCount()
 	return ::GetTickCount();
 }
 
+int32 Environment::ProcessorCount()
+{
+	SYSTEM_INFO si;
+	::GetSystemInfo(&si);
+	return (int32)si.dwNumberOfProcessors;
+}
+
 String Environment::NewLine()
 {
 	return _T("\r\n");
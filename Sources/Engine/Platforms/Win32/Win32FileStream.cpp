@@ -54,31 +54,39 @@ FileStream::~FileStream()
 	delete _internal;
 }
 
-int32 FileStream::GetLength() const
+int64 FileStream::GetLength() const
 {
 	if (_internal->_file == NULL)
 	{
 		return -1;
 	}
 
-	return ::GetFileSize((HANDLE)_internal->_file->GetHandle(), NULL);
+	return _internal->_file->GetLength();
 }
 
-void FileStream::SetLength(int32 value)
+void FileStream::SetLength(int64 value)
 {
 }
 
-int32 FileStream::GetPosition() const
+int64 FileStream::GetPosition() const
 {
 	if (_internal->_file == NULL)
 	{
 		return -1;
 	}
 
-	return ::SetFilePointer(_internal->_file->GetHandle(), 0, NULL, FILE_CURRENT);
+	LARGE_INTEGER distance;
+	LARGE_INTEGER position;
+	distance.QuadPart = 0;
+	if (!::SetFilePointerEx((HANDLE)_internal->_file->GetHandle(), distance, &position, FILE_CURRENT))
+	{
+		return -1;
+	}
+
+	return position.QuadPart;
 }
 
-void FileStream::SetPosition(int32 value)
+void FileStream::SetPosition(int64 value)
 {
 	Seek(value, SeekOrigin_Begin);
 }
@@ -107,7 +115,7 @@ void FileStream::Flush()
 	}
 }
 
-int32 FileStream::Seek(int32 offset, SeekOrigin origin)
+int64 FileStream::Seek(int64 offset, SeekOrigin origin)
 {
 	if (_internal->_file == NULL || !_internal->_file->IsOpen())
 	{
@@ -126,14 +134,16 @@ int32 FileStream::Seek(int32 offset, SeekOrigin origin)
 	else if (origin == SeekOrigin_End)
 		dwMoveMethod = FILE_END;
 
-	DWORD dwPtrLow = ::SetFilePointer((HANDLE)_internal->_file->GetHandle(), offset, NULL, dwMoveMethod);
-	if (dwPtrLow == INVALID_SET_FILE_POINTER)
+	LARGE_INTEGER distance;
+	LARGE_INTEGER position;
+	distance.QuadPart = offset;
+	if (!::SetFilePointerEx((HANDLE)_internal->_file->GetHandle(), distance, &position, dwMoveMethod))
 	{
 		SEthrow(Exception("Failed setting the position within the file stream."));
 		return -1;
 	}
 
-	return dwPtrLow;
+	return position.QuadPart;
 }
 
 bool FileStream::IsEOF() const
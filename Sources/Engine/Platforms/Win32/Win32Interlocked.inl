@@ -5,43 +5,129 @@ Author: Julien Delezenne
 =============================================================================*/
 
 #include "Win32Platform.h"
+#include <intrin.h>
 
 namespace SonataEngine
 {
 
-SE_INLINE void* Interlocked::Exchange(volatile void** location, void* value)
+// The Interlocked functions are full barriers so the memory orders are only
+// used to avoid the barriers of the plain reads and writes. The aligned
+// volatile reads and writes have acquire and release semantics.
+
+SE_INLINE void* Interlocked::Load(volatile void** location, MemoryOrder order)
+{
+	return *(void* volatile*)location;
+}
+
+SE_INLINE int32 Interlocked::Load(volatile int32* location, MemoryOrder order)
+{
+	return *location;
+}
+
+SE_INLINE int64 Interlocked::Load(volatile int64* location, MemoryOrder order)
+{
+	return (int64)InterlockedCompareExchange64((volatile LONGLONG*)location, 0, 0);
+}
+
+SE_INLINE void Interlocked::Store(volatile void** location, void* value, MemoryOrder order)
+{
+	if (order == MemoryOrder_Sequential)
+		InterlockedExchangePointer((volatile PVOID*)location, (PVOID)value);
+	else
+		*(void* volatile*)location = value;
+}
+
+SE_INLINE void Interlocked::Store(volatile int32* location, int32 value, MemoryOrder order)
+{
+	if (order == MemoryOrder_Sequential)
+		InterlockedExchange((volatile LONG*)location, (LONG)value);
+	else
+		*location = value;
+}
+
+SE_INLINE void Interlocked::Store(volatile int64* location, int64 value, MemoryOrder order)
+{
+	Exchange(location, value, order);
+}
+
+SE_INLINE void* Interlocked::Exchange(volatile void** location, void* value, MemoryOrder order)
 {
 	return (void*)InterlockedExchangePointer((volatile PVOID*)location, (PVOID)value);
 }
 
-SE_INLINE int32 Interlocked::Exchange(volatile int32* location, int32 value)
+SE_INLINE int32 Interlocked::Exchange(volatile int32* location, int32 value, MemoryOrder order)
 {
 	return (int32)InterlockedExchange((volatile LONG*)location, (LONG)value);
 }
 
-SE_INLINE void* Interlocked::CompareExchange(volatile void** location, void* value, void* comparand)
+SE_INLINE int64 Interlocked::Exchange(volatile int64* location, int64 value, MemoryOrder order)
+{
+	int64 comparand;
+	do
+	{
+		comparand = Load(location);
+	}
+	while (CompareExchange(location, value, comparand) != comparand);
+	return comparand;
+}
+
+SE_INLINE void* Interlocked::CompareExchange(volatile void** location, void* value, void* comparand, MemoryOrder order)
 {
 	return (void*)InterlockedCompareExchangePointer((volatile PVOID*)location, (PVOID)value, (PVOID)comparand);
 }
 
-SE_INLINE int32 Interlocked::CompareExchange(volatile int32* location, int32 value, int32 comparand)
+SE_INLINE int32 Interlocked::CompareExchange(volatile int32* location, int32 value, int32 comparand, MemoryOrder order)
 {
 	return (int32)InterlockedCompareExchange((volatile LONG*)location, (LONG)value, (LONG)comparand);
 }
 
-SE_INLINE int32 Interlocked::Increment(volatile int32* location)
+SE_INLINE int64 Interlocked::CompareExchange(volatile int64* location, int64 value, int64 comparand, MemoryOrder order)
+{
+	return (int64)InterlockedCompareExchange64((volatile LONGLONG*)location, (LONGLONG)value, (LONGLONG)comparand);
+}
+
+SE_INLINE int32 Interlocked::Increment(volatile int32* location, MemoryOrder order)
 {
 	return (int32)InterlockedIncrement((volatile LONG*)location);
 }
 
-SE_INLINE int32 Interlocked::Decrement(volatile int32* location)
+SE_INLINE int64 Interlocked::Increment(volatile int64* location, MemoryOrder order)
+{
+	return Add(location, 1, order);
+}
+
+SE_INLINE int32 Interlocked::Decrement(volatile int32* location, MemoryOrder order)
 {
 	return (int32)InterlockedDecrement((volatile LONG*)location);
 }
 
-SE_INLINE int32 Interlocked::Add(volatile int32* location, int32 value)
+SE_INLINE int64 Interlocked::Decrement(volatile int64* location, MemoryOrder order)
+{
+	return Add(location, -1, order);
+}
+
+SE_INLINE int32 Interlocked::Add(volatile int32* location, int32 value, MemoryOrder order)
+{
+	return (int32)InterlockedExchangeAdd((volatile LONG*)location, (LONG)value) + value;
+}
+
+SE_INLINE int64 Interlocked::Add(volatile int64* location, int64 value, MemoryOrder order)
+{
+	int64 comparand;
+	do
+	{
+		comparand = Load(location);
+	}
+	while (CompareExchange(location, comparand + value, comparand) != comparand);
+	return comparand + value;
+}
+
+SE_INLINE void Interlocked::MemoryFence(MemoryOrder order)
 {
-	return (int32)InterlockedExchangeAdd((volatile LONG*)location, (LONG)value);
+	if (order == MemoryOrder_Sequential)
+		MemoryBarrier();
+	else
+		_ReadWriteBarrier();
 }
 
 }
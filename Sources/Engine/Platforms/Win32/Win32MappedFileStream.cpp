@@ -5,253 +5,157 @@ Author: Julien Delezenne
 =============================================================================*/
 
 #include "Win32Platform.h"
-#include "Core/IO/FileStream.h"
-#include "Core/IO/File.h"
-#include "Core/Exception/ArgumentNullException.h"
+#include "Core/IO/MappedFileStream.h"
+#include "Core/IO/IOException.h"
 
 namespace SonataEngine
 {
 
-typedef FileStream Win32MappedFileStream;
-
-Win32MappedFileStream::FileStream() :
-	Stream()
+class MappedFileStreamInternal
 {
-	Init();
-}
-
-Win32MappedFileStream::FileStream(File* file) :
-	Stream()
-{
-	if (file == NULL)
-	{
-		throw new ArgumentNullException("file");
-		return;
-	}
-
-	Init();
-
-	_File = file;
-	_SourceName = file->GetName();
-
-	HANDLE hMapFile;
-	LPCTSTR pBuffer;
+public:
+	MappedFileStreamInternal();
 
-	HANDLE hFile = (HANDLE)_File->GetHandle();
-	hMapFile = ::CreateFileMapping(hFile, NULL, PAGE_READWRITE, 0,
-		_BufferSize, _SourceName);
-	if (hMapFile == NULL)
-	{
-		Logger::Current()->Log(LogLevel::Error, _T("Win32MappedFileStream (CreateFileMapping)"),
-			_T("Failed to create the file mapping object."));
-		return;
-	}
+public:
+	HANDLE _file;
+	HANDLE _mapping;
+};
 
-	pBuffer = (LPTSTR)::MapViewOfFile(hMapFile, FILE_MAP_ALL_ACCESS,
-		0, 0, _BufferSize);           
- 
-	if (pBuffer == NULL) 
-	{ 
-		Logger::Current()->Log(LogLevel::Error, _T("Win32MappedFileStream (MapViewOfFile)"),
-			_T("Failed to map a view  of the file."));
-		return;
-	}
-}
 
-Win32MappedFileStream::~FileStream()
+MappedFileStreamInternal::MappedFileStreamInternal() :
+	_file(INVALID_HANDLE_VALUE),
+	_mapping(NULL)
 {
-	::UnmapViewOfFile(pBuffer);
 }
 
-void Win32MappedFileStream::Init()
-{
-	_BufferSize = SE_FILESTREAM_BUFFERSIZE;
-	_File = NULL;
-}
 
-int32 Win32MappedFileStream::GetLength() const
+MappedFileStream::MappedFileStream() :
+	Stream(),
+	_internal(new MappedFileStreamInternal()),
+	_access(MappedFileAccess_Normal),
+	_copyOnWrite(false),
+	_data(NULL),
+	_length(0),
+	_position(0)
 {
-	if (_File == NULL)
-		return -1;
-
-	return GetFileSize(_File->GetHandle(), NULL);
 }
 
-void Win32MappedFileStream::SetLength(int32 value)
+MappedFileStream::MappedFileStream(const String& fileName, MappedFileAccess access, bool copyOnWrite) :
+	Stream(),
+	_internal(new MappedFileStreamInternal()),
+	_access(MappedFileAccess_Normal),
+	_copyOnWrite(false),
+	_data(NULL),
+	_length(0),
+	_position(0)
 {
+	if (!Open(fileName, access, copyOnWrite))
+	{
+		SEthrow(IOException("Failed mapping the file."));
+	}
 }
 
-int32 Win32MappedFileStream::GetPosition() const
+MappedFileStream::~MappedFileStream()
 {
-	SE_ASSERT(_File);
-	return ::SetFilePointer(_File->GetHandle(), 0, NULL, FILE_CURRENT);
-}
+	Close();
 
-void Win32MappedFileStream::SetPosition(int32 value)
-{
-	Seek(value, SeekOrigin_Begin);
+	delete _internal;
 }
 
-void Win32MappedFileStream::Close()
+bool MappedFileStream::Open(const String& fileName, MappedFileAccess access, bool copyOnWrite)
 {
-	if (_File == NULL || !_File->IsOpen())
-		return;
+	Close();
 
-	_File->Close();
-	Init();
-}
+	// The access pattern is given to the cache manager when the file is opened
+	DWORD dwFlagsAndAttributes = FILE_ATTRIBUTE_NORMAL;
+	if (access == MappedFileAccess_Sequential)
+		dwFlagsAndAttributes |= FILE_FLAG_SEQUENTIAL_SCAN;
+	else if (access == MappedFileAccess_Random)
+		dwFlagsAndAttributes |= FILE_FLAG_RANDOM_ACCESS;
 
-void Win32MappedFileStream::Flush()
-{
-	if (_File == NULL || !_File->IsOpen())
+	HANDLE hFile = ::CreateFile(fileName.Data(), GENERIC_READ, FILE_SHARE_READ, NULL,
+		OPEN_EXISTING, dwFlagsAndAttributes, NULL);
+	if (hFile == INVALID_HANDLE_VALUE)
 	{
-		//EXCEPT(ExceptionType_Abort, "File is not opened", "Win32MappedFileStream::Flush");
-		return;
+		return false;
 	}
 
-	if (_File->GetHandle())
+	LARGE_INTEGER size;
+	if (!::GetFileSizeEx(hFile, &size) || (uint64)size.QuadPart > (uint64)(SIZE_T)-1)
 	{
-		if (!::FlushFileBuffers(_File->GetHandle()))
-		{
-			//EXCEPT(ExceptionType_Abort, "Can't flush the file", "Win32MappedFileStream::Flush");
-			return;
-		}
+		::CloseHandle(hFile);
+		return false;
 	}
-}
 
-int32 Win32MappedFileStream::Seek(int32 offset, SeekOrigin origin)
-{
-	if (_File == NULL || !_File->IsOpen())
+	// An empty file cannot be mapped
+	HANDLE hMapping = NULL;
+	const SEbyte* data = NULL;
+	if (size.QuadPart > 0)
 	{
-		//EXCEPT(ExceptionType_Abort, "File is not opened", "Win32MappedFileStream::Seek");
-		return 0;
-	}
-
-	if (!CanSeek())
-		return GetPosition();
-
-	// Origin
-	DWORD dwMoveMethod = FILE_CURRENT;
-	if (origin == SeekOrigin_Begin)
-		dwMoveMethod = FILE_BEGIN;
-	else if (origin == SeekOrigin_End)
-		dwMoveMethod = FILE_END;
+		hMapping = ::CreateFileMapping(hFile, NULL, (copyOnWrite ? PAGE_WRITECOPY : PAGE_READONLY), 0, 0, NULL);
+		if (hMapping == NULL)
+		{
+			::CloseHandle(hFile);
+			return false;
+		}
 
-	if (!::SetFilePointer(_File->GetHandle(), offset, NULL, dwMoveMethod))
-	{
-		//EXCEPT(ExceptionType_Fail, "Cannot set new file position", "Win32MappedFileStream::Seek");
-		return 0;
+		data = (const SEbyte*)::MapViewOfFile(hMapping, (copyOnWrite ? FILE_MAP_COPY : FILE_MAP_READ), 0, 0, 0);
+		if (data == NULL)
+		{
+			::CloseHandle(hMapping);
+			::CloseHandle(hFile);
+			return false;
+		}
 	}
 
-	return GetPosition();
-}
-
-bool Win32MappedFileStream::IsEOF() const
-{
-	return GetPosition() == GetLength();
-}
-
-byte Win32MappedFileStream::ReadByte()
-{
-	if (_File == NULL || !_File->IsOpen())
-	{
-		//EXCEPT(ExceptionType_Abort, "File is not opened", "Win32MappedFileStream::ReadByte");
-		return EOF;
-	}
+	_internal->_file = hFile;
+	_internal->_mapping = hMapping;
 
-	if (!CanRead())
-	{
-		//EXCEPT(ExceptionType_Abort, "Read operation not permitted", "Win32MappedFileStream::ReadByte");
-		return EOF;
-	}
+	_fileName = fileName;
+	_access = access;
+	_copyOnWrite = copyOnWrite;
+	_data = data;
+	_length = size.QuadPart;
+	_position = 0;
 
-	byte value;
-	return Read(&value, 1) == EOF ? EOF : value;
+	return true;
 }
 
-int32 Win32MappedFileStream::Read(byte* buffer, int32 count)
+bool MappedFileStream::IsOpen() const
 {
-	if (buffer == NULL)
-	{
-		//EXCEPT(ExceptionType_Pointer, "Null pointer error", "Win32MappedFileStream::Read");
-		return EOF;
-	}
-
-	if (_File == NULL || !_File->IsOpen())
-	{
-		//EXCEPT(ExceptionType_Abort, "File is not opened", "Win32MappedFileStream::Read");
-		return EOF;
-	}
-
-	if (!CanRead())
-	{
-		//EXCEPT(ExceptionType_Abort, "Read operation not permitted", "Win32MappedFileStream::Read");
-		return EOF;
-	}
-
-	DWORD dwNumberOfBytesRead;
-	if (::ReadFile(_File->GetHandle(), (LPVOID) buffer, count, &dwNumberOfBytesRead, NULL) == FALSE)
-	{
-		//EXCEPT(ExceptionType_Fail, "Read error", "Win32MappedFileStream::Read");
-		return EOF;
-	}
-
-	return dwNumberOfBytesRead;
+	return (_internal->_file != INVALID_HANDLE_VALUE);
 }
 
-void Win32MappedFileStream::WriteByte(byte value)
+void MappedFileStream::SetAccess(MappedFileAccess value)
 {
-	if (_File == NULL || !_File->IsOpen())
-	{
-		//EXCEPT(ExceptionType_Abort, "File is not opened", "Win32MappedFileStream::WriteByte");
-		return;
-	}
-
-	if (!CanWrite())
-	{
-		//EXCEPT(ExceptionType_Abort, "Write operation not permitted", "Win32MappedFileStream::WriteByte");
-		return;
-	}
-
-	Write(&value, 1);
+	_access = value;
 }
 
-int32 Win32MappedFileStream::Write(const byte* buffer, int32 count)
+void MappedFileStream::Close()
 {
-	if (buffer == NULL)
+	if (!IsOpen())
 	{
-		//EXCEPT(ExceptionType_Pointer, "Null pointer error", "Win32MappedFileStream::Write");
-		return EOF;
+		return;
 	}
 
-	if (_File == NULL || !_File->IsOpen())
+	if (_data != NULL)
 	{
-		//EXCEPT(ExceptionType_Abort, "File is not opened", "Win32MappedFileStream::Write");
-		return EOF;
+		::UnmapViewOfFile(_data);
 	}
-
-	if (!CanWrite())
+	if (_internal->_mapping != NULL)
 	{
-		//EXCEPT(ExceptionType_Abort, "Write operation not permitted", "Win32MappedFileStream::Write");
-		return EOF;
+		::CloseHandle(_internal->_mapping);
 	}
+	::CloseHandle(_internal->_file);
 
-	DWORD dwNumberOfBytesWritten;
-	if (::WriteFile(_File->GetHandle(), buffer, count, &dwNumberOfBytesWritten, NULL) == FALSE)
-	{
-		//EXCEPT(ExceptionType_Fail, "Write error", "Win32MappedFileStream::Write");
-		return EOF;
-	}
-
-	return dwNumberOfBytesWritten;
-}
-
-String Win32MappedFileStream::GetName() const
-{
-	if (_File == NULL)
-		return String::Empty;
+	_internal->_file = INVALID_HANDLE_VALUE;
+	_internal->_mapping = NULL;
 
-	return _File->GetName();
+	_fileName = String::Empty;
+	_copyOnWrite = false;
+	_data = NULL;
+	_length = 0;
+	_position = 0;
 }
 
 }
@@ -7,6 +7,7 @@ Author: Julien Delezenne
 #include <windows.h>
 
 #include "Core/Threading/Thread.h"
+#include "Core/System/FrameArena.h"
 #include "Core/Exception/Exception.h"
 
 namespace SonataEngine
@@ -39,9 +40,15 @@ const int32 Thread::Infinite = -1;
 static DWORD WINAPI _ThreadProc(LPVOID lpParameter)
 {
     ((Thread*)lpParameter)->Run();
+    FrameArena::ReleaseCurrent();
     return 0;
 }
 
+Thread::Thread() :
+	_internal(new ThreadInternal())
+{
+}
+
 Thread::Thread(ThreadStart start) :
 	_internal(new ThreadInternal())
 {
@@ -72,6 +79,7 @@ void Thread::Sleep(int32 millisecondsTimeout)
 
 void Thread::Exit()
 {
+	FrameArena::ReleaseCurrent();
 	::ExitThread(0);
 }
 
@@ -191,7 +199,10 @@ void Thread::Join(int32 millisecondsTimeout)
 	if (_internal->_state == ThreadState_Unstarted)
 		return;
 
-	::WaitForSingleObject(_internal->_handle, millisecondsTimeout);
+	if (::WaitForSingleObject(_internal->_handle, millisecondsTimeout) == WAIT_OBJECT_0)
+	{
+		_internal->_state = ThreadState_Stopped;
+	}
 }
 
 void Thread::Run()
@@ -32,6 +32,11 @@ uint32 Environment::TickCount()
 	return ::GetTickCount();
 }
 
+int32 Environment::ProcessorCount()
+{
+	return 1;
+}
+
 String Environment::NewLine()
 {
 	return _T("\r\n");
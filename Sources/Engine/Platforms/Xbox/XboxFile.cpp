@@ -92,16 +92,16 @@ FileHandle File::GetHandle() const
 	return (FileHandle)_internal->_handle;
 }
 
-int32 File::GetLength() const
+int64 File::GetLength() const
 {
-	int32 nLength = ::GetFileSize(_internal->_handle, NULL);
-	if (nLength == INVALID_FILE_SIZE)
+	LARGE_INTEGER size;
+	if (!::GetFileSizeEx(_internal->_handle, &size))
 	{
 		SEthrow(Exception("Failed retrieving the file size."));
 		return 0;
 	}
 
-	return nLength;
+	return size.QuadPart;
 }
 
 bool File::IsOpen() const
@@ -17,22 +17,22 @@ SE_INLINE void Memory::Terminate()
 {
 }
 
-SE_INLINE void* Memory::Alloc(size_t size)
+SE_INLINE void* Memory::SystemAlloc(size_t size)
 {
 	return ::HeapAlloc(::GetProcessHeap(), 0, size);
 }
 
-SE_INLINE void* Memory::Calloc(size_t num, size_t size)
+SE_INLINE void* Memory::SystemCalloc(size_t num, size_t size)
 {
 	return ::HeapAlloc(::GetProcessHeap(), HEAP_ZERO_MEMORY, num * size);
 }
 
-SE_INLINE void* Memory::ReAlloc(void* ptr, size_t size)
+SE_INLINE void* Memory::SystemReAlloc(void* ptr, size_t size)
 {
 	return ::HeapReAlloc(::GetProcessHeap(), 0, ptr, size);
 }
 
-SE_INLINE void Memory::Free(void* ptr)
+SE_INLINE void Memory::SystemFree(void* ptr)
 {
 	::HeapFree(::GetProcessHeap(), 0, ptr);
 }
@@ -107,11 +107,19 @@ namespace SonataEngine
 			RectangleInt _Rectangle;
 		};
 
-		class SE_UI_EXPORT ListItemList : public Array<ListItem*>
+		/**
+			@brief List of the items of a widget.
+
+			The array is not exposed so the items are only modified through
+			the methods that update their owner.
+		*/
+		class SE_UI_EXPORT ListItemList : protected Array<ListItem*>
 		{
 			typedef Array<ListItem*> super;
 
 		public:
+			typedef super::Iterator Iterator;
+
 			ListItemList() :
 				super(),
 				_Owner(NULL)
@@ -126,27 +134,37 @@ namespace SonataEngine
 
 			void SetOwner(Widget* value) { _Owner = value; }
 
-			virtual void Add(ListItem* value)
+			using super::GetIterator;
+			using super::Count;
+			using super::IsEmpty;
+			using super::Contains;
+			using super::IndexOf;
+
+			ListItem* operator[](int32 index) const { return super::operator[](index); }
+
+			ListItem* GetItem(int32 index) const { return super::GetItem(index); }
+
+			void Add(ListItem* value)
 			{
 				super::Add(value);
 				value->SetOwner(_Owner);
 				_Owner->Refresh();
 			}
 
-			virtual void Insert(int32 index, ListItem* value)
+			void Insert(int32 index, ListItem* value)
 			{
 				super::Insert(index, value);
 				value->SetOwner(_Owner);
 			}
 
-			virtual void Remove(ListItem* value)
+			void Remove(ListItem* value)
 			{
 				value->SetOwner(NULL);
 				super::Remove(value);
 				_Owner->Refresh();
 			}
 
-			virtual void Clear()
+			void Clear()
 			{
 				ListItemList::Iterator it = GetIterator();
 				while (it.Next())
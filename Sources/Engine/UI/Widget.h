@@ -46,37 +46,55 @@ namespace SonataEngine
 			SE_END_REFLECTION(Widget);
 
 		public:
-			class WidgetList : public Array<Widget*>
+			/**
+				@brief List of the children of a widget.
+
+				The array is not exposed so the children are only modified
+				through the methods that update their parent.
+			*/
+			class WidgetList : protected Array<Widget*>
 			{
 				typedef Array<Widget*> super;
 
 			public:
+				typedef super::Iterator Iterator;
+
 				WidgetList(Widget* owner) :
 					super(),
 					_Owner(owner)
 				{
 				}
 
-				virtual void Add(Widget* value)
+				using super::GetIterator;
+				using super::Count;
+				using super::IsEmpty;
+				using super::Contains;
+				using super::IndexOf;
+
+				Widget* operator[](int32 index) const { return super::operator[](index); }
+
+				Widget* GetItem(int32 index) const { return super::GetItem(index); }
+
+				void Add(Widget* value)
 				{
 					super::Add(value);
 					value->InternalSetParent(_Owner);
 				}
 
-				virtual void Insert(int32 index, Widget* value)
+				void Insert(int32 index, Widget* value)
 				{
 					super::Insert(index, value);
 					value->InternalSetParent(_Owner);
 				}
 
-				virtual void Remove(Widget* value)
+				void Remove(Widget* value)
 				{
 					value->InternalSetParent(NULL);
 					super::Remove(value);
 					//TODO: UISystem notification
 				}
 
-				virtual void Clear()
+				void Clear()
 				{
 					WidgetList::Iterator it = GetIterator();
 					while (it.Next())
@@ -206,7 +206,7 @@ void WestwoodW3DReader::SkipChunk(W3dChunkHeader* current)
 
 bool WestwoodW3DReader::ReadW3D()
 {
-	uint32 ChunkSize = _Reader->GetStream()->GetLength();
+	uint32 ChunkSize = (uint32)_Reader->GetStream()->GetLength();
 
 	W3dChunkHeader current;
 	uint32 CurrentSize = 0;
@@ -41,7 +41,7 @@ Image* DevILImageReader::LoadImage(Stream& stream, ImageReaderOptions* options)
 	if (stream.GetStreamType() == StreamType_Memory)
 	{
 		MemoryStream& memory = *(MemoryStream*)&stream;
-		res = ilLoadL(IL_TYPE_UNKNOWN, memory.GetBuffer(), stream.GetLength());
+		res = ilLoadL(IL_TYPE_UNKNOWN, memory.GetBuffer(), (ILuint)stream.GetLength());
 	}
 	else if (stream.GetStreamType() == StreamType_File)
 	{
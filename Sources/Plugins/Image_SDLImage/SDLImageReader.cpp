@@ -27,7 +27,7 @@ Image* SDLImageReader::LoadImage(Stream& stream, ImageReaderOptions* options)
 	if (stream.GetStreamType() == StreamType_Memory)
 	{
 		MemoryStream& memory = *(MemoryStream*)&stream;
-		SDL_RWops* src = SDL_RWFromMem(memory.GetBuffer(), stream.GetLength());
+		SDL_RWops* src = SDL_RWFromMem(memory.GetBuffer(), (int)stream.GetLength());
 		surface = IMG_Load_RW(src, 0);
 		SDL_FreeRW(src);
 	}
@@ -60,7 +60,7 @@ bool M3DSModelReader::ReadModel()
 	_scene.keyf = NULL;
 
 	Mesh3DSChunk chunk;
-	chunk.offset = _stream->GetPosition();
+	chunk.offset = (uint32)_stream->GetPosition();
 	while (ReadNextChunk(parent, chunk))
 	{
 		switch (chunk.id)
@@ -94,7 +94,7 @@ bool M3DSModelReader::ReadChunk(Mesh3DSChunk& chunk)
 
 bool M3DSModelReader::ReadNextChunk(const Mesh3DSChunk& parent, Mesh3DSChunk& chunk)
 {
-	chunk.offset = _stream->GetPosition();
+	chunk.offset = (uint32)_stream->GetPosition();
 
 	if (chunk.offset >= parent.offset + parent.size)
 		return false;
@@ -226,7 +226,7 @@ void M3DSModelReader::ReadEditorChunk(const Mesh3DSChunk& parent, Mesh3DSEditor&
 	Mesh3DSMaterial* material;
 
 	Mesh3DSChunk chunk;
-	chunk.offset = _stream->GetPosition();
+	chunk.offset = (uint32)_stream->GetPosition();
 	while (ReadNextChunk(parent, chunk))
 	{
 		switch (chunk.id)
@@ -275,7 +275,7 @@ void M3DSModelReader::ReadMaterialChunk(const Mesh3DSChunk& parent, Mesh3DSMater
 	material.specular_map = NULL;
 
 	Mesh3DSChunk chunk;
-	chunk.offset = _stream->GetPosition();
+	chunk.offset = (uint32)_stream->GetPosition();
 	while (ReadNextChunk(parent, chunk))
 	{
 		switch (chunk.id)
@@ -388,7 +388,7 @@ void M3DSModelReader::ReadTextureChunk(const Mesh3DSChunk& parent, Mesh3DSTextur
 	int16 temp;
 
 	Mesh3DSChunk chunk;
-	chunk.offset = _stream->GetPosition();
+	chunk.offset = (uint32)_stream->GetPosition();
 	while (ReadNextChunk(parent, chunk))
 	{
 		switch (chunk.id)
@@ -450,7 +450,7 @@ void M3DSModelReader::ReadObjectChunk(const Mesh3DSChunk& parent, Mesh3DSEditor&
 	String name = ReadString();
 
 	Mesh3DSChunk chunk;
-	chunk.offset = _stream->GetPosition();
+	chunk.offset = (uint32)_stream->GetPosition();
 	ReadNextChunk(parent, chunk);
 	switch (chunk.id)
 	{
@@ -493,7 +493,7 @@ void M3DSModelReader::ReadMeshChunk(const Mesh3DSChunk& parent, Mesh3DSMesh& mes
 	mesh.faces = NULL;
 
 	Mesh3DSChunk chunk;
-	chunk.offset = _stream->GetPosition();
+	chunk.offset = (uint32)_stream->GetPosition();
 	while (ReadNextChunk(parent, chunk))
 	{
 		switch (chunk.id)
@@ -576,7 +576,7 @@ void M3DSModelReader::ReadMeshFaceChunk(const Mesh3DSChunk& parent, Mesh3DSMesh&
 	int16 index;
 
 	Mesh3DSChunk chunk;
-	chunk.offset = _stream->GetPosition();
+	chunk.offset = (uint32)_stream->GetPosition();
 	while (ReadNextChunk(parent, chunk))
 	{
 		switch (chunk.id)
@@ -619,7 +619,7 @@ void M3DSModelReader::ReadCameraChunk(const Mesh3DSChunk& parent, Mesh3DSCamera&
 	camera.fov = 2400.0f / fov;
 
 	Mesh3DSChunk chunk;
-	chunk.offset = _stream->GetPosition();
+	chunk.offset = (uint32)_stream->GetPosition();
 	while (ReadNextChunk(parent, chunk))
 	{
 		switch (chunk.id)
@@ -661,7 +661,7 @@ void M3DSModelReader::ReadLightChunk(const Mesh3DSChunk& parent, Mesh3DSLight& l
 	light.position = ReadVector3();
 
 	Mesh3DSChunk chunk;
-	chunk.offset = _stream->GetPosition();
+	chunk.offset = (uint32)_stream->GetPosition();
 	while (ReadNextChunk(parent, chunk))
 	{
 		switch (chunk.id)
@@ -703,7 +703,7 @@ void M3DSModelReader::ReadSpotlightChunk(const Mesh3DSChunk& parent, Mesh3DSLigh
 	*_stream >> light.fall_off;
 
 	Mesh3DSChunk chunk;
-	chunk.offset = _stream->GetPosition();
+	chunk.offset = (uint32)_stream->GetPosition();
 	while (ReadNextChunk(parent, chunk))
 	{
 		switch (chunk.id)
@@ -752,7 +752,7 @@ void M3DSModelReader::ReadKeyframerChunk(const Mesh3DSChunk& parent, Mesh3DSKeyf
 	Mesh3DSNode* node;
 
 	Mesh3DSChunk chunk;
-	chunk.offset = _stream->GetPosition();
+	chunk.offset = (uint32)_stream->GetPosition();
 	while (ReadNextChunk(parent, chunk))
 	{
 		switch (chunk.id)
@@ -804,7 +804,7 @@ void M3DSModelReader::ReadKeyframerChunk(const Mesh3DSChunk& parent, Mesh3DSKeyf
 void M3DSModelReader::ReadNodeChunk(const Mesh3DSChunk& parent, Mesh3DSNode& node)
 {
 	Mesh3DSChunk chunk;
-	chunk.offset = _stream->GetPosition();
+	chunk.offset = (uint32)_stream->GetPosition();
 	while (ReadNextChunk(parent, chunk))
 	{
 		switch (chunk.id)
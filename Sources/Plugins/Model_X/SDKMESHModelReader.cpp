@@ -146,8 +146,8 @@ Model* SDKMESHModelReader::LoadModel(Stream& stream, ModelReaderOptions* options
 	_fileName = ((FileStream*)&stream)->GetFileName();
 	_path = Path::GetDirectoryName(_fileName);
 
-	_sdkmesh.m_pStaticMeshData = new BYTE[stream.GetLength()];
-	stream.Read(_sdkmesh.m_pStaticMeshData, stream.GetLength());
+	_sdkmesh.m_pStaticMeshData = new BYTE[(int32)stream.GetLength()];
+	stream.Read(_sdkmesh.m_pStaticMeshData, (int32)stream.GetLength());
 
 	if (!ReadModel())
 	{
@@ -218,7 +218,7 @@ void XATGModelReader::ProcessRootData()
 			SE_LOGERROR("Could not find physical memory blob file.");
 			return;
 		}
-		uint32 length = stream->GetLength();
+		uint32 length = (uint32)stream->GetLength();
 		SE_ASSERT(length > 0);
 		_binaryBlobData = new SEbyte[length];
 		stream->Read(_binaryBlobData, length);
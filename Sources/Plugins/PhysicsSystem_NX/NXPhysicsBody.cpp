@@ -143,6 +143,8 @@ void NXPhysicsBody::CreateFromShapes()
 		actorDesc.body = &bodyDesc;
 	}
 
+	// The body is retrieved from the actor by the queries of the scene
+	actorDesc.userData = (IBody*)this;
 	_NxActor = _Scene->GetNxScene()->createActor(actorDesc);
 }
 
@@ -214,4 +214,154 @@ void NXPhysicsScene::Update(real64 elapsed)
 	_NxScene->fetchResults(NX_RIGID_BODY_FINISHED, true);
 }
 
+/// Builds a hit of a query from a shape of the SDK.
+static void _MakeHit(NxShape* shape, const NxVec3& position, const NxVec3& normal, real distance, const Vector3& direction, RaycastHit& hit)
+{
+	IBody* body = (IBody*)shape->getActor().userData;
+	hit._Body = body;
+	hit._Shape = (body == NULL || body->Shapes().IsEmpty() ? NULL : body->Shapes()[0].Get());
+	hit._Position = NXHelper::MakeVector3(position);
+	hit._Normal = NXHelper::MakeVector3(normal);
+	hit._Distance = distance;
+
+	if (Vector3::Dot(hit._Normal, direction) > 0.0)
+		hit._Normal = -hit._Normal;
+}
+
+/// Adds the hits of a ray sorted by distance.
+class RaycastReport : public NxUserRaycastReport
+{
+public:
+	BaseArray<RaycastHit>* Hits;
+	Vector3 Direction;
+	int First;
+
+	virtual bool onHit(const NxRaycastHit& rayHit)
+	{
+		RaycastHit hit;
+		_MakeHit(rayHit.shape, rayHit.worldImpact, rayHit.worldNormal, rayHit.distance, Direction, hit);
+		if (hit._Body == NULL)
+			return true;
+
+		Hits->Add(hit);
+		int index = Hits->Count() - 1;
+		while (index > First && (*Hits)[index - 1]._Distance > hit._Distance)
+		{
+			(*Hits)[index] = (*Hits)[index - 1];
+			index--;
+		}
+		(*Hits)[index] = hit;
+		return true;
+	}
+};
+
+/// Adds the bodies of the shapes overlapping a box.
+class OverlapReport : public NxUserEntityReport<NxShape*>
+{
+public:
+	BaseArray<IBody*>* Bodies;
+	int Count;
+
+	virtual bool onEvent(NxU32 nbEntities, NxShape** entities)
+	{
+		for (NxU32 i=0; i<nbEntities; ++i)
+		{
+			IBody* body = (IBody*)entities[i]->getActor().userData;
+			if (body != NULL)
+			{
+				Bodies->Add(body);
+				Count++;
+			}
+		}
+		return true;
+	}
+};
+
+bool NXPhysicsScene::Raycast(const Ray3& ray, real maxDistance, RaycastHit& hit) const
+{
+	if (_NxScene == NULL)
+		return false;
+
+	Vector3 direction = Vector3::Normalize(ray.Direction);
+	NxRay nxRay(NXHelper::MakeVector3(ray.Origin), NXHelper::MakeVector3(direction));
+
+	NxRaycastHit rayHit;
+	NxShape* shape = _NxScene->raycastClosestShape(nxRay, NX_ALL_SHAPES, rayHit, 0xffffffff, maxDistance);
+	if (shape == NULL)
+		return false;
+
+	_MakeHit(shape, rayHit.worldImpact, rayHit.worldNormal, rayHit.distance, direction, hit);
+	return (hit._Body != NULL);
+}
+
+int NXPhysicsScene::RaycastAll(const Ray3& ray, real maxDistance, BaseArray<RaycastHit>& hits) const
+{
+	if (_NxScene == NULL)
+		return 0;
+
+	Vector3 direction = Vector3::Normalize(ray.Direction);
+	NxRay nxRay(NXHelper::MakeVector3(ray.Origin), NXHelper::MakeVector3(direction));
+
+	RaycastReport report;
+	report.Hits = &hits;
+	report.Direction = direction;
+	report.First = hits.Count();
+	_NxScene->raycastAllShapes(nxRay, report, NX_ALL_SHAPES, 0xffffffff, maxDistance);
+	return hits.Count() - report.First;
+}
+
+bool NXPhysicsScene::SweepSphere(const BoundingSphere& sphere, const Vector3& direction, real maxDistance, RaycastHit& hit) const
+{
+	if (_NxScene == NULL)
+		return false;
+
+	// A sphere is a capsule of which the segment is a point
+	NxVec3 center = NXHelper::MakeVector3(sphere.Center);
+	NxCapsule capsule(NxSegment(center, center), sphere.Radius);
+	Vector3 motion = Vector3::Normalize(direction);
+
+	NxSweepQueryHit sweepHit;
+	NxU32 count = _NxScene->linearCapsuleSweep(capsule, NXHelper::MakeVector3(motion * maxDistance),
+		NX_SF_STATICS | NX_SF_DYNAMICS, NULL, 1, &sweepHit, NULL);
+	if (count == 0 || sweepHit.hitShape == NULL)
+		return false;
+
+	_MakeHit(sweepHit.hitShape, sweepHit.point, sweepHit.normal, sweepHit.t * maxDistance, motion, hit);
+	return (hit._Body != NULL);
+}
+
+bool NXPhysicsScene::SweepBox(const OBB& box, const Vector3& direction, real maxDistance, RaycastHit& hit) const
+{
+	if (_NxScene == NULL)
+		return false;
+
+	NxBox nxBox(NXHelper::MakeVector3(box.Center), NXHelper::MakeVector3(box.Extents),
+		NXHelper::MakeMatrix33(box.Rotation));
+	Vector3 motion = Vector3::Normalize(direction);
+
+	NxSweepQueryHit sweepHit;
+	NxU32 count = _NxScene->linearOBBSweep(nxBox, NXHelper::MakeVector3(motion * maxDistance),
+		NX_SF_STATICS | NX_SF_DYNAMICS, NULL, 1, &sweepHit, NULL);
+	if (count == 0 || sweepHit.hitShape == NULL)
+		return false;
+
+	_MakeHit(sweepHit.hitShape, sweepHit.point, sweepHit.normal, sweepHit.t * maxDistance, motion, hit);
+	return (hit._Body != NULL);
+}
+
+int NXPhysicsScene::OverlapAABB(const AABB& box, BaseArray<IBody*>& bodies) const
+{
+	if (_NxScene == NULL)
+		return 0;
+
+	NxBounds3 bounds;
+	bounds.set(NXHelper::MakeVector3(box.Min), NXHelper::MakeVector3(box.Max));
+
+	OverlapReport report;
+	report.Bodies = &bodies;
+	report.Count = 0;
+	_NxScene->overlapAABBShapes(bounds, NX_ALL_SHAPES, 0, NULL, &report);
+	return report.Count;
+}
+
 }
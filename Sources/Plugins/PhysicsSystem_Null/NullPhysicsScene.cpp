@@ -144,4 +144,30 @@ void NullPhysicsScene::Update(real64 elapsed)
 	}
 }
 
+bool NullPhysicsScene::Raycast(const Ray3& ray, real maxDistance, RaycastHit& hit) const
+{
+	// The bodies of the null scene have no collision geometry
+	return false;
+}
+
+int NullPhysicsScene::RaycastAll(const Ray3& ray, real maxDistance, BaseArray<RaycastHit>& hits) const
+{
+	return 0;
+}
+
+bool NullPhysicsScene::SweepSphere(const BoundingSphere& sphere, const Vector3& direction, real maxDistance, RaycastHit& hit) const
+{
+	return false;
+}
+
+bool NullPhysicsScene::SweepBox(const OBB& box, const Vector3& direction, real maxDistance, RaycastHit& hit) const
+{
+	return false;
+}
+
+int NullPhysicsScene::OverlapAABB(const AABB& box, BaseArray<IBody*>& bodies) const
+{
+	return 0;
+}
+
 }
@@ -54,6 +54,12 @@ public:
 
 	virtual void Update(real64 elapsed);
 
+	virtual bool Raycast(const Ray3& ray, real maxDistance, RaycastHit& hit) const;
+	virtual int RaycastAll(const Ray3& ray, real maxDistance, BaseArray<RaycastHit>& hits) const;
+	virtual bool SweepSphere(const BoundingSphere& sphere, const Vector3& direction, real maxDistance, RaycastHit& hit) const;
+	virtual bool SweepBox(const OBB& box, const Vector3& direction, real maxDistance, RaycastHit& hit) const;
+	virtual int OverlapAABB(const AABB& box, BaseArray<IBody*>& bodies) const;
+
 protected:
 	Array<BodyPtr> _Bodies;
 	Dictionary<MaterialIndex, MaterialPtr> _Materials;
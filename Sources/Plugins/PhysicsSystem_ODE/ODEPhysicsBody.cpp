@@ -127,6 +127,12 @@ void ODEPhysicsBody::CreateFromShapes()
 	default:
 		return;
 	}
+
+	// The scene queries find the body of the geometries
+	if (_GeomID != NULL)
+	{
+		dGeomSetData(_GeomID, this);
+	}
 }
 
 Vector3 ODEPhysicsBody::GetPosition() const
@@ -180,4 +180,249 @@ void ODEPhysicsScene::Update(real64 elapsed)
 	dWorldStep(_WorldID, elapsed);
 }
 
+/// Maximum number of contacts between the query and a geometry.
+static const int MaxQueryContacts = 8;
+
+/// Number of bisection steps of the sweeps.
+static const int SweepIterations = 12;
+
+static void _QueryCallback(void* data, dGeomID o1, dGeomID o2)
+{
+	if (dGeomIsSpace(o1) || dGeomIsSpace(o2))
+	{
+		dSpaceCollide2(o1, o2, data, &_QueryCallback);
+		return;
+	}
+
+	// The query geometry is the first one, it is not in the space
+	BaseArray<RaycastHit>* hits = (BaseArray<RaycastHit>*)data;
+	IBody* body = (IBody*)dGeomGetData(o2);
+	if (body == NULL)
+		return;
+
+	dContactGeom contacts[MaxQueryContacts];
+	int count = dCollide(o1, o2, MaxQueryContacts, contacts, sizeof(dContactGeom));
+	if (count == 0)
+		return;
+
+	// Keeps the deepest contact, or the closest one for the rays
+	int best = 0;
+	for (int i=1; i<count; ++i)
+	{
+		bool isBetter = (dGeomGetClass(o1) == dRayClass ?
+			contacts[i].depth < contacts[best].depth : contacts[i].depth > contacts[best].depth);
+		if (isBetter)
+			best = i;
+	}
+
+	RaycastHit hit;
+	hit._Body = body;
+	hit._Shape = (body->Shapes().IsEmpty() ? NULL : body->Shapes()[0].Get());
+	hit._Position = ODEHelper::MakeVector3(contacts[best].pos);
+	hit._Normal = ODEHelper::MakeVector3(contacts[best].normal);
+	hit._Distance = contacts[best].depth;
+	hits->Add(hit);
+}
+
+void ODEPhysicsScene::Collide(dGeomID geom, BaseArray<RaycastHit>& hits) const
+{
+	dSpaceCollide2(geom, (dGeomID)_SpaceID, &hits, &_QueryCallback);
+}
+
+bool ODEPhysicsScene::RaycastClosest(dGeomID rayGeom, const Ray3& ray, real maxDistance, RaycastHit& hit) const
+{
+	Vector3 direction = Vector3::Normalize(ray.Direction);
+	dGeomRaySetLength(rayGeom, maxDistance);
+	dGeomRaySet(rayGeom, ray.Origin.X, ray.Origin.Y, ray.Origin.Z, direction.X, direction.Y, direction.Z);
+
+	BaseArray<RaycastHit> hits;
+	Collide(rayGeom, hits);
+
+	// The depth of the ray contacts is the distance from the origin
+	int count = hits.Count();
+	for (int i=0; i<count; ++i)
+	{
+		if (i == 0 || hits[i]._Distance < hit._Distance)
+			hit = hits[i];
+	}
+
+	if (count > 0 && Vector3::Dot(hit._Normal, direction) > 0.0)
+		hit._Normal = -hit._Normal;
+	return (count > 0);
+}
+
+bool ODEPhysicsScene::Raycast(const Ray3& ray, real maxDistance, RaycastHit& hit) const
+{
+	MutexLocker locker(&_QueryLock);
+	dGeomID rayGeom = dCreateRay(0, maxDistance);
+	bool isHit = RaycastClosest(rayGeom, ray, maxDistance, hit);
+	dGeomDestroy(rayGeom);
+	return isHit;
+}
+
+int ODEPhysicsScene::RaycastAll(const Ray3& ray, real maxDistance, BaseArray<RaycastHit>& hits) const
+{
+	MutexLocker locker(&_QueryLock);
+	Vector3 direction = Vector3::Normalize(ray.Direction);
+	dGeomID rayGeom = dCreateRay(0, maxDistance);
+	dGeomRaySet(rayGeom, ray.Origin.X, ray.Origin.Y, ray.Origin.Z, direction.X, direction.Y, direction.Z);
+
+	BaseArray<RaycastHit> rayHits;
+	Collide(rayGeom, rayHits);
+	dGeomDestroy(rayGeom);
+
+	// Sorted by distance
+	int first = hits.Count();
+	int count = rayHits.Count();
+	for (int i=0; i<count; ++i)
+	{
+		RaycastHit& hit = rayHits[i];
+		if (Vector3::Dot(hit._Normal, direction) > 0.0)
+			hit._Normal = -hit._Normal;
+
+		hits.Add(hit);
+		int index = hits.Count() - 1;
+		while (index > first && hits[index - 1]._Distance > hit._Distance)
+		{
+			hits[index] = hits[index - 1];
+			index--;
+		}
+		hits[index] = hit;
+	}
+
+	return count;
+}
+
+bool ODEPhysicsScene::Sweep(dGeomID geom, const Vector3& start, const Vector3& direction, real maxDistance, real step, RaycastHit& hit) const
+{
+	BaseArray<RaycastHit> hits;
+	real free = 0.0;
+	real distance = 0.0;
+
+	// Finds a position overlapping a geometry
+	while (true)
+	{
+		Vector3 position = start + direction * distance;
+		dGeomSetPosition(geom, position.X, position.Y, position.Z);
+
+		hits.Clear();
+		Collide(geom, hits);
+		if (!hits.IsEmpty())
+			break;
+
+		if (distance >= maxDistance)
+			return false;
+
+		free = distance;
+		distance = Math::Min(distance + step, maxDistance);
+	}
+
+	if (distance == 0.0)
+	{
+		hit = hits[0];
+		hit._Position = start;
+		hit._Normal = -direction;
+		hit._Distance = 0.0;
+		return true;
+	}
+
+	// Bisection between the last free position and the overlapping one
+	BaseArray<RaycastHit> overlapHits = hits;
+	for (int i=0; i<SweepIterations; ++i)
+	{
+		real middle = (free + distance) * 0.5f;
+		Vector3 position = start + direction * middle;
+		dGeomSetPosition(geom, position.X, position.Y, position.Z);
+
+		hits.Clear();
+		Collide(geom, hits);
+		if (hits.IsEmpty())
+		{
+			free = middle;
+		}
+		else
+		{
+			distance = middle;
+			overlapHits = hits;
+		}
+	}
+
+	hit = overlapHits[0];
+	for (int i=1; i<overlapHits.Count(); ++i)
+	{
+		if (overlapHits[i]._Distance < hit._Distance)
+			hit = overlapHits[i];
+	}
+	if (Vector3::Dot(hit._Normal, direction) > 0.0)
+		hit._Normal = -hit._Normal;
+	hit._Distance = free;
+	return true;
+}
+
+bool ODEPhysicsScene::SweepSphere(const BoundingSphere& sphere, const Vector3& direction, real maxDistance, RaycastHit& hit) const
+{
+	MutexLocker locker(&_QueryLock);
+	dGeomID geom = dCreateSphere(0, sphere.Radius);
+	bool isHit = Sweep(geom, sphere.Center, Vector3::Normalize(direction), maxDistance, sphere.Radius, hit);
+	dGeomDestroy(geom);
+	return isHit;
+}
+
+bool ODEPhysicsScene::SweepBox(const OBB& box, const Vector3& direction, real maxDistance, RaycastHit& hit) const
+{
+	MutexLocker locker(&_QueryLock);
+	dGeomID geom = dCreateBox(0, box.Extents.X * 2.0f, box.Extents.Y * 2.0f, box.Extents.Z * 2.0f);
+
+	dMatrix3 rotation;
+	for (int i=0; i<3; ++i)
+	{
+		rotation[i*4+0] = box.Rotation.M[i][0];
+		rotation[i*4+1] = box.Rotation.M[i][1];
+		rotation[i*4+2] = box.Rotation.M[i][2];
+		rotation[i*4+3] = 0.0;
+	}
+	dGeomSetRotation(geom, rotation);
+
+	real step = Math::Min(box.Extents.X, Math::Min(box.Extents.Y, box.Extents.Z));
+	bool isHit = Sweep(geom, box.Center, Vector3::Normalize(direction), maxDistance, step, hit);
+	dGeomDestroy(geom);
+	return isHit;
+}
+
+int ODEPhysicsScene::OverlapAABB(const AABB& box, BaseArray<IBody*>& bodies) const
+{
+	MutexLocker locker(&_QueryLock);
+	Vector3 center = box.GetCenter();
+	Vector3 dimensions = box.GetDimensions();
+	dGeomID geom = dCreateBox(0, dimensions.X, dimensions.Y, dimensions.Z);
+	dGeomSetPosition(geom, center.X, center.Y, center.Z);
+
+	BaseArray<RaycastHit> hits;
+	Collide(geom, hits);
+	dGeomDestroy(geom);
+
+	int count = hits.Count();
+	for (int i=0; i<count; ++i)
+	{
+		bodies.Add(hits[i]._Body);
+	}
+	return count;
+}
+
+void ODEPhysicsScene::RaycastBatch(RaycastQuery* queries, int count) const
+{
+	if (queries == NULL || count <= 0)
+		return;
+
+	// The collision functions of ODE are not reentrant, the rays are cast by the calling thread
+	MutexLocker locker(&_QueryLock);
+	dGeomID rayGeom = dCreateRay(0, 1.0);
+	for (int i=0; i<count; ++i)
+	{
+		RaycastQuery& query = queries[i];
+		query._HasHit = RaycastClosest(rayGeom, query._Ray, query._MaxDistance, query._Hit);
+	}
+	dGeomDestroy(rayGeom);
+}
+
 }
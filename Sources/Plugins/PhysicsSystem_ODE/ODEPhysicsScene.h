@@ -54,10 +54,33 @@ public:
 
 	virtual void Update(real64 elapsed);
 
+	virtual bool Raycast(const Ray3& ray, real maxDistance, RaycastHit& hit) const;
+	virtual int RaycastAll(const Ray3& ray, real maxDistance, BaseArray<RaycastHit>& hits) const;
+	virtual bool SweepSphere(const BoundingSphere& sphere, const Vector3& direction, real maxDistance, RaycastHit& hit) const;
+	virtual bool SweepBox(const OBB& box, const Vector3& direction, real maxDistance, RaycastHit& hit) const;
+	virtual int OverlapAABB(const AABB& box, BaseArray<IBody*>& bodies) const;
+	virtual void RaycastBatch(RaycastQuery* queries, int count) const;
+
 	ODEPhysicsSystem* GetPhysicsSystem() const { return _PhysicsSystem; }
 	dWorldID GetWorldID() const { return _WorldID; }
 	dSpaceID GetSpaceID() const { return _SpaceID; }
 
+protected:
+	/**
+		Collides a geometry that is not in the space with the geometries of the space.
+		@param hits The list where the deepest contact with each body is added.
+	*/
+	void Collide(dGeomID geom, BaseArray<RaycastHit>& hits) const;
+
+	/**
+		Moves a geometry by steps until it touches a geometry of the space,
+		then finds the distance of the contact by bisection.
+		@param step The length of the steps, smaller than the geometry.
+	*/
+	bool Sweep(dGeomID geom, const Vector3& start, const Vector3& direction, real maxDistance, real step, RaycastHit& hit) const;
+
+	bool RaycastClosest(dGeomID rayGeom, const Ray3& ray, real maxDistance, RaycastHit& hit) const;
+
 protected:
 	ODEPhysicsSystem* _PhysicsSystem;
 	SceneDescription _Description;
@@ -65,6 +88,9 @@ protected:
 	dSpaceID _SpaceID;
 	dJointGroupID _CollisionJointGroup;
 
+	/// The collision functions of ODE are not reentrant, the queries are serialized.
+	mutable Mutex _QueryLock;
+
 	Array<BodyPtr> _Bodies;
 	Dictionary<MaterialIndex, MaterialPtr> _Materials;
 	MaterialIndex _DefaultMaterial;
@@ -185,4 +185,42 @@ void RWPhysicsScene::Update(real64 elapsed)
 		return;
 }
 
+// The collision queries of the SDK are not exposed by this plugin,
+// the queries of the scene report that they are not supported
+static void _QueryNotSupported(const String& source)
+{
+	Logger::Current()->Log(LogLevel::Warning, source,
+		_T("The collision queries are not supported by the RenderWare physics system."));
+}
+
+bool RWPhysicsScene::Raycast(const Ray3& ray, real maxDistance, RaycastHit& hit) const
+{
+	_QueryNotSupported(_T("RWPhysicsScene.Raycast"));
+	return false;
+}
+
+int RWPhysicsScene::RaycastAll(const Ray3& ray, real maxDistance, BaseArray<RaycastHit>& hits) const
+{
+	_QueryNotSupported(_T("RWPhysicsScene.RaycastAll"));
+	return 0;
+}
+
+bool RWPhysicsScene::SweepSphere(const BoundingSphere& sphere, const Vector3& direction, real maxDistance, RaycastHit& hit) const
+{
+	_QueryNotSupported(_T("RWPhysicsScene.SweepSphere"));
+	return false;
+}
+
+bool RWPhysicsScene::SweepBox(const OBB& box, const Vector3& direction, real maxDistance, RaycastHit& hit) const
+{
+	_QueryNotSupported(_T("RWPhysicsScene.SweepBox"));
+	return false;
+}
+
+int RWPhysicsScene::OverlapAABB(const AABB& box, BaseArray<IBody*>& bodies) const
+{
+	_QueryNotSupported(_T("RWPhysicsScene.OverlapAABB"));
+	return 0;
+}
+
 }
@@ -0,0 +1,581 @@
+/*=============================================================================
+BroadPhase.cpp
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+#include "BroadPhase.h"
+
+namespace SE_Software
+{
+
+const int32 BroadPhase::NullProxy = -1;
+
+BroadPhase::BroadPhase(bool useBounds) :
+	_UseBounds(useBounds),
+	_FreeProxy(NullProxy)
+{
+}
+
+BroadPhase::~BroadPhase()
+{
+}
+
+BroadPhase* BroadPhase::Create(BroadPhaseType type)
+{
+	switch (type)
+	{
+	case BroadPhaseType_None:
+		return new AllPairsBroadPhase();
+
+	case BroadPhaseType_SweepAndPrune:
+		return new SweepAndPruneBroadPhase();
+
+	case BroadPhaseType_AABBTree:
+	default:
+		return new TreeBroadPhase();
+	}
+}
+
+int32 BroadPhase::CreateProxy(const AABB& box, void* userData, bool isStatic)
+{
+	int32 proxy;
+	if (_FreeProxy != NullProxy)
+	{
+		proxy = _FreeProxy;
+		_FreeProxy = _Proxies[proxy]._Next;
+	}
+	else
+	{
+		proxy = _Proxies.Count();
+		_Proxies.Add(Proxy());
+	}
+
+	Proxy& data = _Proxies[proxy];
+	data._Box = box;
+	data._UserData = userData;
+	data._Next = NullProxy;
+	data._Internal = NullProxy;
+	data._IsStatic = isStatic;
+	data._IsUnbounded = (!_UseBounds || box.IsEmpty());
+	data._IsDestroyed = false;
+
+	if (data._IsUnbounded)
+	{
+		_UnboundedProxies.Add(proxy);
+	}
+	else
+	{
+		OnCreateProxy(proxy);
+	}
+
+	// The pairs with the proxies without box are added by the next update
+	_PendingProxies.Add(proxy);
+
+	return proxy;
+}
+
+void BroadPhase::DestroyProxy(int32 proxy)
+{
+	SE_ASSERT(proxy >= 0 && proxy < _Proxies.Count() && !_Proxies[proxy]._IsDestroyed);
+
+	Proxy& data = _Proxies[proxy];
+	if (data._IsUnbounded)
+	{
+		RemoveUnboundedProxy(proxy);
+	}
+	else
+	{
+		OnDestroyProxy(proxy);
+	}
+
+	// The proxy is freed after its pairs are removed
+	data._IsDestroyed = true;
+	_DestroyedProxies.Add(proxy);
+}
+
+void BroadPhase::MoveProxy(int32 proxy, const AABB& box)
+{
+	SE_ASSERT(proxy >= 0 && proxy < _Proxies.Count() && !_Proxies[proxy]._IsDestroyed);
+
+	Proxy& data = _Proxies[proxy];
+	data._Box = box;
+
+	if (!_UseBounds)
+	{
+		return;
+	}
+
+	bool isUnbounded = box.IsEmpty();
+	if (isUnbounded == data._IsUnbounded)
+	{
+		if (!isUnbounded)
+		{
+			OnMoveProxy(proxy);
+		}
+	}
+	else if (isUnbounded)
+	{
+		OnDestroyProxy(proxy);
+		data._IsUnbounded = true;
+		_UnboundedProxies.Add(proxy);
+		_PendingProxies.Add(proxy);
+	}
+	else
+	{
+		// The pairs with the bounded proxies are removed by the next update if they don't overlap
+		RemoveUnboundedProxy(proxy);
+		data._IsUnbounded = false;
+		OnCreateProxy(proxy);
+	}
+}
+
+void* BroadPhase::GetUserData(int32 proxy) const
+{
+	SE_ASSERT(proxy >= 0 && proxy < _Proxies.Count());
+	return _Proxies[proxy]._UserData;
+}
+
+void BroadPhase::UpdatePairs()
+{
+	int32 i;
+
+	_AddedPairs.Clear();
+	_RemovedPairs.Clear();
+
+	// Remove the pairs that don't overlap anymore
+	for (i = _Pairs.Count() - 1; i >= 0; --i)
+	{
+		const BroadPhasePair& pair = _Pairs[i];
+		const Proxy& proxyA = _Proxies[pair._ProxyA];
+		const Proxy& proxyB = _Proxies[pair._ProxyB];
+
+		if (proxyA._IsDestroyed || proxyB._IsDestroyed)
+		{
+			RemovePairAt(i);
+		}
+		else if (!proxyA._IsUnbounded && !proxyB._IsUnbounded &&
+			!TestOverlap(pair._ProxyA, pair._ProxyB))
+		{
+			RemovePairAt(i);
+		}
+	}
+
+	// Add the pairs with the proxies without box
+	int32 pendingCount = _PendingProxies.Count();
+	for (i = 0; i < pendingCount; ++i)
+	{
+		int32 proxy = _PendingProxies[i];
+		const Proxy& data = _Proxies[proxy];
+		if (data._IsDestroyed)
+		{
+			continue;
+		}
+
+		if (data._IsUnbounded)
+		{
+			int32 proxyCount = _Proxies.Count();
+			for (int32 j = 0; j < proxyCount; ++j)
+			{
+				AddPair(proxy, j);
+			}
+		}
+		else
+		{
+			int32 unboundedCount = _UnboundedProxies.Count();
+			for (int32 j = 0; j < unboundedCount; ++j)
+			{
+				AddPair(proxy, _UnboundedProxies[j]);
+			}
+		}
+	}
+	_PendingProxies.Clear();
+
+	FindPairs();
+
+	// Free the destroyed proxies
+	int32 destroyedCount = _DestroyedProxies.Count();
+	for (i = 0; i < destroyedCount; ++i)
+	{
+		int32 proxy = _DestroyedProxies[i];
+		_Proxies[proxy]._UserData = NULL;
+		_Proxies[proxy]._Next = _FreeProxy;
+		_FreeProxy = proxy;
+	}
+	_DestroyedProxies.Clear();
+}
+
+void BroadPhase::Query(const AABB& box, BaseArray<void*>& result) const
+{
+	int32 unboundedCount = _UnboundedProxies.Count();
+	for (int32 i = 0; i < unboundedCount; ++i)
+	{
+		result.Add(_Proxies[_UnboundedProxies[i]]._UserData);
+	}
+
+	QueryBounded(box, result);
+}
+
+void BroadPhase::Raycast(const Ray3& ray, real maxDistance, RaycastFunction function, void* context) const
+{
+	// The proxies without box, like the planes, are likely to shorten the ray
+	int32 unboundedCount = _UnboundedProxies.Count();
+	for (int32 i = 0; i < unboundedCount; ++i)
+	{
+		real result = function(_Proxies[_UnboundedProxies[i]]._UserData, ray, maxDistance, context);
+		if (result < 0.0)
+		{
+			return;
+		}
+		maxDistance = Math::Min(maxDistance, result);
+	}
+
+	RaycastBounded(ray, maxDistance, function, context);
+}
+
+void BroadPhase::QueryBounded(const AABB& box, BaseArray<void*>& result) const
+{
+	int32 proxyCount = _Proxies.Count();
+	for (int32 i = 0; i < proxyCount; ++i)
+	{
+		const Proxy& data = _Proxies[i];
+		if (!data._IsDestroyed && !data._IsUnbounded && data._Box.Intersects(box))
+		{
+			result.Add(data._UserData);
+		}
+	}
+}
+
+void BroadPhase::RaycastBounded(const Ray3& ray, real maxDistance, RaycastFunction function, void* context) const
+{
+	int32 proxyCount = _Proxies.Count();
+	for (int32 i = 0; i < proxyCount; ++i)
+	{
+		const Proxy& data = _Proxies[i];
+		real distance;
+		if (!data._IsDestroyed && !data._IsUnbounded &&
+			data._Box.Intersects(ray, distance) && distance <= maxDistance)
+		{
+			real result = function(data._UserData, ray, maxDistance, context);
+			if (result < 0.0)
+			{
+				return;
+			}
+			maxDistance = Math::Min(maxDistance, result);
+		}
+	}
+}
+
+void BroadPhase::AddPair(int32 proxyA, int32 proxyB)
+{
+	if (proxyA == proxyB)
+	{
+		return;
+	}
+
+	const Proxy& dataA = _Proxies[proxyA];
+	const Proxy& dataB = _Proxies[proxyB];
+	if (dataA._IsDestroyed || dataB._IsDestroyed || (dataA._IsStatic && dataB._IsStatic))
+	{
+		return;
+	}
+
+	if (proxyA > proxyB)
+	{
+		SE_Swap(proxyA, proxyB);
+	}
+
+	uint64 key = GetPairKey(proxyA, proxyB);
+	if (_PairIndices.Find(key) != NULL)
+	{
+		return;
+	}
+
+	BroadPhasePair pair;
+	pair._ProxyA = proxyA;
+	pair._ProxyB = proxyB;
+
+	_PairIndices.Add(key, _Pairs.Count());
+	_Pairs.Add(pair);
+	_AddedPairs.Add(pair);
+}
+
+void BroadPhase::RemovePairAt(int32 index)
+{
+	BroadPhasePair pair = _Pairs[index];
+	_PairIndices.Remove(GetPairKey(pair._ProxyA, pair._ProxyB));
+	_RemovedPairs.Add(pair);
+
+	// The last pair is moved to the removed index
+	int32 last = _Pairs.Count() - 1;
+	if (index != last)
+	{
+		const BroadPhasePair& moved = _Pairs[last];
+		_Pairs[index] = moved;
+		*_PairIndices.Find(GetPairKey(moved._ProxyA, moved._ProxyB)) = index;
+	}
+	_Pairs.RemoveAt(last);
+}
+
+void BroadPhase::RemoveUnboundedProxy(int32 proxy)
+{
+	int32 count = _UnboundedProxies.Count();
+	for (int32 i = 0; i < count; ++i)
+	{
+		if (_UnboundedProxies[i] == proxy)
+		{
+			_UnboundedProxies[i] = _UnboundedProxies[count - 1];
+			_UnboundedProxies.RemoveAt(count - 1);
+			return;
+		}
+	}
+}
+
+uint64 BroadPhase::GetPairKey(int32 proxyA, int32 proxyB)
+{
+	return ((uint64)(uint32)proxyA << 32) | (uint64)(uint32)proxyB;
+}
+
+
+AllPairsBroadPhase::AllPairsBroadPhase() :
+	BroadPhase(false)
+{
+}
+
+
+TreeBroadPhase::TreeBroadPhase() :
+	BroadPhase(true)
+{
+}
+
+void TreeBroadPhase::OnCreateProxy(int32 proxy)
+{
+	Proxy& data = GetProxy(proxy);
+	data._Internal = _Tree.CreateProxy(data._Box, (void*)(SEptr)proxy);
+	_MovedProxies.Add(proxy);
+}
+
+void TreeBroadPhase::OnDestroyProxy(int32 proxy)
+{
+	Proxy& data = GetProxy(proxy);
+	_Tree.DestroyProxy(data._Internal);
+	data._Internal = NullProxy;
+}
+
+void TreeBroadPhase::OnMoveProxy(int32 proxy)
+{
+	const Proxy& data = GetProxy(proxy);
+	if (_Tree.MoveProxy(data._Internal, data._Box))
+	{
+		_MovedProxies.Add(proxy);
+	}
+}
+
+bool TreeBroadPhase::TestOverlap(int32 proxyA, int32 proxyB) const
+{
+	// The pairs are kept while the enlarged boxes overlap
+	return _Tree.GetFatBox(GetProxy(proxyA)._Internal).Intersects(
+		_Tree.GetFatBox(GetProxy(proxyB)._Internal));
+}
+
+void TreeBroadPhase::QueryBounded(const AABB& box, BaseArray<void*>& result) const
+{
+	// The tree stores the proxies, they are replaced by their user data
+	int32 first = result.Count();
+	_Tree.Query(box, result);
+
+	int32 count = result.Count();
+	for (int32 i = first; i < count; ++i)
+	{
+		result[i] = GetProxy((int32)(SEptr)result[i])._UserData;
+	}
+}
+
+/// Function and data of a ray cast against the tree of a broad phase.
+struct TreeRaycastData
+{
+	const TreeBroadPhase* _BroadPhase;
+	RaycastFunction _Function;
+	void* _Context;
+};
+
+void TreeBroadPhase::RaycastBounded(const Ray3& ray, real maxDistance, RaycastFunction function, void* context) const
+{
+	TreeRaycastData data;
+	data._BroadPhase = this;
+	data._Function = function;
+	data._Context = context;
+	_Tree.Raycast(ray, maxDistance, RaycastProxy, &data);
+}
+
+real TreeBroadPhase::RaycastProxy(void* userData, const Ray3& ray, real maxDistance, void* context)
+{
+	// The tree stores the proxies, the function receives their user data
+	TreeRaycastData* data = (TreeRaycastData*)context;
+	return data->_Function(data->_BroadPhase->GetProxy((int32)(SEptr)userData)._UserData,
+		ray, maxDistance, data->_Context);
+}
+
+void TreeBroadPhase::FindPairs()
+{
+	// Only the proxies that left their enlarged box can have new pairs
+	int32 movedCount = _MovedProxies.Count();
+	for (int32 i = 0; i < movedCount; ++i)
+	{
+		int32 proxy = _MovedProxies[i];
+		const Proxy& data = GetProxy(proxy);
+		if (data._IsDestroyed || data._Internal == NullProxy)
+		{
+			continue;
+		}
+
+		_QueryResult.Clear();
+		_Tree.Query(_Tree.GetFatBox(data._Internal), _QueryResult);
+
+		int32 resultCount = _QueryResult.Count();
+		for (int32 j = 0; j < resultCount; ++j)
+		{
+			AddPair(proxy, (int32)(SEptr)_QueryResult[j]);
+		}
+	}
+
+	_MovedProxies.Clear();
+}
+
+
+/// State of a proxy in the intervals, stored in _Internal.
+enum IntervalState
+{
+	/// The proxy has no interval.
+	IntervalState_None = -1,
+
+	/// The interval of the proxy will be removed by the next update.
+	IntervalState_Removed = 0,
+
+	/// The interval of the proxy is used.
+	IntervalState_Used = 1
+};
+
+SweepAndPruneBroadPhase::SweepAndPruneBroadPhase() :
+	BroadPhase(true),
+	_Axis(0),
+	_IsSorted(true)
+{
+}
+
+bool SweepAndPruneBroadPhase::CompareIntervals(const Interval& left, const Interval& right)
+{
+	return left._Min < right._Min;
+}
+
+void SweepAndPruneBroadPhase::OnCreateProxy(int32 proxy)
+{
+	// The interval may still be in the list if the proxy lost its box since the last update
+	Proxy& data = GetProxy(proxy);
+	if (data._Internal == IntervalState_None)
+	{
+		Interval interval;
+		interval._Min = data._Box.Min[_Axis];
+		interval._Max = data._Box.Max[_Axis];
+		interval._Proxy = proxy;
+		_Intervals.Add(interval);
+		_IsSorted = false;
+	}
+	data._Internal = IntervalState_Used;
+}
+
+void SweepAndPruneBroadPhase::OnDestroyProxy(int32 proxy)
+{
+	GetProxy(proxy)._Internal = IntervalState_Removed;
+}
+
+bool SweepAndPruneBroadPhase::TestOverlap(int32 proxyA, int32 proxyB) const
+{
+	return GetProxy(proxyA)._Box.Intersects(GetProxy(proxyB)._Box);
+}
+
+void SweepAndPruneBroadPhase::FindPairs()
+{
+	int32 i, j;
+
+	// Remove the unused intervals and compute the variance of the centers
+	Vector3 sum = Vector3::Zero;
+	Vector3 sumSquares = Vector3::Zero;
+	int32 count = 0;
+	int32 intervalCount = _Intervals.Count();
+	Interval* intervals = _Intervals.Data();
+	for (i = 0; i < intervalCount; ++i)
+	{
+		int32 proxy = intervals[i]._Proxy;
+		Proxy& data = GetProxy(proxy);
+		if (data._Internal != IntervalState_Used)
+		{
+			data._Internal = IntervalState_None;
+			continue;
+		}
+
+		Vector3 center = (data._Box.Min + data._Box.Max) * (real)0.5;
+		sum += center;
+		sumSquares += center * center;
+		intervals[count++] = intervals[i];
+	}
+
+	_Intervals.Resize(count);
+	intervals = _Intervals.Data();
+
+	if (count == 0)
+	{
+		return;
+	}
+
+	// Sweep along the axis of largest variance
+	Vector3 variance = sumSquares - (sum * sum) / (real)count;
+	int32 axis = 0;
+	if (variance.Y > variance[axis])
+		axis = 1;
+	if (variance.Z > variance[axis])
+		axis = 2;
+
+	for (i = 0; i < count; ++i)
+	{
+		const AABB& box = GetProxy(intervals[i]._Proxy)._Box;
+		intervals[i]._Min = box.Min[axis];
+		intervals[i]._Max = box.Max[axis];
+	}
+
+	if (axis != _Axis || !_IsSorted)
+	{
+		_Axis = axis;
+		_IsSorted = true;
+		_Intervals.Sort(CompareIntervals);
+	}
+	else
+	{
+		// The intervals are almost sorted when the axis doesn't change and no interval was added
+		for (i = 1; i < count; ++i)
+		{
+			Interval interval = intervals[i];
+			for (j = i - 1; j >= 0 && intervals[j]._Min > interval._Min; --j)
+			{
+				intervals[j + 1] = intervals[j];
+			}
+			intervals[j + 1] = interval;
+		}
+	}
+
+	for (i = 0; i < count; ++i)
+	{
+		const Interval& interval = intervals[i];
+		const AABB& box = GetProxy(interval._Proxy)._Box;
+
+		for (j = i + 1; j < count && intervals[j]._Min <= interval._Max; ++j)
+		{
+			if (box.Intersects(GetProxy(intervals[j]._Proxy)._Box))
+			{
+				AddPair(interval._Proxy, intervals[j]._Proxy);
+			}
+		}
+	}
+}
+
+}
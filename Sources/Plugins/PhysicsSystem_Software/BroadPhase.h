@@ -0,0 +1,240 @@
+/*=============================================================================
+BroadPhase.h
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+#ifndef _SE_BROADPHASE_H_
+#define _SE_BROADPHASE_H_
+
+#include "SoftwarePhysicsSystem.h"
+
+namespace SE_Software
+{
+
+/** Pair of overlapping proxies. */
+struct BroadPhasePair
+{
+	int32 _ProxyA;
+	int32 _ProxyB;
+};
+
+/**
+	@brief Base class for the broad phase algorithms.
+
+	The broad phase keeps the pairs of overlapping proxies across the steps,
+	and reports the pairs that were added and removed by the last update.
+
+	The proxies with an empty box, like the planes, overlap every other proxy.
+	The pairs of two static proxies are never created.
+*/
+class BroadPhase
+{
+public:
+	/** Identifier of an invalid proxy. */
+	static const int32 NullProxy;
+
+public:
+	virtual ~BroadPhase();
+
+	/** Creates the broad phase of the specified type. */
+	static BroadPhase* Create(BroadPhaseType type);
+
+	/** @name Proxies. */
+	//@{
+	/**
+		Creates a proxy.
+		@param box The box of the object.
+		@param userData The data of the object.
+		@param isStatic Whether the object is static.
+		@return The identifier of the proxy.
+	*/
+	int32 CreateProxy(const AABB& box, void* userData, bool isStatic);
+
+	/**
+		Destroys a proxy.
+		Its pairs are reported as removed by the next update.
+	*/
+	void DestroyProxy(int32 proxy);
+
+	/** Sets the box of a proxy. */
+	void MoveProxy(int32 proxy, const AABB& box);
+
+	/** Gets the user data of a proxy. */
+	void* GetUserData(int32 proxy) const;
+	//@}
+
+	/** @name Pairs. */
+	//@{
+	/** Finds the overlapping pairs after the proxies were moved. */
+	void UpdatePairs();
+
+	/** Gets the overlapping pairs. */
+	const BaseArray<BroadPhasePair>& GetPairs() const { return _Pairs; }
+
+	/** Gets the pairs added by the last update. */
+	const BaseArray<BroadPhasePair>& GetAddedPairs() const { return _AddedPairs; }
+
+	/** Gets the pairs removed by the last update. */
+	const BaseArray<BroadPhasePair>& GetRemovedPairs() const { return _RemovedPairs; }
+	//@}
+
+	/** @name Queries. */
+	//@{
+	/**
+		Gets the user data of the proxies that can intersect a box.
+		The proxies without box are always returned.
+	*/
+	void Query(const AABB& box, BaseArray<void*>& result) const;
+
+	/**
+		Casts a ray against the proxies.
+		The function is called with the user data of the proxies that can intersect the segment,
+		the proxies without box are always passed first.
+	*/
+	void Raycast(const Ray3& ray, real maxDistance, RaycastFunction function, void* context) const;
+	//@}
+
+protected:
+	/// Proxy of an object. The free proxies are linked with _Next.
+	struct Proxy
+	{
+		AABB _Box;
+		void* _UserData;
+		int32 _Next;
+		int32 _Internal;
+		bool _IsStatic;
+		bool _IsUnbounded;
+		bool _IsDestroyed;
+	};
+
+	/**
+		Constructor.
+		@param useBounds false if every proxy overlaps the other proxies.
+	*/
+	BroadPhase(bool useBounds);
+
+	/** Adds a pair, if it doesn't exist yet. */
+	void AddPair(int32 proxyA, int32 proxyB);
+
+	Proxy& GetProxy(int32 proxy) { return _Proxies[proxy]; }
+	const Proxy& GetProxy(int32 proxy) const { return _Proxies[proxy]; }
+
+	/** Called when a proxy with a box is created or gets a box. */
+	virtual void OnCreateProxy(int32 proxy) = 0;
+
+	/** Called when a proxy with a box is destroyed or loses its box. */
+	virtual void OnDestroyProxy(int32 proxy) = 0;
+
+	/** Called when a proxy with a box is moved. */
+	virtual void OnMoveProxy(int32 proxy) = 0;
+
+	/** Determines whether the existing pair of two proxies with a box still overlaps. */
+	virtual bool TestOverlap(int32 proxyA, int32 proxyB) const = 0;
+
+	/** Adds the new pairs of proxies with a box. */
+	virtual void FindPairs() = 0;
+
+	/** Adds the proxies with a box that can intersect a box. The default implementation tests every proxy. */
+	virtual void QueryBounded(const AABB& box, BaseArray<void*>& result) const;
+
+	/** Casts a ray against the proxies with a box. The default implementation tests every proxy. */
+	virtual void RaycastBounded(const Ray3& ray, real maxDistance, RaycastFunction function, void* context) const;
+
+private:
+	BroadPhase(const BroadPhase&);
+	BroadPhase& operator=(const BroadPhase&);
+
+	void RemovePairAt(int32 index);
+	void RemoveUnboundedProxy(int32 proxy);
+
+	static uint64 GetPairKey(int32 proxyA, int32 proxyB);
+
+	bool _UseBounds;
+	BaseArray<Proxy> _Proxies;
+	int32 _FreeProxy;
+	BaseArray<int32> _UnboundedProxies;
+	BaseArray<int32> _PendingProxies;
+	BaseArray<int32> _DestroyedProxies;
+
+	BaseArray<BroadPhasePair> _Pairs;
+	Hashtable<uint64, int32> _PairIndices;
+	BaseArray<BroadPhasePair> _AddedPairs;
+	BaseArray<BroadPhasePair> _RemovedPairs;
+};
+
+/** Broad phase testing every pair of proxies. */
+class AllPairsBroadPhase : public BroadPhase
+{
+public:
+	AllPairsBroadPhase();
+
+protected:
+	virtual void OnCreateProxy(int32 proxy) {}
+	virtual void OnDestroyProxy(int32 proxy) {}
+	virtual void OnMoveProxy(int32 proxy) {}
+	virtual bool TestOverlap(int32 proxyA, int32 proxyB) const { return true; }
+	virtual void FindPairs() {}
+};
+
+/**
+	Broad phase using a dynamic bounding volume hierarchy.
+	Only the proxies that left their enlarged box are queried for new pairs.
+*/
+class TreeBroadPhase : public BroadPhase
+{
+public:
+	TreeBroadPhase();
+
+protected:
+	virtual void OnCreateProxy(int32 proxy);
+	virtual void OnDestroyProxy(int32 proxy);
+	virtual void OnMoveProxy(int32 proxy);
+	virtual bool TestOverlap(int32 proxyA, int32 proxyB) const;
+	virtual void FindPairs();
+	virtual void QueryBounded(const AABB& box, BaseArray<void*>& result) const;
+	virtual void RaycastBounded(const Ray3& ray, real maxDistance, RaycastFunction function, void* context) const;
+
+	static real RaycastProxy(void* userData, const Ray3& ray, real maxDistance, void* context);
+
+	AABBTree _Tree;
+	BaseArray<int32> _MovedProxies;
+	BaseArray<void*> _QueryResult;
+};
+
+/**
+	Broad phase sorting the boxes along one axis.
+	The axis of largest variance of the centers is chosen at each update,
+	and the boxes are kept sorted with an insertion sort while it doesn't change
+	and no box is added.
+*/
+class SweepAndPruneBroadPhase : public BroadPhase
+{
+public:
+	SweepAndPruneBroadPhase();
+
+protected:
+	virtual void OnCreateProxy(int32 proxy);
+	virtual void OnDestroyProxy(int32 proxy);
+	virtual void OnMoveProxy(int32 proxy) {}
+	virtual bool TestOverlap(int32 proxyA, int32 proxyB) const;
+	virtual void FindPairs();
+
+	/// Interval of a box on the sweep axis.
+	struct Interval
+	{
+		real _Min;
+		real _Max;
+		int32 _Proxy;
+	};
+
+	static bool CompareIntervals(const Interval& left, const Interval& right);
+
+	BaseArray<Interval> _Intervals;
+	int32 _Axis;
+	bool _IsSorted;
+};
+
+}
+
+#endif
@@ -0,0 +1,420 @@
+/*=============================================================================
+ContactSolver.cpp
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+#include "ContactSolver.h"
+
+namespace SE_Software
+{
+
+/// Fraction of the penetration corrected at each step.
+static const real BaumgarteFactor = 0.2f;
+
+/// Penetration allowed without correction, to keep the contacts stable.
+static const real AllowedPenetration = 0.01f;
+
+/// Approaching speed below which the contacts don't bounce.
+static const real RestitutionThreshold = 1.0f;
+
+/// Maximum distance between a contact and the cached contact it takes the impulses from.
+static const real WarmStartDistance = 0.1f;
+
+/// Minimum cosine of the angle between the normal of a contact and the normal of its cached contact.
+static const real WarmStartCosine = 0.95f;
+
+static Vector3 _GetVelocity(const SolverBody& body, const Vector3& relPos)
+{
+	return body._LinearVelocity + Vector3::Cross(body._AngularVelocity, relPos);
+}
+
+static real _GetEffectiveMass(const SolverBody& bodyA, const SolverBody& bodyB,
+	const Vector3& relPosA, const Vector3& relPosB, const Vector3& direction)
+{
+	real mass = bodyA._InverseMass + bodyB._InverseMass +
+		Vector3::Dot(Vector3::Cross(bodyA._InverseInertiaTensor.Transform(
+		Vector3::Cross(relPosA, direction)), relPosA), direction) +
+		Vector3::Dot(Vector3::Cross(bodyB._InverseInertiaTensor.Transform(
+		Vector3::Cross(relPosB, direction)), relPosB), direction);
+
+	return (mass > Math::Epsilon ? 1.0f / mass : 0.0f);
+}
+
+
+ContactSolver::ContactSolver() :
+	_Elapsed(0.0),
+	_Iterations(1)
+{
+}
+
+void ContactSolver::Clear()
+{
+	_Bodies.Clear();
+	_BodyParents.Clear();
+	_BodyIslands.Clear();
+	_Constraints.Clear();
+	_IslandConstraints.Clear();
+	_Islands.Clear();
+}
+
+int32 ContactSolver::AddBody(const SolverBody& body)
+{
+	int32 index = _Bodies.Count();
+	_Bodies.Add(body);
+	_BodyParents.Add(index);
+	_BodyIslands.Add(-1);
+	return index;
+}
+
+void ContactSolver::AddContact(const SolverContact& contact)
+{
+	Constraint constraint;
+	constraint._Contact = contact;
+	_Constraints.Add(constraint);
+
+	LinkBodies(contact._BodyA, contact._BodyB);
+}
+
+void ContactSolver::LinkBodies(int32 bodyA, int32 bodyB)
+{
+	// The static bodies are not modified by the solver and don't connect the islands
+	if (!_Bodies[bodyA]._IsDynamic || !_Bodies[bodyB]._IsDynamic)
+		return;
+
+	int32 rootA = FindRoot(bodyA);
+	int32 rootB = FindRoot(bodyB);
+	if (rootA < rootB)
+		_BodyParents[rootB] = rootA;
+	else if (rootB < rootA)
+		_BodyParents[rootA] = rootB;
+}
+
+void ContactSolver::RemoveImpulses(uint32 bodyKey)
+{
+	BaseArray<uint64> keys = _CacheIndices.Keys();
+	int32 count = keys.Count();
+	for (int32 i = 0; i < count; i++)
+	{
+		if ((uint32)(keys[i] >> 32) == bodyKey || (uint32)keys[i] == bodyKey)
+			_CacheIndices.Remove(keys[i]);
+	}
+}
+
+int32 ContactSolver::FindRoot(int32 body)
+{
+	while (_BodyParents[body] != body)
+	{
+		_BodyParents[body] = _BodyParents[_BodyParents[body]];
+		body = _BodyParents[body];
+	}
+	return body;
+}
+
+void ContactSolver::BuildIslands()
+{
+	int32 i;
+	int32 count = _Constraints.Count();
+
+	// The islands are numbered in the order of their first constraint
+	for (i = 0; i < count; i++)
+	{
+		const SolverContact& contact = _Constraints[i]._Contact;
+		int32 body = (_Bodies[contact._BodyA]._IsDynamic ? contact._BodyA : contact._BodyB);
+		if (!_Bodies[body]._IsDynamic)
+			continue;
+
+		int32 root = FindRoot(body);
+		if (_BodyIslands[root] < 0)
+		{
+			Island island;
+			island._First = 0;
+			island._Count = 0;
+			_BodyIslands[root] = _Islands.Count();
+			_Islands.Add(island);
+		}
+		_Islands[_BodyIslands[root]]._Count++;
+	}
+
+	int32 islandCount = _Islands.Count();
+	int32 first = 0;
+	for (i = 0; i < islandCount; i++)
+	{
+		_Islands[i]._First = first;
+		first += _Islands[i]._Count;
+		_Islands[i]._Count = 0;
+	}
+
+	// The constraints keep their order inside the islands
+	_IslandConstraints.Resize(first);
+	for (i = 0; i < count; i++)
+	{
+		const SolverContact& contact = _Constraints[i]._Contact;
+		int32 body = (_Bodies[contact._BodyA]._IsDynamic ? contact._BodyA : contact._BodyB);
+		if (!_Bodies[body]._IsDynamic)
+			continue;
+
+		Island& island = _Islands[_BodyIslands[FindRoot(body)]];
+		_IslandConstraints[island._First + island._Count] = i;
+		island._Count++;
+	}
+
+	int32 bodyCount = _Bodies.Count();
+	for (i = 0; i < bodyCount; i++)
+	{
+		if (_Bodies[i]._IsDynamic)
+		{
+			_BodyIslands[i] = _BodyIslands[FindRoot(i)];
+		}
+	}
+}
+
+void ContactSolver::Solve(real64 elapsed, int32 iterations)
+{
+	BuildIslands();
+
+	// The impulses of the previous step are kept for the next step
+	if (elapsed <= 0.0)
+		return;
+
+	_Elapsed = elapsed;
+	_Iterations = Math::Max(iterations, 1);
+
+	if (!_Islands.IsEmpty())
+	{
+		// The bodies of an island are only modified by the thread solving it
+		JobScheduler::Instance()->ParallelFor(_Islands.Count(), SolveIslands, this);
+	}
+
+	StoreImpulses();
+}
+
+void ContactSolver::UpdateSleepTimes(real64 elapsed, real sleepEnergy)
+{
+	int32 i;
+	int32 bodyCount = _Bodies.Count();
+
+	// Negative until the first body of the island is found
+	_IslandSleepTimes.Resize(_Islands.Count());
+	for (i = 0; i < _IslandSleepTimes.Count(); i++)
+	{
+		_IslandSleepTimes[i] = -1.0f;
+	}
+
+	for (i = 0; i < bodyCount; i++)
+	{
+		SolverBody& body = _Bodies[i];
+		if (!body._IsDynamic)
+			continue;
+
+		// The sleeping bodies keep their time, their island sleeps again if no other body moves
+		if (body._IsAwake)
+		{
+			real energy = body._LinearVelocity.LengthSquared() + body._AngularVelocity.LengthSquared();
+			if (energy > sleepEnergy)
+				body._SleepTime = 0.0f;
+			else
+				body._SleepTime += (real)elapsed;
+		}
+
+		int32 island = _BodyIslands[i];
+		if (island >= 0 && (_IslandSleepTimes[island] < 0.0f || body._SleepTime < _IslandSleepTimes[island]))
+		{
+			_IslandSleepTimes[island] = body._SleepTime;
+		}
+	}
+}
+
+real ContactSolver::GetIslandSleepTime(int32 index) const
+{
+	int32 island = _BodyIslands[index];
+	return (island >= 0 ? _IslandSleepTimes[island] : _Bodies[index]._SleepTime);
+}
+
+void ContactSolver::SolveIslands(int32 start, int32 end, void* data)
+{
+	ContactSolver* solver = (ContactSolver*)data;
+	for (int32 i = start; i < end; i++)
+	{
+		solver->SolveIsland(solver->_Islands[i]);
+	}
+}
+
+void ContactSolver::SolveIsland(const Island& island)
+{
+	int32 i, iteration;
+	const int32* indices = _IslandConstraints.Data() + island._First;
+
+	for (i = 0; i < island._Count; i++)
+	{
+		PrepareConstraint(_Constraints[indices[i]]);
+	}
+
+	for (i = 0; i < island._Count; i++)
+	{
+		WarmStart(_Constraints[indices[i]]);
+	}
+
+	for (iteration = 0; iteration < _Iterations; iteration++)
+	{
+		for (i = 0; i < island._Count; i++)
+		{
+			SolveConstraint(_Constraints[indices[i]]);
+		}
+	}
+}
+
+void ContactSolver::PrepareConstraint(Constraint& constraint)
+{
+	const SolverContact& contact = constraint._Contact;
+	const SolverBody& bodyA = _Bodies[contact._BodyA];
+	const SolverBody& bodyB = _Bodies[contact._BodyB];
+	const Vector3& normal = contact._Normal;
+
+	constraint._RelPosA = contact._Position - bodyA._Position;
+	constraint._RelPosB = contact._Position - bodyB._Position;
+
+	// Friction directions
+	if (Math::Abs(normal.X) >= 0.57735f)
+		constraint._Tangents[0] = Vector3::Normalize(Vector3(normal.Y, -normal.X, 0.0f));
+	else
+		constraint._Tangents[0] = Vector3::Normalize(Vector3(0.0f, normal.Z, -normal.Y));
+	constraint._Tangents[1] = Vector3::Cross(normal, constraint._Tangents[0]);
+
+	constraint._NormalMass = _GetEffectiveMass(bodyA, bodyB, constraint._RelPosA, constraint._RelPosB, normal);
+	constraint._TangentMasses[0] = _GetEffectiveMass(bodyA, bodyB, constraint._RelPosA, constraint._RelPosB, constraint._Tangents[0]);
+	constraint._TangentMasses[1] = _GetEffectiveMass(bodyA, bodyB, constraint._RelPosA, constraint._RelPosB, constraint._Tangents[1]);
+
+	// Target velocity: bounce or penetration correction
+	real normalVelocity = Vector3::Dot(_GetVelocity(bodyA, constraint._RelPosA) -
+		_GetVelocity(bodyB, constraint._RelPosB), normal);
+
+	constraint._VelocityBias = 0.0f;
+	if (normalVelocity < -RestitutionThreshold)
+	{
+		constraint._VelocityBias = -contact._Restitution * normalVelocity;
+	}
+
+	real penetrationBias = (real)(BaumgarteFactor / _Elapsed) *
+		Math::Max(contact._Depth - AllowedPenetration, 0.0f);
+	constraint._VelocityBias = Math::Max(constraint._VelocityBias, penetrationBias);
+
+	// Impulses of the previous step
+	constraint._NormalImpulse = 0.0f;
+	constraint._TangentImpulses[0] = 0.0f;
+	constraint._TangentImpulses[1] = 0.0f;
+
+	const int32* head = _CacheIndices.Find(contact._PairKey);
+	if (head == NULL)
+		return;
+
+	const CachedContact* match = NULL;
+	real matchDistance = WarmStartDistance * WarmStartDistance;
+	for (int32 index = *head; index >= 0; index = _Cache[index]._Next)
+	{
+		const CachedContact& cached = _Cache[index];
+		real distance = (cached._Position - contact._Position).LengthSquared();
+		if (distance <= matchDistance && Vector3::Dot(cached._Normal, normal) >= WarmStartCosine)
+		{
+			match = &cached;
+			matchDistance = distance;
+		}
+	}
+
+	if (match != NULL)
+	{
+		constraint._NormalImpulse = match->_NormalImpulse;
+		constraint._TangentImpulses[0] = Vector3::Dot(match->_FrictionImpulse, constraint._Tangents[0]);
+		constraint._TangentImpulses[1] = Vector3::Dot(match->_FrictionImpulse, constraint._Tangents[1]);
+	}
+}
+
+void ContactSolver::WarmStart(Constraint& constraint)
+{
+	Vector3 impulse = constraint._NormalImpulse * constraint._Contact._Normal +
+		constraint._TangentImpulses[0] * constraint._Tangents[0] +
+		constraint._TangentImpulses[1] * constraint._Tangents[1];
+
+	ApplyImpulse(constraint, impulse);
+}
+
+void ContactSolver::SolveConstraint(Constraint& constraint)
+{
+	const SolverContact& contact = constraint._Contact;
+	const SolverBody& bodyA = _Bodies[contact._BodyA];
+	const SolverBody& bodyB = _Bodies[contact._BodyB];
+
+	// Normal impulse, the accumulated impulse can only push the bodies apart
+	Vector3 relVel = _GetVelocity(bodyA, constraint._RelPosA) - _GetVelocity(bodyB, constraint._RelPosB);
+	real lambda = constraint._NormalMass * (constraint._VelocityBias - Vector3::Dot(relVel, contact._Normal));
+
+	real oldImpulse = constraint._NormalImpulse;
+	constraint._NormalImpulse = Math::Max(oldImpulse + lambda, 0.0f);
+	ApplyImpulse(constraint, (constraint._NormalImpulse - oldImpulse) * contact._Normal);
+
+	// Friction impulses, bounded by the normal impulse
+	real maxFriction = contact._Friction * constraint._NormalImpulse;
+	for (int i = 0; i < 2; i++)
+	{
+		relVel = _GetVelocity(bodyA, constraint._RelPosA) - _GetVelocity(bodyB, constraint._RelPosB);
+		lambda = -constraint._TangentMasses[i] * Vector3::Dot(relVel, constraint._Tangents[i]);
+
+		oldImpulse = constraint._TangentImpulses[i];
+		constraint._TangentImpulses[i] = Math::Clamp(oldImpulse + lambda, -maxFriction, maxFriction);
+		ApplyImpulse(constraint, (constraint._TangentImpulses[i] - oldImpulse) * constraint._Tangents[i]);
+	}
+}
+
+void ContactSolver::ApplyImpulse(const Constraint& constraint, const Vector3& impulse)
+{
+	SolverBody& bodyA = _Bodies[constraint._Contact._BodyA];
+	SolverBody& bodyB = _Bodies[constraint._Contact._BodyB];
+
+	// The static bodies can be shared by several islands and must not be written
+	if (bodyA._IsDynamic)
+	{
+		bodyA._LinearVelocity += impulse * bodyA._InverseMass;
+		bodyA._AngularVelocity += bodyA._InverseInertiaTensor.Transform(Vector3::Cross(constraint._RelPosA, impulse));
+	}
+
+	if (bodyB._IsDynamic)
+	{
+		bodyB._LinearVelocity -= impulse * bodyB._InverseMass;
+		bodyB._AngularVelocity -= bodyB._InverseInertiaTensor.Transform(Vector3::Cross(constraint._RelPosB, impulse));
+	}
+}
+
+void ContactSolver::StoreImpulses()
+{
+	_CacheIndices.Clear();
+	_Cache.Clear();
+
+	int32 count = _IslandConstraints.Count();
+	for (int32 i = 0; i < count; i++)
+	{
+		const Constraint& constraint = _Constraints[_IslandConstraints[i]];
+
+		CachedContact cached;
+		cached._Position = constraint._Contact._Position;
+		cached._Normal = constraint._Contact._Normal;
+		cached._NormalImpulse = constraint._NormalImpulse;
+		cached._FrictionImpulse = constraint._TangentImpulses[0] * constraint._Tangents[0] +
+			constraint._TangentImpulses[1] * constraint._Tangents[1];
+
+		int32 index = _Cache.Count();
+		int32* head = _CacheIndices.Find(constraint._Contact._PairKey);
+		if (head != NULL)
+		{
+			cached._Next = *head;
+			*head = index;
+		}
+		else
+		{
+			cached._Next = -1;
+			_CacheIndices.Add(constraint._Contact._PairKey, index);
+		}
+		_Cache.Add(cached);
+	}
+}
+
+}
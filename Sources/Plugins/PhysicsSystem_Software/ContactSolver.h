@@ -0,0 +1,182 @@
+/*=============================================================================
+ContactSolver.h
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+#ifndef _SE_CONTACTSOLVER_H_
+#define _SE_CONTACTSOLVER_H_
+
+#include "SoftwarePhysicsSystem.h"
+
+namespace SE_Software
+{
+
+/** Velocity state of a body used by the solver. */
+struct SolverBody
+{
+	Vector3 _Position;
+	Vector3 _LinearVelocity;
+	Vector3 _AngularVelocity;
+	real _InverseMass;
+	Matrix3 _InverseInertiaTensor;
+	bool _IsDynamic;
+	bool _IsAwake;
+
+	/// Time during which the body has been resting.
+	real _SleepTime;
+};
+
+/** Contact point between two bodies. */
+struct SolverContact
+{
+	/// Key of the pair of bodies, used to find the impulses of the previous step.
+	/// The high and low 32 bits are the keys of the bodies A and B.
+	uint64 _PairKey;
+	int32 _BodyA;
+	int32 _BodyB;
+
+	/// The normal points from the body B to the body A.
+	Vector3 _Position;
+	Vector3 _Normal;
+	real _Depth;
+	real _Restitution;
+	real _Friction;
+};
+
+/**
+	@brief Sequential impulse solver for the contacts.
+
+	The bodies connected by the contacts are grouped in islands with a
+	union-find, the static bodies don't connect the islands. The islands are
+	independent and are solved in parallel by the job scheduler, the results
+	don't depend on the number of threads.
+
+	The accumulated impulses of each contact are kept for the next step and
+	are applied first to the matching contacts of the same pair (warm starting).
+*/
+class ContactSolver
+{
+public:
+	ContactSolver();
+
+	/** @name Setup. */
+	//@{
+	/** Removes the bodies and the contacts of the previous step. */
+	void Clear();
+
+	/**
+		Adds a body.
+		@return The index of the body.
+	*/
+	int32 AddBody(const SolverBody& body);
+
+	/** Gets the body at the specified index, with its solved velocities. */
+	const SolverBody& GetBody(int32 index) const { return _Bodies[index]; }
+
+	/** Adds a contact between two added bodies. */
+	void AddContact(const SolverContact& contact);
+
+	/** Connects two bodies in the same island without adding a contact. */
+	void LinkBodies(int32 bodyA, int32 bodyB);
+
+	/**
+		Forgets the impulses of the previous step of the contacts of a body.
+		Must be called when a body is destroyed, as its key can be reused by another body.
+		@param bodyKey The key of the body in the pair keys.
+	*/
+	void RemoveImpulses(uint32 bodyKey);
+	//@}
+
+	/** @name Solving. */
+	//@{
+	/**
+		Solves the contacts.
+		@param elapsed The time step.
+		@param iterations The number of iterations over the contacts of each island.
+	*/
+	void Solve(real64 elapsed, int32 iterations);
+
+	/** Gets the number of islands of the last solve. */
+	int32 GetIslandCount() const { return _Islands.Count(); }
+
+	/** Determines whether the body was in an island of the last solve. */
+	bool IsBodySolved(int32 index) const { return _BodyIslands[index] >= 0; }
+	//@}
+
+	/** @name Sleeping. */
+	//@{
+	/**
+		Updates the resting time of the awake dynamic bodies from their solved velocities.
+		@param elapsed The time step.
+		@param sleepEnergy The sum of the squared linear and angular speeds below which a body is resting.
+	*/
+	void UpdateSleepTimes(real64 elapsed, real sleepEnergy);
+
+	/**
+		Gets the resting time of the island of a body, which is the smallest resting time of its bodies.
+		A body that is not in an island is its own island.
+	*/
+	real GetIslandSleepTime(int32 index) const;
+	//@}
+
+protected:
+	/// Contact with its solver data.
+	struct Constraint
+	{
+		SolverContact _Contact;
+		Vector3 _RelPosA;
+		Vector3 _RelPosB;
+		Vector3 _Tangents[2];
+		real _NormalMass;
+		real _TangentMasses[2];
+		real _VelocityBias;
+		real _NormalImpulse;
+		real _TangentImpulses[2];
+	};
+
+	/// Impulses of a contact of the previous step. The contacts of a pair are linked with _Next.
+	struct CachedContact
+	{
+		Vector3 _Position;
+		Vector3 _Normal;
+		real _NormalImpulse;
+		Vector3 _FrictionImpulse;
+		int32 _Next;
+	};
+
+	/// Range of the constraints of an island in _IslandConstraints.
+	struct Island
+	{
+		int32 _First;
+		int32 _Count;
+	};
+
+	int32 FindRoot(int32 body);
+	void BuildIslands();
+	void PrepareConstraint(Constraint& constraint);
+	void WarmStart(Constraint& constraint);
+	void SolveIsland(const Island& island);
+	void SolveConstraint(Constraint& constraint);
+	void ApplyImpulse(const Constraint& constraint, const Vector3& impulse);
+	void StoreImpulses();
+
+	static void SolveIslands(int32 start, int32 end, void* data);
+
+	BaseArray<SolverBody> _Bodies;
+	BaseArray<int32> _BodyParents;
+	BaseArray<int32> _BodyIslands;
+	BaseArray<Constraint> _Constraints;
+	BaseArray<int32> _IslandConstraints;
+	BaseArray<Island> _Islands;
+	BaseArray<real> _IslandSleepTimes;
+	real64 _Elapsed;
+	int32 _Iterations;
+
+	Hashtable<uint64, int32> _CacheIndices;
+	BaseArray<CachedContact> _Cache;
+};
+
+}
+
+#endif
@@ -0,0 +1,1173 @@
+/*=============================================================================
+NarrowPhase.cpp
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+#include "NarrowPhase.h"
+#include "PhysicsBody.h"
+
+#if SE_USE_SIMD && (defined(_M_IX86) || defined(_M_X64) || defined(__SSE__))
+#	define SE_NARROWPHASE_SSE 1
+#	include <xmmintrin.h>
+#else
+#	define SE_NARROWPHASE_SSE 0
+#endif
+
+namespace SE_Software
+{
+
+/// Number of pairs tested at once by the SSE functions.
+static const int32 BatchSize = 4;
+
+/// Distance below which two centers are considered equal.
+static const real MinDistance = (real)1e-6;
+
+/// Squared sine below which two edges are parallel.
+static const real ParallelTolerance = (real)1e-6;
+
+/// An edge axis is only chosen when it is clearly shallower than the face axes, which keeps the face contacts stable.
+static const real EdgeRelativeTolerance = (real)0.95;
+static const real EdgeAbsoluteTolerance = (real)0.005;
+
+/// Distance below which a new point replaces a point of the previous step.
+static const real MergeDistance = (real)0.02;
+
+/// Separation or drift along the surface beyond which a point of the previous step is dropped.
+static const real BreakingDistance = (real)0.02;
+
+static const BoundingSphere& _GetSphere(const IShape* shape)
+{
+	return ((const ISphereShape*)shape)->Data;
+}
+
+static const Plane& _GetPlane(const IShape* shape)
+{
+	return ((const IPlaneShape*)shape)->Data;
+}
+
+/// Gets the box of a shape, the shapes other than the boxes use the bounding box of their body.
+static OBB _GetBox(const IShape* shape, const PhysicsBody* body)
+{
+	if (shape->GetShapeType() == ShapeType_Box)
+		return ((const IBoxShape*)shape)->Data;
+
+	return OBB(body->GetWorldBoundingBox(), Matrix3::Identity);
+}
+
+static void _SetPoint(CollisionResult& result, const Vector3& normal, const Vector3& position, real depth)
+{
+	result._Normal = normal;
+	result._Positions[0] = position;
+	result._Depths[0] = depth;
+	result._PointCount = 1;
+}
+
+static void _AddPoint(CollisionResult& result, const Vector3& position, real depth)
+{
+	if (result._PointCount < CollisionResult::MaxPoints)
+	{
+		result._Positions[result._PointCount] = position;
+		result._Depths[result._PointCount] = depth;
+		result._PointCount++;
+	}
+}
+
+/// Gets the sign of an axis for a corner of a box.
+static real _GetCornerSign(int32 corner, int32 axis)
+{
+	return ((corner >> axis) & 1) ? (real)1.0 : (real)-1.0;
+}
+
+/*-----------------------------------------------------------------------------
+	Sphere/Sphere.
+-----------------------------------------------------------------------------*/
+
+static void _SphereSphere(const BoundingSphere& sphereA, const BoundingSphere& sphereB, CollisionResult& result)
+{
+	result._PointCount = 0;
+
+	Vector3 offset = sphereA.Center - sphereB.Center;
+	real distance = Math::Sqrt(offset.LengthSquared());
+	real depth = sphereA.Radius + sphereB.Radius - distance;
+	if (depth < 0.0)
+		return;
+
+	Vector3 normal = Vector3::UnitY;
+	if (distance > MinDistance)
+		normal = offset * ((real)1.0 / distance);
+
+	_SetPoint(result, normal, sphereB.Center + normal * (sphereB.Radius - depth * (real)0.5), depth);
+}
+
+/*-----------------------------------------------------------------------------
+	Sphere/Plane.
+-----------------------------------------------------------------------------*/
+
+static void _SpherePlane(const BoundingSphere& sphere, const Plane& plane, CollisionResult& result)
+{
+	result._PointCount = 0;
+
+	// The plane is the boundary of a half-space
+	real distance = plane.GetDistance(sphere.Center);
+	real depth = sphere.Radius - distance;
+	if (depth < 0.0)
+		return;
+
+	_SetPoint(result, plane.Normal, sphere.Center - plane.Normal * ((sphere.Radius + distance) * (real)0.5), depth);
+}
+
+/*-----------------------------------------------------------------------------
+	Sphere/Box.
+-----------------------------------------------------------------------------*/
+
+static void _SphereBox(const BoundingSphere& sphere, const OBB& box, CollisionResult& result)
+{
+	result._PointCount = 0;
+
+	Vector3 axes[3];
+	axes[0] = box.Rotation.GetColumn(0);
+	axes[1] = box.Rotation.GetColumn(1);
+	axes[2] = box.Rotation.GetColumn(2);
+
+	Vector3 offset = sphere.Center - box.Center;
+	Vector3 local(Vector3::Dot(axes[0], offset), Vector3::Dot(axes[1], offset), Vector3::Dot(axes[2], offset));
+
+	// Closest point of the box to the center of the sphere
+	Vector3 closest;
+	for (int i = 0; i < 3; ++i)
+	{
+		closest[i] = Math::Clamp(local[i], -box.Extents[i], box.Extents[i]);
+	}
+
+	Vector3 localNormal;
+	Vector3 surface;
+	real depth;
+	Vector3 difference = local - closest;
+	real distanceSquared = difference.LengthSquared();
+	if (distanceSquared > MinDistance * MinDistance)
+	{
+		real distance = Math::Sqrt(distanceSquared);
+		localNormal = difference * ((real)1.0 / distance);
+		surface = closest;
+		depth = sphere.Radius - distance;
+	}
+	else
+	{
+		// The center is inside of the box, it is pushed out through the closest face
+		Vector3 penetration(box.Extents.X - Math::Abs(local.X), box.Extents.Y - Math::Abs(local.Y),
+			box.Extents.Z - Math::Abs(local.Z));
+		int axis = 2;
+		if (penetration.X <= penetration.Y && penetration.X <= penetration.Z)
+			axis = 0;
+		else if (penetration.Y <= penetration.Z)
+			axis = 1;
+
+		real sign = (local[axis] >= 0.0) ? (real)1.0 : (real)-1.0;
+		localNormal = Vector3::Zero;
+		localNormal[axis] = sign;
+		surface = local;
+		surface[axis] = sign * box.Extents[axis];
+		depth = sphere.Radius + penetration[axis];
+	}
+
+	if (depth < 0.0)
+		return;
+
+	Vector3 position = surface - localNormal * (depth * (real)0.5);
+	_SetPoint(result,
+		axes[0] * localNormal.X + axes[1] * localNormal.Y + axes[2] * localNormal.Z,
+		box.Center + axes[0] * position.X + axes[1] * position.Y + axes[2] * position.Z,
+		depth);
+}
+
+/*-----------------------------------------------------------------------------
+	Box/Plane.
+-----------------------------------------------------------------------------*/
+
+/// Adds the corners of a box below a plane, from the depths of the 8 corners.
+static void _AddBoxPlaneCorners(const OBB& box, const Plane& plane, const real* depths, CollisionResult& result)
+{
+	result._Normal = plane.Normal;
+	result._PointCount = 0;
+
+	Vector3 axes[3];
+	for (int i = 0; i < 3; ++i)
+	{
+		axes[i] = box.Rotation.GetColumn(i) * box.Extents[i];
+	}
+
+	for (int32 corner = 0; corner < 8; ++corner)
+	{
+		if (depths[corner] < 0.0)
+			continue;
+
+		Vector3 position = box.Center +
+			axes[0] * _GetCornerSign(corner, 0) +
+			axes[1] * _GetCornerSign(corner, 1) +
+			axes[2] * _GetCornerSign(corner, 2);
+		_AddPoint(result, position + plane.Normal * (depths[corner] * (real)0.5), depths[corner]);
+	}
+}
+
+static void _BoxPlane(const OBB& box, const Plane& plane, CollisionResult& result)
+{
+	// The distance of a corner is the distance of the center plus the projections of the signed extents
+	real center = plane.GetDistance(box.Center);
+	real projections[3];
+	for (int i = 0; i < 3; ++i)
+	{
+		projections[i] = box.Extents[i] * Vector3::Dot(plane.Normal, box.Rotation.GetColumn(i));
+	}
+
+	real depths[8];
+	for (int32 corner = 0; corner < 8; ++corner)
+	{
+		depths[corner] = -(center +
+			_GetCornerSign(corner, 0) * projections[0] +
+			_GetCornerSign(corner, 1) * projections[1] +
+			_GetCornerSign(corner, 2) * projections[2]);
+	}
+
+	_AddBoxPlaneCorners(box, plane, depths, result);
+}
+
+/*-----------------------------------------------------------------------------
+	Box/Box.
+-----------------------------------------------------------------------------*/
+
+/// Box with its axes.
+struct ContactBox
+{
+	Vector3 _Center;
+	Vector3 _Axes[3];
+	real _Extents[3];
+};
+
+static void _GetContactBox(const OBB& box, ContactBox& result)
+{
+	result._Center = box.Center;
+	for (int i = 0; i < 3; ++i)
+	{
+		result._Axes[i] = box.Rotation.GetColumn(i);
+		result._Extents[i] = box.Extents[i];
+	}
+}
+
+static real _GetProjectedRadius(const ContactBox& box, const Vector3& axis)
+{
+	return box._Extents[0] * Math::Abs(Vector3::Dot(box._Axes[0], axis)) +
+		box._Extents[1] * Math::Abs(Vector3::Dot(box._Axes[1], axis)) +
+		box._Extents[2] * Math::Abs(Vector3::Dot(box._Axes[2], axis));
+}
+
+/// Clips a polygon by the plane dot(normal, p) <= offset.
+static int32 _ClipPolygon(const Vector3* points, int32 count, const Vector3& normal, real offset, Vector3* result)
+{
+	int32 resultCount = 0;
+	for (int32 i = 0; i < count; ++i)
+	{
+		const Vector3& start = points[i];
+		const Vector3& end = points[(i + 1) % count];
+		real startDistance = Vector3::Dot(normal, start) - offset;
+		real endDistance = Vector3::Dot(normal, end) - offset;
+
+		if (startDistance <= 0.0)
+		{
+			result[resultCount++] = start;
+		}
+		if ((startDistance < 0.0 && endDistance > 0.0) || (startDistance > 0.0 && endDistance < 0.0))
+		{
+			result[resultCount++] = start + (end - start) * (startDistance / (startDistance - endDistance));
+		}
+	}
+	return resultCount;
+}
+
+/**
+	Clips the face of the incident box the most opposed to the reference face,
+	and adds the clipped points below the reference face.
+*/
+static void _AddFaceContacts(const ContactBox& reference, int32 axis, const Vector3& faceNormal,
+	const ContactBox& incident, CollisionResult& result)
+{
+	Vector3 faceCenter = reference._Center + faceNormal * reference._Extents[axis];
+
+	// Incident face
+	int32 incidentAxis = 0;
+	real maxDot = -1.0;
+	for (int32 i = 0; i < 3; ++i)
+	{
+		real dot = Math::Abs(Vector3::Dot(incident._Axes[i], faceNormal));
+		if (dot > maxDot)
+		{
+			maxDot = dot;
+			incidentAxis = i;
+		}
+	}
+
+	real sign = (Vector3::Dot(incident._Axes[incidentAxis], faceNormal) > 0.0) ? (real)-1.0 : (real)1.0;
+	Vector3 incidentCenter = incident._Center + incident._Axes[incidentAxis] * (sign * incident._Extents[incidentAxis]);
+	Vector3 u = incident._Axes[(incidentAxis + 1) % 3] * incident._Extents[(incidentAxis + 1) % 3];
+	Vector3 v = incident._Axes[(incidentAxis + 2) % 3] * incident._Extents[(incidentAxis + 2) % 3];
+
+	Vector3 polygon[CollisionResult::MaxPoints];
+	Vector3 clipped[CollisionResult::MaxPoints];
+	polygon[0] = incidentCenter + u + v;
+	polygon[1] = incidentCenter - u + v;
+	polygon[2] = incidentCenter - u - v;
+	polygon[3] = incidentCenter + u - v;
+	int32 count = 4;
+
+	// Side planes of the reference face
+	for (int32 i = 1; i < 3 && count > 0; ++i)
+	{
+		const Vector3& side = reference._Axes[(axis + i) % 3];
+		real center = Vector3::Dot(side, reference._Center);
+		real extent = reference._Extents[(axis + i) % 3];
+
+		count = _ClipPolygon(polygon, count, side, center + extent, clipped);
+		count = _ClipPolygon(clipped, count, -side, -center + extent, polygon);
+	}
+
+	real faceOffset = Vector3::Dot(faceNormal, faceCenter);
+	for (int32 i = 0; i < count; ++i)
+	{
+		real depth = faceOffset - Vector3::Dot(faceNormal, polygon[i]);
+		if (depth >= 0.0)
+		{
+			_AddPoint(result, polygon[i] + faceNormal * (depth * (real)0.5), depth);
+		}
+	}
+}
+
+/// Gets the middle of the edge of a box parallel to an axis that is the furthest along a direction.
+static Vector3 _GetSupportEdge(const ContactBox& box, int32 axis, const Vector3& direction)
+{
+	Vector3 result = box._Center;
+	for (int32 i = 0; i < 3; ++i)
+	{
+		if (i == axis)
+			continue;
+
+		real sign = (Vector3::Dot(box._Axes[i], direction) > 0.0) ? (real)1.0 : (real)-1.0;
+		result += box._Axes[i] * (sign * box._Extents[i]);
+	}
+	return result;
+}
+
+static void _BoxBox(const OBB& obbA, const OBB& obbB, CollisionResult& result)
+{
+	result._PointCount = 0;
+
+	ContactBox boxA;
+	ContactBox boxB;
+	_GetContactBox(obbA, boxA);
+	_GetContactBox(obbB, boxB);
+	Vector3 offset = boxA._Center - boxB._Center;
+
+	// Separating axis test, the axis of least penetration gives the normal
+	real faceDepth = SE_MAX_R32;
+	int32 faceAxis = -1;
+	for (int32 i = 0; i < 6; ++i)
+	{
+		const Vector3& axis = (i < 3) ? boxA._Axes[i] : boxB._Axes[i - 3];
+		real depth = _GetProjectedRadius(boxA, axis) + _GetProjectedRadius(boxB, axis) -
+			Math::Abs(Vector3::Dot(offset, axis));
+		if (depth < 0.0)
+			return;
+
+		if (depth < faceDepth)
+		{
+			faceDepth = depth;
+			faceAxis = i;
+		}
+	}
+
+	real edgeDepth = SE_MAX_R32;
+	int32 edgeA = -1;
+	int32 edgeB = -1;
+	Vector3 edgeNormal;
+	for (int32 i = 0; i < 3; ++i)
+	{
+		for (int32 j = 0; j < 3; ++j)
+		{
+			Vector3 axis = Vector3::Cross(boxA._Axes[i], boxB._Axes[j]);
+			real lengthSquared = axis.LengthSquared();
+			if (lengthSquared < ParallelTolerance)
+				continue;
+
+			axis *= (real)1.0 / Math::Sqrt(lengthSquared);
+			real depth = _GetProjectedRadius(boxA, axis) + _GetProjectedRadius(boxB, axis) -
+				Math::Abs(Vector3::Dot(offset, axis));
+			if (depth < 0.0)
+				return;
+
+			if (depth < edgeDepth)
+			{
+				edgeDepth = depth;
+				edgeA = i;
+				edgeB = j;
+				edgeNormal = axis;
+			}
+		}
+	}
+
+	if (edgeA >= 0 && edgeDepth < EdgeRelativeTolerance * faceDepth - EdgeAbsoluteTolerance)
+	{
+		// The normal points from the box B to the box A
+		if (Vector3::Dot(edgeNormal, offset) < 0.0)
+			edgeNormal = -edgeNormal;
+
+		// Closest points of the two edges
+		Vector3 pointA = _GetSupportEdge(boxA, edgeA, -edgeNormal);
+		Vector3 pointB = _GetSupportEdge(boxB, edgeB, edgeNormal);
+		const Vector3& directionA = boxA._Axes[edgeA];
+		const Vector3& directionB = boxB._Axes[edgeB];
+		Vector3 r = pointA - pointB;
+		real b = Vector3::Dot(directionA, directionB);
+		real c = Vector3::Dot(directionA, r);
+		real f = Vector3::Dot(directionB, r);
+		real denominator = (real)1.0 - b * b;
+
+		real s = 0.0;
+		real t = 0.0;
+		if (denominator > ParallelTolerance)
+		{
+			s = Math::Clamp((b * f - c) / denominator, -boxA._Extents[edgeA], boxA._Extents[edgeA]);
+			t = Math::Clamp((f - b * c) / denominator, -boxB._Extents[edgeB], boxB._Extents[edgeB]);
+		}
+
+		Vector3 position = (pointA + directionA * s + pointB + directionB * t) * (real)0.5;
+		_SetPoint(result, edgeNormal, position, edgeDepth);
+		return;
+	}
+
+	// Face contact, the incident face is clipped by the reference face
+	if (faceAxis < 3)
+	{
+		real sign = (Vector3::Dot(boxA._Axes[faceAxis], offset) > 0.0) ? (real)-1.0 : (real)1.0;
+		Vector3 faceNormal = boxA._Axes[faceAxis] * sign;
+		result._Normal = -faceNormal;
+		_AddFaceContacts(boxA, faceAxis, faceNormal, boxB, result);
+	}
+	else
+	{
+		faceAxis -= 3;
+		real sign = (Vector3::Dot(boxB._Axes[faceAxis], offset) > 0.0) ? (real)1.0 : (real)-1.0;
+		Vector3 faceNormal = boxB._Axes[faceAxis] * sign;
+		result._Normal = faceNormal;
+		_AddFaceContacts(boxB, faceAxis, faceNormal, boxA, result);
+	}
+}
+
+#if SE_NARROWPHASE_SSE
+/*-----------------------------------------------------------------------------
+	SSE functions, they test four pairs and give the results of the scalar functions.
+-----------------------------------------------------------------------------*/
+
+/// Four vectors stored as structure of arrays.
+struct SimdVector3
+{
+	__m128 X, Y, Z;
+};
+
+static SimdVector3 _LoadVector(const Vector3& a, const Vector3& b, const Vector3& c, const Vector3& d)
+{
+	SimdVector3 result;
+	result.X = _mm_setr_ps(a.X, b.X, c.X, d.X);
+	result.Y = _mm_setr_ps(a.Y, b.Y, c.Y, d.Y);
+	result.Z = _mm_setr_ps(a.Z, b.Z, c.Z, d.Z);
+	return result;
+}
+
+static void _StoreVector(const SimdVector3& value, Vector3* result)
+{
+	real32 x[BatchSize];
+	real32 y[BatchSize];
+	real32 z[BatchSize];
+	_mm_storeu_ps(x, value.X);
+	_mm_storeu_ps(y, value.Y);
+	_mm_storeu_ps(z, value.Z);
+	for (int32 i = 0; i < BatchSize; ++i)
+	{
+		result[i] = Vector3(x[i], y[i], z[i]);
+	}
+}
+
+static __m128 _Dot(const SimdVector3& left, const SimdVector3& right)
+{
+	return _mm_add_ps(_mm_add_ps(_mm_mul_ps(left.X, right.X), _mm_mul_ps(left.Y, right.Y)),
+		_mm_mul_ps(left.Z, right.Z));
+}
+
+static SimdVector3 _MultiplyAdd(const SimdVector3& value, const SimdVector3& direction, __m128 scale)
+{
+	SimdVector3 result;
+	result.X = _mm_add_ps(value.X, _mm_mul_ps(direction.X, scale));
+	result.Y = _mm_add_ps(value.Y, _mm_mul_ps(direction.Y, scale));
+	result.Z = _mm_add_ps(value.Z, _mm_mul_ps(direction.Z, scale));
+	return result;
+}
+
+static __m128 _Select(__m128 mask, __m128 left, __m128 right)
+{
+	return _mm_or_ps(_mm_and_ps(mask, left), _mm_andnot_ps(mask, right));
+}
+
+static __m128 _Abs(__m128 value)
+{
+	return _mm_andnot_ps(_mm_set1_ps(-0.0f), value);
+}
+
+static void _StorePoints(const SimdVector3& normal, const SimdVector3& position, __m128 depth, CollisionResult* results)
+{
+	Vector3 normals[BatchSize];
+	Vector3 positions[BatchSize];
+	real32 depths[BatchSize];
+	_StoreVector(normal, normals);
+	_StoreVector(position, positions);
+	_mm_storeu_ps(depths, depth);
+
+	for (int32 i = 0; i < BatchSize; ++i)
+	{
+		if (depths[i] < 0.0)
+			results[i]._PointCount = 0;
+		else
+			_SetPoint(results[i], normals[i], positions[i], depths[i]);
+	}
+}
+
+static void _SphereSphere4(const CollisionPair* pairs, CollisionResult* results)
+{
+	const BoundingSphere& a0 = _GetSphere(pairs[0]._ShapeA);
+	const BoundingSphere& a1 = _GetSphere(pairs[1]._ShapeA);
+	const BoundingSphere& a2 = _GetSphere(pairs[2]._ShapeA);
+	const BoundingSphere& a3 = _GetSphere(pairs[3]._ShapeA);
+	const BoundingSphere& b0 = _GetSphere(pairs[0]._ShapeB);
+	const BoundingSphere& b1 = _GetSphere(pairs[1]._ShapeB);
+	const BoundingSphere& b2 = _GetSphere(pairs[2]._ShapeB);
+	const BoundingSphere& b3 = _GetSphere(pairs[3]._ShapeB);
+
+	SimdVector3 centerA = _LoadVector(a0.Center, a1.Center, a2.Center, a3.Center);
+	SimdVector3 centerB = _LoadVector(b0.Center, b1.Center, b2.Center, b3.Center);
+	__m128 radiusA = _mm_setr_ps(a0.Radius, a1.Radius, a2.Radius, a3.Radius);
+	__m128 radiusB = _mm_setr_ps(b0.Radius, b1.Radius, b2.Radius, b3.Radius);
+
+	SimdVector3 offset;
+	offset.X = _mm_sub_ps(centerA.X, centerB.X);
+	offset.Y = _mm_sub_ps(centerA.Y, centerB.Y);
+	offset.Z = _mm_sub_ps(centerA.Z, centerB.Z);
+	__m128 distance = _mm_sqrt_ps(_Dot(offset, offset));
+	__m128 depth = _mm_sub_ps(_mm_add_ps(radiusA, radiusB), distance);
+
+	// The normal is up when the centers are equal
+	__m128 isSeparate = _mm_cmpgt_ps(distance, _mm_set1_ps(MinDistance));
+	__m128 inverse = _mm_div_ps(_mm_set1_ps(1.0f), _mm_max_ps(distance, _mm_set1_ps(MinDistance)));
+	SimdVector3 normal;
+	normal.X = _mm_and_ps(isSeparate, _mm_mul_ps(offset.X, inverse));
+	normal.Y = _Select(isSeparate, _mm_mul_ps(offset.Y, inverse), _mm_set1_ps(1.0f));
+	normal.Z = _mm_and_ps(isSeparate, _mm_mul_ps(offset.Z, inverse));
+
+	SimdVector3 position = _MultiplyAdd(centerB, normal,
+		_mm_sub_ps(radiusB, _mm_mul_ps(depth, _mm_set1_ps(0.5f))));
+	_StorePoints(normal, position, depth, results);
+}
+
+static void _SpherePlane4(const CollisionPair* pairs, CollisionResult* results)
+{
+	const BoundingSphere& s0 = _GetSphere(pairs[0]._ShapeA);
+	const BoundingSphere& s1 = _GetSphere(pairs[1]._ShapeA);
+	const BoundingSphere& s2 = _GetSphere(pairs[2]._ShapeA);
+	const BoundingSphere& s3 = _GetSphere(pairs[3]._ShapeA);
+	const Plane& p0 = _GetPlane(pairs[0]._ShapeB);
+	const Plane& p1 = _GetPlane(pairs[1]._ShapeB);
+	const Plane& p2 = _GetPlane(pairs[2]._ShapeB);
+	const Plane& p3 = _GetPlane(pairs[3]._ShapeB);
+
+	SimdVector3 center = _LoadVector(s0.Center, s1.Center, s2.Center, s3.Center);
+	__m128 radius = _mm_setr_ps(s0.Radius, s1.Radius, s2.Radius, s3.Radius);
+	SimdVector3 normal = _LoadVector(p0.Normal, p1.Normal, p2.Normal, p3.Normal);
+	__m128 d = _mm_setr_ps(p0.D, p1.D, p2.D, p3.D);
+
+	__m128 distance = _mm_add_ps(_Dot(normal, center), d);
+	__m128 depth = _mm_sub_ps(radius, distance);
+	SimdVector3 position = _MultiplyAdd(center, normal,
+		_mm_mul_ps(_mm_add_ps(radius, distance), _mm_set1_ps(-0.5f)));
+	_StorePoints(normal, position, depth, results);
+}
+
+static void _SphereBox4(const CollisionPair* pairs, CollisionResult* results)
+{
+	const BoundingSphere& s0 = _GetSphere(pairs[0]._ShapeA);
+	const BoundingSphere& s1 = _GetSphere(pairs[1]._ShapeA);
+	const BoundingSphere& s2 = _GetSphere(pairs[2]._ShapeA);
+	const BoundingSphere& s3 = _GetSphere(pairs[3]._ShapeA);
+	OBB b0 = _GetBox(pairs[0]._ShapeB, pairs[0]._BodyB);
+	OBB b1 = _GetBox(pairs[1]._ShapeB, pairs[1]._BodyB);
+	OBB b2 = _GetBox(pairs[2]._ShapeB, pairs[2]._BodyB);
+	OBB b3 = _GetBox(pairs[3]._ShapeB, pairs[3]._BodyB);
+
+	SimdVector3 center = _LoadVector(s0.Center, s1.Center, s2.Center, s3.Center);
+	__m128 radius = _mm_setr_ps(s0.Radius, s1.Radius, s2.Radius, s3.Radius);
+	SimdVector3 boxCenter = _LoadVector(b0.Center, b1.Center, b2.Center, b3.Center);
+	SimdVector3 extents = _LoadVector(b0.Extents, b1.Extents, b2.Extents, b3.Extents);
+	SimdVector3 axes[3];
+	for (int i = 0; i < 3; ++i)
+	{
+		axes[i] = _LoadVector(b0.Rotation.GetColumn(i), b1.Rotation.GetColumn(i),
+			b2.Rotation.GetColumn(i), b3.Rotation.GetColumn(i));
+	}
+
+	SimdVector3 offset;
+	offset.X = _mm_sub_ps(center.X, boxCenter.X);
+	offset.Y = _mm_sub_ps(center.Y, boxCenter.Y);
+	offset.Z = _mm_sub_ps(center.Z, boxCenter.Z);
+
+	SimdVector3 local;
+	local.X = _Dot(axes[0], offset);
+	local.Y = _Dot(axes[1], offset);
+	local.Z = _Dot(axes[2], offset);
+
+	// Closest point of the box to the center of the sphere
+	SimdVector3 closest;
+	closest.X = _mm_min_ps(_mm_max_ps(local.X, _mm_sub_ps(_mm_setzero_ps(), extents.X)), extents.X);
+	closest.Y = _mm_min_ps(_mm_max_ps(local.Y, _mm_sub_ps(_mm_setzero_ps(), extents.Y)), extents.Y);
+	closest.Z = _mm_min_ps(_mm_max_ps(local.Z, _mm_sub_ps(_mm_setzero_ps(), extents.Z)), extents.Z);
+
+	SimdVector3 difference;
+	difference.X = _mm_sub_ps(local.X, closest.X);
+	difference.Y = _mm_sub_ps(local.Y, closest.Y);
+	difference.Z = _mm_sub_ps(local.Z, closest.Z);
+	__m128 distanceSquared = _Dot(difference, difference);
+	__m128 isOutside = _mm_cmpgt_ps(distanceSquared, _mm_set1_ps(MinDistance * MinDistance));
+	__m128 distance = _mm_sqrt_ps(distanceSquared);
+	__m128 inverse = _mm_div_ps(_mm_set1_ps(1.0f), _mm_max_ps(distance, _mm_set1_ps(MinDistance)));
+
+	// Center inside of the box: closest face
+	__m128 one = _mm_set1_ps(1.0f);
+	__m128 signMask = _mm_set1_ps(-0.0f);
+	SimdVector3 penetration;
+	penetration.X = _mm_sub_ps(extents.X, _Abs(local.X));
+	penetration.Y = _mm_sub_ps(extents.Y, _Abs(local.Y));
+	penetration.Z = _mm_sub_ps(extents.Z, _Abs(local.Z));
+	__m128 isX = _mm_and_ps(_mm_cmple_ps(penetration.X, penetration.Y), _mm_cmple_ps(penetration.X, penetration.Z));
+	__m128 isY = _mm_andnot_ps(isX, _mm_cmple_ps(penetration.Y, penetration.Z));
+	__m128 isZ = _mm_cmpeq_ps(_mm_or_ps(isX, isY), _mm_setzero_ps());
+	SimdVector3 sign;
+	sign.X = _mm_or_ps(one, _mm_andnot_ps(_mm_cmpge_ps(local.X, _mm_setzero_ps()), signMask));
+	sign.Y = _mm_or_ps(one, _mm_andnot_ps(_mm_cmpge_ps(local.Y, _mm_setzero_ps()), signMask));
+	sign.Z = _mm_or_ps(one, _mm_andnot_ps(_mm_cmpge_ps(local.Z, _mm_setzero_ps()), signMask));
+	__m128 insideDepth = _mm_add_ps(radius, _Select(isX, penetration.X, _Select(isY, penetration.Y, penetration.Z)));
+
+	SimdVector3 localNormal;
+	localNormal.X = _Select(isOutside, _mm_mul_ps(difference.X, inverse), _mm_and_ps(isX, sign.X));
+	localNormal.Y = _Select(isOutside, _mm_mul_ps(difference.Y, inverse), _mm_and_ps(isY, sign.Y));
+	localNormal.Z = _Select(isOutside, _mm_mul_ps(difference.Z, inverse), _mm_and_ps(isZ, sign.Z));
+
+	SimdVector3 surface;
+	surface.X = _Select(isOutside, closest.X, _Select(isX, _mm_mul_ps(sign.X, extents.X), local.X));
+	surface.Y = _Select(isOutside, closest.Y, _Select(isY, _mm_mul_ps(sign.Y, extents.Y), local.Y));
+	surface.Z = _Select(isOutside, closest.Z, _Select(isZ, _mm_mul_ps(sign.Z, extents.Z), local.Z));
+
+	__m128 depth = _Select(isOutside, _mm_sub_ps(radius, distance), insideDepth);
+	SimdVector3 position = _MultiplyAdd(surface, localNormal, _mm_mul_ps(depth, _mm_set1_ps(-0.5f)));
+
+	// Back to world space
+	SimdVector3 normal;
+	normal.X = _mm_add_ps(_mm_add_ps(_mm_mul_ps(axes[0].X, localNormal.X), _mm_mul_ps(axes[1].X, localNormal.Y)), _mm_mul_ps(axes[2].X, localNormal.Z));
+	normal.Y = _mm_add_ps(_mm_add_ps(_mm_mul_ps(axes[0].Y, localNormal.X), _mm_mul_ps(axes[1].Y, localNormal.Y)), _mm_mul_ps(axes[2].Y, localNormal.Z));
+	normal.Z = _mm_add_ps(_mm_add_ps(_mm_mul_ps(axes[0].Z, localNormal.X), _mm_mul_ps(axes[1].Z, localNormal.Y)), _mm_mul_ps(axes[2].Z, localNormal.Z));
+
+	SimdVector3 world = _MultiplyAdd(boxCenter, axes[0], position.X);
+	world = _MultiplyAdd(world, axes[1], position.Y);
+	world = _MultiplyAdd(world, axes[2], position.Z);
+
+	_StorePoints(normal, world, depth, results);
+}
+
+static void _BoxPlane4(const CollisionPair* pairs, CollisionResult* results)
+{
+	OBB boxes[BatchSize];
+	const Plane* planes[BatchSize];
+	for (int32 i = 0; i < BatchSize; ++i)
+	{
+		boxes[i] = _GetBox(pairs[i]._ShapeA, pairs[i]._BodyA);
+		planes[i] = &_GetPlane(pairs[i]._ShapeB);
+	}
+
+	SimdVector3 normal = _LoadVector(planes[0]->Normal, planes[1]->Normal, planes[2]->Normal, planes[3]->Normal);
+	SimdVector3 center = _LoadVector(boxes[0].Center, boxes[1].Center, boxes[2].Center, boxes[3].Center);
+	__m128 d = _mm_setr_ps(planes[0]->D, planes[1]->D, planes[2]->D, planes[3]->D);
+	__m128 distance = _mm_add_ps(_Dot(normal, center), d);
+
+	__m128 projections[3];
+	for (int i = 0; i < 3; ++i)
+	{
+		SimdVector3 axis = _LoadVector(boxes[0].Rotation.GetColumn(i), boxes[1].Rotation.GetColumn(i),
+			boxes[2].Rotation.GetColumn(i), boxes[3].Rotation.GetColumn(i));
+		__m128 extent = _mm_setr_ps(boxes[0].Extents[i], boxes[1].Extents[i], boxes[2].Extents[i], boxes[3].Extents[i]);
+		projections[i] = _mm_mul_ps(extent, _Dot(normal, axis));
+	}
+
+	// Depths of the 8 corners of the 4 boxes
+	real32 corners[8][BatchSize];
+	for (int32 corner = 0; corner < 8; ++corner)
+	{
+		__m128 value = distance;
+		for (int i = 0; i < 3; ++i)
+		{
+			value = ((corner >> i) & 1) ? _mm_add_ps(value, projections[i]) : _mm_sub_ps(value, projections[i]);
+		}
+		_mm_storeu_ps(corners[corner], _mm_sub_ps(_mm_setzero_ps(), value));
+	}
+
+	for (int32 i = 0; i < BatchSize; ++i)
+	{
+		real depths[8];
+		for (int32 corner = 0; corner < 8; ++corner)
+		{
+			depths[corner] = corners[corner][i];
+		}
+		_AddBoxPlaneCorners(boxes[i], *planes[i], depths, results[i]);
+	}
+}
+#endif
+
+/*-----------------------------------------------------------------------------
+	Batch functions of the dispatch table.
+-----------------------------------------------------------------------------*/
+
+static void _CollideSpheres(const CollisionPair* pairs, int32 count, CollisionResult* results)
+{
+	int32 i = 0;
+#if SE_NARROWPHASE_SSE
+	for (; i + BatchSize <= count; i += BatchSize)
+	{
+		_SphereSphere4(pairs + i, results + i);
+	}
+#endif
+	for (; i < count; ++i)
+	{
+		_SphereSphere(_GetSphere(pairs[i]._ShapeA), _GetSphere(pairs[i]._ShapeB), results[i]);
+	}
+}
+
+static void _CollideSpherePlanes(const CollisionPair* pairs, int32 count, CollisionResult* results)
+{
+	int32 i = 0;
+#if SE_NARROWPHASE_SSE
+	for (; i + BatchSize <= count; i += BatchSize)
+	{
+		_SpherePlane4(pairs + i, results + i);
+	}
+#endif
+	for (; i < count; ++i)
+	{
+		_SpherePlane(_GetSphere(pairs[i]._ShapeA), _GetPlane(pairs[i]._ShapeB), results[i]);
+	}
+}
+
+static void _CollideSphereBoxes(const CollisionPair* pairs, int32 count, CollisionResult* results)
+{
+	int32 i = 0;
+#if SE_NARROWPHASE_SSE
+	for (; i + BatchSize <= count; i += BatchSize)
+	{
+		_SphereBox4(pairs + i, results + i);
+	}
+#endif
+	for (; i < count; ++i)
+	{
+		_SphereBox(_GetSphere(pairs[i]._ShapeA), _GetBox(pairs[i]._ShapeB, pairs[i]._BodyB), results[i]);
+	}
+}
+
+static void _CollideBoxPlanes(const CollisionPair* pairs, int32 count, CollisionResult* results)
+{
+	int32 i = 0;
+#if SE_NARROWPHASE_SSE
+	for (; i + BatchSize <= count; i += BatchSize)
+	{
+		_BoxPlane4(pairs + i, results + i);
+	}
+#endif
+	for (; i < count; ++i)
+	{
+		_BoxPlane(_GetBox(pairs[i]._ShapeA, pairs[i]._BodyA), _GetPlane(pairs[i]._ShapeB), results[i]);
+	}
+}
+
+static void _CollideBoxes(const CollisionPair* pairs, int32 count, CollisionResult* results)
+{
+	// The clipping has too many branches to test several pairs at once
+	for (int32 i = 0; i < count; ++i)
+	{
+		_BoxBox(_GetBox(pairs[i]._ShapeA, pairs[i]._BodyA), _GetBox(pairs[i]._ShapeB, pairs[i]._BodyB), results[i]);
+	}
+}
+
+/*-----------------------------------------------------------------------------
+	Manifolds.
+-----------------------------------------------------------------------------*/
+
+/**
+	Keeps the deepest point, the point the furthest from it, the point making
+	the largest triangle with them and the point adding the largest area.
+	@return The number of points kept.
+*/
+static int32 _ReducePoints(const ManifoldPoint* points, int32 count, ManifoldPoint* result)
+{
+	int32 indices[ContactManifold::MaxPoints];
+
+	indices[0] = 0;
+	for (int32 i = 1; i < count; ++i)
+	{
+		if (points[i]._Depth > points[indices[0]]._Depth)
+			indices[0] = i;
+	}
+	const Vector3& p0 = points[indices[0]]._Position;
+
+	real maxValue = 0.0;
+	indices[1] = -1;
+	for (int32 i = 0; i < count; ++i)
+	{
+		real value = (points[i]._Position - p0).LengthSquared();
+		if (value > maxValue)
+		{
+			maxValue = value;
+			indices[1] = i;
+		}
+	}
+	if (indices[1] < 0)
+	{
+		result[0] = points[indices[0]];
+		return 1;
+	}
+	const Vector3& p1 = points[indices[1]]._Position;
+
+	maxValue = 0.0;
+	indices[2] = -1;
+	for (int32 i = 0; i < count; ++i)
+	{
+		real value = Vector3::Cross(p1 - p0, points[i]._Position - p0).LengthSquared();
+		if (value > maxValue)
+		{
+			maxValue = value;
+			indices[2] = i;
+		}
+	}
+	if (indices[2] < 0)
+	{
+		result[0] = points[indices[0]];
+		result[1] = points[indices[1]];
+		return 2;
+	}
+	const Vector3& p2 = points[indices[2]]._Position;
+
+	// The point the furthest outside of an edge of the triangle
+	Vector3 normal = Vector3::Cross(p1 - p0, p2 - p0);
+	const Vector3* triangle[3] = { &p0, &p1, &p2 };
+	maxValue = 0.0;
+	indices[3] = -1;
+	for (int32 i = 0; i < count; ++i)
+	{
+		for (int32 j = 0; j < 3; ++j)
+		{
+			const Vector3& start = *triangle[j];
+			const Vector3& end = *triangle[(j + 1) % 3];
+			real value = -Vector3::Dot(Vector3::Cross(end - start, points[i]._Position - start), normal);
+			if (value > maxValue)
+			{
+				maxValue = value;
+				indices[3] = i;
+			}
+		}
+	}
+
+	int32 resultCount = (indices[3] < 0) ? 3 : 4;
+	for (int32 i = 0; i < resultCount; ++i)
+	{
+		result[i] = points[indices[i]];
+	}
+	return resultCount;
+}
+
+
+NarrowPhase::NarrowPhase()
+{
+	for (int32 i = 0; i < ShapeTypeCount; ++i)
+	{
+		for (int32 j = 0; j < ShapeTypeCount; ++j)
+		{
+			_Functions[i][j] = NULL;
+			_IsSwapped[i][j] = false;
+		}
+	}
+
+	// The capsules and the meshes are tested as boxes
+	SetCollideFunction(ShapeType_Sphere, ShapeType_Sphere, _CollideSpheres);
+	SetCollideFunction(ShapeType_Sphere, ShapeType_Plane, _CollideSpherePlanes);
+
+	const ShapeType boxTypes[] = { ShapeType_Box, ShapeType_Capsule, ShapeType_Mesh };
+	for (int32 i = 0; i < 3; ++i)
+	{
+		SetCollideFunction(ShapeType_Sphere, boxTypes[i], _CollideSphereBoxes);
+		SetCollideFunction(boxTypes[i], ShapeType_Plane, _CollideBoxPlanes);
+		for (int32 j = i; j < 3; ++j)
+		{
+			SetCollideFunction(boxTypes[i], boxTypes[j], _CollideBoxes);
+		}
+	}
+}
+
+void NarrowPhase::SetCollideFunction(ShapeType typeA, ShapeType typeB, CollideFunction function)
+{
+	SE_ASSERT(typeA < ShapeTypeCount && typeB < ShapeTypeCount);
+
+	_Functions[typeA][typeB] = function;
+	_IsSwapped[typeA][typeB] = false;
+	if (typeA != typeB)
+	{
+		_Functions[typeB][typeA] = function;
+		_IsSwapped[typeB][typeA] = true;
+	}
+}
+
+CollideFunction NarrowPhase::GetCollideFunction(ShapeType typeA, ShapeType typeB) const
+{
+	return _Functions[typeA][typeB];
+}
+
+uint64 NarrowPhase::GetManifoldKey(int32 proxyA, int32 proxyB)
+{
+	return ((uint64)(uint32)proxyA << 32) | (uint32)proxyB;
+}
+
+void NarrowPhase::AddPair(PhysicsBody* bodyA, PhysicsBody* bodyB)
+{
+	if (bodyA->Shapes().IsEmpty() || bodyB->Shapes().IsEmpty())
+		return;
+
+	// The bodies of a manifold are sorted by proxy
+	if (bodyA->GetBroadPhaseProxy() > bodyB->GetBroadPhaseProxy())
+		SE_Swap(bodyA, bodyB);
+
+	CollisionPair pair;
+	pair._ShapeA = bodyA->Shapes()[0].Get();
+	pair._ShapeB = bodyB->Shapes()[0].Get();
+	pair._BodyA = bodyA;
+	pair._BodyB = bodyB;
+	pair._IsSwapped = false;
+	if (_Functions[pair._ShapeA->GetShapeType()][pair._ShapeB->GetShapeType()] == NULL)
+		return;
+
+	uint64 key = GetManifoldKey(bodyA->GetBroadPhaseProxy(), bodyB->GetBroadPhaseProxy());
+	const int32* index = _ManifoldIndices.Find(key);
+	if (index != NULL)
+	{
+		pair._Manifold = *index;
+	}
+	else
+	{
+		pair._Manifold = _Manifolds.Count();
+		_ManifoldIndices.Add(key, pair._Manifold);
+
+		ContactManifold& manifold = _Manifolds.EmplaceBack();
+		manifold._Key = key;
+		manifold._BodyA = NULL;
+		manifold._BodyB = NULL;
+	}
+
+	// A proxy can be reused by another body before the pair of the previous one is removed
+	ContactManifold& manifold = _Manifolds[pair._Manifold];
+	if (manifold._BodyA != bodyA || manifold._BodyB != bodyB)
+	{
+		manifold._BodyA = bodyA;
+		manifold._BodyB = bodyB;
+		manifold._PointCount = 0;
+	}
+
+	_Pairs.Add(pair);
+}
+
+void NarrowPhase::DestroyManifold(int32 proxyA, int32 proxyB)
+{
+	if (proxyA > proxyB)
+		SE_Swap(proxyA, proxyB);
+
+	uint64 key = GetManifoldKey(proxyA, proxyB);
+	const int32* found = _ManifoldIndices.Find(key);
+	if (found == NULL)
+		return;
+
+	int32 index = *found;
+	_ManifoldIndices.Remove(key);
+
+	// The last manifold is moved to the removed index
+	int32 last = _Manifolds.Count() - 1;
+	if (index != last)
+	{
+		_Manifolds[index] = _Manifolds[last];
+		*_ManifoldIndices.Find(_Manifolds[index]._Key) = index;
+	}
+	_Manifolds.RemoveAt(last);
+}
+
+void NarrowPhase::Update()
+{
+	int32 i;
+	const int32 functionCount = ShapeTypeCount * ShapeTypeCount;
+
+	_TouchingManifolds.Clear();
+
+	int32 pairCount = _Pairs.Count();
+	if (pairCount == 0)
+		return;
+
+	// Groups the pairs by function, with their shapes in the order of the function
+	int32 starts[functionCount + 1];
+	for (i = 0; i <= functionCount; ++i)
+	{
+		starts[i] = 0;
+	}
+
+	_PairFunctions.Resize(pairCount);
+	for (i = 0; i < pairCount; ++i)
+	{
+		CollisionPair& pair = _Pairs[i];
+		ShapeType typeA = pair._ShapeA->GetShapeType();
+		ShapeType typeB = pair._ShapeB->GetShapeType();
+		if (_IsSwapped[typeA][typeB])
+		{
+			SE_Swap(pair._ShapeA, pair._ShapeB);
+			SE_Swap(pair._BodyA, pair._BodyB);
+			pair._IsSwapped = true;
+			_PairFunctions[i] = typeB * ShapeTypeCount + typeA;
+		}
+		else
+		{
+			_PairFunctions[i] = typeA * ShapeTypeCount + typeB;
+		}
+		starts[_PairFunctions[i] + 1]++;
+	}
+
+	for (i = 0; i < functionCount; ++i)
+	{
+		starts[i + 1] += starts[i];
+	}
+
+	_SortedPairs.Resize(pairCount);
+	for (i = 0; i < pairCount; ++i)
+	{
+		_SortedPairs[starts[_PairFunctions[i]]++] = _Pairs[i];
+	}
+
+	// The starts were moved to the end of each group
+	_Results.Resize(pairCount);
+	int32 start = 0;
+	for (i = 0; i < functionCount; ++i)
+	{
+		int32 count = starts[i] - start;
+		if (count > 0)
+		{
+			_Functions[i / ShapeTypeCount][i % ShapeTypeCount](&_SortedPairs[start], count, &_Results[start]);
+		}
+		start = starts[i];
+	}
+
+	for (i = 0; i < pairCount; ++i)
+	{
+		const CollisionPair& pair = _SortedPairs[i];
+		CollisionResult& result = _Results[i];
+		if (pair._IsSwapped)
+		{
+			result._Normal = -result._Normal;
+		}
+
+		ContactManifold& manifold = _Manifolds[pair._Manifold];
+		UpdateManifold(manifold, result);
+		if (manifold._PointCount > 0)
+		{
+			_TouchingManifolds.Add(pair._Manifold);
+		}
+	}
+
+	_Pairs.Clear();
+}
+
+void NarrowPhase::UpdateManifold(ContactManifold& manifold, const CollisionResult& result)
+{
+	int32 i, j;
+
+	// The shapes are separated
+	if (result._PointCount == 0)
+	{
+		manifold._PointCount = 0;
+		return;
+	}
+
+	const Vector3& normal = result._Normal;
+	Vector3 positionA = manifold._BodyA->GetPosition();
+	Vector3 positionB = manifold._BodyB->GetPosition();
+	Matrix3 orientationA = manifold._BodyA->GetOrientationMatrix();
+	Matrix3 orientationB = manifold._BodyB->GetOrientationMatrix();
+	Matrix3 inverseA = Matrix3::Transpose(orientationA);
+	Matrix3 inverseB = Matrix3::Transpose(orientationB);
+
+	ManifoldPoint points[ContactManifold::MaxPoints + CollisionResult::MaxPoints];
+	int32 count = 0;
+
+	for (i = 0; i < result._PointCount; ++i)
+	{
+		ManifoldPoint& point = points[count++];
+		point._Position = result._Positions[i];
+		point._Depth = result._Depths[i];
+
+		Vector3 halfDepth = normal * (point._Depth * (real)0.5);
+		point._LocalPointA = inverseA.Transform(point._Position - halfDepth - positionA);
+		point._LocalPointB = inverseB.Transform(point._Position + halfDepth - positionB);
+	}
+
+	// The points of the previous step follow the bodies, until they separate or slide
+	for (i = 0; i < manifold._PointCount; ++i)
+	{
+		const ManifoldPoint& previous = manifold._Points[i];
+		Vector3 pointA = positionA + orientationA.Transform(previous._LocalPointA);
+		Vector3 pointB = positionB + orientationB.Transform(previous._LocalPointB);
+		Vector3 offset = pointB - pointA;
+		real depth = Vector3::Dot(offset, normal);
+		if (depth < -BreakingDistance || (offset - normal * depth).LengthSquared() > BreakingDistance * BreakingDistance)
+			continue;
+
+		Vector3 position = (pointA + pointB) * (real)0.5;
+		bool isReplaced = false;
+		for (j = 0; j < result._PointCount && !isReplaced; ++j)
+		{
+			isReplaced = ((points[j]._Position - position).LengthSquared() < MergeDistance * MergeDistance);
+		}
+		if (isReplaced)
+			continue;
+
+		ManifoldPoint& point = points[count++];
+		point = previous;
+		point._Position = position;
+		point._Depth = depth;
+	}
+
+	manifold._Normal = normal;
+	if (count <= ContactManifold::MaxPoints)
+	{
+		for (i = 0; i < count; ++i)
+		{
+			manifold._Points[i] = points[i];
+		}
+		manifold._PointCount = count;
+	}
+	else
+	{
+		manifold._PointCount = _ReducePoints(points, count, manifold._Points);
+	}
+}
+
+}
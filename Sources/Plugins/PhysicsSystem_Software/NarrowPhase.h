@@ -0,0 +1,153 @@
+/*=============================================================================
+NarrowPhase.h
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+#ifndef _SE_NARROWPHASE_H_
+#define _SE_NARROWPHASE_H_
+
+#include "SoftwarePhysicsSystem.h"
+
+namespace SE_Software
+{
+
+class PhysicsBody;
+
+/** Point of a contact manifold. */
+struct ManifoldPoint
+{
+	/// Middle of the two surfaces.
+	Vector3 _Position;
+
+	/// Penetration depth along the normal of the manifold.
+	real _Depth;
+
+	/// Points of the surfaces in the space of their body, used to follow the bodies at the next step.
+	Vector3 _LocalPointA;
+	Vector3 _LocalPointB;
+};
+
+/** Contact points between two bodies, kept across the steps. */
+struct ContactManifold
+{
+	static const int32 MaxPoints = 4;
+
+	uint64 _Key;
+	PhysicsBody* _BodyA;
+	PhysicsBody* _BodyB;
+
+	/// The normal points from the body B to the body A.
+	Vector3 _Normal;
+	ManifoldPoint _Points[MaxPoints];
+	int32 _PointCount;
+};
+
+/** Pair of shapes passed to a collision function. */
+struct CollisionPair
+{
+	const IShape* _ShapeA;
+	const IShape* _ShapeB;
+	const PhysicsBody* _BodyA;
+	const PhysicsBody* _BodyB;
+	int32 _Manifold;
+	bool _IsSwapped;
+};
+
+/** Contact points found by a collision function, before they are merged in the manifold. */
+struct CollisionResult
+{
+	static const int32 MaxPoints = 8;
+
+	/// The normal points from the shape B to the shape A.
+	Vector3 _Normal;
+	Vector3 _Positions[MaxPoints];
+	real _Depths[MaxPoints];
+	int32 _PointCount;
+};
+
+/**
+	Finds the contact points of a batch of pairs of shapes.
+	@param pairs The pairs, their shapes have the types the function was registered for.
+	@param count The number of pairs.
+	@param results [out] The contact points of each pair.
+*/
+typedef void (*CollideFunction)(const CollisionPair* pairs, int32 count, CollisionResult* results);
+
+/**
+	@brief Contact generation between the pairs found by the broad phase.
+
+	The collision functions are stored in a table indexed by the types of the
+	two shapes. The pairs are grouped by function and each function processes
+	its pairs in one call, the sphere functions and the box/plane function test
+	four pairs at once with SSE. The capsules and the meshes are tested with
+	the world bounding box of their body.
+
+	Each pair of bodies keeps a manifold of at most four points. The points of
+	the previous step are moved with the bodies and kept while they don't
+	separate, the new points replace the close ones and the manifold is reduced
+	to the deepest point and the points covering the largest area.
+*/
+class NarrowPhase
+{
+public:
+	NarrowPhase();
+
+	/** @name Dispatch. */
+	//@{
+	/** Sets the function for two types of shapes, it is also used when the shapes are swapped. */
+	void SetCollideFunction(ShapeType typeA, ShapeType typeB, CollideFunction function);
+
+	/** Gets the function for two types of shapes. */
+	CollideFunction GetCollideFunction(ShapeType typeA, ShapeType typeB) const;
+	//@}
+
+	/** @name Manifolds. */
+	//@{
+	/** Adds a pair of bodies to test at the next update. */
+	void AddPair(PhysicsBody* bodyA, PhysicsBody* bodyB);
+
+	/** Finds the contact points of the added pairs and updates their manifolds. */
+	void Update();
+
+	/** Destroys the manifold of two broad phase proxies, when their pair was removed. */
+	void DestroyManifold(int32 proxyA, int32 proxyB);
+
+	/** Gets the manifolds with contact points after the last update. */
+	const BaseArray<int32>& GetTouchingManifolds() const { return _TouchingManifolds; }
+
+	/** Gets the manifold at the specified index. */
+	const ContactManifold& GetManifold(int32 index) const { return _Manifolds[index]; }
+
+	/** Gets the number of manifolds. */
+	int32 GetManifoldCount() const { return _Manifolds.Count(); }
+	//@}
+
+protected:
+	/// Number of types of shapes in the dispatch table.
+	static const int32 ShapeTypeCount = ShapeType_Compound + 1;
+
+	void UpdateManifold(ContactManifold& manifold, const CollisionResult& result);
+
+	static uint64 GetManifoldKey(int32 proxyA, int32 proxyB);
+
+	CollideFunction _Functions[ShapeTypeCount][ShapeTypeCount];
+	bool _IsSwapped[ShapeTypeCount][ShapeTypeCount];
+
+	BaseArray<ContactManifold> _Manifolds;
+	Hashtable<uint64, int32> _ManifoldIndices;
+	BaseArray<int32> _TouchingManifolds;
+
+	BaseArray<CollisionPair> _Pairs;
+	BaseArray<CollisionPair> _SortedPairs;
+	BaseArray<CollisionResult> _Results;
+	BaseArray<int32> _PairFunctions;
+
+private:
+	NarrowPhase(const NarrowPhase&);
+	NarrowPhase& operator=(const NarrowPhase&);
+};
+
+}
+
+#endif
@@ -57,6 +57,8 @@ PhysicsBody::PhysicsBody(PhysicsScene* scene, const BodyDescription& desc) :
 	_Orientation(Quaternion::Identity),
 	_OrientationMatrix(Matrix3::Identity),
 	_InverseOrientationMatrix(Matrix3::Identity),
+	_PreviousPosition(Vector3::Zero),
+	_PreviousOrientation(Quaternion::Identity),
 	_COMPosition(Vector3::Zero),
 	_COMWorldPosition(Vector3::Zero),
 	_COMOrientation(Quaternion::Identity),
@@ -75,7 +77,10 @@ PhysicsBody::PhysicsBody(PhysicsScene* scene, const BodyDescription& desc) :
 	_AngularMomentum(Vector3::Zero),
 	_MaxAngularVelocity(0.0),
 	_Forces(Vector3::Zero),
-	_Torques(Vector3::Zero)
+	_Torques(Vector3::Zero),
+	_BroadPhaseProxy(BroadPhase::NullProxy),
+	_SolverIndex(-1),
+	_SleepTime(0.0)
 {
 	_Scene = scene;
 	_BodyType = desc._BodyType;
@@ -94,6 +99,7 @@ PhysicsBody::PhysicsBody(PhysicsScene* scene, const BodyDescription& desc) :
 	_Solver = new ODESolverEuler(sizeof(PhysicsBody::State) / sizeof(real), BodyDerivatives, this);
 
 	CreateFromShapes();
+	UpdateShapes();
 }
 
 PhysicsBody::~PhysicsBody()
@@ -114,6 +120,8 @@ void PhysicsBody::CreateFromShapes()
 		shape->SetMaterial(_Scene->GetMaterial(_Scene->GetDefaultMaterial()));
 	}
 
+	_LocalBoundingBox = shape->ComputeBoundingBox();
+
 	if (_BodyType == BodyType_Static)
 		return;
 
@@ -127,7 +135,6 @@ void PhysicsBody::CreateFromShapes()
 	real mass = shape->GetMass();
 
 	SetInertiaTensor(shape->ComputeInertiaTensor());
-	_LocalBoundingBox = shape->ComputeBoundingBox();
 
 	switch (shape->GetShapeType())
 	{
@@ -175,6 +182,9 @@ void PhysicsBody::CreateFromShapes()
 
 void PhysicsBody::UpdateShapes()
 {
+	_WorldBoundingBox = _LocalBoundingBox;
+	_WorldBoundingBox.Transform(Matrix4(_OrientationMatrix, _Position));
+
 	if (_Shapes.IsEmpty())
 		return;
 
@@ -223,6 +233,38 @@ void PhysicsBody::UpdateInertiaTensor()
 	_InverseWorldInertiaTensor = _OrientationMatrix * _InverseInertiaTensor * _InverseOrientationMatrix;
 }
 
+void PhysicsBody::ResetPreviousState()
+{
+	_PreviousPosition = _Position;
+	_PreviousOrientation = _Orientation;
+}
+
+void PhysicsBody::SetActive(bool value)
+{
+	_Active = value;
+	_SleepTime = 0.0;
+
+	// A sleeping body doesn't move until it is woken up
+	if (!_Active)
+	{
+		ResetPreviousState();
+		_LinearVelocity = Vector3::Zero;
+		_AngularVelocity = Vector3::Zero;
+		_Forces = Vector3::Zero;
+		_Torques = Vector3::Zero;
+	}
+}
+
+Vector3 PhysicsBody::GetInterpolatedPosition(real alpha) const
+{
+	return Vector3::Lerp(_PreviousPosition, _Position, alpha);
+}
+
+Quaternion PhysicsBody::GetInterpolatedOrientation(real alpha) const
+{
+	return Quaternion::Slerp(_PreviousOrientation, _Orientation, alpha);
+}
+
 Vector3 PhysicsBody::GetPosition() const
 {
 	return _Position;
@@ -231,6 +273,7 @@ Vector3 PhysicsBody::GetPosition() const
 void PhysicsBody::SetPosition(const Vector3& value)
 {
 	_Position = value;
+	ResetPreviousState();
 	UpdateShapes();
 }
 
@@ -249,6 +292,7 @@ void PhysicsBody::SetOrientation(const Quaternion& value)
 	_Orientation = value;
 	_Orientation.ToRotationMatrix(_OrientationMatrix);
 	_InverseOrientationMatrix = Matrix3::Transpose(_OrientationMatrix);
+	ResetPreviousState();
 	UpdateInertiaTensor();
 	UpdateShapes();
 }
@@ -258,6 +302,7 @@ void PhysicsBody::SetOrientationMatrix(const Matrix3& value)
 	_OrientationMatrix = value;
 	_Orientation = Quaternion::FromRotationMatrix(_OrientationMatrix);
 	_InverseOrientationMatrix = Matrix3::Transpose(_OrientationMatrix);
+	ResetPreviousState();
 	UpdateInertiaTensor();
 	UpdateShapes();
 }
@@ -723,6 +768,16 @@ void PhysicsBody::UpdateVelocity(real64 elapsed)
 {
 	if (_BodyType == BodyType_Dynamic)
 	{
+		// Gravity
+		// Add the gravity force: P = m * g.
+		if (_GravityEnabled)
+			_Forces += _Mass * _Scene->GetGravity();
+
+		// Damping
+		// Apply a force and torque in the opposite direction of motion scaled by the body's velocity 
+		_Forces -= _LinearDamping * _LinearVelocity;
+		_Torques -= _AngularDamping * _AngularVelocity;
+
 		// Integrate
 		_LinearMomentum = (_Forces * elapsed);
 		_AngularMomentum = (_Torques * elapsed);
@@ -730,6 +785,10 @@ void PhysicsBody::UpdateVelocity(real64 elapsed)
 		_LinearVelocity += _InverseMass * _LinearMomentum;
 		_AngularVelocity += _InverseInertiaTensor * _AngularMomentum;
 	}
+
+	// Reset forces
+	_Forces = Vector3::Zero;
+	_Torques = Vector3::Zero;
 }
 
 void PhysicsBody::Integrate(real delta, PhysicsBody::State& next)
@@ -741,18 +800,8 @@ void PhysicsBody::Update(real64 elapsed)
 {
 	PhysicsBody::State next;
 
-	if (_BodyType == BodyType_Dynamic)
-	{
-		// Gravity
-		// Add the gravity force: P = m * g.
-		if (_GravityEnabled)
-			_Forces += _Mass * _Scene->GetGravity();
-
-		// Damping
-		// Apply a force and torque in the opposite direction of motion scaled by the body's velocity 
-		_Forces -= _LinearDamping * _LinearVelocity;
-		_Torques -= _AngularDamping * _AngularVelocity;
-	}
+	// The velocity is integrated by UpdateVelocity before the collision response
+	ResetPreviousState();
 
 #if 0
 	if (_BodyType == BodyType_Dynamic)
@@ -783,15 +832,16 @@ void PhysicsBody::Update(real64 elapsed)
 	}
 
 #else
-	UpdateVelocity(elapsed);
-
 	// Update the position
 	_Position += _LinearVelocity * elapsed;
 
 	// Update the orientation
-	_AngularVelocity.Normalize();
-	_Orientation *= Quaternion::FromAxisAngle(_AngularVelocity, elapsed);
-	_Orientation.Normalize();
+	real angularSpeed = _AngularVelocity.Length();
+	if (angularSpeed > Math::Epsilon)
+	{
+		_Orientation *= Quaternion::FromAxisAngle(_AngularVelocity / angularSpeed, angularSpeed * elapsed);
+		_Orientation.Normalize();
+	}
 
 	// Update the orientation matrix
 	_Orientation.ToRotationMatrix(_OrientationMatrix);
@@ -800,13 +850,6 @@ void PhysicsBody::Update(real64 elapsed)
 	// Update the world inertia tensor and shapes
 	UpdateInertiaTensor();
 	UpdateShapes();
-
-	_WorldBoundingBox = _LocalBoundingBox;
-	_WorldBoundingBox.Transform(Matrix4(_OrientationMatrix, _Position));
-
-	// Reset forces
-	_Forces = Vector3::Zero;
-	_Torques = Vector3::Zero;
 }
 
 }
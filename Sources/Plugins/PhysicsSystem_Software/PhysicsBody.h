@@ -94,7 +94,7 @@ public:
 	virtual bool GetEnabled() const { return _Enabled; }
 	virtual void SetEnabled(bool value) { _Enabled = value; }
 	virtual bool GetActive() const { return _Active; }
-	virtual void SetActive(bool value) { _Active = value; }
+	virtual void SetActive(bool value);
 	virtual bool GetGravityEnabled() const { return _GravityEnabled; }
 	virtual void SetGravityEnabled(bool value) { _GravityEnabled = value; }
 
@@ -160,15 +160,28 @@ public:
 	virtual void AddTorqueImpulse(const Vector3& torque);
 	virtual void AddLocalTorqueImpulse(const Vector3& torque);
 
+	virtual Vector3 GetInterpolatedPosition(real alpha) const;
+	virtual Quaternion GetInterpolatedOrientation(real alpha) const;
+
 	virtual void Update(real64 elapsed);
 
 	real GetInverseMass() const { return _InverseMass; }
+
+	int32 GetBroadPhaseProxy() const { return _BroadPhaseProxy; }
+	void SetBroadPhaseProxy(int32 value) { _BroadPhaseProxy = value; }
+
+	int32 GetSolverIndex() const { return _SolverIndex; }
+	void SetSolverIndex(int32 value) { _SolverIndex = value; }
+
+	real GetSleepTime() const { return _SleepTime; }
+	void SetSleepTime(real value) { _SleepTime = value; }
 	void UpdateVelocity(real64 elapsed);
 
 private:
 	void CreateFromShapes();
 	void UpdateShapes();
 	void UpdateInertiaTensor();
+	void ResetPreviousState();
 	void Integrate(real delta, PhysicsBody::State& next);
 
 	friend void BodyDerivatives(real t, const real* state, real* deltaState, const void* userData);
@@ -187,6 +200,8 @@ protected:
 	Quaternion _Orientation;
 	Matrix3 _OrientationMatrix;
 	Matrix3 _InverseOrientationMatrix;
+	Vector3 _PreviousPosition;
+	Quaternion _PreviousOrientation;
 
 	bool _Enabled;
 	bool _Active;
@@ -222,6 +237,10 @@ protected:
 
 	IntegrationType _IntegrationType;
 	ODESolver* _Solver;
+
+	int32 _BroadPhaseProxy;
+	int32 _SolverIndex;
+	real _SleepTime;
 };
 
 }
@@ -7,282 +7,185 @@ Author: Julien Delezenne
 #include "PhysicsScene.h"
 #include "PhysicsBody.h"
 #include "PhysicsMaterial.h"
+#include "ShapeQuery.h"
 
 namespace SE_Software
 {
 
-SpaceDivisionObject::SpaceDivisionObject() :
-	Object()
-{
-}
-
-SpaceDivisionObject::~SpaceDivisionObject()
-{
-}
-
-
-SpaceDivision::SpaceDivision() :
-	Object()
-{
-}
-
-SpaceDivision::~SpaceDivision()
-{
-}
-
-
-OctreeSpace::Node::Node()
-{
-}
-
-OctreeSpace::OctreeSpace() :
-	SpaceDivision()
-{
-}
-
-OctreeSpace::~OctreeSpace()
+PhysicsScene::PhysicsScene(PhysicsSystem* physicsSystem, const SceneDescription& desc) :
+	Physics::IScene(),
+	_PhysicsSystem(physicsSystem),
+	_Description(desc),
+	_Accumulator(0.0),
+	_InterpolationAlpha(1.0),
+	_AwakeBodyCount(0),
+	_SleepingBodyCount(0)
 {
-}
+	_BroadPhase = BroadPhase::Create(_Description._BroadPhase);
 
-void OctreeSpace::AddObject(SpaceDivisionObject* object)
-{
+	// Creates the default material
+	IMaterial* material = CreateMaterial();
+	material->SetDynamicFriction(0.5f);
+	material->SetStaticFriction(0.5f);
+	material->SetRestitution(0.5f);
+	_DefaultMaterial = material->GetIndex();
 }
 
-void OctreeSpace::RemoveObject(SpaceDivisionObject* object)
+PhysicsScene::~PhysicsScene()
 {
+	SE_DELETE(_BroadPhase);
 }
 
-void OctreeSpace::InternalAddNode(Node* node)
+bool PhysicsScene::IsAwake(const PhysicsBody* body)
 {
+	return (body->GetBodyType() == BodyType_Dynamic && body->GetActive());
 }
 
-void OctreeSpace::InternalRemoveNode(Node* node)
+IMaterial* PhysicsScene::GetShapeMaterial(const IShape* shape) const
 {
-}
+	IMaterial* material = shape->GetMaterial().Get();
+	if (material == NULL)
+		return GetMaterial(_DefaultMaterial);
 
-
-PhysicsScene::PhysicsScene(PhysicsSystem* physicsSystem, const SceneDescription& desc) :
-	Physics::IScene(),
-	_PhysicsSystem(physicsSystem),
-	_Description(desc)
-{
-	// Creates the default material
-	IMaterial* material = CreateMaterial();
-	material->SetDynamicFriction(0.5f);
-	material->SetStaticFriction(0.5f);
-	material->SetRestitution(0.5f);
-	_DefaultMaterial = material->GetIndex();
+	return material;
 }
 
-PhysicsScene::~PhysicsScene()
+void PhysicsScene::UpdateProxies()
 {
+	int bodyCount = _Bodies.Count();
+	const BodyPtr* bodies = _Bodies.Data();
+	for (int i=0; i<bodyCount; ++i)
+	{
+		PhysicsBody* body = (PhysicsBody*)bodies[i].Get();
+		_BroadPhase->MoveProxy(body->GetBroadPhaseProxy(), body->GetWorldBoundingBox());
+	}
 }
 
 void PhysicsScene::GenerateContactPairs()
 {
-	int i, j;
-
-	int count = GetBodyCount();
+	int i;
 
 	// Collision detection: broad phase
-	//TODO: use an octree
+	// The bodies may have been moved since the last step
+	UpdateProxies();
+	_BroadPhase->UpdatePairs();
+
+	// The manifolds of the pairs that stopped overlapping are destroyed
+	const BaseArray<BroadPhasePair>& removedPairs = _BroadPhase->GetRemovedPairs();
+	int removedCount = removedPairs.Count();
+	for (i=0; i<removedCount; ++i)
+	{
+		_NarrowPhase.DestroyManifold(removedPairs[i]._ProxyA, removedPairs[i]._ProxyB);
+	}
 
-	for (i=0; i<count; ++i)
+	// The broad phase keeps the overlapping pairs across the steps
+	const BaseArray<BroadPhasePair>& pairs = _BroadPhase->GetPairs();
+	int pairCount = pairs.Count();
+	_ContactPairs.SetCapacity(pairCount);
+	for (i=0; i<pairCount; ++i)
 	{
-		IBody* bodyA = GetBody(i);
+		PhysicsBody* bodyA = (PhysicsBody*)_BroadPhase->GetUserData(pairs[i]._ProxyA);
+		PhysicsBody* bodyB = (PhysicsBody*)_BroadPhase->GetUserData(pairs[i]._ProxyB);
 
-		if (!bodyA->GetEnabled())
+		if (!bodyA->GetEnabled() || !bodyB->GetEnabled())
 			continue;
 
-		for (j=0; j<i; ++j)
-		{
-			IBody* bodyB = GetBody(j);
-
-			if (!bodyB->GetEnabled())
-				continue;
+		// The resting bodies are only tested again when a moving body touches them
+		if (!IsAwake(bodyA) && !IsAwake(bodyB))
+			continue;
 
-			// If the bounding box overlaps, add a new contact pair
-			// FIX: Planes have an empty AABB
-			if (!_Description._BroadPhase ||
-				(bodyA->GetWorldBoundingBox().IsEmpty() || bodyB->GetWorldBoundingBox().IsEmpty() ||
-				bodyA->GetWorldBoundingBox().Intersects(bodyB->GetWorldBoundingBox())))
-			{
-				ContactPair pair;
-				pair.SetBodyA(bodyA);
-				pair.SetBodyB(bodyB);
+		ContactPair pair;
+		pair.SetBodyA(bodyA);
+		pair.SetBodyB(bodyB);
 
-				_ContactPairs.Add(pair);
-			}
-		}
+		_ContactPairs.Add(pair);
 	}
 }
 
 void PhysicsScene::GenerateContactInfos()
 {
 	int i, j;
-	int count = _ContactPairs.Count();
 
 	// Collision detection: narrow phase
-	//TODO: Use the shape collision algorithms to calculate the contact points
-	//Keep the pair with the largest separation value
-
+	int count = _ContactPairs.Count();
 	for (i=0; i<count; i++)
 	{
-		ContactPair pair = _ContactPairs[i];
-		IBody* bodyA = pair.GetBodyA();
-		IBody* bodyB = pair.GetBodyB();
-
-		if (bodyA->Shapes().Count() == 0)
-			continue;
-		if (bodyB->Shapes().Count() == 0)
-			continue;
-
-		IShape* shapeA = bodyA->Shapes().GetItem(0);
-		IShape* shapeB = bodyB->Shapes().GetItem(0);
-
-		bool intersect = false;
-		/*BaseArray<IntersectionContact> contacts;
-
-		switch (shapeA->GetShapeType())
-		{
-		case ShapeType_Plane:
-			switch (shapeB->GetShapeType())
-			{
-				case ShapeType_Plane:
-					break;
-
-				case ShapeType_Box:
-					intersect = IntersectionBoxPlane::Contact(
-						((IBoxShape*)shapeB)->Data, ((IPlaneShape*)shapeA)->Data, &contacts);
-					break;
-
-				case ShapeType_Sphere:
-					intersect = IntersectionPlaneSphere::Contact(
-						((IPlaneShape*)shapeA)->Data, ((ISphereShape*)shapeB)->Data, &contacts);
-					break;
-			}
-			break;
-
-		case ShapeType_Box:
-			switch (shapeB->GetShapeType())
-			{
-				case ShapeType_Plane:
-					intersect = IntersectionBoxPlane::Contact(
-						((IBoxShape*)shapeA)->Data, ((IPlaneShape*)shapeB)->Data, &contacts);
-					break;
-
-				case ShapeType_Box:
-					intersect = IntersectionBoxBox::Contact(
-						((IBoxShape*)shapeA)->Data, ((IBoxShape*)shapeB)->Data, &contacts);
-					break;
-
-				case ShapeType_Sphere:
-					intersect = IntersectionBoxSphere::Contact(
-						((IBoxShape*)shapeA)->Data, ((ISphereShape*)shapeB)->Data, &contacts);
-					break;
-			}
-			break;
-
-		case ShapeType_Sphere:
-			switch (shapeB->GetShapeType())
-			{
-				case ShapeType_Plane:
-					intersect = IntersectionPlaneSphere::Contact(
-						((IPlaneShape*)shapeB)->Data, ((ISphereShape*)shapeA)->Data, &contacts);
-					break;
-
-				case ShapeType_Box:
-					intersect = IntersectionBoxSphere::Contact(
-						((IBoxShape*)shapeB)->Data, ((ISphereShape*)shapeA)->Data, &contacts);
-					break;
-
-				case ShapeType_Sphere:
-					intersect = IntersectionSphereSphere::Contact(
-						((ISphereShape*)shapeA)->Data, ((ISphereShape*)shapeB)->Data, &contacts);
-					break;
-			}
-			break;
-		}
-
-		if (intersect)
-		{
-			if (bodyA->GetBodyType() == BodyType_Dynamic)
-				bodyA->SetActive(true);
-			if (bodyB->GetBodyType() == BodyType_Dynamic)
-				bodyB->SetActive(true);
-
-			int contactCount = contacts.Count();
-			for (j=0; j<contactCount; j++)
-			{
-				ContactInfo info;
-				info.SetShapeA(shapeA);
-				info.SetShapeB(shapeB);
-				info.SetPosition(contacts[j]._Position);
-				info.SetNormal(contacts[j]._Normal);
-				info.SetSeparation(contacts[j]._Depth);
-
-				IMaterial* materialA = shapeA->GetMaterial();
-				IMaterial* materialB = shapeB->GetMaterial();
-				info.SetMaterialA(materialA->GetIndex());
-				info.SetMaterialB(materialB->GetIndex());
-				info.SetRestitution((materialA->GetRestitution() + materialB->GetRestitution()) / 2.0);
-
-				_ContactInfos.Add(info);
-			}
-		}*/
+		const ContactPair& pair = _ContactPairs[i];
+		_NarrowPhase.AddPair((PhysicsBody*)pair.GetBodyA().Get(), (PhysicsBody*)pair.GetBodyB().Get());
 	}
+	_NarrowPhase.Update();
 
-	/*count = _ContactInfos.Count();
-	if (count > 1)
+	const BaseArray<int32>& manifolds = _NarrowPhase.GetTouchingManifolds();
+	count = manifolds.Count();
+	for (i=0; i<count; i++)
 	{
-		Array<ContactInfo> contactInfos;
-		for (j=0; j<count; j++)
-		{
-			ContactInfo info;
-			info.SetShapeA(_ContactInfos[j].GetShapeA());
-			info.SetShapeB(_ContactInfos[j].GetShapeB());
-
-			info.SetMaterialA(_ContactInfos[j].GetMaterialA());
-			info.SetMaterialB(_ContactInfos[j].GetMaterialB());
-
-			Vector3 p = _ContactInfos[j].GetPosition();
-			Vector3 n = _ContactInfos[j].GetNormal();
-			real r = _ContactInfos[j].GetRestitution();
-			real s = _ContactInfos[j].GetSeparation();
-			int contacts = 1;
-			for (i=j+1; i<count; i++)
-			{
-				if (info.GetShapeA() == _ContactInfos[i].GetShapeA())
-				{
-					p += _ContactInfos[i].GetPosition();
-					n += _ContactInfos[i].GetNormal();
-					r += _ContactInfos[i].GetRestitution();
-					s += _ContactInfos[i].GetSeparation();
-					contacts++;
-				}
-			}
+		const ContactManifold& manifold = _NarrowPhase.GetManifold(manifolds[i]);
+		IShape* shapeA = manifold._BodyA->Shapes()[0].Get();
+		IShape* shapeB = manifold._BodyB->Shapes()[0].Get();
+		IMaterial* materialA = GetShapeMaterial(shapeA);
+		IMaterial* materialB = GetShapeMaterial(shapeB);
 
-			info.SetPosition(p / contacts);
-			info.SetNormal(Vector3::Normalize(n / contacts));
-			info.SetRestitution(r / contacts);
-			info.SetSeparation(s / contacts);
+		for (j=0; j<manifold._PointCount; j++)
+		{
+			// The points kept from the previous step can be slightly separated
+			const ManifoldPoint& point = manifold._Points[j];
+			if (point._Depth < 0.0)
+				continue;
 
-			contactInfos.Add(info);
+			ContactInfo info;
+			info.SetShapeA(shapeA);
+			info.SetShapeB(shapeB);
+			info.SetPosition(point._Position);
+			info.SetNormal(manifold._Normal);
+			info.SetSeparation(point._Depth);
+			info.SetMaterialA(materialA->GetIndex());
+			info.SetMaterialB(materialB->GetIndex());
+			info.SetRestitution((materialA->GetRestitution() + materialB->GetRestitution()) / 2.0);
+
+			_ContactInfos.Add(info);
 		}
-		_ContactInfos = contactInfos;
-	}*/
+	}
 }
 
 void PhysicsScene::ResolveCollisions(real64 elapsed)
 {
 	int i;
-	int count = _ContactInfos.Count();
 
-	//TODO: Calculate the forces: contact, friction
+	_Solver.Clear();
+	_SolvedContactInfos.Clear();
 
+	// The velocities are solved on a copy of the bodies
+	int bodyCount = _Bodies.Count();
+	const BodyPtr* bodies = _Bodies.Data();
+	for (i=0; i<bodyCount; ++i)
+	{
+		PhysicsBody* body = (PhysicsBody*)bodies[i].Get();
+
+		SolverBody solverBody;
+		solverBody._Position = body->GetPosition();
+		solverBody._LinearVelocity = body->GetLinearVelocity();
+		solverBody._AngularVelocity = body->GetAngularVelocity();
+		solverBody._IsDynamic = (body->GetBodyType() == BodyType_Dynamic);
+		solverBody._IsAwake = body->GetActive();
+		solverBody._SleepTime = body->GetSleepTime();
+		if (solverBody._IsDynamic)
+		{
+			solverBody._InverseMass = body->GetInverseMass();
+			solverBody._InverseInertiaTensor = body->GetInverseWorldInertiaTensor();
+		}
+		else
+		{
+			solverBody._InverseMass = 0.0;
+			solverBody._InverseInertiaTensor = Matrix3::Zero;
+		}
+
+		body->SetSolverIndex(_Solver.AddBody(solverBody));
+	}
+
+	int count = _ContactInfos.Count();
 	for (i=0; i<count; i++)
 	{
-		ContactInfo info = _ContactInfos[i];
+		const ContactInfo& info = _ContactInfos[i];
 
 		//todo: Cancel
 		if (!PreContact.Invoke(this, ContactEventArgs(info)))
@@ -294,108 +197,60 @@ void PhysicsScene::ResolveCollisions(real64 elapsed)
 		IMaterial* materialA = GetMaterial(info.GetMaterialA());
 		IMaterial* materialB = GetMaterial(info.GetMaterialB());
 
-		Vector3 relPosA = info.GetPosition() - bodyA->GetPosition();
-		Vector3 relPosB = info.GetPosition() - bodyB->GetPosition();
-
-		Vector3 relVel = bodyA->GetVelocityAtLocalPosition(relPosA) -
-			bodyB->GetVelocityAtLocalPosition(relPosB);
-		real normalVel = Vector3::Dot(relVel, info.GetNormal());
-
-		real impulseNumerator, impulseDenominator;
-		if (!Math::Equals(normalVel, 0.0, 0.05))
-		{
-			//bodyA->SetActive(false);
-			//bodyB->SetActive(false);
-
-			if (elapsed > 0.0)
-			{
-				real Kerp = 0.4;
-				real Kfps = 1.0 / elapsed;
-				real Kcor = Kerp * Kfps;
-				real positionalError = Kcor * -info.GetSeparation();
-				real penetrationImpulse = positionalError * 1.0;
-				normalVel += penetrationImpulse;
-			}
-
-			// Calculate the contact impulse
-			impulseNumerator = -(1.0 + info.GetRestitution()) * normalVel;
-
-			impulseDenominator = bodyA->GetInverseMass() +
-				Vector3::Dot(Vector3::Cross(bodyA->GetInverseWorldInertiaTensor() *
-				Vector3::Cross(relPosA, info.GetNormal()), relPosA), info.GetNormal());
-
-			if (bodyB->GetBodyType() != BodyType_Static)
-			{
-				impulseDenominator +=  bodyB->GetInverseMass() +
-					Vector3::Dot(Vector3::Cross(bodyB->GetInverseWorldInertiaTensor() *
-					Vector3::Cross(relPosB, info.GetNormal()), relPosB), info.GetNormal());
-			}
-
-			if (impulseDenominator > Math::Epsilon)
-			{
-				Vector3 impulse = (impulseNumerator / impulseDenominator) * info.GetNormal();
-
-				//Console::WriteLine(impulse.ToString());
-				bodyA->AddImpulseAtLocalPosition(impulse, relPosA);
-
-				if (bodyB->GetBodyType() != BodyType_Static)
-				{
-					bodyB->AddImpulseAtLocalPosition(-impulse, relPosB);
-				}
-			}
-		}
+		SolverContact contact;
+		contact._PairKey = ((uint64)(uint32)bodyA->GetBroadPhaseProxy() << 32) | (uint32)bodyB->GetBroadPhaseProxy();
+		contact._BodyA = bodyA->GetSolverIndex();
+		contact._BodyB = bodyB->GetSolverIndex();
+		contact._Position = info.GetPosition();
+		contact._Normal = info.GetNormal();
+		contact._Depth = info.GetSeparation();
+		contact._Restitution = info.GetRestitution();
+		contact._Friction = (materialA->GetDynamicFriction() + materialB->GetDynamicFriction()) / 2.0;
+
+		_Solver.AddContact(contact);
+		_SolvedContactInfos.Add(i);
+	}
 
-		// Calculate the friction impulse
+	_Solver.Solve(elapsed, _Description._Iterations);
 
-		// Get the new velocity
-		relVel = bodyA->GetVelocityAtLocalPosition(relPosA) -
-			bodyB->GetVelocityAtLocalPosition(relPosB);
-		Vector3 tangentVel = relVel - Vector3::Dot(relVel, info.GetNormal()) * info.GetNormal();
+	bool sleepEnabled = (_Description._SleepEnergy > 0.0);
+	if (sleepEnabled)
+	{
+		_Solver.UpdateSleepTimes(elapsed, _Description._SleepEnergy);
+	}
 
-		real tangentSpeed = tangentVel.Length();
-		if (tangentSpeed < 0.05)
+	for (i=0; i<bodyCount; ++i)
+	{
+		PhysicsBody* body = (PhysicsBody*)bodies[i].Get();
+		if (body->GetBodyType() != BodyType_Dynamic)
 			continue;
 
-		Vector3 tangent = -tangentVel / tangentSpeed;
-
-		impulseDenominator = 0.0;
-		if (bodyA->GetBodyType() != BodyType_Static)
-		{
-			impulseDenominator = bodyA->GetInverseMass() + 
-				Vector3::Dot(tangent, Vector3::Cross(bodyA->GetInverseWorldInertiaTensor() *
-				(Vector3::Cross(relPosA, tangent)), relPosA));
-		}
+		const SolverBody& solverBody = _Solver.GetBody(i);
+		body->SetSleepTime(solverBody._SleepTime);
 
-		if (bodyB->GetBodyType() != BodyType_Static)
+		// The bodies touching each other sleep together when all of them are resting
+		if (sleepEnabled && _Solver.GetIslandSleepTime(i) >= _Description._SleepTime)
 		{
-			impulseDenominator += bodyB->GetInverseMass() + 
-				Vector3::Dot(tangent, Vector3::Cross(bodyB->GetInverseWorldInertiaTensor() *
-				(Vector3::Cross(relPosB, tangent)), relPosB));
+			if (body->GetActive())
+				body->SetActive(false);
+			continue;
 		}
 
-		if (impulseDenominator > Math::Epsilon)
-		{
-			real impulseToReverse = tangentSpeed / impulseDenominator;
-
-			real impulseFromNormalImpulse = materialA->GetStaticFriction() * normalVel;
-			real frictionImpulse;
-
-			if (impulseToReverse < impulseFromNormalImpulse)
-				frictionImpulse = impulseToReverse;
-			else
-				frictionImpulse = materialA->GetDynamicFriction() * normalVel;
-
-			tangent *= frictionImpulse;
+		if (!_Solver.IsBodySolved(i))
+			continue;
 
-			bodyA->AddImpulseAtLocalPosition(tangent, relPosA);
+		// A moving body touching a sleeping body wakes it up
+		if (!body->GetActive())
+			body->SetActive(true);
 
-			if (bodyB->GetBodyType() != BodyType_Static)
-			{
-				bodyB->AddImpulseAtLocalPosition(-tangent, relPosB);
-			}
-		}
+		body->SetLinearVelocity(solverBody._LinearVelocity);
+		body->SetAngularVelocity(solverBody._AngularVelocity);
+	}
 
-		PostContact.Invoke(this, ContactEventArgs(info));
+	count = _SolvedContactInfos.Count();
+	for (i=0; i<count; i++)
+	{
+		PostContact.Invoke(this, ContactEventArgs(_ContactInfos[_SolvedContactInfos[i]]));
 	}
 }
 
@@ -449,7 +304,9 @@ IBody* PhysicsScene::CreateBody(const BodyDescription& desc)
 	if (_Description._MaxBodies > 0 && GetBodyCount() == _Description._MaxBodies)
 		return NULL;
 
-	IBody* body = new PhysicsBody(this, desc);
+	PhysicsBody* body = new PhysicsBody(this, desc);
+	body->SetBroadPhaseProxy(_BroadPhase->CreateProxy(body->GetWorldBoundingBox(), body,
+		body->GetBodyType() == BodyType_Static));
 	_Bodies.Add(body);
 	return body;
 }
@@ -458,6 +315,10 @@ void PhysicsScene::DestroyBody(IBody* body)
 {
 	if (_Bodies.Contains(body))
 	{
+		// The proxy can be reused by a new body, which must not inherit the impulses of its contacts
+		int32 proxy = ((PhysicsBody*)body)->GetBroadPhaseProxy();
+		_Solver.RemoveImpulses((uint32)proxy);
+		_BroadPhase->DestroyProxy(proxy);
 		_Bodies.Remove(body);
 	}
 }
@@ -521,33 +382,57 @@ void PhysicsScene::DestroyJoint(IJoint* joint)
 	}
 }
 
+real PhysicsScene::GetInterpolationAlpha() const
+{
+	return _InterpolationAlpha;
+}
+
 void PhysicsScene::Update(real64 elapsed)
 {
-	uint i;
+	real64 timeStep = _Description._TimeStep;
+	if (_Description._TimeStepType != TimeStepType_Fixed || timeStep <= 0.0)
+	{
+		Step(elapsed);
+		_InterpolationAlpha = 1.0;
+		return;
+	}
+
+	// Runs as many fixed steps as the accumulated time allows
+	_Accumulator += elapsed;
 
-	real64 delta;
-	static real64 lastTime = 0.0;
-	if (_Description._TimeStepType == TimeStepType_Fixed)
+	uint32 maxSubsteps = Math::Max(_Description._MaxSubsteps, (uint32)1);
+	uint32 substeps = 0;
+	while (_Accumulator >= timeStep && substeps < maxSubsteps)
 	{
-		lastTime += elapsed;
-		if (lastTime > _Description._TimeStep)
-			lastTime -= _Description._TimeStep;
-		else
-			return;
-		delta = _Description._TimeStep;
+		Step(timeStep);
+		_Accumulator -= timeStep;
+		substeps++;
 	}
-	else
+
+	// Drops the time that could not be simulated, a slow frame must not make the next ones slower
+	if (_Accumulator >= timeStep)
 	{
-		delta = elapsed;
+		_Accumulator -= (real64)(int64)(_Accumulator / timeStep) * timeStep;
 	}
 
-	/*{
-		Array<BodyPtr>::Iterator it = _Bodies.GetIterator();
-		while (it.Next())
+	_InterpolationAlpha = (real)(_Accumulator / timeStep);
+}
+
+void PhysicsScene::Step(real64 elapsed)
+{
+	// Apply the forces before the collision response, so that the resting contacts cancel the gravity
+	{
+		int bodyCount = _Bodies.Count();
+		const BodyPtr* bodies = _Bodies.Data();
+		for (int j = 0; j < bodyCount; ++j)
 		{
-			((PhysicsBody*)it.Current().Get())->UpdateVelocity(elapsed);
+			PhysicsBody* body = (PhysicsBody*)bodies[j].Get();
+			if (body->GetActive())
+			{
+				body->UpdateVelocity(elapsed);
+			}
 		}
-	}*/
+	}
 
 	// Two steps: collision detection and collision response
 	if (_Description._CollisionDetection)
@@ -556,48 +441,226 @@ void PhysicsScene::Update(real64 elapsed)
 		GenerateContactInfos();
 
 		// Collision response
-		_Description._Iterations = 1;
-		real64 delta = elapsed;// / (real64)_Description._Iterations;
-		for (i=0; i<_Description._Iterations; i++)
-		{
-			ResolveCollisions(delta);
-		}
+		ResolveCollisions(elapsed);
 	}
 
 	// Update the state of the bodies
 	{
-		Array<BodyPtr>::Iterator it = _Bodies.GetIterator();
-		while (it.Next())
+		_AwakeBodyCount = 0;
+		_SleepingBodyCount = 0;
+
+		int bodyCount = _Bodies.Count();
+		const BodyPtr* bodies = _Bodies.Data();
+		for (int j = 0; j < bodyCount; ++j)
 		{
-			IBody* body = it.Current().Get();
-			//body->AddForce(body->GetMass() * GetGravity());
-			//((PhysicsBody*)body)->UpdateVelocity(elapsed);
+			IBody* body = bodies[j].Get();
 			if (body->GetActive())
 			{
 				body->Update(elapsed);
 			}
 
-			/*if (body->GetBodyType() == BodyType_Dynamic)
+			if (body->GetBodyType() == BodyType_Dynamic)
 			{
-				if (body->GetLinearVelocity().Equals(Vector3::Zero, 0.05) &&
-					body->GetAngularVelocity().Equals(Vector3::Zero, 0.05))
-				{
-					body->SetActive(false);
-					body->SetLinearVelocity(Vector3::Zero);
-					body->SetAngularVelocity(Vector3::Zero);
-				}
-				else if (!body->GetActive())
-				{
-					body->SetActive(true);
-				}
-			}*/
+				if (body->GetActive())
+					_AwakeBodyCount++;
+				else
+					_SleepingBodyCount++;
+			}
 		}
 	}
 
+	// The queries use the boxes of the proxies
+	UpdateProxies();
+
 	_ContactPairs.Clear();
 	_ContactInfos.Clear();
+}
+
+/// Closest hit of a ray cast through the broad phase.
+struct RaycastClosestData
+{
+	RaycastHit* _Hit;
+	bool _IsHit;
+};
+
+/// Hits of a ray cast through the broad phase.
+struct RaycastAllData
+{
+	BaseArray<RaycastHit>* _Hits;
+	int _First;
+};
+
+/// Adds a hit to a list sorted by distance.
+static void _InsertHit(BaseArray<RaycastHit>& hits, int first, const RaycastHit& hit)
+{
+	hits.Add(hit);
+	int index = hits.Count() - 1;
+	while (index > first && hits[index - 1]._Distance > hit._Distance)
+	{
+		hits[index] = hits[index - 1];
+		index--;
+	}
+	hits[index] = hit;
+}
+
+bool PhysicsScene::Raycast(const Ray3& ray, real maxDistance, RaycastHit& hit) const
+{
+	Ray3 unitRay(ray.Origin, Vector3::Normalize(ray.Direction));
+
+	RaycastClosestData data;
+	data._Hit = &hit;
+	data._IsHit = false;
+	_BroadPhase->Raycast(unitRay, maxDistance, RaycastClosestBody, &data);
+
+	return data._IsHit;
+}
+
+real PhysicsScene::RaycastClosestBody(void* userData, const Ray3& ray, real maxDistance, void* context)
+{
+	PhysicsBody* body = (PhysicsBody*)userData;
+	if (!body->GetEnabled() || body->Shapes().IsEmpty())
+		return maxDistance;
+
+	// The closest hit so far limits the distance of the next bodies
+	IShape* shape = body->Shapes()[0].Get();
+	RaycastHit shapeHit;
+	if (!ShapeQuery::Raycast(shape, body->GetWorldBoundingBox(), ray, maxDistance, shapeHit))
+		return maxDistance;
+
+	RaycastClosestData* data = (RaycastClosestData*)context;
+	*data->_Hit = shapeHit;
+	data->_Hit->_Body = body;
+	data->_Hit->_Shape = shape;
+	data->_IsHit = true;
+	return shapeHit._Distance;
+}
+
+int PhysicsScene::RaycastAll(const Ray3& ray, real maxDistance, BaseArray<RaycastHit>& hits) const
+{
+	Ray3 unitRay(ray.Origin, Vector3::Normalize(ray.Direction));
+
+	RaycastAllData data;
+	data._Hits = &hits;
+	data._First = hits.Count();
+	_BroadPhase->Raycast(unitRay, maxDistance, RaycastAllBodies, &data);
+
+	return hits.Count() - data._First;
+}
+
+real PhysicsScene::RaycastAllBodies(void* userData, const Ray3& ray, real maxDistance, void* context)
+{
+	PhysicsBody* body = (PhysicsBody*)userData;
+	if (!body->GetEnabled() || body->Shapes().IsEmpty())
+		return maxDistance;
+
+	IShape* shape = body->Shapes()[0].Get();
+	RaycastHit hit;
+	if (ShapeQuery::Raycast(shape, body->GetWorldBoundingBox(), ray, maxDistance, hit))
+	{
+		RaycastAllData* data = (RaycastAllData*)context;
+		hit._Body = body;
+		hit._Shape = shape;
+		_InsertHit(*data->_Hits, data->_First, hit);
+	}
+
+	return maxDistance;
+}
+
+bool PhysicsScene::SweepSphere(const BoundingSphere& sphere, const Vector3& direction, real maxDistance, RaycastHit& hit) const
+{
+	Vector3 unitDirection = Vector3::Normalize(direction);
+
+	// Box around the whole movement
+	AABB sweptBox = AABB::CreateFromSphere(sphere);
+	sweptBox.Merge(AABB::CreateFromSphere(BoundingSphere(sphere.Center + unitDirection * maxDistance, sphere.Radius)));
+
+	BaseArray<void*> candidates;
+	_BroadPhase->Query(sweptBox, candidates);
+
+	bool isHit = false;
+	int count = candidates.Count();
+	for (int i=0; i<count; ++i)
+	{
+		PhysicsBody* body = (PhysicsBody*)candidates[i];
+		if (!body->GetEnabled() || body->Shapes().IsEmpty())
+			continue;
+
+		IShape* shape = body->Shapes()[0].Get();
+		RaycastHit shapeHit;
+		if (ShapeQuery::SweepSphere(shape, body->GetWorldBoundingBox(), sphere, unitDirection, maxDistance, shapeHit))
+		{
+			hit = shapeHit;
+			hit._Body = body;
+			hit._Shape = shape;
+			maxDistance = shapeHit._Distance;
+			isHit = true;
+		}
+	}
+
+	return isHit;
+}
+
+bool PhysicsScene::SweepBox(const OBB& box, const Vector3& direction, real maxDistance, RaycastHit& hit) const
+{
+	Vector3 unitDirection = Vector3::Normalize(direction);
+
+	// Box around the whole movement
+	Vector3 extents;
+	for (int j=0; j<3; ++j)
+	{
+		Vector3 row = box.Rotation.GetRow(j);
+		extents[j] = Math::Abs(row.X) * box.Extents.X + Math::Abs(row.Y) * box.Extents.Y + Math::Abs(row.Z) * box.Extents.Z;
+	}
+	Vector3 end = box.Center + unitDirection * maxDistance;
+	AABB sweptBox(box.Center - extents, box.Center + extents);
+	sweptBox.Merge(AABB(end - extents, end + extents));
+
+	BaseArray<void*> candidates;
+	_BroadPhase->Query(sweptBox, candidates);
+
+	bool isHit = false;
+	int count = candidates.Count();
+	for (int i=0; i<count; ++i)
+	{
+		PhysicsBody* body = (PhysicsBody*)candidates[i];
+		if (!body->GetEnabled() || body->Shapes().IsEmpty())
+			continue;
+
+		IShape* shape = body->Shapes()[0].Get();
+		RaycastHit shapeHit;
+		if (ShapeQuery::SweepBox(shape, body->GetWorldBoundingBox(), box, unitDirection, maxDistance, shapeHit))
+		{
+			hit = shapeHit;
+			hit._Body = body;
+			hit._Shape = shape;
+			maxDistance = shapeHit._Distance;
+			isHit = true;
+		}
+	}
+
+	return isHit;
+}
+
+int PhysicsScene::OverlapAABB(const AABB& box, BaseArray<IBody*>& bodies) const
+{
+	BaseArray<void*> candidates;
+	_BroadPhase->Query(box, candidates);
+
+	int first = bodies.Count();
+	int count = candidates.Count();
+	for (int i=0; i<count; ++i)
+	{
+		PhysicsBody* body = (PhysicsBody*)candidates[i];
+		if (!body->GetEnabled() || body->Shapes().IsEmpty())
+			continue;
+
+		if (ShapeQuery::Overlap(body->Shapes()[0].Get(), body->GetWorldBoundingBox(), box))
+		{
+			bodies.Add(body);
+		}
+	}
 
-	//TODO: Determines the bodies that need to be deactived
+	return bodies.Count() - first;
 }
 
 }
@@ -8,57 +8,14 @@ Author: Julien Delezenne
 #define _SE_PHYSICSSCENE_H_
 
 #include "SoftwarePhysicsSystem.h"
+#include "BroadPhase.h"
+#include "NarrowPhase.h"
+#include "ContactSolver.h"
 
 namespace SE_Software
 {
 
-class SpaceDivisionObject : public Object
-{
-public:
-	SpaceDivisionObject();
-	virtual ~SpaceDivisionObject();
-
-	virtual AABB GetLocalBoundingBox() const = 0;
-	virtual AABB GetWorldBoundingBox() const = 0;
-};
-
-class SpaceDivision : public Object
-{
-public:
-	SpaceDivision();
-	virtual ~SpaceDivision();
-
-	virtual void AddObject(SpaceDivisionObject* object) = 0;
-	virtual void RemoveObject(SpaceDivisionObject* object) = 0;
-};
-
-class OctreeSpace : public SpaceDivision
-{
-public:
-	class Node
-	{
-	public:
-		Node();
-
-		Array<SpaceDivisionObject*> _Objects;
-		Vector3 _Position;
-		Node* _Parent;
-		Node* _Children[8];
-	};
-
-	OctreeSpace();
-	virtual ~OctreeSpace();
-
-	virtual void AddObject(SpaceDivisionObject* object);
-	virtual void RemoveObject(SpaceDivisionObject* object);
-
-private:
-	void InternalAddNode(Node* node);
-	void InternalRemoveNode(Node* node);
-
-protected:
-	Node* _RootNode;
-};
+class PhysicsBody;
 
 /** Scene. */
 class PhysicsScene : public Physics::IScene
@@ -82,6 +39,8 @@ public:
 	virtual uint32 GetIterations() const;
 	virtual void SetIterations(uint32 value);
 
+	virtual real GetInterpolationAlpha() const;
+
 	virtual IBody* CreateBody(const BodyDescription& desc);
 	virtual void DestroyBody(IBody* body);
 
@@ -102,9 +61,35 @@ public:
 
 	virtual void Update(real64 elapsed);
 
+	virtual bool Raycast(const Ray3& ray, real maxDistance, RaycastHit& hit) const;
+	virtual int RaycastAll(const Ray3& ray, real maxDistance, BaseArray<RaycastHit>& hits) const;
+	virtual bool SweepSphere(const BoundingSphere& sphere, const Vector3& direction, real maxDistance, RaycastHit& hit) const;
+	virtual bool SweepBox(const OBB& box, const Vector3& direction, real maxDistance, RaycastHit& hit) const;
+	virtual int OverlapAABB(const AABB& box, BaseArray<IBody*>& bodies) const;
+
 	PhysicsSystem* GetPhysicsSystem() const { return _PhysicsSystem; }
 
+	/** Gets the number of dynamic bodies that were simulated by the last update. */
+	int GetAwakeBodyCount() const { return _AwakeBodyCount; }
+
+	/** Gets the number of dynamic bodies that were sleeping after the last update. */
+	int GetSleepingBodyCount() const { return _SleepingBodyCount; }
+
 protected:
+	static bool IsAwake(const PhysicsBody* body);
+
+	/** Gets the material of a shape, or the default material. */
+	IMaterial* GetShapeMaterial(const IShape* shape) const;
+
+	/** Simulates a single step. */
+	void Step(real64 elapsed);
+
+	/** Moves the broad phase proxies of the bodies to their current bounding box. */
+	void UpdateProxies();
+
+	static real RaycastClosestBody(void* userData, const Ray3& ray, real maxDistance, void* context);
+	static real RaycastAllBodies(void* userData, const Ray3& ray, real maxDistance, void* context);
+
 	void GenerateContactPairs();
 	void GenerateContactInfos();
 	void ResolveCollisions(real64 elapsed);
@@ -112,14 +97,22 @@ protected:
 protected:
 	PhysicsSystem* _PhysicsSystem;
 	SceneDescription _Description;
+	real64 _Accumulator;
+	real _InterpolationAlpha;
 
 	Array<BodyPtr> _Bodies;
 	Dictionary<MaterialIndex, MaterialPtr> _Materials;
 	MaterialIndex _DefaultMaterial;
 	Array<JointPtr> _Joints;
 
+	BroadPhase* _BroadPhase;
 	Array<ContactPair> _ContactPairs;
+	NarrowPhase _NarrowPhase;
 	Array<ContactInfo> _ContactInfos;
+	ContactSolver _Solver;
+	BaseArray<int32> _SolvedContactInfos;
+	int _AwakeBodyCount;
+	int _SleepingBodyCount;
 };
 
 }
@@ -0,0 +1,607 @@
+/*=============================================================================
+ShapeQuery.cpp
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+#include "ShapeQuery.h"
+
+namespace SE_Software
+{
+
+/// Squared sine below which two directions are parallel.
+static const real ParallelTolerance = (real)1e-6;
+
+/// Distance beyond which a point is outside of a face of a box.
+static const real FaceTolerance = (real)1e-4;
+
+static void _GetAxes(const OBB& box, Vector3* axes)
+{
+	axes[0] = box.Rotation.GetColumn(0);
+	axes[1] = box.Rotation.GetColumn(1);
+	axes[2] = box.Rotation.GetColumn(2);
+}
+
+static Vector3 _ToLocal(const Vector3* axes, const Vector3& value)
+{
+	return Vector3(Vector3::Dot(axes[0], value), Vector3::Dot(axes[1], value), Vector3::Dot(axes[2], value));
+}
+
+static Vector3 _ToWorld(const Vector3* axes, const Vector3& value)
+{
+	return axes[0] * value.X + axes[1] * value.Y + axes[2] * value.Z;
+}
+
+/// Gets the corner of a box that is the furthest along a direction, or the center of its face or edge.
+static Vector3 _GetSupport(const OBB& box, const Vector3* axes, const Vector3& direction)
+{
+	Vector3 result = box.Center;
+	for (int i = 0; i < 3; ++i)
+	{
+		real projection = Vector3::Dot(axes[i], direction);
+		if (projection > ParallelTolerance)
+			result += axes[i] * box.Extents[i];
+		else if (projection < -ParallelTolerance)
+			result -= axes[i] * box.Extents[i];
+	}
+	return result;
+}
+
+static void _SetInitialOverlap(const Vector3& origin, const Vector3& direction, RaycastHit& hit)
+{
+	hit._Position = origin;
+	hit._Normal = -direction;
+	hit._Distance = 0.0;
+}
+
+/**
+	Casts a ray against a box centered on the origin (slab test).
+	@param axis [out] The axis of the face that was hit, -1 if the ray starts inside of the box.
+	@param sign [out] The side of the face that was hit.
+*/
+static bool _RaycastLocalBox(const Vector3& origin, const Vector3& direction, const Vector3& extents,
+	real maxDistance, real& distance, int& axis, real& sign)
+{
+	real tmin = -SE_MAX_R32;
+	real tmax = SE_MAX_R32;
+	axis = -1;
+	sign = 0.0;
+
+	for (int i = 0; i < 3; ++i)
+	{
+		if (Math::Abs(direction[i]) < ParallelTolerance)
+		{
+			if (Math::Abs(origin[i]) > extents[i])
+				return false;
+			continue;
+		}
+
+		real invDirection = (real)1.0 / direction[i];
+		real t1 = (-extents[i] - origin[i]) * invDirection;
+		real t2 = (extents[i] - origin[i]) * invDirection;
+		real faceSign = -1.0;
+		if (t1 > t2)
+		{
+			SE_Swap(t1, t2);
+			faceSign = 1.0;
+		}
+
+		if (t1 > tmin)
+		{
+			tmin = t1;
+			axis = i;
+			sign = faceSign;
+		}
+		tmax = Math::Min(tmax, t2);
+		if (tmin > tmax)
+			return false;
+	}
+
+	if (tmax < 0.0 || tmin > maxDistance)
+		return false;
+
+	if (tmin < 0.0)
+	{
+		axis = -1;
+		distance = 0.0;
+	}
+	else
+	{
+		distance = tmin;
+	}
+	return true;
+}
+
+/// Casts a ray against a sphere, the ray must start outside of the sphere.
+static bool _RaycastSphere(const Vector3& origin, const Vector3& direction, const Vector3& center, real radius,
+	real& distance, Vector3& normal)
+{
+	Vector3 offset = origin - center;
+	real b = Vector3::Dot(offset, direction);
+	real c = offset.LengthSquared() - radius * radius;
+	if (b > 0.0)
+		return false;
+
+	real discriminant = b * b - c;
+	if (discriminant < 0.0)
+		return false;
+
+	distance = Math::Max(-b - Math::Sqrt(discriminant), (real)0.0);
+	normal = Vector3::Normalize(origin + direction * distance - center);
+	return true;
+}
+
+/// Casts a ray against a capsule, the ray must start outside of the capsule.
+static bool _RaycastCapsule(const Vector3& origin, const Vector3& direction, const Vector3& pointA, const Vector3& pointB,
+	real radius, real& distance, Vector3& normal)
+{
+	Vector3 axis = pointB - pointA;
+	Vector3 offset = origin - pointA;
+	real axisLengthSq = axis.LengthSquared();
+	real axisDir = Vector3::Dot(axis, direction);
+	real axisOffset = Vector3::Dot(axis, offset);
+
+	// Side of the infinite cylinder: a t^2 + 2 b t + c = 0
+	real a = axisLengthSq - axisDir * axisDir;
+	if (a > ParallelTolerance * axisLengthSq)
+	{
+		real b = axisLengthSq * Vector3::Dot(offset, direction) - axisOffset * axisDir;
+		real c = axisLengthSq * (offset.LengthSquared() - radius * radius) - axisOffset * axisOffset;
+		real discriminant = b * b - a * c;
+		if (discriminant < 0.0)
+			return false;
+
+		real t = (-b - Math::Sqrt(discriminant)) / a;
+		real projection = axisOffset + t * axisDir;
+		if (t >= 0.0 && projection >= 0.0 && projection <= axisLengthSq)
+		{
+			distance = t;
+			Vector3 point = origin + direction * t;
+			normal = Vector3::Normalize(point - (pointA + axis * (projection / axisLengthSq)));
+			return true;
+		}
+	}
+
+	// Spheres at the ends
+	real distanceA, distanceB;
+	Vector3 normalA, normalB;
+	bool hitA = _RaycastSphere(origin, direction, pointA, radius, distanceA, normalA);
+	bool hitB = _RaycastSphere(origin, direction, pointB, radius, distanceB, normalB);
+	if (hitA && (!hitB || distanceA <= distanceB))
+	{
+		distance = distanceA;
+		normal = normalA;
+		return true;
+	}
+	if (hitB)
+	{
+		distance = distanceB;
+		normal = normalB;
+		return true;
+	}
+	return false;
+}
+
+/// Gets the squared distance between a point and a box centered on the origin.
+static real _GetDistanceSquared(const Vector3& point, const Vector3& extents, Vector3& closest)
+{
+	real distanceSq = 0.0;
+	for (int i = 0; i < 3; ++i)
+	{
+		closest[i] = Math::Clamp(point[i], -extents[i], extents[i]);
+		real delta = point[i] - closest[i];
+		distanceSq += delta * delta;
+	}
+	return distanceSq;
+}
+
+
+bool ShapeQuery::Raycast(const IShape* shape, const AABB& bounds, const Ray3& ray, real maxDistance, RaycastHit& hit)
+{
+	switch (shape->GetShapeType())
+	{
+	case ShapeType_Plane:
+		return RaycastPlane(((const IPlaneShape*)shape)->Data, ray, maxDistance, hit);
+
+	case ShapeType_Sphere:
+		return RaycastSphere(((const ISphereShape*)shape)->Data, ray, maxDistance, hit);
+
+	case ShapeType_Box:
+		return RaycastBox(((const IBoxShape*)shape)->Data, ray, maxDistance, hit);
+
+	default:
+		return RaycastBox(OBB(bounds, Matrix3::Identity), ray, maxDistance, hit);
+	}
+}
+
+bool ShapeQuery::SweepSphere(const IShape* shape, const AABB& bounds, const BoundingSphere& sphere,
+	const Vector3& direction, real maxDistance, RaycastHit& hit)
+{
+	switch (shape->GetShapeType())
+	{
+	case ShapeType_Plane:
+		return SweepSpherePlane(sphere, direction, maxDistance, ((const IPlaneShape*)shape)->Data, hit);
+
+	case ShapeType_Sphere:
+		return SweepSphereSphere(sphere, direction, maxDistance, ((const ISphereShape*)shape)->Data, hit);
+
+	case ShapeType_Box:
+		return SweepSphereBox(sphere, direction, maxDistance, ((const IBoxShape*)shape)->Data, hit);
+
+	default:
+		return SweepSphereBox(sphere, direction, maxDistance, OBB(bounds, Matrix3::Identity), hit);
+	}
+}
+
+bool ShapeQuery::SweepBox(const IShape* shape, const AABB& bounds, const OBB& box,
+	const Vector3& direction, real maxDistance, RaycastHit& hit)
+{
+	switch (shape->GetShapeType())
+	{
+	case ShapeType_Plane:
+		return SweepBoxPlane(box, direction, maxDistance, ((const IPlaneShape*)shape)->Data, hit);
+
+	case ShapeType_Sphere:
+		return SweepBoxSphere(box, direction, maxDistance, ((const ISphereShape*)shape)->Data, hit);
+
+	case ShapeType_Box:
+		return SweepBoxBox(box, direction, maxDistance, ((const IBoxShape*)shape)->Data, hit);
+
+	default:
+		return SweepBoxBox(box, direction, maxDistance, OBB(bounds, Matrix3::Identity), hit);
+	}
+}
+
+bool ShapeQuery::Overlap(const IShape* shape, const AABB& bounds, const AABB& box)
+{
+	RaycastHit hit;
+
+	switch (shape->GetShapeType())
+	{
+	case ShapeType_Plane:
+		{
+			// The plane is the boundary of a half-space
+			const Plane& plane = ((const IPlaneShape*)shape)->Data;
+			Vector3 extents = box.GetExtents();
+			real radius = Math::Abs(plane.Normal.X) * extents.X + Math::Abs(plane.Normal.Y) * extents.Y +
+				Math::Abs(plane.Normal.Z) * extents.Z;
+			return (plane.GetDistance(box.GetCenter()) <= radius);
+		}
+
+	case ShapeType_Sphere:
+		return box.Intersects(((const ISphereShape*)shape)->Data);
+
+	case ShapeType_Box:
+		return SweepBoxBox(OBB(box, Matrix3::Identity), Vector3::Zero, 0.0, ((const IBoxShape*)shape)->Data, hit);
+
+	default:
+		return bounds.Intersects(box);
+	}
+}
+
+bool ShapeQuery::RaycastPlane(const Plane& plane, const Ray3& ray, real maxDistance, RaycastHit& hit)
+{
+	// The plane is the boundary of a half-space, the side opposite to its normal is inside
+	real distance = plane.GetDistance(ray.Origin);
+	if (distance <= 0.0)
+	{
+		_SetInitialOverlap(ray.Origin, ray.Direction, hit);
+		return true;
+	}
+
+	real speed = Vector3::Dot(plane.Normal, ray.Direction);
+	if (speed >= 0.0)
+		return false;
+
+	real t = -distance / speed;
+	if (t > maxDistance)
+		return false;
+
+	hit._Position = ray.Origin + ray.Direction * t;
+	hit._Normal = plane.Normal;
+	hit._Distance = t;
+	return true;
+}
+
+bool ShapeQuery::RaycastSphere(const BoundingSphere& sphere, const Ray3& ray, real maxDistance, RaycastHit& hit)
+{
+	if ((ray.Origin - sphere.Center).LengthSquared() <= sphere.Radius * sphere.Radius)
+	{
+		_SetInitialOverlap(ray.Origin, ray.Direction, hit);
+		return true;
+	}
+
+	real t;
+	Vector3 normal;
+	if (!_RaycastSphere(ray.Origin, ray.Direction, sphere.Center, sphere.Radius, t, normal) || t > maxDistance)
+		return false;
+
+	hit._Position = ray.Origin + ray.Direction * t;
+	hit._Normal = normal;
+	hit._Distance = t;
+	return true;
+}
+
+bool ShapeQuery::RaycastBox(const OBB& box, const Ray3& ray, real maxDistance, RaycastHit& hit)
+{
+	Vector3 axes[3];
+	_GetAxes(box, axes);
+
+	real t, sign;
+	int axis;
+	if (!_RaycastLocalBox(_ToLocal(axes, ray.Origin - box.Center), _ToLocal(axes, ray.Direction),
+		box.Extents, maxDistance, t, axis, sign))
+	{
+		return false;
+	}
+
+	if (axis < 0)
+	{
+		_SetInitialOverlap(ray.Origin, ray.Direction, hit);
+		return true;
+	}
+
+	hit._Position = ray.Origin + ray.Direction * t;
+	hit._Normal = axes[axis] * sign;
+	hit._Distance = t;
+	return true;
+}
+
+bool ShapeQuery::SweepSpherePlane(const BoundingSphere& sphere, const Vector3& direction, real maxDistance,
+	const Plane& plane, RaycastHit& hit)
+{
+	real distance = plane.GetDistance(sphere.Center) - sphere.Radius;
+	if (distance <= 0.0)
+	{
+		_SetInitialOverlap(sphere.Center, direction, hit);
+		return true;
+	}
+
+	real speed = Vector3::Dot(plane.Normal, direction);
+	if (speed >= 0.0)
+		return false;
+
+	real t = -distance / speed;
+	if (t > maxDistance)
+		return false;
+
+	hit._Position = sphere.Center + direction * t - plane.Normal * sphere.Radius;
+	hit._Normal = plane.Normal;
+	hit._Distance = t;
+	return true;
+}
+
+bool ShapeQuery::SweepSphereSphere(const BoundingSphere& sphere, const Vector3& direction, real maxDistance,
+	const BoundingSphere& target, RaycastHit& hit)
+{
+	// Ray from the center against the sum of the spheres
+	real radius = sphere.Radius + target.Radius;
+	if ((sphere.Center - target.Center).LengthSquared() <= radius * radius)
+	{
+		_SetInitialOverlap(sphere.Center, direction, hit);
+		return true;
+	}
+
+	real t;
+	Vector3 normal;
+	if (!_RaycastSphere(sphere.Center, direction, target.Center, radius, t, normal) || t > maxDistance)
+		return false;
+
+	hit._Position = target.Center + normal * target.Radius;
+	hit._Normal = normal;
+	hit._Distance = t;
+	return true;
+}
+
+bool ShapeQuery::SweepSphereBox(const BoundingSphere& sphere, const Vector3& direction, real maxDistance,
+	const OBB& target, RaycastHit& hit)
+{
+	Vector3 axes[3];
+	_GetAxes(target, axes);
+
+	Vector3 origin = _ToLocal(axes, sphere.Center - target.Center);
+	Vector3 localDirection = _ToLocal(axes, direction);
+	const Vector3& extents = target.Extents;
+	real radius = sphere.Radius;
+
+	Vector3 closest;
+	if (_GetDistanceSquared(origin, extents, closest) <= radius * radius)
+	{
+		_SetInitialOverlap(sphere.Center, direction, hit);
+		return true;
+	}
+
+	// Ray from the center against the box enlarged by the radius
+	real t, sign;
+	int axis;
+	Vector3 enlarged = extents + Vector3(radius, radius, radius);
+	if (!_RaycastLocalBox(origin, localDirection, enlarged, maxDistance, t, axis, sign))
+		return false;
+
+	Vector3 point = origin + localDirection * t;
+	int outsideCount = 0;
+	for (int i = 0; i < 3; ++i)
+	{
+		if (Math::Abs(point[i]) > extents[i] + FaceTolerance)
+			outsideCount++;
+	}
+
+	Vector3 localNormal;
+	if (axis >= 0 && outsideCount <= 1)
+	{
+		localNormal = Vector3::Zero;
+		localNormal[axis] = sign;
+	}
+	else
+	{
+		// The enlarged box was entered near an edge, the rounded edges are capsules
+		bool isHit = false;
+		for (int i = 0; i < 3; ++i)
+		{
+			int j = (i + 1) % 3;
+			int k = (i + 2) % 3;
+			for (int corner = 0; corner < 4; ++corner)
+			{
+				Vector3 pointA;
+				pointA[i] = -extents[i];
+				pointA[j] = ((corner & 1) ? extents[j] : -extents[j]);
+				pointA[k] = ((corner & 2) ? extents[k] : -extents[k]);
+				Vector3 pointB = pointA;
+				pointB[i] = extents[i];
+
+				real edgeDistance;
+				Vector3 edgeNormal;
+				if (_RaycastCapsule(origin, localDirection, pointA, pointB, radius, edgeDistance, edgeNormal) &&
+					(!isHit || edgeDistance < t))
+				{
+					t = edgeDistance;
+					localNormal = edgeNormal;
+					isHit = true;
+				}
+			}
+		}
+
+		if (!isHit || t > maxDistance)
+			return false;
+	}
+
+	hit._Normal = _ToWorld(axes, localNormal);
+	hit._Position = sphere.Center + direction * t - hit._Normal * radius;
+	hit._Distance = t;
+	return true;
+}
+
+bool ShapeQuery::SweepBoxPlane(const OBB& box, const Vector3& direction, real maxDistance,
+	const Plane& plane, RaycastHit& hit)
+{
+	Vector3 axes[3];
+	_GetAxes(box, axes);
+
+	real radius = 0.0;
+	for (int i = 0; i < 3; ++i)
+	{
+		radius += box.Extents[i] * Math::Abs(Vector3::Dot(axes[i], plane.Normal));
+	}
+
+	real distance = plane.GetDistance(box.Center) - radius;
+	if (distance <= 0.0)
+	{
+		_SetInitialOverlap(box.Center, direction, hit);
+		return true;
+	}
+
+	real speed = Vector3::Dot(plane.Normal, direction);
+	if (speed >= 0.0)
+		return false;
+
+	real t = -distance / speed;
+	if (t > maxDistance)
+		return false;
+
+	hit._Position = _GetSupport(box, axes, -plane.Normal) + direction * t;
+	hit._Normal = plane.Normal;
+	hit._Distance = t;
+	return true;
+}
+
+bool ShapeQuery::SweepBoxSphere(const OBB& box, const Vector3& direction, real maxDistance,
+	const BoundingSphere& target, RaycastHit& hit)
+{
+	// The sphere moving the other way hits the box at the same distance
+	RaycastHit reverse;
+	if (!SweepSphereBox(target, -direction, maxDistance, box, reverse))
+		return false;
+
+	hit._Normal = -reverse._Normal;
+	hit._Position = (reverse._Distance > 0.0 ? target.Center - reverse._Normal * target.Radius : box.Center);
+	hit._Distance = reverse._Distance;
+	return true;
+}
+
+bool ShapeQuery::SweepBoxBox(const OBB& box, const Vector3& direction, real maxDistance,
+	const OBB& target, RaycastHit& hit)
+{
+	Vector3 axesA[3], axesB[3];
+	_GetAxes(box, axesA);
+	_GetAxes(target, axesB);
+
+	// Face normals of both boxes and cross products of their edges
+	Vector3 testAxes[15];
+	int axisCount = 0;
+	int i, j;
+	for (i = 0; i < 3; ++i)
+	{
+		testAxes[axisCount++] = axesA[i];
+		testAxes[axisCount++] = axesB[i];
+	}
+	for (i = 0; i < 3; ++i)
+	{
+		for (j = 0; j < 3; ++j)
+		{
+			Vector3 axis = Vector3::Cross(axesA[i], axesB[j]);
+			real lengthSq = axis.LengthSquared();
+			if (lengthSq > ParallelTolerance)
+			{
+				testAxes[axisCount++] = axis / Math::Sqrt(lengthSq);
+			}
+		}
+	}
+
+	// Time interval during which the projections overlap on every axis
+	Vector3 offset = target.Center - box.Center;
+	real first = -SE_MAX_R32;
+	real last = SE_MAX_R32;
+	Vector3 normal = Vector3::Zero;
+
+	for (i = 0; i < axisCount; ++i)
+	{
+		const Vector3& axis = testAxes[i];
+		real radius = 0.0;
+		for (j = 0; j < 3; ++j)
+		{
+			radius += box.Extents[j] * Math::Abs(Vector3::Dot(axesA[j], axis));
+			radius += target.Extents[j] * Math::Abs(Vector3::Dot(axesB[j], axis));
+		}
+
+		real distance = Vector3::Dot(offset, axis);
+		real speed = Vector3::Dot(direction, axis);
+		if (Math::Abs(speed) < ParallelTolerance)
+		{
+			if (Math::Abs(distance) > radius)
+				return false;
+			continue;
+		}
+
+		real enter = (distance - radius) / speed;
+		real exit = (distance + radius) / speed;
+		if (enter > exit)
+		{
+			SE_Swap(enter, exit);
+		}
+
+		if (enter > first)
+		{
+			first = enter;
+			normal = (speed > 0.0 ? -axis : axis);
+		}
+		last = Math::Min(last, exit);
+		if (first > last)
+			return false;
+	}
+
+	if (last < 0.0 || first > maxDistance)
+		return false;
+
+	if (first <= 0.0)
+	{
+		_SetInitialOverlap(box.Center, direction, hit);
+		return true;
+	}
+
+	hit._Position = _GetSupport(box, axesA, -normal) + direction * first;
+	hit._Normal = normal;
+	hit._Distance = first;
+	return true;
+}
+
+}
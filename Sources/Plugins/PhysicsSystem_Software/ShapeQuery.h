@@ -0,0 +1,80 @@
+/*=============================================================================
+ShapeQuery.h
+Project: Sonata Engine
+Author: Julien Delezenne
+=============================================================================*/
+
+#ifndef _SE_SHAPEQUERY_H_
+#define _SE_SHAPEQUERY_H_
+
+#include "SoftwarePhysicsSystem.h"
+
+namespace SE_Software
+{
+
+/**
+	@brief Raycasts, sweeps and overlaps against the shapes of the bodies.
+
+	The shapes are in world space and the directions must be normalized.
+	The sweeps don't rotate the moving shape. A query starting inside of a
+	shape hits it at the distance 0 with the opposite of the direction as
+	normal. Only the position, the normal and the distance of the hits are set.
+
+	The capsules and the meshes are tested with the world bounding box of
+	their body.
+*/
+class ShapeQuery
+{
+public:
+	/** @name Shapes. */
+	//@{
+	/**
+		Casts a ray against a shape.
+		@param shape The shape.
+		@param bounds The world bounding box of the body of the shape.
+		@param ray The ray.
+		@param maxDistance The maximum distance of the hit.
+		@param hit [out] The hit.
+		@return true if the shape was hit; otherwise, false.
+	*/
+	static bool Raycast(const IShape* shape, const AABB& bounds, const Ray3& ray, real maxDistance, RaycastHit& hit);
+
+	/** Sweeps a sphere against a shape. */
+	static bool SweepSphere(const IShape* shape, const AABB& bounds, const BoundingSphere& sphere,
+		const Vector3& direction, real maxDistance, RaycastHit& hit);
+
+	/** Sweeps a box against a shape. */
+	static bool SweepBox(const IShape* shape, const AABB& bounds, const OBB& box,
+		const Vector3& direction, real maxDistance, RaycastHit& hit);
+
+	/** Determines whether a shape overlaps a box. */
+	static bool Overlap(const IShape* shape, const AABB& bounds, const AABB& box);
+	//@}
+
+	/** @name Primitives. */
+	//@{
+	static bool RaycastPlane(const Plane& plane, const Ray3& ray, real maxDistance, RaycastHit& hit);
+	static bool RaycastSphere(const BoundingSphere& sphere, const Ray3& ray, real maxDistance, RaycastHit& hit);
+	static bool RaycastBox(const OBB& box, const Ray3& ray, real maxDistance, RaycastHit& hit);
+
+	static bool SweepSpherePlane(const BoundingSphere& sphere, const Vector3& direction, real maxDistance,
+		const Plane& plane, RaycastHit& hit);
+	static bool SweepSphereSphere(const BoundingSphere& sphere, const Vector3& direction, real maxDistance,
+		const BoundingSphere& target, RaycastHit& hit);
+	static bool SweepSphereBox(const BoundingSphere& sphere, const Vector3& direction, real maxDistance,
+		const OBB& target, RaycastHit& hit);
+
+	static bool SweepBoxPlane(const OBB& box, const Vector3& direction, real maxDistance,
+		const Plane& plane, RaycastHit& hit);
+	static bool SweepBoxSphere(const OBB& box, const Vector3& direction, real maxDistance,
+		const BoundingSphere& target, RaycastHit& hit);
+
+	/** Sweeps a box against another box with the separating axis test, a null direction tests the overlap. */
+	static bool SweepBoxBox(const OBB& box, const Vector3& direction, real maxDistance,
+		const OBB& target, RaycastHit& hit);
+	//@}
+};
+
+}
+
+#endif
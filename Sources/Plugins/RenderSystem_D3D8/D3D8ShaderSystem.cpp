@@ -79,7 +79,7 @@ ShaderMaterial* D3D8ShaderSystem::CreateShader(Stream& stream)
 {
 	HRESULT hr;
 
-	int32 length = stream.GetLength();
+	int32 length = (int32)stream.GetLength();
 	SEbyte* data = new SEbyte[length];
 	if (stream.Read(data, length) == 0)
 		return NULL;
@@ -83,7 +83,7 @@ EffectShader* D3D9HLSLShaderSystem::CreateEffectShader(const String& source)
 	if (stream == NULL)
 		return NULL;
 
-	int32 length = stream->GetLength();
+	int32 length = (int32)stream->GetLength();
 	SEbyte* data = new SEbyte[length];
 	if (stream->Read(data, length) == 0)
 	{
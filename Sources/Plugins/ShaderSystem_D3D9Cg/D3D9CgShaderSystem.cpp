@@ -124,7 +124,7 @@ ShaderMaterial* D3D9CgShaderSystem::CreateShader(Stream& stream)
 {
 	/*HRESULT hr;
 
-	int32 length = stream.GetLength();
+	int32 length = (int32)stream.GetLength();
 	SEbyte* data = new SEbyte[length];
 	if (stream.Read(data, length) == 0)
 		return NULL;
@@ -92,7 +92,7 @@ bool WAVSoundReader::OpenSound(Stream& stream, SoundReaderOptions* options)
 	}
 
 	int32 chunkSize = reader.ReadInt32();
-	_DataOffset = stream.GetPosition();
+	_DataOffset = (int32)stream.GetPosition();
 
 	int32 sampleSize = _Format.GetBlockAlign();
 	_DataSize = chunkSize / sampleSize;
@@ -21,7 +21,9 @@ static AudioResourceHandler* s_AudioResourceHandler;
 Application::Application() :
 	_isReady(false),
 	_mainWindow(NULL),
-	_isFullscreen(false)
+	_isFullscreen(false),
+	_lastAllocationCount(0),
+	_frameAllocationCount(0)
 {
 	s_GraphicsResourceHandler = new GraphicsResourceHandler();
 	s_AudioResourceHandler = new AudioResourceHandler();
@@ -97,6 +99,8 @@ bool Application::Destroy()
 		SE_DELETE(_mainWindow);
 	}
 
+	FrameArena::DestroyAll();
+
 	_isReady = false;
 
 	return true;
@@ -150,6 +154,13 @@ void Application::Run()
 		return;
 	}
 
+	// Release the temporary allocations of the previous frame
+	FrameArena::ResetAll();
+
+	int32 allocationCount = Memory::GetAllocationCount();
+	_frameAllocationCount = allocationCount - _lastAllocationCount;
+	_lastAllocationCount = allocationCount;
+
 	// Update the input system
 	InputSystem* inputSystem = InputSystem::Current();
 	if (inputSystem != NULL)
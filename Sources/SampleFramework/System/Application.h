@@ -30,6 +30,8 @@ protected:
 	TimeValue _elapsedTime;
 	TimeValue _lastFrame;
 	real32 _minFramePeriod;
+	int32 _lastAllocationCount;
+	int32 _frameAllocationCount;
 
 public:
 	/** @name Constructors / Destructor. */
@@ -69,6 +71,9 @@ public:
 	real32 GetMinFramePeriod() const { return _minFramePeriod; }
 	void SetMinFramePeriod(real32 value) { _minFramePeriod = value; }
 
+	/** Gets the number of heap allocations made during the last frame. */
+	int32 GetFrameAllocationCount() const { return _frameAllocationCount; }
+
 	/** Creates the application. */
 	virtual bool Create();
 
@@ -49,17 +49,6 @@ AI::PathfinderNodeID UnitPathMap::GetNeighbour(AI::PathfinderNode* node, int ind
 	return unitNode->_Children[index];
 }
 
-void UnitPathMap::SetAStarFlags(AI::PathfinderNodeID node, uint32 flags)
-{
-	//TODO
-}
-
-uint32 UnitPathMap::GetAStarFlags(AI::PathfinderNodeID node)
-{
-	//TODO
-	return 0;
-}
-
 void UnitPathMap::InitializeNeighbour(AI::AStarPathfinderNode* parent, AI::AStarPathfinderNode* child)
 {
 	UnitPathNode* unitChild = (UnitPathNode*)child;
@@ -151,108 +140,6 @@ bool UnitPathGoal::IsSearchFinished(AI::AStarPathfinderNode* node)
 }
 
 
-PriorityQueueStorage::PriorityQueueStorage() :
-	AI::AStarPathfinderStorage()
-{
-}
-
-PriorityQueueStorage::~PriorityQueueStorage()
-{
-	Reset();
-}
-
-void PriorityQueueStorage::Reset()
-{
-	OpenList::Iterator itOpen = _OpenList.GetIterator();
-	while (itOpen.Next())
-	{
-		//delete itOpen.Current();
-	}
-
-	ClosedList::Iterator itClosed = _ClosedList.GetIterator();
-	while (itClosed.Next())
-	{
-		//delete itOpen.Current();
-	}
-
-	_OpenList.Clear();
-	_ClosedList.Clear();
-}
-
-void PriorityQueueStorage::AddToOpenList(AI::AStarPathfinderNode* node, AI::AStarPathfinderMap* map)
-{
-	_OpenList.Enqueue(node);
-}
-
-void PriorityQueueStorage::AddToClosedList(AI::AStarPathfinderNode* node, AI::AStarPathfinderMap* map)
-{
-	_ClosedList.Add(node);
-}
-
-void PriorityQueueStorage::RemoveFromOpenList(AI::AStarPathfinderNode* node)
-{
-	if (node == _OpenList.Peek())
-		_OpenList.Dequeue();
-}
-
-void PriorityQueueStorage::RemoveFromClosedList(AI::AStarPathfinderNode* node)
-{
-	_ClosedList.Remove(node);
-}
-
-AI::AStarPathfinderNode* PriorityQueueStorage::FindInOpenList(AI::PathfinderNodeID node)
-{
-	OpenList::Iterator it = _OpenList.GetIterator();
-	while (it.Next())
-	{
-		if (it.Current()->_NodeID == node)
-			return it.Current();
-	}
-
-	return NULL;
-}
-
-AI::AStarPathfinderNode* PriorityQueueStorage::FindInClosedList(AI::PathfinderNodeID node)
-{
-	ClosedList::Iterator it = _ClosedList.GetIterator();
-	while (it.Next())
-	{
-		if (it.Current()->_NodeID == node)
-			return it.Current();
-	}
-
-	return NULL;
-}
-
-AI::AStarPathfinderNode* PriorityQueueStorage::RemoveBestOpenNode()
-{
-	if (_OpenList.IsEmpty())
-	{
-		return NULL;
-	}
-
-	return _OpenList.Dequeue();
-}
-
-
-UnitPathStorage::UnitPathStorage() :
-	PriorityQueueStorage()
-{
-}
-
-AI::AStarPathfinderNode* UnitPathStorage::CreateNode(AI::PathfinderNodeID node)
-{
-	UnitPathNode* unitNode = new UnitPathNode();
-	unitNode->_NodeID = node;
-	return unitNode;
-}
-
-void UnitPathStorage::DestroyNode(AI::AStarPathfinderNode* node)
-{
-	SE_DELETE(node);
-}
-
-
 UnitPathManager::UnitPathManager()
 {
 	_Pathfinder = NULL;
@@ -295,7 +182,9 @@ AI::PathfinderNode* UnitPathManager::FindPath(Unit* unit, Cell* source, Cell* de
 	}
 
 	_Goal->Initialize(_Map, unit);
-	_Map->Initialize(GameCore::Instance()->GetWorld()->GetMap());
+	Map* map = GameCore::Instance()->GetWorld()->GetMap();
+	_Map->Initialize(map);
+	_Storage->SetNodeCount(map->_Cells.Count());
 
 	_Pathfinder->Initialize(_Storage, _Goal, _Map);
 	_Pathfinder->SetSourceNode(_Map->CellToPathfinderNodeID(source));
@@ -26,9 +26,6 @@ public:
 	virtual int GetNeighbourCount(AI::PathfinderNode* node);
 	virtual AI::PathfinderNodeID GetNeighbour(AI::PathfinderNode* node, int neighbour);
 
-	virtual void SetAStarFlags(AI::PathfinderNodeID node, uint32 flags);
-	virtual uint32 GetAStarFlags(AI::PathfinderNodeID node);
-
 	virtual void InitializeNeighbour(AI::AStarPathfinderNode* parent, AI::AStarPathfinderNode* child);
 
 	AI::PathfinderNodeID CellToPathfinderNodeID(Cell* cell);
@@ -62,53 +59,7 @@ protected:
 	Unit* _Unit;
 };
 
-template <class T>
-class RefComparer : public IComparer<T>
-{
-public:
-	virtual int Compare(const T& x, const T& y) const
-	{
-		if (*x < *y)
-			return -1;
-		else if (*x > *y)
-			return 1;
-		else
-			return 0;
-	}
-};
-
-class PriorityQueueStorage : public AI::AStarPathfinderStorage
-{
-public:
-	PriorityQueueStorage();
-	virtual ~PriorityQueueStorage();
-
-	virtual void Reset();
-	virtual void AddToOpenList(AI::AStarPathfinderNode* node, AI::AStarPathfinderMap* map);
-	virtual void AddToClosedList(AI::AStarPathfinderNode* node, AI::AStarPathfinderMap* map);
-	virtual void RemoveFromOpenList(AI::AStarPathfinderNode* node);
-	virtual void RemoveFromClosedList(AI::AStarPathfinderNode* node);
-
-	virtual AI::AStarPathfinderNode* FindInOpenList(AI::PathfinderNodeID node);
-	virtual AI::AStarPathfinderNode* FindInClosedList(AI::PathfinderNodeID node);
-
-	virtual AI::AStarPathfinderNode* RemoveBestOpenNode();
-
-protected:
-	typedef PriorityQueue< AI::AStarPathfinderNode*, RefComparer<AI::AStarPathfinderNode*> > OpenList;
-	OpenList _OpenList;
-	typedef Array<AI::AStarPathfinderNode*> ClosedList;
-	ClosedList _ClosedList;
-};
-
-class UnitPathStorage : public PriorityQueueStorage
-{
-public:
-	UnitPathStorage();
-
-	virtual AI::AStarPathfinderNode* CreateNode(AI::PathfinderNodeID node);
-	virtual void DestroyNode(AI::AStarPathfinderNode* node);
-};
+typedef AI::PooledAStarPathfinderStorage<UnitPathNode> UnitPathStorage;
 
 class UnitPathManager
 {
@@ -126,7 +77,7 @@ protected:
 
 protected:
 	AI::AStarPathfinder* _Pathfinder;
-	PriorityQueueStorage* _Storage;
+	UnitPathStorage* _Storage;
 	UnitPathGoal* _Goal;
 	UnitPathMap* _Map;
 };
@@ -178,7 +178,7 @@ void SettingsDialog::Show(Widget* owner)
 
 	_ComboBoxTimeStep->SetSelectedIndex(scene->GetTimeStepType());
 	_TextBoxTimeStep->SetText(String::ToString(scene->GetTimeStep()));
-	_CheckBoxBroadPhase->SetChecked(desc._BroadPhase);
+	_CheckBoxBroadPhase->SetChecked(desc._BroadPhase != Physics::BroadPhaseType_None);
 	_CheckBoxCollisionDetection->SetChecked(desc._CollisionDetection);
 	_TextBoxGravityX->SetText(String::ToString(scene->GetGravity().X));
 	_TextBoxGravityY->SetText(String::ToString(scene->GetGravity().Y));
@@ -1048,6 +1048,9 @@ void PhysicsWorld::Update(real64 elapsed)
 		PhysicsSystem::Current()->Update(elapsed);
 	}
 
+	// Blend the transforms between the last two fixed steps
+	real alpha = _PhysicsScene->GetInterpolationAlpha();
+
 	count = _Entities.Count();
 	for (i=0; i<count; i++)
 	{
@@ -1055,8 +1058,8 @@ void PhysicsWorld::Update(real64 elapsed)
 		ModelNode* node = entity->GetNode();
 		Physics::IBody* body = entity->GetPhysicsBody();
 
-		node->SetLocalPosition(body->GetPosition());
-		node->SetLocalOrientation(body->GetOrientation());
+		node->SetLocalPosition(body->GetInterpolatedPosition(alpha));
+		node->SetLocalOrientation(body->GetInterpolatedOrientation(alpha));
 	}
 
 	if (_Scene != NULL)
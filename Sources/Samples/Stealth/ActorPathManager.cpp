@@ -41,17 +41,6 @@ AI::PathfinderNodeID ActorPathMap::GetNeighbour(AI::PathfinderNode* node, int in
 	return actorNode->_Children[index];
 }
 
-void ActorPathMap::SetAStarFlags(AI::PathfinderNodeID node, uint32 flags)
-{
-	//TODO
-}
-
-uint32 ActorPathMap::GetAStarFlags(AI::PathfinderNodeID node)
-{
-	//TODO
-	return 0;
-}
-
 void ActorPathMap::InitializeNeighbour(AI::AStarPathfinderNode* parent, AI::AStarPathfinderNode* child)
 {
 	ActorPathNode* actorChild = (ActorPathNode*)child;
@@ -180,108 +169,6 @@ bool ActorPathGoal::IsSearchFinished(AI::AStarPathfinderNode* node)
 }
 
 
-PriorityQueueStorage::PriorityQueueStorage() :
-	AI::AStarPathfinderStorage()
-{
-}
-
-PriorityQueueStorage::~PriorityQueueStorage()
-{
-	Reset();
-}
-
-void PriorityQueueStorage::Reset()
-{
-	OpenList::Iterator itOpen = _OpenList.GetIterator();
-	while (itOpen.Next())
-	{
-		//delete itOpen.Current();
-	}
-
-	ClosedList::Iterator itClosed = _ClosedList.GetIterator();
-	while (itClosed.Next())
-	{
-		//delete itOpen.Current();
-	}
-
-	_OpenList.Clear();
-	_ClosedList.Clear();
-}
-
-void PriorityQueueStorage::AddToOpenList(AI::AStarPathfinderNode* node, AI::AStarPathfinderMap* map)
-{
-	_OpenList.Enqueue(node);
-}
-
-void PriorityQueueStorage::AddToClosedList(AI::AStarPathfinderNode* node, AI::AStarPathfinderMap* map)
-{
-	_ClosedList.Add(node);
-}
-
-void PriorityQueueStorage::RemoveFromOpenList(AI::AStarPathfinderNode* node)
-{
-	if (node == _OpenList.Peek())
-		_OpenList.Dequeue();
-}
-
-void PriorityQueueStorage::RemoveFromClosedList(AI::AStarPathfinderNode* node)
-{
-	_ClosedList.Remove(node);
-}
-
-AI::AStarPathfinderNode* PriorityQueueStorage::FindInOpenList(AI::PathfinderNodeID node)
-{
-	OpenList::Iterator it = _OpenList.GetIterator();
-	while (it.Next())
-	{
-		if (it.Current()->_NodeID == node)
-			return it.Current();
-	}
-
-	return NULL;
-}
-
-AI::AStarPathfinderNode* PriorityQueueStorage::FindInClosedList(AI::PathfinderNodeID node)
-{
-	ClosedList::Iterator it = _ClosedList.GetIterator();
-	while (it.Next())
-	{
-		if (it.Current()->_NodeID == node)
-			return it.Current();
-	}
-
-	return NULL;
-}
-
-AI::AStarPathfinderNode* PriorityQueueStorage::RemoveBestOpenNode()
-{
-	if (_OpenList.IsEmpty())
-	{
-		return NULL;
-	}
-
-	return _OpenList.Dequeue();
-}
-
-
-ActorPathStorage::ActorPathStorage() :
-	PriorityQueueStorage()
-{
-}
-
-AI::AStarPathfinderNode* ActorPathStorage::CreateNode(AI::PathfinderNodeID node)
-{
-	ActorPathNode* actorNode = new ActorPathNode();
-	actorNode->_NodeID = node;
-	return actorNode;
-}
-
-void ActorPathStorage::DestroyNode(AI::AStarPathfinderNode* node)
-{
-	SE_DELETE(node);
-}
-
-
 ActorPathManager::ActorPathManager()
 {
 	_Pathfinder = NULL;
@@ -328,7 +215,9 @@ AI::PathfinderNode* ActorPathManager::FindPath(Actor* actor, MapNode* source, Ma
 #endif
 
 	_Goal->Initialize(_Map, actor);
-	_Map->Initialize(GameCore::Instance()->GetWorld()->GetMap());
+	Map* map = GameCore::Instance()->GetWorld()->GetMap();
+	_Map->Initialize(map);
+	_Storage->SetNodeCount(map->_MapNodes.Count());
 
 	_Pathfinder->Initialize(_Storage, _Goal, _Map);
 	_Pathfinder->SetSourceNode(_Map->MapNodeToPathfinderNodeID(source));